@@ -465,11 +465,19 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/qgcunittest
 
     HEADERS += \
+        src/ADSB/ADSBSpatialIndexTest.h \
+        src/AnalyzeView/GeoTagLogParserTest.h \
+        src/AnalyzeView/LogDownloadTest.h \
+        src/AnalyzeView/MAVLinkTimeSeriesTest.h \
+        src/AnalyzeView/TlogAnalyzerTest.h \
         src/Audio/AudioOutputTest.h \
+        src/FactSystem/FactGroupTest.h \
         src/FactSystem/FactSystemTestBase.h \
         src/FactSystem/FactSystemTestGeneric.h \
         src/FactSystem/FactSystemTestPX4.h \
         src/FactSystem/ParameterManagerTest.h \
+        src/FactSystem/ParameterMetaDataTest.h \
+        src/Joystick/JoystickTest.h \
         src/MissionManager/CameraCalcTest.h \
         src/MissionManager/CameraSectionTest.h \
         src/MissionManager/CorridorScanComplexItemTest.h \
@@ -493,29 +501,46 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/MissionManager/VisualMissionItemTest.h \
         src/qgcunittest/GeoTest.h \
         src/qgcunittest/LinkManagerTest.h \
+        src/qgcunittest/MAVLinkMessageDispatcherTest.h \
+        src/qgcunittest/MAVLinkParserWorkerTest.h \
         src/qgcunittest/MavlinkLogTest.h \
         src/qgcunittest/MultiSignalSpy.h \
+        src/qgcunittest/QGCTileMemoryCacheTest.h \
         src/qgcunittest/TCPLinkTest.h \
         src/qgcunittest/TCPLoopBackServer.h \
+        src/qgcunittest/TelemetryLogWriterTest.h \
+        src/qgcunittest/TerrainTileManagerTest.h \
+        src/qgcunittest/TerrainTileTest.h \
+        src/qgcunittest/TlogReaderTest.h \
+        src/qgcunittest/UDPLinkTest.h \
         src/qgcunittest/UnitTest.h \
         src/Vehicle/FTPManagerTest.h \
         src/Vehicle/InitialConnectTest.h \
         src/Vehicle/RequestMessageTest.h \
         src/Vehicle/SendMavCommandWithHandlerTest.h \
         src/Vehicle/SendMavCommandWithSignallingTest.h \
+        src/Vehicle/TrajectoryPointsTest.h \
+        src/VehicleSetup/BootloaderTest.h \
         #src/qgcunittest/RadioConfigTest.h \
-        #src/AnalyzeView/LogDownloadTest.h \
         #src/qgcunittest/FileDialogTest.h \
         #src/qgcunittest/FileManagerTest.h \
         #src/qgcunittest/MainWindowTest.h \
         #src/qgcunittest/MessageBoxTest.h \
 
     SOURCES += \
+        src/ADSB/ADSBSpatialIndexTest.cc \
+        src/AnalyzeView/GeoTagLogParserTest.cc \
+        src/AnalyzeView/LogDownloadTest.cc \
+        src/AnalyzeView/MAVLinkTimeSeriesTest.cc \
+        src/AnalyzeView/TlogAnalyzerTest.cc \
         src/Audio/AudioOutputTest.cc \
+        src/FactSystem/FactGroupTest.cc \
         src/FactSystem/FactSystemTestBase.cc \
         src/FactSystem/FactSystemTestGeneric.cc \
         src/FactSystem/FactSystemTestPX4.cc \
         src/FactSystem/ParameterManagerTest.cc \
+        src/FactSystem/ParameterMetaDataTest.cc \
+        src/Joystick/JoystickTest.cc \
         src/MissionManager/CameraCalcTest.cc \
         src/MissionManager/CameraSectionTest.cc \
         src/MissionManager/CorridorScanComplexItemTest.cc \
@@ -539,10 +564,18 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/MissionManager/VisualMissionItemTest.cc \
         src/qgcunittest/GeoTest.cc \
         src/qgcunittest/LinkManagerTest.cc \
+        src/qgcunittest/MAVLinkMessageDispatcherTest.cc \
+        src/qgcunittest/MAVLinkParserWorkerTest.cc \
         src/qgcunittest/MavlinkLogTest.cc \
         src/qgcunittest/MultiSignalSpy.cc \
+        src/qgcunittest/QGCTileMemoryCacheTest.cc \
         src/qgcunittest/TCPLinkTest.cc \
         src/qgcunittest/TCPLoopBackServer.cc \
+        src/qgcunittest/TelemetryLogWriterTest.cc \
+        src/qgcunittest/TerrainTileManagerTest.cc \
+        src/qgcunittest/TerrainTileTest.cc \
+        src/qgcunittest/TlogReaderTest.cc \
+        src/qgcunittest/UDPLinkTest.cc \
         src/qgcunittest/UnitTest.cc \
         src/qgcunittest/UnitTestList.cc \
         src/Vehicle/FTPManagerTest.cc \
@@ -550,8 +583,9 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/Vehicle/RequestMessageTest.cc \
         src/Vehicle/SendMavCommandWithHandlerTest.cc \
         src/Vehicle/SendMavCommandWithSignallingTest.cc \
+        src/Vehicle/TrajectoryPointsTest.cc \
+        src/VehicleSetup/BootloaderTest.cc \
         #src/qgcunittest/RadioConfigTest.cc \
-        #src/AnalyzeView/LogDownloadTest.cc \
         #src/qgcunittest/FileDialogTest.cc \
         #src/qgcunittest/FileManagerTest.cc \
         #src/qgcunittest/MainWindowTest.cc \
@@ -562,8 +596,10 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
 # Main QGC Headers and Source files
 
 HEADERS += \
+    src/ADSB/ADSBSpatialIndex.h \
     src/ADSB/ADSBVehicle.h \
     src/ADSB/ADSBVehicleManager.h \
+    src/AnalyzeView/LogBufferedReader.h \
     src/AnalyzeView/LogDownloadController.h \
     src/AnalyzeView/PX4LogParser.h \
     src/AnalyzeView/ULogParser.h \
@@ -702,10 +738,15 @@ HEADERS += \
     src/comm/LinkConfiguration.h \
     src/comm/LinkInterface.h \
     src/comm/LinkManager.h \
+    src/comm/LinkQualityTracker.h \
     src/comm/LogReplayLink.h \
+    src/comm/MAVLinkMessageDispatcher.h \
+    src/comm/MAVLinkParserWorker.h \
     src/comm/MAVLinkProtocol.h \
     src/comm/QGCMAVLink.h \
     src/comm/TCPLink.h \
+    src/comm/TelemetryLogWriter.h \
+    src/comm/TlogReader.h \
     src/comm/UDPLink.h \
     src/comm/UdpIODevice.h \
     src/uas/UAS.h \
@@ -713,6 +754,7 @@ HEADERS += \
     src/uas/UASMessageHandler.h \
     src/AnalyzeView/GeoTagController.h \
     src/AnalyzeView/ExifParser.h \
+    src/AnalyzeView/TlogAnalyzer.h \
 
 contains (DEFINES, QGC_ENABLE_PAIRING) {
     HEADERS += \
@@ -785,8 +827,10 @@ AndroidBuild {
 }
 
 SOURCES += \
+    src/ADSB/ADSBSpatialIndex.cc \
     src/ADSB/ADSBVehicle.cc \
     src/ADSB/ADSBVehicleManager.cc \
+    src/AnalyzeView/LogBufferedReader.cc \
     src/AnalyzeView/LogDownloadController.cc \
     src/AnalyzeView/PX4LogParser.cc \
     src/AnalyzeView/ULogParser.cc \
@@ -921,10 +965,15 @@ SOURCES += \
     src/comm/LinkConfiguration.cc \
     src/comm/LinkInterface.cc \
     src/comm/LinkManager.cc \
+    src/comm/LinkQualityTracker.cc \
     src/comm/LogReplayLink.cc \
+    src/comm/MAVLinkMessageDispatcher.cc \
+    src/comm/MAVLinkParserWorker.cc \
     src/comm/MAVLinkProtocol.cc \
     src/comm/QGCMAVLink.cc \
     src/comm/TCPLink.cc \
+    src/comm/TelemetryLogWriter.cc \
+    src/comm/TlogReader.cc \
     src/comm/UDPLink.cc \
     src/comm/UdpIODevice.cc \
     src/main.cc \
@@ -932,6 +981,7 @@ SOURCES += \
     src/uas/UASMessageHandler.cc \
     src/AnalyzeView/GeoTagController.cc \
     src/AnalyzeView/ExifParser.cc \
+    src/AnalyzeView/TlogAnalyzer.cc \
 
 contains (DEFINES, QGC_ENABLE_PAIRING) {
     SOURCES += \
@@ -1176,9 +1226,11 @@ HEADERS += \
     src/FactSystem/Fact.h \
     src/FactSystem/FactControls/FactPanelController.h \
     src/FactSystem/FactGroup.h \
+    src/FactSystem/FactGroupUpdateScheduler.h \
     src/FactSystem/FactMetaData.h \
     src/FactSystem/FactSystem.h \
     src/FactSystem/FactValueSliderListModel.h \
+    src/FactSystem/ParameterCacheFile.h \
     src/FactSystem/ParameterManager.h \
     src/FactSystem/SettingsFact.h \
 
@@ -1186,9 +1238,11 @@ SOURCES += \
     src/FactSystem/Fact.cc \
     src/FactSystem/FactControls/FactPanelController.cc \
     src/FactSystem/FactGroup.cc \
+    src/FactSystem/FactGroupUpdateScheduler.cc \
     src/FactSystem/FactMetaData.cc \
     src/FactSystem/FactSystem.cc \
     src/FactSystem/FactValueSliderListModel.cc \
+    src/FactSystem/ParameterCacheFile.cc \
     src/FactSystem/ParameterManager.cc \
     src/FactSystem/SettingsFact.cc \
 
@@ -1196,9 +1250,11 @@ SOURCES += \
 # MAVLink Inspector
 contains (DEFINES, QGC_ENABLE_MAVLINK_INSPECTOR) {
     HEADERS += \
-        src/AnalyzeView/MAVLinkInspectorController.h
+        src/AnalyzeView/MAVLinkInspectorController.h \
+        src/AnalyzeView/MAVLinkTimeSeries.h
     SOURCES += \
-        src/AnalyzeView/MAVLinkInspectorController.cc
+        src/AnalyzeView/MAVLinkInspectorController.cc \
+        src/AnalyzeView/MAVLinkTimeSeries.cc
     QT += \
         charts
 }
@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBSpatialIndex.h"
+
+#include <QtMath>
+
+int ADSBSpatialIndex::_latCell(double latitude)
+{
+    return qBound(0, static_cast<int>(qFloor((latitude + 90.0) / _cellDegrees)), _latCells - 1);
+}
+
+int ADSBSpatialIndex::_lonCell(double longitude)
+{
+    int cell = static_cast<int>(qFloor((longitude + 180.0) / _cellDegrees)) % _lonCells;
+    return cell < 0 ? cell + _lonCells : cell;
+}
+
+void ADSBSpatialIndex::update(uint32_t icaoAddress, const QGeoCoordinate& coordinate, double altitude)
+{
+    if (!coordinate.isValid()) {
+        remove(icaoAddress);
+        return;
+    }
+
+    quint64 cell = _cellKey(_latCell(coordinate.latitude()), _lonCell(coordinate.longitude()));
+
+    auto iter = _entries.find(icaoAddress);
+    if (iter == _entries.end()) {
+        iter = _entries.insert(icaoAddress, Entry_t());
+        _cells[cell].insert(icaoAddress);
+    } else if (iter->cell != cell) {
+        auto cellIter = _cells.find(iter->cell);
+        if (cellIter != _cells.end()) {
+            cellIter->remove(icaoAddress);
+            if (cellIter->isEmpty()) {
+                _cells.erase(cellIter);
+            }
+        }
+        _cells[cell].insert(icaoAddress);
+    }
+    iter->coordinate    = coordinate;
+    iter->altitude      = altitude;
+    iter->cell          = cell;
+}
+
+void ADSBSpatialIndex::remove(uint32_t icaoAddress)
+{
+    auto iter = _entries.find(icaoAddress);
+    if (iter == _entries.end()) {
+        return;
+    }
+    auto cellIter = _cells.find(iter->cell);
+    if (cellIter != _cells.end()) {
+        cellIter->remove(icaoAddress);
+        if (cellIter->isEmpty()) {
+            _cells.erase(cellIter);
+        }
+    }
+    _entries.erase(iter);
+}
+
+void ADSBSpatialIndex::clear(void)
+{
+    _entries.clear();
+    _cells.clear();
+}
+
+QList<uint32_t> ADSBSpatialIndex::query(const QGeoCoordinate& coordinate, double altitude, double horizontalMeters, double verticalMeters) const
+{
+    QList<uint32_t> icaoAddresses;
+
+    if (!coordinate.isValid() || horizontalMeters < 0 || _entries.isEmpty()) {
+        return icaoAddresses;
+    }
+
+    // Degrees covered by the radius. The meters per degree is on the low side of the sphere distanceTo uses so the
+    // span never falls short. Longitude degrees shrink towards the poles so the longitude span is sized for the
+    // latitude in the band closest to the pole, and once the band reaches a pole every longitude is in range.
+    const double metersPerDegree    = 111000.0;
+    double       latSpan            = qMin(horizontalMeters / metersPerDegree, 180.0);
+    double       poleLatitude       = qAbs(coordinate.latitude()) + latSpan;
+    double       lonSpan            = 360.0;
+    if (poleLatitude < 90.0) {
+        lonSpan = qMin(horizontalMeters / (metersPerDegree * qCos(qDegreesToRadians(poleLatitude))), 360.0);
+    }
+
+    int firstLatCell    = _latCell(coordinate.latitude() - latSpan);
+    int lastLatCell     = _latCell(coordinate.latitude() + latSpan);
+    int firstLonCell    = static_cast<int>(qFloor((coordinate.longitude() + 180.0 - lonSpan) / _cellDegrees));
+    int lastLonCell     = static_cast<int>(qFloor((coordinate.longitude() + 180.0 + lonSpan) / _cellDegrees));
+    if (lastLonCell - firstLonCell + 1 >= _lonCells) {
+        firstLonCell    = 0;
+        lastLonCell     = _lonCells - 1;
+    }
+
+    for (int latCell = firstLatCell; latCell <= lastLatCell; latCell++) {
+        for (int lonCell = firstLonCell; lonCell <= lastLonCell; lonCell++) {
+            // Wrap across the antimeridian
+            int wrappedLonCell = ((lonCell % _lonCells) + _lonCells) % _lonCells;
+
+            auto cellIter = _cells.constFind(_cellKey(latCell, wrappedLonCell));
+            if (cellIter == _cells.constEnd()) {
+                continue;
+            }
+            for (uint32_t icaoAddress: cellIter.value()) {
+                const Entry_t& entry = _entries[icaoAddress];
+                if (!qIsNaN(altitude) && !qIsNaN(entry.altitude) && qAbs(entry.altitude - altitude) > verticalMeters) {
+                    continue;
+                }
+                if (coordinate.distanceTo(entry.coordinate) <= horizontalMeters) {
+                    icaoAddresses.append(icaoAddress);
+                }
+            }
+        }
+    }
+
+    return icaoAddresses;
+}
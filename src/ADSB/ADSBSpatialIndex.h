@@ -0,0 +1,53 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QGeoCoordinate>
+#include <QHash>
+#include <QSet>
+#include <QList>
+
+/// Uniform latitude/longitude grid over ADS-B positions, keyed by ICAO address.
+///
+/// Entries move between cells as their positions update, so a proximity query only looks at the cells overlapping
+/// the search radius instead of at every aircraft.
+class ADSBSpatialIndex
+{
+public:
+    /// Adds or moves an aircraft
+    ///     @param altitude AMSL in meters, NaN if not known
+    void update(uint32_t icaoAddress, const QGeoCoordinate& coordinate, double altitude);
+
+    void remove(uint32_t icaoAddress);
+    void clear (void);
+    int  count (void) const { return _entries.count(); }
+
+    /// @return ICAO addresses of the aircraft within horizontalMeters and verticalMeters of the specified position.
+    ///         The vertical check is skipped when either altitude is NaN.
+    QList<uint32_t> query(const QGeoCoordinate& coordinate, double altitude, double horizontalMeters, double verticalMeters) const;
+
+private:
+    typedef struct {
+        QGeoCoordinate  coordinate;
+        double          altitude;
+        quint64         cell;
+    } Entry_t;
+
+    static int      _latCell    (double latitude);
+    static int      _lonCell    (double longitude);
+    static quint64  _cellKey    (int latCell, int lonCell) { return (static_cast<quint64>(static_cast<quint32>(latCell)) << 32) | static_cast<quint32>(lonCell); }
+
+    static constexpr double _cellDegrees    = 0.25;     ///< About 28km north/south
+    static const int        _latCells       = 720;      ///< 180 / _cellDegrees
+    static const int        _lonCells       = 1440;     ///< 360 / _cellDegrees
+
+    QHash<uint32_t, Entry_t>            _entries;
+    QHash<quint64, QSet<uint32_t>>      _cells;
+};
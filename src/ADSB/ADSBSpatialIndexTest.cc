@@ -0,0 +1,206 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBSpatialIndexTest.h"
+#include "ADSBSpatialIndex.h"
+#include "ADSBVehicleManager.h"
+#include "QGCApplication.h"
+
+#include <algorithm>
+
+QList<uint32_t> ADSBSpatialIndexTest::_sorted(QList<uint32_t> icaoAddresses)
+{
+    std::sort(icaoAddresses.begin(), icaoAddresses.end());
+    return icaoAddresses;
+}
+
+ADSBVehicle::VehicleInfo_t ADSBSpatialIndexTest::_vehicleInfo(uint32_t icaoAddress, const QGeoCoordinate& coordinate, double altitude)
+{
+    ADSBVehicle::VehicleInfo_t vehicleInfo;
+
+    vehicleInfo.icaoAddress     = icaoAddress;
+    vehicleInfo.location        = coordinate;
+    vehicleInfo.altitude        = altitude;
+    vehicleInfo.heading         = qQNaN();
+    vehicleInfo.alert           = false;
+    vehicleInfo.availableFlags  = ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable;
+
+    return vehicleInfo;
+}
+
+void ADSBSpatialIndexTest::_query_test(void)
+{
+    ADSBSpatialIndex    index;
+    QGeoCoordinate      center(47.2501, 8.5455);
+
+    index.update(1, center.atDistanceAndAzimuth(500, 0), qQNaN());
+    index.update(2, center.atDistanceAndAzimuth(1500, 90), qQNaN());
+    index.update(3, center.atDistanceAndAzimuth(50000, 180), qQNaN());
+    // Just across the cell boundary at 47.25
+    index.update(4, QGeoCoordinate(47.2499, 8.5455), qQNaN());
+    QCOMPARE(index.count(), 4);
+
+    QCOMPARE(_sorted(index.query(center, qQNaN(), 1000, 0)),       QList<uint32_t>({ 1, 4 }));
+    QCOMPARE(_sorted(index.query(center, qQNaN(), 2000, 0)),       QList<uint32_t>({ 1, 2, 4 }));
+    QCOMPARE(_sorted(index.query(center, qQNaN(), 100000, 0)),     QList<uint32_t>({ 1, 2, 3, 4 }));
+    QVERIFY(index.query(center, qQNaN(), -1, 0).isEmpty());
+    QVERIFY(index.query(QGeoCoordinate(), qQNaN(), 1000, 0).isEmpty());
+}
+
+void ADSBSpatialIndexTest::_antimeridian_test(void)
+{
+    ADSBSpatialIndex index;
+
+    // Each pair is a couple of hundred meters apart with the antimeridian between them
+    index.update(1, QGeoCoordinate(10, 179.999), qQNaN());
+    index.update(2, QGeoCoordinate(10, -179.999), qQNaN());
+    index.update(3, QGeoCoordinate(10, 179.5), qQNaN());
+
+    QCOMPARE(_sorted(index.query(QGeoCoordinate(10, 179.999), qQNaN(), 1000, 0)),    QList<uint32_t>({ 1, 2 }));
+    QCOMPARE(_sorted(index.query(QGeoCoordinate(10, -179.999), qQNaN(), 1000, 0)),   QList<uint32_t>({ 1, 2 }));
+    QCOMPARE(_sorted(index.query(QGeoCoordinate(10, 180), qQNaN(), 60000, 0)),       QList<uint32_t>({ 1, 2, 3 }));
+}
+
+void ADSBSpatialIndexTest::_pole_test(void)
+{
+    ADSBSpatialIndex index;
+
+    // About 2.2km away on the other side of the pole, 1.2km away a quarter of the way round and 1.1km away on the pole itself
+    index.update(1, QGeoCoordinate(89.99, 180), qQNaN());
+    index.update(2, QGeoCoordinate(89.995, 90), qQNaN());
+    index.update(3, QGeoCoordinate(90, 0), qQNaN());
+
+    QCOMPARE(_sorted(index.query(QGeoCoordinate(89.99, 0), qQNaN(), 1500, 0)), QList<uint32_t>({ 2, 3 }));
+    QCOMPARE(_sorted(index.query(QGeoCoordinate(89.99, 0), qQNaN(), 3000, 0)), QList<uint32_t>({ 1, 2, 3 }));
+
+    // Same across the south pole, where the latitude cell is clamped
+    index.clear();
+    index.update(1, QGeoCoordinate(-89.99, 180), qQNaN());
+    index.update(2, QGeoCoordinate(-90, 0), qQNaN());
+    QCOMPARE(_sorted(index.query(QGeoCoordinate(-89.99, 0), qQNaN(), 3000, 0)), QList<uint32_t>({ 1, 2 }));
+}
+
+void ADSBSpatialIndexTest::_vertical_test(void)
+{
+    ADSBSpatialIndex    index;
+    QGeoCoordinate      center(47.397, 8.5455);
+
+    index.update(1, center.atDistanceAndAzimuth(100, 0), 350);
+    index.update(2, center.atDistanceAndAzimuth(100, 90), 450);
+    index.update(3, center.atDistanceAndAzimuth(100, 180), -250);
+    index.update(4, center.atDistanceAndAzimuth(100, 270), qQNaN());
+
+    // Unknown altitude on the aircraft or at the query position skips the vertical check
+    QCOMPARE(_sorted(index.query(center, 100, 1000, 300)),         QList<uint32_t>({ 1, 4 }));
+    QCOMPARE(_sorted(index.query(center, 100, 1000, 400)),         QList<uint32_t>({ 1, 2, 3, 4 }));
+    QCOMPARE(_sorted(index.query(center, qQNaN(), 1000, 0)),       QList<uint32_t>({ 1, 2, 3, 4 }));
+}
+
+void ADSBSpatialIndexTest::_move_test(void)
+{
+    ADSBSpatialIndex    index;
+    QGeoCoordinate      center(47.397, 8.5455);
+    QGeoCoordinate      farAway = center.atDistanceAndAzimuth(50000, 45);
+
+    index.update(1, center, qQNaN());
+    QCOMPARE(index.query(center, qQNaN(), 1000, 0), QList<uint32_t>({ 1 }));
+
+    // Moving to another cell must take it out of the old one
+    index.update(1, farAway, qQNaN());
+    QCOMPARE(index.count(), 1);
+    QVERIFY(index.query(center, qQNaN(), 1000, 0).isEmpty());
+    QCOMPARE(index.query(farAway, qQNaN(), 1000, 0), QList<uint32_t>({ 1 }));
+
+    index.update(1, center, qQNaN());
+    QCOMPARE(index.query(center, qQNaN(), 1000, 0), QList<uint32_t>({ 1 }));
+    QVERIFY(index.query(farAway, qQNaN(), 1000, 0).isEmpty());
+
+    index.remove(1);
+    QCOMPARE(index.count(), 0);
+    QVERIFY(index.query(center, qQNaN(), 1000, 0).isEmpty());
+
+    // An invalid position drops the aircraft from the index
+    index.update(2, center, qQNaN());
+    index.update(2, QGeoCoordinate(), qQNaN());
+    QCOMPARE(index.count(), 0);
+}
+
+void ADSBSpatialIndexTest::_expiry_test(void)
+{
+    ADSBVehicleManager manager(qgcApp(), qgcApp()->toolbox());
+    manager.setToolbox(qgcApp()->toolbox());
+    manager._adsbVehicleCleanupTimer.stop();
+
+    const int       expiryTicks = ADSBVehicleManager::_expiryTicks;
+    const int       wheelSlots  = ADSBVehicleManager::_expiryWheelSlots;
+    QGeoCoordinate  coordinate(47.397, 8.5455);
+
+    manager.adsbVehicleUpdate(_vehicleInfo(1, coordinate, 500));
+    QCOMPARE(manager.adsbVehicles()->count(), 1);
+
+    int slot = manager._expirySlots.value(1, -1);
+    QCOMPARE(slot, (manager._expiryTick + expiryTicks) % wheelSlots);
+
+    // Nothing looks at the vehicle until the tick it is due on
+    for (int i = 1; i < expiryTicks; i++) {
+        manager._cleanupStaleVehicles();
+        QCOMPARE(manager._expirySlots.value(1, -1), slot);
+    }
+
+    // Due, but the real timeout has not passed so it is pushed out a single tick
+    manager._cleanupStaleVehicles();
+    QCOMPARE(manager._expiryTick, slot);
+    int nextSlot = (slot + 1) % wheelSlots;
+    QCOMPARE(manager._expirySlots.value(1, -1), nextSlot);
+    QVERIFY(manager._expiryWheel[nextSlot].contains(1));
+    QCOMPARE(manager.adsbVehicles()->count(), 1);
+
+    // An update moves it to a full timeout from now
+    manager.adsbVehicleUpdate(_vehicleInfo(1, coordinate, 500));
+    slot = (manager._expiryTick + expiryTicks) % wheelSlots;
+    QCOMPARE(manager._expirySlots.value(1, -1), slot);
+    QVERIFY(!manager._expiryWheel[nextSlot].contains(1));
+    QVERIFY(manager._expiryWheel[slot].contains(1));
+}
+
+void ADSBSpatialIndexTest::_conflict_test(void)
+{
+    _connectMockLink();
+    QTRY_VERIFY_WITH_TIMEOUT(_vehicle->coordinate().isValid(), 5000);
+
+    ADSBVehicleManager manager(qgcApp(), qgcApp()->toolbox());
+    manager.setToolbox(qgcApp()->toolbox());
+    manager._adsbVehicleCleanupTimer.stop();
+
+    QGeoCoordinate  vehicleCoordinate   = _vehicle->coordinate();
+    double          vehicleAltitude     = _vehicle->altitudeAMSL()->rawValue().toDouble();
+
+    manager.adsbVehicleUpdate(_vehicleInfo(1, vehicleCoordinate.atDistanceAndAzimuth(1000, 0), vehicleAltitude));
+    manager.adsbVehicleUpdate(_vehicleInfo(2, vehicleCoordinate.atDistanceAndAzimuth(5000, 90), vehicleAltitude));
+    manager.adsbVehicleUpdate(_vehicleInfo(3, vehicleCoordinate.atDistanceAndAzimuth(1000, 180), vehicleAltitude + 1000));
+    QCOMPARE(manager.adsbVehicles()->count(), 3);
+
+    QCOMPARE(manager.adsbVehiclesInConflict(2000, 300).count(), 1);
+
+    manager._cleanupStaleVehicles();
+    ADSBVehicle* adsbVehicle = manager._adsbICAOMap.value(1, nullptr);
+    QVERIFY(adsbVehicle);
+    QVERIFY(adsbVehicle->alert());
+    QVERIFY(!manager._adsbICAOMap.value(2)->alert());
+    QVERIFY(!manager._adsbICAOMap.value(3)->alert());
+
+    // Moving out of range clears the alert
+    QSignalSpy alertSpy(adsbVehicle, &ADSBVehicle::alertChanged);
+    manager.adsbVehicleUpdate(_vehicleInfo(1, vehicleCoordinate.atDistanceAndAzimuth(5000, 0), vehicleAltitude));
+    manager._cleanupStaleVehicles();
+    QVERIFY(!adsbVehicle->alert());
+    QCOMPARE(alertSpy.count(), 1);
+
+    _disconnectMockLink();
+}
@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "ADSBVehicle.h"
+
+class ADSBSpatialIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _query_test        (void);
+    void _antimeridian_test (void);
+    void _pole_test         (void);
+    void _vertical_test     (void);
+    void _move_test         (void);
+    void _expiry_test       (void);
+    void _conflict_test     (void);
+
+private:
+    ADSBVehicle::VehicleInfo_t _vehicleInfo(uint32_t icaoAddress, const QGeoCoordinate& coordinate, double altitude);
+
+    static QList<uint32_t> _sorted(QList<uint32_t> icaoAddresses);
+};
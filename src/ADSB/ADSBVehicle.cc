@@ -19,6 +19,7 @@ ADSBVehicle::ADSBVehicle(const VehicleInfo_t& vehicleInfo, QObject* parent)
     , _altitude     (qQNaN())
     , _heading      (qQNaN())
     , _alert        (false)
+    , _proximityAlert(false)
 {
     update(vehicleInfo);
 }
@@ -55,13 +56,27 @@ void ADSBVehicle::update(const VehicleInfo_t& vehicleInfo)
     }
     if (vehicleInfo.availableFlags & AlertAvailable) {
         if (vehicleInfo.alert != _alert) {
+            bool oldAlert = alert();
             _alert = vehicleInfo.alert;
-            emit alertChanged();
+            if (alert() != oldAlert) {
+                emit alertChanged();
+            }
         }
     }
     _lastUpdateTimer.restart();
 }
 
+void ADSBVehicle::setProximityAlert(bool proximityAlert)
+{
+    if (proximityAlert != _proximityAlert) {
+        bool oldAlert = alert();
+        _proximityAlert = proximityAlert;
+        if (alert() != oldAlert) {
+            emit alertChanged();
+        }
+    }
+}
+
 bool ADSBVehicle::expired()
 {
     return _lastUpdateTimer.hasExpired(expirationTimeoutMs);
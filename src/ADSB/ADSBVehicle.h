@@ -45,20 +45,26 @@ public:
     Q_PROPERTY(QGeoCoordinate   coordinate  READ coordinate     NOTIFY coordinateChanged)
     Q_PROPERTY(double           altitude    READ altitude       NOTIFY altitudeChanged)     // NaN for not available
     Q_PROPERTY(double           heading     READ heading        NOTIFY headingChanged)      // NaN for not available
-    Q_PROPERTY(bool             alert       READ alert          NOTIFY alertChanged)        // Collision path
+    Q_PROPERTY(bool             alert       READ alert          NOTIFY alertChanged)        // Collision path, or too close to one of our vehicles
 
     int             icaoAddress (void) const { return static_cast<int>(_icaoAddress); }
     QString         callsign    (void) const { return _callsign; }
     QGeoCoordinate  coordinate  (void) const { return _coordinate; }
     double          altitude    (void) const { return _altitude; }
     double          heading     (void) const { return _heading; }
-    bool            alert       (void) const { return _alert; }
+    bool            alert       (void) const { return _alert || _proximityAlert; }
 
     void update(const VehicleInfo_t& vehicleInfo);
 
+    /// Set by ADSBVehicleManager while the vehicle is within conflict range of one of our vehicles
+    void setProximityAlert(bool proximityAlert);
+
     /// check if the vehicle is expired and should be removed
     bool expired();
 
+    static constexpr qint64 expirationTimeoutMs = 120000;   ///< timeout with no update in ms after which the vehicle is removed.
+                                                            ///< AirMap sends updates for each vehicle every second.
+
 signals:
     void coordinateChanged  ();
     void callsignChanged    ();
@@ -73,11 +79,9 @@ private:
     double          _altitude;
     double          _heading;
     bool            _alert;
+    bool            _proximityAlert;
 
     QElapsedTimer   _lastUpdateTimer;
-
-    static constexpr qint64 expirationTimeoutMs = 120000;   ///< timeout with no update in ms after which the vehicle is removed.
-                                                            ///< AirMap sends updates for each vehicle every second.
 };
 
 Q_DECLARE_METATYPE(ADSBVehicle::VehicleInfo_t)
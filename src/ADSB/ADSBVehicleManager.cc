@@ -12,11 +12,14 @@
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 #include "ADSBVehicleManagerSettings.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
 
 #include <QDebug>
 
 ADSBVehicleManager::ADSBVehicleManager(QGCApplication* app, QGCToolbox* toolbox)
-    : QGCTool(app, toolbox)
+    : QGCTool       (app, toolbox)
+    , _expiryWheel  (_expiryWheelSlots)
 {
 }
 
@@ -26,7 +29,7 @@ void ADSBVehicleManager::setToolbox(QGCToolbox* toolbox)
 
     connect(&_adsbVehicleCleanupTimer, &QTimer::timeout, this, &ADSBVehicleManager::_cleanupStaleVehicles);
     _adsbVehicleCleanupTimer.setSingleShot(false);
-    _adsbVehicleCleanupTimer.start(1000);
+    _adsbVehicleCleanupTimer.start(_expiryTickMSecs);
 
     ADSBVehicleManagerSettings* settings = qgcApp()->toolbox()->settingsManager()->adsbVehicleManagerSettings();
     if (settings->adsbServerConnectEnabled()->rawValue().toBool()) {
@@ -36,33 +39,130 @@ void ADSBVehicleManager::setToolbox(QGCToolbox* toolbox)
     }
 }
 
+void ADSBVehicleManager::_scheduleExpiry(uint32_t icaoAddress, int ticks)
+{
+    int slot = (_expiryTick + ticks) % _expiryWheelSlots;
+
+    auto iter = _expirySlots.find(icaoAddress);
+    if (iter != _expirySlots.end()) {
+        if (iter.value() == slot) {
+            return;
+        }
+        _expiryWheel[iter.value()].remove(icaoAddress);
+        iter.value() = slot;
+    } else {
+        _expirySlots.insert(icaoAddress, slot);
+    }
+    _expiryWheel[slot].insert(icaoAddress);
+}
+
 void ADSBVehicleManager::_cleanupStaleVehicles()
 {
-    // Remove all expired ADSB vehicles
-    for (int i=_adsbVehicles.count()-1; i>=0; i--) {
-        ADSBVehicle* adsbVehicle = _adsbVehicles.value<ADSBVehicle*>(i);
-        if (adsbVehicle->expired()) {
-            qCDebug(ADSBVehicleManagerLog) << "Expired" << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
-            _adsbVehicles.removeAt(i);
-            _adsbICAOMap.remove(adsbVehicle->icaoAddress());
-            adsbVehicle->deleteLater();
+    // Only the vehicles due on this tick are looked at
+    _expiryTick = (_expiryTick + 1) % _expiryWheelSlots;
+    QSet<uint32_t> dueIcaoAddresses;
+    dueIcaoAddresses.swap(_expiryWheel[_expiryTick]);
+
+    for (uint32_t icaoAddress: dueIcaoAddresses) {
+        _expirySlots.remove(icaoAddress);
+
+        ADSBVehicle* adsbVehicle = _adsbICAOMap.value(icaoAddress, nullptr);
+        if (!adsbVehicle) {
+            continue;
+        }
+        if (!adsbVehicle->expired()) {
+            // Tick came in a little early
+            _scheduleExpiry(icaoAddress, 1);
+            continue;
+        }
+
+        qCDebug(ADSBVehicleManagerLog) << "Expired" << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
+        _adsbVehicles.removeOne(adsbVehicle);
+        _adsbICAOMap.remove(icaoAddress);
+        _spatialIndex.remove(icaoAddress);
+        adsbVehicle->deleteLater();
+    }
+
+    _updateConflicts();
+}
+
+void ADSBVehicleManager::_updateConflicts(void)
+{
+    QSet<uint32_t> conflictIcaoAddresses;
+
+    for (ADSBVehicle* adsbVehicle: adsbVehiclesInConflict(_conflictHorizontalMeters, _conflictVerticalMeters)) {
+        conflictIcaoAddresses.insert(static_cast<uint32_t>(adsbVehicle->icaoAddress()));
+        adsbVehicle->setProximityAlert(true);
+    }
+
+    // Clear the alert on aircraft which have moved out of range
+    for (uint32_t icaoAddress: _conflictIcaoAddresses) {
+        if (!conflictIcaoAddresses.contains(icaoAddress)) {
+            ADSBVehicle* adsbVehicle = _adsbICAOMap.value(icaoAddress, nullptr);
+            if (adsbVehicle) {
+                adsbVehicle->setProximityAlert(false);
+            }
         }
     }
+
+    _conflictIcaoAddresses.swap(conflictIcaoAddresses);
 }
 
 void ADSBVehicleManager::adsbVehicleUpdate(const ADSBVehicle::VehicleInfo_t vehicleInfo)
 {
-    uint32_t icaoAddress = vehicleInfo.icaoAddress;
+    uint32_t        icaoAddress = vehicleInfo.icaoAddress;
+    ADSBVehicle*    adsbVehicle = _adsbICAOMap.value(icaoAddress, nullptr);
 
-    if (_adsbICAOMap.contains(icaoAddress)) {
-        _adsbICAOMap[icaoAddress]->update(vehicleInfo);
+    if (adsbVehicle) {
+        adsbVehicle->update(vehicleInfo);
     } else {
         if (vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable) {
-            ADSBVehicle* adsbVehicle = new ADSBVehicle(vehicleInfo, this);
+            adsbVehicle = new ADSBVehicle(vehicleInfo, this);
             _adsbICAOMap[icaoAddress] = adsbVehicle;
             _adsbVehicles.append(adsbVehicle);
+        } else {
+            return;
+        }
+    }
+
+    if (vehicleInfo.availableFlags & (ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable)) {
+        _spatialIndex.update(icaoAddress, adsbVehicle->coordinate(), adsbVehicle->altitude());
+    }
+    _scheduleExpiry(icaoAddress, _expiryTicks);
+}
+
+QList<ADSBVehicle*> ADSBVehicleManager::adsbVehiclesNear(const QGeoCoordinate& coordinate, double altitudeAMSL, double horizontalMeters, double verticalMeters) const
+{
+    QList<ADSBVehicle*> adsbVehicles;
+
+    for (uint32_t icaoAddress: _spatialIndex.query(coordinate, altitudeAMSL, horizontalMeters, verticalMeters)) {
+        ADSBVehicle* adsbVehicle = _adsbICAOMap.value(icaoAddress, nullptr);
+        if (adsbVehicle) {
+            adsbVehicles.append(adsbVehicle);
         }
     }
+
+    return adsbVehicles;
+}
+
+QList<ADSBVehicle*> ADSBVehicleManager::adsbVehiclesInConflict(double horizontalMeters, double verticalMeters) const
+{
+    QList<ADSBVehicle*>     adsbVehicles;
+    QmlObjectListModel*     vehicles = _toolbox->multiVehicleManager()->vehicles();
+
+    for (int i = 0; i < vehicles->count(); i++) {
+        Vehicle* vehicle = vehicles->value<Vehicle*>(i);
+        if (!vehicle->coordinate().isValid()) {
+            continue;
+        }
+        for (ADSBVehicle* adsbVehicle: adsbVehiclesNear(vehicle->coordinate(), vehicle->altitudeAMSL()->rawValue().toDouble(), horizontalMeters, verticalMeters)) {
+            if (!adsbVehicles.contains(adsbVehicle)) {
+                adsbVehicles.append(adsbVehicle);
+            }
+        }
+    }
+
+    return adsbVehicles;
 }
 
 void ADSBVehicleManager::_tcpError(const QString errorMsg)
@@ -12,11 +12,13 @@
 #include "QGCToolbox.h"
 #include "QmlObjectListModel.h"
 #include "ADSBVehicle.h"
+#include "ADSBSpatialIndex.h"
 
 #include <QThread>
 #include <QTcpSocket>
 #include <QTimer>
 #include <QGeoCoordinate>
+#include <QVector>
 
 class ADSBVehicleManagerSettings;
 
@@ -49,7 +51,9 @@ private:
 
 class ADSBVehicleManager : public QGCTool {
     Q_OBJECT
-    
+
+    friend class ADSBSpatialIndexTest;
+
 public:
     ADSBVehicleManager(QGCApplication* app, QGCToolbox* toolbox);
 
@@ -57,6 +61,13 @@ public:
 
     QmlObjectListModel* adsbVehicles(void) { return &_adsbVehicles; }
 
+    /// @return ADS-B vehicles within horizontalMeters and verticalMeters of the specified position. The vertical
+    ///         check is skipped when either altitude is not known (NaN).
+    QList<ADSBVehicle*> adsbVehiclesNear(const QGeoCoordinate& coordinate, double altitudeAMSL, double horizontalMeters, double verticalMeters) const;
+
+    /// @return ADS-B vehicles within range of any of our vehicles
+    QList<ADSBVehicle*> adsbVehiclesInConflict(double horizontalMeters, double verticalMeters) const;
+
     // QGCTool overrides
     void setToolbox(QGCToolbox* toolbox) final;
 
@@ -68,8 +79,26 @@ private slots:
     void _cleanupStaleVehicles(void);
 
 private:
+    void _scheduleExpiry(uint32_t icaoAddress, int ticks);
+    void _updateConflicts(void);
+
+    // Expiry is a timer wheel with a slot per cleanup tick. Every update moves the vehicle to the slot for the tick it
+    // would time out on, so each tick only looks at the vehicles which are due rather than at all of them.
+    static const int _expiryTickMSecs   = 1000;
+    static const int _expiryTicks       = static_cast<int>(ADSBVehicle::expirationTimeoutMs / _expiryTickMSecs) + 1;
+    static const int _expiryWheelSlots  = _expiryTicks + 1;
+
+    // Aircraft within this range of one of our vehicles are shown as an alert
+    static constexpr double _conflictHorizontalMeters   = 2000;
+    static constexpr double _conflictVerticalMeters     = 300;
+
     QmlObjectListModel              _adsbVehicles;
     QMap<uint32_t, ADSBVehicle*>    _adsbICAOMap;
+    ADSBSpatialIndex                _spatialIndex;
+    QVector<QSet<uint32_t>>         _expiryWheel;
+    QHash<uint32_t, int>            _expirySlots;       ///< Current wheel slot for each ICAO address
+    int                             _expiryTick = 0;
+    QSet<uint32_t>                  _conflictIcaoAddresses;
     QTimer                          _adsbVehicleCleanupTimer;
     ADSBTCPLink*                    _tcpLink = nullptr;
 };
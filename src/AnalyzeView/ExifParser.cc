@@ -13,6 +13,38 @@ ExifParser::~ExifParser()
 
 }
 
+bool ExifParser::readHeader(QIODevice& image, QByteArray& header)
+{
+    // Start of image marker
+    header = image.read(2);
+    if (header.size() != 2 || static_cast<uint8_t>(header[0]) != 0xff || static_cast<uint8_t>(header[1]) != 0xd8) {
+        return false;
+    }
+
+    // Each segment is 0xff, marker, 16 bit big endian length which includes the length itself
+    while (true) {
+        QByteArray segmentHeader = image.read(4);
+        if (segmentHeader.size() != 4 || static_cast<uint8_t>(segmentHeader[0]) != 0xff) {
+            return false;
+        }
+        uint8_t marker = static_cast<uint8_t>(segmentHeader[1]);
+        int     length = qFromBigEndian<quint16>(segmentHeader.constData() + 2);
+        if (marker == 0xda || length < 2) {
+            // Start of scan, image data follows and there won't be any EXIF
+            return false;
+        }
+        QByteArray segment = image.read(length - 2);
+        if (segment.size() != length - 2) {
+            return false;
+        }
+        header.append(segmentHeader);
+        header.append(segment);
+        if (marker == 0xe1) {
+            return true;
+        }
+    }
+}
+
 double ExifParser::readTime(QByteArray& buf)
 {
     QByteArray tiffHeader("\x49\x49\x2A", 3);
@@ -59,17 +91,24 @@ double ExifParser::readTime(QByteArray& buf)
 bool ExifParser::write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag)
 {
     QByteArray app1Header("\xff\xe1", 2);
+    QByteArray tiffHeader("\x49\x49\x2A", 3);
+    if (buf.indexOf(app1Header) < 0 || buf.indexOf(tiffHeader) < 0) {
+        return false;
+    }
     uint32_t app1HeaderInd = buf.indexOf(app1Header);
     uint16_t *conversionPointer = reinterpret_cast<uint16_t *>(buf.mid(app1HeaderInd + 2, 2).data());
     uint16_t app1Size = *conversionPointer;
     uint16_t app1SizeEndian = qFromBigEndian(app1Size) + 0xa5;  // change wrong endian
-    QByteArray tiffHeader("\x49\x49\x2A", 3);
     uint32_t tiffHeaderInd = buf.indexOf(tiffHeader);
     conversionPointer = reinterpret_cast<uint16_t *>(buf.mid(tiffHeaderInd + 8, 2).data());
     uint16_t numberOfTiffFields  = *conversionPointer;
     uint32_t nextIfdOffsetInd = tiffHeaderInd + 10 + 12 * (numberOfTiffFields);
     conversionPointer = reinterpret_cast<uint16_t *>(buf.mid(nextIfdOffsetInd, 2).data());
     uint16_t nextIfdOffset = *conversionPointer;
+    // Everything patched below has to be inside the buffer, which may only hold the header
+    if (nextIfdOffsetInd + 16 > static_cast<uint32_t>(buf.size()) || tiffHeaderInd + nextIfdOffset > static_cast<uint32_t>(buf.size())) {
+        return false;
+    }
 
     // Definition of useful unions and structs
     union char2uint32_u {
@@ -3,6 +3,7 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QIODevice>
 
 #include "GeoTagController.h"
 
@@ -11,6 +12,12 @@ class ExifParser
 public:
     ExifParser();
     ~ExifParser();
+
+    /// Reads the JPEG segments up to and including the EXIF (APP1) segment. This is all readTime and write need, so the
+    /// image data itself never has to be loaded.
+    ///     @return false: not a JPEG or no EXIF segment found
+    static bool readHeader(QIODevice& image, QByteArray& header);
+
     double readTime(QByteArray& buf);
     bool write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag);
 };
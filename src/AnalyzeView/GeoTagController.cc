@@ -15,6 +15,7 @@
 #include <cfloat>
 #include <QDir>
 #include <QUrl>
+#include <QtConcurrent>
 
 #include "ExifParser.h"
 #include "ULogParser.h"
@@ -160,38 +161,33 @@ void GeoTagWorker::run()
     }
     emit progressChanged((100/nSteps));
 
-    // Parse EXIF
-    ExifParser exifParser;
+    // Parse EXIF. Images are spread over the thread pool, and only the JPEG header of each is read.
+    QVector<ImageJob_t> jobs(_imageList.count());
+    for (int i = 0; i < _imageList.count(); ++i) {
+        jobs[i].imagePath = _imageList.at(i).absoluteFilePath();
+    }
+    QFuture<void> future = QtConcurrent::map(jobs, _readImageTime);
+    if (!_waitForJobs(future, (100/nSteps), (100/nSteps))) {
+        qCDebug(GeotaggingLog) << "Tagging cancelled";
+        emit error(tr("Tagging cancelled"));
+        return;
+    }
     _imageTime.clear();
-    for (int i = 0; i < _imageList.size(); ++i) {
-        QFile file(_imageList.at(i).absoluteFilePath());
-        if (!file.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
-        }
-        QByteArray imageBuffer = file.readAll();
-        file.close();
-
-        _imageTime.append(exifParser.readTime(imageBuffer));
-
-        emit progressChanged((100/nSteps) + ((100/nSteps) / _imageList.size())*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
+    for (const ImageJob_t& job: jobs) {
+        if (!job.error.isEmpty()) {
+            emit error(job.error);
             return;
         }
+        _imageTime.append(job.time);
     }
 
-    // Load log
+    // Load log, the parsers read it a chunk at a time
     bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
     QFile file(_logFile);
     if (!file.open(QIODevice::ReadOnly)) {
         emit error(tr("Geotagging failed. Couldn't open log file."));
         return;
     }
-    QByteArray log = file.readAll();
-    file.close();
 
     // Instantiate appropriate parser
     _triggerList.clear();
@@ -199,13 +195,14 @@ void GeoTagWorker::run()
     QString errorString;
     if (isULog) {
         ULogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList, errorString);
+        parseComplete = parser.getTagsFromLog(file, _triggerList, errorString);
 
     } else {
         PX4LogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList);
+        parseComplete = parser.getTagsFromLog(file, _triggerList);
 
     }
+    file.close();
 
     if (!parseComplete) {
         if (_cancel) {
@@ -246,42 +243,32 @@ void GeoTagWorker::run()
     // Tag images
     int maxIndex = std::min(_imageIndices.count(), _triggerIndices.count());
     maxIndex = std::min(maxIndex, _imageList.count());
+    jobs.resize(maxIndex);
     for(int i = 0; i < maxIndex; i++) {
         int imageIndex = _imageIndices[i];
         if (imageIndex >= _imageList.count()) {
             emit error(tr("Geotagging failed. Requesting image #%1, but only %2 images present.").arg(imageIndex).arg(_imageList.count()));
             return;
         }
-        QFile fileRead(_imageList.at(_imageIndices[i]).absoluteFilePath());
-        if (!fileRead.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
-        }
-        QByteArray imageBuffer = fileRead.readAll();
-        fileRead.close();
-
-        if (!exifParser.write(imageBuffer, _triggerList[_triggerIndices[i]])) {
-            emit error(tr("Geotagging failed. Couldn't write to image."));
-            return;
+        ImageJob_t& job = jobs[i];
+        job.imagePath   = _imageList.at(imageIndex).absoluteFilePath();
+        job.geotag      = _triggerList[_triggerIndices[i]];
+        job.error.clear();
+        if(_saveDirectory == "") {
+            job.savePath = _imageDirectory + "/TAGGED/" + _imageList.at(imageIndex).fileName();
         } else {
-            QFile fileWrite;
-            if(_saveDirectory == "") {
-                fileWrite.setFileName(_imageDirectory + "/TAGGED/" + _imageList.at(_imageIndices[i]).fileName());
-            } else {
-                fileWrite.setFileName(_saveDirectory + "/" + _imageList.at(_imageIndices[i]).fileName());
-            }
-            if (!fileWrite.open(QFile::WriteOnly)) {
-                emit error(tr("Geotagging failed. Couldn't write to an image."));
-                return;
-            }
-            fileWrite.write(imageBuffer);
-            fileWrite.close();
+            job.savePath = _saveDirectory + "/" + _imageList.at(imageIndex).fileName();
         }
-        emit progressChanged(4*(100/nSteps) + ((100/nSteps) / maxIndex)*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
+    }
+    future = QtConcurrent::map(jobs, _tagImage);
+    if (!_waitForJobs(future, 4*(100/nSteps), (100/nSteps))) {
+        qCDebug(GeotaggingLog) << "Tagging cancelled";
+        emit error(tr("Tagging cancelled"));
+        return;
+    }
+    for (const ImageJob_t& job: jobs) {
+        if (!job.error.isEmpty()) {
+            emit error(job.error);
             return;
         }
     }
@@ -295,6 +282,68 @@ void GeoTagWorker::run()
     emit progressChanged(100);
 }
 
+/// Waits for the thread pool to work through a set of images, reporting progress and passing on cancellation
+/// @return false: tagging was cancelled
+bool GeoTagWorker::_waitForJobs(QFuture<void>& future, double progressStart, double progressSpan)
+{
+    while (!future.isFinished()) {
+        if (_cancel) {
+            // Images already being processed are finished, the rest are dropped
+            future.cancel();
+        } else if (future.progressMaximum() > 0) {
+            emit progressChanged(progressStart + (progressSpan * future.progressValue()) / future.progressMaximum());
+        }
+        msleep(_progressIntervalMSecs);
+    }
+    future.waitForFinished();
+    return !_cancel;
+}
+
+void GeoTagWorker::_readImageTime(ImageJob_t& job)
+{
+    QFile file(job.imagePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        job.error = tr("Geotagging failed. Couldn't open an image.");
+        return;
+    }
+    QByteArray header;
+    if (!ExifParser::readHeader(file, header)) {
+        qCWarning(GeotaggingLog) << "No EXIF data found" << job.imagePath;
+        job.time = -1.0;
+        return;
+    }
+    job.time = ExifParser().readTime(header);
+}
+
+/// Writes a tagged copy of the image. Only the EXIF header is patched in memory, the image data is copied through a
+/// chunk at a time.
+void GeoTagWorker::_tagImage(ImageJob_t& job)
+{
+    QFile fileRead(job.imagePath);
+    if (!fileRead.open(QIODevice::ReadOnly)) {
+        job.error = tr("Geotagging failed. Couldn't open an image.");
+        return;
+    }
+    QByteArray header;
+    if (!ExifParser::readHeader(fileRead, header) || !ExifParser().write(header, job.geotag)) {
+        job.error = tr("Geotagging failed. Couldn't write to image.");
+        return;
+    }
+
+    QFile fileWrite(job.savePath);
+    if (!fileWrite.open(QFile::WriteOnly) || fileWrite.write(header) != header.size()) {
+        job.error = tr("Geotagging failed. Couldn't write to an image.");
+        return;
+    }
+    while (!fileRead.atEnd()) {
+        QByteArray chunk = fileRead.read(_copyChunkBytes);
+        if (chunk.isEmpty() || fileWrite.write(chunk) != chunk.size()) {
+            job.error = tr("Geotagging failed. Couldn't write to an image.");
+            return;
+        }
+    }
+}
+
 bool GeoTagWorker::triggerFiltering()
 {
     _imageIndices.clear();
@@ -18,6 +18,7 @@
 #include <QThread>
 #include <QFileInfoList>
 #include <QElapsedTimer>
+#include <QFuture>
 #include <QDebug>
 #include <QGeoCoordinate>
 
@@ -59,7 +60,23 @@ signals:
     void progressChanged    (double progress);
 
 private:
+    /// One image to be processed on the thread pool
+    typedef struct {
+        QString                 imagePath;
+        QString                 savePath;
+        cameraFeedbackPacket    geotag;
+        double                  time;
+        QString                 error;      ///< Set if processing the image failed
+    } ImageJob_t;
+
     bool triggerFiltering();
+    bool _waitForJobs(QFuture<void>& future, double progressStart, double progressSpan);
+
+    static void _readImageTime  (ImageJob_t& job);
+    static void _tagImage       (ImageJob_t& job);
+
+    static const int            _copyChunkBytes         = 1024 * 1024;
+    static const unsigned long  _progressIntervalMSecs  = 100;
 
     bool                    _cancel;
     QString                 _logFile;
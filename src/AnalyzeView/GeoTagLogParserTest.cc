@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoTagLogParserTest.h"
+#include "LogBufferedReader.h"
+#include "ULogParser.h"
+#include "PX4LogParser.h"
+
+#include <QBuffer>
+
+void GeoTagLogParserTest::_bufferedReader_test(void)
+{
+    QByteArray bytes;
+    for (int i = 0; i < 100; i++) {
+        bytes.append(static_cast<char>(i));
+    }
+    QBuffer log(&bytes);
+    QVERIFY(log.open(QIODevice::ReadOnly));
+
+    // Reads smaller than the requests force messages to be assembled across chunks
+    LogBufferedReader reader(log, 7);
+    int position = 0;
+    for (int length: { 3, 10, 1, 25, 7, 30 }) {
+        QVERIFY(reader.fill(length));
+        QCOMPARE(QByteArray(reader.data(), length), bytes.mid(position, length));
+        reader.skip(length);
+        position += length;
+    }
+
+    // 24 bytes are left
+    QVERIFY(reader.fill(24));
+    QCOMPARE(QByteArray(reader.data(), 24), bytes.mid(position));
+    QVERIFY(!reader.fill(25));
+}
+
+void GeoTagLogParserTest::_ulog_test(void)
+{
+    QFile log(QStringLiteral(":/unittest/GeoTagTest.ulg"));
+    QVERIFY(log.open(QIODevice::ReadOnly));
+
+    // The fixture has three camera_capture messages among other messages, followed by a truncated message
+    ULogParser                                  parser;
+    QList<GeoTagWorker::cameraFeedbackPacket>   cameraFeedback;
+    QString                                     errorMessage;
+    QVERIFY2(parser.getTagsFromLog(log, cameraFeedback, errorMessage), qPrintable(errorMessage));
+    QCOMPARE(cameraFeedback.count(), 3);
+
+    for (int i = 0; i < cameraFeedback.count(); i++) {
+        const GeoTagWorker::cameraFeedbackPacket& feedback = cameraFeedback[i];
+        uint32_t sequence = static_cast<uint32_t>(i + 1);
+
+        QCOMPARE(feedback.imageSequence, sequence);
+        QCOMPARE(feedback.timestamp, 10.0 + sequence);
+        QCOMPARE(feedback.timestampUTC, 1600000000.0 + sequence);
+        QCOMPARE(feedback.latitude, 47.1 + sequence * 0.001);
+        QVERIFY(qAbs(feedback.longitude - (8.5 + sequence * 0.001)) < 1.0e-9);
+        QCOMPARE(feedback.altitude, 500.0f + sequence);
+        QCOMPARE(feedback.groundDistance, 20.0f + sequence);
+        QCOMPARE(feedback.captureResult, static_cast<uint8_t>(1));
+    }
+}
+
+void GeoTagLogParserTest::_ulogBadHeader_test(void)
+{
+    QFile log(QStringLiteral(":/unittest/GeoTagTest.px4log"));
+    QVERIFY(log.open(QIODevice::ReadOnly));
+
+    ULogParser                                  parser;
+    QList<GeoTagWorker::cameraFeedbackPacket>   cameraFeedback;
+    QString                                     errorMessage;
+    QVERIFY(!parser.getTagsFromLog(log, cameraFeedback, errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+    QCOMPARE(cameraFeedback.count(), 0);
+}
+
+void GeoTagLogParserTest::_px4log_test(void)
+{
+    QFile log(QStringLiteral(":/unittest/GeoTagTest.px4log"));
+    QVERIFY(log.open(QIODevice::ReadOnly));
+
+    // The fixture has some garbage to resync over and a position before the first trigger which is ignored. Triggers 1
+    // and 2 are each followed by a position, the last trigger has no position after it.
+    PX4LogParser                                parser;
+    QList<GeoTagWorker::cameraFeedbackPacket>   cameraFeedback;
+    QVERIFY(parser.getTagsFromLog(log, cameraFeedback));
+    QCOMPARE(cameraFeedback.count(), 3);
+
+    for (int i = 0; i < cameraFeedback.count(); i++) {
+        const GeoTagWorker::cameraFeedbackPacket& feedback = cameraFeedback[i];
+        uint32_t sequence = static_cast<uint32_t>(i + 1);
+
+        QCOMPARE(feedback.imageSequence, sequence);
+        QCOMPARE(feedback.timestamp, 10.0 + sequence);
+        if (sequence < 3) {
+            QVERIFY(qAbs(feedback.latitude - (47.1 + sequence * 0.001)) < 1.0e-7);
+            QVERIFY(qAbs(feedback.longitude - (8.5 + sequence * 0.001)) < 1.0e-7);
+            QCOMPARE(feedback.altitude, 500.0f + sequence);
+        } else {
+            QCOMPARE(feedback.latitude, 0.0);
+            QCOMPARE(feedback.longitude, 0.0);
+        }
+    }
+}
@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for the ULog and sdlog2 camera trigger parsers used by geotagging
+class GeoTagLogParserTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _bufferedReader_test   (void);
+    void _ulog_test             (void);
+    void _ulogBadHeader_test    (void);
+    void _px4log_test           (void);
+};
@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogBufferedReader.h"
+
+LogBufferedReader::LogBufferedReader(QIODevice& log, int readChunkBytes)
+    : _log              (log)
+    , _readChunkBytes   (readChunkBytes)
+    , _bufferIndex      (0)
+{
+
+}
+
+bool LogBufferedReader::fill(int bytes)
+{
+    if (_buffer.size() - _bufferIndex >= bytes) {
+        return true;
+    }
+
+    // Drop what has already been consumed before reading more
+    _buffer.remove(0, _bufferIndex);
+    _bufferIndex = 0;
+    while (_buffer.size() < bytes) {
+        QByteArray chunk = _log.read(qMax(_readChunkBytes, bytes - _buffer.size()));
+        if (chunk.isEmpty()) {
+            return false;
+        }
+        _buffer.append(chunk);
+    }
+
+    return true;
+}
@@ -0,0 +1,43 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+
+/// Sequential reader for the binary flight log parsers. Only a chunk of the log is held in memory at a time, while
+/// each message can still be accessed as contiguous bytes.
+class LogBufferedReader
+{
+public:
+    /// @param log Device to read from, must already be open
+    /// @param readChunkBytes Minimum number of bytes read from the device at a time
+    LogBufferedReader(QIODevice& log, int readChunkBytes = _defaultReadChunkBytes);
+
+    /// Makes sure at least the specified number of bytes are available at the current position, reading more of the
+    /// log if needed
+    /// @return false: end of log reached first
+    bool fill(int bytes);
+
+    /// @return Bytes at the current position. Only valid for the count passed to the last successful fill, and only
+    /// until the next call to fill.
+    const char* data(void) const { return _buffer.constData() + _bufferIndex; }
+
+    /// Moves the current position forward. The bytes skipped must have been made available by fill.
+    void skip(int bytes) { _bufferIndex += bytes; }
+
+private:
+    QIODevice&  _log;
+    int         _readChunkBytes;
+    QByteArray  _buffer;
+    int         _bufferIndex;
+
+    static const int _defaultReadChunkBytes = 1024 * 1024;
+};
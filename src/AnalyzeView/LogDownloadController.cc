@@ -18,6 +18,9 @@
 #include "ParameterManager.h"
 #include "Vehicle.h"
 #include "SettingsManager.h"
+#ifndef NO_SERIAL_LINK
+#include "SerialLink.h"
+#endif
 
 #include <QDebug>
 #include <QSettings>
@@ -29,14 +32,24 @@
 #define kGUIRateMilliseconds 17
 #define kTableBins           512
 #define kChunkSize           (kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)
+#define kWindowChunks        4
+#define kLogDataFrameBytes   (MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_MSG_ID_LOG_DATA_LEN)
 
 QGC_LOGGING_CATEGORY(LogDownloadLog, "LogDownloadLog")
 
 //-----------------------------------------------------------------------------
+// Data is requested for a window of kWindowChunks chunks at a time, so the vehicle keeps streaming while earlier
+// chunks are still being completed. Bins which arrive out of order are kept in the chunk's buffer. Each chunk is
+// written to the file with a single write once all of its bins are in.
 struct LogDownloadData {
     LogDownloadData(QGCLogEntry* entry);
-    QBitArray     chunk_table;
-    uint32_t      current_chunk;
+    QBitArray     chunk_tables[kWindowChunks];  ///< Received bins for each chunk in the window, indexed by chunk % kWindowChunks
+    QByteArray    chunk_buffers[kWindowChunks]; ///< Data for each chunk in the window
+    uint32_t      current_chunk;                ///< First chunk in the window, all chunks before it are written
+    uint32_t      stream_offset;                ///< Offset following the highest data received so far
+    uint32_t      request_offset;               ///< Outstanding request
+    uint32_t      request_end;
+    bool          repairing;                    ///< true: outstanding request is filling a gap, not streaming
     QFile         file;
     QString       filename;
     uint          ID;
@@ -44,19 +57,21 @@ struct LogDownloadData {
     uint          written;
     size_t        rate_bytes;
     qreal         rate_avg;
+    qreal         link_rate;                    ///< Theoretical LOG_DATA payload bytes/sec of the link, 0 if not known
     QElapsedTimer elapsed;
+    QElapsedTimer total_elapsed;
 
-    void advanceChunk()
+    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the chunk
+    uint32_t chunkBins(uint32_t chunk) const
     {
-           current_chunk++;
-           chunk_table = QBitArray(chunkBins(), false);
+        return qMin(qCeil((entry->size() - chunk*kChunkSize)/static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)),
+                    kTableBins);
     }
 
-    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the current chunk
-    uint32_t chunkBins() const
+    // The number of bytes in the chunk
+    uint32_t chunkBytes(uint32_t chunk) const
     {
-        return qMin(qCeil((entry->size() - current_chunk*kChunkSize)/static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)),
-                    kTableBins);
+        return qMin(entry->size() - chunk*kChunkSize, static_cast<uint>(kChunkSize));
     }
 
     // The number of kChunkSize chunks in the file
@@ -65,21 +80,49 @@ struct LogDownloadData {
         return qCeil(entry->size() / static_cast<qreal>(kChunkSize));
     }
 
-    // True if all bins in the chunk have been set to val
-    bool chunkEquals(const bool val) const
+    // One past the last chunk in the window
+    uint32_t windowEndChunk() const
+    {
+        return qMin(current_chunk + kWindowChunks, numChunks());
+    }
+
+    // One past the last byte in the window
+    uint32_t windowEndOffset() const
+    {
+        return qMin(windowEndChunk() * kChunkSize, entry->size());
+    }
+
+    QBitArray&  chunkTable  (uint32_t chunk) { return chunk_tables[chunk % kWindowChunks]; }
+    QByteArray& chunkBuffer (uint32_t chunk) { return chunk_buffers[chunk % kWindowChunks]; }
+
+    // Sets up the table and buffer for a chunk which just moved into the window
+    void initChunk(uint32_t chunk)
     {
-        return chunk_table == QBitArray(chunk_table.size(), val);
+        chunkTable(chunk) = QBitArray(chunkBins(chunk), false);
+        chunkBuffer(chunk).resize(chunkBytes(chunk));
     }
 
+    // True if all bins in the chunk have been received
+    bool chunkComplete(uint32_t chunk)
+    {
+        const QBitArray& table = chunkTable(chunk);
+        return table.count(true) == table.size();
+    }
 };
 
 //----------------------------------------------------------------------------------------
 LogDownloadData::LogDownloadData(QGCLogEntry* entry_)
-    : ID(entry_->id())
+    : current_chunk(0)
+    , stream_offset(0)
+    , request_offset(0)
+    , request_end(0)
+    , repairing(false)
+    , ID(entry_->id())
     , entry(entry_)
     , written(0)
     , rate_bytes(0)
     , rate_avg(0)
+    , link_rate(0)
 {
 
 }
@@ -302,14 +345,35 @@ void LogDownloadController::_updateDataRate(void)
         _downloadData->rate_bytes = 0;
 
         //-- Update status
-        const QString status = QString("%1 (%2/s)").arg(QGCMapEngine::bigSizeToString(_downloadData->written),
-                                                        QGCMapEngine::bigSizeToString(_downloadData->rate_avg));
+        QString status;
+        if (_downloadData->link_rate > 0) {
+            status = QString("%1 (%2/s of %3/s)").arg(QGCMapEngine::bigSizeToString(_downloadData->written),
+                                                      QGCMapEngine::bigSizeToString(_downloadData->rate_avg),
+                                                      QGCMapEngine::bigSizeToString(_downloadData->link_rate));
+        } else {
+            status = QString("%1 (%2/s)").arg(QGCMapEngine::bigSizeToString(_downloadData->written),
+                                              QGCMapEngine::bigSizeToString(_downloadData->rate_avg));
+        }
 
         _downloadData->entry->setStatus(status);
         _downloadData->elapsed.start();
     }
 }
 
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_logThroughput()
+{
+    qreal seconds = _downloadData->total_elapsed.elapsed() / 1000.0;
+    qreal achieved = seconds > 0 ? _downloadData->written / seconds : 0;
+    QString linkName = _vehicle && _vehicle->priorityLink() ? _vehicle->priorityLink()->getName() : QString();
+    if (_downloadData->link_rate > 0) {
+        qCDebug(LogDownloadLog) << "Log" << _downloadData->ID << "downloaded on" << linkName << "achieved:theoretical bytes/sec" << achieved << _downloadData->link_rate
+                                << QString("(%1%)").arg(achieved * 100.0 / _downloadData->link_rate, 0, 'f', 1);
+    } else {
+        qCDebug(LogDownloadLog) << "Log" << _downloadData->ID << "downloaded on" << linkName << "achieved bytes/sec" << achieved;
+    }
+}
 
 //----------------------------------------------------------------------------------------
 void
@@ -330,75 +394,102 @@ LogDownloadController::_logData(UASInterface* uas, uint32_t ofs, uint16_t id, ui
         return;
     }
 
-    bool result = false;
-    uint32_t timeout_time = kTimeOutMilliseconds;
-    if(ofs <= _downloadData->entry->size()) {
-        const uint32_t chunk = ofs / kChunkSize;
-        if (chunk != _downloadData->current_chunk) {
-            qWarning() << "Ignored packet for out of order chunk actual:expected" << chunk << _downloadData->current_chunk;
+    if(ofs > _downloadData->entry->size()) {
+        qWarning() << "Received log offset greater than expected";
+        _downloadData->entry->setStatus(tr("Error"));
+        return;
+    }
+
+    const uint32_t chunk = ofs / kChunkSize;
+    if (chunk < _downloadData->current_chunk || chunk >= _downloadData->windowEndChunk()) {
+        // Already written, or left over from a request which has been replaced since
+        qCDebug(LogDownloadLog) << "Ignored packet outside of window ofs:firstChunk:endChunk" << ofs << _downloadData->current_chunk << _downloadData->windowEndChunk();
+        return;
+    }
+
+    QBitArray&      table   = _downloadData->chunkTable(chunk);
+    QByteArray&     buffer  = _downloadData->chunkBuffer(chunk);
+    const uint16_t  bin     = (ofs - chunk*kChunkSize) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    if (bin >= table.size()) {
+        qWarning() << "Out of range bin received";
+        return;
+    }
+
+    //-- Buffer the data, the chunk is written to the file once it is complete
+    if (!table.testBit(bin)) {
+        const uint32_t bufferOffset = bin * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+        const uint32_t bytes        = qMin(static_cast<uint32_t>(count), buffer.size() - bufferOffset);
+        memcpy(buffer.data() + bufferOffset, data, bytes);
+        table.setBit(bin);
+        _downloadData->written      += bytes;
+        _downloadData->rate_bytes   += bytes;
+    }
+    _downloadData->stream_offset = qMax(_downloadData->stream_offset, ofs + count);
+    _updateDataRate();
+    //-- reset retries
+    _retries = 0;
+    //-- Reset timer
+    _timer.start(kTimeOutMilliseconds);
+
+    //-- Write out completed chunks at the front of the window, which moves the window forward
+    bool windowMoved = false;
+    while (_downloadData->current_chunk < _downloadData->numChunks() && _downloadData->chunkComplete(_downloadData->current_chunk)) {
+        if (!_writeChunk(_downloadData->current_chunk)) {
+            _downloadData->entry->setStatus(tr("Error"));
+            _receivedAllData();
             return;
         }
-        const uint16_t bin = (ofs - chunk*kChunkSize) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-        if (bin >= _downloadData->chunk_table.size()) {
-            qWarning() << "Out of range bin received";
-        } else
-            _downloadData->chunk_table.setBit(bin);
-        if (_downloadData->file.pos() != ofs) {
-            // Seek to correct position
-            if (!_downloadData->file.seek(ofs)) {
-                qWarning() << "Error while seeking log file offset";
-                return;
-            }
-        }
-
-        //-- Write chunk to file
-        if(_downloadData->file.write((const char*)data, count)) {
-            _downloadData->written += count;
-            _downloadData->rate_bytes += count;
-            _updateDataRate();
-            result = true;
-            //-- reset retries
-            _retries = 0;
-            //-- Reset timer
-            _timer.start(timeout_time);
-            //-- Do we have it all?
-            if(_logComplete()) {
-                _downloadData->entry->setStatus(tr("Downloaded"));
-                //-- Check for more
-                _receivedAllData();
-            } else if (_chunkComplete()) {
-                _downloadData->advanceChunk();
-                _requestLogData(_downloadData->ID,
-                                _downloadData->current_chunk*kChunkSize,
-                                _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            } else if (bin < _downloadData->chunk_table.size() - 1 && _downloadData->chunk_table.at(bin+1)) {
-                // Likely to be grabbing fragments and got to the end of a gap
-                _findMissingData();
-            }
-        } else {
-            qWarning() << "Error while writing log file chunk";
+        _downloadData->current_chunk++;
+        const uint32_t newChunk = _downloadData->current_chunk + kWindowChunks - 1;
+        if (newChunk < _downloadData->numChunks()) {
+            _downloadData->initChunk(newChunk);
         }
-    } else {
-        qWarning() << "Received log offset greater than expected";
+        windowMoved = true;
     }
-    if(!result) {
-        _downloadData->entry->setStatus(tr("Error"));
+
+    //-- Do we have it all?
+    if(_logComplete()) {
+        _downloadData->entry->setStatus(tr("Downloaded"));
+        _logThroughput();
+        //-- Check for more
+        _receivedAllData();
+    } else if (ofs < _downloadData->request_end && ofs + count >= _downloadData->request_end) {
+        // The outstanding request has been delivered. Fill in any gaps, then keep streaming.
+        _requestWindowData(true /* repairGaps */);
+    } else if (windowMoved && !_downloadData->repairing &&
+               _downloadData->stream_offset + (kWindowChunks * kChunkSize) / 2 > _downloadData->request_end) {
+        // Extend the stream to the end of the window before it runs dry. A new request replaces the outstanding
+        // one, so it picks up from the last data received.
+        _requestWindowData(false /* repairGaps */);
     }
 }
 
-
 //----------------------------------------------------------------------------------------
 bool
-LogDownloadController::_chunkComplete() const
+LogDownloadController::_writeChunk(uint32_t chunk)
 {
-    return _downloadData->chunkEquals(true);
+    const QByteArray&   buffer  = _downloadData->chunkBuffer(chunk);
+    const qint64        pos     = static_cast<qint64>(chunk) * kChunkSize;
+
+    if (_downloadData->file.pos() != pos) {
+        // Seek to correct position
+        if (!_downloadData->file.seek(pos)) {
+            qWarning() << "Error while seeking log file offset";
+            return false;
+        }
+    }
+    if (_downloadData->file.write(buffer) != buffer.size()) {
+        qWarning() << "Error while writing log file chunk";
+        return false;
+    }
+    return true;
 }
 
 //----------------------------------------------------------------------------------------
 bool
 LogDownloadController::_logComplete() const
 {
-    return _chunkComplete() && (_downloadData->current_chunk+1) == _downloadData->numChunks();
+    return _downloadData->current_chunk == _downloadData->numChunks();
 }
 
 //----------------------------------------------------------------------------------------
@@ -409,7 +500,7 @@ LogDownloadController::_receivedAllData()
     //-- Anything queued up for download?
     if(_prepareLogDownload()) {
         //-- Request Log
-        _requestLogData(_downloadData->ID, 0, _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+        _requestWindowData(false /* repairGaps */);
         _timer.start(kTimeOutMilliseconds);
     } else {
         _resetSelection();
@@ -424,8 +515,6 @@ LogDownloadController::_findMissingData()
     if (_logComplete()) {
          _receivedAllData();
          return;
-    } else if (_chunkComplete()) {
-        _downloadData->advanceChunk();
     }
 
     _retries++;
@@ -442,24 +531,58 @@ LogDownloadController::_findMissingData()
 #endif
 
     _updateDataRate();
+    _requestWindowData(true /* repairGaps */);
+}
 
-    uint16_t start = 0, end = 0;
-    const int size = _downloadData->chunk_table.size();
-    for (; start < size; start++) {
-        if (!_downloadData->chunk_table.testBit(start)) {
-            break;
+//----------------------------------------------------------------------------------------
+/// Finds the first run of missing bins below the stream offset
+bool
+LogDownloadController::_findGap(uint32_t& start, uint32_t& end)
+{
+    bool found = false;
+
+    for (uint32_t chunk = _downloadData->current_chunk; chunk < _downloadData->windowEndChunk(); chunk++) {
+        const QBitArray& table = _downloadData->chunkTable(chunk);
+        for (int bin = 0; bin < table.size(); bin++) {
+            const uint32_t ofs = chunk*kChunkSize + bin*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+            if (ofs >= _downloadData->stream_offset) {
+                end = ofs;
+                return found;
+            }
+            if (!found && !table.testBit(bin)) {
+                start = ofs;
+                found = true;
+            } else if (found && table.testBit(bin)) {
+                end = ofs;
+                return true;
+            }
         }
     }
+    end = _downloadData->windowEndOffset();
+    return found;
+}
+
+//----------------------------------------------------------------------------------------
+/// Requests the first gap in the window when repairGaps is set, otherwise continues the stream from the highest
+/// data received through the end of the window
+void
+LogDownloadController::_requestWindowData(bool repairGaps)
+{
+    uint32_t start = 0, end = 0;
 
-    for (end = start; end < size; end++) {
-        if (_downloadData->chunk_table.testBit(end)) {
-            break;
+    _downloadData->repairing = repairGaps && _findGap(start, end);
+    if (!_downloadData->repairing) {
+        start   = _downloadData->stream_offset;
+        end     = _downloadData->windowEndOffset();
+        if (start >= end) {
+            // Everything in the window has been requested, wait for it to move
+            return;
         }
     }
 
-    const uint32_t pos = _downloadData->current_chunk*kChunkSize + start*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-                   len = (end - start)*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-    _requestLogData(_downloadData->ID, pos, len, _retries);
+    _downloadData->request_offset   = start;
+    _downloadData->request_end      = end;
+    _requestLogData(_downloadData->ID, start, end - start, _retries);
 }
 
 //----------------------------------------------------------------------------------------
@@ -623,9 +746,12 @@ LogDownloadController::_prepareLogDownload()
         if(!_downloadData->file.resize(entry->size())) {
             qWarning() << "Failed to allocate space for log file:" <<  _downloadData->filename;
         } else {
-            _downloadData->current_chunk = 0;
-            _downloadData->chunk_table = QBitArray(_downloadData->chunkBins(), false);
+            for (uint32_t chunk = 0; chunk < _downloadData->windowEndChunk(); chunk++) {
+                _downloadData->initChunk(chunk);
+            }
+            _downloadData->link_rate = _linkDataRate();
             _downloadData->elapsed.start();
+            _downloadData->total_elapsed.start();
             result = true;
         }
     }
@@ -640,6 +766,24 @@ LogDownloadController::_prepareLogDownload()
     return result;
 }
 
+//----------------------------------------------------------------------------------------
+/// @return Theoretical LOG_DATA payload bytes/sec for the priority link, 0 if not known
+qreal
+LogDownloadController::_linkDataRate()
+{
+#ifndef NO_SERIAL_LINK
+    SerialLink* serialLink = qobject_cast<SerialLink*>(_vehicle->priorityLink());
+    if (serialLink) {
+        SerialConfiguration* serialConfig = qobject_cast<SerialConfiguration*>(serialLink->getLinkConfiguration());
+        if (serialConfig) {
+            // 10 bits on the wire per byte, and only the payload of each LOG_DATA message is log data
+            return (serialConfig->baud() / 10.0) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN / kLogDataFrameBytes;
+        }
+    }
+#endif
+    return 0;
+}
+
 //----------------------------------------------------------------------------------------
 void
 LogDownloadController::_setDownloading(bool active)
@@ -145,8 +145,10 @@ private slots:
 
 private:
     bool _entriesComplete   ();
-    bool _chunkComplete     () const;
     bool _logComplete       () const;
+    bool _writeChunk        (uint32_t chunk);
+    bool _findGap           (uint32_t& start, uint32_t& end);
+    void _requestWindowData (bool repairGaps);
     void _findMissingEntries();
     void _receivedAllEntries();
     void _receivedAllData   ();
@@ -158,6 +160,8 @@ private:
     void _setDownloading    (bool active);
     void _setListing        (bool active);
     void _updateDataRate    ();
+    void _logThroughput     ();
+    qreal _linkDataRate     ();
 
     QGCLogEntry* _getNextSelected();
 
@@ -12,17 +12,17 @@
 #include "MockLink.h"
 
 #include <QDir>
+#include <QFileInfo>
+#include <QTemporaryDir>
 
 LogDownloadTest::LogDownloadTest(void)
 {
 
 }
 
-void LogDownloadTest::downloadTest(void)
+/// Lists the logs, downloads the first one and checks it matches the MockLink log byte for byte
+void LogDownloadTest::_downloadLog(void)
 {
-
-    _connectMockLink(MAV_AUTOPILOT_PX4);
-
     LogDownloadController* controller = new LogDownloadController();
 
     _rgLogDownloadControllerSignals[requestingListChangedSignalIndex] =     SIGNAL(requestingListChanged());
@@ -43,24 +43,65 @@ void LogDownloadTest::downloadTest(void)
 
     QGCLogModel* model = controller->model();
     QVERIFY(model);
-    qDebug() << model->count();
+    QCOMPARE(model->count(), 1);
     (*model)[0]->setSelected(true);
 
-    QString downloadTo = QDir::currentPath();
+    QTemporaryDir downloadDir;
+    QVERIFY(downloadDir.isValid());
+    QString downloadTo = downloadDir.path();
     qDebug() << "download to:" << downloadTo;
     controller->downloadToDirectory(downloadTo);
     QVERIFY(_multiSpyLogDownloadController->waitForSignalByIndex(downloadingLogsChangedSignalIndex, 10000));
     _multiSpyLogDownloadController->clearAllSignals();
     if (controller->downloadingLogs()) {
-        QVERIFY(_multiSpyLogDownloadController->waitForSignalByIndex(downloadingLogsChangedSignalIndex, 10000));
+        QVERIFY(_multiSpyLogDownloadController->waitForSignalByIndex(downloadingLogsChangedSignalIndex, 30000));
         QCOMPARE(controller->downloadingLogs(), false);
     }
     _multiSpyLogDownloadController->clearAllSignals();
 
     QString downloadFile = QDir(downloadTo).filePath("log_0_UnknownDate.ulg");
+    QCOMPARE(QFileInfo(downloadFile).size(), QFileInfo(_mockLink->logDownloadFile()).size());
     QVERIFY(UnitTest::fileCompare(downloadFile, _mockLink->logDownloadFile()));
 
-    QFile::remove(downloadFile);
-
+    delete _multiSpyLogDownloadController;
+    _multiSpyLogDownloadController = nullptr;
     delete controller;
 }
+
+void LogDownloadTest::downloadTest(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _downloadLog();
+}
+
+/// Lost LOG_DATA on either side of chunk boundaries, and at the end of the file, must be requested again and written
+/// to the right place
+void LogDownloadTest::_dropAcrossChunks_test(void)
+{
+    const uint32_t binSize      = MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    const uint32_t chunkSize    = _chunkBins * binSize;
+    const uint32_t fileSize     = (3 * chunkSize) + 1234;
+    const uint32_t lastBin      = ((fileSize - 1) / binSize) * binSize;
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadSimulation(fileSize,
+                                        { 0, chunkSize - binSize, chunkSize, chunkSize + binSize, (2 * chunkSize) - binSize, 2 * chunkSize + (10 * binSize), lastBin },
+                                        { });
+    _downloadLog();
+}
+
+/// LOG_DATA which arrives after the packet following it, including across chunk boundaries and next to a lost packet,
+/// must land in the right chunk
+void LogDownloadTest::_reorderAcrossChunks_test(void)
+{
+    const uint32_t binSize      = MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    const uint32_t chunkSize    = _chunkBins * binSize;
+    const uint32_t fileSize     = (3 * chunkSize) + 1234;
+    const uint32_t lastBin      = ((fileSize - 1) / binSize) * binSize;
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadSimulation(fileSize,
+                                        { 2 * chunkSize },
+                                        { 0, chunkSize - binSize, (2 * chunkSize) - binSize, (3 * chunkSize) - binSize, 3 * chunkSize, lastBin - binSize });
+    _downloadLog();
+}
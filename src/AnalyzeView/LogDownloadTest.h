@@ -25,8 +25,12 @@ private slots:
     //void cleanup(void) { _cleanup(); }
 
     void downloadTest(void);
+    void _dropAcrossChunks_test(void);
+    void _reorderAcrossChunks_test(void);
 
 private:
+    void _downloadLog(void);
+
     // LogDownloadController signals
 
     enum {
@@ -46,6 +50,8 @@ private:
     static const size_t _cLogDownloadControllerSignals = logDownloadControllerMaxSignalIndex;
     const char*         _rgLogDownloadControllerSignals[_cLogDownloadControllerSignals];
 
+    static const uint32_t _chunkBins = 512;    ///< LOG_DATA packets per chunk, matches LogDownloadController
+
 };
 
 #endif
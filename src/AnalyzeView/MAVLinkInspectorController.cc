@@ -10,7 +10,10 @@
 #include "MAVLinkInspectorController.h"
 #include "QGCApplication.h"
 #include "MultiVehicleManager.h"
+#include "SettingsManager.h"
+#include "AppSettings.h"
 #include <QtCharts/QLineSeries>
+#include <QDir>
 
 QGC_LOGGING_CATEGORY(MAVLinkInspectorLog, "MAVLinkInspectorLog")
 
@@ -30,6 +33,13 @@ QGCMAVLinkMessageField::QGCMAVLinkMessageField(QGCMAVLinkMessage *parent, QStrin
     qCDebug(MAVLinkInspectorLog) << "Field:" << name << type;
 }
 
+//-----------------------------------------------------------------------------
+QGCMAVLinkMessageField::~QGCMAVLinkMessageField()
+{
+    setRecording(false);
+    delete _timeSeries;
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCMAVLinkMessageField::addSeries(MAVLinkChartController* chart, QAbstractSeries* series)
@@ -37,8 +47,8 @@ QGCMAVLinkMessageField::addSeries(MAVLinkChartController* chart, QAbstractSeries
     if(!_pSeries) {
         _chart = chart;
         _pSeries = series;
+        _timeSeries = new MAVLinkTimeSeries();
         emit seriesChanged();
-        _dataIndex = 0;
         _msg->updateFieldSelection();
     }
 }
@@ -48,9 +58,10 @@ void
 QGCMAVLinkMessageField::delSeries()
 {
     if(_pSeries) {
-        _values.clear();
         QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(_values);
+        lineSeries->replace(QList<QPointF>());
+        delete _timeSeries;
+        _timeSeries = nullptr;
         _pSeries = nullptr;
         _chart   = nullptr;
         emit seriesChanged();
@@ -85,6 +96,39 @@ QGCMAVLinkMessageField::chartIndex()
     return 0;
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessageField::setRecording(bool recording)
+{
+    if(recording == _recordFile.isOpen()) {
+        return;
+    }
+    if(recording) {
+        QString path = qgcApp()->toolbox()->settingsManager()->appSettings()->telemetrySavePath();
+        if(path.isEmpty() || !QDir().mkpath(path)) {
+            qgcApp()->showAppMessage(tr("Unable to record %1: no telemetry save path is set.").arg(label()));
+            emit recordingChanged();
+            return;
+        }
+        QString fileName = QString("%1_%2_%3.csv").arg(_msg->name()).arg(_name).arg(QDateTime::currentDateTime().toString("yyyy-MM-dd_hh.mm.ss"));
+        _recordFile.setFileName(QDir(path).filePath(fileName));
+        if(!_recordFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            qgcApp()->showAppMessage(tr("Unable to record %1: %2").arg(label()).arg(_recordFile.errorString()));
+            emit recordingChanged();
+            return;
+        }
+        qCDebug(MAVLinkInspectorLog) << "Recording" << label() << "to" << _recordFile.fileName();
+        _recordStream.setDevice(&_recordFile);
+        _recordStream.setRealNumberPrecision(15);
+        _recordStream << "Timestamp (ms)," << _msg->name() << "." << _name << "\n";
+    } else {
+        _recordStream.flush();
+        _recordStream.setDevice(nullptr);
+        _recordFile.close();
+    }
+    emit recordingChanged();
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
@@ -93,39 +137,20 @@ QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
         _value = newValue;
         emit valueChanged();
     }
-    if(_pSeries && _chart) {
-        int count = _values.count();
-        //-- Arbitrary limit of 1 minute of data at 50Hz for now
-        if(count < (50 * 60)) {
-            QPointF p(QGC::bootTimeMilliseconds(), v);
-            _values.append(p);
-        } else {
-            if(_dataIndex >= count) _dataIndex = 0;
-            _values[_dataIndex].setX(QGC::bootTimeMilliseconds());
-            _values[_dataIndex].setY(v);
-            _dataIndex++;
+    if(_timeSeries || _recordFile.isOpen()) {
+        quint64 t = QGC::bootTimeMilliseconds();
+        if(_timeSeries) {
+            _timeSeries->append(static_cast<qreal>(t), v);
         }
-        //-- Auto Range
-        if(_chart->rangeYIndex() == 0) {
-            qreal vmin  = std::numeric_limits<qreal>::max();
-            qreal vmax  = std::numeric_limits<qreal>::min();
-            for(int i = 0; i < _values.count(); i++) {
-                qreal v = _values[i].y();
-                if(vmax < v) vmax = v;
-                if(vmin > v) vmin = v;
-            }
-            bool changed = false;
-            if(std::abs(_rangeMin - vmin) > 0.000001) {
-                _rangeMin = vmin;
-                changed = true;
-            }
-            if(std::abs(_rangeMax - vmax) > 0.000001) {
-                _rangeMax = vmax;
-                changed = true;
-            }
-            if(changed) {
-                _chart->updateYRange();
+        if(_recordFile.isOpen()) {
+            //-- char fields are recorded as the string, quotes doubled as CSV expects, everything else as the number
+            _recordStream << t << ",";
+            if(_type == QStringLiteral("char")) {
+                _recordStream << "\"" << QString(newValue).replace(QStringLiteral("\""), QStringLiteral("\"\"")) << "\"";
+            } else {
+                _recordStream << v;
             }
+            _recordStream << "\n";
         }
     }
 }
@@ -134,18 +159,32 @@ QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
 void
 QGCMAVLinkMessageField::updateSeries()
 {
-    int count = _values.count();
-    if (count > 1) {
-        QList<QPointF> s;
-        s.reserve(count);
-        int idx = _dataIndex;
-        for(int i = 0; i < count; i++, idx++) {
-            if(idx >= count) idx = 0;
-            QPointF p(_values[idx]);
-            s.append(p);
+    if(!_pSeries || !_chart || !_timeSeries) {
+        return;
+    }
+    //-- Draw from the finest resolution which fits the visible time scale
+    QList<QPointF> s;
+    qreal vmin = 0;
+    qreal vmax = 0;
+    if(!_timeSeries->points(static_cast<qreal>(_chart->rangeXMin().toMSecsSinceEpoch()), MAVLinkTimeSeries::maxChartPoints, s, vmin, vmax)) {
+        return;
+    }
+    QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
+    lineSeries->replace(s);
+    //-- Auto Range over what is visible
+    if(_chart->rangeYIndex() == 0) {
+        bool changed = false;
+        if(std::abs(_rangeMin - vmin) > 0.000001) {
+            _rangeMin = vmin;
+            changed = true;
+        }
+        if(std::abs(_rangeMax - vmax) > 0.000001) {
+            _rangeMax = vmax;
+            changed = true;
+        }
+        if(changed) {
+            _chart->updateYRange();
         }
-        QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(s);
     }
 }
 
@@ -641,7 +680,7 @@ MAVLinkChartController::updateYRange()
 {
     if(_chartFields.count()) {
         qreal vmin  = std::numeric_limits<qreal>::max();
-        qreal vmax  = std::numeric_limits<qreal>::min();
+        qreal vmax  = std::numeric_limits<qreal>::lowest();
         for(int i = 0; i < _chartFields.count(); i++) {
             QObject* object = qvariant_cast<QObject*>(_chartFields.at(i));
             QGCMAVLinkMessageField* pField = qobject_cast<QGCMAVLinkMessageField*>(object);
@@ -730,6 +769,8 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     _timeScaleSt.append(new TimeScale_st(this, tr("10 Sec"), 10 * 1000));
     _timeScaleSt.append(new TimeScale_st(this, tr("30 Sec"), 30 * 1000));
     _timeScaleSt.append(new TimeScale_st(this, tr("60 Sec"), 60 * 1000));
+    _timeScaleSt.append(new TimeScale_st(this, tr("10 Min"), 10 * 60 * 1000));
+    _timeScaleSt.append(new TimeScale_st(this, tr("60 Min"), 60 * 60 * 1000));
     emit timeScalesChanged();
     _rangeSt.append(new Range_st(this, tr("Auto"),    0));
     _rangeSt.append(new Range_st(this, tr("10,000"),  10000));
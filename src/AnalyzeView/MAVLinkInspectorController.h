@@ -14,12 +14,15 @@
 #pragma once
 
 #include "MAVLinkProtocol.h"
+#include "MAVLinkTimeSeries.h"
 #include "Vehicle.h"
 
 #include <QObject>
 #include <QString>
 #include <QDebug>
 #include <QVariantList>
+#include <QFile>
+#include <QTextStream>
 #include <QtCharts/QAbstractSeries>
 
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkInspectorLog)
@@ -43,8 +46,10 @@ public:
     Q_PROPERTY(bool             selectable  READ selectable NOTIFY selectableChanged)
     Q_PROPERTY(int              chartIndex  READ chartIndex CONSTANT)
     Q_PROPERTY(QAbstractSeries* series      READ series     NOTIFY seriesChanged)
+    Q_PROPERTY(bool             recording   READ recording  WRITE setRecording  NOTIFY recordingChanged)
 
     QGCMAVLinkMessageField(QGCMAVLinkMessage* parent, QString name, QString type);
+    ~QGCMAVLinkMessageField();
 
     QString         name            () { return _name;  }
     QString         label           ();
@@ -53,12 +58,13 @@ public:
     bool            selectable      () { return _selectable; }
     bool            selected        () { return _pSeries != nullptr; }
     QAbstractSeries*series          () { return _pSeries; }
-    QList<QPointF>* values          () { return &_values;}
+    bool            recording       () { return _recordFile.isOpen(); }
     qreal           rangeMin        () { return _rangeMin; }
     qreal           rangeMax        () { return _rangeMax; }
     int             chartIndex      ();
 
     void            setSelectable   (bool sel);
+    void            setRecording    (bool recording);
     void            updateValue     (QString newValue, qreal v);
 
     void            addSeries       (MAVLinkChartController* chart, QAbstractSeries* series);
@@ -69,20 +75,22 @@ signals:
     void            seriesChanged       ();
     void            selectableChanged   ();
     void            valueChanged        ();
+    void            recordingChanged    ();
 
 private:
     QString     _type;
     QString     _name;
     QString     _value;
     bool        _selectable = true;
-    int         _dataIndex  = 0;
     qreal       _rangeMin   = 0;
     qreal       _rangeMax   = 0;
 
     QAbstractSeries*    _pSeries = nullptr;
     QGCMAVLinkMessage*  _msg     = nullptr;
     MAVLinkChartController*      _chart   = nullptr;
-    QList<QPointF>      _values;
+    MAVLinkTimeSeries*  _timeSeries = nullptr;  ///< Only allocated while the field is charted
+    QFile               _recordFile;
+    QTextStream         _recordStream;
 };
 
 //-----------------------------------------------------------------------------
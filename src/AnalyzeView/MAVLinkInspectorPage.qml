@@ -144,7 +144,7 @@ AnalyzePage {
                     //---------------------------------------------------------
                     GridLayout {
                         id:                 msgInfoGrid
-                        columns:            5
+                        columns:            6
                         columnSpacing:      ScreenTools.defaultFontPixelWidth  * 0.25
                         rowSpacing:         ScreenTools.defaultFontPixelHeight * 0.25
                         width:              parent.width
@@ -163,10 +163,13 @@ AnalyzePage {
                         QGCLabel {
                             text:       qsTr("Plot 2")
                         }
+                        QGCLabel {
+                            text:       qsTr("Record")
+                        }
 
                         //---------------------------------------------------------
                         Rectangle {
-                            Layout.columnSpan:  5
+                            Layout.columnSpan:  6
                             Layout.fillWidth:   true
                             height:             1
                             color:              qgcPal.text
@@ -261,6 +264,16 @@ AnalyzePage {
                                 }
                             }
                         }
+                        Repeater {
+                            model:      curMessage ? curMessage.fields : []
+                            delegate:   QGCCheckBox {
+                                Layout.row:         index + 2
+                                Layout.column:      5
+                                Layout.alignment:   Qt.AlignHCenter
+                                checked:            object.recording
+                                onClicked:          object.recording = checked
+                            }
+                        }
                     }
                     Item { height: ScreenTools.defaultFontPixelHeight * 0.25; width: 1 }
                     MAVLinkChart {
@@ -0,0 +1,193 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkTimeSeries.h"
+
+#include <cmath>
+#include <limits>
+
+//-- Bucket width and number of buckets kept for each level: 2 minutes of 50ms, 20 minutes of 500ms, 2 hours of 5s
+static const struct {
+    qreal   bucketMSecs;
+    int     capacity;
+} kLevels[] = {
+    {   50, 2400 },
+    {  500, 2400 },
+    { 5000, 1440 },
+};
+
+//-----------------------------------------------------------------------------
+MAVLinkTimeSeries::MAVLinkTimeSeries()
+    : _raw(_rawCapacity)
+{
+    for(const auto& info: kLevels) {
+        Level_t level;
+        level.bucketMSecs = info.bucketMSecs;
+        level.buckets.resize(info.capacity);
+        _levels.append(level);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkTimeSeries::clear()
+{
+    _rawHead  = 0;
+    _rawCount = 0;
+    for(Level_t& level: _levels) {
+        level.head  = 0;
+        level.count = 0;
+        level.open  = Bucket_t();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkTimeSeries::_addToBucket(Bucket_t& bucket, qreal value)
+{
+    if(bucket.count == 0) {
+        bucket.min = bucket.max = value;
+    } else if(value < bucket.min) {
+        bucket.min      = value;
+        bucket.minFirst = false;
+    } else if(value > bucket.max) {
+        bucket.max      = value;
+        bucket.minFirst = true;
+    }
+    bucket.count++;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkTimeSeries::append(qreal timeMSecs, qreal value)
+{
+    if(_rawCount < _rawCapacity) {
+        _raw[(_rawHead + _rawCount) % _rawCapacity] = QPointF(timeMSecs, value);
+        _rawCount++;
+    } else {
+        _raw[_rawHead] = QPointF(timeMSecs, value);
+        _rawHead = (_rawHead + 1) % _rawCapacity;
+    }
+    for(Level_t& level: _levels) {
+        qreal start = std::floor(timeMSecs / level.bucketMSecs) * level.bucketMSecs;
+        if(level.open.count && start > level.open.time) {
+            //-- Close the open bucket, overwriting the oldest one once the level is full
+            int capacity = level.buckets.count();
+            if(level.count < capacity) {
+                level.buckets[(level.head + level.count) % capacity] = level.open;
+                level.count++;
+            } else {
+                level.buckets[level.head] = level.open;
+                level.head = (level.head + 1) % capacity;
+            }
+            level.open = Bucket_t();
+        }
+        if(level.open.count == 0) {
+            level.open.time = start;
+        }
+        _addToBucket(level.open, value);
+    }
+}
+
+//-----------------------------------------------------------------------------
+int
+MAVLinkTimeSeries::_firstRaw(qreal fromMSecs) const
+{
+    //-- Binary search for the oldest sample at or after fromMSecs
+    int lo = 0;
+    int hi = _rawCount;
+    while(lo < hi) {
+        int mid = (lo + hi) / 2;
+        if(_raw[(_rawHead + mid) % _rawCapacity].x() < fromMSecs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+//-----------------------------------------------------------------------------
+int
+MAVLinkTimeSeries::_firstBucket(const Level_t& level, qreal fromMSecs)
+{
+    //-- Oldest bucket which ends after fromMSecs
+    int capacity = level.buckets.count();
+    int lo = 0;
+    int hi = level.count;
+    while(lo < hi) {
+        int mid = (lo + hi) / 2;
+        if(level.buckets[(level.head + mid) % capacity].time + level.bucketMSecs <= fromMSecs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkTimeSeries::_addBucketPoints(const Bucket_t& bucket, qreal bucketMSecs, QList<QPointF>& points, qreal& min, qreal& max)
+{
+    if(bucket.count == 0) {
+        return;
+    }
+    if(min > bucket.min) min = bucket.min;
+    if(max < bucket.max) max = bucket.max;
+    if(bucket.min == bucket.max) {
+        points.append(QPointF(bucket.time, bucket.min));
+    } else {
+        //-- Both extremes, in the order they were seen
+        points.append(QPointF(bucket.time,                     bucket.minFirst ? bucket.min : bucket.max));
+        points.append(QPointF(bucket.time + bucketMSecs / 2,   bucket.minFirst ? bucket.max : bucket.min));
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool
+MAVLinkTimeSeries::points(qreal fromMSecs, int maxPoints, QList<QPointF>& points, qreal& min, qreal& max) const
+{
+    points.clear();
+    min = std::numeric_limits<qreal>::max();
+    max = std::numeric_limits<qreal>::lowest();
+    if(_rawCount == 0) {
+        return false;
+    }
+    //-- A level which has never wrapped holds everything since the series started, so it covers any span
+    int  first     = _firstRaw(fromMSecs);
+    bool rawCovers = _rawCount < _rawCapacity || _raw[_rawHead].x() <= fromMSecs;
+    if(rawCovers && _rawCount - first <= maxPoints) {
+        points.reserve(_rawCount - first);
+        for(int i = first; i < _rawCount; i++) {
+            const QPointF& p = _raw[(_rawHead + i) % _rawCapacity];
+            if(min > p.y()) min = p.y();
+            if(max < p.y()) max = p.y();
+            points.append(p);
+        }
+        return !points.isEmpty();
+    }
+    for(int l = 0; l < _levels.count(); l++) {
+        const Level_t& level = _levels[l];
+        int capacity = level.buckets.count();
+        first = _firstBucket(level, fromMSecs);
+        bool covers = level.count < capacity || level.buckets[level.head].time <= fromMSecs;
+        //-- Two points per bucket, plus the open one. Fall back to the coarsest level when nothing fits.
+        int count = (level.count - first + 1) * 2;
+        if((covers && count <= maxPoints) || l == _levels.count() - 1) {
+            points.reserve(count);
+            for(int i = first; i < level.count; i++) {
+                _addBucketPoints(level.buckets[(level.head + i) % capacity], level.bucketMSecs, points, min, max);
+            }
+            _addBucketPoints(level.open, level.bucketMSecs, points, min, max);
+            break;
+        }
+    }
+    return !points.isEmpty();
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+/// @file
+/// @brief Bounded, multi resolution sample storage for MAVLink Inspector charts
+
+#pragma once
+
+#include <QList>
+#include <QPointF>
+#include <QVector>
+
+//-----------------------------------------------------------------------------
+/// Time series of a single charted field.
+///
+/// Raw samples are kept in a fixed capacity ring. Every sample is also folded into a few levels of fixed width
+/// min/max buckets, each level with its own fixed capacity ring, so memory use is bounded no matter how long or how
+/// fast a field is charted. A zoomed out chart is drawn from the buckets instead of decimating raw samples on every
+/// refresh, and keeping both extremes of a bucket means spikes are never lost.
+class MAVLinkTimeSeries
+{
+public:
+    MAVLinkTimeSeries();
+
+    /// Points drawn per chart series, regardless of the time scale. Two points per bucket, enough for each time scale
+    /// to be drawn from the level sized for it: 60 seconds of 50ms buckets, 10 minutes of 500ms buckets.
+    static const int maxChartPoints = 2500;
+
+    /// Adds a sample. Times are expected to be increasing.
+    void    append          (qreal timeMSecs, qreal value);
+    void    clear           ();
+
+    /// Fills points with the data from fromMSecs onwards, taken from the finest level which covers the whole span with
+    /// no more than maxPoints points.
+    ///     @param[out] min Smallest value in points
+    ///     @param[out] max Largest value in points
+    ///     @return false: no data in the span
+    bool    points          (qreal fromMSecs, int maxPoints, QList<QPointF>& points, qreal& min, qreal& max) const;
+
+private:
+    typedef struct {
+        qreal   time        = 0;    ///< Start of the bucket
+        qreal   min         = 0;
+        qreal   max         = 0;
+        bool    minFirst    = true; ///< Minimum was seen before the maximum
+        int     count       = 0;
+    } Bucket_t;
+
+    typedef struct {
+        qreal               bucketMSecs = 0;
+        QVector<Bucket_t>   buckets;
+        int                 head        = 0;    ///< Index of the oldest bucket
+        int                 count       = 0;
+        Bucket_t            open;               ///< Bucket currently being filled
+    } Level_t;
+
+    static void _addToBucket    (Bucket_t& bucket, qreal value);
+    static void _addBucketPoints(const Bucket_t& bucket, qreal bucketMSecs, QList<QPointF>& points, qreal& min, qreal& max);
+    int         _firstRaw       (qreal fromMSecs) const;
+    static int  _firstBucket    (const Level_t& level, qreal fromMSecs);
+
+    static const int _rawCapacity = 4096;
+
+    QVector<QPointF>    _raw;
+    int                 _rawHead    = 0;    ///< Index of the oldest sample
+    int                 _rawCount   = 0;
+    QVector<Level_t>    _levels;
+};
@@ -0,0 +1,140 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkTimeSeriesTest.h"
+#include "MAVLinkTimeSeries.h"
+
+#include <cmath>
+
+bool MAVLinkTimeSeriesTest::_ascending(const QList<QPointF>& points)
+{
+    for (int i = 1; i < points.count(); i++) {
+        if (points[i].x() <= points[i - 1].x()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Bucketed points sit on the bucket start or half way through the bucket
+bool MAVLinkTimeSeriesTest::_onGrid(const QList<QPointF>& points, qreal gridMSecs)
+{
+    for (const QPointF& point: points) {
+        if (std::fmod(point.x(), gridMSecs) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MAVLinkTimeSeriesTest::_empty_test(void)
+{
+    MAVLinkTimeSeries   series;
+    QList<QPointF>      points;
+    qreal               min, max;
+
+    QVERIFY(!series.points(0, 100, points, min, max));
+    QVERIFY(points.isEmpty());
+
+    series.append(0, 1);
+    QVERIFY(series.points(0, 100, points, min, max));
+    QCOMPARE(points.count(), 1);
+
+    // Nothing after the requested start
+    QVERIFY(!series.points(10, 100, points, min, max));
+
+    series.clear();
+    QVERIFY(!series.points(0, 100, points, min, max));
+}
+
+void MAVLinkTimeSeriesTest::_levelSelection_test(void)
+{
+    MAVLinkTimeSeries   series;
+    QList<QPointF>      points;
+    qreal               min, max;
+
+    // Two minutes at 50Hz, alternating values so no bucket is flat
+    for (int i = 0; i < 6000; i++) {
+        series.append(i * 20, i % 2);
+    }
+    qreal fromMSecs = 119980 - 60000;
+
+    // The 60 second scale has more raw samples than the budget, but fits in the 50ms level
+    QVERIFY(series.points(fromMSecs, MAVLinkTimeSeries::maxChartPoints, points, min, max));
+    QVERIFY(points.count() <= MAVLinkTimeSeries::maxChartPoints);
+    QCOMPARE(points.count(), 2402);
+    QCOMPARE(points.first().x(), 59950.0);
+    QVERIFY(_onGrid(points, 25));
+    QVERIFY(_ascending(points));
+    QCOMPARE(min, 0.0);
+    QCOMPARE(max, 1.0);
+
+    // A smaller budget drops to the 500ms level
+    QVERIFY(series.points(fromMSecs, 2000, points, min, max));
+    QCOMPARE(points.count(), 242);
+    QVERIFY(_onGrid(points, 250));
+
+    // A short span fits in the raw samples
+    QVERIFY(series.points(119000, MAVLinkTimeSeries::maxChartPoints, points, min, max));
+    QCOMPARE(points.count(), 50);
+    QCOMPARE(points.first(), QPointF(119000, 0));
+    QCOMPARE(points.last(), QPointF(119980, 1));
+}
+
+void MAVLinkTimeSeriesTest::_wrap_test(void)
+{
+    MAVLinkTimeSeries   series;
+    QList<QPointF>      points;
+    qreal               min, max;
+
+    // 200 seconds at 100Hz wraps both the raw samples and the 50ms level
+    for (int i = 0; i < 20000; i++) {
+        series.append(i * 10, i % 2);
+    }
+
+    // Raw samples from across the end of the ring
+    QVERIFY(series.points(195000, 1000000, points, min, max));
+    QCOMPARE(points.count(), 500);
+    QCOMPARE(points.first().x(), 195000.0);
+    QCOMPARE(points.last().x(), 199990.0);
+    QVERIFY(_ascending(points));
+
+    // Older than the raw samples, 50ms buckets from across the end of the ring
+    QVERIFY(series.points(100000, 1000000, points, min, max));
+    QCOMPARE(points.count(), 4000);
+    QCOMPARE(points.first().x(), 100000.0);
+    QVERIFY(_onGrid(points, 25));
+    QVERIFY(_ascending(points));
+
+    // The 50ms level has dropped the start, only the 500ms level still covers it
+    QVERIFY(series.points(0, 1000000, points, min, max));
+    QCOMPARE(points.count(), 800);
+    QCOMPARE(points.first().x(), 0.0);
+    QVERIFY(_onGrid(points, 250));
+    QVERIFY(_ascending(points));
+}
+
+void MAVLinkTimeSeriesTest::_minMaxOrder_test(void)
+{
+    MAVLinkTimeSeries   series;
+    QList<QPointF>      points;
+    qreal               min, max;
+
+    // 50ms buckets: maximum then minimum, minimum then maximum, flat
+    const qreal values[] = { 5, 9, 1, 5,   5, 1, 9, 5,   3, 3, 3, 3 };
+    for (int i = 0; i < 12; i++) {
+        series.append((i / 4) * 50 + (i % 4) * 10, values[i]);
+    }
+
+    // Too many raw samples, so the 50ms level is used
+    QVERIFY(series.points(0, 6, points, min, max));
+    QCOMPARE(points, QList<QPointF>({ QPointF(0, 9), QPointF(25, 1), QPointF(50, 1), QPointF(75, 9), QPointF(100, 3) }));
+    QCOMPARE(min, 1.0);
+    QCOMPARE(max, 9.0);
+}
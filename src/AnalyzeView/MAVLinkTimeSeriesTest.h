@@ -0,0 +1,30 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QPointF>
+
+/// Unit test for the MAVLink Inspector chart sample storage
+class MAVLinkTimeSeriesTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _empty_test            (void);
+    void _levelSelection_test   (void);
+    void _wrap_test             (void);
+    void _minMaxOrder_test      (void);
+
+private:
+    static bool _ascending  (const QList<QPointF>& points);
+    static bool _onGrid     (const QList<QPointF>& points, qreal gridMSecs);
+};
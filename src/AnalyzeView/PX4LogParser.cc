@@ -1,8 +1,16 @@
 #include "PX4LogParser.h"
+#include "LogBufferedReader.h"
 #include <math.h>
 #include <QtEndian>
 #include <QDateTime>
 
+// sdlog2 message ids and layout
+#define SDLOG2_HEADER_LEN   3
+#define SDLOG2_FMT_ID       0x80
+#define SDLOG2_FMT_LEN      89
+#define SDLOG2_GPOS_ID      0x10
+#define SDLOG2_TRIG_ID      0x37
+
 PX4LogParser::PX4LogParser()
 {
 
@@ -13,86 +21,83 @@ PX4LogParser::~PX4LogParser()
 
 }
 
-bool PX4LogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+bool PX4LogParser::getTagsFromLog(QIODevice& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
 {
-
-     // general message header
-    char header[] = {(char)0xA3, (char)0x95, (char)0x00};
-    // header for GPOS message header
-    char gposHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x10, (char)0x00};
-    int gposHeaderOffset;
-    // header for GPOS message
-    char gposHeader[] = {(char)0xA3, (char)0x95, (char)0x10, (char)0x00};
+    // offsets from the start of the message, including the header
     int gposOffsets[3] = {3, 7, 11};
-    int gposLengths[3] = {4, 4, 4};
-    // header for trigger message header
-    char triggerHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x37, (char)0x00};
-    int triggerHeaderOffset;
-    // header for trigger message
-    char triggerHeader[] = {(char)0xA3, (char)0x95, (char)0x37, (char)0x00};
     int triggerOffsets[2] = {3, 11};
-    int triggerLengths[2] = {8, 4};
 
-    // extract header information: message lengths
-    uint8_t* iptr = reinterpret_cast<uint8_t*>(log.mid(log.indexOf(gposHeaderHeader) + 4, 1).data());
-    gposHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
-    iptr = reinterpret_cast<uint8_t*>(log.mid(log.indexOf(triggerHeaderHeader) + 4, 1).data());
-    triggerHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
+    LogBufferedReader reader(log);
+
+    memset(_messageLengths, 0, sizeof(_messageLengths));
+    _messageLengths[SDLOG2_FMT_ID] = SDLOG2_FMT_LEN;
 
-    // extract trigger data
-    int index = 1;
+    // Trigger waiting for the position which follows it
+    GeoTagWorker::cameraFeedbackPacket feedback;
+    bool feedbackPending = false;
     int sequence = -1;
-    while(index < log.count() - 1) {
 
-        // first extract trigger
-        index = log.indexOf(triggerHeader, index + 1);
-        // check for whether last entry has been passed
-        if (index < 0) {
-            break;
-        }
+    while (reader.fill(SDLOG2_HEADER_LEN)) {
+        const uint8_t* header = reinterpret_cast<const uint8_t*>(reader.data());
 
-        if (log.indexOf(header, index + 1) != index + triggerHeaderOffset) {
+        // Step a byte at a time over anything which isn't the start of a known message, to resync after corrupt data
+        int length = _messageLengths[header[2]];
+        if (header[0] != 0xA3 || header[1] != 0x95 || length < SDLOG2_HEADER_LEN) {
+            reader.skip(1);
             continue;
         }
-
-        GeoTagWorker::cameraFeedbackPacket feedback;
-        memset(&feedback, 0, sizeof(feedback));
-
-        uint64_t* time = reinterpret_cast<uint64_t*>(log.mid(index + triggerOffsets[0], triggerLengths[0]).data());
-        double timeDouble = static_cast<double>(qFromLittleEndian(*time)) / 1.0e6;
-        uint32_t* seq = reinterpret_cast<uint32_t*>(log.mid(index + triggerOffsets[1], triggerLengths[1]).data());
-        int seqInt = static_cast<int>(qFromLittleEndian(*seq));
-        if (sequence >= seqInt || sequence + 20 < seqInt) { // assume that logging has not skipped more than 20 triggers. this prevents wrong header detection
-            continue;
+        if (!reader.fill(length)) {
+            break;
         }
-        feedback.timestamp = timeDouble;
-        feedback.imageSequence = seqInt;
-        sequence = seqInt;
+        const char* msg = reader.data();
 
-        // second extract position
-        bool lookForGpos = true;
-        while (lookForGpos) {
+        switch (static_cast<uint8_t>(msg[2])) {
+        case SDLOG2_FMT_ID:
+            // type, length, name, format, labels
+            _messageLengths[static_cast<uint8_t>(msg[3])] = static_cast<uint8_t>(msg[4]);
+            break;
 
-            int gposIndex = log.indexOf(gposHeader, index + 1);
-            if (gposIndex < 0) {
-                cameraFeedback.append(feedback);
+        case SDLOG2_TRIG_ID:
+        {
+            // Triggers are ignored until the previous one has its position
+            if (feedbackPending || length < triggerOffsets[1] + 4) {
                 break;
             }
-            index = gposIndex;
-
-            // verify that at an offset of gposHeaderOffset the next log message starts
-            if (gposIndex + gposHeaderOffset == log.indexOf(header, gposIndex + 1)) {
-                int32_t* lat = reinterpret_cast<int32_t*>(log.mid(gposIndex + gposOffsets[0], gposLengths[0]).data());
-                feedback.latitude = static_cast<double>(qFromLittleEndian(*lat))/1.0e7;
-                int32_t* lon = reinterpret_cast<int32_t*>(log.mid(gposIndex + gposOffsets[1], gposLengths[1]).data());
-                feedback.longitude = static_cast<double>(qFromLittleEndian(*lon))/1.0e7;
+            double timeDouble = static_cast<double>(qFromLittleEndian<quint64>(msg + triggerOffsets[0])) / 1.0e6;
+            int seqInt = static_cast<int>(qFromLittleEndian<quint32>(msg + triggerOffsets[1]));
+            if (sequence >= seqInt || sequence + 20 < seqInt) { // assume that logging has not skipped more than 20 triggers. this prevents wrong header detection
+                break;
+            }
+            memset(&feedback, 0, sizeof(feedback));
+            feedback.timestamp = timeDouble;
+            feedback.imageSequence = seqInt;
+            sequence = seqInt;
+            feedbackPending = true;
+            break;
+        }
+
+        case SDLOG2_GPOS_ID:
+            if (feedbackPending && length >= gposOffsets[2] + 4) {
+                feedback.latitude = static_cast<double>(qFromLittleEndian<qint32>(msg + gposOffsets[0]))/1.0e7;
+                feedback.longitude = static_cast<double>(qFromLittleEndian<qint32>(msg + gposOffsets[1]))/1.0e7;
                 feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                float* alt = reinterpret_cast<float*>(log.mid(gposIndex + gposOffsets[2], gposLengths[2]).data());
-                feedback.altitude = qFromLittleEndian(*alt);
+                quint32 alt = qFromLittleEndian<quint32>(msg + gposOffsets[2]);
+                memcpy(&feedback.altitude, &alt, sizeof(feedback.altitude));
                 cameraFeedback.append(feedback);
-                break;
+                feedbackPending = false;
             }
+            break;
+
+        default:
+            break;
         }
+
+        reader.skip(length);
+    }
+
+    // Last trigger without a position after it
+    if (feedbackPending) {
+        cameraFeedback.append(feedback);
     }
 
     return true;
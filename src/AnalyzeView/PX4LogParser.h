@@ -3,6 +3,7 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QIODevice>
 
 #include "GeoTagController.h"
 
@@ -11,10 +12,12 @@ class PX4LogParser
 public:
     PX4LogParser();
     ~PX4LogParser();
-    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
 
-private:
+    /// Walks the sdlog2 messages in order, only a chunk of the file is held in memory
+    bool getTagsFromLog(QIODevice& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
 
+private:
+    int         _messageLengths[256];   ///< From the FMT messages, 0 for unknown message types
 };
 
 #endif // PX4LOGPARSER_H
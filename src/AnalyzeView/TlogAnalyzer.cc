@@ -0,0 +1,321 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogAnalyzer.h"
+#include "TlogReader.h"
+#include "QGCLoggingCategory.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QSaveFile>
+
+QGC_LOGGING_CATEGORY(TlogAnalyzerLog, "TlogAnalyzerLog")
+
+TlogAnalyzer::TlogAnalyzer(void)
+    : _gapThresholdUSecs(static_cast<quint64>(_defaultGapThresholdMSecs) * 1000)
+{
+    _reset();
+}
+
+void TlogAnalyzer::_reset(void)
+{
+    _startTimeUSecs = 0;
+    _endTimeUSecs   = 0;
+    _messageCount   = 0;
+    _lostCount      = 0;
+    _mbPerSec       = 0;
+    _streamStats.clear();
+    memset(_lastSeq, 0, sizeof(_lastSeq));
+    memset(_seqSeen, 0, sizeof(_seqSeen));
+
+    for (FieldSeries_t& series: _fieldSeries) {
+        series.timestamps.clear();
+        series.sysids.clear();
+        series.compids.clear();
+        for (QVector<double>& column: series.columns) {
+            column.clear();
+        }
+    }
+}
+
+bool TlogAnalyzer::_findMessageInfo(const QString& messageName, const mavlink_message_info_t*& messageInfo)
+{
+    messageInfo = mavlink_get_message_info_by_name(messageName.toLatin1().constData());
+    return messageInfo != nullptr;
+}
+
+bool TlogAnalyzer::setFieldSelections(const QStringList& fields, QString& errorString)
+{
+    _fieldSeries.clear();
+
+    for (const QString& field: fields) {
+        QStringList parts = field.trimmed().split(QStringLiteral("."));
+        const mavlink_message_info_t* messageInfo;
+
+        if (parts.count() != 2 || !_findMessageInfo(parts[0], messageInfo)) {
+            errorString = QObject::tr("Unknown field selection '%1', format is MESSAGE_NAME.field_name").arg(field);
+            return false;
+        }
+
+        const mavlink_field_info_t* fieldInfo = nullptr;
+        for (unsigned int i = 0; i < messageInfo->num_fields; i++) {
+            if (parts[1] == QLatin1String(messageInfo->fields[i].name)) {
+                fieldInfo = &messageInfo->fields[i];
+                break;
+            }
+        }
+        if (!fieldInfo || fieldInfo->type == MAVLINK_TYPE_CHAR) {
+            errorString = QObject::tr("Field '%1' is not a numeric field of %2").arg(parts[1]).arg(parts[0]);
+            return false;
+        }
+
+        FieldSeries_t& series = _fieldSeries[messageInfo->msgid];
+        series.messageName = messageInfo->name;
+        if (!series.fieldNames.contains(parts[1])) {
+            series.fieldNames.append(parts[1]);
+            series.fieldInfos.append(fieldInfo);
+            series.columns.append(QVector<double>());
+        }
+    }
+
+    return true;
+}
+
+/// @return Value of a numeric field. For array fields the first element is returned.
+double TlogAnalyzer::_fieldValue(const mavlink_field_info_t& fieldInfo, const uint8_t* payload)
+{
+    const uint8_t* p = payload + fieldInfo.wire_offset;
+
+    switch (fieldInfo.type) {
+    case MAVLINK_TYPE_UINT8_T:  return *p;
+    case MAVLINK_TYPE_INT8_T:   return *reinterpret_cast<const int8_t*>(p);
+    case MAVLINK_TYPE_UINT16_T: { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+    case MAVLINK_TYPE_INT16_T:  { int16_t  v; memcpy(&v, p, sizeof(v)); return v; }
+    case MAVLINK_TYPE_UINT32_T: { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+    case MAVLINK_TYPE_INT32_T:  { int32_t  v; memcpy(&v, p, sizeof(v)); return v; }
+    case MAVLINK_TYPE_UINT64_T: { uint64_t v; memcpy(&v, p, sizeof(v)); return static_cast<double>(v); }
+    case MAVLINK_TYPE_INT64_T:  { int64_t  v; memcpy(&v, p, sizeof(v)); return static_cast<double>(v); }
+    case MAVLINK_TYPE_FLOAT:    { float    v; memcpy(&v, p, sizeof(v)); return static_cast<double>(v); }
+    case MAVLINK_TYPE_DOUBLE:   { double   v; memcpy(&v, p, sizeof(v)); return v; }
+    default:                    return 0;
+    }
+}
+
+bool TlogAnalyzer::analyze(const QString& logFilename, QString& errorString)
+{
+    TlogReader reader;
+
+    _reset();
+    _logFilename = logFilename;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!reader.open(logFilename, errorString)) {
+        return false;
+    }
+
+    _startTimeUSecs = reader.startTimeUSecs();
+    _endTimeUSecs   = reader.endTimeUSecs();
+
+    // Records are framed by TlogReader and then run through the standard MAVLink parser so messages are decoded
+    // exactly as they are for a live link.
+    mavlink_reset_channel_status(_mavlinkChannel);
+
+    qint64                  offset = 0;
+    TlogReader::Record_t    record;
+    mavlink_message_t       message;
+    mavlink_status_t        status;
+
+    while (reader.readRecord(offset, record)) {
+        for (int i = 0; i < record.packetLength; i++) {
+            if (mavlink_parse_char(_mavlinkChannel, record.packet[i], &message, &status)) {
+                _handleMessage(record.timestampUSecs, message);
+            }
+        }
+    }
+
+    qint64 elapsedMSecs = qMax(timer.elapsed(), static_cast<qint64>(1));
+    _mbPerSec = (static_cast<double>(reader.size()) / (1024.0 * 1024.0)) / (elapsedMSecs / 1000.0);
+
+    qCDebug(TlogAnalyzerLog) << "Analyzed" << logFilename << "messages" << _messageCount << "elapsed(ms)" << elapsedMSecs << "MB/s" << _mbPerSec;
+
+    return true;
+}
+
+void TlogAnalyzer::_updateLoss(const mavlink_message_t& message)
+{
+    if (_seqSeen[message.sysid][message.compid]) {
+        uint8_t expectedSeq = _lastSeq[message.sysid][message.compid] + 1;
+        _lostCount += static_cast<uint8_t>(message.seq - expectedSeq);
+    } else {
+        _seqSeen[message.sysid][message.compid] = true;
+    }
+    _lastSeq[message.sysid][message.compid] = message.seq;
+}
+
+void TlogAnalyzer::_handleMessage(quint64 timestampUSecs, const mavlink_message_t& message)
+{
+    _messageCount++;
+    _updateLoss(message);
+
+    quint64 key = (static_cast<quint64>(message.sysid) << 32) | (static_cast<quint64>(message.compid) << 24) | message.msgid;
+    auto iter = _streamStats.find(key);
+    if (iter == _streamStats.end()) {
+        StreamStats_t stats = { message.sysid, message.compid, message.msgid, 1, timestampUSecs, timestampUSecs, 0, 0 };
+        _streamStats.insert(key, stats);
+    } else {
+        StreamStats_t& stats = iter.value();
+        if (timestampUSecs > stats.lastTimeUSecs) {
+            quint64 gapUSecs = timestampUSecs - stats.lastTimeUSecs;
+            stats.maxGapUSecs = qMax(stats.maxGapUSecs, gapUSecs);
+            if (gapUSecs > _gapThresholdUSecs) {
+                stats.gapCount++;
+            }
+        }
+        stats.count++;
+        stats.lastTimeUSecs = timestampUSecs;
+    }
+
+    if (!_fieldSeries.isEmpty()) {
+        auto seriesIter = _fieldSeries.find(message.msgid);
+        if (seriesIter != _fieldSeries.end()) {
+            FieldSeries_t&  series  = seriesIter.value();
+            const uint8_t*  payload = reinterpret_cast<const uint8_t*>(&message.payload64[0]);
+
+            series.timestamps.append(timestampUSecs);
+            series.sysids.append(message.sysid);
+            series.compids.append(message.compid);
+            for (int i = 0; i < series.fieldInfos.count(); i++) {
+                series.columns[i].append(_fieldValue(*series.fieldInfos[i], payload));
+            }
+        }
+    }
+}
+
+void TlogAnalyzer::writeSummary(QTextStream& stream) const
+{
+    QList<StreamStats_t> rgStats = _streamStats.values();
+    std::sort(rgStats.begin(), rgStats.end(), [](const StreamStats_t& a, const StreamStats_t& b) {
+        return a.sysid != b.sysid ? a.sysid < b.sysid : (a.compid != b.compid ? a.compid < b.compid : a.msgid < b.msgid);
+    });
+
+    stream << "sysid,compid,msgid,name,count,rate_hz,max_gap_ms,gaps\n";
+    for (const StreamStats_t& stats: rgStats) {
+        mavlink_message_t dummy;
+        dummy.msgid = stats.msgid;
+        const mavlink_message_info_t* messageInfo = mavlink_get_message_info(&dummy);
+
+        quint64 spanUSecs   = stats.lastTimeUSecs - stats.firstTimeUSecs;
+        double  rateHz      = spanUSecs ? (stats.count - 1) / (spanUSecs / 1.0e6) : 0;
+
+        stream << stats.sysid << ',' << stats.compid << ',' << stats.msgid << ','
+               << (messageInfo ? messageInfo->name : "UNKNOWN") << ','
+               << stats.count << ','
+               << QString::number(rateHz, 'f', 2) << ','
+               << QString::number(stats.maxGapUSecs / 1000.0, 'f', 1) << ','
+               << stats.gapCount << '\n';
+    }
+}
+
+bool TlogAnalyzer::writeResults(const QString& outputDir, QString& errorString) const
+{
+    QDir        dir(outputDir);
+    QString     baseName = QFileInfo(_logFilename).completeBaseName();
+
+    if (!dir.exists() && !dir.mkpath(QStringLiteral("."))) {
+        errorString = QObject::tr("Unable to create output directory '%1'").arg(outputDir);
+        return false;
+    }
+
+    QSaveFile summaryFile(dir.filePath(QStringLiteral("%1.summary.csv").arg(baseName)));
+    if (!summaryFile.open(QFile::WriteOnly | QFile::Text)) {
+        errorString = QObject::tr("Unable to create '%1', error: %2").arg(summaryFile.fileName()).arg(summaryFile.errorString());
+        return false;
+    }
+    {
+        QTextStream stream(&summaryFile);
+        writeSummary(stream);
+    }
+    if (!summaryFile.commit()) {
+        errorString = QObject::tr("Unable to write '%1', error: %2").arg(summaryFile.fileName()).arg(summaryFile.errorString());
+        return false;
+    }
+
+    for (const FieldSeries_t& series: _fieldSeries) {
+        QSaveFile seriesFile(dir.filePath(QStringLiteral("%1.%2.csv").arg(baseName).arg(series.messageName)));
+        if (!seriesFile.open(QFile::WriteOnly | QFile::Text)) {
+            errorString = QObject::tr("Unable to create '%1', error: %2").arg(seriesFile.fileName()).arg(seriesFile.errorString());
+            return false;
+        }
+
+        QTextStream stream(&seriesFile);
+        stream << "timestamp_us,sysid,compid," << series.fieldNames.join(',') << '\n';
+        for (int row = 0; row < series.timestamps.count(); row++) {
+            stream << series.timestamps[row] << ',' << series.sysids[row] << ',' << series.compids[row];
+            for (const QVector<double>& column: series.columns) {
+                stream << ',' << QString::number(column[row], 'g', 10);
+            }
+            stream << '\n';
+        }
+        stream.flush();
+
+        if (!seriesFile.commit()) {
+            errorString = QObject::tr("Unable to write '%1', error: %2").arg(seriesFile.fileName()).arg(seriesFile.errorString());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int TlogAnalyzer::runFromCommandLine(const QString& logPath, const QString& fields, const QString& outputDir, const QString& gapThresholdMSecs)
+{
+    QTextStream     out(stdout);
+    QTextStream     err(stderr);
+    TlogAnalyzer    analyzer;
+    QString         errorString;
+    QStringList     logFiles;
+
+    if (!fields.isEmpty() && !analyzer.setFieldSelections(fields.split(QStringLiteral(","), QString::SkipEmptyParts), errorString)) {
+        err << errorString << endl;
+        return -1;
+    }
+    if (!gapThresholdMSecs.isEmpty()) {
+        analyzer.setGapThresholdMSecs(gapThresholdMSecs.toInt());
+    }
+
+    QFileInfo logPathInfo(logPath);
+    if (logPathInfo.isDir()) {
+        QDir logDir(logPath);
+        for (const QString& logFile: logDir.entryList(QStringList(QStringLiteral("*.tlog")), QDir::Files, QDir::Name)) {
+            logFiles.append(logDir.filePath(logFile));
+        }
+    } else {
+        logFiles.append(logPath);
+    }
+
+    int failures = 0;
+    for (const QString& logFile: logFiles) {
+        if (!analyzer.analyze(logFile, errorString) ||
+                !analyzer.writeResults(outputDir.isEmpty() ? QFileInfo(logFile).absolutePath() : outputDir, errorString)) {
+            err << logFile << ": " << errorString << endl;
+            failures++;
+            continue;
+        }
+        out << logFile << ": " << analyzer.messageCount() << " messages, "
+            << analyzer.lostCount() << " lost, "
+            << QString::number(analyzer.durationUSecs() / 1.0e6, 'f', 1) << " secs, "
+            << QString::number(analyzer.mbPerSec(), 'f', 1) << " MB/s" << endl;
+    }
+
+    return failures ? -failures : 0;
+}
@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QTextStream>
+#include <QLoggingCategory>
+
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TlogAnalyzerLog)
+
+/// Headless telemetry log analysis.
+///
+/// Streams a tlog through the MAVLink decoder as fast as the log can be read, with no real time pacing and without
+/// the Vehicle/FactGroup stack. Produces per message stream counts, rates, sequence loss and gaps, plus optional
+/// time series of selected fields. Field values are collected column wise and written out as CSV, one file per
+/// message type.
+class TlogAnalyzer
+{
+public:
+    TlogAnalyzer(void);
+
+    /// Selects the fields to collect time series for
+    ///     @param fields List of MESSAGE_NAME.field_name entries, for example ATTITUDE.roll
+    /// @return false: one or more fields are not known, see errorString
+    bool setFieldSelections(const QStringList& fields, QString& errorString);
+
+    /// Intervals between two messages of the same stream above this are reported as gaps
+    void setGapThresholdMSecs(int gapThresholdMSecs) { _gapThresholdUSecs = static_cast<quint64>(gapThresholdMSecs) * 1000; }
+
+    /// Analyzes the specified log, replacing the results of any previous analysis
+    ///     @param[out] errorString Error message if analysis fails
+    /// @return true: success
+    bool analyze(const QString& logFilename, QString& errorString);
+
+    /// Writes the per message stream summary as CSV
+    void writeSummary(QTextStream& stream) const;
+
+    /// Writes the summary and selected field time series to the specified directory, using the log file name as the
+    /// base for the output file names
+    bool writeResults(const QString& outputDir, QString& errorString) const;
+
+    quint64 messageCount    (void) const { return _messageCount; }
+    quint64 lostCount       (void) const { return _lostCount; }
+    quint64 durationUSecs   (void) const { return _endTimeUSecs - _startTimeUSecs; }
+    double  mbPerSec        (void) const { return _mbPerSec; }
+
+    /// Runs analysis from the command line over one or more logs and exits. Logs can be specified as files or
+    /// directories, in which case all tlogs in the directory are analyzed.
+    /// @return Process exit code
+    static int runFromCommandLine(const QString& logPath, const QString& fields, const QString& outputDir, const QString& gapThresholdMSecs);
+
+private:
+    typedef struct {
+        uint8_t     sysid;
+        uint8_t     compid;
+        uint32_t    msgid;
+        quint64     count;
+        quint64     firstTimeUSecs;
+        quint64     lastTimeUSecs;
+        quint64     maxGapUSecs;
+        quint64     gapCount;
+    } StreamStats_t;
+
+    /// Column wise storage of the selected fields for one message type
+    typedef struct {
+        QString                         messageName;
+        QStringList                     fieldNames;
+        QVector<const mavlink_field_info_t*> fieldInfos;
+        QVector<quint64>                timestamps;
+        QVector<uint8_t>                sysids;
+        QVector<uint8_t>                compids;
+        QVector<QVector<double>>        columns;
+    } FieldSeries_t;
+
+    void    _reset          (void);
+    void    _handleMessage  (quint64 timestampUSecs, const mavlink_message_t& message);
+    void    _updateLoss     (const mavlink_message_t& message);
+
+    static bool     _findMessageInfo(const QString& messageName, const mavlink_message_info_t*& messageInfo);
+    static double   _fieldValue     (const mavlink_field_info_t& fieldInfo, const uint8_t* payload);
+
+    QString                         _logFilename;
+    quint64                         _gapThresholdUSecs;
+    quint64                         _startTimeUSecs;
+    quint64                         _endTimeUSecs;
+    quint64                         _messageCount;
+    quint64                         _lostCount;
+    double                          _mbPerSec;
+    QHash<quint64, StreamStats_t>   _streamStats;       ///< Keyed by sysid/compid/msgid
+    QMap<uint32_t, FieldSeries_t>   _fieldSeries;       ///< Keyed by msgid
+    uint8_t                         _lastSeq    [256][256];
+    bool                            _seqSeen    [256][256];
+
+    static const mavlink_channel_t  _mavlinkChannel         = MAVLINK_COMM_0;   ///< LinkManager never hands out channel 0
+    static const int                _defaultGapThresholdMSecs = 1000;
+};
@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogAnalyzerTest.h"
+#include "TlogAnalyzer.h"
+#include "LinkManager.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+const quint64 TlogAnalyzerTest::_startTimeUSecs = 1600000000000000ull;
+
+/// Writes a 12.5 second log from a single vehicle with ATTITUDE at 10Hz and HEARTBEAT at 1Hz. After 5 seconds there
+/// is a 2.5 second gap in the log. Three ATTITUDE messages at 2 seconds are dropped, which shows up as sequence loss.
+/// ATTITUDE.roll is 0.25 * the message tick.
+bool TlogAnalyzerTest::_writeTestLog(const QString& logFilename)
+{
+    QFile logFile(logFilename);
+    if (!logFile.open(QFile::WriteOnly)) {
+        return false;
+    }
+
+    int channel = _linkManager->_reserveMavlinkChannel();
+    if (channel == 0) {
+        return false;
+    }
+
+    mavlink_message_t   message;
+    uint8_t             buf[MAVLINK_MAX_PACKET_LEN];
+
+    auto writeRecord = [&](quint64 timestampUSecs) {
+        uchar timestamp[sizeof(quint64)];
+        qToBigEndian<quint64>(timestampUSecs, timestamp);
+        logFile.write(reinterpret_cast<const char*>(timestamp), sizeof(timestamp));
+        int len = mavlink_msg_to_send_buffer(buf, &message);
+        logFile.write(reinterpret_cast<const char*>(buf), len);
+    };
+
+    for (int tick = 0; tick <= 100; tick++) {
+        quint64 timestampUSecs = _startTimeUSecs + static_cast<quint64>(tick) * 100000 + (tick >= 50 ? 2500000 : 0);
+
+        if (tick % 10 == 0) {
+            mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, static_cast<uint8_t>(channel), &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+            writeRecord(timestampUSecs);
+        }
+
+        mavlink_msg_attitude_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, static_cast<uint8_t>(channel), &message, static_cast<uint32_t>(tick * 100), tick * 0.25f, 0, 0, 0, 0, 0);
+        if (tick < 20 || tick > 22) {
+            writeRecord(timestampUSecs);
+        }
+    }
+
+    _linkManager->_freeMavlinkChannel(channel);
+
+    return logFile.error() == QFile::NoError;
+}
+
+void TlogAnalyzerTest::_analyze_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath("test.tlog");
+    QString         errorString;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(_writeTestLog(logFilename));
+
+    TlogAnalyzer analyzer;
+    QVERIFY2(analyzer.setFieldSelections(QStringList({ "ATTITUDE.roll" }), errorString), qPrintable(errorString));
+
+    // The second pass uses the index cached by the first, the results must be the same
+    for (int pass = 0; pass < 2; pass++) {
+        QVERIFY2(analyzer.analyze(logFilename, errorString), qPrintable(errorString));
+        QCOMPARE(analyzer.messageCount(), static_cast<quint64>(98 + 11));
+        QCOMPARE(analyzer.lostCount(), static_cast<quint64>(3));
+        QCOMPARE(analyzer.durationUSecs(), static_cast<quint64>(12500000));
+
+        QString     summary;
+        QTextStream stream(&summary);
+        analyzer.writeSummary(stream);
+        stream.flush();
+        QCOMPARE(summary, QStringLiteral("sysid,compid,msgid,name,count,rate_hz,max_gap_ms,gaps\n"
+                                         "1,1,0,HEARTBEAT,11,0.80,3500.0,1\n"
+                                         "1,1,30,ATTITUDE,98,7.76,2600.0,1\n"));
+    }
+
+    QVERIFY2(analyzer.writeResults(tempDir.path(), errorString), qPrintable(errorString));
+
+    QFile seriesFile(tempDir.filePath("test.ATTITUDE.csv"));
+    QVERIFY(seriesFile.open(QFile::ReadOnly | QFile::Text));
+    QStringList rows = QString(seriesFile.readAll()).split('\n', QString::SkipEmptyParts);
+    QCOMPARE(rows.count(), 1 + 98);
+    QCOMPARE(rows[0], QStringLiteral("timestamp_us,sysid,compid,roll"));
+    QCOMPARE(rows[1], QStringLiteral("%1,1,1,0").arg(_startTimeUSecs));
+    QCOMPARE(rows[2], QStringLiteral("%1,1,1,0.25").arg(_startTimeUSecs + 100000));
+    QCOMPARE(rows.last(), QStringLiteral("%1,1,1,25").arg(_startTimeUSecs + 12500000));
+
+    QVERIFY(QFile::exists(tempDir.filePath("test.summary.csv")));
+}
+
+void TlogAnalyzerTest::_commandLine_test(void)
+{
+    QTemporaryDir   logDir;
+    QTemporaryDir   outputDir;
+    QVERIFY(logDir.isValid() && outputDir.isValid());
+    QVERIFY(_writeTestLog(logDir.filePath("first.tlog")));
+    QVERIFY(_writeTestLog(logDir.filePath("second.tlog")));
+
+    // Directories analyze every tlog within them
+    QCOMPARE(TlogAnalyzer::runFromCommandLine(logDir.path(), QStringLiteral("ATTITUDE.roll,ATTITUDE.pitch"), outputDir.path(), QStringLiteral("1000")), 0);
+    for (const char* baseName: { "first", "second" }) {
+        QVERIFY(QFile::exists(QDir(outputDir.path()).filePath(QStringLiteral("%1.summary.csv").arg(baseName))));
+        QFile seriesFile(QDir(outputDir.path()).filePath(QStringLiteral("%1.ATTITUDE.csv").arg(baseName)));
+        QVERIFY(seriesFile.open(QFile::ReadOnly | QFile::Text));
+        QCOMPARE(QString(seriesFile.readLine()).trimmed(), QStringLiteral("timestamp_us,sysid,compid,roll,pitch"));
+    }
+
+    // A gap threshold above the longest gap reports no gaps
+    QCOMPARE(TlogAnalyzer::runFromCommandLine(logDir.filePath("first.tlog"), QString(), outputDir.path(), QStringLiteral("5000")), 0);
+    QFile summaryFile(QDir(outputDir.path()).filePath("first.summary.csv"));
+    QVERIFY(summaryFile.open(QFile::ReadOnly | QFile::Text));
+    QString summary = summaryFile.readAll();
+    QVERIFY(summary.contains(QStringLiteral("1,1,0,HEARTBEAT,11,0.80,3500.0,0\n")));
+    QVERIFY(summary.contains(QStringLiteral("1,1,30,ATTITUDE,98,7.76,2600.0,0\n")));
+
+    // Missing logs fail
+    QVERIFY(TlogAnalyzer::runFromCommandLine(logDir.filePath("missing.tlog"), QString(), outputDir.path(), QString()) != 0);
+}
+
+void TlogAnalyzerTest::_badFieldSelection_test(void)
+{
+    TlogAnalyzer    analyzer;
+    QString         errorString;
+
+    QVERIFY(!analyzer.setFieldSelections(QStringList({ "NOT_A_MESSAGE.roll" }), errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!analyzer.setFieldSelections(QStringList({ "ATTITUDE.not_a_field" }), errorString));
+    QVERIFY(!analyzer.setFieldSelections(QStringList({ "ATTITUDE" }), errorString));
+
+    // Character fields can't be collected as time series
+    QVERIFY(!analyzer.setFieldSelections(QStringList({ "STATUSTEXT.text" }), errorString));
+
+    QVERIFY(analyzer.setFieldSelections(QStringList({ "ATTITUDE.roll", "HEARTBEAT.custom_mode" }), errorString));
+}
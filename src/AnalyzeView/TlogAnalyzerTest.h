@@ -0,0 +1,27 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class TlogAnalyzerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _analyze_test          (void);
+    void _commandLine_test      (void);
+    void _badFieldSelection_test(void);
+
+private:
+    bool _writeTestLog(const QString& logFilename);
+
+    static const quint64 _startTimeUSecs;
+};
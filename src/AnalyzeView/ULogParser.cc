@@ -1,8 +1,11 @@
 #include "ULogParser.h"
+#include "LogBufferedReader.h"
 #include <math.h>
 #include <QDateTime>
 
 ULogParser::ULogParser()
+    : _cameraCaptureSize(0)
+    , _cameraCaptureMsgID(-1)
 {
 
 }
@@ -83,36 +86,42 @@ bool ULogParser::parseFieldFormat(QString& fields)
         prevFieldEnd = fieldEnd + 1;
         fieldEnd = fields.indexOf(';', prevFieldEnd);
     }
+    _cameraCaptureSize = offset;
     return false;
 }
 
-bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage)
+bool ULogParser::getTagsFromLog(QIODevice& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage)
 {
+    LogBufferedReader reader(log);
+
     errorMessage.clear();
 
     //verify it's an ULog file
-    if(!log.contains(_ULogMagic)) {
+    if(!reader.fill(ULOG_FILE_HEADER_LEN) || !QByteArray::fromRawData(reader.data(), ULOG_FILE_HEADER_LEN).startsWith(_ULogMagic)) {
         errorMessage = tr("Could not detect ULog file header magic");
         return false;
     }
 
-    int index = ULOG_FILE_HEADER_LEN;
+    reader.skip(ULOG_FILE_HEADER_LEN);
     bool geotagFound = false;
 
-    while(index < log.count() - 1) {
+    while(reader.fill(ULOG_MSG_HEADER_LEN)) {
 
         ULogMessageHeader header;
         memset(&header, 0, sizeof(header));
-        memcpy(&header, log.data() + index, ULOG_MSG_HEADER_LEN);
+        memcpy(&header, reader.data(), ULOG_MSG_HEADER_LEN);
+
+        // Stop at a truncated last message
+        int msgLen = ULOG_MSG_HEADER_LEN + header.msgSize;
+        if (!reader.fill(msgLen)) {
+            break;
+        }
+        const char* msg = reader.data();
 
         switch (header.msgType) {
             case (int)ULogMessageType::FORMAT:
             {
-                ULogMessageFormat format_msg;
-                memset(&format_msg, 0, sizeof(format_msg));
-                memcpy(&format_msg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
-
-                QString fmt(format_msg.format);
+                QString fmt = QString::fromLatin1(msg + ULOG_MSG_HEADER_LEN, header.msgSize);
                 int posSeparator = fmt.indexOf(':');
                 QString messageName = fmt.left(posSeparator);
                 QString messageFields = fmt.mid(posSeparator + 1, header.msgSize - posSeparator - 1);
@@ -125,14 +134,16 @@ bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedb
 
             case (int)ULogMessageType::ADD_LOGGED_MSG:
             {
-                ULogMessageAddLogged addLoggedMsg;
-                memset(&addLoggedMsg, 0, sizeof(addLoggedMsg));
-                memcpy(&addLoggedMsg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
-
-                QString messageName(addLoggedMsg.msgName);
+                // multi_id, msg_id, message name
+                if (header.msgSize < 3) {
+                    break;
+                }
+                uint16_t msgID;
+                memcpy(&msgID, msg + ULOG_MSG_HEADER_LEN + 1, 2);
+                QString messageName = QString::fromLatin1(msg + ULOG_MSG_HEADER_LEN + 3, header.msgSize - 3);
 
                 if(messageName.contains(QLatin1Literal("camera_capture"))) {
-                    _cameraCaptureMsgID = addLoggedMsg.msgID;
+                    _cameraCaptureMsgID = msgID;
                     geotagFound = true;
                 }
 
@@ -142,24 +153,26 @@ bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedb
             case (int)ULogMessageType::DATA:
             {
                 uint16_t msgID = -1;
-                memcpy(&msgID, log.data() + index + ULOG_MSG_HEADER_LEN, 2);
+                memcpy(&msgID, msg + ULOG_MSG_HEADER_LEN, 2);
 
-                if (geotagFound && msgID == _cameraCaptureMsgID) {
+                if (geotagFound && msgID == _cameraCaptureMsgID && header.msgSize >= 2 + _cameraCaptureSize) {
 
                     // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
                     GeoTagWorker::cameraFeedbackPacket feedback;
                     memset(&feedback, 0, sizeof(feedback));
-                    memcpy(&feedback.timestamp, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("timestamp")), 8);
-                    feedback.timestamp /= 1.0e6; // to seconds
-                    memcpy(&feedback.timestampUTC, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("timestamp_utc")), 8);
-                    feedback.timestampUTC /= 1.0e6; // to seconds
-                    memcpy(&feedback.imageSequence, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("seq")), 4);
-                    memcpy(&feedback.latitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("lat")), 8);
-                    memcpy(&feedback.longitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("lon")), 8);
+                    // Timestamps are uint64_t microseconds
+                    uint64_t timestampUSecs;
+                    memcpy(&timestampUSecs, msg + 5 + _cameraCaptureOffsets.value(QStringLiteral("timestamp")), 8);
+                    feedback.timestamp = timestampUSecs / 1.0e6; // to seconds
+                    memcpy(&timestampUSecs, msg + 5 + _cameraCaptureOffsets.value(QStringLiteral("timestamp_utc")), 8);
+                    feedback.timestampUTC = timestampUSecs / 1.0e6; // to seconds
+                    memcpy(&feedback.imageSequence, msg + 5 + _cameraCaptureOffsets.value(QStringLiteral("seq")), 4);
+                    memcpy(&feedback.latitude, msg + 5 + _cameraCaptureOffsets.value(QStringLiteral("lat")), 8);
+                    memcpy(&feedback.longitude, msg + 5 + _cameraCaptureOffsets.value(QStringLiteral("lon")), 8);
                     feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                    memcpy(&feedback.altitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("alt")), 4);
-                    memcpy(&feedback.groundDistance, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("ground_distance")), 4);
-                    memcpy(&feedback.captureResult, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("result")), 1);
+                    memcpy(&feedback.altitude, msg + 5 + _cameraCaptureOffsets.value(QStringLiteral("alt")), 4);
+                    memcpy(&feedback.groundDistance, msg + 5 + _cameraCaptureOffsets.value(QStringLiteral("ground_distance")), 4);
+                    memcpy(&feedback.captureResult, msg + 5 + _cameraCaptureOffsets.value(QStringLiteral("result")), 1);
 
                     cameraFeedback.append(feedback);
 
@@ -172,7 +185,7 @@ bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedb
                 break;
         }
 
-        index += (3 + header.msgSize);
+        reader.skip(msgLen);
 
     }
 
@@ -4,6 +4,7 @@
 #include <QGeoCoordinate>
 #include <QDebug>
 #include <QCoreApplication>
+#include <QIODevice>
 
 #include "GeoTagController.h"
 
@@ -17,12 +18,14 @@ public:
     ULogParser();
     ~ULogParser();
 
-    /// @return true: failed, errorMessage set
-    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage);
+    /// Parses the log a message at a time, only a chunk of the file is held in memory
+    /// @return false: failed, errorMessage set
+    bool getTagsFromLog(QIODevice& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage);
 
 private:
 
     QMap<QString, int> _cameraCaptureOffsets; // <fieldName, fieldOffset>
+    int _cameraCaptureSize;
     int _cameraCaptureMsgID;
 
     const char _ULogMagic[8] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
@@ -51,22 +54,6 @@ private:
         uint8_t msgType;
     };
 
-    struct ULogMessageFormat {
-        uint16_t msgSize;
-        uint8_t msgType;
-
-        char format[2096];
-    };
-
-    struct ULogMessageAddLogged {
-	  uint16_t msgSize;
-      uint8_t msgType;
-
-	  uint8_t multiID;
-	  uint16_t msgID;
-	  char msgName[255];
-	};
-
 };
 
 #endif // ULOGPARSER_H
@@ -77,7 +77,10 @@ APMSensorsComponentController::APMSensorsComponentController(void)
         qWarning() << "Sensors component is missing";
     }
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    MAVLinkMessageDispatcher* dispatcher = _vehicle->messageDispatcher();
+    dispatcher->subscribe(this, MAVLINK_MSG_ID_COMMAND_ACK,         [this](LinkInterface*, const mavlink_message_t& message) { _handleCommandAck(message); },       _vehicle->id());
+    dispatcher->subscribe(this, MAVLINK_MSG_ID_MAG_CAL_PROGRESS,    [this](LinkInterface*, const mavlink_message_t& message) { _handleMagCalProgress(message); },   _vehicle->id());
+    dispatcher->subscribe(this, MAVLINK_MSG_ID_MAG_CAL_REPORT,      [this](LinkInterface*, const mavlink_message_t& message) { _handleMagCalReport(message); },     _vehicle->id());
 }
 
 APMSensorsComponentController::~APMSensorsComponentController()
@@ -726,7 +729,7 @@ bool APMSensorsComponentController::usingUDPLink(void)
     return _vehicle->priorityLink()->getLinkConfiguration()->type() == LinkConfiguration::TypeUdp;
 }
 
-void APMSensorsComponentController::_handleCommandAck(mavlink_message_t& message)
+void APMSensorsComponentController::_handleCommandAck(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeLevelHorizon) {
         mavlink_command_ack_t commandAck;
@@ -765,7 +768,7 @@ void APMSensorsComponentController::_handleCommandAck(mavlink_message_t& message
     }
 }
 
-void APMSensorsComponentController::_handleMagCalProgress(mavlink_message_t& message)
+void APMSensorsComponentController::_handleMagCalProgress(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeOnboardCompass) {
         mavlink_mag_cal_progress_t magCalProgress;
@@ -793,7 +796,7 @@ void APMSensorsComponentController::_handleMagCalProgress(mavlink_message_t& mes
     }
 }
 
-void APMSensorsComponentController::_handleMagCalReport(mavlink_message_t& message)
+void APMSensorsComponentController::_handleMagCalReport(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeOnboardCompass) {
         mavlink_mag_cal_report_t magCalReport;
@@ -841,27 +844,6 @@ void APMSensorsComponentController::_handleMagCalReport(mavlink_message_t& messa
     }
 }
 
-void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
-{
-    Q_UNUSED(link);
-
-    if (message.sysid != _vehicle->id()) {
-        return;
-    }
-
-    switch (message.msgid) {
-    case MAVLINK_MSG_ID_COMMAND_ACK:
-        _handleCommandAck(message);
-        break;
-    case MAVLINK_MSG_ID_MAG_CAL_PROGRESS:
-        _handleMagCalProgress(message);
-        break;
-    case MAVLINK_MSG_ID_MAG_CAL_REPORT:
-        _handleMagCalReport(message);
-        break;
-    }
-}
-
 void APMSensorsComponentController::_restorePreviousCompassCalFitness(void)
 {
     if (_restoreCompassCalFitness) {
@@ -133,7 +133,6 @@ signals:
 
 private slots:
     void _handleUASTextMessage(int uasId, int compId, int severity, QString text);
-    void _mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message);
     void _mavCommandResult(int vehicleId, int component, int command, int result, bool noReponseFromVehicle);
 
 private:
@@ -143,9 +142,9 @@ private:
     void _refreshParams(void);
     void _hideAllCalAreas(void);
     void _resetInternalState(void);
-    void _handleCommandAck(mavlink_message_t& message);
-    void _handleMagCalProgress(mavlink_message_t& message);
-    void _handleMagCalReport(mavlink_message_t& message);
+    void _handleCommandAck(const mavlink_message_t& message);
+    void _handleMagCalProgress(const mavlink_message_t& message);
+    void _handleMagCalReport(const mavlink_message_t& message);
     void _restorePreviousCompassCalFitness(void);
 
     enum StopCalibrationCode {
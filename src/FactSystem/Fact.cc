@@ -12,6 +12,7 @@
 #include "QGCMAVLink.h"
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
+#include "FactGroupUpdateScheduler.h"
 
 #include <QtQml>
 #include <QQmlEngine>
@@ -26,6 +27,7 @@ Fact::Fact(QObject* parent)
     , _metaData                 (nullptr)
     , _sendValueChangedSignals  (true)
     , _deferredValueChangeSignal(false)
+    , _valueChangedSignalCount  (0)
     , _valueSliderModel         (nullptr)
     , _ignoreQGCRebootRequired  (false)
 {    
@@ -44,6 +46,7 @@ Fact::Fact(int componentId, QString name, FactMetaData::ValueType_t type, QObjec
     , _metaData                 (nullptr)
     , _sendValueChangedSignals  (true)
     , _deferredValueChangeSignal(false)
+    , _valueChangedSignalCount  (0)
     , _valueSliderModel         (nullptr)
     , _ignoreQGCRebootRequired  (false)
 {
@@ -62,6 +65,7 @@ Fact::Fact(const QString& settingsGroup, FactMetaData* metaData, QObject* parent
     , _metaData                 (nullptr)
     , _sendValueChangedSignals  (true)
     , _deferredValueChangeSignal(false)
+    , _valueChangedSignalCount  (0)
     , _valueSliderModel         (nullptr)
     , _ignoreQGCRebootRequired  (false)
 {
@@ -93,6 +97,8 @@ const Fact& Fact::operator=(const Fact& other)
     _type                       = other._type;
     _sendValueChangedSignals    = other._sendValueChangedSignals;
     _deferredValueChangeSignal  = other._deferredValueChangeSignal;
+    _lastSignalledRawValue      = other._lastSignalledRawValue;
+    _valueChangedSignalCount    = 0;
     _valueSliderModel           = nullptr;
     _ignoreQGCRebootRequired    = other._ignoreQGCRebootRequired;
     if (_metaData && other._metaData) {
@@ -640,19 +646,28 @@ void Fact::setSendValueChangedSignals (bool sendValueChangedSignals)
 void Fact::_sendValueChangedSignal(QVariant value)
 {
     if (_sendValueChangedSignals) {
+        _lastSignalledRawValue = _rawValue;
+        _valueChangedSignalCount++;
         emit valueChanged(value);
         _deferredValueChangeSignal = false;
     } else {
         _deferredValueChangeSignal = true;
+        FactGroupUpdateScheduler::instance()->markDirty();
     }
 }
 
-void Fact::sendDeferredValueChangedSignal(void)
+bool Fact::sendDeferredValueChangedSignal(void)
 {
     if (_deferredValueChangeSignal) {
         _deferredValueChangeSignal = false;
-        emit valueChanged(cookedValue());
+        if (_rawValue != _lastSignalledRawValue) {
+            _lastSignalledRawValue = _rawValue;
+            _valueChangedSignalCount++;
+            emit valueChanged(cookedValue());
+            return true;
+        }
     }
+    return false;
 }
 
 QString Fact::enumOrValueString(void)
@@ -152,7 +152,14 @@ public:
     bool sendValueChangedSignals (void) const { return _sendValueChangedSignals; }
     bool deferredValueChangeSignal(void) const { return _deferredValueChangeSignal; }
     void clearDeferredValueChangeSignal(void) { _deferredValueChangeSignal = false; }
-    void sendDeferredValueChangedSignal(void);
+
+    /// Sends a deferred valueChanged signal. The signal is only sent if the raw value is different from the value
+    /// at the time of the last signal, so a value which changes and then changes back between updates is not signalled.
+    /// @return true: valueChanged was signalled
+    bool sendDeferredValueChangedSignal(void);
+
+    /// @return Number of valueChanged signals sent for value changes
+    quint32 valueChangedSignalCount(void) const { return _valueChangedSignalCount; }
 
     // C++ methods
 
@@ -212,6 +219,8 @@ protected:
     FactMetaData*               _metaData;
     bool                        _sendValueChangedSignals;
     bool                        _deferredValueChangeSignal;
+    QVariant                    _lastSignalledRawValue;     ///< Raw value at the time of the last valueChanged signal
+    quint32                     _valueChangedSignalCount;
     FactValueSliderListModel*   _valueSliderModel;
     bool                        _ignoreQGCRebootRequired;
 };
@@ -9,6 +9,7 @@
 
 
 #include "FactGroup.h"
+#include "FactGroupUpdateScheduler.h"
 #include "JsonHelper.h"
 
 #include <QJsonDocument>
@@ -25,7 +26,7 @@ FactGroup::FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject*
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
 {
-    _setupTimer();
+    _setupUpdates();
     _nameToFactMetaDataMap = FactMetaData::createMapFromJsonFile(metaDataFile, this);
 }
 
@@ -34,7 +35,14 @@ FactGroup::FactGroup(int updateRateMsecs, QObject* parent, bool ignoreCamelCase)
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
 {
-    _setupTimer();
+    _setupUpdates();
+}
+
+FactGroup::~FactGroup()
+{
+    if (_updateRateMSecs > 0) {
+        FactGroupUpdateScheduler::instance()->removeFactGroup(this);
+    }
 }
 
 void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
@@ -43,14 +51,43 @@ void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
     _nameToFactMetaDataMap = FactMetaData::createMapFromJsonArray(jsonArray, defineMap, this);
 }
 
-void FactGroup::_setupTimer()
+/// Rate limited groups don't run their own timer. Instead all groups are updated from a single global update frame
+/// so that value changes across all groups land in the same ui frame.
+void FactGroup::_setupUpdates()
 {
     if (_updateRateMSecs > 0) {
-        connect(&_updateTimer, &QTimer::timeout, this, &FactGroup::_updateAllValues);
-        _updateTimer.setSingleShot(false);
-        _updateTimer.setInterval(_updateRateMSecs);
-        _updateTimer.start();
+        FactGroupUpdateScheduler::instance()->addFactGroup(this);
+    }
+}
+
+bool FactGroup::updateFrame(qint64 frameTimeMSecs)
+{
+    if (_liveUpdates) {
+        return false;
+    }
+    if (frameTimeMSecs < _nextUpdateMSecs) {
+        return _hasDeferredChanges();
+    }
+
+    // Stay on the group update interval, but don't try to catch up on missed frames
+    _nextUpdateMSecs += _updateRateMSecs;
+    if (_nextUpdateMSecs <= frameTimeMSecs) {
+        _nextUpdateMSecs = frameTimeMSecs + _updateRateMSecs;
     }
+
+    _updateAllValues();
+
+    return false;
+}
+
+bool FactGroup::_hasDeferredChanges(void) const
+{
+    for (const Fact* fact: _nameToFactMap) {
+        if (fact->deferredValueChangeSignal()) {
+            return true;
+        }
+    }
+    return false;
 }
 
 Fact* FactGroup::getFact(const QString& name)
@@ -127,21 +164,23 @@ void FactGroup::_addFactGroup(FactGroup* factGroup, const QString& name)
 void FactGroup::_updateAllValues(void)
 {
     for(Fact* fact: _nameToFactMap) {
-        fact->sendDeferredValueChangedSignal();
+        if (fact->deferredValueChangeSignal()) {
+            if (fact->sendDeferredValueChangedSignal()) {
+                _valueChangedSignalCount++;
+            } else {
+                _suppressedSignalCount++;
+            }
+        }
     }
 }
 
 void FactGroup::setLiveUpdates(bool liveUpdates)
 {
-    if (_updateTimer.interval() == 0) {
+    if (_updateRateMSecs == 0) {
         return;
     }
 
-    if (liveUpdates) {
-        _updateTimer.stop();
-    } else {
-        _updateTimer.start();
-    }
+    _liveUpdates = liveUpdates;
     for(Fact* fact: _nameToFactMap) {
         fact->setSendValueChangedSignals(liveUpdates);
     }
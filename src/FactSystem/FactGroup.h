@@ -16,18 +16,21 @@
 
 #include <QStringList>
 #include <QMap>
-#include <QTimer>
 
 Q_DECLARE_LOGGING_CATEGORY(VehicleLog)
+Q_DECLARE_LOGGING_CATEGORY(FactGroupLog)
 
 /// Used to group Facts together into an object hierarachy.
 class FactGroup : public QObject
 {
     Q_OBJECT
+
+    friend class FactGroupUpdateScheduler;
     
 public:
     FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent = nullptr, bool ignoreCamelCase = false);
     FactGroup(int updateRateMsecs, QObject* parent = nullptr, bool ignoreCamelCase = false);
+    ~FactGroup();
 
     Q_PROPERTY(QStringList factNames        READ factNames      CONSTANT)
     Q_PROPERTY(QStringList factGroupNames   READ factGroupNames CONSTANT)
@@ -44,6 +47,17 @@ public:
     QStringList factNames(void) const { return _factNames; }
     QStringList factGroupNames(void) const { return _nameToFactGroupMap.keys(); }
 
+    /// @return Number of deferred valueChanged signals sent by this group
+    quint64 valueChangedSignalCount(void) const { return _valueChangedSignalCount; }
+
+    /// @return Number of deferred valueChanged signals which were dropped since the value was back to the last signalled value
+    quint64 suppressedSignalCount(void) const { return _suppressedSignalCount; }
+
+    /// Called by FactGroupUpdateScheduler on each update frame. Sends deferred value changes if the group update
+    /// interval has elapsed.
+    /// @return true: group still has deferred value changes waiting for the next update interval
+    bool updateFrame(qint64 frameTimeMSecs);
+
 protected slots:
     virtual void _updateAllValues(void);
 
@@ -60,11 +74,15 @@ protected:
     QStringList                     _factNames;
 
 private:
-    void    _setupTimer (void);
-    QString _camelCase  (const QString& text);
-
-    bool    _ignoreCamelCase = false;
-    QTimer  _updateTimer;
+    void    _setupUpdates           (void);
+    bool    _hasDeferredChanges     (void) const;
+    QString _camelCase              (const QString& text);
+
+    bool    _ignoreCamelCase            = false;
+    bool    _liveUpdates                = false;
+    qint64  _nextUpdateMSecs            = 0;
+    quint64 _valueChangedSignalCount    = 0;
+    quint64 _suppressedSignalCount      = 0;
 };
 
 #endif
@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupTest.h"
+#include "FactGroupUpdateScheduler.h"
+
+FactGroupTestGroup::FactGroupTestGroup(QObject* parent)
+    : FactGroup (updateRateMSecs, parent)
+    , alphaFact (0, QStringLiteral("alpha"),    FactMetaData::valueTypeDouble)
+    , betaFact  (0, QStringLiteral("beta"),     FactMetaData::valueTypeDouble)
+{
+    alphaFact.setMetaData(new FactMetaData(FactMetaData::valueTypeDouble, this));
+    betaFact.setMetaData(new FactMetaData(FactMetaData::valueTypeDouble, this));
+
+    _addFact(&alphaFact, alphaFact.name());
+    _addFact(&betaFact,  betaFact.name());
+}
+
+/// Several value changes within a single update interval are signalled once, with the latest value
+void FactGroupTest::_coalesce_test(void)
+{
+    const int updateRateMSecs = FactGroupTestGroup::updateRateMSecs;
+
+    FactGroupUpdateScheduler*   scheduler = FactGroupUpdateScheduler::instance();
+    FactGroupTestGroup          factGroup;
+    QSignalSpy                  spyAlpha(&factGroup.alphaFact, &Fact::valueChanged);
+
+    // Nothing to signal, so there are no update frames running
+    QTRY_VERIFY(!scheduler->isFrameTimerActive());
+
+    factGroup.alphaFact._containerSetRawValue(1.0);
+    factGroup.alphaFact._containerSetRawValue(2.0);
+    factGroup.alphaFact._containerSetRawValue(3.0);
+    QCOMPARE(spyAlpha.count(), 0);
+    QVERIFY(scheduler->isFrameTimerActive());
+
+    QTRY_COMPARE_WITH_TIMEOUT(spyAlpha.count(), 1, updateRateMSecs * 10);
+    QCOMPARE(spyAlpha[0][0].toDouble(), 3.0);
+
+    // No further signals, and the frames stop once there is nothing left to signal
+    QTRY_VERIFY_WITH_TIMEOUT(!scheduler->isFrameTimerActive(), updateRateMSecs * 10);
+    QTest::qWait(updateRateMSecs * 3);
+    QCOMPARE(spyAlpha.count(), 1);
+}
+
+/// A value which changes and then changes back before the update is not signalled
+void FactGroupTest::_unchangedValue_test(void)
+{
+    const int updateRateMSecs = FactGroupTestGroup::updateRateMSecs;
+
+    FactGroupTestGroup  factGroup;
+    QSignalSpy          spyAlpha(&factGroup.alphaFact, &Fact::valueChanged);
+
+    factGroup.alphaFact._containerSetRawValue(1.0);
+    QTRY_COMPARE_WITH_TIMEOUT(spyAlpha.count(), 1, updateRateMSecs * 10);
+
+    factGroup.alphaFact._containerSetRawValue(2.0);
+    factGroup.alphaFact._containerSetRawValue(1.0);
+    QTRY_COMPARE_WITH_TIMEOUT(factGroup.suppressedSignalCount(), static_cast<quint64>(1), updateRateMSecs * 10);
+    QTest::qWait(updateRateMSecs * 3);
+    QCOMPARE(spyAlpha.count(), 1);
+    QCOMPARE(factGroup.valueChangedSignalCount(), static_cast<quint64>(1));
+}
+
+void FactGroupTest::_signalCounts_test(void)
+{
+    const int updateRateMSecs = FactGroupTestGroup::updateRateMSecs;
+
+    FactGroupTestGroup  factGroup;
+    QSignalSpy          spyAlpha(&factGroup.alphaFact, &Fact::valueChanged);
+    QSignalSpy          spyBeta (&factGroup.betaFact,  &Fact::valueChanged);
+
+    // Alpha is signalled in two separate updates, beta in the first only
+    factGroup.alphaFact._containerSetRawValue(1.0);
+    factGroup.betaFact._containerSetRawValue(1.0);
+    QTRY_COMPARE_WITH_TIMEOUT(spyAlpha.count(), 1, updateRateMSecs * 10);
+    QCOMPARE(spyBeta.count(), 1);
+
+    factGroup.alphaFact._containerSetRawValue(2.0);
+    QTRY_COMPARE_WITH_TIMEOUT(spyAlpha.count(), 2, updateRateMSecs * 10);
+    QTest::qWait(updateRateMSecs * 3);
+    QCOMPARE(spyBeta.count(), 1);
+
+    QCOMPARE(factGroup.alphaFact.valueChangedSignalCount(), static_cast<quint32>(2));
+    QCOMPARE(factGroup.betaFact.valueChangedSignalCount(),  static_cast<quint32>(1));
+    QCOMPARE(factGroup.valueChangedSignalCount(),           static_cast<quint64>(3));
+    QCOMPARE(factGroup.suppressedSignalCount(),             static_cast<quint64>(0));
+
+    QStringList report = FactGroupUpdateScheduler::instance()->churnReport(100);
+    QVERIFY(report.contains(QStringLiteral("FactGroupTestGroup: signalled 3 suppressed 0")));
+    QVERIFY(report.contains(QStringLiteral("FactGroupTestGroup.alpha: signalled 2")));
+    QVERIFY(report.contains(QStringLiteral("FactGroupTestGroup.beta: signalled 1")));
+}
@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "FactGroup.h"
+
+/// Rate limited FactGroup with two facts used by FactGroupTest
+class FactGroupTestGroup : public FactGroup
+{
+    Q_OBJECT
+
+public:
+    FactGroupTestGroup(QObject* parent = nullptr);
+
+    Fact alphaFact;
+    Fact betaFact;
+
+    static const int updateRateMSecs = 100;
+};
+
+/// Unit test for rate limited FactGroup signalling through FactGroupUpdateScheduler
+class FactGroupTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _coalesce_test         (void);
+    void _unchangedValue_test   (void);
+    void _signalCounts_test     (void);
+};
@@ -0,0 +1,140 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupUpdateScheduler.h"
+#include "FactGroup.h"
+
+#include <QGuiApplication>
+#include <QScreen>
+#include <QMap>
+
+static FactGroupUpdateScheduler* _instance = nullptr;
+
+FactGroupUpdateScheduler* FactGroupUpdateScheduler::instance(void)
+{
+    if (!_instance) {
+        _instance = new FactGroupUpdateScheduler();
+        Q_CHECK_PTR(_instance);
+    }
+
+    return _instance;
+}
+
+FactGroupUpdateScheduler::FactGroupUpdateScheduler(void)
+{
+    int frameIntervalMSecs = _defaultFrameIntervalMSecs;
+    QScreen* screen = QGuiApplication::primaryScreen();
+    if (screen && screen->refreshRate() > 1) {
+        frameIntervalMSecs = qBound(4, static_cast<int>(1000.0 / screen->refreshRate()), 100);
+    }
+
+    _frameTimer.setTimerType(Qt::PreciseTimer);
+    _frameTimer.setInterval(frameIntervalMSecs);
+    connect(&_frameTimer, &QTimer::timeout, this, &FactGroupUpdateScheduler::_updateFrame);
+
+    _churnLogTimer.setInterval(_churnLogIntervalMSecs);
+    connect(&_churnLogTimer, &QTimer::timeout, this, &FactGroupUpdateScheduler::_logChurn);
+
+    _frameClock.start();
+}
+
+void FactGroupUpdateScheduler::addFactGroup(FactGroup* factGroup)
+{
+    if (!_factGroups.contains(factGroup)) {
+        _factGroups.append(factGroup);
+    }
+    // Churn reporting is only needed when someone is going to look at it
+    if (!_churnLogTimer.isActive() && FactGroupLog().isDebugEnabled()) {
+        _churnLogTimer.start();
+    }
+}
+
+void FactGroupUpdateScheduler::removeFactGroup(FactGroup* factGroup)
+{
+    _factGroups.removeOne(factGroup);
+    if (_factGroups.isEmpty()) {
+        _frameTimer.stop();
+        _churnLogTimer.stop();
+    }
+}
+
+void FactGroupUpdateScheduler::markDirty(void)
+{
+    _dirty = true;
+    if (!_frameTimer.isActive() && !_factGroups.isEmpty()) {
+        _frameTimer.start();
+    }
+}
+
+void FactGroupUpdateScheduler::_updateFrame(void)
+{
+    qint64  frameTimeMSecs  = _frameClock.elapsed();
+    bool    pending         = false;
+
+    _dirty = false;
+
+    // Index based since signalling a value change can lead to groups being removed
+    for (int i = 0; i < _factGroups.count(); i++) {
+        if (_factGroups[i]->updateFrame(frameTimeMSecs)) {
+            pending = true;
+        }
+    }
+
+    // Nothing changed during this frame and nothing is waiting on a group update interval
+    if (!pending && !_dirty) {
+        _frameTimer.stop();
+    }
+}
+
+QStringList FactGroupUpdateScheduler::churnReport(int maxEntries) const
+{
+    QMap<QString, quint64>  groupSignalCounts;
+    QMap<QString, quint64>  groupSuppressedCounts;
+    QMap<QString, quint64>  factSignalCounts;
+
+    for (FactGroup* factGroup: _factGroups) {
+        QString groupName = factGroup->metaObject()->className();
+        groupSignalCounts[groupName]        += factGroup->valueChangedSignalCount();
+        groupSuppressedCounts[groupName]    += factGroup->suppressedSignalCount();
+        for (auto iter = factGroup->_nameToFactMap.constBegin(); iter != factGroup->_nameToFactMap.constEnd(); iter++) {
+            factSignalCounts[QStringLiteral("%1.%2").arg(groupName).arg(iter.key())] += iter.value()->valueChangedSignalCount();
+        }
+    }
+
+    QList<QPair<quint64, QString>> rgGroups;
+    for (auto iter = groupSignalCounts.constBegin(); iter != groupSignalCounts.constEnd(); iter++) {
+        rgGroups.append(qMakePair(iter.value(), iter.key()));
+    }
+    QList<QPair<quint64, QString>> rgFacts;
+    for (auto iter = factSignalCounts.constBegin(); iter != factSignalCounts.constEnd(); iter++) {
+        rgFacts.append(qMakePair(iter.value(), iter.key()));
+    }
+    auto busiestFirst = [](const QPair<quint64, QString>& a, const QPair<quint64, QString>& b) { return a.first > b.first; };
+    std::sort(rgGroups.begin(), rgGroups.end(), busiestFirst);
+    std::sort(rgFacts.begin(), rgFacts.end(), busiestFirst);
+
+    QStringList report;
+    for (const auto& group: rgGroups) {
+        report.append(QStringLiteral("%1: signalled %2 suppressed %3").arg(group.second).arg(group.first).arg(groupSuppressedCounts[group.second]));
+    }
+    for (int i = 0; i < qMin(maxEntries, rgFacts.count()); i++) {
+        report.append(QStringLiteral("%1: signalled %2").arg(rgFacts[i].second).arg(rgFacts[i].first));
+    }
+
+    return report;
+}
+
+void FactGroupUpdateScheduler::_logChurn(void)
+{
+    if (FactGroupLog().isDebugEnabled()) {
+        for (const QString& line: churnReport(_churnLogMaxEntries)) {
+            qCDebug(FactGroupLog) << line;
+        }
+    }
+}
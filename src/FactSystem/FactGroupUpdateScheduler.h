@@ -0,0 +1,63 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QList>
+#include <QStringList>
+
+class FactGroup;
+
+/// Drives the deferred valueChanged signalling for all rate limited FactGroups from a single timer running at the
+/// display refresh interval. Each frame only the groups whose update interval has elapsed are visited, and within
+/// those only facts whose value actually changed are signalled. This keeps all ui binding updates for a frame
+/// together instead of being spread across a timer per FactGroup.
+///
+/// The frame timer only runs while there are deferred value changes. It is started when a fact is marked dirty and
+/// stops after a frame with nothing left to signal.
+class FactGroupUpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static FactGroupUpdateScheduler* instance(void);
+
+    void addFactGroup   (FactGroup* factGroup);
+    void removeFactGroup(FactGroup* factGroup);
+
+    /// Called when a fact in a rate limited group has a deferred value change. Starts the update frames if needed.
+    void markDirty(void);
+
+    int  frameIntervalMSecs (void) const { return _frameTimer.interval(); }
+    bool isFrameTimerActive (void) const { return _frameTimer.isActive(); }
+
+    /// @return Per FactGroup type and per Fact valueChanged signal counts, busiest first
+    ///     @param maxEntries Maximum number of Fact entries to return
+    QStringList churnReport(int maxEntries) const;
+
+private slots:
+    void _updateFrame   (void);
+    void _logChurn      (void);
+
+private:
+    FactGroupUpdateScheduler(void);
+
+    QList<FactGroup*>   _factGroups;
+    QTimer              _frameTimer;
+    QTimer              _churnLogTimer;
+    QElapsedTimer       _frameClock;
+    bool                _dirty = false;     ///< A fact was marked dirty since the last frame
+
+    static const int _defaultFrameIntervalMSecs = 16;
+    static const int _churnLogIntervalMSecs     = 10000;
+    static const int _churnLogMaxEntries        = 20;
+};
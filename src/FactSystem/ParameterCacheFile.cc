@@ -0,0 +1,293 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterCacheFile.h"
+#include "QGC.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <cstring>
+
+const char* ParameterCacheFile::_magic = "QPC3";
+
+ParameterCacheFile::~ParameterCacheFile()
+{
+    close();
+}
+
+void ParameterCacheFile::close(void)
+{
+    if (_map) {
+        _file.unmap(const_cast<uchar*>(_map));
+    }
+    _file.close();
+    _map    = nullptr;
+    _names  = nullptr;
+    _values = nullptr;
+    _types  = nullptr;
+    _hash   = 0;
+    _count  = 0;
+}
+
+bool ParameterCacheFile::open(const QString& fileName, QString& errorString)
+{
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        errorString = _file.errorString();
+        return false;
+    }
+
+    qint64 fileSize = _file.size();
+    if (fileSize < _headerSize) {
+        errorString = QStringLiteral("File too small");
+        close();
+        return false;
+    }
+
+    const uchar* map = _file.map(0, fileSize);
+    if (!map) {
+        errorString = _file.errorString();
+        close();
+        return false;
+    }
+    _map = map;
+
+    if (memcmp(map, _magic, 4) != 0 || qFromLittleEndian<quint32>(map + 4) != _formatVersion) {
+        errorString = QStringLiteral("Unknown cache format");
+        close();
+        return false;
+    }
+
+    quint32 hash        = qFromLittleEndian<quint32>(map + 8);
+    quint32 count       = qFromLittleEndian<quint32>(map + 12);
+    quint32 checksum    = qFromLittleEndian<quint32>(map + 16);
+
+    // Each parameter takes a name, a value and a type
+    qint64 bodySize = static_cast<qint64>(count) * (nameLength + 8 + 1);
+    if (fileSize != _headerSize + bodySize) {
+        errorString = QStringLiteral("Size does not match parameter count");
+        close();
+        return false;
+    }
+    if (QGC::crc32(map + _headerSize, static_cast<unsigned>(bodySize), 0) != checksum) {
+        errorString = QStringLiteral("Checksum mismatch");
+        close();
+        return false;
+    }
+
+    _hash   = hash;
+    _count  = count;
+    _names  = reinterpret_cast<const char*>(map + _headerSize);
+    _values = map + _headerSize + count * nameLength;
+    _types  = _values + count * 8;
+
+    for (quint32 i = 0; i < count; i++) {
+        if (_types[i] > FactMetaData::valueTypeDouble) {
+            errorString = QStringLiteral("Invalid parameter type");
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QString ParameterCacheFile::name(int index) const
+{
+    const char* name = _names + (index * nameLength);
+    return QString::fromLatin1(name, static_cast<int>(strnlen(name, nameLength)));
+}
+
+FactMetaData::ValueType_t ParameterCacheFile::type(int index) const
+{
+    return static_cast<FactMetaData::ValueType_t>(_types[index]);
+}
+
+QVariant ParameterCacheFile::rawValue(int index) const
+{
+    return _decodeValue(type(index), qFromLittleEndian<quint64>(_values + (index * 8)));
+}
+
+int ParameterCacheFile::indexOf(const QString& name) const
+{
+    char key[nameLength] = {};
+    QByteArray latin1 = name.toLatin1();
+    if (latin1.length() > nameLength) {
+        return -1;
+    }
+    memcpy(key, latin1.constData(), static_cast<size_t>(latin1.length()));
+
+    // Names are sorted, zero padding sorts before any character
+    int lo = 0;
+    int hi = count() - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int result = memcmp(_names + (mid * nameLength), key, nameLength);
+        if (result == 0) {
+            return mid;
+        } else if (result < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+bool ParameterCacheFile::_encodeValue(FactMetaData::ValueType_t type, const QVariant& rawValue, quint64& bits)
+{
+    bits = 0;
+    switch (type) {
+    case FactMetaData::valueTypeUint8:
+        bits = static_cast<quint8>(rawValue.toUInt());
+        break;
+    case FactMetaData::valueTypeInt8:
+        bits = static_cast<quint8>(static_cast<qint8>(rawValue.toInt()));
+        break;
+    case FactMetaData::valueTypeUint16:
+        bits = static_cast<quint16>(rawValue.toUInt());
+        break;
+    case FactMetaData::valueTypeInt16:
+        bits = static_cast<quint16>(static_cast<qint16>(rawValue.toInt()));
+        break;
+    case FactMetaData::valueTypeUint32:
+        bits = rawValue.toUInt();
+        break;
+    case FactMetaData::valueTypeInt32:
+        bits = static_cast<quint32>(rawValue.toInt());
+        break;
+    case FactMetaData::valueTypeUint64:
+        bits = rawValue.toULongLong();
+        break;
+    case FactMetaData::valueTypeInt64:
+        bits = static_cast<quint64>(rawValue.toLongLong());
+        break;
+    case FactMetaData::valueTypeFloat:
+    {
+        float value = rawValue.toFloat();
+        quint32 floatBits;
+        memcpy(&floatBits, &value, sizeof(floatBits));
+        bits = floatBits;
+        break;
+    }
+    case FactMetaData::valueTypeDouble:
+    {
+        double value = rawValue.toDouble();
+        memcpy(&bits, &value, sizeof(bits));
+        break;
+    }
+    default:
+        return false;
+    }
+    return true;
+}
+
+QVariant ParameterCacheFile::_decodeValue(FactMetaData::ValueType_t type, quint64 bits)
+{
+    switch (type) {
+    case FactMetaData::valueTypeUint8:
+        return QVariant(static_cast<uint>(static_cast<quint8>(bits)));
+    case FactMetaData::valueTypeInt8:
+        return QVariant(static_cast<int>(static_cast<qint8>(bits)));
+    case FactMetaData::valueTypeUint16:
+        return QVariant(static_cast<uint>(static_cast<quint16>(bits)));
+    case FactMetaData::valueTypeInt16:
+        return QVariant(static_cast<int>(static_cast<qint16>(bits)));
+    case FactMetaData::valueTypeUint32:
+        return QVariant(static_cast<uint>(bits));
+    case FactMetaData::valueTypeInt32:
+        return QVariant(static_cast<int>(static_cast<quint32>(bits)));
+    case FactMetaData::valueTypeUint64:
+        return QVariant(static_cast<qulonglong>(bits));
+    case FactMetaData::valueTypeInt64:
+        return QVariant(static_cast<qlonglong>(bits));
+    case FactMetaData::valueTypeFloat:
+    {
+        quint32 floatBits = static_cast<quint32>(bits);
+        float value;
+        memcpy(&value, &floatBits, sizeof(value));
+        return QVariant(value);
+    }
+    case FactMetaData::valueTypeDouble:
+    {
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return QVariant(value);
+    }
+    default:
+        return QVariant();
+    }
+}
+
+quint32 ParameterCacheFile::addToHash(quint32 hash, const QString& name, FactMetaData::ValueType_t type, const QVariant& rawValue)
+{
+    quint64 bits;
+    if (!_encodeValue(type, rawValue, bits)) {
+        return hash;
+    }
+    uchar valueBytes[8];
+    qToLittleEndian<quint64>(bits, valueBytes);
+
+    QByteArray latin1 = name.toLatin1();
+    hash = QGC::crc32(reinterpret_cast<const quint8*>(latin1.constData()), static_cast<unsigned>(latin1.length()), hash);
+    hash = QGC::crc32(valueBytes, static_cast<unsigned>(FactMetaData::typeToSize(type)), hash);
+    return hash;
+}
+
+bool ParameterCacheFile::write(const QString& fileName, const QList<Param_t>& params, quint32 hash, QString& errorString)
+{
+    int count = params.count();
+    QByteArray body(count * (nameLength + 8 + 1), 0);
+    char* names     = body.data();
+    char* values    = names + (count * nameLength);
+    char* types     = values + (count * 8);
+
+    for (int i = 0; i < count; i++) {
+        const Param_t& param = params[i];
+
+        QByteArray latin1 = param.name.toLatin1();
+        if (latin1.length() > nameLength) {
+            errorString = QStringLiteral("Parameter name too long: %1").arg(param.name);
+            return false;
+        }
+        memcpy(names + (i * nameLength), latin1.constData(), static_cast<size_t>(latin1.length()));
+
+        quint64 bits;
+        if (!_encodeValue(param.type, param.rawValue, bits)) {
+            errorString = QStringLiteral("Unsupported parameter type: %1").arg(param.name);
+            return false;
+        }
+        qToLittleEndian<quint64>(bits, values + (i * 8));
+        types[i] = static_cast<char>(param.type);
+    }
+
+    uchar header[_headerSize] = {};
+    memcpy(header, _magic, 4);
+    qToLittleEndian<quint32>(_formatVersion, header + 4);
+    qToLittleEndian<quint32>(hash, header + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(count), header + 12);
+    qToLittleEndian<quint32>(QGC::crc32(reinterpret_cast<const quint8*>(body.constData()), static_cast<unsigned>(body.length()), 0), header + 16);
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorString = file.errorString();
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(header), _headerSize);
+    file.write(body);
+    if (!file.commit()) {
+        errorString = file.errorString();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QVariant>
+#include <QList>
+
+#include "FactMetaData.h"
+
+/// Binary, memory mapped cache of the parameter set of a single component.
+///
+/// File layout, all values little endian:
+///     header      magic, format version, parameter set hash, parameter count, checksum of everything after the header
+///     names       count * 16 byte parameter names, sorted, zero padded (same as a MAVLink param_id)
+///     values      count * 8 byte values, the low bytes holding the parameter type's value
+///     types       count * 1 byte FactMetaData::ValueType_t
+///
+/// The hash of the parameter set is calculated once when the cache is written, the same way the vehicle calculates
+/// its _HASH_CHECK value, so checking the cache against the vehicle only needs the header. Reading a cache maps the
+/// file and validates its layout and checksum without building any per parameter structures.
+class ParameterCacheFile
+{
+public:
+    ParameterCacheFile(void) = default;
+    ~ParameterCacheFile();
+
+    typedef struct {
+        QString                     name;
+        FactMetaData::ValueType_t   type;
+        QVariant                    rawValue;
+    } Param_t;
+
+    /// Maps and validates the cache file
+    ///     @return false: no usable cache, errorString set
+    bool open(const QString& fileName, QString& errorString);
+    void close(void);
+
+    quint32                     hash        (void) const { return _hash; }
+    int                         count       (void) const { return static_cast<int>(_count); }
+    QString                     name        (int index) const;
+    FactMetaData::ValueType_t   type        (int index) const;
+    QVariant                    rawValue    (int index) const;
+
+    /// @return Index of the named parameter, -1 if not in the cache
+    int indexOf(const QString& name) const;
+
+    /// Writes a cache file. params must be sorted by name. The file is replaced atomically.
+    ///     @param hash Parameter set hash as calculated by addToHash
+    ///     @return false: write failed, errorString set
+    static bool write(const QString& fileName, const QList<Param_t>& params, quint32 hash, QString& errorString);
+
+    /// Adds a parameter to a parameter set hash, the same way as the vehicle does for _HASH_CHECK
+    static quint32 addToHash(quint32 hash, const QString& name, FactMetaData::ValueType_t type, const QVariant& rawValue);
+
+    static const int nameLength = 16;
+
+private:
+    static bool     _encodeValue    (FactMetaData::ValueType_t type, const QVariant& rawValue, quint64& bits);
+    static QVariant _decodeValue    (FactMetaData::ValueType_t type, quint64 bits);
+
+    static const char*      _magic;
+    static const quint32    _formatVersion  = 1;
+    static const int        _headerSize     = 24;
+
+    QFile           _file;
+    const uchar*    _map        = nullptr;
+    const char*     _names      = nullptr;
+    const uchar*    _values     = nullptr;
+    const uchar*    _types      = nullptr;
+    quint32         _hash       = 0;
+    quint32         _count      = 0;
+};
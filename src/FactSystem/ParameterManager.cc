@@ -108,6 +108,10 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     _waitingParamTimeoutTimer.setInterval(3000);
     connect(&_waitingParamTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
 
+    _indexRequestTimer.setInterval(50);
+    connect(&_indexRequestTimer, &QTimer::timeout, this, &ParameterManager::_indexRequestTimeout);
+    _indexRequestClock.start();
+
     connect(_vehicle->uas(), &UASInterface::parameterUpdate, this, &ParameterManager::_parameterUpdate);
 
     // Ensure the cache directory exists
@@ -281,8 +285,8 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
 
     // Remove this parameter from the waiting lists
     if (_waitingReadParamIndexMap[componentId].contains(parameterId)) {
+        _indexRequestReceived(componentId, parameterId);
         _waitingReadParamIndexMap[componentId].remove(parameterId);
-        _indexBatchQueue.removeOne(parameterId);
         _fillIndexBatchQueue(false /* waitingParamTimeout */);
     }
     _waitingReadParamNameMap[componentId].remove(parameterName);
@@ -672,8 +676,8 @@ int  ParameterManager::getComponentId(const QString& category)
     return (_componentCategoryHash.contains(category)) ? _componentCategoryHash.value(category) : _vehicle->defaultComponentId();
 }
 
-/// Requests missing index based parameters from the vehicle.
-///     @param waitingParamTimeout: true: being called due to timeout, false: being called to re-fill the batch queue
+/// Requests missing index based parameters from the vehicle, keeping each component's request window full.
+///     @param waitingParamTimeout: true: being called due to timeout, false: being called to re-fill the request windows
 /// return true: Parameters were requested, false: No more requests needed
 bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
 {
@@ -681,48 +685,141 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
         return false;
     }
 
-    const int maxBatchSize = 10;
-
     if (waitingParamTimeout) {
-        // We timed out, clear the queue and try again
-        qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to timeout";
-        _indexBatchQueue.clear();
+        // Nothing at all arrived for a while, everything in flight is lost. Start over from a small window.
+        qCDebug(ParameterManagerLog) << "Refilling index based request windows due to timeout";
+        for (RequestWindow_t& requestWindow: _indexRequestWindowMap) {
+            if (requestWindow.inFlight.count()) {
+                requestWindow.slowStartThreshold    = qMax(requestWindow.window / 2.0, 2.0);
+                requestWindow.window                = 1;
+                requestWindow.inFlight.clear();
+            }
+        }
     } else {
-        qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to received parameter";
+        qCDebug(ParameterManagerVerbose1Log) << "Refilling index based request windows";
     }
 
+    bool paramsInFlight = false;
+    qint64 nowMSecs = _indexRequestClock.elapsed();
+
     for(int componentId: _waitingReadParamIndexMap.keys()) {
-        if (_waitingReadParamIndexMap[componentId].count()) {
-            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap count" << _waitingReadParamIndexMap[componentId].count();
-            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap" << _waitingReadParamIndexMap[componentId];
+        QMap<int, int>& waitingIndices = _waitingReadParamIndexMap[componentId];
+        RequestWindow_t& requestWindow = _indexRequestWindowMap[componentId];
+
+        if (waitingIndices.count()) {
+            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap count" << waitingIndices.count() << "window" << requestWindow.window << "rto" << requestWindow.rtoMSecs;
+            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap" << waitingIndices;
         }
 
-        for(int paramIndex: _waitingReadParamIndexMap[componentId].keys()) {
-            if (_indexBatchQueue.contains(paramIndex)) {
+        for(int paramIndex: waitingIndices.keys()) {
+            if (requestWindow.inFlight.count() >= static_cast<int>(requestWindow.window)) {
+                break;
+            }
+            if (requestWindow.inFlight.contains(paramIndex)) {
                 // Don't add more than once
                 continue;
             }
 
-            if (_indexBatchQueue.count() > maxBatchSize) {
-                break;
-            }
-
-            _waitingReadParamIndexMap[componentId][paramIndex]++;   // Bump retry count
-            if (_disableAllRetries || _waitingReadParamIndexMap[componentId][paramIndex] > _maxInitialLoadRetrySingleParam) {
+            waitingIndices[paramIndex]++;   // Bump retry count
+            if (_disableAllRetries || waitingIndices[paramIndex] > _maxInitialLoadRetrySingleParam) {
                 // Give up on this index
                 _failedReadParamIndexMap[componentId] << paramIndex;
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
-                _waitingReadParamIndexMap[componentId].remove(paramIndex);
+                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << waitingIndices[paramIndex] << ")";
+                waitingIndices.remove(paramIndex);
             } else {
                 // Retry again
-                _indexBatchQueue.append(paramIndex);
+                requestWindow.inFlight[paramIndex] = nowMSecs;
                 _readParameterRaw(componentId, "", paramIndex);
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
+                qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << waitingIndices[paramIndex] << ")";
+            }
+        }
+
+        if (requestWindow.inFlight.count()) {
+            paramsInFlight = true;
+        }
+    }
+
+    if (paramsInFlight) {
+        if (!_indexRequestTimer.isActive()) {
+            _indexRequestTimer.start();
+        }
+    } else {
+        _indexRequestTimer.stop();
+    }
+
+    return paramsInFlight;
+}
+
+/// Called when an index based parameter arrives while the request windows are active
+void ParameterManager::_indexRequestReceived(int componentId, int paramIndex)
+{
+    if (!_indexRequestWindowMap.contains(componentId)) {
+        return;
+    }
+    RequestWindow_t& requestWindow = _indexRequestWindowMap[componentId];
+    if (!requestWindow.inFlight.contains(paramIndex)) {
+        return;
+    }
+
+    // Only first requests give a usable round trip time, a retry can't be matched to the request it answers
+    if (_waitingReadParamIndexMap[componentId].value(paramIndex) == 1) {
+        double rttMSecs = _indexRequestClock.elapsed() - requestWindow.inFlight[paramIndex];
+        if (requestWindow.srttMSecs == 0) {
+            requestWindow.srttMSecs     = rttMSecs;
+            requestWindow.rttVarMSecs   = rttMSecs / 2.0;
+        } else {
+            // Smoothed the same way as RFC 6298
+            requestWindow.rttVarMSecs   += (qAbs(requestWindow.srttMSecs - rttMSecs) - requestWindow.rttVarMSecs) / 4.0;
+            requestWindow.srttMSecs     += (rttMSecs - requestWindow.srttMSecs) / 8.0;
+        }
+        requestWindow.rtoMSecs = qBound(static_cast<double>(_minRequestRtoMSecs),
+                                        requestWindow.srttMSecs + (4.0 * requestWindow.rttVarMSecs),
+                                        static_cast<double>(_maxRequestRtoMSecs));
+    }
+    requestWindow.inFlight.remove(paramIndex);
+
+    if (requestWindow.window < requestWindow.slowStartThreshold) {
+        requestWindow.window += 1.0;
+    } else {
+        requestWindow.window += 1.0 / requestWindow.window;
+    }
+    requestWindow.window = qMin(requestWindow.window, static_cast<double>(_maxRequestWindow));
+}
+
+/// Re-requests index based parameters whose request timed out. Each timeout counts as one loss event per component.
+void ParameterManager::_indexRequestTimeout(void)
+{
+    QMutexLocker lock(&_dataMutex);
+
+    qint64 nowMSecs = _indexRequestClock.elapsed();
+    bool lost = false;
+
+    for (int componentId: _indexRequestWindowMap.keys()) {
+        RequestWindow_t& requestWindow = _indexRequestWindowMap[componentId];
+        int lostCount = 0;
+
+        for (int paramIndex: requestWindow.inFlight.keys()) {
+            if (nowMSecs - requestWindow.inFlight[paramIndex] >= requestWindow.rtoMSecs) {
+                // Leave it in the waiting list so it's requested again
+                requestWindow.inFlight.remove(paramIndex);
+                lostCount++;
             }
         }
+        if (lostCount) {
+            requestWindow.slowStartThreshold    = qMax(requestWindow.window / 2.0, 2.0);
+            requestWindow.window                = qMax(requestWindow.window / 2.0, 1.0);
+            requestWindow.rtoMSecs              = qMin(requestWindow.rtoMSecs * 2.0, static_cast<double>(_maxRequestRtoMSecs));
+            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Index re-requests timed out" << lostCount << "window" << requestWindow.window << "rto" << requestWindow.rtoMSecs;
+            lost = true;
+        }
     }
 
-    return _indexBatchQueue.count() != 0;
+    if (lost) {
+        _fillIndexBatchQueue(false /* waitingParamTimeout */);
+        lock.unlock();
+        _checkInitialLoadComplete();
+        _updateProgressBar();
+    }
 }
 
 void ParameterManager::_waitingParamTimeout(void)
@@ -884,18 +981,28 @@ void ParameterManager::_writeParameterRaw(int componentId, const QString& paramN
 
 void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
-    CacheMapName2ParamTypeVal cacheMap;
-
-    for(const QString& paramName: _mapParameterName2Variant[componentId].keys()) {
-        const Fact *fact = _mapParameterName2Variant[componentId][paramName].value<Fact*>();
-        cacheMap[paramName] = ParamTypeVal(fact->type(), fact->rawValue());
+    QList<ParameterCacheFile::Param_t>  params;
+    quint32                             hash = 0;
+    CompInfoParam*                      compInfoParam = _vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1);
+
+    // Map keys are sorted, which is the order the cache needs. The hash is calculated once here instead of on every load.
+    const QVariantMap& factMap = _mapParameterName2Variant[componentId];
+    params.reserve(factMap.count());
+    for (auto iter = factMap.constBegin(); iter != factMap.constEnd(); iter++) {
+        const Fact* fact = iter.value().value<Fact*>();
+        params.append({ iter.key(), fact->type(), fact->rawValue() });
+        if (compInfoParam->_isParameterVolatile(iter.key())) {
+            // Does not take part in CRC
+            qCDebug(ParameterManagerLog) << "Volatile parameter" << iter.key();
+        } else {
+            hash = ParameterCacheFile::addToHash(hash, iter.key(), fact->type(), fact->rawValue());
+        }
     }
 
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
-
-    QDataStream ds(&cacheFile);
-    ds << cacheMap;
+    QString errorString;
+    if (!ParameterCacheFile::write(parameterCacheFile(vehicleId, componentId), params, hash, errorString)) {
+        qCWarning(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Parameter cache write failed" << errorString;
+    }
 }
 
 QDir ParameterManager::parameterCacheDir()
@@ -906,61 +1013,41 @@ QDir ParameterManager::parameterCacheDir()
 
 QString ParameterManager::parameterCacheFile(int vehicleId, int componentId)
 {
-    return parameterCacheDir().filePath(QString("%1_%2.v2").arg(vehicleId).arg(componentId));
+    return parameterCacheDir().filePath(QString("%1_%2.v3").arg(vehicleId).arg(componentId));
 }
 
 void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value)
 {
     qCInfo(ParameterManagerLog) << "Attemping load from cache";
 
-    uint32_t crc32_value = 0;
-    /* The datastructure of the cache table */
-    CacheMapName2ParamTypeVal cacheMap;
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    if (!cacheFile.exists()) {
+    QString             errorString;
+    ParameterCacheFile  cache;
+    QString             cacheFileName(parameterCacheFile(vehicleId, componentId));
+    if (!QFile::exists(cacheFileName)) {
         /* no local cache, just wait for them to come in*/
         return;
     }
-    cacheFile.open(QIODevice::ReadOnly);
-
-    /* Deserialize the parameter cache table */
-    QDataStream ds(&cacheFile);
-    ds >> cacheMap;
+    if (!cache.open(cacheFileName, errorString)) {
+        qCInfo(ParameterManagerLog) << "Parameter cache unusable" << errorString << qPrintable(cacheFileName);
+        return;
+    }
 
     // Load parameter meta data for the version number stored in cache.
     // We need meta data so we have access to the volatile bit
-    if (cacheMap.contains(_versionParam)) {
-        _parameterSetMajorVersion = cacheMap[_versionParam].second.toInt();
+    int versionIndex = cache.indexOf(_versionParam);
+    if (versionIndex != -1) {
+        _parameterSetMajorVersion = cache.rawValue(versionIndex).toInt();
     }
     _vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->_parameterMajorVersionKnown(_parameterSetMajorVersion);
 
-    /* compute the crc of the local cache to check against the remote */
-
-    for (const QString& name: cacheMap.keys()) {
-        if (_vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->_isParameterVolatile(name)) {
-            // Does not take part in CRC
-            qCDebug(ParameterManagerLog) << "Volatile parameter" << name;
-        } else {
-            const ParamTypeVal& paramTypeVal = cacheMap[name];
-            const void *vdat = paramTypeVal.second.constData();
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            crc32_value = QGC::crc32((const uint8_t *)qPrintable(name), name.length(),  crc32_value);
-            crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(fact_type), crc32_value);
-        }
-    }
+    /* the hash of the local cache was calculated when it was written */
+    uint32_t crc32_value = cache.hash();
 
     /* if the two param set hashes match, just load from the disk */
     if (crc32_value == hash_value.toUInt()) {
-        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
-
-        int count = cacheMap.count();
-        int index = 0;
-        for (const QString& name: cacheMap.keys()) {
-            const ParamTypeVal& paramTypeVal = cacheMap[name];
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            const int mavType = _factTypeToMavType(fact_type);
-            _parameterUpdate(vehicleId, componentId, name, count, index++, mavType, paramTypeVal.second);
-        }
+        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(cacheFileName);
+
+        _loadFromCache(componentId, cache);
 
         // Return the hash value to notify we don't want any more updates
         mavlink_param_set_t     p;
@@ -1002,11 +1089,12 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
     } else {
         // Cache parameter version may differ from vehicle parameter version so we can't trust information loaded from cache parameter version number
         _parameterSetMajorVersion = -1;
-        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
+        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(cacheFileName);
         if (ParameterManagerDebugCacheFailureLog().isDebugEnabled()) {
             _debugCacheCRC[componentId] = true;
-            _debugCacheMap[componentId] = cacheMap;
-            for (const QString& name: cacheMap.keys()) {
+            for (int i = 0; i < cache.count(); i++) {
+                QString name = cache.name(i);
+                _debugCacheMap[componentId][name] = ParamTypeVal(cache.type(i), cache.rawValue(i));
                 _debugCacheParamSeen[componentId][name] = false;
             }
             qgcApp()->showAppMessage(tr("Parameter cache CRC match failed"));
@@ -1015,6 +1103,74 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
     }
 }
 
+/// Creates all the Facts for a component straight from a validated cache, instead of feeding each cached parameter
+/// through _parameterUpdate.
+void ParameterManager::_loadFromCache(int componentId, const ParameterCacheFile& cache)
+{
+    int count = cache.count();
+
+    _initialRequestTimeoutTimer.stop();
+    _waitingParamTimeoutTimer.stop();
+
+    _dataMutex.lock();
+
+    if (!_paramCountMap.contains(componentId)) {
+        _paramCountMap[componentId] = count;
+        _totalParamCount += count;
+    }
+
+    // Nothing left to wait for from this component
+    _waitingReadParamIndexMap[componentId]  = QMap<int, int>();
+    _waitingReadParamNameMap[componentId]   = QMap<QString, int>();
+    _waitingWriteParamNameMap[componentId]  = QMap<QString, int>();
+
+    // Other components may still have requests outstanding
+    int totalWaitingParamCount = 0;
+    for (int waitingComponentId: _waitingReadParamIndexMap.keys()) {
+        totalWaitingParamCount += _waitingReadParamIndexMap[waitingComponentId].count();
+    }
+    for (int waitingComponentId: _waitingReadParamNameMap.keys()) {
+        totalWaitingParamCount += _waitingReadParamNameMap[waitingComponentId].count();
+    }
+    for (int waitingComponentId: _waitingWriteParamNameMap.keys()) {
+        totalWaitingParamCount += _waitingWriteParamNameMap[waitingComponentId].count();
+    }
+
+    QVector<Fact*>  facts(count);
+    QVariantMap&    factMap = _mapParameterName2Variant[componentId];
+    for (int i = 0; i < count; i++) {
+        QString name = cache.name(i);
+        auto iter = factMap.constFind(name);
+        if (iter != factMap.constEnd()) {
+            facts[i] = iter.value().value<Fact*>();
+        } else {
+            facts[i] = new Fact(componentId, name, cache.type(i), this);
+            factMap[name] = QVariant::fromValue(facts[i]);
+
+            // We need to know when the fact changes from QML so that we can send the new value to the parameter manager
+            connect(facts[i], &Fact::_containerRawValueChanged, this, &ParameterManager::_valueUpdated);
+        }
+    }
+
+    _dataMutex.unlock();
+
+    for (int i = 0; i < count; i++) {
+        facts[i]->_containerSetRawValue(cache.rawValue(i));
+    }
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Created" << count << "facts from cache";
+
+    if (totalWaitingParamCount || !_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
+        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer after cache load: totalWaitingParamCount:" << totalWaitingParamCount;
+        _waitingParamTimeoutTimer.start();
+    }
+
+    if (componentId == _vehicle->defaultComponentId()) {
+        _addMetaDataToDefaultComponent();
+    }
+    _setupComponentCategoryMap(componentId);
+    _checkInitialLoadComplete();
+}
+
 QString ParameterManager::readParametersFromStream(QTextStream& stream)
 {
     QString missingErrors;
@@ -16,8 +16,10 @@
 #include <QMutex>
 #include <QDir>
 #include <QJsonObject>
+#include <QElapsedTimer>
 
 #include "FactSystem.h"
+#include "ParameterCacheFile.h"
 #include "MAVLinkProtocol.h"
 #include "AutoPilotPlugin.h"
 #include "QGCMAVLink.h"
@@ -109,6 +111,7 @@ protected:
     void _waitingParamTimeout   (void);
     void _tryCacheLookup        (void);
     void _initialRequestTimeout (void);
+    void _indexRequestTimeout   (void);
 
 private:
     static QVariant         _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool failOk = false);
@@ -120,6 +123,7 @@ private:
     void    _writeParameterRaw                  (int componentId, const QString& paramName, const QVariant& value);
     void    _writeLocalParamCache               (int vehicleId, int componentId);
     void    _tryCacheHashLoad                   (int vehicleId, int componentId, QVariant hash_value);
+    void    _loadFromCache                      (int componentId, const ParameterCacheFile& cache);
     void    _loadMetaData                       (void);
     void    _clearMetaData                      (void);
     void    _addMetaDataToDefaultComponent      (void);
@@ -128,6 +132,7 @@ private:
     QString _logVehiclePrefix                   (int componentId);
     void    _setLoadProgress                    (double loadProgress);
     bool    _fillIndexBatchQueue                (bool waitingParamTimeout);
+    void    _indexRequestReceived               (int componentId, int paramIndex);
     void    _updateProgressBar                  (void);
 
     MAV_PARAM_TYPE _factTypeToMavType(FactMetaData::ValueType_t factType);
@@ -177,7 +182,27 @@ private:
     bool                _disableAllRetries;                     ///< true: Don't retry any requests (used for testing)
 
     bool        _indexBatchQueueActive; ///< true: we are actively batching re-requests for missing index base params, false: index based re-request has not yet started
-    QList<int>  _indexBatchQueue;       ///< The current queue of index re-requests
+
+    static const int _initialRequestWindow      = 4;        ///< Index re-requests allowed in flight per component to start with
+    static const int _maxRequestWindow          = 64;
+    static const int _initialRequestRtoMSecs    = 1000;     ///< Re-request timeout until the round trip time is known
+    static const int _minRequestRtoMSecs        = 200;
+    static const int _maxRequestRtoMSecs        = 3000;
+
+    /// Congestion window for index based re-requests to a single component. Components are re-requested in parallel,
+    /// each with its own window. The window grows for each re-request answered (doubling per round trip until the slow
+    /// start threshold, then by one per round trip) and halves when re-requests time out.
+    typedef struct {
+        QMap<int, qint64>   inFlight;                               ///< Key: parameter index, Value: time requested (msecs)
+        double              window              = _initialRequestWindow;
+        double              slowStartThreshold  = _maxRequestWindow;
+        double              srttMSecs           = 0;                ///< Smoothed round trip time, 0: no sample yet
+        double              rttVarMSecs         = 0;
+        double              rtoMSecs            = _initialRequestRtoMSecs;
+    } RequestWindow_t;
+
+    QMap<int, RequestWindow_t>  _indexRequestWindowMap; ///< Key: Component id
+    QElapsedTimer               _indexRequestClock;
 
     QMap<int, int>                  _paramCountMap;             ///< Key: Component id, Value: count of parameters in this component
     QMap<int, QMap<int, int> >      _waitingReadParamIndexMap;  ///< Key: Component id, Value: Map { Key: parameter index still waiting for, Value: retry count }
@@ -191,6 +216,7 @@ private:
 
     QTimer _initialRequestTimeoutTimer;
     QTimer _waitingParamTimeoutTimer;
+    QTimer _indexRequestTimer;              ///< Checks in flight index re-requests for timeouts
 
     QMutex _dataMutex;
 
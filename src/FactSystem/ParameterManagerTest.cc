@@ -12,6 +12,11 @@
 #include "MultiVehicleManager.h"
 #include "QGCApplication.h"
 #include "ParameterManager.h"
+#include "MAVLinkProtocol.h"
+#include "QGC.h"
+
+#include <QElapsedTimer>
+#include <QTemporaryDir>
 
 /// Test failure modes which should still lead to param load success
 void ParameterManagerTest::_noFailureWorker(MockConfiguration::FailureMode_t failureMode)
@@ -138,3 +143,178 @@ void ParameterManagerTest::_requestListMissingParamFail(void)
     // User should have been notified
     checkExpectedMessageBox();
 }
+
+/// Loads the ArduCopter parameter set over a simulated poor link and checks that it completes within maxLoadMSecs
+void ParameterManagerTest::_lossyLinkLoadWorker(int lossPercent, int latencyMSecs, int maxLoadMSecs)
+{
+    Q_ASSERT(!_mockLink);
+    _mockLink = MockLink::startAPMArduCopterMockLink(false);
+    _mockLink->setParamLinkSimulation(lossPercent, latencyMSecs);
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QVERIFY(vehicleMgr);
+
+    QElapsedTimer loadTime;
+    loadTime.start();
+
+    QSignalSpy spyVehicle(vehicleMgr, SIGNAL(activeVehicleAvailableChanged(bool)));
+    QCOMPARE(spyVehicle.wait(5000), true);
+    Vehicle* vehicle = vehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+    QCOMPARE(spyParamsReady.wait(qMax(maxLoadMSecs - static_cast<int>(loadTime.elapsed()), 1)), true);
+    qint64 loadMSecs = loadTime.elapsed();
+
+    ParameterManager* parameterManager = vehicle->parameterManager();
+    int paramCount = 0;
+    for (int componentId: parameterManager->componentIds()) {
+        paramCount += parameterManager->parameterNames(componentId).count();
+    }
+    qCDebug(ParameterManagerVerbose1Log) << "Parameter load loss" << lossPercent << "% latency" << latencyMSecs << "ms:" << paramCount << "params in" << loadMSecs << "ms";
+    QCOMPARE(parameterManager->missingParameters(), false);
+    QVERIFY(paramCount > 0);
+    QVERIFY2(loadMSecs <= maxLoadMSecs, qPrintable(QStringLiteral("Parameter load took %1 ms").arg(loadMSecs)));
+
+    _disconnectMockLink();
+}
+
+void ParameterManagerTest::_lossyLinkLoad(void)
+{
+    _lossyLinkLoadWorker(5, 50, _maxLossyLoadMSecs);
+}
+
+/// Load times across a range of link conditions. Too slow for the default run, set QGC_PARAM_LOAD_SWEEP to run it
+/// and turn on ParameterManagerVerbose1Log to see the timings.
+void ParameterManagerTest::_lossyLinkLoadSweep(void)
+{
+    if (qEnvironmentVariableIsEmpty("QGC_PARAM_LOAD_SWEEP")) {
+        QSKIP("Set QGC_PARAM_LOAD_SWEEP to run the parameter load timing sweep");
+    }
+
+    static const struct {
+        int lossPercent;
+        int latencyMSecs;
+    } rgCases[] = {
+        { 0,    0 },
+        { 5,    50 },
+        { 15,   200 },
+    };
+
+    for (const auto& testCase: rgCases) {
+        _lossyLinkLoadWorker(testCase.lossPercent, testCase.latencyMSecs, 120000);
+    }
+}
+
+void ParameterManagerTest::_cacheFileRoundTrip(void)
+{
+    // Must be sorted by name
+    QList<ParameterCacheFile::Param_t> params = {
+        { "BAT_N_CELLS",        FactMetaData::valueTypeUint8,   QVariant(4u) },
+        { "COM_RC_LOSS_T",      FactMetaData::valueTypeFloat,   QVariant(0.5f) },
+        { "MC_ROLL_P",          FactMetaData::valueTypeFloat,   QVariant(6.5f) },
+        { "MIS_TAKEOFF_ALT",    FactMetaData::valueTypeFloat,   QVariant(-2.5f) },
+        { "SYS_AUTOSTART",      FactMetaData::valueTypeInt32,   QVariant(-4001) },
+        { "SYS_PARAM_VER_1234", FactMetaData::valueTypeUint32,  QVariant(4000000000u) },
+        { "TRIM_PITCH",         FactMetaData::valueTypeInt16,   QVariant(-300) },
+    };
+
+    quint32 hash = 0;
+    for (const ParameterCacheFile::Param_t& param: params) {
+        hash = ParameterCacheFile::addToHash(hash, param.name, param.type, param.rawValue);
+    }
+
+    // Must stay the same as the hash the text cache calculated straight from the QVariant storage, which is what the
+    // vehicle sends as _HASH_CHECK
+    quint32 legacyHash = 0;
+    for (const ParameterCacheFile::Param_t& param: params) {
+        legacyHash = QGC::crc32((const uint8_t *)qPrintable(param.name), param.name.length(), legacyHash);
+        legacyHash = QGC::crc32((const uint8_t *)param.rawValue.constData(), FactMetaData::typeToSize(param.type), legacyHash);
+    }
+    QCOMPARE(hash, legacyHash);
+    QCOMPARE(hash, 0x40173a0au);
+
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath("cache.v3");
+    QString         errorString;
+    QVERIFY(tempDir.isValid());
+    QVERIFY2(ParameterCacheFile::write(fileName, params, hash, errorString), qPrintable(errorString));
+
+    {
+        ParameterCacheFile cache;
+        QVERIFY2(cache.open(fileName, errorString), qPrintable(errorString));
+        QCOMPARE(cache.hash(), hash);
+        QCOMPARE(cache.count(), params.count());
+        for (int i = 0; i < params.count(); i++) {
+            QCOMPARE(cache.name(i), params[i].name);
+            QCOMPARE(cache.type(i), params[i].type);
+            QCOMPARE(cache.rawValue(i).toDouble(), params[i].rawValue.toDouble());
+            QCOMPARE(cache.indexOf(params[i].name), i);
+        }
+        QCOMPARE(cache.indexOf("NOT_A_PARAM"), -1);
+        QCOMPARE(cache.indexOf("MC_ROLL"), -1);
+    }
+
+    // A corrupted cache must be rejected
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    file.seek(file.size() - 20);
+    file.write("X");
+    file.close();
+
+    ParameterCacheFile cache;
+    QCOMPARE(cache.open(fileName, errorString), false);
+}
+
+/// Second connect to the same vehicle must come up from the parameter cache without any parameters being sent
+void ParameterManagerTest::_cacheLoad(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    ParameterManager*   paramManager    = _vehicle->parameterManager();
+    int                 componentId     = _vehicle->defaultComponentId();
+    QStringList         paramNames      = paramManager->parameterNames(componentId);
+    QString             cacheFileName   = ParameterManager::parameterCacheFile(_vehicle->id(), componentId);
+    QVERIFY(paramManager->parametersReady());
+    QVERIFY(QFile::exists(cacheFileName));
+
+    // The vehicle's hash must match the cache written from the parameters it sent
+    ParameterCacheFile  cache;
+    QString             errorString;
+    QVERIFY2(cache.open(cacheFileName, errorString), qPrintable(errorString));
+    QCOMPARE(cache.count(), paramNames.count());
+    QCOMPARE(cache.hash(), _mockLink->_paramHash(componentId));
+    cache.close();
+
+    // Every MockLink gets a new system id, move the cache over to the id of the next one so it looks like the same vehicle
+    int vehicleId = _vehicle->id();
+    _disconnectMockLink();
+    QStringList cacheFiles = ParameterManager::parameterCacheDir().entryList({ QStringLiteral("%1_*").arg(vehicleId) }, QDir::Files);
+    QVERIFY(!cacheFiles.isEmpty());
+    for (const QString& fileName: cacheFiles) {
+        QString newFileName = QString(fileName).replace(QStringLiteral("%1_").arg(vehicleId), QStringLiteral("%1_").arg(MockLink::_nextVehicleSystemId));
+        QVERIFY(ParameterManager::parameterCacheDir().rename(fileName, newFileName));
+    }
+
+    QObject paramValueCounter;
+    int     paramValueCount = 0;
+    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, &paramValueCounter, [&paramValueCount](LinkInterface*, mavlink_message_t message) {
+        if (message.msgid == MAVLINK_MSG_ID_PARAM_VALUE) {
+            mavlink_param_value_t paramValue;
+            mavlink_msg_param_value_decode(&message, &paramValue);
+            if (strncmp(paramValue.param_id, "_HASH_CHECK", sizeof(paramValue.param_id)) != 0) {
+                paramValueCount++;
+            }
+        }
+    });
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    paramManager = _vehicle->parameterManager();
+    QVERIFY(paramManager->parametersReady());
+    QCOMPARE(paramManager->missingParameters(), false);
+    QCOMPARE(paramManager->parameterNames(componentId), paramNames);
+    for (const QString& paramName: paramNames) {
+        QVERIFY(paramManager->parameterExists(componentId, paramName));
+    }
+    QCOMPARE(paramValueCount, 0);
+}
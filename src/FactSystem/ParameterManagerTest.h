@@ -25,9 +25,16 @@ private slots:
     void _requestListNoResponse(void);
     void _requestListMissingParamSuccess(void);
     void _requestListMissingParamFail(void);
+    void _lossyLinkLoad(void);
+    void _lossyLinkLoadSweep(void);
+    void _cacheFileRoundTrip(void);
+    void _cacheLoad(void);
 
 private:
     void _noFailureWorker(MockConfiguration::FailureMode_t failureMode);
+    void _lossyLinkLoadWorker(int lossPercent, int latencyMSecs, int maxLoadMSecs);
+
+    static const int _maxLossyLoadMSecs = 15000;    ///< Full ArduCopter load at 5% loss and 50ms latency
 };
 
 #endif
@@ -0,0 +1,295 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterMetaDataTest.h"
+#include "PX4ParameterMetaData.h"
+#include "APMParameterMetaData.h"
+#include "ParameterManager.h"
+#include "ParameterCacheFile.h"
+#include "FirmwarePlugin.h"
+#include "Vehicle.h"
+
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+
+const char* ParameterMetaDataTest::_px4MetaDataFile = ":/FirmwarePlugin/PX4/PX4ParameterFactMetaData.xml";
+const char* ParameterMetaDataTest::_apmMetaDataFile = ":/FirmwarePlugin/APM/APMParameterFactMetaData.Copter.4.0.xml";
+
+/// Reads the parameters from a PX4 meta data file without going through PX4ParameterMetaData
+///     @param skippedNames Returned: Parameters the PX4 parser does not fully read, the first one in the file and duplicates
+QMap<QString, ParameterMetaDataTest::XmlParameter_t> ParameterMetaDataTest::_readPX4MetaDataFile(const QString& metaDataFile, QStringList& skippedNames)
+{
+    QMap<QString, XmlParameter_t> parameters;
+
+    QFile file(metaDataFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return parameters;
+    }
+
+    QXmlStreamReader    xml(&file);
+    QString             group;
+    XmlParameter_t*     parameter = nullptr;
+
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (!xml.isStartElement()) {
+            continue;
+        }
+
+        QString elementName = xml.name().toString();
+        if (elementName == "group") {
+            group = xml.attributes().value("name").toString();
+        } else if (elementName == "parameter") {
+            QString name = xml.attributes().value("name").toString();
+            if (skippedNames.isEmpty() || parameters.contains(name) || skippedNames.contains(name)) {
+                // The parser has always ignored the elements of the first parameter in a file, and falls back to default
+                // meta data for duplicates
+                parameters.remove(name);
+                skippedNames.append(name);
+                parameter = nullptr;
+                continue;
+            }
+
+            bool unknownType;
+            parameter = &parameters[name];
+            parameter->type         = FactMetaData::stringToType(xml.attributes().value("type").toString(), unknownType);
+            parameter->group        = group;
+            parameter->category     = xml.attributes().value("category").toString();
+            parameter->hasDefault   = xml.attributes().hasAttribute("default");
+            parameter->defaultValue = xml.attributes().value("default").toString();
+            parameter->volatileValue = xml.attributes().value("volatile") == QStringLiteral("true");
+            parameter->readOnly     = parameter->volatileValue || xml.attributes().value("readonly") == QStringLiteral("true");
+            if (parameter->category.isEmpty()) {
+                parameter->category = QStringLiteral("Standard");
+            }
+        } else if (parameter) {
+            if (elementName == "short_desc") {
+                parameter->shortDescription = xml.readElementText().replace("\n", " ");
+            } else if (elementName == "long_desc") {
+                parameter->longDescription = xml.readElementText().replace("\n", " ");
+            } else if (elementName == "min") {
+                parameter->min = xml.readElementText();
+            } else if (elementName == "max") {
+                parameter->max = xml.readElementText();
+            } else if (elementName == "unit") {
+                parameter->units = xml.readElementText();
+            } else if (elementName == "reboot_required") {
+                parameter->rebootRequired = xml.readElementText().compare("true", Qt::CaseInsensitive) == 0;
+            } else if (elementName == "value") {
+                QString code = xml.attributes().value("code").toString();
+                parameter->values.append(qMakePair(code, xml.readElementText()));
+            } else if (elementName == "boolean") {
+                parameter->values.append(qMakePair(QStringLiteral("1"), QStringLiteral("Enabled")));
+                parameter->values.append(qMakePair(QStringLiteral("0"), QStringLiteral("Disabled")));
+            } else if (elementName == "bit") {
+                int index = xml.attributes().value("index").toInt();
+                QString description = xml.readElementText();
+                if (index < 31) {
+                    parameter->bitmask.append(qMakePair(index, description));
+                }
+            }
+        }
+    }
+
+    return parameters;
+}
+
+/// Vehicles loading the same PX4 file share one parsed table, FactMetaData stays per vehicle
+void ParameterMetaDataTest::_px4SharedParse_test(void)
+{
+    PX4ParameterMetaData metaData1;
+    PX4ParameterMetaData metaData2;
+    metaData1.loadParameterFactMetaDataFile(_px4MetaDataFile);
+    metaData2.loadParameterFactMetaDataFile(_px4MetaDataFile);
+
+    QVERIFY(metaData1._rawMetaData);
+    QVERIFY(metaData1._rawMetaData->count() > 1000);
+    QCOMPARE(metaData1._rawMetaData.data(), metaData2._rawMetaData.data());
+
+    FactMetaData* factMetaData1 = metaData1.getMetaDataForFact("MC_ROLL_P", MAV_TYPE_QUADROTOR, FactMetaData::valueTypeFloat);
+    FactMetaData* factMetaData2 = metaData2.getMetaDataForFact("MC_ROLL_P", MAV_TYPE_QUADROTOR, FactMetaData::valueTypeFloat);
+    QVERIFY(factMetaData1 != factMetaData2);
+    QCOMPARE(factMetaData1->parent(), &metaData1);
+    QCOMPARE(factMetaData2->parent(), &metaData2);
+}
+
+/// Vehicles loading the same ArduPilot file share one parsed table, FactMetaData stays per vehicle
+void ParameterMetaDataTest::_apmSharedParse_test(void)
+{
+    APMParameterMetaData metaData1;
+    APMParameterMetaData metaData2;
+    metaData1.loadParameterFactMetaDataFile(_apmMetaDataFile);
+    metaData2.loadParameterFactMetaDataFile(_apmMetaDataFile);
+
+    QVERIFY(metaData1._vehicleTypeToParametersMap);
+    QVERIFY(!metaData1._vehicleTypeToParametersMap->isEmpty());
+    QCOMPARE(metaData1._vehicleTypeToParametersMap.data(), metaData2._vehicleTypeToParametersMap.data());
+
+    FactMetaData* factMetaData1 = metaData1.getMetaDataForFact("ATC_RAT_RLL_P", MAV_TYPE_QUADROTOR, FactMetaData::valueTypeFloat);
+    FactMetaData* factMetaData2 = metaData2.getMetaDataForFact("ATC_RAT_RLL_P", MAV_TYPE_QUADROTOR, FactMetaData::valueTypeFloat);
+    QVERIFY(factMetaData1 != factMetaData2);
+    QCOMPARE(factMetaData1->shortDescription(), factMetaData2->shortDescription());
+    QVERIFY(!factMetaData1->shortDescription().isEmpty());
+}
+
+/// A meta data file which changed on disk is parsed again, vehicles which loaded the old contents keep them
+void ParameterMetaDataTest::_changedFileParsedAgain_test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath("PX4ParameterFactMetaData.xml");
+    QVERIFY(tempDir.isValid());
+    QVERIFY(QFile::copy(_px4MetaDataFile, fileName));
+    QVERIFY(QFile::setPermissions(fileName, QFile::ReadOwner | QFile::WriteOwner));
+
+    PX4ParameterMetaData oldMetaData;
+    oldMetaData.loadParameterFactMetaDataFile(fileName);
+    PX4ParameterMetaData sameMetaData;
+    sameMetaData.loadParameterFactMetaDataFile(fileName);
+    QCOMPARE(oldMetaData._rawMetaData.data(), sameMetaData._rawMetaData.data());
+
+    // Change the default of MC_ROLL_P, which also changes the file size
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray contents = file.readAll();
+    file.close();
+    const QByteArray oldDefault("default=\"6.5\" name=\"MC_ROLL_P\"");
+    QVERIFY(contents.contains(oldDefault));
+    contents.replace(oldDefault, QByteArray("default=\"7.25\" name=\"MC_ROLL_P\""));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write(contents), static_cast<qint64>(contents.size()));
+    file.close();
+
+    PX4ParameterMetaData newMetaData;
+    newMetaData.loadParameterFactMetaDataFile(fileName);
+    QVERIFY(newMetaData._rawMetaData.data() != oldMetaData._rawMetaData.data());
+
+    FactMetaData* oldFactMetaData = oldMetaData.getMetaDataForFact("MC_ROLL_P", MAV_TYPE_QUADROTOR, FactMetaData::valueTypeFloat);
+    FactMetaData* newFactMetaData = newMetaData.getMetaDataForFact("MC_ROLL_P", MAV_TYPE_QUADROTOR, FactMetaData::valueTypeFloat);
+    QCOMPARE(oldFactMetaData->rawDefaultValue().toFloat(), 6.5f);
+    QCOMPARE(newFactMetaData->rawDefaultValue().toFloat(), 7.25f);
+
+    // Unchanged from here on, so shared again
+    PX4ParameterMetaData nextMetaData;
+    nextMetaData.loadParameterFactMetaDataFile(fileName);
+    QCOMPARE(nextMetaData._rawMetaData.data(), newMetaData._rawMetaData.data());
+}
+
+/// FactMetaData is only created when asked for, and must come out the same as when the whole file was converted while
+/// parsing
+void ParameterMetaDataTest::_px4OnDemandMetaData_test(void)
+{
+    QStringList                     skippedNames;
+    QMap<QString, XmlParameter_t>   xmlParameters = _readPX4MetaDataFile(_px4MetaDataFile, skippedNames);
+    QVERIFY(xmlParameters.count() > 1000);
+
+    PX4ParameterMetaData metaData;
+    metaData.loadParameterFactMetaDataFile(_px4MetaDataFile);
+    QVERIFY(metaData._mapParameterName2FactMetaData.isEmpty());
+
+    int cChecked = 0;
+    for (auto iter = xmlParameters.constBegin(); iter != xmlParameters.constEnd(); iter++) {
+        const QString&          name            = iter.key();
+        const XmlParameter_t&   xmlParameter    = iter.value();
+        QString                 errorString;
+        QVariant                value;
+
+        FactMetaData* factMetaData = metaData.getMetaDataForFact(name, MAV_TYPE_QUADROTOR, xmlParameter.type);
+        QVERIFY2(factMetaData, qPrintable(name));
+        QCOMPARE(factMetaData->name(),                  name);
+        QCOMPARE(factMetaData->type(),                  xmlParameter.type);
+        QCOMPARE(factMetaData->category(),              xmlParameter.category);
+        QCOMPARE(factMetaData->group(),                 xmlParameter.group);
+        QCOMPARE(factMetaData->readOnly(),              xmlParameter.readOnly);
+        QCOMPARE(factMetaData->volatileValue(),         xmlParameter.volatileValue);
+        QCOMPARE(factMetaData->vehicleRebootRequired(), xmlParameter.rebootRequired);
+        QCOMPARE(factMetaData->rawUnits(),              xmlParameter.units);
+        if (!xmlParameter.shortDescription.isEmpty()) {
+            QCOMPARE(factMetaData->shortDescription(),  xmlParameter.shortDescription);
+        }
+        if (!xmlParameter.longDescription.isEmpty()) {
+            QCOMPARE(factMetaData->longDescription(),   xmlParameter.longDescription);
+        }
+
+        // Min and max go through the same conversion and validation as when they were set while parsing
+        FactMetaData expected(xmlParameter.type);
+        if (!xmlParameter.min.isEmpty() && expected.convertAndValidateRaw(xmlParameter.min, false, value, errorString)) {
+            expected.setRawMin(value);
+        }
+        if (!xmlParameter.max.isEmpty() && expected.convertAndValidateRaw(xmlParameter.max, false, value, errorString)) {
+            expected.setRawMax(value);
+        }
+        QCOMPARE(factMetaData->rawMin(), expected.rawMin());
+        QCOMPARE(factMetaData->rawMax(), expected.rawMax());
+
+        FactMetaData defaultConversion(xmlParameter.type);
+        if (xmlParameter.hasDefault && defaultConversion.convertAndValidateRaw(xmlParameter.defaultValue, false, value, errorString)) {
+            QVERIFY2(factMetaData->defaultValueAvailable(), qPrintable(name));
+            QCOMPARE(factMetaData->rawDefaultValue(), value);
+        } else {
+            QVERIFY2(!factMetaData->defaultValueAvailable(), qPrintable(name));
+        }
+
+        // Enum values are validated against the final min/max
+        QStringList     enumStrings;
+        QVariantList    enumValues;
+        for (const auto& enumValue: xmlParameter.values) {
+            if (factMetaData->convertAndValidateRaw(enumValue.first, false, value, errorString)) {
+                enumStrings.append(enumValue.second);
+                enumValues.append(value);
+            }
+        }
+        QCOMPARE(factMetaData->enumStrings(), enumStrings);
+        QCOMPARE(factMetaData->enumValues(),  enumValues);
+
+        QCOMPARE(factMetaData->bitmaskStrings().count(), xmlParameter.bitmask.count());
+        for (int i = 0; i < xmlParameter.bitmask.count(); i++) {
+            QCOMPARE(factMetaData->bitmaskStrings()[i], xmlParameter.bitmask[i].second);
+            QCOMPARE(factMetaData->bitmaskValues()[i].toLongLong(), 1LL << xmlParameter.bitmask[i].first);
+        }
+
+        cChecked++;
+    }
+
+    // Only what was asked for was created
+    QCOMPARE(metaData._mapParameterName2FactMetaData.count(), cChecked);
+    qCDebug(PX4ParameterMetaDataLog) << "Checked" << cChecked << "parameters, skipped" << skippedNames;
+}
+
+/// Volatile PX4 parameters come from the parsed file and are left out of the parameter cache hash
+void ParameterMetaDataTest::_px4VolatileCacheHash_test(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    FirmwarePlugin* plugin          = _vehicle->firmwarePlugin();
+    QObject*        paramMetaData   = plugin->_loadParameterMetaData(_px4MetaDataFile);
+    QVERIFY(plugin->_isParameterVolatile(paramMetaData, "COM_FLIGHT_UUID", _vehicle->vehicleType()));
+    QVERIFY(!plugin->_isParameterVolatile(paramMetaData, "MC_ROLL_P", _vehicle->vehicleType()));
+    QVERIFY(!plugin->_isParameterVolatile(paramMetaData, "NOT_A_PARAM", _vehicle->vehicleType()));
+
+    ParameterCacheFile  cache;
+    QString             errorString;
+    QVERIFY2(cache.open(ParameterManager::parameterCacheFile(_vehicle->id(), _vehicle->defaultComponentId()), errorString), qPrintable(errorString));
+
+    quint32 allHash         = 0;
+    quint32 nonVolatileHash = 0;
+    int     cVolatile       = 0;
+    for (int i = 0; i < cache.count(); i++) {
+        allHash = ParameterCacheFile::addToHash(allHash, cache.name(i), cache.type(i), cache.rawValue(i));
+        if (plugin->_isParameterVolatile(paramMetaData, cache.name(i), _vehicle->vehicleType())) {
+            cVolatile++;
+        } else {
+            nonVolatileHash = ParameterCacheFile::addToHash(nonVolatileHash, cache.name(i), cache.type(i), cache.rawValue(i));
+        }
+    }
+    delete paramMetaData;
+
+    QVERIFY(cVolatile > 0);
+    QCOMPARE(cache.hash(), nonVolatileHash);
+    QVERIFY(cache.hash() != allHash);
+}
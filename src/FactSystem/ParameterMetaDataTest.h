@@ -0,0 +1,51 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "FactMetaData.h"
+
+/// Unit test for sharing parsed parameter meta data files and creating PX4 FactMetaData on demand
+class ParameterMetaDataTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _px4SharedParse_test(void);
+    void _apmSharedParse_test(void);
+    void _changedFileParsedAgain_test(void);
+    void _px4OnDemandMetaData_test(void);
+    void _px4VolatileCacheHash_test(void);
+
+private:
+    /// Parameter as written in a PX4 meta data file
+    typedef struct {
+        FactMetaData::ValueType_t       type            = FactMetaData::valueTypeInt32;
+        QString                         category;
+        QString                         group;
+        QString                         defaultValue;
+        QString                         shortDescription;
+        QString                         longDescription;
+        QString                         min;
+        QString                         max;
+        QString                         units;
+        bool                            hasDefault      = false;
+        bool                            readOnly        = false;
+        bool                            volatileValue   = false;
+        bool                            rebootRequired  = false;
+        QList<QPair<QString, QString>>  values;
+        QList<QPair<int, QString>>      bitmask;
+    } XmlParameter_t;
+
+    QMap<QString, XmlParameter_t> _readPX4MetaDataFile(const QString& metaDataFile, QStringList& skippedNames);
+
+    static const char* _px4MetaDataFile;
+    static const char* _apmMetaDataFile;
+};
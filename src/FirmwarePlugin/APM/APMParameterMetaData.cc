@@ -16,6 +16,7 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QDateTime>
 #include <QStack>
 
 static const char* kInvalidConverstion = "Internal Error: No support for string parameters";
@@ -143,6 +144,43 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
     _parameterMetaDataLoaded = true;
 
+    _vehicleTypeToParametersMap = _sharedVehicleTypeToParametersMap(metaDataFile);
+}
+
+/// The xml is parsed the first time a file is asked for. Every vehicle which asks for the same file after that gets the
+/// same read only maps, unless the file changed on disk in between.
+QSharedPointer<const APMParameterMetaData::VehicleTypeToParametersMap_t> APMParameterMetaData::_sharedVehicleTypeToParametersMap(const QString& metaDataFile)
+{
+    typedef struct {
+        qint64                                              size;
+        QDateTime                                           lastModified;
+        QSharedPointer<const VehicleTypeToParametersMap_t>  vehicleTypeToParametersMap;
+    } ParsedFile_t;
+
+    // Only used from the main thread
+    static QMap<QString, ParsedFile_t> parsedFiles;
+
+    QFileInfo fileInfo(metaDataFile);
+    auto iter = parsedFiles.constFind(metaDataFile);
+    if (iter != parsedFiles.constEnd() && iter->size == fileInfo.size() && iter->lastModified == fileInfo.lastModified()) {
+        qCDebug(APMParameterMetaDataLog) << "Using already parsed parameter meta data:" << metaDataFile;
+        return iter->vehicleTypeToParametersMap;
+    }
+
+    VehicleTypeToParametersMap_t* vehicleTypeToParametersMap = new VehicleTypeToParametersMap_t;
+    _parseParameterFactMetaDataFile(metaDataFile, *vehicleTypeToParametersMap);
+
+    ParsedFile_t parsedFile;
+    parsedFile.size                         = fileInfo.size();
+    parsedFile.lastModified                 = fileInfo.lastModified();
+    parsedFile.vehicleTypeToParametersMap   = QSharedPointer<const VehicleTypeToParametersMap_t>(vehicleTypeToParametersMap);
+    parsedFiles[metaDataFile] = parsedFile;
+
+    return parsedFile.vehicleTypeToParametersMap;
+}
+
+void APMParameterMetaData::_parseParameterFactMetaDataFile(const QString& metaDataFile, VehicleTypeToParametersMap_t& vehicleTypeToParametersMap)
+{
     QRegExp parameterCategories = QRegExp("ArduCopter|ArduPlane|APMrover2|ArduSub|AntennaTracker");
     QString currentCategory;
 
@@ -256,14 +294,12 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                           << "group: " << group;
 
                 Q_ASSERT(!rawMetaData);
-                if (_vehicleTypeToParametersMap[currentCategory].contains(name)) {
+                if (vehicleTypeToParametersMap[currentCategory].contains(name)) {
                     qCDebug(APMParameterMetaDataLog) << "Duplicate parameter found:" << name;
-                    rawMetaData = _vehicleTypeToParametersMap[currentCategory][name];
                 } else {
-                    rawMetaData = new APMFactMetaDataRaw(this);
-                    _vehicleTypeToParametersMap[currentCategory][name] = rawMetaData;
                     groupMembers[group] << name;
                 }
+                rawMetaData = &vehicleTypeToParametersMap[currentCategory][name];
                 qCDebug(APMParameterMetaDataVerboseLog) << "inserting metadata for field" << name;
                 rawMetaData->name = name;
                 rawMetaData->category = category;
@@ -296,7 +332,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 xmlState.pop();
             } else if (elementName == "parameters") {
                 qCDebug(APMParameterMetaDataVerboseLog) << "end of parameters for category: " << currentCategory;
-                correctGroupMemberships(_vehicleTypeToParametersMap[currentCategory], groupMembers);
+                correctGroupMemberships(vehicleTypeToParametersMap[currentCategory], groupMembers);
                 groupMembers.clear();
                 xmlState.pop();
             } else if (elementName == "vehicles") {
@@ -314,7 +350,7 @@ void APMParameterMetaData::correctGroupMemberships(ParameterNametoFactMetaDataMa
     foreach(const QString& groupName, groupMembers.keys()) {
             if (groupMembers[groupName].count() == 1) {
                 foreach(const QString& parameter, groupMembers.value(groupName)) {
-                    parameterToFactMetaDataMap[parameter]->group = FactMetaData::defaultGroup();
+                    parameterToFactMetaDataMap[parameter].group = FactMetaData::defaultGroup();
                 }
             }
         }
@@ -428,13 +464,20 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
 FactMetaData* APMParameterMetaData::getMetaDataForFact(const QString& name, MAV_TYPE vehicleType, FactMetaData::ValueType_t type)
 {
     const QString mavTypeString = mavTypeToString(vehicleType);
-    APMFactMetaDataRaw* rawMetaData = nullptr;
+    const APMFactMetaDataRaw* rawMetaData = nullptr;
 
     // check if we have metadata for fact, use generic otherwise
-    if (_vehicleTypeToParametersMap[mavTypeString].contains(name)) {
-        rawMetaData = _vehicleTypeToParametersMap[mavTypeString][name];
-    } else if (_vehicleTypeToParametersMap["libraries"].contains(name)) {
-        rawMetaData = _vehicleTypeToParametersMap["libraries"][name];
+    if (_vehicleTypeToParametersMap) {
+        for (const QString& category: { mavTypeString, QStringLiteral("libraries") }) {
+            auto categoryIter = _vehicleTypeToParametersMap->constFind(category);
+            if (categoryIter != _vehicleTypeToParametersMap->constEnd()) {
+                auto paramIter = categoryIter->constFind(name);
+                if (paramIter != categoryIter->constEnd()) {
+                    rawMetaData = &paramIter.value();
+                    break;
+                }
+            }
+        }
     }
 
     FactMetaData *metaData = new FactMetaData(type, this);
@@ -14,6 +14,7 @@
 #include <QObject>
 #include <QMap>
 #include <QPointer>
+#include <QSharedPointer>
 #include <QXmlStreamReader>
 #include <QLoggingCategory>
 
@@ -24,12 +25,11 @@
 Q_DECLARE_LOGGING_CATEGORY(APMParameterMetaDataLog)
 Q_DECLARE_LOGGING_CATEGORY(APMParameterMetaDataVerboseLog)
 
-class APMFactMetaDataRaw : public QObject
+class APMFactMetaDataRaw
 {
-    Q_OBJECT
 public:
-    APMFactMetaDataRaw(QObject *parent = nullptr)
-        : QObject(parent), rebootRequired(false)
+    APMFactMetaDataRaw(void)
+        : rebootRequired(false)
     { }
 
     QString name;
@@ -49,8 +49,10 @@ public:
 
 /// Collection of Parameter Facts for PX4 AutoPilot
 
-typedef QMap<QString, APMFactMetaDataRaw*> ParameterNametoFactMetaDataMap;
+typedef QMap<QString, APMFactMetaDataRaw> ParameterNametoFactMetaDataMap;
 
+/// The raw meta data read from a file is shared by all vehicles which load that file. FactMetaData is created from it
+/// per vehicle in getMetaDataForFact.
 class APMParameterMetaData : public QObject
 {
     Q_OBJECT
@@ -76,16 +78,22 @@ private:
         XmlStateDone
     };    
 
+    typedef QMap<QString, ParameterNametoFactMetaDataMap> VehicleTypeToParametersMap_t;
+
     QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
-    bool skipXMLBlock(QXmlStreamReader& xml, const QString& blockName);
-    bool parseParameterAttributes(QXmlStreamReader& xml, APMFactMetaDataRaw *rawMetaData);
-    void correctGroupMemberships(ParameterNametoFactMetaDataMap& parameterToFactMetaDataMap, QMap<QString,QStringList>& groupMembers);
+    static bool skipXMLBlock(QXmlStreamReader& xml, const QString& blockName);
+    static bool parseParameterAttributes(QXmlStreamReader& xml, APMFactMetaDataRaw *rawMetaData);
+    static void correctGroupMemberships(ParameterNametoFactMetaDataMap& parameterToFactMetaDataMap, QMap<QString,QStringList>& groupMembers);
     QString mavTypeToString(MAV_TYPE vehicleTypeEnum);
-    QString _groupFromParameterName(const QString& name);
+    static QString _groupFromParameterName(const QString& name);
+    static QSharedPointer<const VehicleTypeToParametersMap_t> _sharedVehicleTypeToParametersMap(const QString& metaDataFile);
+    static void _parseParameterFactMetaDataFile(const QString& metaDataFile, VehicleTypeToParametersMap_t& vehicleTypeToParametersMap);
 
-    bool                                            _parameterMetaDataLoaded        = false;    ///< true: parameter meta data already loaded
+    bool                                                _parameterMetaDataLoaded        = false;    ///< true: parameter meta data already loaded
     // FIXME: metadata is vehicle type specific now
-    QMap<QString, ParameterNametoFactMetaDataMap>   _vehicleTypeToParametersMap;                ///< Maps from a vehicle type to paramametertoFactMeta map>
+    QSharedPointer<const VehicleTypeToParametersMap_t>  _vehicleTypeToParametersMap;                ///< Maps from a vehicle type to paramametertoFactMeta map>, shared with all other users of the same file
+
+    friend class ParameterMetaDataTest;
 };
 
 #endif
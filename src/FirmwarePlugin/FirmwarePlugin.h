@@ -221,7 +221,8 @@ public:
     /// Important: Only CompInfoParam code should use this method
     virtual QString _internalParameterMetaDataFile(Vehicle* /*vehicle*/) { return QString(); }
 
-    /// Loads the specified parameter meta data file.
+    /// Loads the specified parameter meta data file. Called for every vehicle which connects, so the parsed file should be
+    /// shared between calls instead of being parsed again.
     /// @return Opaque parameter meta data information which must be stored with Vehicle. Vehicle is responsible to
     ///         call deleteParameterMetaData when no longer needed.
     /// Important: Only CompInfoParam code should use this method
@@ -263,6 +263,21 @@ FactMetaData* PX4FirmwarePlugin::_getMetaDataForFact(QObject* parameterMetaData,
     return nullptr;
 }
 
+bool PX4FirmwarePlugin::_isParameterVolatile(QObject* parameterMetaData, const QString& name, MAV_TYPE vehicleType)
+{
+    Q_UNUSED(vehicleType)
+
+    PX4ParameterMetaData* px4MetaData = qobject_cast<PX4ParameterMetaData*>(parameterMetaData);
+
+    if (px4MetaData) {
+        return px4MetaData->isParameterVolatile(name);
+    } else {
+        qWarning() << "Internal error: pointer passed to PX4FirmwarePlugin::_isParameterVolatile not PX4ParameterMetaData";
+    }
+
+    return false;
+}
+
 void PX4FirmwarePlugin::_getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion)
 {
     return PX4ParameterMetaData::getParameterMetaDataVersionInfo(metaDataFile, majorVersion, minorVersion);
@@ -19,6 +19,7 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QDateTime>
 
 static const char* kInvalidConverstion = "Internal Error: No support for string parameters";
 
@@ -88,6 +89,48 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
     _parameterMetaDataLoaded = true;
 
+    _rawMetaData = _sharedRawMetaData(metaDataFile);
+
+#ifdef GENERATE_PARAMETER_JSON
+    _generateParameterJson();
+#endif
+}
+
+/// Returns the parsed contents of the meta data file. Each file is only parsed once, later loads of the same unchanged
+/// file get the same read only copy.
+QSharedPointer<const PX4ParameterMetaData::NameToRawMetaDataMap_t> PX4ParameterMetaData::_sharedRawMetaData(const QString& metaDataFile)
+{
+    typedef struct {
+        qint64                                          size;
+        QDateTime                                       lastModified;
+        QSharedPointer<const NameToRawMetaDataMap_t>    rawMetaData;
+    } ParsedFile_t;
+
+    // Only used from the main thread
+    static QMap<QString, ParsedFile_t> parsedFiles;
+
+    // Downloaded meta data is cached under the same name across versions, so a changed file must be parsed again
+    QFileInfo fileInfo(metaDataFile);
+    auto iter = parsedFiles.constFind(metaDataFile);
+    if (iter != parsedFiles.constEnd() && iter->size == fileInfo.size() && iter->lastModified == fileInfo.lastModified()) {
+        qCDebug(PX4ParameterMetaDataLog) << "Using already parsed parameter meta data:" << metaDataFile;
+        return iter->rawMetaData;
+    }
+
+    NameToRawMetaDataMap_t* rawMetaDataMap = new NameToRawMetaDataMap_t;
+    _parseParameterFactMetaDataFile(metaDataFile, *rawMetaDataMap);
+
+    ParsedFile_t parsedFile;
+    parsedFile.size         = fileInfo.size();
+    parsedFile.lastModified = fileInfo.lastModified();
+    parsedFile.rawMetaData  = QSharedPointer<const NameToRawMetaDataMap_t>(rawMetaDataMap);
+    parsedFiles[metaDataFile] = parsedFile;
+
+    return parsedFile.rawMetaData;
+}
+
+void PX4ParameterMetaData::_parseParameterFactMetaDataFile(const QString& metaDataFile, NameToRawMetaDataMap_t& rawMetaDataMap)
+{
     qCDebug(PX4ParameterMetaDataLog) << "Loading parameter meta data:" << metaDataFile;
 
     QFile xmlFile(metaDataFile);
@@ -110,8 +153,8 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
     
     QString         factGroup;
-    QString         errorString;
-    FactMetaData*   metaData = nullptr;
+    QString         rawName;
+    RawMetaData_t*  rawMetaData = nullptr;
     int             xmlState = XmlStateNone;
     bool            badMetaData = true;
     
@@ -211,30 +254,25 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                     return;
                 }
                 
-                // Now that we know type we can create meta data object and add it to the system
-                metaData = new FactMetaData(foundType, this);
-                if (_mapParameterName2FactMetaData.contains(name)) {
+                // Now that we know type we can add the meta data to the system
+                rawName = name;
+                if (rawMetaDataMap.contains(name)) {
                     // We can't trust the meta data since we have dups
                     qCWarning(PX4ParameterMetaDataLog) << "Duplicate parameter found:" << name;
                     badMetaData = true;
                     // Reset to default meta data
-                    _mapParameterName2FactMetaData[name] = metaData;
+                    rawMetaDataMap[name] = RawMetaData_t();
+                    rawMetaData = &rawMetaDataMap[name];
+                    rawMetaData->type = foundType;
                 } else {
-                    _mapParameterName2FactMetaData[name] = metaData;
-                    metaData->setName(name);
-                    metaData->setCategory(category);
-                    metaData->setGroup(factGroup);
-                    metaData->setReadOnly(readOnly);
-                    metaData->setVolatileValue(volatileValue);
-                    
-                    if (xml.attributes().hasAttribute("default") && !strDefault.isEmpty()) {
-                        QVariant varDefault;
-                        
-                        if (metaData->convertAndValidateRaw(strDefault, false, varDefault, errorString)) {
-                            metaData->setRawDefaultValue(varDefault);
-                        } else {
-                            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << name << " type:" << type << " default:" << strDefault << " error:" << errorString;
-                        }
+                    rawMetaData = &rawMetaDataMap[name];
+                    rawMetaData->type           = foundType;
+                    rawMetaData->category       = category;
+                    rawMetaData->group          = factGroup;
+                    rawMetaData->readOnly       = readOnly;
+                    rawMetaData->volatileValue  = volatileValue;
+                    if (xml.attributes().hasAttribute("default")) {
+                        rawMetaData->defaultValue = strDefault;
                     }
                 }
                 
@@ -246,45 +284,33 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 }
 
                 if (!badMetaData) {
-                    if (metaData) {
+                    if (rawMetaData) {
                         if (elementName == "short_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Short description:" << text;
-                            metaData->setShortDescription(text);
+                            rawMetaData->shortDescription = text;
 
                         } else if (elementName == "long_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Long description:" << text;
-                            metaData->setLongDescription(text);
+                            rawMetaData->longDescription = text;
 
                         } else if (elementName == "min") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Min:" << text;
-
-                            QVariant varMin;
-                            if (metaData->convertAndValidateRaw(text, false /* convertOnly */, varMin, errorString)) {
-                                metaData->setRawMin(varMin);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid min value, name:" << metaData->name() << " type:" << metaData->type() << " min:" << text << " error:" << errorString;
-                            }
+                            rawMetaData->min = text;
 
                         } else if (elementName == "max") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Max:" << text;
-
-                            QVariant varMax;
-                            if (metaData->convertAndValidateRaw(text, false /* convertOnly */, varMax, errorString)) {
-                                metaData->setRawMax(varMax);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:" << metaData->type() << " max:" << text << " error:" << errorString;
-                            }
+                            rawMetaData->max = text;
 
                         } else if (elementName == "unit") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Unit:" << text;
-                            metaData->setRawUnits(text);
+                            rawMetaData->units = text;
 
                         } else if (elementName == "decimal") {
                             QString text = xml.readElementText();
@@ -293,16 +319,16 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                             bool convertOk;
                             QVariant varDecimals = QVariant(text).toUInt(&convertOk);
                             if (convertOk) {
-                                metaData->setDecimalPlaces(varDecimals.toInt());
+                                rawMetaData->decimalPlaces = varDecimals.toInt();
                             } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid decimals value, name:" << metaData->name() << " type:" << metaData->type() << " decimals:" << text << " error: invalid number";
+                                qCWarning(PX4ParameterMetaDataLog) << "Invalid decimals value, name:" << rawName << " decimals:" << text << " error: invalid number";
                             }
 
                         } else if (elementName == "reboot_required") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "RebootRequired:" << text;
                             if (text.compare("true", Qt::CaseInsensitive) == 0) {
-                                metaData->setVehicleRebootRequired(true);
+                                rawMetaData->rebootRequired = true;
                             }
 
                         } else if (elementName == "values") {
@@ -313,33 +339,14 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                             QString enumString = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
                                                              << "value desc:" << enumString << "code:" << enumValueStr;
+                            rawMetaData->values.append(QPair<QString, QString>(enumValueStr, enumString));
 
-                            QVariant    enumValue;
-                            QString     errorString;
-                            if (metaData->convertAndValidateRaw(enumValueStr, false /* validate */, enumValue, errorString)) {
-                                metaData->addEnumInfo(enumString, enumValue);
-                            } else {
-                                qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << metaData->name()
-                                                                 << " type:" << metaData->type() << " value:" << enumValueStr
-                                                                 << " error:" << errorString;
-                            }
                         } else if (elementName == "increment") {
-                            double  increment;
-                            bool    ok;
-                            QString text = xml.readElementText();
-                            increment = text.toDouble(&ok);
-                            if (ok) {
-                                metaData->setRawIncrement(increment);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << text;
-                            }
+                            rawMetaData->increment = xml.readElementText();
 
                         } else if (elementName == "boolean") {
-                            QVariant    enumValue;
-                            metaData->convertAndValidateRaw(1, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Enabled"), enumValue);
-                            metaData->convertAndValidateRaw(0, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Disabled"), enumValue);
+                            rawMetaData->values.append(QPair<QString, QString>(QStringLiteral("1"), tr("Enabled")));
+                            rawMetaData->values.append(QPair<QString, QString>(QStringLiteral("0"), tr("Disabled")));
 
                         } else if (elementName == "bitmask") {
                             // doing nothing individual bits will follow anyway. May be used for sanity checking.
@@ -353,16 +360,7 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                                                                  << "index:" << bit << "description:" << bitDescription;
 
                                 if (bit < 31) {
-                                    QVariant bitmaskRawValue = 1 << bit;
-                                    QVariant bitmaskValue;
-                                    QString errorString;
-                                    if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, errorString)) {
-                                        metaData->addBitmaskInfo(bitDescription, bitmaskValue);
-                                    } else {
-                                        qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << metaData->name()
-                                                                         << " type:" << metaData->type() << " value:" << bitmaskValue
-                                                                         << " error:" << errorString;
-                                    }
+                                    rawMetaData->bitmask.append(QPair<int, QString>(bit, bitDescription));
                                 } else {
                                     qCWarning(PX4ParameterMetaDataLog) << "Invalid value for bitmask, bit:" << bit;
                                 }
@@ -379,17 +377,8 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
             QString elementName = xml.name().toString();
 
             if (elementName == "parameter") {
-                // Done loading this parameter, validate default value
-                if (metaData->defaultValueAvailable()) {
-                    QVariant var;
-
-                    if (!metaData->convertAndValidateRaw(metaData->rawDefaultValue(), false /* convertOnly */, var, errorString)) {
-                        qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << metaData->name() << " type:" << metaData->type() << " default:" << metaData->rawDefaultValue() << " error:" << errorString;
-                    }
-                }
-
                 // Reset for next parameter
-                metaData = nullptr;
+                rawMetaData = nullptr;
                 badMetaData = false;
                 xmlState = XmlStateFoundGroup;
             } else if (elementName == "group") {
@@ -400,10 +389,105 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
         }
         xml.readNext();
     }
+}
 
-#ifdef GENERATE_PARAMETER_JSON
-    _generateParameterJson();
-#endif
+/// Creates the FactMetaData for a parameter from what was read from the file
+FactMetaData* PX4ParameterMetaData::_createMetaData(const QString& name, const RawMetaData_t& rawMetaData)
+{
+    QString         errorString;
+    FactMetaData*   metaData = new FactMetaData(rawMetaData.type, this);
+
+    metaData->setName(name);
+    metaData->setCategory(rawMetaData.category);
+    metaData->setGroup(rawMetaData.group);
+    metaData->setReadOnly(rawMetaData.readOnly);
+    metaData->setVolatileValue(rawMetaData.volatileValue);
+    metaData->setVehicleRebootRequired(rawMetaData.rebootRequired);
+
+    if (!rawMetaData.defaultValue.isEmpty()) {
+        QVariant varDefault;
+        if (metaData->convertAndValidateRaw(rawMetaData.defaultValue, false, varDefault, errorString)) {
+            metaData->setRawDefaultValue(varDefault);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << name << " type:" << metaData->type() << " default:" << rawMetaData.defaultValue << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.shortDescription.isEmpty()) {
+        metaData->setShortDescription(rawMetaData.shortDescription);
+    }
+    if (!rawMetaData.longDescription.isEmpty()) {
+        metaData->setLongDescription(rawMetaData.longDescription);
+    }
+
+    if (!rawMetaData.min.isEmpty()) {
+        QVariant varMin;
+        if (metaData->convertAndValidateRaw(rawMetaData.min, false /* convertOnly */, varMin, errorString)) {
+            metaData->setRawMin(varMin);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid min value, name:" << name << " type:" << metaData->type() << " min:" << rawMetaData.min << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.max.isEmpty()) {
+        QVariant varMax;
+        if (metaData->convertAndValidateRaw(rawMetaData.max, false /* convertOnly */, varMax, errorString)) {
+            metaData->setRawMax(varMax);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid max value, name:" << name << " type:" << metaData->type() << " max:" << rawMetaData.max << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.units.isEmpty()) {
+        metaData->setRawUnits(rawMetaData.units);
+    }
+
+    if (rawMetaData.decimalPlaces != FactMetaData::kUnknownDecimalPlaces) {
+        metaData->setDecimalPlaces(rawMetaData.decimalPlaces);
+    }
+
+    for (const QPair<QString, QString>& value: rawMetaData.values) {
+        QVariant enumValue;
+        if (metaData->convertAndValidateRaw(value.first, false /* validate */, enumValue, errorString)) {
+            metaData->addEnumInfo(value.second, enumValue);
+        } else {
+            qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << name
+                                             << " type:" << metaData->type() << " value:" << value.first
+                                             << " error:" << errorString;
+        }
+    }
+
+    if (!rawMetaData.increment.isEmpty()) {
+        bool    ok;
+        double  increment = rawMetaData.increment.toDouble(&ok);
+        if (ok) {
+            metaData->setRawIncrement(increment);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid value for increment, name:" << name << " increment:" << rawMetaData.increment;
+        }
+    }
+
+    for (const QPair<int, QString>& bit: rawMetaData.bitmask) {
+        QVariant bitmaskRawValue = 1 << bit.first;
+        QVariant bitmaskValue;
+        if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, errorString)) {
+            metaData->addBitmaskInfo(bit.second, bitmaskValue);
+        } else {
+            qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << name
+                                             << " type:" << metaData->type() << " value:" << bitmaskValue
+                                             << " error:" << errorString;
+        }
+    }
+
+    // Validate the default value against the final min/max
+    if (metaData->defaultValueAvailable()) {
+        QVariant var;
+        if (!metaData->convertAndValidateRaw(metaData->rawDefaultValue(), false /* convertOnly */, var, errorString)) {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << name << " type:" << metaData->type() << " default:" << metaData->rawDefaultValue() << " error:" << errorString;
+        }
+    }
+
+    return metaData;
 }
 
 #ifdef GENERATE_PARAMETER_JSON
@@ -420,6 +504,13 @@ void PX4ParameterMetaData::_generateParameterJson()
 {
     qCDebug(ParameterManagerLog) << "PX4ParameterMetaData::_generateParameterJson";
 
+    // Meta data is only created on demand, so create all of it first
+    if (_rawMetaData) {
+        for (auto iter = _rawMetaData->constBegin(); iter != _rawMetaData->constEnd(); iter++) {
+            getMetaDataForFact(iter.key(), MAV_TYPE_GENERIC, iter->type);
+        }
+    }
+
     int indentLevel = 0;
     QFile jsonFile(QDir(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)).absoluteFilePath("parameter.json"));
     jsonFile.open(QFile::WriteOnly | QFile::Truncate | QFile::Text);
@@ -495,14 +586,34 @@ FactMetaData* PX4ParameterMetaData::getMetaDataForFact(const QString& name, MAV_
     Q_UNUSED(vehicleType)
 
     if (!_mapParameterName2FactMetaData.contains(name)) {
-        qCDebug(PX4ParameterMetaDataLog) << "No metaData for " << name << "using generic metadata";
-        FactMetaData* metaData = new FactMetaData(type, this);
+        FactMetaData* metaData = nullptr;
+        if (_rawMetaData) {
+            auto iter = _rawMetaData->constFind(name);
+            if (iter != _rawMetaData->constEnd()) {
+                metaData = _createMetaData(name, iter.value());
+            }
+        }
+        if (!metaData) {
+            qCDebug(PX4ParameterMetaDataLog) << "No metaData for " << name << "using generic metadata";
+            metaData = new FactMetaData(type, this);
+        }
         _mapParameterName2FactMetaData[name] = metaData;
     }
 
     return _mapParameterName2FactMetaData[name];
 }
 
+bool PX4ParameterMetaData::isParameterVolatile(const QString& name) const
+{
+    if (_rawMetaData) {
+        auto iter = _rawMetaData->constFind(name);
+        if (iter != _rawMetaData->constEnd()) {
+            return iter->volatileValue;
+        }
+    }
+    return false;
+}
+
 void PX4ParameterMetaData::getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion)
 {
     QFile xmlFile(metaDataFile);
@@ -13,6 +13,7 @@
 
 #include <QObject>
 #include <QMap>
+#include <QSharedPointer>
 #include <QXmlStreamReader>
 #include <QLoggingCategory>
 
@@ -28,6 +29,10 @@ Q_DECLARE_LOGGING_CATEGORY(PX4ParameterMetaDataLog)
 //#define GENERATE_PARAMETER_JSON
 
 /// Loads and holds parameter fact meta data for PX4 stack
+///
+/// A meta data file is only parsed the first time it is loaded. The parsed contents are never modified after that, so
+/// they are shared by every vehicle which loads the same file. The FactMetaData for a parameter is only created when a
+/// vehicle asks for it.
 class PX4ParameterMetaData : public QObject
 {
     Q_OBJECT
@@ -37,6 +42,7 @@ public:
 
     void            loadParameterFactMetaDataFile   (const QString& metaDataFile);
     FactMetaData*   getMetaDataForFact              (const QString& name, MAV_TYPE vehicleType, FactMetaData::ValueType_t type);
+    bool            isParameterVolatile             (const QString& name) const;
 
     static void getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion);
 
@@ -50,15 +56,43 @@ private:
         XmlStateDone
     };    
 
+    /// Parameter meta data as read from the file
+    typedef struct {
+        FactMetaData::ValueType_t       type            = FactMetaData::valueTypeInt32;
+        QString                         category;
+        QString                         group;
+        QString                         shortDescription;
+        QString                         longDescription;
+        QString                         defaultValue;       ///< Empty if not specified
+        QString                         min;
+        QString                         max;
+        QString                         units;
+        QString                         increment;
+        int                             decimalPlaces   = FactMetaData::kUnknownDecimalPlaces;
+        bool                            rebootRequired  = false;
+        bool                            readOnly        = false;
+        bool                            volatileValue   = false;
+        QList<QPair<QString, QString>>  values;             ///< Enum code, description
+        QList<QPair<int, QString>>      bitmask;            ///< Bit index, description
+    } RawMetaData_t;
+
+    typedef QMap<QString, RawMetaData_t> NameToRawMetaDataMap_t;
+
     QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
     static void _outputFileWarning(const QString& metaDataFile, const QString& error1, const QString& error2);
+    static QSharedPointer<const NameToRawMetaDataMap_t> _sharedRawMetaData(const QString& metaDataFile);
+    static void _parseParameterFactMetaDataFile(const QString& metaDataFile, NameToRawMetaDataMap_t& rawMetaDataMap);
+    FactMetaData* _createMetaData(const QString& name, const RawMetaData_t& rawMetaData);
 
 #ifdef GENERATE_PARAMETER_JSON
     void _generateParameterJson();
 #endif
 
-    bool                                _parameterMetaDataLoaded        = false;    ///< true: parameter meta data already loaded
-    FactMetaData::NameToMetaDataMap_t   _mapParameterName2FactMetaData;             ///< Maps from a parameter name to FactMetaData
+    bool                                          _parameterMetaDataLoaded        = false;    ///< true: parameter meta data already loaded
+    QSharedPointer<const NameToRawMetaDataMap_t>  _rawMetaData;                               ///< Shared with all other users of the same file
+    FactMetaData::NameToMetaDataMap_t             _mapParameterName2FactMetaData;             ///< FactMetaData created so far
+
+    friend class ParameterMetaDataTest;
 };
 
 #endif
@@ -240,6 +240,15 @@ FlightMap {
             onPointAdded:           trajectoryPolyline.addCoordinate(coordinate)
             onUpdateLastPoint:      trajectoryPolyline.replaceCoordinate(trajectoryPolyline.pathLength() - 1, coordinate)
             onPointsCleared:        trajectoryPolyline.path = []
+            onLevelOfDetailChanged: trajectoryPolyline.path = activeVehicle.trajectoryPoints.list()
+        }
+
+        // Only the level of detail which fits the zoom level is shown
+        Binding {
+            target:                 activeVehicle ? activeVehicle.trajectoryPoints : null
+            property:               "zoomLevel"
+            value:                  _root.zoomLevel
+            when:                   !pipMode
         }
     }
 
@@ -60,7 +60,9 @@ void GPSManager::connectGPS(const QString& device, const QString& gps_type)
     //create RTCM device
     _rtcmMavlink = new RTCMMavlink(*_toolbox);
 
-    connect(_gpsProvider, &GPSProvider::RTCMDataUpdate, _rtcmMavlink, &RTCMMavlink::RTCMDataUpdate);
+    // Direct, RTCMMavlink queues the data to itself at high priority
+    connect(_gpsProvider, &GPSProvider::RTCMDataUpdate, _rtcmMavlink, &RTCMMavlink::RTCMDataUpdate, Qt::DirectConnection);
+    connect(_rtcmMavlink, &RTCMMavlink::rtcmDataStats,  this,         &GPSManager::rtcmDataStats);
 
     //test: connect to position update
     connect(_gpsProvider, &GPSProvider::positionUpdate,         this, &GPSManager::GPSPositionUpdate);
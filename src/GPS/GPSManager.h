@@ -37,6 +37,7 @@ signals:
     void onDisconnect();
     void surveyInStatus(float duration, float accuracyMM,  double latitude, double longitude, float altitude, bool valid, bool active);
     void satelliteUpdate(int numSats);
+    void rtcmDataStats(double dataRateKBps, double latencyMSecs);
 
 private slots:
     void GPSPositionUpdate(GPSPositionMessage msg);
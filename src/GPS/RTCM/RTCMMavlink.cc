@@ -12,66 +12,132 @@
 
 #include "MultiVehicleManager.h"
 #include "Vehicle.h"
+#include "QGCLoggingCategory.h"
 
-#include <cstdio>
+#include <QCoreApplication>
+#include <QThread>
+
+/// Carries an RTCM message from the GPS thread to the main thread
+class RTCMDataEvent : public QEvent
+{
+public:
+    RTCMDataEvent(const QByteArray& message_, qint64 receivedNSecs_)
+        : QEvent        (eventType())
+        , message       (message_)
+        , receivedNSecs (receivedNSecs_)
+    { }
+
+    static QEvent::Type eventType(void)
+    {
+        static const int type = QEvent::registerEventType();
+        return static_cast<QEvent::Type>(type);
+    }
+
+    QByteArray  message;
+    qint64      receivedNSecs;
+};
 
 RTCMMavlink::RTCMMavlink(QGCToolbox& toolbox)
     : _toolbox(toolbox)
 {
-    _bandwidthTimer.start();
+    memset(&_rtcmData, 0, sizeof(_rtcmData));
+    _sendBuffer.reserve(_maxFragments * MAVLINK_MAX_PACKET_LEN);
+    _clock.start();
 }
 
-void RTCMMavlink::RTCMDataUpdate(QByteArray message)
+void RTCMMavlink::RTCMDataUpdate(const QByteArray& message)
 {
-    /* statistics */
-    _bandwidthByteCounter += message.size();
-    qint64 elapsed = _bandwidthTimer.elapsed();
-    if (elapsed > 1000) {
-        printf("RTCM bandwidth: %.2f kB/s\n", (float) _bandwidthByteCounter / elapsed * 1000.f / 1024.f);
-        _bandwidthTimer.restart();
-        _bandwidthByteCounter = 0;
-    }
+    qint64 receivedNSecs = _clock.nsecsElapsed();
 
-    const int maxMessageLength = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN;
-    mavlink_gps_rtcm_data_t mavlinkRtcmData;
-    memset(&mavlinkRtcmData, 0, sizeof(mavlink_gps_rtcm_data_t));
-
-    if (message.size() < maxMessageLength) {
-        mavlinkRtcmData.len = message.size();
-        mavlinkRtcmData.flags = (_sequenceId & 0x1F) << 3;
-        memcpy(&mavlinkRtcmData.data, message.data(), message.size());
-        sendMessageToVehicle(mavlinkRtcmData);
+    if (QThread::currentThread() == thread()) {
+        _forward(message, receivedNSecs);
     } else {
-        // We need to fragment
-
-        uint8_t fragmentId = 0;         // Fragment id indicates the fragment within a set
-        int start = 0;
-        while (start < message.size()) {
-            int length = std::min(message.size() - start, maxMessageLength);
-            mavlinkRtcmData.flags = 1;                      // LSB set indicates message is fragmented
-            mavlinkRtcmData.flags |= fragmentId++ << 1;     // Next 2 bits are fragment id
-            mavlinkRtcmData.flags |= (_sequenceId & 0x1F) << 3;     // Next 5 bits are sequence id
-            mavlinkRtcmData.len = length;
-            memcpy(&mavlinkRtcmData.data, message.data() + start, length);
-            sendMessageToVehicle(mavlinkRtcmData);
-            start += length;
+        QCoreApplication::postEvent(this, new RTCMDataEvent(message, receivedNSecs), Qt::HighEventPriority);
+    }
+}
+
+bool RTCMMavlink::event(QEvent* event)
+{
+    if (event->type() == RTCMDataEvent::eventType()) {
+        RTCMDataEvent* rtcmEvent = static_cast<RTCMDataEvent*>(event);
+        _forward(rtcmEvent->message, rtcmEvent->receivedNSecs);
+        return true;
+    }
+    return QObject::event(event);
+}
+
+void RTCMMavlink::_forward(const QByteArray& message, qint64 receivedNSecs)
+{
+    if (message.size() > _maxFragments * MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN) {
+        qCWarning(RTKGPSLog) << "RTCM message too large to fragment" << message.size();
+        return;
+    }
+
+    // Vehicles sharing a link only need one copy
+    QmlObjectListModel& vehicles = *_toolbox.multiVehicleManager()->vehicles();
+    _links.clear();
+    _linkVehicles.clear();
+    for (int i = 0; i < vehicles.count(); i++) {
+        Vehicle*        vehicle = qobject_cast<Vehicle*>(vehicles[i]);
+        LinkInterface*  link    = vehicle->priorityLink();
+        if (link && link->isConnected() && !_links.contains(link)) {
+            _links.append(link);
+            _linkVehicles.append(vehicle);
         }
     }
+    for (int i = 0; i < _links.count(); i++) {
+        _sendLink(_linkVehicles[i], _links[i], message);
+    }
     ++_sequenceId;
+
+    /* statistics */
+    qint64 nowNSecs = _clock.nsecsElapsed();
+    _bandwidthByteCounter += message.size();
+    _latencyNSecs += nowNSecs - receivedNSecs;
+    _latencyCount++;
+    qint64 elapsedNSecs = nowNSecs - _bandwidthStartNSecs;
+    if (elapsedNSecs > 1000000000) {
+        double dataRateKBps = (static_cast<double>(_bandwidthByteCounter) * 1.0e9 / elapsedNSecs) / 1024.0;
+        double latencyMSecs = (static_cast<double>(_latencyNSecs) / _latencyCount) / 1.0e6;
+        qCDebug(RTKGPSLog) << QStringLiteral("RTCM bandwidth: %1 kB/s latency: %2 ms").arg(dataRateKBps, 0, 'f', 2).arg(latencyMSecs, 0, 'f', 3);
+        emit rtcmDataStats(dataRateKBps, latencyMSecs);
+        _bandwidthStartNSecs    = nowNSecs;
+        _bandwidthByteCounter   = 0;
+        _latencyNSecs           = 0;
+        _latencyCount           = 0;
+    }
 }
 
-void RTCMMavlink::sendMessageToVehicle(const mavlink_gps_rtcm_data_t& msg)
+/// Encodes all fragments of the message for the link's channel and sends them with a single write through the vehicle,
+/// so they show up in its sent message counts
+void RTCMMavlink::_sendLink(Vehicle* vehicle, LinkInterface* link, const QByteArray& message)
 {
-    QmlObjectListModel& vehicles = *_toolbox.multiVehicleManager()->vehicles();
+    const int maxMessageLength = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN;
     MAVLinkProtocol* mavlinkProtocol = _toolbox.mavlinkProtocol();
-    for (int i = 0; i < vehicles.count(); i++) {
-        Vehicle* vehicle = qobject_cast<Vehicle*>(vehicles[i]);
-        mavlink_message_t message;
+
+    uint8_t fragmentId = 0;         // Fragment id indicates the fragment within a set
+    int fragmentCount = 0;
+    int start = 0;
+    do {
+        int length = std::min(message.size() - start, maxMessageLength);
+        if (message.size() < maxMessageLength) {
+            _rtcmData.flags = (_sequenceId & 0x1F) << 3;
+        } else {
+            // We need to fragment
+            _rtcmData.flags = 1;                                // LSB set indicates message is fragmented
+            _rtcmData.flags |= fragmentId++ << 1;               // Next 2 bits are fragment id
+            _rtcmData.flags |= (_sequenceId & 0x1F) << 3;       // Next 5 bits are sequence id
+        }
+        _rtcmData.len = static_cast<uint8_t>(length);
+        memcpy(&_rtcmData.data, message.constData() + start, static_cast<size_t>(length));
         mavlink_msg_gps_rtcm_data_encode_chan(mavlinkProtocol->getSystemId(),
                                               mavlinkProtocol->getComponentId(),
-                                              vehicle->priorityLink()->mavlinkChannel(),
-                                              &message,
-                                              &msg);
-        vehicle->sendMessageOnLinkThreadSafe(vehicle->priorityLink(), message);
-    }
+                                              link->mavlinkChannel(),
+                                              &_messages[fragmentCount++],
+                                              &_rtcmData);
+
+        start += length;
+    } while (start < message.size());
+
+    vehicle->sendMessagesOnLinkThreadSafe(link, _messages, fragmentCount, _sendBuffer);
 }
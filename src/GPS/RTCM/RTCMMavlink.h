@@ -12,13 +12,22 @@
 
 #include <QObject>
 #include <QElapsedTimer>
+#include <QEvent>
+#include <QVector>
 
 #include "QGCToolbox.h"
 #include "MAVLinkProtocol.h"
 
+class LinkInterface;
+class Vehicle;
+
 /**
  ** class RTCMMavlink
  * Receives RTCM updates and sends them via MAVLINK to the device
+ *
+ * Each RTCM message is fragmented and encoded once per link into a reused buffer, and written to the link in one go
+ * through one of the vehicles on that link so the fragments are counted as sent by it. Vehicles which share a link
+ * get the corrections once, GPS_RTCM_DATA is not addressed to a particular vehicle.
  */
 class RTCMMavlink : public QObject
 {
@@ -28,13 +37,37 @@ public:
     //TODO: API to select device(s)?
 
 public slots:
-    void RTCMDataUpdate(QByteArray message);
+    /// Thread safe. Calls from other threads are posted at high priority so corrections are forwarded ahead of the
+    /// normal priority events already queued on the main thread.
+    void RTCMDataUpdate(const QByteArray& message);
+
+signals:
+    /// Emitted about once a second while corrections are flowing
+    ///     @param dataRateKBps     RTCM data forwarded per second
+    ///     @param latencyMSecs     Average time from receiving an RTCM message to it being written to the links
+    void rtcmDataStats(double dataRateKBps, double latencyMSecs);
+
+protected:
+    bool event(QEvent* event) override;
 
 private:
-    void sendMessageToVehicle(const mavlink_gps_rtcm_data_t& msg);
+    void _forward   (const QByteArray& message, qint64 receivedNSecs);
+    void _sendLink  (Vehicle* vehicle, LinkInterface* link, const QByteArray& message);
+
+    static const int _maxFragments = 4;     ///< Fragment id is two bits
 
     QGCToolbox& _toolbox;
-    QElapsedTimer _bandwidthTimer;
+    QElapsedTimer _clock;
+    qint64 _bandwidthStartNSecs = 0;
     int _bandwidthByteCounter = 0;
+    qint64 _latencyNSecs = 0;
+    int _latencyCount = 0;
     uint8_t _sequenceId = 0;
+
+    // Reused for every message so forwarding doesn't allocate
+    mavlink_gps_rtcm_data_t _rtcmData;
+    mavlink_message_t _messages[_maxFragments];
+    QByteArray _sendBuffer;
+    QVector<LinkInterface*> _links;
+    QVector<Vehicle*> _linkVehicles;        ///< Vehicle sending on the matching entry in _links
 };
@@ -18,6 +18,7 @@
 #include "QGCCameraControl.h"
 
 #include <QSettings>
+#include <QMutexLocker>
 
 QGC_LOGGING_CATEGORY(JoystickLog,       "JoystickLog")
 QGC_LOGGING_CATEGORY(JoystickValuesLog, "JoystickValuesLog")
@@ -460,21 +461,91 @@ void Joystick::run()
     //-- Joystick thread
     _open();
     //-- Reset timers
-    _axisTime.start();
+    _pollClock.start();
     for (int buttonIndex = 0; buttonIndex < _totalButtonCount; buttonIndex++) {
         if(_buttonActionArray[buttonIndex]) {
             _buttonActionArray[buttonIndex]->buttonTime.start();
         }
     }
+    _manualControlStatsMutex.lock();
+    _manualControlStats     = ManualControlStats_t();
+    _meanSendIntervalUSecs  = 0;
+    _lastSendNSecs          = -1;
+    _manualControlStatsMutex.unlock();
+
+    // Axis output is scheduled against deadlines on a high resolution clock instead of sleeping a fixed time after
+    // each loop. The device is sampled right before each send, so the sample is never older than the send itself.
+    qint64 nextAxisNSecs    = 0;
+    qint64 nextStatsLogNSecs = static_cast<qint64>(_statsLogMSecs) * 1000000;
     while (!_exitThread) {
+        const qint64 axisPeriodNSecs = static_cast<qint64>(1.0e9 / _axisFrequency);
+
         _update();
+        _sampleNSecs = _pollClock.nsecsElapsed();
         _handleButtons();
-        _handleAxis();
-        QGC::SLEEP::msleep(20);
+
+        if (_sampleNSecs >= nextAxisNSecs) {
+            _handleAxis();
+            nextAxisNSecs = _nextAxisDeadline(nextAxisNSecs, _sampleNSecs, axisPeriodNSecs);
+        }
+
+        if (_sampleNSecs >= nextStatsLogNSecs) {
+            nextStatsLogNSecs = _sampleNSecs + static_cast<qint64>(_statsLogMSecs) * 1000000;
+            ManualControlStats_t stats = manualControlStats();
+            qCDebug(JoystickLog) << "MANUAL_CONTROL sent:rateHz:jitterUSecs:maxIntervalUSecs:sampleAgeUSecs" << stats.sent << stats.rateHz << stats.jitterUSecs << stats.maxIntervalUSecs << stats.sampleAgeUSecs;
+        }
+
+        qint64 sleepUSecs = (_pollWakeTime(nextAxisNSecs, _sampleNSecs) - _pollClock.nsecsElapsed()) / 1000;
+        if (sleepUSecs > 0) {
+            QGC::SLEEP::usleep(static_cast<unsigned long>(sleepUSecs));
+        }
     }
     _close();
 }
 
+/// Steps from the deadline which was just met so the rate doesn't drift, but doesn't try to catch up after a stall
+///     @param deadlineNSecs Deadline of the axis output which was just sent
+///     @param sampleNSecs When the device was sampled for that output
+/// @return Deadline for the next axis output
+qint64 Joystick::_nextAxisDeadline(qint64 deadlineNSecs, qint64 sampleNSecs, qint64 periodNSecs)
+{
+    qint64 nextDeadlineNSecs = deadlineNSecs + periodNSecs;
+    if (nextDeadlineNSecs <= sampleNSecs) {
+        nextDeadlineNSecs = sampleNSecs + periodNSecs;
+    }
+    return nextDeadlineNSecs;
+}
+
+/// @return When the polling thread should wake up: the next axis output, but at least every _inputPollMSecs for buttons
+qint64 Joystick::_pollWakeTime(qint64 nextAxisNSecs, qint64 sampleNSecs)
+{
+    return qMin(nextAxisNSecs, sampleNSecs + static_cast<qint64>(_inputPollMSecs) * 1000000);
+}
+
+void Joystick::_updateManualControlStats(qint64 sendNSecs)
+{
+    QMutexLocker lock(&_manualControlStatsMutex);
+
+    _manualControlStats.sent++;
+    // Smoothed the same way as RFC 3550 jitter
+    _manualControlStats.sampleAgeUSecs += ((sendNSecs - _sampleNSecs) / 1000.0 - _manualControlStats.sampleAgeUSecs) / 16.0;
+    if (_lastSendNSecs >= 0) {
+        double intervalUSecs    = (sendNSecs - _lastSendNSecs) / 1000.0;
+        double deviationUSecs   = qAbs(intervalUSecs - 1.0e6 / _axisFrequency);
+        _meanSendIntervalUSecs = _meanSendIntervalUSecs == 0 ? intervalUSecs : _meanSendIntervalUSecs + (intervalUSecs - _meanSendIntervalUSecs) / 16.0;
+        _manualControlStats.rateHz              = 1.0e6 / _meanSendIntervalUSecs;
+        _manualControlStats.jitterUSecs         += (deviationUSecs - _manualControlStats.jitterUSecs) / 16.0;
+        _manualControlStats.maxIntervalUSecs    = qMax(_manualControlStats.maxIntervalUSecs, intervalUSecs);
+    }
+    _lastSendNSecs = sendNSecs;
+}
+
+Joystick::ManualControlStats_t Joystick::manualControlStats()
+{
+    QMutexLocker lock(&_manualControlStatsMutex);
+    return _manualControlStats;
+}
+
 void Joystick::_handleButtons()
 {
     int lastBbuttonValues[256];
@@ -573,101 +644,96 @@ void Joystick::_handleButtons()
 
 void Joystick::_handleAxis()
 {
-    //-- Get frequency
-    int axisDelay = static_cast<int>(1000.0f / _axisFrequency);
-    //-- Check elapsed time since last run
-    if(_axisTime.elapsed() > axisDelay) {
-        _axisTime.start();
-        //-- Update axis
-        for (int axisIndex = 0; axisIndex < _axisCount; axisIndex++) {
-            int newAxisValue = _getAxis(axisIndex);
-            // Calibration code requires signal to be emitted even if value hasn't changed
-            _rgAxisValues[axisIndex] = newAxisValue;
-            emit rawAxisValueChanged(axisIndex, newAxisValue);
-        }
-        if (_activeVehicle->joystickEnabled() && !_calibrationMode && _calibrated) {
-            int     axis = _rgFunctionAxis[rollFunction];
-            float   roll = _adjustRange(_rgAxisValues[axis],    _rgCalibration[axis], _deadband);
+    //-- Update axis
+    for (int axisIndex = 0; axisIndex < _axisCount; axisIndex++) {
+        int newAxisValue = _getAxis(axisIndex);
+        // Calibration code requires signal to be emitted even if value hasn't changed
+        _rgAxisValues[axisIndex] = newAxisValue;
+        emit rawAxisValueChanged(axisIndex, newAxisValue);
+    }
+    if (_activeVehicle->joystickEnabled() && !_calibrationMode && _calibrated) {
+        int     axis = _rgFunctionAxis[rollFunction];
+        float   roll = _adjustRange(_rgAxisValues[axis],    _rgCalibration[axis], _deadband);
 
-                    axis = _rgFunctionAxis[pitchFunction];
-            float   pitch = _adjustRange(_rgAxisValues[axis],   _rgCalibration[axis], _deadband);
+                axis = _rgFunctionAxis[pitchFunction];
+        float   pitch = _adjustRange(_rgAxisValues[axis],   _rgCalibration[axis], _deadband);
 
-                    axis = _rgFunctionAxis[yawFunction];
-            float   yaw = _adjustRange(_rgAxisValues[axis],     _rgCalibration[axis],_deadband);
+                axis = _rgFunctionAxis[yawFunction];
+        float   yaw = _adjustRange(_rgAxisValues[axis],     _rgCalibration[axis],_deadband);
 
-                    axis = _rgFunctionAxis[throttleFunction];
-            float   throttle = _adjustRange(_rgAxisValues[axis],_rgCalibration[axis], _throttleMode==ThrottleModeDownZero?false:_deadband);
+                axis = _rgFunctionAxis[throttleFunction];
+        float   throttle = _adjustRange(_rgAxisValues[axis],_rgCalibration[axis], _throttleMode==ThrottleModeDownZero?false:_deadband);
 
-            float   gimbalPitch = 0.0f;
-            float   gimbalYaw   = 0.0f;
+        float   gimbalPitch = 0.0f;
+        float   gimbalYaw   = 0.0f;
 
-            if(_axisCount > 4) {
-                axis = _rgFunctionAxis[gimbalPitchFunction];
-                gimbalPitch = _adjustRange(_rgAxisValues[axis], _rgCalibration[axis],_deadband);
-            }
+        if(_axisCount > 4) {
+            axis = _rgFunctionAxis[gimbalPitchFunction];
+            gimbalPitch = _adjustRange(_rgAxisValues[axis], _rgCalibration[axis],_deadband);
+        }
 
-            if(_axisCount > 5) {
-                axis = _rgFunctionAxis[gimbalYawFunction];
-                gimbalYaw = _adjustRange(_rgAxisValues[axis],   _rgCalibration[axis],_deadband);
-            }
+        if(_axisCount > 5) {
+            axis = _rgFunctionAxis[gimbalYawFunction];
+            gimbalYaw = _adjustRange(_rgAxisValues[axis],   _rgCalibration[axis],_deadband);
+        }
 
-            if (_accumulator) {
-                static float throttle_accu = 0.f;
-                throttle_accu += throttle * (40 / 1000.f); //for throttle to change from min to max it will take 1000ms (40ms is a loop time)
-                throttle_accu = std::max(static_cast<float>(-1.f), std::min(throttle_accu, static_cast<float>(1.f)));
-                throttle = throttle_accu;
-            }
+        if (_accumulator) {
+            static float throttle_accu = 0.f;
+            throttle_accu += throttle / _axisFrequency; //for throttle to change from min to max it will take 1000ms
+            throttle_accu = std::max(static_cast<float>(-1.f), std::min(throttle_accu, static_cast<float>(1.f)));
+            throttle = throttle_accu;
+        }
 
-            if (_circleCorrection) {
-                float roll_limited      = std::max(static_cast<float>(-M_PI_4), std::min(roll,      static_cast<float>(M_PI_4)));
-                float pitch_limited     = std::max(static_cast<float>(-M_PI_4), std::min(pitch,     static_cast<float>(M_PI_4)));
-                float yaw_limited       = std::max(static_cast<float>(-M_PI_4), std::min(yaw,       static_cast<float>(M_PI_4)));
-                float throttle_limited  = std::max(static_cast<float>(-M_PI_4), std::min(throttle,  static_cast<float>(M_PI_4)));
-
-                // Map from unit circle to linear range and limit
-                roll =      std::max(-1.0f, std::min(tanf(asinf(roll_limited)),     1.0f));
-                pitch =     std::max(-1.0f, std::min(tanf(asinf(pitch_limited)),    1.0f));
-                yaw =       std::max(-1.0f, std::min(tanf(asinf(yaw_limited)),      1.0f));
-                throttle =  std::max(-1.0f, std::min(tanf(asinf(throttle_limited)), 1.0f));
-            }
+        if (_circleCorrection) {
+            float roll_limited      = std::max(static_cast<float>(-M_PI_4), std::min(roll,      static_cast<float>(M_PI_4)));
+            float pitch_limited     = std::max(static_cast<float>(-M_PI_4), std::min(pitch,     static_cast<float>(M_PI_4)));
+            float yaw_limited       = std::max(static_cast<float>(-M_PI_4), std::min(yaw,       static_cast<float>(M_PI_4)));
+            float throttle_limited  = std::max(static_cast<float>(-M_PI_4), std::min(throttle,  static_cast<float>(M_PI_4)));
+
+            // Map from unit circle to linear range and limit
+            roll =      std::max(-1.0f, std::min(tanf(asinf(roll_limited)),     1.0f));
+            pitch =     std::max(-1.0f, std::min(tanf(asinf(pitch_limited)),    1.0f));
+            yaw =       std::max(-1.0f, std::min(tanf(asinf(yaw_limited)),      1.0f));
+            throttle =  std::max(-1.0f, std::min(tanf(asinf(throttle_limited)), 1.0f));
+        }
 
-            if ( _exponential < -0.01f) {
-                // Exponential (0% to -50% range like most RC radios)
-                // _exponential is set by a slider in joystickConfigAdvanced.qml
-                // Calculate new RPY with exponential applied
-                roll =  -_exponential*powf(roll, 3) + (1+_exponential)*roll;
-                pitch = -_exponential*powf(pitch,3) + (1+_exponential)*pitch;
-                yaw =   -_exponential*powf(yaw,  3) + (1+_exponential)*yaw;
-            }
+        if ( _exponential < -0.01f) {
+            // Exponential (0% to -50% range like most RC radios)
+            // _exponential is set by a slider in joystickConfigAdvanced.qml
+            // Calculate new RPY with exponential applied
+            roll =  -_exponential*powf(roll, 3) + (1+_exponential)*roll;
+            pitch = -_exponential*powf(pitch,3) + (1+_exponential)*pitch;
+            yaw =   -_exponential*powf(yaw,  3) + (1+_exponential)*yaw;
+        }
 
-            // Adjust throttle to 0:1 range
-            if (_throttleMode == ThrottleModeCenterZero && _activeVehicle->supportsThrottleModeCenterZero()) {
-                if (!_activeVehicle->supportsNegativeThrust() || !_negativeThrust) {
-                    throttle = std::max(0.0f, throttle);
-                }
-            } else {
-                throttle = (throttle + 1.0f) / 2.0f;
-            }
-            qCDebug(JoystickValuesLog) << "name:roll:pitch:yaw:throttle:gimbalPitch:gimbalYaw" << name() << roll << -pitch << yaw << throttle << gimbalPitch << gimbalYaw;
-            // NOTE: The buttonPressedBits going to MANUAL_CONTROL are currently used by ArduSub (and it only handles 16 bits)
-            // Set up button bitmap
-            quint64 buttonPressedBits = 0;  // Buttons pressed for manualControl signal
-            for (int buttonIndex = 0; buttonIndex < _totalButtonCount; buttonIndex++) {
-                quint64 buttonBit = static_cast<quint64>(1LL << buttonIndex);
-                if (_rgButtonValues[buttonIndex] != BUTTON_UP) {
-                    // Mark the button as pressed as long as its pressed
-                    buttonPressedBits |= buttonBit;
-                }
+        // Adjust throttle to 0:1 range
+        if (_throttleMode == ThrottleModeCenterZero && _activeVehicle->supportsThrottleModeCenterZero()) {
+            if (!_activeVehicle->supportsNegativeThrust() || !_negativeThrust) {
+                throttle = std::max(0.0f, throttle);
             }
-            uint16_t shortButtons = static_cast<uint16_t>(buttonPressedBits & 0xFFFF);
-            _activeVehicle->sendJoystickDataThreadSafe(roll, pitch, yaw, throttle, shortButtons);
-            emit axisValues(roll, -pitch, yaw, throttle); // Used by joystick cal screen
-            if(_activeVehicle && _axisCount > 4 && _gimbalEnabled) {
-                //-- TODO: There is nothing consuming this as there are no messages to handle gimbal
-                //   the way MANUAL_CONTROL handles the other channels.
-                emit manualControlGimbal((gimbalPitch + 1.0f) / 2.0f * 90.0f, gimbalYaw * 180.0f);
+        } else {
+            throttle = (throttle + 1.0f) / 2.0f;
+        }
+        qCDebug(JoystickValuesLog) << "name:roll:pitch:yaw:throttle:gimbalPitch:gimbalYaw" << name() << roll << -pitch << yaw << throttle << gimbalPitch << gimbalYaw;
+        // NOTE: The buttonPressedBits going to MANUAL_CONTROL are currently used by ArduSub (and it only handles 16 bits)
+        // Set up button bitmap
+        quint64 buttonPressedBits = 0;  // Buttons pressed for manualControl signal
+        for (int buttonIndex = 0; buttonIndex < _totalButtonCount; buttonIndex++) {
+            quint64 buttonBit = static_cast<quint64>(1LL << buttonIndex);
+            if (_rgButtonValues[buttonIndex] != BUTTON_UP) {
+                // Mark the button as pressed as long as its pressed
+                buttonPressedBits |= buttonBit;
             }
         }
+        uint16_t shortButtons = static_cast<uint16_t>(buttonPressedBits & 0xFFFF);
+        _activeVehicle->sendJoystickDataThreadSafe(roll, pitch, yaw, throttle, shortButtons);
+        _updateManualControlStats(_pollClock.nsecsElapsed());
+        emit axisValues(roll, -pitch, yaw, throttle); // Used by joystick cal screen
+        if(_activeVehicle && _axisCount > 4 && _gimbalEnabled) {
+            //-- TODO: There is nothing consuming this as there are no messages to handle gimbal
+            //   the way MANUAL_CONTROL handles the other channels.
+            emit manualControlGimbal((gimbalPitch + 1.0f) / 2.0f * 90.0f, gimbalYaw * 180.0f);
+        }
     }
 }
 
@@ -939,7 +1005,7 @@ void Joystick::setAxisFrequency(float val)
 {
     //-- Arbitrary limits
     if(val < 0.25f) val = 0.25f;
-    if(val > 50.0f) val = 50.0f;
+    if(val > _maxAxisFrequency) val = _maxAxisFrequency;
     _axisFrequency = val;
     _saveSettings();
     emit axisFrequencyChanged();
@@ -14,6 +14,8 @@
 
 #include <QObject>
 #include <QThread>
+#include <QMutex>
+#include <QElapsedTimer>
 
 #include "QGCLoggingCategory.h"
 #include "Vehicle.h"
@@ -102,6 +104,7 @@ public:
     Q_PROPERTY(bool     gimbalEnabled           READ gimbalEnabled          WRITE setGimbalEnabled      NOTIFY gimbalEnabledChanged)
     Q_PROPERTY(int      throttleMode            READ throttleMode           WRITE setThrottleMode       NOTIFY throttleModeChanged)
     Q_PROPERTY(float    axisFrequency           READ axisFrequency          WRITE setAxisFrequency      NOTIFY axisFrequencyChanged)
+    Q_PROPERTY(float    maxAxisFrequency        READ maxAxisFrequency       CONSTANT)
     Q_PROPERTY(float    buttonFrequency         READ buttonFrequency        WRITE setButtonFrequency    NOTIFY buttonFrequencyChanged)
     Q_PROPERTY(bool     negativeThrust          READ negativeThrust         WRITE setNegativeThrust     NOTIFY negativeThrustChanged)
     Q_PROPERTY(float    exponential             READ exponential            WRITE setExponential        NOTIFY exponentialChanged)
@@ -174,6 +177,19 @@ public:
     float axisFrequency     () { return _axisFrequency; }
     /// Set joystick message rate (in Hz)
     void  setAxisFrequency  (float val);
+    /// Highest supported joystick message rate (in Hz)
+    float maxAxisFrequency  () { return _maxAxisFrequency; }
+
+    typedef struct {
+        quint64 sent                = 0;    ///< MANUAL_CONTROL messages sent since polling started
+        double  rateHz              = 0;    ///< Measured send rate
+        double  jitterUSecs         = 0;    ///< Smoothed deviation of the send interval from the configured interval
+        double  maxIntervalUSecs    = 0;    ///< Longest interval between two sends
+        double  sampleAgeUSecs      = 0;    ///< Smoothed time from sampling the device to sending the sample
+    } ManualControlStats_t;
+
+    /// Statistics for the MANUAL_CONTROL output. Thread safe.
+    ManualControlStats_t manualControlStats();
 
     /// Get joystick button repeat rate (in Hz)
     float buttonFrequency   () { return _buttonFrequency; }
@@ -249,6 +265,11 @@ private:
     int _mapFunctionMode(int mode, int function);
     void _remapAxes(int currentMode, int newMode, int (&newMapping)[maxFunction]);
 
+    void _updateManualControlStats(qint64 sendNSecs);
+
+    static qint64 _nextAxisDeadline (qint64 deadlineNSecs, qint64 sampleNSecs, qint64 periodNSecs);
+    static qint64 _pollWakeTime     (qint64 nextAxisNSecs, qint64 sampleNSecs);
+
     // Override from QThread
     virtual void run();
 
@@ -289,7 +310,13 @@ protected:
 
     static int          _transmitterMode;
     int                 _rgFunctionAxis[maxFunction] = {};
-    QElapsedTimer       _axisTime;
+    QElapsedTimer       _pollClock;                     ///< Time base for the polling thread
+    qint64              _sampleNSecs        = 0;        ///< When the device was last sampled
+    qint64              _lastSendNSecs      = -1;       ///< When MANUAL_CONTROL was last sent
+
+    QMutex                  _manualControlStatsMutex;
+    ManualControlStats_t    _manualControlStats;
+    double                  _meanSendIntervalUSecs = 0;
 
     QmlObjectListModel              _assignableButtonActions;
     QList<AssignedButtonAction*>    _buttonActionArray;
@@ -300,6 +327,12 @@ protected:
 private:
     static const char*  _rgFunctionSettingsKey[maxFunction];
 
+    static constexpr float  _maxAxisFrequency       = 500.0f;
+    static const int        _inputPollMSecs         = 20;       ///< Longest time between device polls, keeps buttons responsive at low axis rates
+    static const int        _statsLogMSecs          = 5000;
+
+    friend class JoystickTest;
+
     static const char* _settingsGroup;
     static const char* _calibratedSettingsKey;
     static const char* _buttonActionNameKey;
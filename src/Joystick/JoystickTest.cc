@@ -0,0 +1,250 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "JoystickTest.h"
+#include "Joystick.h"
+#include "MockLink.h"
+#include "QGCApplication.h"
+
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+
+/// Joystick device with centered sticks which records when it is sampled
+class JoystickTestDevice : public Joystick
+{
+public:
+    JoystickTestDevice(MultiVehicleManager* multiVehicleManager)
+        : Joystick(QStringLiteral("JoystickTest"), 4 /* axisCount */, 0 /* buttonCount */, 0 /* hatCount */, multiVehicleManager)
+    { }
+
+    /// @return Sample times as QDeadlineTimer::current(Qt::PreciseTimer) nsecs
+    QList<qint64> sampleTimes(void)
+    {
+        QMutexLocker lock(&_sampleMutex);
+        return _sampleTimes;
+    }
+
+    int  index      (void) final { return 0; }
+    void setIndex   (int) final { }
+
+private:
+    bool _open      (void) final { return true; }
+    void _close     (void) final { }
+    bool _getButton (int) final { return false; }
+    int  _getAxis   (int) final { return 0; }
+    bool _getHat    (int, int) final { return false; }
+
+    bool _update(void) final
+    {
+        QMutexLocker lock(&_sampleMutex);
+        _sampleTimes.append(QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs());
+        return true;
+    }
+
+    QMutex          _sampleMutex;
+    QList<qint64>   _sampleTimes;
+};
+
+/// Runs the polling thread schedule against a simulated clock where every sleep overshoots by oversleepNSecs
+///     @param stallAtNSecs Time of a single stall of stallNSecs, -1 for none
+///     @param[out] wakeDelays Time from each sample to the following wake up
+/// @return Simulated axis output times
+QList<qint64> JoystickTest::_simulateSchedule(qint64 periodNSecs, qint64 runNSecs, qint64 oversleepNSecs, qint64 stallAtNSecs, qint64 stallNSecs, QList<qint64>* wakeDelays)
+{
+    QList<qint64>   sends;
+    qint64          nowNSecs        = 0;
+    qint64          nextAxisNSecs   = 0;
+    bool            stalled         = false;
+
+    while (nowNSecs < runNSecs) {
+        if (!stalled && stallAtNSecs >= 0 && nowNSecs >= stallAtNSecs) {
+            nowNSecs += stallNSecs;
+            stalled = true;
+        }
+
+        const qint64 sampleNSecs = nowNSecs;
+        if (sampleNSecs >= nextAxisNSecs) {
+            sends.append(sampleNSecs);
+            nextAxisNSecs = Joystick::_nextAxisDeadline(nextAxisNSecs, sampleNSecs, periodNSecs);
+        }
+
+        qint64 wakeNSecs = Joystick::_pollWakeTime(nextAxisNSecs, sampleNSecs);
+        if (wakeDelays) {
+            wakeDelays->append(wakeNSecs - sampleNSecs);
+        }
+        nowNSecs = qMax(wakeNSecs, sampleNSecs) + oversleepNSecs;
+    }
+
+    return sends;
+}
+
+/// Output deadlines step by the period from the previous deadline, so late wake ups don't add up to a lower rate
+void JoystickTest::_axisScheduleTest(void)
+{
+    const qint64 periodNSecs    = 1000000000 / _axisFrequency;
+    const qint64 runNSecs       = 1000000000;
+    const qint64 oversleepNSecs = 300000;
+
+    QList<qint64> sends = _simulateSchedule(periodNSecs, runNSecs, oversleepNSecs, -1, 0);
+
+    // Every send is within one oversleep of its deadline, the deadlines are exact multiples of the period
+    QCOMPARE(sends.count(), static_cast<int>(runNSecs / periodNSecs));
+    for (int i = 0; i < sends.count(); i++) {
+        qint64 lateNSecs = sends[i] - (i * periodNSecs);
+        QVERIFY2(lateNSecs >= 0 && lateNSecs <= oversleepNSecs, qPrintable(QStringLiteral("send %1 late by %2 ns").arg(i).arg(lateNSecs)));
+    }
+
+    // At a low rate the device is still polled for buttons every _inputPollMSecs
+    const qint64    inputPollNSecs  = static_cast<qint64>(Joystick::_inputPollMSecs) * 1000000;
+    QList<qint64>   wakeDelays;
+    sends = _simulateSchedule(1000000000 / 2, runNSecs, oversleepNSecs, -1, 0, &wakeDelays);
+    QCOMPARE(sends.count(), 2);
+    for (qint64 wakeDelayNSecs: wakeDelays) {
+        QVERIFY(wakeDelayNSecs > 0 && wakeDelayNSecs <= inputPollNSecs);
+    }
+}
+
+/// After a stall the schedule restarts from the late sample instead of sending a burst to catch up
+void JoystickTest::_axisScheduleStallTest(void)
+{
+    const qint64 periodNSecs    = 1000000000 / _axisFrequency;
+    const qint64 runNSecs       = 1000000000;
+    const qint64 oversleepNSecs = 300000;
+    const qint64 stallAtNSecs   = runNSecs / 2;
+    const qint64 stallNSecs     = 20 * periodNSecs + periodNSecs / 2;
+
+    QList<qint64> sends = _simulateSchedule(periodNSecs, runNSecs, oversleepNSecs, stallAtNSecs, stallNSecs);
+
+    int stallIndex = -1;
+    for (int i = 1; i < sends.count(); i++) {
+        qint64 intervalNSecs = sends[i] - sends[i - 1];
+        QVERIFY2(intervalNSecs >= periodNSecs - oversleepNSecs, qPrintable(QStringLiteral("send %1 only %2 ns after the previous one").arg(i).arg(intervalNSecs)));
+        if (intervalNSecs > stallNSecs) {
+            QCOMPARE(stallIndex, -1);
+            stallIndex = i;
+        }
+    }
+    QVERIFY(stallIndex > 0);
+
+    // The stall costs the sends which fell inside it, the rest keep the rate
+    const int expectedSends = static_cast<int>((runNSecs - stallNSecs) / periodNSecs);
+    QVERIFY2(qAbs(sends.count() - expectedSends) <= 1, qPrintable(QStringLiteral("%1 sends, expected %2").arg(sends.count()).arg(expectedSends)));
+}
+
+/// Stats computed from known send times
+void JoystickTest::_manualControlStatsTest(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    JoystickTestDevice* joystick = new JoystickTestDevice(qgcApp()->toolbox()->multiVehicleManager());
+    joystick->setAxisFrequency(_axisFrequency);
+
+    const qint64    periodNSecs     = 1000000000 / _axisFrequency;
+    const double    periodUSecs     = periodNSecs / 1000.0;
+    const qint64    sampleAgeNSecs  = 100000;
+    const int       cSends          = 300;  // Long enough for the smoothed sample age to settle
+
+    qint64 sendNSecs = 0;
+    for (int i = 0; i < cSends; i++) {
+        sendNSecs = i * periodNSecs;
+        joystick->_sampleNSecs = sendNSecs - sampleAgeNSecs;
+        joystick->_updateManualControlStats(sendNSecs);
+    }
+
+    Joystick::ManualControlStats_t stats = joystick->manualControlStats();
+    QCOMPARE(stats.sent, static_cast<quint64>(cSends));
+    QVERIFY(qAbs(stats.rateHz - _axisFrequency) < 0.001);
+    QVERIFY(stats.jitterUSecs < 0.001);
+    QVERIFY(qAbs(stats.maxIntervalUSecs - periodUSecs) < 0.001);
+    QVERIFY(qAbs(stats.sampleAgeUSecs - sampleAgeNSecs / 1000.0) < 0.001);
+
+    // A single late send shows up in the max interval and the jitter, and brings the smoothed rate down
+    sendNSecs += 3 * periodNSecs;
+    joystick->_sampleNSecs = sendNSecs - sampleAgeNSecs;
+    joystick->_updateManualControlStats(sendNSecs);
+
+    stats = joystick->manualControlStats();
+    QCOMPARE(stats.sent, static_cast<quint64>(cSends + 1));
+    QVERIFY(qAbs(stats.maxIntervalUSecs - 3 * periodUSecs) < 0.001);
+    QVERIFY(qAbs(stats.jitterUSecs - (2 * periodUSecs) / 16.0) < 0.001);
+    QVERIFY(stats.rateHz < _axisFrequency);
+
+    delete joystick;
+    _disconnectMockLink();
+}
+
+void JoystickTest::_manualControlRateTest(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    JoystickTestDevice* joystick = new JoystickTestDevice(qgcApp()->toolbox()->multiVehicleManager());
+    Joystick::Calibration_t calibration;
+    for (int axis = 0; axis < joystick->axisCount(); axis++) {
+        joystick->setCalibration(axis, calibration);
+    }
+    joystick->setAxisFrequency(_axisFrequency);
+    _vehicle->setJoystickEnabled(true);
+    joystick->startPolling(_vehicle);
+
+    QTest::qWait(_runMSecs);
+    joystick->stopPolling();
+    QVERIFY(joystick->wait(5000));
+
+    QList<qint64>                   samples     = joystick->sampleTimes();
+    QList<qint64>                   arrivals    = _mockLink->manualControlArrivals();
+    Joystick::ManualControlStats_t  stats       = joystick->manualControlStats();
+
+    QVERIFY(arrivals.count() > 1);
+    QVERIFY(static_cast<quint64>(arrivals.count()) <= stats.sent);
+
+    // Rate and interval jitter as seen by the vehicle
+    const double    periodUSecs     = 1.0e6 / _axisFrequency;
+    double          jitterUSecs     = 0;
+    double          maxIntervalUSecs = 0;
+    for (int i = 1; i < arrivals.count(); i++) {
+        double intervalUSecs = (arrivals[i] - arrivals[i - 1]) / 1000.0;
+        jitterUSecs += qAbs(intervalUSecs - periodUSecs);
+        maxIntervalUSecs = qMax(maxIntervalUSecs, intervalUSecs);
+    }
+    jitterUSecs /= arrivals.count() - 1;
+    double rateHz = (arrivals.count() - 1) / ((arrivals.last() - arrivals.first()) / 1.0e9);
+
+    // Latency from the device being sampled to the message reaching the vehicle
+    double  latencyUSecs    = 0;
+    double  maxLatencyUSecs = 0;
+    int     latencyCount    = 0;
+    int     sampleIndex     = 0;
+    for (qint64 arrival: arrivals) {
+        while (sampleIndex + 1 < samples.count() && samples[sampleIndex + 1] <= arrival) {
+            sampleIndex++;
+        }
+        if (samples.count() && samples[sampleIndex] <= arrival) {
+            double sampleLatencyUSecs = (arrival - samples[sampleIndex]) / 1000.0;
+            latencyUSecs += sampleLatencyUSecs;
+            maxLatencyUSecs = qMax(maxLatencyUSecs, sampleLatencyUSecs);
+            latencyCount++;
+        }
+    }
+    QVERIFY(latencyCount > 0);
+    latencyUSecs /= latencyCount;
+
+    qCDebug(JoystickLog) << "MANUAL_CONTROL requested rate" << _axisFrequency << "Hz received" << arrivals.count() << "at" << rateHz << "Hz";
+    qCDebug(JoystickLog) << "    interval jitter" << jitterUSecs << "us max interval" << maxIntervalUSecs << "us";
+    qCDebug(JoystickLog) << "    sample to vehicle latency" << latencyUSecs << "us max" << maxLatencyUSecs << "us";
+    qCDebug(JoystickLog) << "    joystick stats rate" << stats.rateHz << "Hz jitter" << stats.jitterUSecs << "us sample age" << stats.sampleAgeUSecs << "us";
+
+    // Wall clock timing on build machines is too noisy to assert on, it is only logged above. The schedule itself is
+    // checked by _axisScheduleTest. Here the output must merely be flowing and counted.
+    QVERIFY(stats.sent > 1);
+    QVERIFY(stats.rateHz > 0);
+
+    _vehicle->setJoystickEnabled(false);
+    delete joystick;
+    _disconnectMockLink();
+}
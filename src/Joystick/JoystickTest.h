@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Checks the MANUAL_CONTROL output of the joystick polling thread. Scheduling and stats are checked against a
+/// simulated clock, the real thread against MockLink only logs its timing since build machines are too noisy for it.
+class JoystickTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _axisScheduleTest(void);
+    void _axisScheduleStallTest(void);
+    void _manualControlStatsTest(void);
+    void _manualControlRateTest(void);
+
+private:
+    QList<qint64> _simulateSchedule(qint64 periodNSecs, qint64 runNSecs, qint64 oversleepNSecs, qint64 stallAtNSecs, qint64 stallNSecs, QList<qint64>* wakeDelays = nullptr);
+
+    static const int _axisFrequency             = 200;
+    static const int _runMSecs                  = 2000;
+};
@@ -25,7 +25,9 @@ MissionManager::MissionManager(Vehicle* vehicle)
     : PlanManager               (vehicle, MAV_MISSION_TYPE_MISSION)
     , _cachedLastCurrentIndex   (-1)
 {
-    connect(_vehicle, &Vehicle::mavlinkMessageReceived, this, &MissionManager::_mavlinkMessageReceived);
+    MAVLinkMessageDispatcher* dispatcher = _vehicle->messageDispatcher();
+    dispatcher->subscribe(this, MAVLINK_MSG_ID_MISSION_CURRENT, [this](LinkInterface*, const mavlink_message_t& message) { _handleMissionCurrent(message); });
+    dispatcher->subscribe(this, MAVLINK_MSG_ID_HEARTBEAT,       [this](LinkInterface*, const mavlink_message_t& message) { _handleHeartbeat(message); });
 }
 
 MissionManager::~MissionManager()
@@ -216,20 +218,6 @@ void MissionManager::generateResumeMission(int resumeIndex)
     _writeMissionItemsWorker();
 }
 
-/// Called when a new mavlink message for out vehicle is received
-void MissionManager::_mavlinkMessageReceived(const mavlink_message_t& message)
-{
-    switch (message.msgid) {
-    case MAVLINK_MSG_ID_MISSION_CURRENT:
-        _handleMissionCurrent(message);
-        break;
-
-    case MAVLINK_MSG_ID_HEARTBEAT:
-        _handleHeartbeat(message);
-        break;
-    }
-}
-
 void MissionManager::_handleMissionCurrent(const mavlink_message_t& message)
 {
     mavlink_mission_current_t missionCurrent;
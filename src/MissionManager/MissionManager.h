@@ -38,9 +38,6 @@ public:
     /// from mission start to resumeIndex in the generate mission.
     void generateResumeMission(int resumeIndex);
 
-private slots:
-    void _mavlinkMessageReceived(const mavlink_message_t& message);
-
 private:
     void _handleMissionCurrent(const mavlink_message_t& message);
     void _handleHeartbeat(const mavlink_message_t& message);
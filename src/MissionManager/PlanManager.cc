@@ -677,36 +677,6 @@ void PlanManager::_handleMissionAck(const mavlink_message_t& message)
     }
 }
 
-/// Called when a new mavlink message for out vehicle is received
-void PlanManager::_mavlinkMessageReceived(const mavlink_message_t& message)
-{
-    switch (message.msgid) {
-    case MAVLINK_MSG_ID_MISSION_COUNT:
-        _handleMissionCount(message);
-        break;
-
-    case MAVLINK_MSG_ID_MISSION_ITEM:
-        _handleMissionItem(message, false /* missionItemInt */);
-        break;
-
-    case MAVLINK_MSG_ID_MISSION_ITEM_INT:
-        _handleMissionItem(message, true /* missionItemInt */);
-        break;
-
-    case MAVLINK_MSG_ID_MISSION_REQUEST:
-        _handleMissionRequest(message, false /* missionItemInt */);
-        break;
-
-    case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
-        _handleMissionRequest(message, true /* missionItemInt */);
-        break;
-
-    case MAVLINK_MSG_ID_MISSION_ACK:
-        _handleMissionAck(message);
-        break;
-    }
-}
-
 void PlanManager::_sendError(ErrorCode_t errorCode, const QString& errorMsg)
 {
     qCDebug(PlanManagerLog) << QStringLiteral("Sending error - _planTypeString(%1) errorCode(%2) errorMsg(%4)").arg(_planTypeString()).arg(errorCode).arg(errorMsg);
@@ -974,14 +944,35 @@ void PlanManager::_clearAndDeleteWriteMissionItems(void)
     _writeMissionItems.clear();
 }
 
+/// Subscribes to the mission protocol messages for the duration of a transaction
 void PlanManager::_connectToMavlink(void)
 {
-    connect(_vehicle, &Vehicle::mavlinkMessageReceived, this, &PlanManager::_mavlinkMessageReceived);
+    if (!_messageSubscriptionIds.isEmpty()) {
+        return;
+    }
+
+    MAVLinkMessageDispatcher* dispatcher = _vehicle->messageDispatcher();
+
+    _messageSubscriptionIds.append(dispatcher->subscribe(this, MAVLINK_MSG_ID_MISSION_COUNT,
+                                                         [this](LinkInterface*, const mavlink_message_t& message) { _handleMissionCount(message); }));
+    _messageSubscriptionIds.append(dispatcher->subscribe(this, MAVLINK_MSG_ID_MISSION_ITEM,
+                                                         [this](LinkInterface*, const mavlink_message_t& message) { _handleMissionItem(message, false /* missionItemInt */); }));
+    _messageSubscriptionIds.append(dispatcher->subscribe(this, MAVLINK_MSG_ID_MISSION_ITEM_INT,
+                                                         [this](LinkInterface*, const mavlink_message_t& message) { _handleMissionItem(message, true /* missionItemInt */); }));
+    _messageSubscriptionIds.append(dispatcher->subscribe(this, MAVLINK_MSG_ID_MISSION_REQUEST,
+                                                         [this](LinkInterface*, const mavlink_message_t& message) { _handleMissionRequest(message, false /* missionItemInt */); }));
+    _messageSubscriptionIds.append(dispatcher->subscribe(this, MAVLINK_MSG_ID_MISSION_REQUEST_INT,
+                                                         [this](LinkInterface*, const mavlink_message_t& message) { _handleMissionRequest(message, true /* missionItemInt */); }));
+    _messageSubscriptionIds.append(dispatcher->subscribe(this, MAVLINK_MSG_ID_MISSION_ACK,
+                                                         [this](LinkInterface*, const mavlink_message_t& message) { _handleMissionAck(message); }));
 }
 
 void PlanManager::_disconnectFromMavlink(void)
 {
-    disconnect(_vehicle, &Vehicle::mavlinkMessageReceived, this, &PlanManager::_mavlinkMessageReceived);
+    for (int subscriptionId: _messageSubscriptionIds) {
+        _vehicle->messageDispatcher()->unsubscribe(subscriptionId);
+    }
+    _messageSubscriptionIds.clear();
 }
 
 QString PlanManager::_planTypeString(void)
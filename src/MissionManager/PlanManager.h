@@ -90,7 +90,6 @@ signals:
     void resumeMissionUploadFail    (void);
 
 private slots:
-    void _mavlinkMessageReceived(const mavlink_message_t& message);
     void _ackTimeout(void);
 
 protected:
@@ -155,6 +154,7 @@ protected:
     QList<MissionItem*> _writeMissionItems;     ///< Set of mission items currently being written to vehicle
     int                 _currentMissionIndex;
     int                 _lastCurrentIndex;
+    QList<int>          _messageSubscriptionIds;///< Mission protocol subscriptions while connected to mavlink
 
 private:
     void _setTransactionInProgress(TransactionType_t type);
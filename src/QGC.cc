@@ -129,8 +129,37 @@ static const quint32 crctab[] =
     0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
+/// Tables for processing eight bytes per step (slice-by-8). Table 0 is crctab, table n is the CRC contribution of a
+/// byte followed by n zero bytes.
+struct Crc32SliceTables {
+    quint32 tab[8][256];
+
+    Crc32SliceTables()
+    {
+        for (int i = 0; i < 256; i++) {
+            tab[0][i] = crctab[i];
+        }
+        for (int i = 0; i < 256; i++) {
+            for (int slice = 1; slice < 8; slice++) {
+                tab[slice][i] = (tab[slice - 1][i] >> 8) ^ crctab[tab[slice - 1][i] & 0xff];
+            }
+        }
+    }
+};
+
 quint32 crc32(const quint8 *src, unsigned len, unsigned state)
 {
+    static const Crc32SliceTables tables;
+    const quint32 (&tab)[8][256] = tables.tab;
+
+    while (len >= 8) {
+        quint32 one = state ^ (static_cast<quint32>(src[0]) | (static_cast<quint32>(src[1]) << 8) | (static_cast<quint32>(src[2]) << 16) | (static_cast<quint32>(src[3]) << 24));
+        quint32 two = static_cast<quint32>(src[4]) | (static_cast<quint32>(src[5]) << 8) | (static_cast<quint32>(src[6]) << 16) | (static_cast<quint32>(src[7]) << 24);
+        state = tab[7][one & 0xff] ^ tab[6][(one >> 8) & 0xff] ^ tab[5][(one >> 16) & 0xff] ^ tab[4][one >> 24] ^
+                tab[3][two & 0xff] ^ tab[2][(two >> 8) & 0xff] ^ tab[1][(two >> 16) & 0xff] ^ tab[0][two >> 24];
+        src += 8;
+        len -= 8;
+    }
     for (unsigned i = 0; i < len; i++) {
         state = crctab[(state ^ src[i]) & 0xff] ^ (state >> 8);
     }
@@ -53,6 +53,7 @@ public:
     using QThread::usleep;
 };
 
+/// CRC32 with the reflected 0xEDB88320 polynomial and no pre or post inversion, matching the PX4 bootloader
 quint32 crc32(const quint8 *src, unsigned len, unsigned state);
 
 }
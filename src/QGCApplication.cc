@@ -363,6 +363,7 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
        connect(gpsManager, &GPSManager::onDisconnect,       this, &QGCApplication::_onGPSDisconnect);
        connect(gpsManager, &GPSManager::surveyInStatus,     this, &QGCApplication::_gpsSurveyInStatus);
        connect(gpsManager, &GPSManager::satelliteUpdate,    this, &QGCApplication::_gpsNumSatellites);
+       connect(gpsManager, &GPSManager::rtcmDataStats,      this, &QGCApplication::_gpsRtcmDataStats);
    }
 #endif /* __mobile__ */
 
@@ -533,6 +534,7 @@ void QGCApplication::_initCommon()
     qmlRegisterUncreatableType<MissionCommandTree>  (kQGroundControl,                       1, 0, "MissionCommandTree",         kRefOnly);
     qmlRegisterUncreatableType<CameraCalc>          (kQGroundControl,                       1, 0, "CameraCalc",                 kRefOnly);
     qmlRegisterUncreatableType<LogReplayLink>       (kQGroundControl,                       1, 0, "LogReplayLink",              kRefOnly);
+    qmlRegisterUncreatableType<TelemetryLogWriter>  (kQGroundControl,                       1, 0, "TelemetryLogWriter",         kRefOnly);
     qmlRegisterUncreatableType<InstrumentValueData> (kQGroundControl,                       1, 0, "InstrumentValueData",        kRefOnly);
     qmlRegisterType<LogReplayLinkController>        (kQGroundControl,                       1, 0, "LogReplayLinkController");
 #if defined(QGC_ENABLE_MAVLINK_INSPECTOR)
@@ -929,6 +931,8 @@ void QGCApplication::_onGPSConnect()
 void QGCApplication::_onGPSDisconnect()
 {
     _gpsRtkFactGroup->connected()->setRawValue(false);
+    _gpsRtkFactGroup->rtcmDataRate()->setRawValue(0);
+    _gpsRtkFactGroup->rtcmLatency()->setRawValue(0);
 }
 
 void QGCApplication::_gpsSurveyInStatus(float duration, float accuracyMM,  double latitude, double longitude, float altitude, bool valid, bool active)
@@ -947,6 +951,12 @@ void QGCApplication::_gpsNumSatellites(int numSatellites)
     _gpsRtkFactGroup->numSatellites()->setRawValue(numSatellites);
 }
 
+void QGCApplication::_gpsRtcmDataStats(double dataRateKBps, double latencyMSecs)
+{
+    _gpsRtkFactGroup->rtcmDataRate()->setRawValue(dataRateKBps);
+    _gpsRtkFactGroup->rtcmLatency()->setRawValue(latencyMSecs);
+}
+
 QString QGCApplication::cachedParameterMetaDataFile(void)
 {
     QSettings settings;
@@ -172,6 +172,7 @@ private slots:
     void _onGPSDisconnect                           (void);
     void _gpsSurveyInStatus                         (float duration, float accuracyMM,  double latitude, double longitude, float altitude, bool valid, bool active);
     void _gpsNumSatellites                          (int numSatellites);
+    void _gpsRtcmDataStats                          (double dataRateKBps, double latencyMSecs);
     void _showDelayedAppMessages                    (void);
 
 private:
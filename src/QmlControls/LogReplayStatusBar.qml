@@ -70,6 +70,9 @@ Rectangle {
                 ListElement { text: "1x";   value: 1 }
                 ListElement { text: "2x";   value: 2 }
                 ListElement { text: "5x";   value: 5 }
+                ListElement { text: "10x";  value: 10 }
+                ListElement { text: "25x";  value: 25 }
+                ListElement { text: "100x"; value: 100 }
             }
 
             onActivated: controller.playbackSpeed = model.get(currentIndex).value
@@ -11,13 +11,13 @@ ElevationProvider::ElevationProvider(const QString& imageFormat, quint32 average
 //-----------------------------------------------------------------------------
 int AirmapElevationProvider::long2tileX(const double lon, const int z) const {
     Q_UNUSED(z)
-    return static_cast<int>(floor((lon + 180.0) / srtm1TileSize));
+    return tileX(lon);
 }
 
 //-----------------------------------------------------------------------------
 int AirmapElevationProvider::lat2tileY(const double lat, const int z) const {
     Q_UNUSED(z)
-    return static_cast<int>(floor((lat + 90.0) / srtm1TileSize));
+    return tileY(lat);
 }
 
 QString AirmapElevationProvider::_getURL(const int x, const int y, const int zoom, QNetworkAccessManager* networkManager) {
@@ -37,6 +37,11 @@ class AirmapElevationProvider : public ElevationProvider {
 
     int lat2tileY(const double lat, const int z) const override;
 
+    /// Tile math shared with the terrain tile manager, which needs it without going through the provider table.
+    /// Elevation tiles are srtm1TileSize degrees square and don't depend on the zoom level.
+    static int tileX(const double lon) { return static_cast<int>(floor((lon + 180.0) / srtm1TileSize)); }
+    static int tileY(const double lat) { return static_cast<int>(floor((lat + 90.0) / srtm1TileSize)); }
+
     QGCTileSet getTileCount(const int zoom, const double topleftLon,
                             const double topleftLat, const double bottomRightLon,
                             const double bottomRightLat) const override;
@@ -24,6 +24,7 @@ HEADERS += \
     $$PWD/QGCMapTileSet.h \
     $$PWD/QGCMapUrlEngine.h \
     $$PWD/QGCTileCacheWorker.h \
+    $$PWD/QGCTileMemoryCache.h \
     $$PWD/QGeoCodeReplyQGC.h \
     $$PWD/QGeoCodingManagerEngineQGC.h \
     $$PWD/QGeoMapReplyQGC.h \
@@ -45,6 +46,7 @@ SOURCES += \
     $$PWD/QGCMapTileSet.cpp \
     $$PWD/QGCMapUrlEngine.cpp \
     $$PWD/QGCTileCacheWorker.cpp \
+    $$PWD/QGCTileMemoryCache.cpp \
     $$PWD/QGeoCodeReplyQGC.cpp \
     $$PWD/QGeoCodingManagerEngineQGC.cpp \
     $$PWD/QGeoMapReplyQGC.cpp \
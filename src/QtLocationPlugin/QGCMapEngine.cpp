@@ -23,6 +23,7 @@
 #include <QSettings>
 #include <QStandardPaths>
 #include <QDir>
+#include <QTimer>
 #include <stdio.h>
 
 #include "QGCMapEngine.h"
@@ -165,6 +166,7 @@ QGCMapEngine::init()
     } else {
         qCritical() << "Could not find suitable map cache directory.";
     }
+    _memoryCache.setMaxBytes(_memoryCacheBytes());
     QGCMapTask* task = new QGCMapTask(QGCMapTask::taskInit);
     _worker.enqueueTask(task);
 }
@@ -195,6 +197,33 @@ QGCMapEngine::_wipeDirectory(const QString& dirPath)
 void
 QGCMapEngine::addTask(QGCMapTask* task)
 {
+    switch(task->type()) {
+        case QGCMapTask::taskFetchTile: {
+            //-- Serve from memory if we can. The worker only sees true misses.
+            QGCFetchTileTask* fetchTask = static_cast<QGCFetchTileTask*>(task);
+            QByteArray img;
+            QString format;
+            QString type;
+            if(_memoryCache.find(fetchTask->hash(), img, format, type)) {
+                QGCCacheTile* tile = new QGCCacheTile(fetchTask->hash(), img, format, type);
+                //-- Delivered from the event loop same as a worker reply, callers may still be connecting to the reply.
+                QTimer::singleShot(0, fetchTask, [fetchTask, tile]() {
+                    fetchTask->setTileFetched(tile);
+                    fetchTask->deleteLater();
+                });
+                return;
+            }
+            break;
+        }
+        case QGCMapTask::taskDeleteTileSet:
+        case QGCMapTask::taskReset:
+        case QGCMapTask::taskImport:
+            //-- Tiles may be gone from the database
+            _memoryCache.clear();
+            break;
+        default:
+            break;
+    }
     _worker.enqueueTask(task);
 }
 
@@ -210,6 +239,10 @@ QGCMapEngine::cacheTile(QString type, int x, int y, int z, const QByteArray& ima
 void
 QGCMapEngine::cacheTile(QString type, const QString& hash, const QByteArray& image, const QString& format, qulonglong set)
 {
+    //-- Only tiles which are being looked at. Offline downloads would just flush the working set.
+    if(set == UINT64_MAX) {
+        _memoryCache.insert(hash, image, format, type);
+    }
     AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
     //-- If we are allowed to persist data, save tile to cache
     if(!appSettings->disableAllPersistence()->rawValue().toBool()) {
@@ -308,6 +341,15 @@ QGCMapEngine::setMaxMemCache(quint32 size)
     QSettings settings;
     settings.setValue(kMaxMemCacheKey, size);
     _maxMemCache = size;
+    _memoryCache.setMaxBytes(_memoryCacheBytes());
+}
+
+//-----------------------------------------------------------------------------
+quint64
+QGCMapEngine::_memoryCacheBytes()
+{
+    //-- A quarter of the memory cache setting goes to raw tiles, the rest is left to Qt's decoded tile cache
+    return static_cast<quint64>(getMaxMemCache()) * 1024 * 1024 / 4;
 }
 
 //-----------------------------------------------------------------------------
@@ -350,6 +392,12 @@ void
 QGCMapEngine::_updateTotals(quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize)
 {
     emit updateTotals(totaltiles, totalsize, defaulttiles, defaultsize);
+    if(QGCTileCacheLog().isDebugEnabled()) {
+        QGCTileMemoryCache::Stats_t stats = _memoryCache.stats();
+        qCDebug(QGCTileCacheLog) << "Memory cache tiles:" << stats.count << "bytes:" << stats.bytes
+                                 << "hits:" << stats.hits << "misses:" << stats.misses
+                                 << "insertions:" << stats.insertions << "evictions:" << stats.evictions;
+    }
     quint64 maxSize = static_cast<quint64>(getMaxDiskCache()) * 1024L * 1024L;
     if(!_prunning && defaultsize > maxSize) {
         //-- Prune Disk Cache
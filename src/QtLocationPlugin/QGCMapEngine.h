@@ -24,6 +24,7 @@
 #include "QGCMapUrlEngine.h"
 #include "QGCMapEngineData.h"
 #include "QGCTileCacheWorker.h"
+#include "QGCTileMemoryCache.h"
 
 
 //-----------------------------------------------------------------------------
@@ -54,6 +55,7 @@ public:
     bool                        isInternetActive    () { return _isInternetActive; }
 
     UrlFactory*                 urlFactory          () { return _urlFactory; }
+    QGCTileMemoryCache*         memoryCache         () { return &_memoryCache; }
 
     //-- Tile Math
     static QGCTileSet           getTileCount        (int zoom, double topleftLon, double topleftLat, double bottomRightLon, double bottomRightLat, QString mapType);
@@ -77,9 +79,11 @@ private:
     void _wipeOldCaches         ();
     void _checkWipeDirectory    (const QString& dirPath);
     bool _wipeDirectory         (const QString& dirPath);
+    quint64 _memoryCacheBytes   ();
 
 private:
     QGCCacheWorker          _worker;
+    QGCTileMemoryCache      _memoryCache;
     QString                 _cachePath;
     QString                 _cacheFile;
     UrlFactory*             _urlFactory;
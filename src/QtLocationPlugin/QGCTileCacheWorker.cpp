@@ -26,6 +26,7 @@
 #include <QDateTime>
 #include <QApplication>
 #include <QFile>
+#include <QElapsedTimer>
 
 #include "time.h"
 
@@ -40,6 +41,23 @@ QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 #define LONG_TIMEOUT        5
 #define SHORT_TIMEOUT       2
 
+//-- Maximum number of tile writes in a single transaction
+#define MAX_BATCH_WRITES    500
+//-- Throughput log interval (seconds)
+#define THROUGHPUT_TIMEOUT  10
+
+//-- SQL for QGCCacheWorker::Statement_t, in the same order
+static const char* kStatementSQL[] = {
+    "INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)",
+    "INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(?, ?)",
+    "SELECT tile, format, type FROM Tiles WHERE hash = ?",
+    "SELECT tileID FROM Tiles WHERE hash = ?",
+    "INSERT OR IGNORE INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(?, ?, ?, ?, ?, ?, ?)",
+    "UPDATE TilesDownload SET state = ? WHERE setID = ? AND hash = ?",
+    "UPDATE TilesDownload SET state = ? WHERE setID = ?",
+    "DELETE FROM TilesDownload WHERE setID = ? AND hash = ?",
+};
+
 //-----------------------------------------------------------------------------
 QGCCacheWorker::QGCCacheWorker()
     : _db(nullptr)
@@ -53,7 +71,19 @@ QGCCacheWorker::QGCCacheWorker()
     , _lastUpdate(0)
     , _updateTimeout(SHORT_TIMEOUT)
     , _hostLookupID(0)
+    , _inTransaction(false)
+    , _batchWrites(0)
+    , _savedTiles(0)
+    , _fetchedTiles(0)
+    , _missedTiles(0)
+    , _saveNSecs(0)
+    , _fetchNSecs(0)
+    , _lastThroughputLog(0)
 {
+    static_assert(sizeof(kStatementSQL) / sizeof(kStatementSQL[0]) == StatementCount, "kStatementSQL out of sync with Statement_t");
+    for(int i = 0; i < StatementCount; i++) {
+        _statements[i] = nullptr;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -115,18 +145,25 @@ QGCCacheWorker::run()
         _init();
     }
     if(_valid) {
-        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
-        _db->setDatabaseName(_databasePath);
-        _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        _valid = _db->open();
+        _connectDB();
     }
+    _lastThroughputLog = time(nullptr);
     while(true) {
         QGCMapTask* task;
         if(_taskQueue.count()) {
             _mutex.lock();
             task = _taskQueue.dequeue();
             _mutex.unlock();
-            switch(task->type()) {
+            //-- Tile writes share a transaction until the queue drains. Anything else runs on its own.
+            QGCMapTask::TaskType type = task->type();
+            if(type == QGCMapTask::taskCacheTile || type == QGCMapTask::taskUpdateTileDownloadState || type == QGCMapTask::taskGetTileDownloadList) {
+                _beginBatch();
+            } else if(type != QGCMapTask::taskFetchTile) {
+                _commitBatch();
+            }
+            QElapsedTimer taskTimer;
+            taskTimer.start();
+            switch(type) {
                 case QGCMapTask::taskInit:
                     break;
                 case QGCMapTask::taskCacheTile:
@@ -170,8 +207,20 @@ QGCCacheWorker::run()
                     break;
             }
             task->deleteLater();
-            //-- Check for update timeout
             size_t count = static_cast<size_t>(_taskQueue.count());
+            if(!count || _batchWrites >= MAX_BATCH_WRITES) {
+                _commitBatch();
+            }
+            //-- Commit time is accounted to the writes
+            if(type == QGCMapTask::taskFetchTile) {
+                _fetchNSecs += taskTimer.nsecsElapsed();
+            } else if(type == QGCMapTask::taskCacheTile || type == QGCMapTask::taskUpdateTileDownloadState) {
+                _saveNSecs += taskTimer.nsecsElapsed();
+            }
+            if(time(nullptr) - _lastThroughputLog >= THROUGHPUT_TIMEOUT) {
+                _logThroughput();
+            }
+            //-- Check for update timeout
             if(count > 100) {
                 _updateTimeout = LONG_TIMEOUT;
             } else if(count < 25) {
@@ -197,12 +246,115 @@ QGCCacheWorker::run()
             _mutex.unlock();
         }
     }
+    _logThroughput();
+    _disconnectDB();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_connectDB()
+{
+    _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
+    _db->setDatabaseName(_databasePath);
+    _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+    _valid = _db->open();
+    if(_valid) {
+        //-- With WAL a commit appends to the log instead of rewriting the database, and NORMAL only syncs at checkpoints.
+        //   This is still safe against corruption, a power loss can at worst lose the last few committed tiles.
+        QSqlQuery query(*_db);
+        if(!query.exec("PRAGMA journal_mode=WAL")) {
+            qWarning() << "Map Cache SQL error (journal_mode):" << query.lastError().text();
+        }
+        if(!query.exec("PRAGMA synchronous=NORMAL")) {
+            qWarning() << "Map Cache SQL error (synchronous):" << query.lastError().text();
+        }
+    }
+    return _valid;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_disconnectDB()
+{
+    _commitBatch();
+    _clearStatements();
     if(_db) {
         delete _db;
         _db = nullptr;
         QSqlDatabase::removeDatabase(kSession);
     }
 }
+
+//-----------------------------------------------------------------------------
+QSqlQuery*
+QGCCacheWorker::_statement(Statement_t statement)
+{
+    if(!_statements[statement]) {
+        QSqlQuery* query = new QSqlQuery(*_db);
+        query->setForwardOnly(true);
+        if(!query->prepare(kStatementSQL[statement])) {
+            qWarning() << "Map Cache SQL error (prepare):" << kStatementSQL[statement] << query->lastError().text();
+        }
+        _statements[statement] = query;
+    }
+    return _statements[statement];
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_clearStatements()
+{
+    for(int i = 0; i < StatementCount; i++) {
+        delete _statements[i];
+        _statements[i] = nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_beginBatch()
+{
+    if(!_inTransaction && _valid && _db) {
+        _inTransaction = _db->transaction();
+        _batchWrites = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_commitBatch()
+{
+    if(_inTransaction) {
+        if(!_db->commit()) {
+            qWarning() << "Map Cache SQL error (commit tile batch):" << _db->lastError().text();
+        }
+        qCDebug(QGCTileCacheLog) << "_commitBatch() writes:" << _batchWrites;
+        _inTransaction = false;
+        _batchWrites = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_logThroughput()
+{
+    //-- Rates are over the time the worker spent on the tasks, not wall clock time
+    if(_savedTiles) {
+        qCDebug(QGCTileCacheLog) << "Tiles saved:" << _savedTiles
+                                 << "tiles/sec:" << (_saveNSecs ? static_cast<double>(_savedTiles) * 1.0e9 / _saveNSecs : 0.0);
+    }
+    if(_fetchedTiles || _missedTiles) {
+        qCDebug(QGCTileCacheLog) << "Tiles fetched:" << _fetchedTiles << "missed:" << _missedTiles
+                                 << "tiles/sec:" << (_fetchNSecs ? static_cast<double>(_fetchedTiles + _missedTiles) * 1.0e9 / _fetchNSecs : 0.0);
+    }
+    _savedTiles         = 0;
+    _fetchedTiles       = 0;
+    _missedTiles        = 0;
+    _saveNSecs          = 0;
+    _fetchNSecs         = 0;
+    _lastThroughputLog  = time(nullptr);
+}
+
 //-----------------------------------------------------------------------------
 bool
 QGCCacheWorker::_findTileSetID(const QString name, quint64& setID)
@@ -241,22 +393,24 @@ QGCCacheWorker::_saveTile(QGCMapTask *mtask)
 {
     if(_valid) {
         QGCSaveTileTask* task = static_cast<QGCSaveTileTask*>(mtask);
-        QSqlQuery query(*_db);
-        query.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-        query.addBindValue(task->tile()->hash());
-        query.addBindValue(task->tile()->format());
-        query.addBindValue(task->tile()->img());
-        query.addBindValue(task->tile()->img().size());
-        query.addBindValue(task->tile()->type());
-        query.addBindValue(QDateTime::currentDateTime().toTime_t());
-        if(query.exec()) {
-            quint64 tileID = query.lastInsertId().toULongLong();
+        QSqlQuery* query = _statement(StatementInsertTile);
+        query->bindValue(0, task->tile()->hash());
+        query->bindValue(1, task->tile()->format());
+        query->bindValue(2, task->tile()->img());
+        query->bindValue(3, task->tile()->img().size());
+        query->bindValue(4, task->tile()->type());
+        query->bindValue(5, QDateTime::currentDateTime().toTime_t());
+        if(query->exec()) {
+            quint64 tileID = query->lastInsertId().toULongLong();
             quint64 setID = task->tile()->set() == UINT64_MAX ? _getDefaultTileSet() : task->tile()->set();
-            QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-            query.prepare(s);
-            if(!query.exec()) {
-                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
+            QSqlQuery* setQuery = _statement(StatementInsertSetTile);
+            setQuery->bindValue(0, tileID);
+            setQuery->bindValue(1, setID);
+            if(!setQuery->exec()) {
+                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << setQuery->lastError().text();
             }
+            _batchWrites++;
+            _savedTiles++;
             qCDebug(QGCTileCacheLog) << "_saveTile() HASH:" << task->tile()->hash();
         } else {
             //-- Tile was already there.
@@ -276,20 +430,25 @@ QGCCacheWorker::_getTile(QGCMapTask* mtask)
     }
     bool found = false;
     QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tile, format, type FROM Tiles WHERE hash = \"%1\"").arg(task->hash());
-    if(query.exec(s)) {
-        if(query.next()) {
-            QByteArray ar   = query.value(0).toByteArray();
-            QString format  = query.value(1).toString();
-            QString type = getQGCMapEngine()->urlFactory()->getTypeFromId(query.value(2).toInt());
+    QSqlQuery* query = _statement(StatementGetTile);
+    query->bindValue(0, task->hash());
+    if(query->exec()) {
+        if(query->next()) {
+            QByteArray ar   = query->value(0).toByteArray();
+            QString format  = query->value(1).toString();
+            QString type = getQGCMapEngine()->urlFactory()->getTypeFromId(query->value(2).toInt());
+            query->finish();
             qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
+            getQGCMapEngine()->memoryCache()->insert(task->hash(), ar, format, type);
             QGCCacheTile* tile = new QGCCacheTile(task->hash(), ar, format, type);
             task->setTileFetched(tile);
             found = true;
+            _fetchedTiles++;
         }
     }
     if(!found) {
+        query->finish();
+        _missedTiles++;
         qCDebug(QGCTileCacheLog) << "_getTile() (NOT in DB) HASH:" << task->hash();
         task->setError("Tile not in cache database");
     }
@@ -418,13 +577,14 @@ QGCCacheWorker::_updateTotals()
 quint64 QGCCacheWorker::_findTile(const QString hash)
 {
     quint64 tileID = 0;
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tileID FROM Tiles WHERE hash = \"%1\"").arg(hash);
-    if(query.exec(s)) {
-        if(query.next()) {
-            tileID = query.value(0).toULongLong();
+    QSqlQuery* query = _statement(StatementFindTile);
+    query->bindValue(0, hash);
+    if(query->exec()) {
+        if(query->next()) {
+            tileID = query->value(0).toULongLong();
         }
     }
+    query->finish();
     return tileID;
 }
 
@@ -460,12 +620,15 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
             //-- Prepare Download List
             quint64 tileCount = 0;
             _db->transaction();
+            QSqlQuery* downloadQuery = _statement(StatementInsertDownload);
+            QSqlQuery* setQuery = _statement(StatementInsertSetTile);
             for(int z = task->tileSet()->minZoom(); z <= task->tileSet()->maxZoom(); z++) {
                 QGCTileSet set = QGCMapEngine::getTileCount(z,
                     task->tileSet()->topleftLon(), task->tileSet()->topleftLat(),
                     task->tileSet()->bottomRightLon(), task->tileSet()->bottomRightLat(), task->tileSet()->type());
                 tileCount += set.tileCount;
                 QString type = task->tileSet()->type();
+                int typeID = getQGCMapEngine()->urlFactory()->getIdFromType(type);
                 for(int x = set.tileX0; x <= set.tileX1; x++) {
                     for(int y = set.tileY0; y <= set.tileY1; y++) {
                         //-- See if tile is already downloaded
@@ -473,26 +636,26 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
                         quint64 tileID = _findTile(hash);
                         if(!tileID) {
                             //-- Set to download
-                            query.prepare("INSERT OR IGNORE INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(?, ?, ?, ?, ? ,? ,?)");
-                            query.addBindValue(setID);
-                            query.addBindValue(hash);
-                            query.addBindValue(getQGCMapEngine()->urlFactory()->getIdFromType(type));
-                            query.addBindValue(x);
-                            query.addBindValue(y);
-                            query.addBindValue(z);
-                            query.addBindValue(0);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into TilesDownload):" << query.lastError().text();
+                            downloadQuery->bindValue(0, setID);
+                            downloadQuery->bindValue(1, hash);
+                            downloadQuery->bindValue(2, typeID);
+                            downloadQuery->bindValue(3, x);
+                            downloadQuery->bindValue(4, y);
+                            downloadQuery->bindValue(5, z);
+                            downloadQuery->bindValue(6, 0);
+                            if(!downloadQuery->exec()) {
+                                qWarning() << "Map Cache SQL error (add tile into TilesDownload):" << downloadQuery->lastError().text();
+                                _db->rollback();
                                 mtask->setError("Error creating tile set download list");
                                 return;
                             } else
                                 actual_count++;
                         } else {
                             //-- Tile already in the database. No need to dowload.
-                            QString s = QString("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-                            query.prepare(s);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
+                            setQuery->bindValue(0, tileID);
+                            setQuery->bindValue(1, setID);
+                            if(!setQuery->exec()) {
+                                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << setQuery->lastError().text();
                             }
                             qCDebug(QGCTileCacheLog) << "_createTileSet() Already Cached HASH:" << hash;
                         }
@@ -530,10 +693,14 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
             tile->setZ(query.value("z").toInt());
             tiles.append(tile);
         }
+        query.finish();
+        QSqlQuery* stateQuery = _statement(StatementUpdateDownloadState);
         for(int i = 0; i < tiles.size(); i++) {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and hash = \"%3\"").arg(static_cast<int>(QGCTile::StateDownloading)).arg(task->setID()).arg(tiles[i]->hash());
-            if(!query.exec(s)) {
-                qWarning() << "Map Cache SQL error (set TilesDownload state):" << query.lastError().text();
+            stateQuery->bindValue(0, static_cast<int>(QGCTile::StateDownloading));
+            stateQuery->bindValue(1, task->setID());
+            stateQuery->bindValue(2, tiles[i]->hash());
+            if(!stateQuery->exec()) {
+                qWarning() << "Map Cache SQL error (set TilesDownload state):" << stateQuery->lastError().text();
             }
         }
     }
@@ -548,20 +715,27 @@ QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
         return;
     }
     QGCUpdateTileDownloadStateTask* task = static_cast<QGCUpdateTileDownloadStateTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s;
+    QSqlQuery* query;
     if(task->state() == QGCTile::StateComplete) {
-        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND hash = \"%2\"").arg(task->setID()).arg(task->hash());
+        query = _statement(StatementDeleteDownload);
+        query->bindValue(0, task->setID());
+        query->bindValue(1, task->hash());
     } else {
         if(task->hash() == "*") {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg(static_cast<int>(task->state())).arg(task->setID());
+            query = _statement(StatementUpdateDownloadStateAll);
+            query->bindValue(0, static_cast<int>(task->state()));
+            query->bindValue(1, task->setID());
         } else {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND hash = \"%3\"").arg(static_cast<int>(task->state())).arg(task->setID()).arg(task->hash());
+            query = _statement(StatementUpdateDownloadState);
+            query->bindValue(0, static_cast<int>(task->state()));
+            query->bindValue(1, task->setID());
+            query->bindValue(2, task->hash());
         }
     }
-    if(!query.exec(s)) {
-        qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
+    if(!query->exec()) {
+        qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query->lastError().text();
     }
+    _batchWrites++;
 }
 
 //-----------------------------------------------------------------------------
@@ -648,6 +822,7 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
         return;
     }
     QGCResetTask* task = static_cast<QGCResetTask*>(mtask);
+    _clearStatements();
     QSqlQuery query(*_db);
     QString s;
     s = QString("DROP TABLE Tiles");
@@ -673,11 +848,7 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
     //-- If replacing, simply copy over it
     if(task->replace()) {
         //-- Close and delete old database
-        if(_db) {
-            delete _db;
-            _db = nullptr;
-            QSqlDatabase::removeDatabase(kSession);
-        }
+        _disconnectDB();
         QFile file(_databasePath);
         file.remove();
         //-- Copy given database
@@ -686,10 +857,7 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
         _init();
         if(_valid) {
             task->setProgress(50);
-            _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
-            _db->setDatabaseName(_databasePath);
-            _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            _valid = _db->open();
+            _connectDB();
         }
         task->setProgress(100);
     } else {
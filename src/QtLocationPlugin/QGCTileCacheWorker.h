@@ -26,6 +26,7 @@
 #include <QWaitCondition>
 #include <QMutexLocker>
 #include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
 #include <QHostInfo>
 
 #include "QGCLoggingCategory.h"
@@ -54,6 +55,19 @@ private slots:
     void        _lookupReady            (QHostInfo info);
 
 private:
+    //-- Statements used per tile. These are prepared once and reused for the life of the connection.
+    enum Statement_t {
+        StatementInsertTile,
+        StatementInsertSetTile,
+        StatementGetTile,
+        StatementFindTile,
+        StatementInsertDownload,
+        StatementUpdateDownloadState,
+        StatementUpdateDownloadStateAll,
+        StatementDeleteDownload,
+        StatementCount
+    };
+
     void        _saveTile               (QGCMapTask* mtask);
     void        _getTile                (QGCMapTask* mtask);
     void        _getTileSets            (QGCMapTask* mtask);
@@ -73,6 +87,13 @@ private:
     bool        _findTileSetID          (const QString name, quint64& setID);
     void        _updateSetTotals        (QGCCachedTileSet* set);
     bool        _init                   ();
+    bool        _connectDB              ();
+    void        _disconnectDB           ();
+    QSqlQuery*  _statement              (Statement_t statement);
+    void        _clearStatements        ();
+    void        _beginBatch             ();
+    void        _commitBatch            ();
+    void        _logThroughput          ();
     bool        _createDB               (QSqlDatabase *db, bool createDefault = true);
     quint64     _getDefaultTileSet      ();
     void        _updateTotals           ();
@@ -99,6 +120,15 @@ private:
     time_t                  _lastUpdate;
     int                     _updateTimeout;
     int                     _hostLookupID;
+    QSqlQuery*              _statements[StatementCount];
+    bool                    _inTransaction;     ///< Tile writes are batched into a single transaction
+    int                     _batchWrites;
+    quint32                 _savedTiles;        ///< Throughput counters since the last log
+    quint32                 _fetchedTiles;
+    quint32                 _missedTiles;
+    qint64                  _saveNSecs;
+    qint64                  _fetchNSecs;
+    time_t                  _lastThroughputLog;
 };
 
 #endif // QGC_TILE_CACHE_WORKER_H
@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief In-memory tile cache in front of the tile cache worker
+ *
+ */
+
+#include "QGCTileMemoryCache.h"
+
+#include <QMutexLocker>
+
+//-- Default budget until the map engine sets one
+#define DEFAULT_MAX_BYTES   (32 * 1024 * 1024)
+
+//-----------------------------------------------------------------------------
+QGCTileMemoryCache::QGCTileMemoryCache()
+    : _maxBytes(0)
+{
+    setMaxBytes(DEFAULT_MAX_BYTES);
+}
+
+//-----------------------------------------------------------------------------
+QGCTileMemoryCache::Shard_t&
+QGCTileMemoryCache::_shard(const QString& hash)
+{
+    return _shards[qHash(hash) % _shardCount];
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::setMaxBytes(quint64 maxBytes)
+{
+    _maxBytes = maxBytes;
+    for(int i = 0; i < _shardCount; i++) {
+        QMutexLocker lock(&_shards[i].mutex);
+        _shards[i].maxBytes = maxBytes / _shardCount;
+        _evict(_shards[i]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::_evict(Shard_t& shard)
+{
+    //-- Least recently used are at the back
+    while(shard.bytes > shard.maxBytes && !shard.entries.empty()) {
+        const Entry_t& entry = shard.entries.back();
+        shard.bytes -= static_cast<quint64>(entry.img.size());
+        shard.index.remove(entry.hash);
+        shard.entries.pop_back();
+        shard.evictions++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::insert(const QString& hash, const QByteArray& img, const QString& format, const QString& type)
+{
+    Shard_t& shard = _shard(hash);
+    QMutexLocker lock(&shard.mutex);
+    if(img.isEmpty() || static_cast<quint64>(img.size()) > shard.maxBytes) {
+        return;
+    }
+    auto iter = shard.index.find(hash);
+    if(iter != shard.index.end()) {
+        //-- Refresh existing entry and move it to the front
+        EntryList_t::iterator entry = iter.value();
+        shard.bytes -= static_cast<quint64>(entry->img.size());
+        entry->img      = img;
+        entry->format   = format;
+        entry->type     = type;
+        shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+    } else {
+        shard.entries.push_front(Entry_t{ hash, img, format, type });
+        shard.index.insert(hash, shard.entries.begin());
+    }
+    shard.bytes += static_cast<quint64>(img.size());
+    shard.insertions++;
+    _evict(shard);
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileMemoryCache::find(const QString& hash, QByteArray& img, QString& format, QString& type)
+{
+    Shard_t& shard = _shard(hash);
+    QMutexLocker lock(&shard.mutex);
+    auto iter = shard.index.constFind(hash);
+    if(iter == shard.index.constEnd()) {
+        shard.misses++;
+        return false;
+    }
+    EntryList_t::iterator entry = iter.value();
+    shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+    img     = entry->img;
+    format  = entry->format;
+    type    = entry->type;
+    shard.hits++;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::clear()
+{
+    for(int i = 0; i < _shardCount; i++) {
+        QMutexLocker lock(&_shards[i].mutex);
+        _shards[i].entries.clear();
+        _shards[i].index.clear();
+        _shards[i].bytes = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCTileMemoryCache::Stats_t
+QGCTileMemoryCache::stats() const
+{
+    Stats_t stats;
+    for(int i = 0; i < _shardCount; i++) {
+        const Shard_t& shard = _shards[i];
+        QMutexLocker lock(&shard.mutex);
+        stats.hits          += shard.hits;
+        stats.misses        += shard.misses;
+        stats.insertions    += shard.insertions;
+        stats.evictions     += shard.evictions;
+        stats.bytes         += shard.bytes;
+        stats.count         += static_cast<quint32>(shard.index.count());
+    }
+    return stats;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::resetStats()
+{
+    for(int i = 0; i < _shardCount; i++) {
+        QMutexLocker lock(&_shards[i].mutex);
+        _shards[i].hits         = 0;
+        _shards[i].misses       = 0;
+        _shards[i].insertions   = 0;
+        _shards[i].evictions    = 0;
+    }
+}
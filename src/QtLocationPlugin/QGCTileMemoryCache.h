@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief In-memory tile cache in front of the tile cache worker
+ *
+ */
+
+#ifndef QGC_TILE_MEMORY_CACHE_H
+#define QGC_TILE_MEMORY_CACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+
+#include <list>
+
+//-----------------------------------------------------------------------------
+/// Byte budgeted LRU of tile blobs keyed by tile hash. Tiles found here never reach the SQLite worker thread.
+///
+/// The cache is split into shards by hash, each with its own lock and an even share of the byte budget, so lookups
+/// from the map, terrain and worker threads don't contend on a single lock. All methods are thread safe.
+class QGCTileMemoryCache
+{
+public:
+    QGCTileMemoryCache  ();
+
+    typedef struct {
+        quint64 hits        = 0;
+        quint64 misses      = 0;
+        quint64 insertions  = 0;
+        quint64 evictions   = 0;
+        quint64 bytes       = 0;
+        quint32 count       = 0;
+    } Stats_t;
+
+    void        setMaxBytes (quint64 maxBytes);
+    quint64     maxBytes    () const { return _maxBytes; }
+
+    /// Adds or refreshes a tile. Tiles bigger than a shard's share of the budget are not cached.
+    void        insert      (const QString& hash, const QByteArray& img, const QString& format, const QString& type);
+
+    /// Looks up a tile and marks it as most recently used
+    ///     @return true: tile found, img/format/type filled in
+    bool        find        (const QString& hash, QByteArray& img, QString& format, QString& type);
+
+    void        clear       ();
+    Stats_t     stats       () const;
+    void        resetStats  ();
+
+private:
+    typedef struct {
+        QString     hash;
+        QByteArray  img;
+        QString     format;
+        QString     type;
+    } Entry_t;
+
+    typedef std::list<Entry_t> EntryList_t;
+
+    typedef struct {
+        mutable QMutex                          mutex;
+        EntryList_t                             entries;    ///< Most recently used first
+        QHash<QString, EntryList_t::iterator>   index;
+        quint64                                 bytes       = 0;
+        quint64                                 maxBytes    = 0;    ///< Share of the total budget
+        quint64                                 hits        = 0;
+        quint64                                 misses      = 0;
+        quint64                                 insertions  = 0;
+        quint64                                 evictions   = 0;
+    } Shard_t;
+
+    Shard_t&    _shard      (const QString& hash);
+    void        _evict      (Shard_t& shard);
+
+    static const int _shardCount = 8;
+
+    Shard_t     _shards[_shardCount];
+    quint64     _maxBytes;
+
+    friend class QGCTileMemoryCacheTest;
+};
+
+#endif // QGC_TILE_MEMORY_CACHE_H
@@ -10,6 +10,7 @@
 #include "TerrainQuery.h"
 #include "QGCMapEngine.h"
 #include "QGeoMapReplyQGC.h"
+#include "ElevationMapProvider.h"
 #include "QGCApplication.h"
 
 #include <QUrl>
@@ -304,6 +305,16 @@ void TerrainOfflineAirMapQuery::requestPathHeights(const QGeoCoordinate& fromCoo
     _terrainTileManager->addPathQuery(this, fromCoord, toCoord);
 }
 
+void TerrainOfflineAirMapQuery::requestPolyPathHeights(const QList<QGeoCoordinate>& polyPath)
+{
+    if (qgcApp()->runningUnitTests()) {
+        emit polyPathHeightsReceived(false, QList<PathHeightInfo_t>());
+        return;
+    }
+
+    _terrainTileManager->addPolyPathQuery(this, polyPath);
+}
+
 void TerrainOfflineAirMapQuery::requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly)
 {
     if (qgcApp()->runningUnitTests()) {
@@ -333,9 +344,14 @@ void TerrainOfflineAirMapQuery::_signalCarpetHeights(bool success, double minHei
     emit carpetHeightsReceived(success, minHeight, maxHeight, carpet);
 }
 
-TerrainTileManager::TerrainTileManager(void)
+void TerrainOfflineAirMapQuery::_signalPolyPathHeights(bool success, const QList<PathHeightInfo_t>& rgPathHeightInfo)
 {
+    emit polyPathHeightsReceived(success, rgPathHeightInfo);
+}
 
+TerrainTileManager::TerrainTileManager(void)
+{
+    _requestClock.start();
 }
 
 void TerrainTileManager::addCoordinateQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& coordinates)
@@ -343,73 +359,38 @@ void TerrainTileManager::addCoordinateQuery(TerrainOfflineAirMapQuery* terrainQu
     qCDebug(TerrainQueryLog) << "TerrainTileManager::addCoordinateQuery count" << coordinates.count();
 
     if (coordinates.length() > 0) {
-        bool error;
-        QList<double> altitudes;
-
-        if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
-            qCDebug(TerrainQueryLog) << "TerrainTileManager::addPathQuery queue count" << _requestQueue.count();
-            QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModeCoordinates, 0, 0, coordinates };
+        QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModeCoordinates, coordinates, QSet<quint64>(), _requestClock.elapsed() };
+        if (!_resolveRequest(queuedRequestInfo)) {
+            qCDebug(TerrainQueryLog) << "TerrainTileManager::addCoordinateQuery queue count" << _requestQueue.count();
             _requestQueue.append(queuedRequestInfo);
-            return;
-        }
-
-        if (error) {
-            QList<double> noAltitudes;
-            qCWarning(TerrainQueryLog) << "addCoordinateQuery: signalling failure due to internal error";
-            terrainQueryInterface->_signalCoordinateHeights(false, noAltitudes);
-        } else {
-            qCDebug(TerrainQueryLog) << "addCoordinateQuery: All altitudes taken from cached data";
-            terrainQueryInterface->_signalCoordinateHeights(coordinates.count() == altitudes.count(), altitudes);
         }
     }
 }
 
 void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate &startPoint, const QGeoCoordinate &endPoint)
 {
-    // Convert to individual coordinate queries
-    QList<QGeoCoordinate> coordinates;
-    double lat = startPoint.latitude();
-    double lon = startPoint.longitude();
-    double steps = ceil(endPoint.distanceTo(startPoint) / TerrainTile::terrainAltitudeSpacing);
-    double latDiff = endPoint.latitude() - lat;
-    double lonDiff = endPoint.longitude() - lon;
-
-    double distanceBetween;
-    double finalDistanceBetween;
-    if (steps == 0) {
-        coordinates.append(startPoint);
-        coordinates.append(endPoint);
-        distanceBetween = finalDistanceBetween = coordinates[0].distanceTo(coordinates[1]);
-    } else {
-        for (double i = 0.0; i <= steps; i = i + 1) {
-            coordinates.append(QGeoCoordinate(lat + latDiff * i / steps, lon + lonDiff * i / steps));
-        }
-        // We always have one too many and we always want the last one to be the endpoint
-        coordinates.last() = endPoint;
-        distanceBetween = coordinates[0].distanceTo(coordinates[1]);
-        finalDistanceBetween = coordinates[coordinates.count() - 2].distanceTo(coordinates.last());
-    }
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::addPathQuery start:end" << startPoint << endPoint;
 
-    //qDebug() << "terrain" << startPoint.distanceTo(endPoint) << coordinates.count() << distanceBetween;
-
-    qCDebug(TerrainQueryLog) << "TerrainTileManager::addPathQuery start:end:coordCount" << startPoint << endPoint << coordinates.count();
-
-    bool error;
-    QList<double> altitudes;
-    if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
+    QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModePath, { startPoint, endPoint }, QSet<quint64>(), _requestClock.elapsed() };
+    if (!_resolveRequest(queuedRequestInfo)) {
         qCDebug(TerrainQueryLog) << "TerrainTileManager::addPathQuery queue count" << _requestQueue.count();
-        QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModePath, distanceBetween, finalDistanceBetween, coordinates };
         _requestQueue.append(queuedRequestInfo);
+    }
+}
+
+void TerrainTileManager::addPolyPathQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& polyPath)
+{
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::addPolyPathQuery count" << polyPath.count();
+
+    if (polyPath.count() < 2) {
+        terrainQueryInterface->_signalPolyPathHeights(false, QList<PathHeightInfo_t>());
         return;
     }
 
-    if (error) {
-        QList<double> noAltitudes;
-        qCWarning(TerrainQueryLog) << "addPathQuery: signalling failure due to internal error";
-        terrainQueryInterface->_signalPathHeights(false, distanceBetween, finalDistanceBetween, noAltitudes);
-    } else {
-        qCDebug(TerrainQueryLog) << "addPathQuery: All altitudes taken from cached data";
-        terrainQueryInterface->_signalPathHeights(coordinates.count() == altitudes.count(), distanceBetween, finalDistanceBetween, altitudes);
+    QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModePolyPath, polyPath, QSet<quint64>(), _requestClock.elapsed() };
+    if (!_resolveRequest(queuedRequestInfo)) {
+        qCDebug(TerrainQueryLog) << "TerrainTileManager::addPolyPathQuery queue count" << _requestQueue.count();
+        _requestQueue.append(queuedRequestInfo);
     }
 }
 
@@ -418,151 +399,333 @@ void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInt
 /// @return true: altitude returned (check error as well), false: database query queued (altitudes not returned)
 bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error)
 {
+    QSet<quint64>   missingTiles;
+    QMutexLocker    lock(&_tilesMutex);
+
+    return _getAltitudes(coordinates, altitudes, error, missingTiles);
+}
+
+/// Looks up the altitudes for the request and signals the results. Signals are sent with _tilesMutex unlocked since the
+/// receiver may queue a new request right away.
+/// @return true: request signalled, false: tiles are missing, download queued and requestInfo.missingTiles filled in
+bool TerrainTileManager::_resolveRequest(QueuedRequestInfo_t& requestInfo)
+{
+    bool                        error = false;
+    QList<double>               altitudes;
+    QList<PathHeightInfo_t>     rgPathHeightInfo;
+
+    _tilesMutex.lock();
+    bool resolved;
+    if (requestInfo.queryMode == QueryMode::QueryModeCoordinates) {
+        resolved = _getAltitudes(requestInfo.coordinates, altitudes, error, requestInfo.missingTiles);
+    } else {
+        resolved = _getPolyPathHeights(requestInfo.coordinates, rgPathHeightInfo, error, requestInfo.missingTiles);
+    }
+    _tilesMutex.unlock();
+
+    if (!resolved) {
+        return false;
+    }
+
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::_resolveRequest: resolved" << requestInfo.coordinates.count() << "coordinates in" << _requestClock.elapsed() - requestInfo.queuedMSecs << "msecs";
+
+    if (error) {
+        qCWarning(TerrainQueryLog) << "TerrainTileManager::_resolveRequest: signalling failure due to internal error";
+        _signalRequestFailed(requestInfo);
+        return true;
+    }
+
+    switch (requestInfo.queryMode) {
+    case QueryMode::QueryModeCoordinates:
+        requestInfo.terrainQueryInterface->_signalCoordinateHeights(requestInfo.coordinates.count() == altitudes.count(), altitudes);
+        break;
+    case QueryMode::QueryModePath:
+    {
+        const PathHeightInfo_t& pathHeightInfo = rgPathHeightInfo.first();
+        requestInfo.terrainQueryInterface->_signalPathHeights(true, pathHeightInfo.distanceBetween, pathHeightInfo.finalDistanceBetween, pathHeightInfo.heights);
+        break;
+    }
+    case QueryMode::QueryModePolyPath:
+        requestInfo.terrainQueryInterface->_signalPolyPathHeights(true, rgPathHeightInfo);
+        break;
+    case QueryMode::QueryModeCarpet:
+        break;
+    }
+
+    return true;
+}
+
+void TerrainTileManager::_signalRequestFailed(const QueuedRequestInfo_t& requestInfo)
+{
+    switch (requestInfo.queryMode) {
+    case QueryMode::QueryModeCoordinates:
+        requestInfo.terrainQueryInterface->_signalCoordinateHeights(false, QList<double>());
+        break;
+    case QueryMode::QueryModePath:
+        requestInfo.terrainQueryInterface->_signalPathHeights(false, qQNaN(), qQNaN(), QList<double>());
+        break;
+    case QueryMode::QueryModePolyPath:
+        requestInfo.terrainQueryInterface->_signalPolyPathHeights(false, QList<PathHeightInfo_t>());
+        break;
+    case QueryMode::QueryModeCarpet:
+        break;
+    }
+}
+
+/// Must be called with _tilesMutex locked
+/// @return true: altitudes returned (check error as well), false: tiles missing, downloads queued for them
+bool TerrainTileManager::_getAltitudes(const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error, QSet<quint64>& missingTiles)
+{
+    const TerrainTile*  tile    = nullptr;
+    quint64             tileKey = 0;
+
     error = false;
+    altitudes.clear();
+    missingTiles.clear();
 
     for (const QGeoCoordinate& coordinate: coordinates) {
-        QString tileHash = _getTileHash(coordinate);
-        qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates hash:coordinate" << tileHash << coordinate;
-
-        _tilesMutex.lock();
-        if (_tiles.contains(tileHash)) {
-            if (_tiles[tileHash].isIn(coordinate)) {
-                double elevation = _tiles[tileHash].elevation(coordinate);
-                if (qIsNaN(elevation)) {
-                    error = true;
-                    qCWarning(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates Internal Error: missing elevation in tile cache";
-                } else {
-                    qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates returning elevation from tile cache" << elevation;
+        int     x   = AirmapElevationProvider::tileX(coordinate.longitude());
+        int     y   = AirmapElevationProvider::tileY(coordinate.latitude());
+        quint64 key = _tileKey(x, y);
+
+        // Neighbouring coordinates are usually in the same tile
+        if (!tile || key != tileKey) {
+            auto iter = _tiles.constFind(key);
+            tile    = iter == _tiles.constEnd() ? nullptr : &iter.value();
+            tileKey = key;
+        }
+
+        if (!tile) {
+            // Keep going so that all of the missing tiles are requested together
+            if (!_pendingTiles.contains(key)) {
+                _queueTileDownload(key, x, y);
+            }
+            missingTiles.insert(key);
+            continue;
+        }
+        if (!missingTiles.isEmpty()) {
+            continue;
+        }
+
+        double elevation = tile->elevation(coordinate);
+        if (qIsNaN(elevation)) {
+            error = true;
+            qCWarning(TerrainQueryLog) << "TerrainTileManager::_getAltitudes Internal Error: coordinate not in tile region" << coordinate;
+        }
+        altitudes.push_back(elevation);
+    }
+
+    if (!missingTiles.isEmpty()) {
+        altitudes.clear();
+        _startTileDownloads();
+        return false;
+    }
+
+    return true;
+}
+
+/// Samples the heights along each leg of the path every TerrainTile::terrainAltitudeSpacing. Each run of consecutive
+/// samples which fall in the same tile is looked up once and sampled as a batch. Must be called with _tilesMutex locked.
+/// @return true: heights returned (check error as well), false: tiles missing, downloads queued for them
+bool TerrainTileManager::_getPolyPathHeights(const QList<QGeoCoordinate>& polyPath, QList<PathHeightInfo_t>& rgPathHeightInfo, bool& error, QSet<quint64>& missingTiles)
+{
+    error = false;
+    rgPathHeightInfo.clear();
+    missingTiles.clear();
+
+    for (int i = 0; i < polyPath.count() - 1; i++) {
+        const QGeoCoordinate& startPoint    = polyPath[i];
+        const QGeoCoordinate& endPoint      = polyPath[i + 1];
+
+        double  lat     = startPoint.latitude();
+        double  lon     = startPoint.longitude();
+        double  latDiff = endPoint.latitude() - lat;
+        double  lonDiff = endPoint.longitude() - lon;
+        double  steps   = ceil(endPoint.distanceTo(startPoint) / TerrainTile::terrainAltitudeSpacing);
+        int     count   = steps == 0 ? 2 : static_cast<int>(steps) + 1;
+
+        _pathLatitudes.resize(count);
+        _pathLongitudes.resize(count);
+        _pathHeights.resize(count);
+        double* latitudes   = _pathLatitudes.data();
+        double* longitudes  = _pathLongitudes.data();
+        double* heights     = _pathHeights.data();
+
+        for (int j = 0; j < count - 1; j++) {
+            latitudes[j]    = steps == 0 ? lat : lat + latDiff * j / steps;
+            longitudes[j]   = steps == 0 ? lon : lon + lonDiff * j / steps;
+        }
+        // We always want the last one to be the endpoint
+        latitudes[count - 1]    = endPoint.latitude();
+        longitudes[count - 1]   = endPoint.longitude();
+
+        int runStart = 0;
+        while (runStart < count) {
+            int x       = AirmapElevationProvider::tileX(longitudes[runStart]);
+            int y       = AirmapElevationProvider::tileY(latitudes[runStart]);
+            int runEnd  = runStart + 1;
+            while (runEnd < count && AirmapElevationProvider::tileX(longitudes[runEnd]) == x && AirmapElevationProvider::tileY(latitudes[runEnd]) == y) {
+                runEnd++;
+            }
+
+            quint64 key     = _tileKey(x, y);
+            auto    iter    = _tiles.constFind(key);
+            if (iter == _tiles.constEnd()) {
+                // Keep going so that all of the missing tiles are requested together
+                if (!_pendingTiles.contains(key)) {
+                    _queueTileDownload(key, x, y);
                 }
-                altitudes.push_back(elevation);
-            } else {
-                qCWarning(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates Internal Error: coordinate not in tile region";
-                altitudes.push_back(qQNaN());
-                error = true;
+                missingTiles.insert(key);
+            } else if (missingTiles.isEmpty()) {
+                iter.value().elevations(latitudes + runStart, longitudes + runStart, heights + runStart, runEnd - runStart);
             }
+            runStart = runEnd;
+        }
+        if (!missingTiles.isEmpty()) {
+            continue;
+        }
+
+        PathHeightInfo_t pathHeightInfo;
+        if (steps == 0) {
+            pathHeightInfo.distanceBetween = pathHeightInfo.finalDistanceBetween = startPoint.distanceTo(endPoint);
         } else {
-            if (_state != State::Downloading) {
-                QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL("Airmap Elevation", getQGCMapEngine()->urlFactory()->long2tileX("Airmap Elevation",coordinate.longitude(), 1), getQGCMapEngine()->urlFactory()->lat2tileY("Airmap Elevation", coordinate.latitude(), 1), 1, &_networkManager);
-                qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates query from database" << request.url();
-                QGeoTileSpec spec;
-                spec.setX(getQGCMapEngine()->urlFactory()->long2tileX("Airmap Elevation", coordinate.longitude(), 1));
-                spec.setY(getQGCMapEngine()->urlFactory()->lat2tileY("Airmap Elevation", coordinate.latitude(), 1));
-                spec.setZoom(1);
-                spec.setMapId(getQGCMapEngine()->urlFactory()->getIdFromType("Airmap Elevation"));
-                QGeoTiledMapReplyQGC* reply = new QGeoTiledMapReplyQGC(&_networkManager, request, spec);
-                connect(reply, &QGeoTiledMapReplyQGC::terrainDone, this, &TerrainTileManager::_terrainDone);
-                _state = State::Downloading;
+            pathHeightInfo.distanceBetween      = QGeoCoordinate(latitudes[0], longitudes[0]).distanceTo(QGeoCoordinate(latitudes[1], longitudes[1]));
+            pathHeightInfo.finalDistanceBetween = QGeoCoordinate(latitudes[count - 2], longitudes[count - 2]).distanceTo(endPoint);
+        }
+        pathHeightInfo.heights.reserve(count);
+        for (int j = 0; j < count; j++) {
+            if (qIsNaN(heights[j])) {
+                error = true;
             }
-            _tilesMutex.unlock();
-
-            return false;
+            pathHeightInfo.heights.append(heights[j]);
         }
-        _tilesMutex.unlock();
+        rgPathHeightInfo.append(pathHeightInfo);
+    }
+
+    if (!missingTiles.isEmpty()) {
+        rgPathHeightInfo.clear();
+        _startTileDownloads();
+        return false;
+    }
+
+    if (error) {
+        qCWarning(TerrainQueryLog) << "TerrainTileManager::_getPolyPathHeights Internal Error: path coordinate not in tile region";
     }
 
     return true;
 }
 
-void TerrainTileManager::_tileFailed(void)
+/// Must be called with _tilesMutex locked
+void TerrainTileManager::_queueTileDownload(quint64 key, int x, int y)
 {
-    QList<double>    noAltitudes;
+    TileDownload_t tileDownload = { key, x, y };
 
-    for (const QueuedRequestInfo_t& requestInfo: _requestQueue) {
-        if (requestInfo.queryMode == QueryMode::QueryModeCoordinates) {
-            requestInfo.terrainQueryInterface->_signalCoordinateHeights(false, noAltitudes);
-        } else if (requestInfo.queryMode == QueryMode::QueryModePath) {
-            requestInfo.terrainQueryInterface->_signalPathHeights(false, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, noAltitudes);
+    _pendingTiles.insert(key);
+    _tileDownloadQueue.append(tileDownload);
+}
+
+/// Starts queued tile downloads up to the concurrency limit. Must be called with _tilesMutex locked.
+void TerrainTileManager::_startTileDownloads(void)
+{
+    while (_activeDownloads < _maxConcurrentDownloads && !_tileDownloadQueue.isEmpty()) {
+        TileDownload_t tileDownload = _tileDownloadQueue.takeFirst();
+
+        QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL("Airmap Elevation", tileDownload.x, tileDownload.y, 1, &_networkManager);
+        qCDebug(TerrainQueryLog) << "TerrainTileManager::_startTileDownloads query from database" << request.url() << "active" << _activeDownloads << "queued" << _tileDownloadQueue.count();
+        QGeoTileSpec spec;
+        spec.setX(tileDownload.x);
+        spec.setY(tileDownload.y);
+        spec.setZoom(1);
+        spec.setMapId(getQGCMapEngine()->urlFactory()->getIdFromType("Airmap Elevation"));
+        QGeoTiledMapReplyQGC* reply = new QGeoTiledMapReplyQGC(&_networkManager, request, spec);
+        connect(reply, &QGeoTiledMapReplyQGC::terrainDone, this, &TerrainTileManager::_terrainDone);
+        _activeDownloads++;
+    }
+}
+
+/// Fails all queued requests which need the specified tile
+void TerrainTileManager::_tileFailed(quint64 key)
+{
+    for (int i = _requestQueue.count() - 1; i >= 0; i--) {
+        if (_requestQueue[i].missingTiles.contains(key)) {
+            QueuedRequestInfo_t requestInfo = _requestQueue.takeAt(i);
+            _signalRequestFailed(requestInfo);
         }
     }
-    _requestQueue.clear();
 }
 
 void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::NetworkError error)
 {
     QGeoTiledMapReplyQGC* reply = qobject_cast<QGeoTiledMapReplyQGC*>(QObject::sender());
-    _state = State::Idle;
 
     if (!reply) {
         qCWarning(TerrainQueryLog) << "Elevation tile fetched but invalid reply data type.";
         return;
     }
 
-    // remove from download queue
     QGeoTileSpec spec = reply->tileSpec();
-    QString hash = QGCMapEngine::getTileHash("Airmap Elevation", spec.x(), spec.y(), spec.zoom());
+    reply->deleteLater();
+
+    _tileDownloadDone(_tileKey(spec.x(), spec.y()), responseBytes, error);
+}
 
-    // handle potential errors
+/// Adds the downloaded tile, then resolves or fails every queued request waiting on it and starts the next download
+void TerrainTileManager::_tileDownloadDone(quint64 key, const QByteArray& responseBytes, QNetworkReply::NetworkError error)
+{
+    bool tileAdded = false;
     if (error != QNetworkReply::NoError) {
         qCWarning(TerrainQueryLog) << "Elevation tile fetching returned error (" << error << ")";
-        _tileFailed();
-        reply->deleteLater();
-        return;
-    }
-    if (responseBytes.isEmpty()) {
+    } else if (responseBytes.isEmpty()) {
         qCWarning(TerrainQueryLog) << "Error in fetching elevation tile. Empty response.";
-        _tileFailed();
-        reply->deleteLater();
-        return;
-    }
-
-    qCDebug(TerrainQueryLog) << "Received some bytes of terrain data: " << responseBytes.size();
+    } else {
+        qCDebug(TerrainQueryLog) << "Received some bytes of terrain data: " << responseBytes.size();
 
-    TerrainTile* terrainTile = new TerrainTile(responseBytes);
-    if (terrainTile->isValid()) {
-        _tilesMutex.lock();
-        if (!_tiles.contains(hash)) {
-            _tiles.insert(hash, *terrainTile);
+        TerrainTile terrainTile(responseBytes);
+        if (terrainTile.isValid()) {
+            _tilesMutex.lock();
+            if (!_tiles.contains(key)) {
+                _tiles.insert(key, terrainTile);
+            }
+            _tilesMutex.unlock();
+            tileAdded = true;
         } else {
-            delete terrainTile;
+            qCWarning(TerrainQueryLog) << "Received invalid tile";
         }
-        _tilesMutex.unlock();
-    } else {
-        delete terrainTile;
-        qCWarning(TerrainQueryLog) << "Received invalid tile";
     }
-    reply->deleteLater();
 
-    // now try to query the data again
-    for (int i = _requestQueue.count() - 1; i >= 0; i--) {
-        bool error;
-        QList<double> altitudes;
-        QueuedRequestInfo_t& requestInfo = _requestQueue[i];
-
-        if (getAltitudesForCoordinates(requestInfo.coordinates, altitudes, error)) {
-            if (requestInfo.queryMode == QueryMode::QueryModeCoordinates) {
-                if (error) {
-                    QList<double> noAltitudes;
-                    qCWarning(TerrainQueryLog) << "_terrainDone(coordinateQuery): signalling failure due to internal error";
-                    requestInfo.terrainQueryInterface->_signalCoordinateHeights(false, noAltitudes);
-                } else {
-                    qCDebug(TerrainQueryLog) << "_terrainDone(coordinateQuery): All altitudes taken from cached data";
-                    requestInfo.terrainQueryInterface->_signalCoordinateHeights(requestInfo.coordinates.count() == altitudes.count(), altitudes);
-                }
-            } else if (requestInfo.queryMode == QueryMode::QueryModePath) {
-                if (error) {
-                    QList<double> noAltitudes;
-                    qCWarning(TerrainQueryLog) << "_terrainDone(coordinateQuery): signalling failure due to internal error";
-                    requestInfo.terrainQueryInterface->_signalPathHeights(false, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, noAltitudes);
-                } else {
-                    qCDebug(TerrainQueryLog) << "_terrainDone(coordinateQuery): All altitudes taken from cached data";
-                    requestInfo.terrainQueryInterface->_signalPathHeights(requestInfo.coordinates.count() == altitudes.count(), requestInfo.distanceBetween, requestInfo.finalDistanceBetween, altitudes);
-                }
-            }
-            _requestQueue.removeAt(i);
-        }
+    _tilesMutex.lock();
+    _activeDownloads--;
+    _pendingTiles.remove(key);
+    _tilesMutex.unlock();
+
+    if (tileAdded) {
+        // now try to query the data again
+        _processQueuedRequests(key);
+    } else {
+        _tileFailed(key);
     }
+
+    _tilesMutex.lock();
+    _startTileDownloads();
+    _tilesMutex.unlock();
 }
 
-QString TerrainTileManager::_getTileHash(const QGeoCoordinate& coordinate)
+/// Signals all queued requests which were only waiting on the specified tile
+void TerrainTileManager::_processQueuedRequests(quint64 key)
 {
-    QString ret = QGCMapEngine::getTileHash(
-        "Airmap Elevation",
-        getQGCMapEngine()->urlFactory()->long2tileX("Airmap Elevation", coordinate.longitude(), 1),
-        getQGCMapEngine()->urlFactory()->lat2tileY("Airmap Elevation", coordinate.latitude(), 1),
-        1);
-    qCDebug(TerrainQueryVerboseLog) << "Computing unique tile hash for " << coordinate << ret;
+    for (int i = _requestQueue.count() - 1; i >= 0; i--) {
+        QSet<quint64>& missingTiles = _requestQueue[i].missingTiles;
 
-    return ret;
+        if (!missingTiles.remove(key) || !missingTiles.isEmpty()) {
+            continue;
+        }
+
+        // Take the request off the queue first, signalling it may queue new requests
+        QueuedRequestInfo_t requestInfo = _requestQueue.takeAt(i);
+        if (!_resolveRequest(requestInfo)) {
+            _requestQueue.append(requestInfo);
+        }
+    }
 }
 
 TerrainAtCoordinateBatchManager::TerrainAtCoordinateBatchManager(void)
@@ -753,9 +916,8 @@ void TerrainPathQuery::_pathHeights(bool success, double distanceBetween, double
 
 TerrainPolyPathQuery::TerrainPolyPathQuery(bool autoDelete)
     : _autoDelete   (autoDelete)
-    , _pathQuery    (false /* autoDelete */)
 {
-    connect(&_pathQuery, &TerrainPathQuery::terrainDataReceived, this, &TerrainPolyPathQuery::_terrainDataReceived);
+    connect(&_terrainQuery, &TerrainOfflineAirMapQuery::polyPathHeightsReceived, this, &TerrainPolyPathQuery::_polyPathHeights);
 }
 
 void TerrainPolyPathQuery::requestData(const QVariantList& polyPath)
@@ -773,32 +935,16 @@ void TerrainPolyPathQuery::requestData(const QList<QGeoCoordinate>& polyPath)
 {
     qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::requestData count" << polyPath.count();
 
-    // Kick off first request
-    _rgCoords = polyPath;
-    _curIndex = 0;
-    _pathQuery.requestData(_rgCoords[0], _rgCoords[1]);
+    // All legs are resolved by a single query
+    _terrainQuery.requestPolyPathHeights(polyPath);
 }
 
-void TerrainPolyPathQuery::_terrainDataReceived(bool success, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo)
+void TerrainPolyPathQuery::_polyPathHeights(bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo)
 {
-    qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_terrainDataReceived success:_curIndex" << success << _curIndex;
+    qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_polyPathHeights success:count" << success << rgPathHeightInfo.count();
 
-    if (!success) {
-        _rgPathHeightInfo.clear();
-        emit terrainDataReceived(false /* success */, _rgPathHeightInfo);
-        return;
-    }
-
-    _rgPathHeightInfo.append(pathHeightInfo);
-
-    if (++_curIndex >= _rgCoords.count() - 1) {
-        // We've finished all requests
-        qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_terrainDataReceived complete";
-        emit terrainDataReceived(true /* success */, _rgPathHeightInfo);
-        if (_autoDelete) {
-            deleteLater();
-        }
-    } else {
-        _pathQuery.requestData(_rgCoords[_curIndex], _rgCoords[_curIndex+1]);
+    emit terrainDataReceived(success, rgPathHeightInfo);
+    if (_autoDelete) {
+        deleteLater();
     }
 }
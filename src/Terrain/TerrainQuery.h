@@ -18,6 +18,8 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QSet>
 #include <QtLocation/private/qgeotiledmapreply_p.h>
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainQueryLog)
@@ -49,6 +51,12 @@ public:
     ///     @param statsOnly true: Return only stats, no carpet data
     virtual void requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) = 0;
 
+    typedef struct {
+        double          distanceBetween;        ///< Distance between each height value
+        double          finalDistanceBetween;   ///< Distance between final two height values
+        QList<double>   heights;                ///< Terrain heights along path
+    } PathHeightInfo_t;
+
 signals:
     void coordinateHeightsReceived(bool success, QList<double> heights);
     void pathHeightsReceived(bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights);
@@ -102,13 +110,27 @@ public:
     void requestPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord) final;
     void requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) final;
 
+    /// Requests terrain heights along each leg of the poly path in a single query.
+    /// Signals: polyPathHeightsReceived
+    void requestPolyPathHeights(const QList<QGeoCoordinate>& polyPath);
+
     // Internal methods
     void _signalCoordinateHeights(bool success, QList<double> heights);
     void _signalPathHeights(bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights);
     void _signalCarpetHeights(bool success, double minHeight, double maxHeight, const QList<QList<double>>& carpet);
+    void _signalPolyPathHeights(bool success, const QList<PathHeightInfo_t>& rgPathHeightInfo);
+
+signals:
+    void polyPathHeightsReceived(bool success, const QList<TerrainQueryInterface::PathHeightInfo_t>& rgPathHeightInfo);
 };
 
 /// Used internally by TerrainOfflineAirMapQuery to manage terrain tiles
+///
+/// Missing tiles are fetched concurrently through the map engine, which serves them from its tile cache database when
+/// they were fetched before. Each tile is only ever requested once no matter how many queued requests need it.
+///
+/// Tiles are keyed by their integer x/y tile position. Path queries walk the tiles along the path in one pass under a
+/// single lock, sampling each run of consecutive heights which fall in the same tile as a batch.
 class TerrainTileManager : public QObject {
     Q_OBJECT
 
@@ -117,40 +139,66 @@ public:
 
     void addCoordinateQuery         (TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& coordinates);
     void addPathQuery               (TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate& startPoint, const QGeoCoordinate& endPoint);
+    void addPolyPathQuery           (TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& polyPath);
     bool getAltitudesForCoordinates (const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error);
 
 private slots:
     void _terrainDone       (QByteArray responseBytes, QNetworkReply::NetworkError error);
 
 private:
-    enum class State {
-        Idle,
-        Downloading,
-    };
+    typedef TerrainQueryInterface::PathHeightInfo_t PathHeightInfo_t;
 
     enum QueryMode {
         QueryModeCoordinates,
         QueryModePath,
+        QueryModePolyPath,
         QueryModeCarpet
     };
 
     typedef struct {
         TerrainOfflineAirMapQuery*  terrainQueryInterface;
         QueryMode                   queryMode;
-        double                      distanceBetween;        // Distance between each returned height
-        double                      finalDistanceBetween;   // Distance between for final height
-        QList<QGeoCoordinate>       coordinates;
+        QList<QGeoCoordinate>       coordinates;            // Coordinates to query, or the path vertices for path queries
+        QSet<quint64>               missingTiles;           // Tiles which must arrive before the request can be resolved
+        qint64                      queuedMSecs;            // Used to log how long the request took to resolve
     } QueuedRequestInfo_t;
 
-    void    _tileFailed                         (void);
-    QString _getTileHash                        (const QGeoCoordinate& coordinate);
+    typedef struct {
+        quint64 key;
+        int     x;
+        int     y;
+    } TileDownload_t;
+
+    bool    _getAltitudes                       (const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error, QSet<quint64>& missingTiles);
+    bool    _getPolyPathHeights                 (const QList<QGeoCoordinate>& polyPath, QList<PathHeightInfo_t>& rgPathHeightInfo, bool& error, QSet<quint64>& missingTiles);
+    bool    _resolveRequest                     (QueuedRequestInfo_t& requestInfo);
+    void    _signalRequestFailed                (const QueuedRequestInfo_t& requestInfo);
+    void    _tileFailed                         (quint64 key);
+    void    _queueTileDownload                  (quint64 key, int x, int y);
+    void    _startTileDownloads                 (void);
+    void    _processQueuedRequests              (quint64 key);
+    void    _tileDownloadDone                   (quint64 key, const QByteArray& responseBytes, QNetworkReply::NetworkError error);
+
+    static quint64  _tileKey(int x, int y) { return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y); }
 
     QList<QueuedRequestInfo_t>  _requestQueue;
-    State                       _state = State::Idle;
     QNetworkAccessManager       _networkManager;
+    QElapsedTimer               _requestClock;
 
     QMutex                      _tilesMutex;
-    QHash<QString, TerrainTile> _tiles;
+    QHash<quint64, TerrainTile> _tiles;
+    QSet<quint64>               _pendingTiles;              ///< Tiles waiting for download or being downloaded
+    QList<TileDownload_t>       _tileDownloadQueue;
+    int                         _activeDownloads = 0;
+
+    // Scratch buffers for path queries, only used with _tilesMutex locked
+    QVector<double>             _pathLatitudes;
+    QVector<double>             _pathLongitudes;
+    QVector<double>             _pathHeights;
+
+    static const int _maxConcurrentDownloads = 6;
+
+    friend class TerrainTileManagerTest;
 };
 
 /// Used internally by TerrainAtCoordinateQuery to batch coordinate requests together
@@ -246,11 +294,7 @@ public:
     ///     @param coordinates to query
     void requestData(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord);
 
-    typedef struct {
-        double          distanceBetween;        ///< Distance between each height value
-        double          finalDistanceBetween;   ///< Distance between final two height values
-        QList<double>   heights;                ///< Terrain heights along path
-    } PathHeightInfo_t;
+    typedef TerrainQueryInterface::PathHeightInfo_t PathHeightInfo_t;
 
 signals:
     /// Signalled when terrain data comes back from server
@@ -285,12 +329,9 @@ signals:
     void terrainDataReceived(bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo);
 
 private slots:
-    void _terrainDataReceived(bool success, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
+    void _polyPathHeights(bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo);
 
 private:
-    bool                                        _autoDelete;
-    int                                         _curIndex = 0;
-    QList<QGeoCoordinate>                       _rgCoords;
-    QList<TerrainPathQuery::PathHeightInfo_t>   _rgPathHeightInfo;
-    TerrainPathQuery                            _pathQuery;
+    bool                        _autoDelete;
+    TerrainOfflineAirMapQuery   _terrainQuery;
 };
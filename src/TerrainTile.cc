@@ -16,6 +16,11 @@
 #include <QJsonArray>
 #include <QDataStream>
 
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
 QGC_LOGGING_CATEGORY(TerrainTileLog, "TerrainTileLog");
 
 const char*  TerrainTile::_jsonStatusKey        = "status";
@@ -33,33 +38,33 @@ TerrainTile::TerrainTile()
     : _minElevation(-1.0)
     , _maxElevation(-1.0)
     , _avgElevation(-1.0)
-    , _data(nullptr)
     , _gridSizeLat(-1)
     , _gridSizeLon(-1)
     , _isValid(false)
+    , _swLat(0)
+    , _swLon(0)
+    , _latToIndex(0)
+    , _lonToIndex(0)
 {
 
 }
 
 TerrainTile::~TerrainTile()
 {
-    if (_data) {
-        for (int i = 0; i < _gridSizeLat; i++) {
-            delete _data[i];
-        }
-        delete _data;
-        _data = nullptr;
-    }
+
 }
 
 TerrainTile::TerrainTile(QByteArray byteArray)
     : _minElevation(-1.0)
     , _maxElevation(-1.0)
     , _avgElevation(-1.0)
-    , _data(nullptr)
     , _gridSizeLat(-1)
     , _gridSizeLon(-1)
     , _isValid(false)
+    , _swLat(0)
+    , _swLon(0)
+    , _latToIndex(0)
+    , _lonToIndex(0)
 {
     int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
     int cTileBytesAvailable = byteArray.size();
@@ -83,24 +88,29 @@ TerrainTile::TerrainTile(QByteArray byteArray)
     qCDebug(TerrainTileLog) << "Loading terrain tile: " << _southWest << " - " << _northEast;
     qCDebug(TerrainTileLog) << "min:max:avg:sizeLat:sizeLon" << _minElevation << _maxElevation << _avgElevation << _gridSizeLat << _gridSizeLon;
 
+    if (_gridSizeLat < 1 || _gridSizeLon < 1) {
+        qWarning() << "Terrain tile binary data has empty grid";
+        return;
+    }
+
     int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * _gridSizeLat * _gridSizeLon;
     if (cTileBytesAvailable < cTileHeaderBytes + cTileDataBytes) {
         qWarning() << "Terrain tile binary data too small for tile data";
         return;
     }
 
-    _data = new int16_t*[_gridSizeLat];
-    for (int k = 0; k < _gridSizeLat; k++) {
-        _data[k] = new int16_t[_gridSizeLon];
-    }
+    _data.resize(_gridSizeLat * _gridSizeLon);
+    memcpy(_data.data(), &reinterpret_cast<const uint8_t*>(byteArray.constData())[cTileHeaderBytes], static_cast<size_t>(cTileDataBytes));
 
-    int valueIndex = 0;
-    const int16_t* pTileData = reinterpret_cast<const int16_t*>(&reinterpret_cast<const uint8_t*>(byteArray.constData())[cTileHeaderBytes]);
-    for (int i = 0; i < _gridSizeLat; i++) {
-        for (int j = 0; j < _gridSizeLon; j++) {
-            _data[i][j] = pTileData[valueIndex++];
-        }
-    }
+    // Sampling works directly from the bounds and a scale, degenerate tiles always sample the first row/column
+    double latSpan = _northEast.latitude() - _southWest.latitude();
+    double lonSpan = _northEast.longitude() - _southWest.longitude();
+    _swLat      = _southWest.latitude();
+    _swLon      = _southWest.longitude();
+    _latToIndex = latSpan > 0 ? (_gridSizeLat - 1) / latSpan : 0;
+    _lonToIndex = lonSpan > 0 ? (_gridSizeLon - 1) / lonSpan : 0;
+
+    _buildMipLevels();
 
     _isValid = true;
 
@@ -114,29 +124,185 @@ bool TerrainTile::isIn(const QGeoCoordinate& coordinate) const
         qCWarning(TerrainTileLog) << "isIn requested, but tile not valid";
         return false;
     }
-    bool ret = coordinate.latitude() >= _southWest.latitude() && coordinate.longitude() >= _southWest.longitude() &&
+    return coordinate.latitude() >= _southWest.latitude() && coordinate.longitude() >= _southWest.longitude() &&
             coordinate.latitude() <= _northEast.latitude() && coordinate.longitude() <= _northEast.longitude();
-    qCDebug(TerrainTileLog) << "Checking isIn: " << coordinate << " , in sw " << _southWest << " , ne " << _northEast << ": " << ret;
-    return ret;
 }
 
-double TerrainTile::elevation(const QGeoCoordinate& coordinate) const
+double TerrainTile::elevation(const QGeoCoordinate& coordinate, SampleMode mode) const
 {
-    if (_isValid) {
-        qCDebug(TerrainTileLog) << "elevation: " << coordinate << " , in sw " << _southWest << " , ne " << _northEast;
-        // Get the index at resolution of 1 arc second
-        int indexLat = _latToDataIndex(coordinate.latitude());
-        int indexLon = _lonToDataIndex(coordinate.longitude());
-        if (indexLat == -1 || indexLon == -1) {
-            qCWarning(TerrainTileLog) << "Internal error indexLat:indexLon == -1" << indexLat << indexLon;
-            return qQNaN();
-        }
-        qCDebug(TerrainTileLog) << "indexLat:indexLon" << indexLat << indexLon << "elevation" << _data[indexLat][indexLon];
-        return static_cast<double>(_data[indexLat][indexLon]);
-    } else {
+    if (!_isValid) {
         qCWarning(TerrainTileLog) << "Asking for elevation, but no valid data.";
         return qQNaN();
     }
+
+    double latitude     = coordinate.latitude();
+    double longitude    = coordinate.longitude();
+    double elevation;
+    elevations(&latitude, &longitude, &elevation, 1, mode);
+    return elevation;
+}
+
+void TerrainTile::elevations(const double* latitudes, const double* longitudes, double* elevations, int count, SampleMode mode) const
+{
+    if (!_isValid) {
+        for (int i = 0; i < count; i++) {
+            elevations[i] = qQNaN();
+        }
+        return;
+    }
+
+    const int16_t*  data        = _data.constData();
+    const int       sizeLon     = _gridSizeLon;
+    const double    maxLatIndex = _gridSizeLat - 1;
+    const double    maxLonIndex = _gridSizeLon - 1;
+    const double    neLat       = _northEast.latitude();
+    const double    neLon       = _northEast.longitude();
+    const double    nan         = qQNaN();
+
+    // No logging or function calls in here, these loops are run for every sample along a path. Samples outside the
+    // tile, including NaN coordinates which fail every comparison, are rejected before any index is calculated.
+    if (mode == SampleNearest) {
+        for (int i = 0; i < count; i++) {
+            double  lat     = latitudes[i];
+            double  lon     = longitudes[i];
+            if (!(lat >= _swLat && lat <= neLat && lon >= _swLon && lon <= neLon)) {
+                elevations[i] = nan;
+                continue;
+            }
+            double  fLat    = std::min(std::max((lat - _swLat) * _latToIndex, 0.0), maxLatIndex);
+            double  fLon    = std::min(std::max((lon - _swLon) * _lonToIndex, 0.0), maxLonIndex);
+            int     index   = static_cast<int>(fLat + 0.5) * sizeLon + static_cast<int>(fLon + 0.5);
+            elevations[i] = static_cast<double>(data[index]);
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            double  lat     = latitudes[i];
+            double  lon     = longitudes[i];
+            if (!(lat >= _swLat && lat <= neLat && lon >= _swLon && lon <= neLon)) {
+                elevations[i] = nan;
+                continue;
+            }
+            double  fLat    = std::min(std::max((lat - _swLat) * _latToIndex, 0.0), maxLatIndex);
+            double  fLon    = std::min(std::max((lon - _swLon) * _lonToIndex, 0.0), maxLonIndex);
+            int     lat0    = static_cast<int>(fLat);
+            int     lon0    = static_cast<int>(fLon);
+            int     lat1    = std::min(lat0 + 1, _gridSizeLat - 1);
+            int     lon1    = std::min(lon0 + 1, sizeLon - 1);
+            double  wLat    = fLat - lat0;
+            double  wLon    = fLon - lon0;
+            double  v00     = data[lat0 * sizeLon + lon0];
+            double  v01     = data[lat0 * sizeLon + lon1];
+            double  v10     = data[lat1 * sizeLon + lon0];
+            double  v11     = data[lat1 * sizeLon + lon1];
+            double  south   = v00 + (v01 - v00) * wLon;
+            double  north   = v10 + (v11 - v10) * wLon;
+            elevations[i] = south + (north - south) * wLat;
+        }
+    }
+}
+
+QVector<double> TerrainTile::elevations(const QList<QGeoCoordinate>& coordinates, SampleMode mode) const
+{
+    int             count = coordinates.count();
+    QVector<double> latitudes(count);
+    QVector<double> longitudes(count);
+    QVector<double> result(count);
+
+    for (int i = 0; i < count; i++) {
+        latitudes[i]    = coordinates[i].latitude();
+        longitudes[i]   = coordinates[i].longitude();
+    }
+    elevations(latitudes.constData(), longitudes.constData(), result.data(), count, mode);
+
+    return result;
+}
+
+void TerrainTile::_buildMipLevels(void)
+{
+    _mipLevels.clear();
+
+    int             sizeLat = _gridSizeLat;
+    int             sizeLon = _gridSizeLon;
+    const int16_t*  minData = _data.constData();
+    const int16_t*  maxData = _data.constData();
+
+    while (sizeLat > 1 || sizeLon > 1) {
+        MipLevel_t level;
+        level.sizeLat = (sizeLat + 1) / 2;
+        level.sizeLon = (sizeLon + 1) / 2;
+        level.minData.resize(level.sizeLat * level.sizeLon);
+        level.maxData.resize(level.sizeLat * level.sizeLon);
+
+        for (int i = 0; i < level.sizeLat; i++) {
+            for (int j = 0; j < level.sizeLon; j++) {
+                int16_t minValue = std::numeric_limits<int16_t>::max();
+                int16_t maxValue = std::numeric_limits<int16_t>::min();
+                for (int sourceLat = i * 2; sourceLat < std::min(i * 2 + 2, sizeLat); sourceLat++) {
+                    for (int sourceLon = j * 2; sourceLon < std::min(j * 2 + 2, sizeLon); sourceLon++) {
+                        minValue = std::min(minValue, minData[sourceLat * sizeLon + sourceLon]);
+                        maxValue = std::max(maxValue, maxData[sourceLat * sizeLon + sourceLon]);
+                    }
+                }
+                level.minData[i * level.sizeLon + j] = minValue;
+                level.maxData[i * level.sizeLon + j] = maxValue;
+            }
+        }
+
+        _mipLevels.append(level);
+        sizeLat = level.sizeLat;
+        sizeLon = level.sizeLon;
+        minData = _mipLevels.last().minData.constData();
+        maxData = _mipLevels.last().maxData.constData();
+    }
+}
+
+bool TerrainTile::elevationRange(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, double& minElevation, double& maxElevation) const
+{
+    if (!_isValid) {
+        return false;
+    }
+
+    double south = std::max(swCoord.latitude(), _swLat);
+    double west  = std::max(swCoord.longitude(), _swLon);
+    double north = std::min(neCoord.latitude(), _northEast.latitude());
+    double east  = std::min(neCoord.longitude(), _northEast.longitude());
+    if (south > north || west > east) {
+        return false;
+    }
+
+    // Grid points covering the area, rounded outwards so that both sampling modes are covered
+    int lat0 = qBound(0, static_cast<int>(std::floor((south - _swLat) * _latToIndex)), _gridSizeLat - 1);
+    int lat1 = qBound(0, static_cast<int>(std::ceil((north - _swLat) * _latToIndex)), _gridSizeLat - 1);
+    int lon0 = qBound(0, static_cast<int>(std::floor((west - _swLon) * _lonToIndex)), _gridSizeLon - 1);
+    int lon1 = qBound(0, static_cast<int>(std::ceil((east - _swLon) * _lonToIndex)), _gridSizeLon - 1);
+
+    // Go up the pyramid until the area only covers a few cells
+    const int16_t*  minData = _data.constData();
+    const int16_t*  maxData = _data.constData();
+    int             sizeLon = _gridSizeLon;
+    for (int level = 0; level < _mipLevels.count() && (lat1 - lat0 > _mipSpanCells || lon1 - lon0 > _mipSpanCells); level++) {
+        const MipLevel_t& mipLevel = _mipLevels[level];
+        lat0 /= 2;
+        lat1 /= 2;
+        lon0 /= 2;
+        lon1 /= 2;
+        minData = mipLevel.minData.constData();
+        maxData = mipLevel.maxData.constData();
+        sizeLon = mipLevel.sizeLon;
+    }
+
+    int16_t minValue = std::numeric_limits<int16_t>::max();
+    int16_t maxValue = std::numeric_limits<int16_t>::min();
+    for (int i = lat0; i <= lat1; i++) {
+        for (int j = lon0; j <= lon1; j++) {
+            minValue = std::min(minValue, minData[i * sizeLon + j]);
+            maxValue = std::max(maxValue, maxData[i * sizeLon + j]);
+        }
+    }
+    minElevation = minValue;
+    maxElevation = maxValue;
+
+    return true;
 }
 
 QGeoCoordinate TerrainTile::centerCoordinate(void) const
@@ -265,23 +431,3 @@ QByteArray TerrainTile::serialize(QByteArray input)
     return byteArray;
 }
 
-
-int TerrainTile::_latToDataIndex(double latitude) const
-{
-    if (isValid() && _southWest.isValid() && _northEast.isValid()) {
-        return qRound((latitude - _southWest.latitude()) / (_northEast.latitude() - _southWest.latitude()) * (_gridSizeLat - 1));
-    } else {
-        qCWarning(TerrainTileLog) << "TerrainTile::_latToDataIndex internal error" << isValid() << _southWest.isValid() << _northEast.isValid();
-        return -1;
-    }
-}
-
-int TerrainTile::_lonToDataIndex(double longitude) const
-{
-    if (isValid() && _southWest.isValid() && _northEast.isValid()) {
-        return qRound((longitude - _southWest.longitude()) / (_northEast.longitude() - _southWest.longitude()) * (_gridSizeLon - 1));
-    } else {
-        qCWarning(TerrainTileLog) << "TerrainTile::_lonToDataIndex internal error" << isValid() << _southWest.isValid() << _northEast.isValid();
-        return -1;
-    }
-}
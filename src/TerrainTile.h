@@ -4,6 +4,7 @@
 #include "QGCLoggingCategory.h"
 
 #include <QGeoCoordinate>
+#include <QVector>
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainTileLog)
 
@@ -19,6 +20,12 @@ public:
     TerrainTile();
     ~TerrainTile();
 
+    /// How elevations are sampled from the grid
+    enum SampleMode {
+        SampleNearest,      ///< Value of the closest grid point
+        SampleBilinear,     ///< Interpolated from the four surrounding grid points
+    };
+
     /**
     * Constructor from json doc with elevation data (either from file or web)
     *
@@ -52,9 +59,43 @@ public:
     * Evaluates the elevation at the given coordinate
     *
     * @param coordinate
-    * @return elevation
+    * @param mode sampling mode
+    * @return elevation, NaN if the coordinate is outside the tile
+    */
+    double elevation(const QGeoCoordinate& coordinate, SampleMode mode = SampleNearest) const;
+
+    /**
+    * Evaluates the elevation for a batch of coordinates. The loop only touches the flat arrays and the grid so the
+    * compiler can vectorize it.
+    *
+    * @param latitudes
+    * @param longitudes
+    * @param[out] elevations NaN for coordinates outside the tile
+    * @param count number of coordinates
+    * @param mode sampling mode
+    */
+    void elevations(const double* latitudes, const double* longitudes, double* elevations, int count, SampleMode mode = SampleNearest) const;
+
+    /**
+    * Evaluates the elevation for a batch of coordinates
+    *
+    * @param coordinates
+    * @param mode sampling mode
+    * @return elevations, NaN for coordinates outside the tile
     */
-    double elevation(const QGeoCoordinate& coordinate) const;
+    QVector<double> elevations(const QList<QGeoCoordinate>& coordinates, SampleMode mode = SampleNearest) const;
+
+    /**
+    * Bounds the elevation within a rectangular area using the min/max mip levels. The bounds are conservative, they can
+    * be slightly wider than the exact range but never narrower.
+    *
+    * @param swCoord south west corner of the area
+    * @param neCoord north east corner of the area
+    * @param[out] minElevation
+    * @param[out] maxElevation
+    * @return false if the area does not intersect the tile
+    */
+    bool elevationRange(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, double& minElevation, double& maxElevation) const;
 
     /**
     * Accessor for the minimum elevation of the tile
@@ -104,8 +145,15 @@ private:
         int16_t gridSizeLon;
     } TileInfo_t;
 
-    inline int _latToDataIndex(double latitude) const;
-    inline int _lonToDataIndex(double longitude) const;
+    /// One level of the min/max pyramid. Each cell covers 2x2 cells of the level below it.
+    typedef struct {
+        int                 sizeLat;
+        int                 sizeLon;
+        QVector<int16_t>    minData;
+        QVector<int16_t>    maxData;
+    } MipLevel_t;
+
+    void _buildMipLevels(void);
 
     QGeoCoordinate      _southWest;                                     /// South west corner of the tile
     QGeoCoordinate      _northEast;                                     /// North east corner of the tile
@@ -114,11 +162,20 @@ private:
     int16_t             _maxElevation;                                  /// Maximum elevation in tile
     double              _avgElevation;                                  /// Average elevation of the tile
 
-    int16_t**           _data;                                          /// 2D elevation data array
+    QVector<int16_t>    _data;                                          /// Elevation grid, row major by latitude
     int16_t             _gridSizeLat;                                   /// data grid size in latitude direction
     int16_t             _gridSizeLon;                                   /// data grid size in longitude direction
     bool                _isValid;                                       /// data loaded is valid
 
+    double              _swLat;                                         /// Tile bounds and grid scale used by sampling
+    double              _swLon;
+    double              _latToIndex;
+    double              _lonToIndex;
+
+    static const int    _mipSpanCells = 4;                              /// Range queries go up the pyramid until they span this many cells
+
+    QVector<MipLevel_t> _mipLevels;                                     /// Min/max pyramid, the first level halves the grid
+
     // Json keys
     static const char*  _jsonStatusKey;
     static const char*  _jsonDataKey;
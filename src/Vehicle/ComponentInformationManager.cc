@@ -209,8 +209,14 @@ QString RequestMetaDataTypeStateMachine::_downloadCompleteJsonWorker(const QStri
     return outputFileName;
 }
 
-void RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson(const QString& fileName, const QString& errorMsg)
+void RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson(uint8_t componentId, const QString& remotePath, const QString& fileName, const QString& errorMsg)
 {
+    if (componentId != _compInfo->compId || remotePath != _compInfo->uriMetaData) {
+        // Some other transfer on the shared FTPManager
+        return;
+    }
+    disconnect(_compInfo->vehicle->ftpManager(), &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson);
+
     qCDebug(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_downloadCompleteMetaDataJson fileName:errorMsg" << fileName << errorMsg;
 
     if (errorMsg.isEmpty()) {
@@ -220,8 +226,14 @@ void RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson(const QSt
     advance();
 }
 
-void RequestMetaDataTypeStateMachine::_ftpDownloadCompleteTranslationJson(const QString& fileName, const QString& errorMsg)
+void RequestMetaDataTypeStateMachine::_ftpDownloadCompleteTranslationJson(uint8_t componentId, const QString& remotePath, const QString& fileName, const QString& errorMsg)
 {
+    if (componentId != _compInfo->compId || remotePath != _compInfo->uriTranslation) {
+        // Some other transfer on the shared FTPManager
+        return;
+    }
+    disconnect(_compInfo->vehicle->ftpManager(), &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadCompleteTranslationJson);
+
     qCDebug(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_downloadCompleteTranslationJson fileName:errorMsg" << fileName << errorMsg;
 
     QString jsonTranslationFileName;
@@ -269,7 +281,10 @@ void RequestMetaDataTypeStateMachine::_stateRequestMetaDataJson(StateMachine* st
         qCDebug(ComponentInformationManagerLog) << "Downloading metadata json" << compInfo->uriMetaData;
         if (_uriIsFTP(compInfo->uriMetaData)) {
             connect(ftpManager, &FTPManager::downloadComplete, requestMachine, &RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson);
-            ftpManager->download(compInfo->uriMetaData, QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+            if (!ftpManager->download(compInfo->uriMetaData, QStandardPaths::writableLocation(QStandardPaths::TempLocation), compInfo->compId)) {
+                disconnect(ftpManager, &FTPManager::downloadComplete, requestMachine, &RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson);
+                requestMachine->advance();
+            }
         } else {
             QGCFileDownload* download = new QGCFileDownload(requestMachine);
             connect(download, &QGCFileDownload::downloadComplete, requestMachine, &RequestMetaDataTypeStateMachine::_httpDownloadCompleteMetaDataJson);
@@ -295,7 +310,11 @@ void RequestMetaDataTypeStateMachine::_stateRequestTranslationJson(StateMachine*
             qCDebug(ComponentInformationManagerLog) << "Downloading translation json" << compInfo->uriTranslation;
             if (_uriIsFTP(compInfo->uriTranslation)) {
                 connect(ftpManager, &FTPManager::downloadComplete, requestMachine, &RequestMetaDataTypeStateMachine::_ftpDownloadCompleteTranslationJson);
-                ftpManager->download(compInfo->uriTranslation, QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+                if (!ftpManager->download(compInfo->uriTranslation, QStandardPaths::writableLocation(QStandardPaths::TempLocation), compInfo->compId)) {
+                    disconnect(ftpManager, &FTPManager::downloadComplete, requestMachine, &RequestMetaDataTypeStateMachine::_ftpDownloadCompleteTranslationJson);
+                    requestMachine->_compInfo->setJson(requestMachine->_jsonMetadataFileName, QString());
+                    requestMachine->advance();
+                }
             } else {
                 QGCFileDownload* download = new QGCFileDownload(requestMachine);
                 connect(download, &QGCFileDownload::downloadComplete, requestMachine, &RequestMetaDataTypeStateMachine::_httpDownloadCompleteTranslationJson);
@@ -38,8 +38,8 @@ public:
     void            statesCompleted (void) const final;
 
 private slots:
-    void    _ftpDownloadCompleteMetaDataJson    (const QString& file, const QString& errorMsg);
-    void    _ftpDownloadCompleteTranslationJson (const QString& file, const QString& errorMsg);
+    void    _ftpDownloadCompleteMetaDataJson    (uint8_t componentId, const QString& remotePath, const QString& file, const QString& errorMsg);
+    void    _ftpDownloadCompleteTranslationJson (uint8_t componentId, const QString& remotePath, const QString& file, const QString& errorMsg);
     void    _httpDownloadCompleteMetaDataJson   (QString remoteFile, QString localFile, QString errorMsg);
     void    _httpDownloadCompleteTranslationJson(QString remoteFile, QString localFile, QString errorMsg);
     QString _downloadCompleteJsonWorker         (const QString& jsonFileName, const QString& inflatedFileName);
@@ -17,433 +17,472 @@
 #include <QFile>
 #include <QDir>
 #include <string>
+#include <limits>
 
 QGC_LOGGING_CATEGORY(FTPManagerLog, "FTPManagerLog")
 
+static const uint32_t kMaxDataSize = sizeof(((MavlinkFTP::Request*)0)->data);
+
 FTPManager::FTPManager(Vehicle* vehicle)
     : QObject   (vehicle)
     , _vehicle  (vehicle)
 {
-    _ackTimer.setSingleShot(true);
     if (qgcApp()->runningUnitTests()) {
         // Mock link responds immediately if at all
-        _ackTimer.setInterval(10);
+        _ackTimeoutMSecs = _ackTimeoutMSecsUnitTest;
     } else {
-        _ackTimer.setInterval(_ackTimerTimeoutMsecs);
+        _ackTimeoutMSecs = _ackTimeoutMSecsDefault;
     }
-    connect(&_ackTimer, &QTimer::timeout, this, &FTPManager::_ackTimeout);
-    
-    _lastOutgoingRequest.hdr.seqNumber = 0;
-    
+    _timeoutTimer.setInterval(qMax(_ackTimeoutMSecs / 4, 10));
+    connect(&_timeoutTimer, &QTimer::timeout, this, &FTPManager::_checkTimeouts);
+    _clock.start();
+
     // Make sure we don't have bad structure packing
     Q_ASSERT(sizeof(MavlinkFTP::RequestHeader) == 12);
 }
 
-void FTPManager::_handlOpenFileROAck(MavlinkFTP::Request* ack)
+FTPManager::~FTPManager()
 {
-    qCDebug(FTPManagerLog) << QString("_handlOpenFileROAck: _waitState(%1) _readFileLength(%3)").arg(MavlinkFTP::opCodeToString(_waitState)).arg(ack->openFileLength);
-    
-    if (_waitState != MavlinkFTP::kCmdOpenFileRO) {
-        qCDebug(FTPManagerLog) << "Received OpenFileRO Ack while not waiting for it";
-        return;
+    for (QList<Transfer_t*>& queue: _transferQueues) {
+        qDeleteAll(queue);
     }
+}
 
-    if (ack->hdr.size != sizeof(uint32_t)) {
-        qCDebug(FTPManagerLog) << "_handlOpenFileROAck: ack->hdr.size != sizeof(uint32_t)" << ack->hdr.size << sizeof(uint32_t);
-        _downloadComplete(tr("Download failed"));
-        return;
+int FTPManager::transferCount(void) const
+{
+    int count = 0;
+    for (const QList<Transfer_t*>& queue: _transferQueues) {
+        count += queue.count();
     }
+    return count;
+}
 
-    _downloadState.reset();
+FTPManager::Transfer_t* FTPManager::_activeTransfer(uint8_t componentId)
+{
+    auto iter = _transferQueues.find(componentId);
+    if (iter == _transferQueues.end() || iter->isEmpty()) {
+        return nullptr;
+    }
+    return iter->first();
+}
 
-    _waitState                          = MavlinkFTP::kCmdBurstReadFile;
-    _activeSession                      = ack->hdr.session;
-    _downloadState.fileSize             = ack->openFileLength;
-    _downloadState.expectedBurstOffset  = 0;
+QString FTPManager::_stripFTPPrefix(const QString& path)
+{
+    QString ftpPrefix("mavlinkftp://");
+    if (path.startsWith(ftpPrefix, Qt::CaseInsensitive)) {
+        return path.right(path.length() - ftpPrefix.length() + 1);
+    }
+    return path;
+}
 
-    _downloadState.file.setFileName(_downloadState.toDir.filePath(_downloadState.fileName));
-    if (!_downloadState.file.open(QFile::WriteOnly | QFile::Truncate)) {
-        qCDebug(FTPManagerLog) << "_handlOpenFileROAck: _downloadState.file open failed" << _downloadState.file.errorString();
-        _downloadComplete(tr("Download failed"));
-        return;
+bool FTPManager::download(const QString& from, const QString& toDir, uint8_t componentId)
+{
+    qCDebug(FTPManagerLog) << "download from:" << from << "to:" << toDir << "componentId:" << componentId;
+
+    LinkInterface* link = _vehicle->priorityLink();
+    if (!link) {
+        qCDebug(FTPManagerLog) << "Cannot download. Vehicle has no priority link";
+        return false;
     }
 
-    MavlinkFTP::Request request;
-    request.hdr.session = _activeSession;
-    request.hdr.opcode  = MavlinkFTP::kCmdBurstReadFile;
-    request.hdr.offset  = _downloadState.expectedBurstOffset;
-    request.hdr.size    = sizeof(request.data);
-    _sendRequestExpectAck(&request);
+    // We need to strip off the file name from the fully qualified path. We can't use the usual QDir
+    // routines because this path does not exist locally.
+    QString remotePath  = _stripFTPPrefix(from);
+    QString fileName    = remotePath.mid(remotePath.lastIndexOf('/') + 1);
+
+    Transfer_t* transfer    = new Transfer_t;
+    transfer->upload        = false;
+    transfer->componentId   = componentId;
+    transfer->link          = link;
+    transfer->remotePath    = remotePath;
+    transfer->requestedPath = from;
+    transfer->localPath     = QDir(toDir).absoluteFilePath(fileName);
+    _queueTransfer(transfer);
+
+    return true;
 }
 
-void FTPManager::_requestMissingBurstData()
+bool FTPManager::upload(const QString& toPath, const QFileInfo& uploadFile, uint8_t componentId)
 {
-    MavlinkFTP::Request request;
+    qCDebug(FTPManagerLog) << "upload from:" << uploadFile.absoluteFilePath() << "to:" << toPath << "componentId:" << componentId;
 
-    if (_downloadState.missingData.count()) {
-        MissingData_t& missingData = _downloadState.missingData.first();
+    LinkInterface* link = _vehicle->priorityLink();
+    if (!link) {
+        _emitErrorMessage(tr("Command not sent. No Vehicle links."));
+        return false;
+    }
 
-        uint32_t cBytesToRead = qMin((uint32_t)sizeof(request.data), missingData.cBytes);
+    if (toPath.isEmpty()) {
+        return false;
+    }
 
-        qCDebug(FTPManagerLog) << "_requestMissingBurstData: offset:cBytesToRead" << missingData.offset << cBytesToRead;
+    QFile file(uploadFile.absoluteFilePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        _emitErrorMessage(tr("Unable to open local file for upload (%1)").arg(uploadFile.absoluteFilePath()));
+        return false;
+    }
 
-        request.hdr.session                 = _activeSession;
-        request.hdr.opcode                  = MavlinkFTP::kCmdReadFile;
-        request.hdr.offset                  = missingData.offset;
-        request.hdr.size                    = cBytesToRead;
-        _waitState                          = MavlinkFTP::kCmdReadFile;
-        _downloadState.retryCount           = 0;
-        _downloadState.expectedReadOffset   = request.hdr.offset;
+    Transfer_t* transfer    = new Transfer_t;
+    transfer->upload        = true;
+    transfer->componentId   = componentId;
+    transfer->link          = link;
+    transfer->remotePath    = _stripFTPPrefix(toPath) + "/" + uploadFile.fileName();
+    transfer->requestedPath = transfer->remotePath;
+    transfer->localPath     = uploadFile.absoluteFilePath();
+    transfer->uploadData    = file.readAll();
+    transfer->fileSize      = static_cast<uint32_t>(transfer->uploadData.size());
 
-        if (cBytesToRead < missingData.cBytes) {
-            missingData.offset += cBytesToRead;
-            missingData.cBytes -= cBytesToRead;
-        } else {
-            _downloadState.missingData.takeFirst();
-        }
-    } else {
-        qCDebug(FTPManagerLog) << "_requestMissingBurstData: starting next burst" << _downloadState.expectedBurstOffset;
-        request.hdr.session = _activeSession;
-        request.hdr.opcode  = MavlinkFTP::kCmdBurstReadFile;
-        request.hdr.offset  = _downloadState.expectedBurstOffset;
-        request.hdr.size    = sizeof(request.data);
-        _waitState = MavlinkFTP::kCmdBurstReadFile;
+    // Empty files are valid uploads, the server just sees a create followed by a close
+    bool readFailed = transfer->uploadData.size() != file.size();
+    file.close();
+    if (readFailed) {
+        delete transfer;
+        _emitErrorMessage(tr("Unable to read data from local file (%1)").arg(uploadFile.absoluteFilePath()));
+        return false;
     }
 
-    _sendRequestExpectAck(&request);
+    _queueTransfer(transfer);
+
+    return true;
 }
 
-/// Closes out a download session by writing the file and doing cleanup.
-///     @param success true: successful download completion, false: error during download
-void FTPManager::_downloadComplete(const QString& errorMsg)
+void FTPManager::_queueTransfer(Transfer_t* transfer)
 {
-    qCDebug(FTPManagerLog) << QString("_downloadComplete: errorMsg(%1)").arg(errorMsg);
-    
-    QString downloadFilePath    = _downloadState.toDir.absoluteFilePath(_downloadState.fileName);
-    QString error               = errorMsg;
-
-    _ackTimer.stop();
-    _waitState = MavlinkFTP::kCmdNone;
+    QList<Transfer_t*>& queue = _transferQueues[transfer->componentId];
+    queue.append(transfer);
+    if (!_timeoutTimer.isActive()) {
+        _timeoutTimer.start();
+    }
+    if (queue.count() == 1) {
+        _startTransfer(transfer);
+    } else {
+        qCDebug(FTPManagerLog) << "_queueTransfer: waiting for" << queue.count() - 1 << "transfers on componentId" << transfer->componentId;
+    }
+}
 
-    if (error.isEmpty()) {
-        _downloadState.file.close();
+void FTPManager::_startTransfer(Transfer_t* transfer)
+{
+    qCDebug(FTPManagerLog) << "_startTransfer" << (transfer->upload ? "upload" : "download") << transfer->remotePath;
+
+    transfer->elapsed.start();
+    transfer->state         = TransferStateOpening;
+    transfer->retryCount    = 0;
+
+    if (!transfer->upload) {
+        transfer->file.setFileName(transfer->localPath);
+        if (!transfer->file.open(QFile::ReadWrite | QFile::Truncate)) {
+            qCDebug(FTPManagerLog) << "_startTransfer: file open failed" << transfer->file.errorString();
+            transfer->errorMsg = tr("Download failed: Error saving file");
+            _transferComplete(transfer);
+            return;
+        }
     }
-    
-    _downloadState.reset();
-    _sendResetCommand(); // Close the open session
-    emit downloadComplete(downloadFilePath, error);
+
+    _sendOpen(transfer);
+}
+
+void FTPManager::_sendOpen(Transfer_t* transfer)
+{
+    MavlinkFTP::Request request;
+    request.hdr.session = 0;
+    request.hdr.opcode  = transfer->upload ? MavlinkFTP::kCmdCreateFile : MavlinkFTP::kCmdOpenFileRO;
+    request.hdr.offset  = 0;
+    request.hdr.size    = 0;
+    _fillRequestWithString(&request, transfer->remotePath);
+    transfer->requestMSecs = _clock.elapsed();
+    _sendRequest(transfer, &request);
 }
 
-/// Closes out an upload session doing cleanup.
-///     @param success true: successful upload completion, false: error during download
-void FTPManager::_uploadComplete(const QString& errorMsg)
+void FTPManager::_sendBurst(Transfer_t* transfer)
 {
-    qCDebug(FTPManagerLog) << QString("_uploadComplete: errorMsg(%1)").arg(errorMsg);
+    qCDebug(FTPManagerLog) << "_sendBurst: offset" << transfer->burstOffset;
 
-    _waitState      = MavlinkFTP::kCmdNone;
-    _writeFileSize  = 0;
-    _writeFileAccumulator.clear();
-    _sendResetCommand();
-    emit uploadComplete(errorMsg);
+    MavlinkFTP::Request request;
+    request.hdr.session = transfer->session;
+    request.hdr.opcode  = MavlinkFTP::kCmdBurstReadFile;
+    request.hdr.offset  = transfer->burstOffset;
+    request.hdr.size    = kMaxDataSize;
+    transfer->requestMSecs = _clock.elapsed();
+    _sendRequest(transfer, &request);
 }
 
-// We only do read files to fill in holes from a burst read
-void FTPManager::_handleReadFileAck(MavlinkFTP::Request* ack)
+void FTPManager::_sendClose(Transfer_t* transfer)
 {
-    if (ack->hdr.session != _activeSession) {
-        return;
-    }
+    // If the open ack was lost the server may have a session we don't know about
+    MavlinkFTP::Request request;
+    request.hdr.session = transfer->session;
+    request.hdr.opcode  = transfer->sessionOpen ? MavlinkFTP::kCmdTerminateSession : MavlinkFTP::kCmdResetSessions;
+    request.hdr.offset  = 0;
+    request.hdr.size    = 0;
+    transfer->requestMSecs = _clock.elapsed();
+    _sendRequest(transfer, &request);
+}
 
-    qCDebug(FTPManagerLog) << "_handleReadFileAck: offset:size" << ack->hdr.offset << ack->hdr.size;
+void FTPManager::_handleOpenAck(Transfer_t* transfer, MavlinkFTP::Request* ack)
+{
+    qCDebug(FTPManagerLog) << "_handleOpenAck: session" << ack->hdr.session << "openFileLength" << ack->openFileLength;
 
-    if (ack->hdr.offset != _downloadState.expectedReadOffset) {
-        if (++_downloadState.retryCount > _maxRetry) {
-            qCDebug(FTPManagerLog) << QString("_handleReadFileAck: retries exceeded");
-            _downloadComplete(tr("Download failed: Unable to retrieve specified file contents"));
-            return;
-        }
+    transfer->session       = ack->hdr.session;
+    transfer->sessionOpen   = true;
+    transfer->retryCount    = 0;
+    transfer->window        = _initialWindow;
 
-        // Ask for current offset again
-        qCDebug(FTPManagerLog) << QString("_handleReadFileAck: retry retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedReadOffset);
-        MavlinkFTP::Request request;
-        request.hdr.session = _activeSession;
-        request.hdr.opcode  = _waitState;
-        request.hdr.offset  = _downloadState.expectedReadOffset;
-        request.hdr.size    = 0;
-        _sendRequestExpectAck(&request);
+    if (transfer->upload) {
+        transfer->state = TransferStateWindowed;
+        _addMissingData(transfer->missingData, 0, transfer->fileSize);
+        _fillWindow(transfer);
         return;
     }
 
-    _downloadState.file.seek(ack->hdr.offset);
-    int bytesWritten = _downloadState.file.write((const char*)ack->data, ack->hdr.size);
-    if (bytesWritten != ack->hdr.size) {
-        _downloadComplete(tr("Download failed: Error saving file"));
+    if (ack->hdr.size != sizeof(uint32_t)) {
+        qCDebug(FTPManagerLog) << "_handleOpenAck: ack->hdr.size != sizeof(uint32_t)" << ack->hdr.size << sizeof(uint32_t);
+        _finishTransfer(transfer, tr("Download failed"));
         return;
     }
-    _downloadState.bytesWritten += ack->hdr.size;
-    
-    if (_downloadState.fileSize != 0) {
-        emit commandProgress(100 * ((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize));
-    }
-
-    // Move on to fill in possible next hole
-    _requestMissingBurstData();
-}
 
-void FTPManager::_handleBurstReadFileAck(MavlinkFTP::Request* ack)
-{
-    if (ack->hdr.session != _activeSession) {
+    transfer->fileSize = ack->openFileLength;
+    if (transfer->fileSize == 0) {
+        _finishTransfer(transfer, QString());
         return;
     }
 
-    qCDebug(FTPManagerLog) << QString("_handleBurstReadFileAck: offset(%1) size(%2) burstComplete(%3)").arg(ack->hdr.offset).arg(ack->hdr.size).arg(ack->hdr.burstComplete);
-
-    if (ack->hdr.offset != _downloadState.expectedBurstOffset) {
-        if (ack->hdr.offset > _downloadState.expectedBurstOffset) {
-            MissingData_t missingData;
-            missingData.offset = _downloadState.expectedBurstOffset;
-            missingData.cBytes = ack->hdr.offset - _downloadState.expectedBurstOffset;
-            _downloadState.missingData.append(missingData);
-            qCDebug(FTPManagerLog) << "_handleBurstReadFileAck: adding missing data offset:cBytes" << missingData.offset << missingData.cBytes;
-        } else {
-            qCDebug(FTPManagerLog) << "_handleBurstReadFileAck: received offset less than expected offset received:expected" << ack->hdr.offset << _downloadState.expectedBurstOffset;
-            _ackTimer.start();
-            return;
-        }
-    }
-
-    _downloadState.file.seek(ack->hdr.offset);
-    int bytesWritten = _downloadState.file.write((const char*)ack->data, ack->hdr.size);
-    if (bytesWritten != ack->hdr.size) {
-        _downloadComplete(tr("Download failed: Error saving file"));
+    // Incoming data is copied straight into the mapped file, falling back to a seek and write if it can't be mapped
+    if (!transfer->file.resize(transfer->fileSize)) {
+        qCDebug(FTPManagerLog) << "_handleOpenAck: file resize failed" << transfer->file.errorString();
+        _finishTransfer(transfer, tr("Download failed: Error saving file"));
         return;
     }
-    _downloadState.bytesWritten += ack->hdr.size;
-    _downloadState.expectedBurstOffset = ack->hdr.offset + ack->hdr.size;
-
-    if (_downloadState.fileSize != 0) {
-        emit commandProgress(100 * ((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize));
+    transfer->map = transfer->file.map(0, transfer->fileSize);
+    if (!transfer->map) {
+        qCDebug(FTPManagerLog) << "_handleOpenAck: file map failed" << transfer->file.errorString();
     }
 
-    if (ack->hdr.burstComplete) {
-        _requestMissingBurstData();
-    } else {
-        // Still within a burst, next ack should come automatically
-        _ackTimer.start();
-    }
+    _addMissingData(transfer->missingData, 0, transfer->fileSize);
+    transfer->state         = TransferStateBurst;
+    transfer->burstOffset   = 0;
+    _sendBurst(transfer);
 }
 
-void FTPManager::_listAckResponse(MavlinkFTP::Request* /*listAck*/)
+bool FTPManager::_storeData(Transfer_t* transfer, uint32_t offset, const uint8_t* data, uint32_t cBytes)
 {
-#if 0
-    if (listAck->hdr.offset != _listOffset) {
-        // this is a real error (directory listing is synchronous), no need to retransmit
-        _currentOperation = kCOIdle;
-        _emitErrorMessage(tr("List: Offset returned (%1) differs from offset requested (%2)").arg(listAck->hdr.offset).arg(_listOffset));
-        return;
+    if (offset >= transfer->fileSize) {
+        return true;
     }
+    cBytes = qMin(cBytes, transfer->fileSize - offset);
 
-    uint8_t offset = 0;
-    uint8_t cListEntries = 0;
-    uint8_t cBytes = listAck->hdr.size;
+    if (transfer->map) {
+        memcpy(transfer->map + offset, data, cBytes);
+    } else if (!transfer->file.seek(offset) || transfer->file.write(reinterpret_cast<const char*>(data), cBytes) != static_cast<qint64>(cBytes)) {
+        _finishTransfer(transfer, tr("Download failed: Error saving file"));
+        return false;
+    }
+    return true;
+}
 
-    // parse filenames out of the buffer
-    while (offset < cBytes) {
-        const char * ptr = ((const char *)listAck->data) + offset;
+void FTPManager::_handleDataAck(Transfer_t* transfer, MavlinkFTP::Request* ack)
+{
+    uint32_t offset = ack->hdr.offset;
+    uint32_t cBytes = ack->hdr.size;
 
-        // get the length of the name
-        uint8_t cBytesLeft = cBytes - offset;
-        uint8_t nlen = static_cast<uint8_t>(strnlen(ptr, cBytesLeft));
-        if ((*ptr == 'S' && nlen > 1) || (*ptr != 'S' && nlen < 2)) {
-            _currentOperation = kCOIdle;
-            _emitErrorMessage(tr("Incorrectly formed list entry: '%1'").arg(ptr));
-            return;
-        } else if (nlen == cBytesLeft) {
-            _currentOperation = kCOIdle;
-            _emitErrorMessage(tr("Missing NULL termination in list entry"));
+    if (ack->hdr.req_opcode == MavlinkFTP::kCmdReadFile) {
+        auto iter = transfer->outstanding.find(offset);
+        if (iter == transfer->outstanding.end()) {
+            // Second ack for a request which was resent
             return;
         }
+        uint32_t cBytesRequested = iter->cBytes;
+        transfer->outstanding.erase(iter);
 
-        // Returned names are prepended with D for directory, F for file, S for skip
-        if (*ptr == 'F' || *ptr == 'D') {
-            // put it in the view
-            _emitListEntry(ptr);
-        } else if (*ptr == 'S') {
-            // do nothing
-        } else {
-            qDebug() << "unknown entry" << ptr;
+        if (cBytes < cBytesRequested) {
+            // Short read, ask for the rest again
+            _addMissingData(transfer->missingData, offset + cBytes, cBytesRequested - cBytes);
         }
+        cBytes = qMin(cBytes, cBytesRequested);
+        if (!_storeData(transfer, offset, ack->data, cBytes)) {
+            return;
+        }
+        transfer->bytesDone += cBytes;
+        transfer->window = qMin(transfer->window + 1, static_cast<int>(_maxWindow));
+    } else {
+        qCDebug(FTPManagerLog) << QString("_handleDataAck: burst offset(%1) size(%2) burstComplete(%3)").arg(offset).arg(cBytes).arg(ack->hdr.burstComplete);
 
-        // account for the name + NUL
-        offset += nlen + 1;
-
-        cListEntries++;
+        // Burst data is only new where it is still missing. Anything skipped over stays in the missing list and is
+        // read once the burst reaches the end of the file.
+        uint32_t cBytesNew = _removeMissingData(transfer->missingData, offset, cBytes);
+        if (cBytesNew && !_storeData(transfer, offset, ack->data, cBytes)) {
+            return;
+        }
+        transfer->bytesDone += cBytesNew;
+
+        if (transfer->state == TransferStateBurst) {
+            transfer->requestMSecs  = _clock.elapsed();
+            transfer->retryCount    = 0;
+            transfer->burstOffset   = qMax(transfer->burstOffset, offset + cBytes);
+            if (transfer->burstOffset >= transfer->fileSize) {
+                _endBurst(transfer);
+                return;
+            } else if (ack->hdr.burstComplete) {
+                _sendBurst(transfer);
+            }
+        }
     }
 
-    if (listAck->hdr.size == 0 || cListEntries == 0) {
-        // Directory is empty, we're done
-        Q_ASSERT(listAck->hdr.opcode == MavlinkFTP::kRspAck);
-        _currentOperation = kCOIdle;
-        emit commandComplete();
-    } else {
-        // Possibly more entries to come, need to keep trying till we get EOF
-        _currentOperation = kCOList;
-        _listOffset += cListEntries;
-        _sendListCommand();
+    _updateProgress(transfer);
+    if (transfer->state == TransferStateWindowed) {
+        _fillWindow(transfer);
     }
-#endif
 }
 
-/// @brief Respond to the Ack associated with the create command.
-void FTPManager::_createAckResponse(MavlinkFTP::Request* /*createAck*/)
+void FTPManager::_handleWriteAck(Transfer_t* transfer, MavlinkFTP::Request* ack)
 {
-#if 0
-    qCDebug(FTPManagerLog) << "_createAckResponse";
-    
-    _currentOperation = kCOWrite;
-    _activeSession = createAck->hdr.session;
-
-    // Start the sequence of write commands from the beginning of the file
-
-    _writeOffset = 0;
-    _writeSize = 0;
-    
-    _writeFileDatablock();
-#endif
-}
-
-/// @brief Respond to the Ack associated with the write command.
-void FTPManager::_writeAckResponse(MavlinkFTP::Request* /*writeAck*/)
-{
-#if 0
-    if(_writeOffset + _writeSize >= _writeFileSize){
-        _closeUploadSession(true /* success */);
-        return;
-    }
-
-    if (writeAck->hdr.session != _activeSession) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Incorrect session returned"));
-        return;
-    }
+    uint32_t offset = ack->hdr.offset;
 
-    if (writeAck->hdr.offset != _writeOffset) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Offset returned (%1) differs from offset requested (%2)").arg(writeAck->hdr.offset).arg(_writeOffset));
+    auto iter = transfer->outstanding.find(offset);
+    if (iter == transfer->outstanding.end()) {
+        // Second ack for a request which was resent
         return;
     }
+    uint32_t cBytesRequested = iter->cBytes;
+    transfer->outstanding.erase(iter);
 
-    if (writeAck->hdr.size != sizeof(uint32_t)) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Returned invalid size of write size data"));
-        return;
+    uint32_t cBytesWritten = ack->hdr.size == sizeof(uint32_t) ? qMin(ack->writeFileLength, cBytesRequested) : cBytesRequested;
+    if (cBytesWritten < cBytesRequested) {
+        _addMissingData(transfer->missingData, offset + cBytesWritten, cBytesRequested - cBytesWritten);
     }
+    transfer->bytesDone += cBytesWritten;
+    transfer->window = qMin(transfer->window + 1, static_cast<int>(_maxWindow));
 
+    _updateProgress(transfer);
+    _fillWindow(transfer);
+}
 
-    if( writeAck->writeFileLength !=_writeSize) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Size returned (%1) differs from size requested (%2)").arg(writeAck->writeFileLength).arg(_writeSize));
-        return;
-    }
+/// Switches from burst reads to windowed reads of whatever the bursts missed
+void FTPManager::_endBurst(Transfer_t* transfer)
+{
+    qCDebug(FTPManagerLog) << "_endBurst: missing ranges" << transfer->missingData.count();
 
-    _writeFileDatablock();
-#endif
+    transfer->state         = TransferStateWindowed;
+    transfer->retryCount    = 0;
+    _updateProgress(transfer);
+    _fillWindow(transfer);
 }
 
-/// @brief Send next write file data block.
-void FTPManager::_writeFileDatablock(void)
+/// Keeps up to window requests in flight
+void FTPManager::_fillWindow(Transfer_t* transfer)
 {
-#if 0
-    if (_writeOffset + _writeSize >= _writeFileSize){
-        _closeUploadSession(true /* success */);
-        return;
+    while (transfer->outstanding.count() < transfer->window && !transfer->missingData.isEmpty()) {
+        MissingData_t&  missingData = transfer->missingData.first();
+        uint32_t        offset      = missingData.offset;
+        uint32_t        cBytes      = qMin(kMaxDataSize, missingData.cBytes);
+
+        if (cBytes < missingData.cBytes) {
+            missingData.offset += cBytes;
+            missingData.cBytes -= cBytes;
+        } else {
+            transfer->missingData.removeFirst();
+        }
+
+        Outstanding_t outstanding;
+        outstanding.cBytes      = cBytes;
+        outstanding.sentMSecs   = 0;
+        outstanding.retryCount  = 0;
+        transfer->outstanding[offset] = outstanding;
+        _sendWindowedRequest(transfer, offset, cBytes);
     }
 
-    _writeOffset += _writeSize;
+    _checkTransferDone(transfer);
+}
 
+void FTPManager::_sendWindowedRequest(Transfer_t* transfer, uint32_t offset, uint32_t cBytes)
+{
     MavlinkFTP::Request request;
-    request.hdr.session = _activeSession;
-    request.hdr.opcode = MavlinkFTP::kCmdWriteFile;
-    request.hdr.offset = _writeOffset;
-
-    if(_writeFileSize -_writeOffset > sizeof(request.data) )
-        _writeSize = sizeof(request.data);
-    else
-        _writeSize = _writeFileSize - _writeOffset;
-
-    request.hdr.size = _writeSize;
+    request.hdr.session = transfer->session;
+    request.hdr.offset  = offset;
+    request.hdr.size    = static_cast<uint8_t>(cBytes);
+    if (transfer->upload) {
+        request.hdr.opcode = MavlinkFTP::kCmdWriteFile;
+        memcpy(request.data, transfer->uploadData.constData() + offset, cBytes);
+    } else {
+        request.hdr.opcode = MavlinkFTP::kCmdReadFile;
+    }
+    transfer->outstanding[offset].sentMSecs = _clock.elapsed();
+    _sendRequest(transfer, &request);
+}
 
-    memcpy(request.data, &_writeFileAccumulator.data()[_writeOffset], _writeSize);
+void FTPManager::_checkTransferDone(Transfer_t* transfer)
+{
+    if (transfer->state == TransferStateWindowed && transfer->missingData.isEmpty() && transfer->outstanding.isEmpty()) {
+        _finishTransfer(transfer, QString());
+    }
+}
 
-    _sendRequestExpectAck(&request);
-#endif
+void FTPManager::_updateProgress(Transfer_t* transfer)
+{
+    if (transfer->fileSize != 0) {
+        int progress = static_cast<int>(100 * (static_cast<float>(transfer->bytesDone) / static_cast<float>(transfer->fileSize)));
+        if (progress != transfer->progress) {
+            transfer->progress = progress;
+            emit commandProgress(progress);
+        }
+    }
 }
 
-void FTPManager::_handleAck(MavlinkFTP::Request* ack)
+/// Closes the session, the transfer completes once the server acks the close
+void FTPManager::_finishTransfer(Transfer_t* transfer, const QString& errorMsg)
 {
+    qCDebug(FTPManagerLog) << QString("_finishTransfer: errorMsg(%1)").arg(errorMsg);
+
+    transfer->errorMsg      = errorMsg;
+    transfer->state         = TransferStateClosing;
+    transfer->retryCount    = 0;
+    transfer->missingData.clear();
+    transfer->outstanding.clear();
+    _sendClose(transfer);
+}
 
-    switch (ack->hdr.req_opcode) {
-    case MavlinkFTP::kCmdOpenFileRO:
-        _handlOpenFileROAck(ack);
-        break;
-    case MavlinkFTP::kCmdReadFile:
-        _handleReadFileAck(ack);
-        break;
-    case MavlinkFTP::kCmdBurstReadFile:
-        _handleBurstReadFileAck(ack);
-        break;
+void FTPManager::_transferComplete(Transfer_t* transfer)
+{
+    qint64 elapsedMSecs = transfer->elapsed.isValid() ? transfer->elapsed.elapsed() : 0;
+    qCDebug(FTPManagerLog) << "_transferComplete" << transfer->remotePath << "bytes:" << transfer->bytesDone << "msecs:" << elapsedMSecs
+                           << "bytes/sec:" << (elapsedMSecs ? transfer->bytesDone * 1000 / elapsedMSecs : 0) << "errorMsg:" << transfer->errorMsg;
 
-#if 0
-    case MavlinkFTP::kCmdListDirectory:
-        _listAckResponse(request);
-        break;
+    if (transfer->map) {
+        transfer->file.unmap(transfer->map);
+        transfer->map = nullptr;
+    }
+    transfer->file.close();
 
-    case MavlinkFTP::kCmdOpenFileRO:
-    case MavlinkFTP::kCmdOpenFileWO:
-        _handlOpenFileROAck(request);
-        break;
+    QList<Transfer_t*>& queue = _transferQueues[transfer->componentId];
+    queue.removeOne(transfer);
+    if (queue.isEmpty()) {
+        _transferQueues.remove(transfer->componentId);
+    }
+    if (_transferQueues.isEmpty()) {
+        _timeoutTimer.stop();
+    }
 
-    case MavlinkFTP::kCmdCreateFile:
-        _createAckResponse(request);
-        break;
+    if (transfer->upload) {
+        emit uploadComplete(transfer->componentId, transfer->requestedPath, transfer->localPath, transfer->errorMsg);
+    } else {
+        emit downloadComplete(transfer->componentId, transfer->requestedPath, transfer->localPath, transfer->errorMsg);
+    }
+    uint8_t componentId = transfer->componentId;
+    delete transfer;
 
-    case MavlinkFTP::kCmdWriteFile:
-        _writeAckResponse(request);
-        break;
-#endif
-    default:
-        // Ack back from operation which does not require additional work
-        _waitState = MavlinkFTP::kCmdNone;
-        break;
+    // A signal handler may already have started a new transfer on this component
+    Transfer_t* nextTransfer = _activeTransfer(componentId);
+    if (nextTransfer && !nextTransfer->elapsed.isValid()) {
+        _startTransfer(nextTransfer);
     }
 }
 
-void FTPManager::_handleNak(MavlinkFTP::Request* nak)
+void FTPManager::_handleNak(Transfer_t* transfer, MavlinkFTP::Request* nak)
 {
     QString                 errorMsg;
-    MavlinkFTP::OpCode_t    requestOpCode = static_cast<MavlinkFTP::OpCode_t>(nak->hdr.req_opcode);
-    MavlinkFTP::ErrorCode_t errorCode = static_cast<MavlinkFTP::ErrorCode_t>(nak->data[0]);
-
-    if (errorCode == MavlinkFTP::kErrEOF) {
-        qCDebug(FTPManagerLog) << "_handleNak EOF";
-        if (requestOpCode == MavlinkFTP::kCmdReadFile && _downloadState.bytesWritten == _downloadState.fileSize) {
-            // This could be an EOF on a normal read sequence, or an EOF for a read to fill in holes from a burst read.
-            // Either way it means we should be done.
-            _downloadComplete(QString());
-            return;
-        } else if (requestOpCode == MavlinkFTP::kCmdBurstReadFile) {
-            // This is an EOF during a burst read, we still have to check for filling in missing data
-            if (_downloadState.missingData.count()) {
-                // We only call _requestMissingBurstData if there are no missing blocks since _requestMissingBurstData will start a new
-                // burst sequence if you call it with no missing blocks which would put us into an infinite loop on EOFs.
-                _requestMissingBurstData();
-                return;
-            } else if (_downloadState.bytesWritten == _downloadState.fileSize) {
-                _downloadComplete(QString());
-                return;
-            }
-        }
-    }
+    MavlinkFTP::OpCode_t    requestOpCode   = static_cast<MavlinkFTP::OpCode_t>(nak->hdr.req_opcode);
+    MavlinkFTP::ErrorCode_t errorCode       = static_cast<MavlinkFTP::ErrorCode_t>(nak->data[0]);
+
+    qCDebug(FTPManagerLog) << "_handleNak" << MavlinkFTP::opCodeToString(requestOpCode) << MavlinkFTP::errorCodeToString(errorCode);
 
     // Nak's normally have 1 byte of data for error code, except for MavlinkFTP::kErrFailErrno which has additional byte for errno
     if ((errorCode == MavlinkFTP::kErrFailErrno && nak->hdr.size != 2) || ((errorCode != MavlinkFTP::kErrFailErrno) && nak->hdr.size != 1)) {
@@ -453,17 +492,35 @@ void FTPManager::_handleNak(MavlinkFTP::Request* nak)
     } else {
         errorMsg = MavlinkFTP::errorCodeToString(errorCode);
     }
+    errorMsg = (transfer->upload ? tr("Upload failed: %1") : tr("Download failed: %1")).arg(errorMsg);
 
-    _waitState = MavlinkFTP::kCmdNone;
-
-    switch (nak->hdr.req_opcode) {
-    case MavlinkFTP::kCmdOpenFileRO:
-    case MavlinkFTP::kCmdReadFile:
-    case MavlinkFTP::kCmdBurstReadFile:
-        _downloadComplete(tr("Download failed: %1").arg(errorMsg));
+    switch (transfer->state) {
+    case TransferStateOpening:
+        if (requestOpCode == MavlinkFTP::kCmdOpenFileRO || requestOpCode == MavlinkFTP::kCmdCreateFile) {
+            // No session was opened, so there is nothing to close
+            transfer->errorMsg = errorMsg;
+            _transferComplete(transfer);
+        }
         break;
-    default:
-        // FIXME: Rest is NYI
+    case TransferStateBurst:
+        if (requestOpCode == MavlinkFTP::kCmdBurstReadFile) {
+            if (errorCode == MavlinkFTP::kErrEOF) {
+                // End of file, move on to filling in what the bursts missed
+                _endBurst(transfer);
+            } else {
+                _finishTransfer(transfer, errorMsg);
+            }
+        }
+        break;
+    case TransferStateWindowed:
+        if (requestOpCode == MavlinkFTP::kCmdReadFile || requestOpCode == MavlinkFTP::kCmdWriteFile) {
+            _finishTransfer(transfer, errorMsg);
+        }
+        break;
+    case TransferStateClosing:
+        if (requestOpCode == MavlinkFTP::kCmdTerminateSession || requestOpCode == MavlinkFTP::kCmdResetSessions) {
+            _transferComplete(transfer);
+        }
         break;
     }
 }
@@ -482,213 +539,240 @@ void FTPManager::mavlinkMessageReceived(mavlink_message_t message)
     if (data.target_system != qgcId) {
         return;
     }
-    
+
     MavlinkFTP::Request* request = (MavlinkFTP::Request*)&data.payload[0];
 
-    uint16_t incomingSeqNumber = request->hdr.seqNumber;
-    uint16_t expectedSeqNumber = _lastOutgoingRequest.hdr.seqNumber + 1;
+    // Keep track of the newest sequence number from this component, see _sendRequest
+    uint16_t& seqNumber = _seqNumbers[message.compid];
+    if ((uint16_t)(request->hdr.seqNumber - seqNumber) < (std::numeric_limits<uint16_t>::max()/2)) {
+        seqNumber = request->hdr.seqNumber;
+    }
 
-    // ignore old/reordered packets (handle wrap-around properly)
-    if ((uint16_t)((expectedSeqNumber - 1) - incomingSeqNumber) < (std::numeric_limits<uint16_t>::max()/2)) {
-        qCDebug(FTPManagerLog) << "Received old packet: expected seq:" << expectedSeqNumber << "got:" << incomingSeqNumber;
+    Transfer_t* transfer = _activeTransfer(message.compid);
+    if (!transfer) {
         return;
     }
 
-    _ackTimer.stop();
-    
     qCDebug(FTPManagerLog) << "mavlinkMessageReceived" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode));
 
-    if (incomingSeqNumber != expectedSeqNumber) {
-        switch (_waitState) {
-        case MavlinkFTP::kCmdOpenFileRO:
-            _downloadComplete(tr("Download failed: Unable to handle packet loss"));
-            break;
-        case MavlinkFTP::kCmdReadFile:
-        case MavlinkFTP::kCmdBurstReadFile:
-            // These can handle packet loss
-            break;
-#if 0
-        case kCOWrite:
-            _closeUploadSession(false /* failure */);
-            break;
+    if (request->hdr.opcode == MavlinkFTP::kRspNak) {
+        _handleNak(transfer, request);
+        return;
+    } else if (request->hdr.opcode != MavlinkFTP::kRspAck) {
+        return;
+    }
 
-        case kCOOpenRead:
-        case kCOOpenBurst:
-        case kCOCreate:
-            // We could have an open session hanging around
-            _currentOperation = kCOIdle;
-            _sendResetCommand();
-            break;
-#endif
-        default:
-            // Don't need to do anything special
-            _waitState = MavlinkFTP::kCmdNone;
+    switch (transfer->state) {
+    case TransferStateOpening:
+        if (request->hdr.req_opcode == (transfer->upload ? MavlinkFTP::kCmdCreateFile : MavlinkFTP::kCmdOpenFileRO)) {
+            _handleOpenAck(transfer, request);
+        }
+        break;
+    case TransferStateBurst:
+    case TransferStateWindowed:
+        if (request->hdr.session != transfer->session) {
             break;
         }
-    }
-    
-    // Move past the incoming sequence number for next request
-    _lastOutgoingRequest.hdr.seqNumber = incomingSeqNumber;
-
-    if (request->hdr.opcode == MavlinkFTP::kRspAck) {
-        _handleAck(request);
-    } else if (request->hdr.opcode == MavlinkFTP::kRspNak) {
-        _handleNak(request);
+        if (transfer->upload && request->hdr.req_opcode == MavlinkFTP::kCmdWriteFile) {
+            _handleWriteAck(transfer, request);
+        } else if (!transfer->upload && (request->hdr.req_opcode == MavlinkFTP::kCmdReadFile || request->hdr.req_opcode == MavlinkFTP::kCmdBurstReadFile)) {
+            _handleDataAck(transfer, request);
+        }
+        break;
+    case TransferStateClosing:
+        if (request->hdr.req_opcode == MavlinkFTP::kCmdTerminateSession || request->hdr.req_opcode == MavlinkFTP::kCmdResetSessions) {
+            _transferComplete(transfer);
+        }
+        break;
     }
 }
 
-void FTPManager::listDirectory(const QString& dirPath)
+void FTPManager::_checkTimeouts(void)
 {
-    if (_waitState != MavlinkFTP::kCmdNone) {
-        _emitErrorMessage(tr("Command not sent. Waiting for previous command to complete."));
-        return;
-    }
+    qint64 now = _clock.elapsed();
 
-    _dedicatedLink = _vehicle->priorityLink();
-    if (!_dedicatedLink) {
-        _emitErrorMessage(tr("Command not sent. No Vehicle links."));
-        return;
+    QList<Transfer_t*> activeTransfers;
+    for (const QList<Transfer_t*>& queue: _transferQueues) {
+        activeTransfers.append(queue.first());
     }
 
-    // initialise the lister
-    _listPath           = dirPath;
-    _listOffset         = 0;
-    _waitState   =      MavlinkFTP::kCmdListDirectory;
-
-    // and send the initial request
-    _sendListCommand();
-}
-
-void FTPManager::_fillRequestWithString(MavlinkFTP::Request* request, const QString& str)
-{
-    strncpy((char *)&request->data[0], str.toStdString().c_str(), sizeof(request->data));
-    request->hdr.size = static_cast<uint8_t>(strnlen((const char *)&request->data[0], sizeof(request->data)));
-}
-
-void FTPManager::_sendListCommand(void)
-{
-    MavlinkFTP::Request request;
-
-    request.hdr.session = 0;
-    request.hdr.opcode = MavlinkFTP::kCmdListDirectory;
-    request.hdr.offset = _listOffset;
-    request.hdr.size = 0;
-
-    _fillRequestWithString(&request, _listPath);
-
-    qCDebug(FTPManagerLog) << "listDirectory: path:" << _listPath << "offset:" <<  _listOffset;
-    
-    _sendRequestExpectAck(&request);
-}
-
-bool FTPManager::download(const QString& from, const QString& toDir)
-{
-    qCDebug(FTPManagerLog) << "download from:" << from << "to:" << toDir;
-    return _downloadWorker(from, toDir);
+    for (Transfer_t* transfer: activeTransfers) {
+        switch (transfer->state) {
+        case TransferStateOpening:
+        case TransferStateBurst:
+        case TransferStateClosing:
+            if (now - transfer->requestMSecs < _ackTimeoutMSecs) {
+                break;
+            }
+            qCDebug(FTPManagerLog) << "_checkTimeouts: state" << transfer->state << "retryCount" << transfer->retryCount;
+            if (++transfer->retryCount <= _maxRetry) {
+                if (transfer->state == TransferStateOpening) {
+                    _sendOpen(transfer);
+                } else if (transfer->state == TransferStateBurst) {
+                    _sendBurst(transfer);
+                } else {
+                    _sendClose(transfer);
+                }
+            } else if (transfer->state == TransferStateOpening) {
+                _finishTransfer(transfer, tr("%1 failed: Vehicle did not respond to %2").arg(transfer->upload ? tr("Upload") : tr("Download")).arg(MavlinkFTP::opCodeToString(transfer->upload ? MavlinkFTP::kCmdCreateFile : MavlinkFTP::kCmdOpenFileRO)));
+            } else if (transfer->state == TransferStateBurst) {
+                // Server may not support bursts, read whatever is left through windowed reads
+                _endBurst(transfer);
+            } else {
+                // Nothing more we can do, the server will time out the session by itself
+                _transferComplete(transfer);
+            }
+            break;
+        case TransferStateWindowed:
+        {
+            bool timedOut = false;
+            for (uint32_t offset: transfer->outstanding.keys()) {
+                Outstanding_t& outstanding = transfer->outstanding[offset];
+                if (now - outstanding.sentMSecs < _ackTimeoutMSecs) {
+                    continue;
+                }
+                if (++outstanding.retryCount > _maxRetry) {
+                    _finishTransfer(transfer, tr("%1 failed: Vehicle did not respond to %2").arg(transfer->upload ? tr("Upload") : tr("Download")).arg(MavlinkFTP::opCodeToString(transfer->upload ? MavlinkFTP::kCmdWriteFile : MavlinkFTP::kCmdReadFile)));
+                    break;
+                }
+                timedOut = true;
+                _sendWindowedRequest(transfer, offset, outstanding.cBytes);
+            }
+            if (timedOut) {
+                // Back off on loss, the window grows again by one for each ack
+                transfer->window = qMax(transfer->window / 2, 1);
+            }
+        }
+            break;
+        }
+    }
 }
 
-bool FTPManager::_downloadWorker(const QString& from, const QString& toDir)
+void FTPManager::_addMissingData(QList<MissingData_t>& missingData, uint32_t offset, uint32_t cBytes)
 {
-    if (_waitState != MavlinkFTP::kCmdNone) {
-        qCDebug(FTPManagerLog) << "Cannot download. Already in another operation";
-        return false;
+    if (cBytes == 0) {
+        return;
     }
-
-    _dedicatedLink = _vehicle->priorityLink();
-    if (!_dedicatedLink) {
-        qCDebug(FTPManagerLog) << "Cannot download. Vehicle has no priority link";
-        return false;
-    }
-
-    _downloadState.reset();
-    _downloadState.toDir.setPath(toDir);
-
-    QString strippedFrom;
-    QString ftpPrefix("mavlinkftp://");
-    if (from.startsWith(ftpPrefix, Qt::CaseInsensitive)) {
-        strippedFrom = from.right(from.length() - ftpPrefix.length() + 1);
-    } else {
-        strippedFrom = from;
+    int index = 0;
+    while (index < missingData.count() && missingData[index].offset < offset) {
+        index++;
     }
+    MissingData_t newMissingData;
+    newMissingData.offset = offset;
+    newMissingData.cBytes = cBytes;
+    missingData.insert(index, newMissingData);
+}
 
-    // We need to strip off the file name from the fully qualified path. We can't use the usual QDir
-    // routines because this path does not exist locally.
-    int lastDirSlashIndex;
-    for (lastDirSlashIndex=strippedFrom.size()-1; lastDirSlashIndex>=0; lastDirSlashIndex--) {
-        if (strippedFrom[lastDirSlashIndex] == '/') {
+/// Removes a received range from the missing list
+///     @return Number of bytes of the range which were missing
+uint32_t FTPManager::_removeMissingData(QList<MissingData_t>& missingData, uint32_t offset, uint32_t cBytes)
+{
+    uint32_t end            = offset + cBytes;
+    uint32_t cBytesRemoved  = 0;
+
+    int i = 0;
+    while (i < missingData.count()) {
+        MissingData_t   missing     = missingData[i];
+        uint32_t        missingEnd  = missing.offset + missing.cBytes;
+        if (missing.offset >= end) {
             break;
         }
-    }
-    lastDirSlashIndex++; // move past slash
+        if (missingEnd <= offset) {
+            i++;
+            continue;
+        }
 
-    _downloadState.fileName = strippedFrom.right(strippedFrom.size() - lastDirSlashIndex);
-    _waitState              = MavlinkFTP::kCmdOpenFileRO;
+        uint32_t overlapStart   = qMax(offset, missing.offset);
+        uint32_t overlapEnd     = qMin(end, missingEnd);
+        cBytesRemoved += overlapEnd - overlapStart;
+
+        // Replace the range with whatever is left on either side of the overlap
+        missingData.removeAt(i);
+        if (overlapStart > missing.offset) {
+            MissingData_t before;
+            before.offset = missing.offset;
+            before.cBytes = overlapStart - missing.offset;
+            missingData.insert(i++, before);
+        }
+        if (missingEnd > overlapEnd) {
+            MissingData_t after;
+            after.offset = overlapEnd;
+            after.cBytes = missingEnd - overlapEnd;
+            missingData.insert(i++, after);
+        }
+    }
 
-    MavlinkFTP::Request request;
-    request.hdr.session = 0;
-    request.hdr.opcode  = MavlinkFTP::kCmdOpenFileRO;
-    request.hdr.offset  = 0;
-    request.hdr.size    = 0;
-    _fillRequestWithString(&request, strippedFrom);
-    _sendRequestExpectAck(&request);
+    return cBytesRemoved;
+}
 
-    return true;
+void FTPManager::listDirectory(const QString& dirPath)
+{
+    qCDebug(FTPManagerLog) << "listDirectory" << dirPath;
+    _emitErrorMessage(tr("Directory listing is not supported"));
 }
 
-/// @brief Uploads the specified file.
-///     @param toPath File in UAS to upload to, fully qualified path
-///     @param uploadFile Local file to upload from
-void FTPManager::upload(const QString& /*toPath*/, const QFileInfo& /*uploadFile*/)
+void FTPManager::_listAckResponse(MavlinkFTP::Request* /*listAck*/)
 {
 #if 0
-    if(_currentOperation != kCOIdle){
-        _emitErrorMessage(tr("UAS File manager busy. Try again later"));
-        return;
-    }
-
-    _dedicatedLink = _vehicle->priorityLink();
-    if (!_dedicatedLink) {
-        _emitErrorMessage(tr("Command not sent. No Vehicle links."));
+    if (listAck->hdr.offset != _listOffset) {
+        // this is a real error (directory listing is synchronous), no need to retransmit
+        _currentOperation = kCOIdle;
+        _emitErrorMessage(tr("List: Offset returned (%1) differs from offset requested (%2)").arg(listAck->hdr.offset).arg(_listOffset));
         return;
     }
 
-    if (toPath.isEmpty()) {
-        return;
-    }
+    uint8_t offset = 0;
+    uint8_t cListEntries = 0;
+    uint8_t cBytes = listAck->hdr.size;
 
-    if (!uploadFile.isReadable()){
-        _emitErrorMessage(tr("File (%1) is not readable for upload").arg(uploadFile.path()));
-        return;
-    }
+    // parse filenames out of the buffer
+    while (offset < cBytes) {
+        const char * ptr = ((const char *)listAck->data) + offset;
 
-    QFile file(uploadFile.absoluteFilePath());
-    if (!file.open(QIODevice::ReadOnly)) {
-        _emitErrorMessage(tr("Unable to open local file for upload (%1)").arg(uploadFile.absoluteFilePath()));
-        return;
-    }
+        // get the length of the name
+        uint8_t cBytesLeft = cBytes - offset;
+        uint8_t nlen = static_cast<uint8_t>(strnlen(ptr, cBytesLeft));
+        if ((*ptr == 'S' && nlen > 1) || (*ptr != 'S' && nlen < 2)) {
+            _currentOperation = kCOIdle;
+            _emitErrorMessage(tr("Incorrectly formed list entry: '%1'").arg(ptr));
+            return;
+        } else if (nlen == cBytesLeft) {
+            _currentOperation = kCOIdle;
+            _emitErrorMessage(tr("Missing NULL termination in list entry"));
+            return;
+        }
 
-    _writeFileAccumulator = file.readAll();
-    _writeFileSize = _writeFileAccumulator.size();
+        // Returned names are prepended with D for directory, F for file, S for skip
+        if (*ptr == 'F' || *ptr == 'D') {
+            // put it in the view
+            _emitListEntry(ptr);
+        } else if (*ptr == 'S') {
+            // do nothing
+        } else {
+            qDebug() << "unknown entry" << ptr;
+        }
 
-    file.close();
+        // account for the name + NUL
+        offset += nlen + 1;
 
-    if (_writeFileAccumulator.size() == 0) {
-        _emitErrorMessage(tr("Unable to read data from local file (%1)").arg(uploadFile.absoluteFilePath()));
-        return;
+        cListEntries++;
     }
 
-    _currentOperation = kCOCreate;
-
-    MavlinkFTP::Request request;
-    request.hdr.session = 0;
-    request.hdr.opcode = MavlinkFTP::kCmdCreateFile;
-    request.hdr.offset = 0;
-    request.hdr.size = 0;
-    _fillRequestWithString(&request, toPath + "/" + uploadFile.fileName());
-    _sendRequestExpectAck(&request);
+    if (listAck->hdr.size == 0 || cListEntries == 0) {
+        // Directory is empty, we're done
+        Q_ASSERT(listAck->hdr.opcode == MavlinkFTP::kRspAck);
+        _currentOperation = kCOIdle;
+        emit commandComplete();
+    } else {
+        // Possibly more entries to come, need to keep trying till we get EOF
+        _currentOperation = kCOList;
+        _listOffset += cListEntries;
+        _sendListCommand();
+    }
 #endif
 }
 
+
 void FTPManager::createDirectory(const QString& /*directory*/)
 {
 #if 0
@@ -709,111 +793,11 @@ void FTPManager::createDirectory(const QString& /*directory*/)
 #endif
 }
 
-/// @brief Sends a command which only requires an opcode and no additional data
-///     @param opcode Opcode to send
-///     @param newOpState State to put state machine into
-/// @return TRUE: command sent, FALSE: command not sent, waiting for previous command to finish
-bool FTPManager::_sendOpcodeOnlyCmd(MavlinkFTP::OpCode_t opcode, MavlinkFTP::OpCode_t newWaitState)
-{
-    if (_waitState != MavlinkFTP::kCmdNone) {
-        // Can't have multiple commands in play at the same time
-        return false;
-    }
-
-    _waitState = newWaitState;
-
-    MavlinkFTP::Request request;
-    request.hdr.session = 0;
-    request.hdr.opcode  = opcode;
-    request.hdr.offset  = 0;
-    request.hdr.size    = 0;
-    _sendRequestExpectAck(&request);
-
-    return true;
-}
-
-void FTPManager::_ackTimeout(void)
-{
-    qCDebug(FTPManagerLog) << "_ackTimeout" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(_waitState));
-
-    switch (_waitState) {
-    case MavlinkFTP::kCmdReadFile:
-        // FIXME: retry count?
-        // Resend last request
-        _lastOutgoingRequest.hdr.seqNumber--;
-        _sendRequestExpectAck(&_lastOutgoingRequest);
-        return;
-    default:
-        break;
-    }
-
-#if 0
-    if (++_ackNumTries <= _ackTimerMaxRetries) {
-        qCDebug(FTPManagerLog) << "ack timeout - retrying";
-        if (_currentOperation == kCOBurst) {
-            // for burst downloads try to initiate a new burst
-            MavlinkFTP::Request request;
-            request.hdr.session = _activeSession;
-            request.hdr.opcode = MavlinkFTP::kCmdBurstReadFile;
-            request.hdr.offset = _downloadOffset;
-            request.hdr.size = 0;
-            request.hdr.seqNumber = ++_lastOutgoingRequest.hdr.seqNumber;
-
-            _sendRequestNoAck(&request);
-        } else {
-            _sendRequestNoAck(&_lastOutgoingRequest);
-        }
-        return;
-    }
-#endif
-
-    // Make sure to set _currentOperation state before emitting error message. Code may respond
-    // to error message signal by sending another command, which will fail if state is not back
-    // to idle. FileView UI works this way with the List command.
 
-    switch (_waitState) {
-    case MavlinkFTP::kCmdOpenFileRO:
-    case MavlinkFTP::kCmdBurstReadFile:
-    case MavlinkFTP::kCmdReadFile:
-        _downloadComplete(tr("Download failed: Vehicle did not respond to %1").arg(MavlinkFTP::opCodeToString(_waitState)));
-        break;
-#if 0
-        // FIXME: NYI
-    case kCOOpenRead:
-    case kCOOpenBurst:
-        _currentOperation = kCOIdle;
-        _emitErrorMessage(tr("Timeout waiting for ack: Download failed"));
-        _sendResetCommand();
-        break;
-
-    case kCOCreate:
-        _currentOperation = kCOIdle;
-        _emitErrorMessage(tr("Timeout waiting for ack: Upload failed"));
-        _sendResetCommand();
-        break;
-
-    case kCOWrite:
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Timeout waiting for ack: Upload failed"));
-        break;
-#endif
-    default:
-    {
-        MavlinkFTP::OpCode_t    _lastCommand = _waitState;
-        _waitState = MavlinkFTP::kCmdNone;
-        _emitErrorMessage(QString("Timeout waiting for ack: Command failed (%1)").arg(MavlinkFTP::opCodeToString(_lastCommand)));
-    }
-        break;
-    }
-}
-
-void FTPManager::_sendResetCommand(void)
+void FTPManager::_fillRequestWithString(MavlinkFTP::Request* request, const QString& str)
 {
-    MavlinkFTP::Request request;
-    request.hdr.opcode  = MavlinkFTP::kCmdResetSessions;
-    request.hdr.size    = 0;
-    _waitState          = MavlinkFTP::kCmdResetSessions;
-    _sendRequestExpectAck(&request);
+    strncpy((char *)&request->data[0], str.toStdString().c_str(), sizeof(request->data));
+    request->hdr.size = static_cast<uint8_t>(strnlen((const char *)&request->data[0], sizeof(request->data)));
 }
 
 void FTPManager::_emitErrorMessage(const QString& msg)
@@ -828,35 +812,23 @@ void FTPManager::_emitListEntry(const QString& entry)
     emit listEntry(entry);
 }
 
-void FTPManager::_sendRequestExpectAck(MavlinkFTP::Request* request)
+void FTPManager::_sendRequest(Transfer_t* transfer, MavlinkFTP::Request* request)
 {
-    _ackTimer.start();
-    
-    request->hdr.seqNumber = ++_lastOutgoingRequest.hdr.seqNumber;
-    qCDebug(FTPManagerLog) << "_sendRequestExpectAck opcode:" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) << "seqNumber:" << request->hdr.seqNumber;
-
-    if (request->hdr.size <= sizeof(request->data)) {
-        memcpy(&_lastOutgoingRequest, request, sizeof(MavlinkFTP::RequestHeader) + request->hdr.size);
-    } else {
-        // FIXME: Shouldn't this fail something?
-        qCCritical(FTPManagerLog) << "request length too long:" << request->hdr.size;
-    }
-    
-    _sendRequestNoAck(request);
-}
+    // The server treats a request with the sequence number just before its last reply as a resend of the previous
+    // request and replays that reply. Always moving past every sequence number seen from the component, including
+    // each packet of a burst, keeps new requests from being mistaken for resends.
+    request->hdr.seqNumber = ++_seqNumbers[transfer->componentId];
 
-void FTPManager::_sendRequestNoAck(MavlinkFTP::Request* request)
-{
-    qCDebug(FTPManagerLog) << "_sendRequestNoAck opcode:" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode));
+    qCDebug(FTPManagerLog) << "_sendRequest opcode:" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) << "seqNumber:" << request->hdr.seqNumber << "offset:" << request->hdr.offset;
 
     mavlink_message_t message;
     mavlink_msg_file_transfer_protocol_pack_chan(qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
                                                  qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
-                                                 _dedicatedLink->mavlinkChannel(),
+                                                 transfer->link->mavlinkChannel(),
                                                  &message,
                                                  0,                                                     // Target network, 0=broadcast?
                                                  _vehicle->id(),
-                                                 MAV_COMP_ID_AUTOPILOT1,
+                                                 transfer->componentId,
                                                  (uint8_t*)request);                                    // Payload
-    _vehicle->sendMessageOnLinkThreadSafe(_dedicatedLink, message);
+    _vehicle->sendMessageOnLinkThreadSafe(transfer->link, message);
 }
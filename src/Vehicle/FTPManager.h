@@ -12,8 +12,10 @@
 
 #include <QObject>
 #include <QDir>
+#include <QFile>
 #include <QTimer>
-#include <QQueue>
+#include <QElapsedTimer>
+#include <QMap>
 
 #include "UASInterface.h"
 #include "QGCLoggingCategory.h"
@@ -23,128 +25,165 @@ Q_DECLARE_LOGGING_CATEGORY(FTPManagerLog)
 
 class Vehicle;
 
+/// MAVLink FTP client.
+///
+/// Each component runs its own FTP server which only supports a single session, so transfers are queued per component
+/// and transfers to different components run in parallel. Within a transfer several read or write requests are kept in
+/// flight. Requests are matched to their acks by session and offset, so a lost packet only costs a resend of that one
+/// request. Ranges of a download which have not arrived yet are tracked as a list of holes which are filled once the
+/// burst read reaches the end of the file.
 class FTPManager : public QObject
 {
     Q_OBJECT
-    
+
 public:
     FTPManager(Vehicle* vehicle);
+    ~FTPManager();
 
 	/// Downloads the specified file.
-    ///     @param from     File to download from vehicle, fully qualified path. May be in the format mavlinkftp://...
-    ///     @param toDir    Local directory to download file to
-    /// @return true: download has started, false: error, no download
-    /// Signals downloadComplete, commandError, commandProgress
-    bool download(const QString& from, const QString& toDir);
-	
-	/// Stream downloads the specified file.
-    ///     @param from     File to download from UAS, fully qualified path. May be in the format mavlinkftp://...
-    ///     @param toDir    Local directory to download file to
-    /// @return true: download has started, false: error, no download
-    /// Signals downloadComplete, commandError, commandProgress
-    bool burstDownload(const QString& from, const QString& toDir);
-	
-	/// Lists the specified directory. Emits listEntry signal for each entry, followed by listComplete signal.
+    ///     @param from         File to download from vehicle, fully qualified path. May be in the format mavlinkftp://...
+    ///     @param toDir        Local directory to download file to
+    ///     @param componentId  Component to download from
+    /// @return true: download has been queued, false: error, no download
+    /// Signals downloadComplete, commandProgress
+    bool download(const QString& from, const QString& toDir, uint8_t componentId = MAV_COMP_ID_AUTOPILOT1);
+
+	/// Directory listing is not supported by the transfer queues, emits commandError
 	///		@param dirPath Fully qualified path to list
 	void listDirectory(const QString& dirPath);
-	
+
     /// Upload the specified file to the specified location
-    void upload(const QString& toPath, const QFileInfo& uploadFile);
-    
+    ///     @param toPath       Directory on the vehicle to upload to, fully qualified path
+    ///     @param uploadFile   Local file to upload
+    ///     @param componentId  Component to upload to
+    /// @return true: upload has been queued, false: error, no upload
+    /// Signals uploadComplete, commandProgress
+    bool upload(const QString& toPath, const QFileInfo& uploadFile, uint8_t componentId = MAV_COMP_ID_AUTOPILOT1);
+
     /// Create a remote directory
     void createDirectory(const QString& directory);
 
+    /// @return Number of transfers which are queued or in progress
+    int transferCount(void) const;
+
     void mavlinkMessageReceived(mavlink_message_t message);
 
 signals:
-    void downloadComplete   (const QString& file, const QString& errorMsg);
-    void uploadComplete     (const QString& errorMsg);
+    /// Signalled when a download finishes, successfully or not
+    ///     @param componentId  Component downloaded from
+    ///     @param remotePath   Path exactly as passed to download, so the caller can match it to its request
+    ///     @param file         Local file the download was written to
+    ///     @param errorMsg     Empty for success
+    void downloadComplete   (uint8_t componentId, const QString& remotePath, const QString& file, const QString& errorMsg);
+
+    /// Signalled when an upload finishes, successfully or not
+    ///     @param componentId  Component uploaded to
+    ///     @param remotePath   Fully qualified path of the file written on the vehicle
+    ///     @param file         Local file which was uploaded
+    ///     @param errorMsg     Empty for success
+    void uploadComplete     (uint8_t componentId, const QString& remotePath, const QString& file, const QString& errorMsg);
 
     /// Signalled to indicate a new directory entry was received.
     void listEntry(const QString& entry);
-    
+
     // Signals associated with all commands
-    
+
     /// Signalled after a command has completed
     void commandComplete(void);
-    
+
     void commandError(const QString& msg);
-    
+
     /// Signalled during a lengthy command to show progress
     ///     @param value Amount of progress: 0.0 = none, 1.0 = complete
     void commandProgress(int value);
-	
+
 private slots:
-	void _ackTimeout(void);
+	void _checkTimeouts(void);
 
 private:
-    bool    _sendOpcodeOnlyCmd      (MavlinkFTP::OpCode_t opcode, MavlinkFTP::OpCode_t newWaitState);
-    void    _emitErrorMessage       (const QString& msg);
-    void    _emitListEntry          (const QString& entry);
-    void    _sendRequestExpectAck   (MavlinkFTP::Request* request);
-    void    _sendRequestNoAck       (MavlinkFTP::Request* request);
-    void    _sendMessageOnLink      (LinkInterface* link, mavlink_message_t message);
-    void    _fillRequestWithString  (MavlinkFTP::Request* request, const QString& str);
-    void    _handlOpenFileROAck     (MavlinkFTP::Request* ack);
-    void    _handleReadFileAck      (MavlinkFTP::Request* ack);
-    void    _handleBurstReadFileAck (MavlinkFTP::Request* ack);
-    void    _listAckResponse        (MavlinkFTP::Request* listAck);
-    void    _createAckResponse      (MavlinkFTP::Request* createAck);
-    void    _writeAckResponse       (MavlinkFTP::Request* writeAck);
-    void    _writeFileDatablock     (void);
-    void    _sendListCommand        (void);
-    void    _sendResetCommand       (void);
-    void    _downloadComplete       (const QString& errorMsg);
-    void    _uploadComplete         (const QString& errorMsg);
-    bool    _downloadWorker         (const QString& from, const QString& toDir);
-    void    _requestMissingBurstData(void);
-    void    _handleAck              (MavlinkFTP::Request* ack);
-    void    _handleNak              (MavlinkFTP::Request* nak);
-
-    MavlinkFTP::OpCode_t    _waitState              = MavlinkFTP::kCmdNone;     ///< Current operation of state machine
-    QTimer                  _ackTimer;                                          ///< Used to signal a timeout waiting for an ack
-    int                     _ackNumTries;                                       ///< current number of tries
-    Vehicle*                _vehicle;
-    LinkInterface*          _dedicatedLink          = nullptr;                  ///< Link to use for communication
-    MavlinkFTP::Request     _lastOutgoingRequest;                               ///< contains the last outgoing packet
-    unsigned                _listOffset;                                        ///< offset for the current List operation
-    QString                 _listPath;                                          ///< path for the current List operation
-    uint8_t                 _activeSession          = 0;                        ///< currently active session, 0 for none
-    uint32_t                _readOffset;                                        ///< current read offset
-    
-    uint32_t    _writeOffset;               ///< current write offset
-    uint32_t    _writeSize;                 ///< current write data size
-    uint32_t    _writeFileSize;             ///< Size of file being uploaded
-    QByteArray  _writeFileAccumulator;      ///< Holds file being uploaded
-    
     typedef struct  {
         uint32_t offset;
         uint32_t cBytes;
     } MissingData_t;
 
-    struct {
-        uint32_t                expectedBurstOffset;    ///< offset which should be coming next in a burst sequence
-        uint32_t                expectedReadOffset;     ///< offset which should be coming from a hole filling read request
-        uint32_t                bytesWritten;
-        QList<MissingData_t>    missingData;
-        QDir                    toDir;                  ///< Directory to download file to
-        QString                 fileName;               ///< Filename (no path) for download file
-        uint32_t                fileSize;               ///< Size of file being downloaded
-        QFile                   file;
-        int                     retryCount;
-
-        void reset() {
-            expectedBurstOffset = 0;
-            expectedReadOffset  = 0;
-            bytesWritten        = 0;
-            retryCount          = 0;
-            missingData.clear();
-            file.close();
-        }
-    } _downloadState;
-
-    static const int _ackTimerTimeoutMsecs  = 1000;
-    static const int _ackTimerMaxRetries    = 6;
-    static const int _maxRetry              = 5;
+    /// A read or write request waiting for its ack
+    typedef struct {
+        uint32_t    cBytes;
+        qint64      sentMSecs;
+        int         retryCount;
+    } Outstanding_t;
+
+    typedef enum {
+        TransferStateOpening,       ///< Waiting for the session to open
+        TransferStateBurst,         ///< Burst reading towards the end of the file
+        TransferStateWindowed,      ///< Windowed reads of the holes left by the bursts, or windowed writes
+        TransferStateClosing,       ///< Waiting for the session to close
+    } TransferState_t;
+
+    typedef struct Transfer_s {
+        bool                            upload          = false;
+        uint8_t                         componentId     = MAV_COMP_ID_AUTOPILOT1;
+        LinkInterface*                  link            = nullptr;
+        TransferState_t                 state           = TransferStateOpening;
+        uint8_t                         session         = 0;
+        bool                            sessionOpen     = false;
+        QString                         remotePath;                 ///< Path sent to the server
+        QString                         requestedPath;              ///< Remote path reported by the complete signals
+        QString                         localPath;
+        QFile                           file;                       ///< Download file
+        uchar*                          map             = nullptr;  ///< Download file mapped into memory, nullptr if mapping failed
+        QByteArray                      uploadData;
+        uint32_t                        fileSize        = 0;
+        uint32_t                        bytesDone       = 0;
+        uint32_t                        burstOffset     = 0;        ///< Offset the next burst packet is expected at
+        qint64                          requestMSecs    = 0;        ///< Time the open, burst or close request was sent, or the last burst packet arrived
+        int                             retryCount      = 0;        ///< Retries of the current open, burst or close request
+        QList<MissingData_t>            missingData;                ///< Ranges not yet transferred and not in flight, sorted by offset
+        QMap<uint32_t, Outstanding_t>   outstanding;                ///< Windowed requests in flight, by offset
+        int                             window          = 0;        ///< Maximum number of windowed requests in flight
+        int                             progress        = -1;
+        QString                         errorMsg;
+        QElapsedTimer                   elapsed;
+    } Transfer_t;
+
+    void        _emitErrorMessage       (const QString& msg);
+    void        _emitListEntry          (const QString& entry);
+    void        _fillRequestWithString  (MavlinkFTP::Request* request, const QString& str);
+    void        _listAckResponse        (MavlinkFTP::Request* listAck);
+    QString     _stripFTPPrefix         (const QString& path);
+    void        _queueTransfer          (Transfer_t* transfer);
+    void        _startTransfer          (Transfer_t* transfer);
+    void        _sendOpen               (Transfer_t* transfer);
+    void        _sendBurst              (Transfer_t* transfer);
+    void        _sendClose              (Transfer_t* transfer);
+    void        _sendRequest            (Transfer_t* transfer, MavlinkFTP::Request* request);
+    void        _fillWindow             (Transfer_t* transfer);
+    void        _sendWindowedRequest    (Transfer_t* transfer, uint32_t offset, uint32_t cBytes);
+    void        _handleOpenAck          (Transfer_t* transfer, MavlinkFTP::Request* ack);
+    void        _handleDataAck          (Transfer_t* transfer, MavlinkFTP::Request* ack);
+    void        _handleWriteAck         (Transfer_t* transfer, MavlinkFTP::Request* ack);
+    void        _handleNak              (Transfer_t* transfer, MavlinkFTP::Request* nak);
+    bool        _storeData              (Transfer_t* transfer, uint32_t offset, const uint8_t* data, uint32_t cBytes);
+    void        _endBurst               (Transfer_t* transfer);
+    void        _checkTransferDone      (Transfer_t* transfer);
+    void        _finishTransfer         (Transfer_t* transfer, const QString& errorMsg);
+    void        _transferComplete       (Transfer_t* transfer);
+    void        _updateProgress         (Transfer_t* transfer);
+    Transfer_t* _activeTransfer         (uint8_t componentId);
+
+    static void _addMissingData         (QList<MissingData_t>& missingData, uint32_t offset, uint32_t cBytes);
+    static uint32_t _removeMissingData  (QList<MissingData_t>& missingData, uint32_t offset, uint32_t cBytes);
+
+    Vehicle*                            _vehicle;
+    QMap<uint8_t, QList<Transfer_t*>>   _transferQueues;            ///< Queued transfers by component, the first one is active
+    QMap<uint8_t, uint16_t>             _seqNumbers;                ///< Last sequence number seen to or from each component
+    QTimer                              _timeoutTimer;
+    QElapsedTimer                       _clock;
+    int                                 _ackTimeoutMSecs;
+
+    static const int _ackTimeoutMSecsDefault    = 1000;
+    static const int _ackTimeoutMSecsUnitTest   = 50;
+    static const int _maxRetry                  = 5;
+    static const int _initialWindow             = 4;
+    static const int _maxWindow                 = 16;
 };
-
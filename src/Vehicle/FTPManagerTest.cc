@@ -13,6 +13,8 @@
 #include "MockLink.h"
 #include "FTPManager.h"
 
+#include <QElapsedTimer>
+
 const FTPManagerTest::TestCase_t FTPManagerTest::_rgTestCases[] = {
     {  "/version.json" },
 };
@@ -27,14 +29,16 @@ void FTPManagerTest::_testCaseWorker(const TestCase_t& testCase)
 
     QSignalSpy spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
 
-    // void downloadComplete   (const QString& file, const QString& errorMsg);
+    // void downloadComplete   (uint8_t componentId, const QString& remotePath, const QString& file, const QString& errorMsg);
     ftpManager->download(testCase.file, QStandardPaths::writableLocation(QStandardPaths::TempLocation));
 
     QCOMPARE(spyDownloadComplete.wait(10000), true);
     QCOMPARE(spyDownloadComplete.count(), 1);
     QList<QVariant> arguments = spyDownloadComplete.takeFirst();
-    qDebug() << arguments[0].toString();
-    QVERIFY(arguments[1].toString().isEmpty());
+    qDebug() << arguments[2].toString();
+    QCOMPARE(arguments[0].toUInt(), static_cast<uint>(MAV_COMP_ID_AUTOPILOT1));
+    QCOMPARE(arguments[1].toString(), QString(testCase.file));
+    QVERIFY(arguments[3].toString().isEmpty());
 
     _disconnectMockLink();
 }
@@ -53,11 +57,11 @@ void FTPManagerTest::_sizeTestCaseWorker(int fileSize)
     QCOMPARE(spyDownloadComplete.wait(10000), true);
     QCOMPARE(spyDownloadComplete.count(), 1);
 
-    // void downloadComplete   (const QString& file, const QString& errorMsg);
+    // void downloadComplete   (uint8_t componentId, const QString& remotePath, const QString& file, const QString& errorMsg);
     QList<QVariant> arguments = spyDownloadComplete.takeFirst();
-    QVERIFY(arguments[1].toString().isEmpty());
+    QVERIFY(arguments[3].toString().isEmpty());
 
-    _verifyFileSizeAndDelete(arguments[0].toString(), fileSize);
+    _verifyFileSizeAndDelete(arguments[2].toString(), fileSize);
 
     _disconnectMockLink();
 }
@@ -106,11 +110,189 @@ void FTPManagerTest::_testLostPackets(void)
     QCOMPARE(spyDownloadComplete.wait(10000), true);
     QCOMPARE(spyDownloadComplete.count(), 1);
 
-    // void downloadComplete   (const QString& file, const QString& errorMsg);
+    // void downloadComplete   (uint8_t componentId, const QString& remotePath, const QString& file, const QString& errorMsg);
     QList<QVariant> arguments = spyDownloadComplete.takeFirst();
-    QVERIFY(arguments[1].toString().isEmpty());
+    QVERIFY(arguments[3].toString().isEmpty());
+
+    _verifyFileSizeAndDelete(arguments[2].toString(), fileSize);
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::_testParallelDownloads(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    QString     toDir       = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    QString     filename1   = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(3 * 1024);
+    QString     filename2   = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(2 * 1024);
+    QString     filename3   = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(1024);
+
+    QSignalSpy spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
+
+    // Autopilot and camera run in parallel, the second autopilot download waits for the first
+    QVERIFY(ftpManager->download(filename1, toDir));
+    QVERIFY(ftpManager->download(filename2, toDir, MAV_COMP_ID_CAMERA));
+    QVERIFY(ftpManager->download(filename3, toDir));
+    QCOMPARE(ftpManager->transferCount(), 3);
+
+    while (spyDownloadComplete.count() < 3) {
+        QVERIFY(spyDownloadComplete.wait(10000));
+    }
+    QCOMPARE(ftpManager->transferCount(), 0);
+
+    QMap<QString, int> expectedSizes;
+    expectedSizes[QDir(toDir).absoluteFilePath(filename1)] = 3 * 1024;
+    expectedSizes[QDir(toDir).absoluteFilePath(filename2)] = 2 * 1024;
+    expectedSizes[QDir(toDir).absoluteFilePath(filename3)] = 1024;
+
+    QMap<QString, uint> expectedComponents;
+    expectedComponents[filename1] = MAV_COMP_ID_AUTOPILOT1;
+    expectedComponents[filename2] = MAV_COMP_ID_CAMERA;
+    expectedComponents[filename3] = MAV_COMP_ID_AUTOPILOT1;
+
+    // void downloadComplete   (uint8_t componentId, const QString& remotePath, const QString& file, const QString& errorMsg);
+    for (const QList<QVariant>& arguments: spyDownloadComplete) {
+        QVERIFY(arguments[3].toString().isEmpty());
+        QString remotePath = arguments[1].toString();
+        QVERIFY(expectedComponents.contains(remotePath));
+        QCOMPARE(arguments[0].toUInt(), expectedComponents.take(remotePath));
+        QString file = arguments[2].toString();
+        QVERIFY(expectedSizes.contains(file));
+        _verifyFileSizeAndDelete(file, expectedSizes.take(file));
+    }
+
+    _disconnectMockLink();
+}
+
+QString FTPManagerTest::_createUploadFile(int fileSize)
+{
+    QFile file(QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath(QStringLiteral("FTPManagerTestUpload-%1").arg(fileSize)));
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return QString();
+    }
+    for (int i=0; i<fileSize; i++) {
+        file.write(QByteArray(1, i % 255));
+    }
+    file.close();
+    return file.fileName();
+}
+
+void FTPManagerTest::_testUpload(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    int         fileSize    = 5 * 1024 + 7;
+    QString     localFile   = _createUploadFile(fileSize);
+    QVERIFY(!localFile.isEmpty());
+
+    QSignalSpy spyUploadComplete(ftpManager, &FTPManager::uploadComplete);
+
+    QFileInfo fileInfo(localFile);
+    QVERIFY(ftpManager->upload("/fs/microsd", fileInfo));
+    QCOMPARE(spyUploadComplete.wait(10000), true);
+    QCOMPARE(spyUploadComplete.count(), 1);
+
+    // void uploadComplete     (uint8_t componentId, const QString& remotePath, const QString& file, const QString& errorMsg);
+    QList<QVariant> arguments   = spyUploadComplete.takeFirst();
+    QString         remotePath  = QStringLiteral("/fs/microsd/") + fileInfo.fileName();
+    QVERIFY(arguments[3].toString().isEmpty());
+    QCOMPARE(arguments[0].toUInt(), static_cast<uint>(MAV_COMP_ID_AUTOPILOT1));
+    QCOMPARE(arguments[1].toString(), remotePath);
+    QCOMPARE(arguments[2].toString(), fileInfo.absoluteFilePath());
+
+    QFile file(localFile);
+    QVERIFY(file.open(QFile::ReadOnly));
+    QCOMPARE(_mockLink->mockLinkFTP()->uploadedFile(remotePath), file.readAll());
+    file.close();
+    file.remove();
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::_testEmptyUpload(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    QString     localFile   = _createUploadFile(0);
+    QVERIFY(!localFile.isEmpty());
+
+    QSignalSpy spyUploadComplete(ftpManager, &FTPManager::uploadComplete);
+
+    QFileInfo fileInfo(localFile);
+    QVERIFY(ftpManager->upload("/fs/microsd", fileInfo));
+    QCOMPARE(spyUploadComplete.wait(10000), true);
+    QCOMPARE(spyUploadComplete.count(), 1);
+
+    // void uploadComplete     (uint8_t componentId, const QString& remotePath, const QString& file, const QString& errorMsg);
+    QList<QVariant> arguments   = spyUploadComplete.takeFirst();
+    QString         remotePath  = QStringLiteral("/fs/microsd/") + fileInfo.fileName();
+    QVERIFY(arguments[3].toString().isEmpty());
+    QCOMPARE(arguments[1].toString(), remotePath);
+    QVERIFY(_mockLink->mockLinkFTP()->hasUploadedFile(remotePath));
+    QVERIFY(_mockLink->mockLinkFTP()->uploadedFile(remotePath).isEmpty());
+    QCOMPARE(ftpManager->transferCount(), 0);
+
+    QFile::remove(localFile);
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::_testLossyThroughput(void)
+{
+    // Transfers must still complete intact and in bounded time at increasing loss rates. Run with FTPManagerLog
+    // enabled to see the throughput numbers.
+    const QList<int> rgDropPercents = { 0, 5, 10, 20 };
+    int fileSize = 16 * 1024;
+
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    QString     filename    = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(fileSize);
+    QString     localFile   = _createUploadFile(fileSize);
+    QVERIFY(!localFile.isEmpty());
+
+    QFile file(localFile);
+    QVERIFY(file.open(QFile::ReadOnly));
+    QByteArray localBytes = file.readAll();
+    file.close();
+
+    QSignalSpy spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
+    QSignalSpy spyUploadComplete(ftpManager, &FTPManager::uploadComplete);
+
+    for (int dropPercent: rgDropPercents) {
+        _mockLink->mockLinkFTP()->setRandomDropsPercent(dropPercent);
+
+        QElapsedTimer elapsed;
+        elapsed.start();
+        QVERIFY(ftpManager->download(filename, QStandardPaths::writableLocation(QStandardPaths::TempLocation)));
+        QCOMPARE(spyDownloadComplete.wait(10000), true);
+        qint64 downloadMSecs = qMax(elapsed.restart(), static_cast<qint64>(1));
+        QVERIFY2(downloadMSecs <= _maxLossyTransferMSecs, qPrintable(QStringLiteral("Download at %1% drops took %2 ms").arg(dropPercent).arg(downloadMSecs)));
+
+        QList<QVariant> arguments = spyDownloadComplete.takeFirst();
+        QVERIFY(arguments[3].toString().isEmpty());
+        _verifyFileSizeAndDelete(arguments[2].toString(), fileSize);
+
+        elapsed.restart();
+        QVERIFY(ftpManager->upload("/fs/microsd", QFileInfo(localFile)));
+        QCOMPARE(spyUploadComplete.wait(10000), true);
+        qint64 uploadMSecs = qMax(elapsed.elapsed(), static_cast<qint64>(1));
+        QVERIFY2(uploadMSecs <= _maxLossyTransferMSecs, qPrintable(QStringLiteral("Upload at %1% drops took %2 ms").arg(dropPercent).arg(uploadMSecs)));
+
+        arguments = spyUploadComplete.takeFirst();
+        QVERIFY(arguments[3].toString().isEmpty());
+        QCOMPARE(_mockLink->mockLinkFTP()->uploadedFile(arguments[1].toString()), localBytes);
+
+        qCDebug(FTPManagerLog) << "Drop percent" << dropPercent
+                 << "download bytes/sec" << fileSize * 1000 / downloadMSecs
+                 << "upload bytes/sec" << fileSize * 1000 / uploadMSecs;
+    }
 
-    _verifyFileSizeAndDelete(arguments[0].toString(), fileSize);
+    QFile::remove(localFile);
 
     _disconnectMockLink();
 }
@@ -19,6 +19,10 @@ private slots:
     void _performSizeBasedTestCases (void);
     void _performTestCases          (void);
     void _testLostPackets           (void);
+    void _testParallelDownloads     (void);
+    void _testUpload                (void);
+    void _testEmptyUpload           (void);
+    void _testLossyThroughput       (void);
 
 private:
     typedef struct {
@@ -28,6 +32,8 @@ private:
     void _testCaseWorker            (const TestCase_t& testCase);
     void _sizeTestCaseWorker        (int fileSize);
     void _verifyFileSizeAndDelete   (const QString& filename, int expectedSize);
+    QString _createUploadFile       (int fileSize);
 
     static const TestCase_t _rgTestCases[];
+    static const int        _maxLossyTransferMSecs = 5000;  ///< 16KB transfer at up to 20% drops, unit test ack timeouts
 };
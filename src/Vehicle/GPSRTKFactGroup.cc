@@ -18,6 +18,8 @@ const char* GPSRTKFactGroup::_currentAltitudeFactName =          "currentAltitud
 const char* GPSRTKFactGroup::_validFactName =                    "valid";
 const char* GPSRTKFactGroup::_activeFactName =                   "active";
 const char* GPSRTKFactGroup::_numSatellitesFactName =            "numSatellites";
+const char* GPSRTKFactGroup::_rtcmDataRateFactName =             "rtcmDataRate";
+const char* GPSRTKFactGroup::_rtcmLatencyFactName =              "rtcmLatency";
 
 GPSRTKFactGroup::GPSRTKFactGroup(QObject* parent)
     : FactGroup             (1000, ":/json/Vehicle/GPSRTKFact.json", parent)
@@ -30,6 +32,8 @@ GPSRTKFactGroup::GPSRTKFactGroup(QObject* parent)
     , _valid                (0, _validFactName,             FactMetaData::valueTypeBool)
     , _active               (0, _activeFactName,            FactMetaData::valueTypeBool)
     , _numSatellites        (0, _numSatellitesFactName,     FactMetaData::valueTypeInt32)
+    , _rtcmDataRate         (0, _rtcmDataRateFactName,      FactMetaData::valueTypeDouble)
+    , _rtcmLatency          (0, _rtcmLatencyFactName,       FactMetaData::valueTypeDouble)
 {
     _addFact(&_connected,          _connectedFactName);
     _addFact(&_currentDuration,    _currentDurationFactName);
@@ -40,5 +44,7 @@ GPSRTKFactGroup::GPSRTKFactGroup(QObject* parent)
     _addFact(&_valid,              _validFactName);
     _addFact(&_active,             _activeFactName);
     _addFact(&_numSatellites,      _numSatellitesFactName);
+    _addFact(&_rtcmDataRate,       _rtcmDataRateFactName);
+    _addFact(&_rtcmLatency,        _rtcmLatencyFactName);
 }
 
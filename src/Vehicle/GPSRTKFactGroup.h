@@ -28,6 +28,8 @@ public:
     Q_PROPERTY(Fact* valid                READ valid                CONSTANT)
     Q_PROPERTY(Fact* active               READ active               CONSTANT)
     Q_PROPERTY(Fact* numSatellites        READ numSatellites        CONSTANT)
+    Q_PROPERTY(Fact* rtcmDataRate         READ rtcmDataRate         CONSTANT)
+    Q_PROPERTY(Fact* rtcmLatency          READ rtcmLatency          CONSTANT)
 
     Fact* connected         (void) { return &_connected; }
     Fact* currentDuration   (void) { return &_currentDuration; }
@@ -38,6 +40,8 @@ public:
     Fact* valid             (void) { return &_valid; }
     Fact* active            (void) { return &_active; }
     Fact* numSatellites     (void) { return &_numSatellites; }
+    Fact* rtcmDataRate      (void) { return &_rtcmDataRate; }
+    Fact* rtcmLatency       (void) { return &_rtcmLatency; }
 
     static const char* _connectedFactName;
     static const char* _currentDurationFactName;
@@ -48,6 +52,8 @@ public:
     static const char* _validFactName;
     static const char* _activeFactName;
     static const char* _numSatellitesFactName;
+    static const char* _rtcmDataRateFactName;
+    static const char* _rtcmLatencyFactName;
 
 private:
     Fact _connected;        ///< is an RTK gps connected?
@@ -59,4 +65,6 @@ private:
     Fact _valid;            ///< survey-in complete?
     Fact _active;           ///< survey-in active?
     Fact _numSatellites;    ///< number of satellites
+    Fact _rtcmDataRate;     ///< RTCM corrections forwarded to the vehicles in [kB/s]
+    Fact _rtcmLatency;      ///< time from receiving RTCM to writing it to the links in [ms]
 };
@@ -10,11 +10,89 @@
 #include "TrajectoryPoints.h"
 #include "Vehicle.h"
 
+#include <QDateTime>
+#include <QtMath>
+
+const double TrajectoryPoints::_levelTolerances[TrajectoryPoints::_levelCount] = { 0.5, 2.0, 8.0, 32.0, 128.0 };
+
+// Paths are short between points, so distances are worked out on a flat projection around the points
+static const double kMetersPerDegree = 111319.5;
+
 TrajectoryPoints::TrajectoryPoints(Vehicle* vehicle, QObject* parent)
-    : QObject       (parent)
-    , _vehicle      (vehicle)
-    , _lastAzimuth  (qQNaN())
+    : QObject           (parent)
+    , _vehicle          (vehicle)
+    , _zoomLevel        (qQNaN())
+    , _levelOfDetail    (0)
+{
+}
+
+QGeoCoordinate TrajectoryPoints::_coordinate(int index) const
+{
+    return QGeoCoordinate(_latitudes[index], _longitudes[index], static_cast<double>(_altitudes[index]));
+}
+
+/// @return Shortest longitude difference from longitude1 to longitude2, across the antimeridian if that is shorter
+double TrajectoryPoints::_longitudeDelta(double longitude1, double longitude2)
+{
+    double delta = longitude2 - longitude1;
+    if (delta > 180.0) {
+        delta -= 360.0;
+    } else if (delta < -180.0) {
+        delta += 360.0;
+    }
+    return delta;
+}
+
+double TrajectoryPoints::_distance(double latitude1, double longitude1, double latitude2, double longitude2) const
+{
+    double x = _longitudeDelta(longitude1, longitude2) * kMetersPerDegree * qCos(qDegreesToRadians(latitude1));
+    double y = (latitude2 - latitude1) * kMetersPerDegree;
+    return qSqrt(x * x + y * y);
+}
+
+/// @return Distance in meters from the segment first->last of the point furthest from it between first and last
+double TrajectoryPoints::_segmentError(int first, int last) const
 {
+    double lonScale         = kMetersPerDegree * qCos(qDegreesToRadians(_latitudes[first]));
+    double segmentX         = _longitudeDelta(_longitudes[first], _longitudes[last]) * lonScale;
+    double segmentY         = (_latitudes[last] - _latitudes[first]) * kMetersPerDegree;
+    double lengthSquared    = segmentX * segmentX + segmentY * segmentY;
+    double maxErrorSquared  = 0;
+
+    for (int i = first + 1; i < last; i++) {
+        double x = _longitudeDelta(_longitudes[first], _longitudes[i]) * lonScale;
+        double y = (_latitudes[i] - _latitudes[first]) * kMetersPerDegree;
+        double t = lengthSquared > 0 ? qBound(0.0, (x * segmentX + y * segmentY) / lengthSquared, 1.0) : 0.0;
+        x -= t * segmentX;
+        y -= t * segmentY;
+        maxErrorSquared = qMax(maxErrorSquared, x * x + y * y);
+    }
+
+    return qSqrt(maxErrorSquared);
+}
+
+void TrajectoryPoints::_addToLevel(int level, int index)
+{
+    QVector<int>&   indices = _levels[level];
+    bool            visible = level == _levelOfDetail;
+
+    if (indices.count() >= 2) {
+        int first = indices[indices.count() - 2];
+        if (index - first <= _maxSegmentPoints && _segmentError(first, index) <= _levelTolerances[level]) {
+            // Everything the last segment skips is still close to it, just move its end to the new point
+            indices.last() = index;
+            if (visible) {
+                emit updateLastPoint(_coordinate(index));
+            }
+            return;
+        }
+    }
+
+    // The end of the last segment is fixed where it is, and a new segment is started
+    indices.append(index);
+    if (visible) {
+        emit pointAdded(_coordinate(index));
+    }
 }
 
 void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
@@ -22,32 +100,58 @@ void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
     // The goal of this algorithm is to limit the number of trajectory points whic represent the vehicle path.
     // Fewer points means higher performance of map display.
 
-    if (_lastPoint.isValid()) {
-        double distance = _lastPoint.distanceTo(coordinate);
-        if (distance > _distanceTolerance) {
-            //-- Update flight distance
-            _vehicle->updateFlightDistance(distance);
-            // Vehicle has moved far enough from previous point for an update
-            double newAzimuth = _lastPoint.azimuthTo(coordinate);
-            if (qIsNaN(_lastAzimuth) || qAbs(newAzimuth - _lastAzimuth) > _azimuthTolerance) {
-                // The new position IS NOT colinear with the last segment. Append the new position to the list.
-                _lastAzimuth = _lastPoint.azimuthTo(coordinate);
-                _lastPoint = coordinate;
-                _points.append(QVariant::fromValue(coordinate));
-                emit pointAdded(coordinate);
-            } else {
-                // The new position IS colinear with the last segment. Don't add a new point, just update
-                // the last point to be the new position.
-                _lastPoint = coordinate;
-                _points[_points.count() - 1] = QVariant::fromValue(coordinate);
-                emit updateLastPoint(coordinate);
-            }
+    if (!_latitudes.isEmpty()) {
+        double distance = _distance(_latitudes.last(), _longitudes.last(), coordinate.latitude(), coordinate.longitude());
+        if (distance <= _distanceTolerance) {
+            return;
         }
-    } else {
-        // Add the very first trajectory point to the list
-        _lastPoint = coordinate;
-        _points.append(QVariant::fromValue(coordinate));
-        emit pointAdded(coordinate);
+        //-- Update flight distance
+        _vehicle->updateFlightDistance(distance);
+    }
+
+    _latitudes.append(coordinate.latitude());
+    _longitudes.append(coordinate.longitude());
+    _altitudes.append(static_cast<float>(coordinate.altitude()));
+    _timestamps.append(QDateTime::currentMSecsSinceEpoch());
+
+    int index = _latitudes.count() - 1;
+    for (int level = 0; level < _levelCount; level++) {
+        _addToLevel(level, index);
+    }
+}
+
+QVariantList TrajectoryPoints::list(void) const
+{
+    QVariantList points;
+
+    const QVector<int>& indices = _levels[_levelOfDetail];
+    points.reserve(indices.count());
+    for (int index: indices) {
+        points.append(QVariant::fromValue(_coordinate(index)));
+    }
+
+    return points;
+}
+
+void TrajectoryPoints::setZoomLevel(double zoomLevel)
+{
+    if (zoomLevel == _zoomLevel) {
+        return;
+    }
+    _zoomLevel = zoomLevel;
+    emit zoomLevelChanged(zoomLevel);
+
+    // Coarsest level of detail whose tolerance is still within a pixel at this zoom level
+    double  latitude        = _latitudes.isEmpty() ? 0 : _latitudes.last();
+    double  metersPerPixel  = 156543.03392 * qCos(qDegreesToRadians(latitude)) / qPow(2.0, zoomLevel);
+    int     levelOfDetail   = 0;
+    while (levelOfDetail + 1 < _levelCount && _levelTolerances[levelOfDetail + 1] <= metersPerPixel) {
+        levelOfDetail++;
+    }
+
+    if (levelOfDetail != _levelOfDetail) {
+        _levelOfDetail = levelOfDetail;
+        emit levelOfDetailChanged();
     }
 }
 
@@ -59,14 +163,18 @@ void TrajectoryPoints::start(void)
 
 void TrajectoryPoints::stop(void)
 {
-    qDebug() << "Stop" << _points.count();
+    qCDebug(VehicleLog) << "Trajectory stopped points:displayed" << _latitudes.count() << _levels[_levelOfDetail].count();
     disconnect(_vehicle, &Vehicle::coordinateChanged, this, &TrajectoryPoints::_vehicleCoordinateChanged);
 }
 
 void TrajectoryPoints::clear(void)
 {
-    _points.clear();
-    _lastPoint = QGeoCoordinate();
-    _lastAzimuth = qQNaN();
+    _latitudes.clear();
+    _longitudes.clear();
+    _altitudes.clear();
+    _timestamps.clear();
+    for (int level = 0; level < _levelCount; level++) {
+        _levels[level].clear();
+    }
     emit pointsCleared();
 }
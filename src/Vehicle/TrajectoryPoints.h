@@ -12,9 +12,15 @@
 #include "QmlObjectListModel.h"
 
 #include <QGeoCoordinate>
+#include <QVector>
 
 class Vehicle;
 
+/// Flown path of a vehicle.
+///
+/// The full resolution track is stored as columns of plain values. On top of it each level of detail keeps the indices
+/// of the points it needs, simplified as points arrive so that no point skipped by a level is further than the level's
+/// tolerance from the path it shows. The map only sees the level of detail which fits its zoom level.
 class TrajectoryPoints : public QObject
 {
     Q_OBJECT
@@ -22,7 +28,18 @@ class TrajectoryPoints : public QObject
 public:
     TrajectoryPoints(Vehicle* vehicle, QObject* parent = nullptr);
 
-    Q_INVOKABLE QVariantList list(void) const { return _points; }
+    /// Zoom level of the map showing the path, selects the level of detail for list() and the point signals
+    Q_PROPERTY(double zoomLevel READ zoomLevel WRITE setZoomLevel NOTIFY zoomLevelChanged)
+
+    /// @return Path at the current level of detail
+    Q_INVOKABLE QVariantList list(void) const;
+
+    double  zoomLevel       (void) const { return _zoomLevel; }
+    int     levelOfDetail   (void) const { return _levelOfDetail; }
+    int     count           (void) const { return _latitudes.count(); }     ///< Points in the full resolution track
+    qint64  timestamp       (int index) const { return _timestamps[index]; } ///< msecs since epoch of a full resolution track point
+
+    void    setZoomLevel    (double zoomLevel);
 
     void start  (void);
     void stop   (void);
@@ -31,19 +48,43 @@ public slots:
     void clear  (void);
 
 signals:
-    void pointAdded     (QGeoCoordinate coordinate);
-    void updateLastPoint(QGeoCoordinate coordinate);
-    void pointsCleared  (void);
+    // Point signals follow the current level of detail
+    void pointAdded             (QGeoCoordinate coordinate);
+    void updateLastPoint        (QGeoCoordinate coordinate);
+    void pointsCleared          (void);
+    void levelOfDetailChanged   (void);     ///< Path must be reloaded using list()
+    void zoomLevelChanged       (double zoomLevel);
 
 private slots:
     void _vehicleCoordinateChanged(QGeoCoordinate coordinate);
 
 private:
+    static const int        _levelCount = 5;
+    static const double     _levelTolerances[_levelCount];  ///< Meters
+    static const int        _maxSegmentPoints = 64;         ///< Points the last segment of a level can skip before it is fixed
+    static constexpr double _distanceTolerance = 2.0;
+
+    QGeoCoordinate  _coordinate     (int index) const;
+    void            _addToLevel     (int level, int index);
+    double          _segmentError   (int first, int last) const;
+    double          _distance       (double latitude1, double longitude1, double latitude2, double longitude2) const;
+
+    static double   _longitudeDelta (double longitude1, double longitude2);
+
     Vehicle*        _vehicle;
-    QVariantList    _points;
-    QGeoCoordinate  _lastPoint;
-    double          _lastAzimuth;
 
-    static constexpr double _distanceTolerance = 2.0;
-    static constexpr double _azimuthTolerance = 1.5;
+    // Full resolution track
+    QVector<double> _latitudes;
+    QVector<double> _longitudes;
+    QVector<float>  _altitudes;
+    QVector<qint64> _timestamps;    ///< msecs since epoch
+
+    // Track indices for each level of detail. The last index of a level is its open end, which keeps moving to the
+    // newest point while the points it skips stay within tolerance.
+    QVector<int>    _levels[_levelCount];
+
+    double          _zoomLevel;
+    int             _levelOfDetail;
+
+    friend class TrajectoryPointsTest;
 };
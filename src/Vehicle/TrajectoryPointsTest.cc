@@ -0,0 +1,203 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryPointsTest.h"
+#include "TrajectoryPoints.h"
+#include "Vehicle.h"
+
+#include <QDateTime>
+#include <QtMath>
+
+void TrajectoryPointsTest::init(void)
+{
+    UnitTest::init();
+
+    // Flight distance is added to the vehicle as points arrive
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _trajectory = new TrajectoryPoints(_vehicle, this);
+}
+
+void TrajectoryPointsTest::cleanup(void)
+{
+    delete _trajectory;
+    _trajectory = nullptr;
+    _disconnectMockLink();
+
+    UnitTest::cleanup();
+}
+
+/// Adds a track which keeps turning left and right with some wobble, about 5 meters between points
+void TrajectoryPointsTest::_addWindingTrack(int cPoints)
+{
+    QGeoCoordinate  coordinate(47.3977, 8.5456, 500);
+    double          heading = 0;
+
+    for (int i = 0; i < cPoints; i++) {
+        heading += 12.0 * qSin(i / 40.0) + 3.0 * qSin(i * 1.7);
+        coordinate = coordinate.atDistanceAndAzimuth(5.0 + qSin(i * 0.3), heading);
+        coordinate.setAltitude(500 + 20 * qSin(i / 100.0));
+        _trajectory->_vehicleCoordinateChanged(coordinate);
+    }
+}
+
+/// @return Distance in meters from point to the segment first->last, on a local projection built with QGeoCoordinate
+double TrajectoryPointsTest::_segmentDistance(const QGeoCoordinate& first, const QGeoCoordinate& last, const QGeoCoordinate& point)
+{
+    double lastDistance     = first.distanceTo(last);
+    double lastAzimuth      = qDegreesToRadians(first.azimuthTo(last));
+    double pointDistance    = first.distanceTo(point);
+    double pointAzimuth     = qDegreesToRadians(first.azimuthTo(point));
+
+    double segmentX = lastDistance * qSin(lastAzimuth);
+    double segmentY = lastDistance * qCos(lastAzimuth);
+    double x        = pointDistance * qSin(pointAzimuth);
+    double y        = pointDistance * qCos(pointAzimuth);
+
+    double lengthSquared    = segmentX * segmentX + segmentY * segmentY;
+    double t                = lengthSquared > 0 ? qBound(0.0, (x * segmentX + y * segmentY) / lengthSquared, 1.0) : 0.0;
+    x -= t * segmentX;
+    y -= t * segmentY;
+    return qSqrt(x * x + y * y);
+}
+
+/// Every level must start and end with the track, keep its segments short enough and stay within its tolerance of every
+/// raw point it skips
+void TrajectoryPointsTest::_checkLevels(void)
+{
+    const int maxSegmentPoints  = TrajectoryPoints::_maxSegmentPoints;
+    const int levelCount        = TrajectoryPoints::_levelCount;
+    const int count             = _trajectory->count();
+
+    for (int level = 0; level < levelCount; level++) {
+        const QVector<int>& indices     = _trajectory->_levels[level];
+        const double        tolerance   = TrajectoryPoints::_levelTolerances[level];
+        double              maxError    = 0;
+
+        QVERIFY(indices.count() >= 2);
+        QCOMPARE(indices.first(), 0);
+        QCOMPARE(indices.last(), count - 1);
+
+        for (int i = 1; i < indices.count(); i++) {
+            const int first = indices[i - 1];
+            const int last  = indices[i];
+            QVERIFY(last > first);
+            QVERIFY2(last - first <= maxSegmentPoints, qPrintable(QStringLiteral("level %1 segment %2-%3").arg(level).arg(first).arg(last)));
+
+            for (int index = first + 1; index < last; index++) {
+                double error = _segmentDistance(_trajectory->_coordinate(first), _trajectory->_coordinate(last), _trajectory->_coordinate(index));
+                maxError = qMax(maxError, error);
+                // Small allowance for the difference between the two projections
+                QVERIFY2(error <= tolerance * 1.01 + 0.05, qPrintable(QStringLiteral("level %1 point %2 is %3 m off").arg(level).arg(index).arg(error)));
+            }
+        }
+
+        qCDebug(VehicleLog) << "level" << level << "tolerance" << tolerance << "points" << indices.count() << "of" << count << "max error" << maxError;
+    }
+}
+
+void TrajectoryPointsTest::_levelTolerance_test(void)
+{
+    _addWindingTrack(3000);
+    QCOMPARE(_trajectory->count(), 3000);
+    _checkLevels();
+
+    // Coarser levels need fewer points
+    const int levelCount = TrajectoryPoints::_levelCount;
+    for (int level = 1; level < levelCount; level++) {
+        QVERIFY(_trajectory->_levels[level].count() <= _trajectory->_levels[level - 1].count());
+    }
+    QVERIFY(_trajectory->_levels[levelCount - 1].count() < _trajectory->count() / 10);
+}
+
+/// A straight track across the antimeridian must not look like it jumps around the world
+void TrajectoryPointsTest::_antimeridian_test(void)
+{
+    const int       maxSegmentPoints    = TrajectoryPoints::_maxSegmentPoints;
+    const int       levelCount          = TrajectoryPoints::_levelCount;
+    const int       cPoints             = 500;
+    const double    stepMeters          = 5.0;
+    const double    stepDegrees         = stepMeters / 111319.5;
+    double          startDistance       = _vehicle->flightDistance()->rawValue().toDouble();
+
+    for (int i = 0; i < cPoints; i++) {
+        double longitude = 179.995 + i * stepDegrees;
+        if (longitude > 180.0) {
+            longitude -= 360.0;
+        }
+        _trajectory->_vehicleCoordinateChanged(QGeoCoordinate(0.0, longitude, 100));
+    }
+    QCOMPARE(_trajectory->count(), cPoints);
+    QVERIFY(_trajectory->_longitudes.first() > 0 && _trajectory->_longitudes.last() < 0);
+    _checkLevels();
+
+    // Only the segment length limit splits a straight line
+    for (int level = 0; level < levelCount; level++) {
+        QVERIFY(_trajectory->_levels[level].count() <= ((cPoints - 1) / maxSegmentPoints) + 2);
+    }
+
+    double flightDistance = _vehicle->flightDistance()->rawValue().toDouble() - startDistance;
+    QVERIFY2(qAbs(flightDistance - (cPoints - 1) * stepMeters) < 1.0, qPrintable(QStringLiteral("%1 m").arg(flightDistance)));
+}
+
+/// The coarsest level whose tolerance still fits in a pixel is used
+void TrajectoryPointsTest::_zoomLevel_test(void)
+{
+    _addWindingTrack(1000);
+
+    QSignalSpy spyLevelOfDetail(_trajectory, &TrajectoryPoints::levelOfDetailChanged);
+
+    // Meters per pixel around 47 degrees latitude, well away from the level tolerances
+    //      zoom 20: 0.10   zoom 15: 3.3    zoom 13: 13     zoom 11: 52     zoom 9: 208     zoom 5: 3336
+    struct {
+        double  zoomLevel;
+        int     levelOfDetail;
+    } rgZoomLevels[] = {
+        { 20, 0 },
+        { 15, 1 },
+        { 13, 2 },
+        { 11, 3 },
+        { 9,  4 },
+        { 5,  4 },
+        { 20, 0 },
+    };
+
+    int expectedSignals = 0;
+    int levelOfDetail   = _trajectory->levelOfDetail();
+    for (const auto& zoomLevel: rgZoomLevels) {
+        _trajectory->setZoomLevel(zoomLevel.zoomLevel);
+        QCOMPARE(_trajectory->zoomLevel(), zoomLevel.zoomLevel);
+        QCOMPARE(_trajectory->levelOfDetail(), zoomLevel.levelOfDetail);
+        QCOMPARE(_trajectory->list().count(), _trajectory->_levels[zoomLevel.levelOfDetail].count());
+
+        if (zoomLevel.levelOfDetail != levelOfDetail) {
+            expectedSignals++;
+            levelOfDetail = zoomLevel.levelOfDetail;
+        }
+        QCOMPARE(spyLevelOfDetail.count(), expectedSignals);
+    }
+}
+
+void TrajectoryPointsTest::_timestamps_test(void)
+{
+    qint64 startMSecs = QDateTime::currentMSecsSinceEpoch();
+    _addWindingTrack(100);
+    qint64 endMSecs = QDateTime::currentMSecsSinceEpoch();
+
+    QCOMPARE(_trajectory->count(), 100);
+    for (int i = 0; i < _trajectory->count(); i++) {
+        QVERIFY(_trajectory->timestamp(i) >= startMSecs && _trajectory->timestamp(i) <= endMSecs);
+        if (i > 0) {
+            QVERIFY(_trajectory->timestamp(i) >= _trajectory->timestamp(i - 1));
+        }
+    }
+
+    _trajectory->clear();
+    QCOMPARE(_trajectory->count(), 0);
+    QVERIFY(_trajectory->_timestamps.isEmpty());
+}
@@ -0,0 +1,37 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class TrajectoryPoints;
+
+/// Unit test for TrajectoryPoints simplification and level of detail selection. Synthetic tracks are fed straight in,
+/// no vehicle movement is needed.
+class TrajectoryPointsTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void init(void) final;
+    void cleanup(void) final;
+
+    void _levelTolerance_test(void);
+    void _antimeridian_test(void);
+    void _zoomLevel_test(void);
+    void _timestamps_test(void);
+
+private:
+    void    _addWindingTrack    (int cPoints);
+    void    _checkLevels        (void);
+    double  _segmentDistance    (const QGeoCoordinate& first, const QGeoCoordinate& last, const QGeoCoordinate& point);
+
+    TrajectoryPoints* _trajectory = nullptr;
+};
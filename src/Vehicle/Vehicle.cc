@@ -173,7 +173,6 @@ Vehicle::Vehicle(LinkInterface*             link,
     , _messagesReceived(0)
     , _messagesSent(0)
     , _messagesLost(0)
-    , _messageSeq(0)
     , _compID(0)
     , _heardFrom(false)
     , _firmwareMajorVersion(versionNotSetValue)
@@ -228,8 +227,14 @@ Vehicle::Vehicle(LinkInterface*             link,
     _mavlink = _toolbox->mavlinkProtocol();
     qCDebug(VehicleLog) << "Link started with Mavlink " << (_mavlink->getCurrentVersion() >= 200 ? "V2" : "V1");
 
+    _subscribeMessageHandlers();
+
     connect(_mavlink, &MAVLinkProtocol::messageReceived,        this, &Vehicle::_mavlinkMessageReceived);
-    connect(_mavlink, &MAVLinkProtocol::mavlinkMessageStatus,   this, &Vehicle::_mavlinkMessageStatus);
+
+    // Loss statistics are kept by the protocol layer, they are polled instead of being pushed for each message
+    _linkQualityTimer.setInterval(_linkQualityUpdateMSecs);
+    connect(&_linkQualityTimer, &QTimer::timeout, this, &Vehicle::_updateLinkQuality);
+    _linkQualityTimer.start();
 
     _addLink(link);
 
@@ -364,7 +369,6 @@ Vehicle::Vehicle(MAV_AUTOPILOT              firmwareType,
     , _messagesReceived(0)
     , _messagesSent(0)
     , _messagesLost(0)
-    , _messageSeq(0)
     , _compID(0)
     , _heardFrom(false)
     , _firmwareMajorVersion(versionNotSetValue)
@@ -652,7 +656,7 @@ void Vehicle::resetCounters()
     _messagesReceived   = 0;
     _messagesSent       = 0;
     _messagesLost       = 0;
-    _messageSeq         = 0;
+    _messagesLostBase   = _mavlink ? _mavlink->linkQuality()->stats(LinkQualityTracker::anyId, _id, _compID).totalLost : 0;
     _heardFrom          = false;
 }
 
@@ -679,27 +683,10 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     //-- Check link status
     _messagesReceived++;
     emit messagesReceivedChanged();
-    if(!_heardFrom) {
-        if(message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            _heardFrom = true;
-            _compID = message.compid;
-            _messageSeq = message.seq + 1;
-        }
-    } else {
-        if(_compID == message.compid) {
-            uint16_t seq_received = static_cast<uint16_t>(message.seq);
-            uint16_t packet_lost_count = 0;
-            //-- Account for overflow during packet loss
-            if(seq_received < _messageSeq) {
-                packet_lost_count = (seq_received + 255) - _messageSeq;
-            } else {
-                packet_lost_count = seq_received - _messageSeq;
-            }
-            _messageSeq = message.seq + 1;
-            _messagesLost += packet_lost_count;
-            if(packet_lost_count)
-                emit messagesLostChanged();
-        }
+    if(!_heardFrom && message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        // Loss is tracked from the component which sends the first heartbeat, see _updateLinkQuality
+        _heardFrom = true;
+        _compID = message.compid;
     }
 
     // Give the plugin a change to adjust the message contents
@@ -719,146 +706,73 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
 
     _waitForMavlinkMessageMessageReceived(message);
 
-    switch (message.msgid) {
-    case MAVLINK_MSG_ID_HOME_POSITION:
-        _handleHomePosition(message);
-        break;
-    case MAVLINK_MSG_ID_HEARTBEAT:
-        _handleHeartbeat(message);
-        break;
-    case MAVLINK_MSG_ID_RADIO_STATUS:
-        _handleRadioStatus(message);
-        break;
-    case MAVLINK_MSG_ID_RC_CHANNELS:
-        _handleRCChannels(message);
-        break;
-    case MAVLINK_MSG_ID_BATTERY_STATUS:
-        _handleBatteryStatus(message);
-        break;
-    case MAVLINK_MSG_ID_SYS_STATUS:
-        _handleSysStatus(message);
-        break;
-    case MAVLINK_MSG_ID_RAW_IMU:
-        emit mavlinkRawImu(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_IMU:
-        emit mavlinkScaledImu1(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_IMU2:
-        emit mavlinkScaledImu2(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_IMU3:
-        emit mavlinkScaledImu3(message);
-        break;
-    case MAVLINK_MSG_ID_VIBRATION:
-        _handleVibration(message);
-        break;
-    case MAVLINK_MSG_ID_EXTENDED_SYS_STATE:
-        _handleExtendedSysState(message);
-        break;
-    case MAVLINK_MSG_ID_COMMAND_ACK:
-        _handleCommandAck(message);
-        break;
-    case MAVLINK_MSG_ID_COMMAND_LONG:
-        _handleCommandLong(message);
-        break;
-    case MAVLINK_MSG_ID_WIND_COV:
-        _handleWindCov(message);
-        break;
-    case MAVLINK_MSG_ID_LOGGING_DATA:
-        _handleMavlinkLoggingData(message);
-        break;
-    case MAVLINK_MSG_ID_LOGGING_DATA_ACKED:
-        _handleMavlinkLoggingDataAcked(message);
-        break;
-    case MAVLINK_MSG_ID_GPS_RAW_INT:
-        _handleGpsRawInt(message);
-        break;
-    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
-        _handleGlobalPositionInt(message);
-        break;
-    case MAVLINK_MSG_ID_ALTITUDE:
-        _handleAltitude(message);
-        break;
-    case MAVLINK_MSG_ID_VFR_HUD:
-        _handleVfrHud(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_PRESSURE:
-        _handleScaledPressure(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_PRESSURE2:
-        _handleScaledPressure2(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_PRESSURE3:
-        _handleScaledPressure3(message);
-        break;
-    case MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED:
-        _handleCameraImageCaptured(message);
-        break;
-    case MAVLINK_MSG_ID_ADSB_VEHICLE:
-        _handleADSBVehicle(message);
-        break;
-    case MAVLINK_MSG_ID_HIGH_LATENCY2:
-        _handleHighLatency2(message);
-        break;
-    case MAVLINK_MSG_ID_ATTITUDE:
-        _handleAttitude(message);
-        break;
-    case MAVLINK_MSG_ID_ATTITUDE_QUATERNION:
-        _handleAttitudeQuaternion(message);
-        break;
-    case MAVLINK_MSG_ID_ATTITUDE_TARGET:
-        _handleAttitudeTarget(message);
-        break;
-    case MAVLINK_MSG_ID_DISTANCE_SENSOR:
-        _handleDistanceSensor(message);
-        break;
-    case MAVLINK_MSG_ID_ESTIMATOR_STATUS:
-        _handleEstimatorStatus(message);
-        break;
-    case MAVLINK_MSG_ID_STATUSTEXT:
-        _handleStatusText(message);
-        break;
-    case MAVLINK_MSG_ID_ORBIT_EXECUTION_STATUS:
-        _handleOrbitExecutionStatus(message);
-        break;
-    case MAVLINK_MSG_ID_MESSAGE_INTERVAL:
-        _handleMessageInterval(message);
-        break;
-    case MAVLINK_MSG_ID_PING:
-        _handlePing(link, message);
-        break;
-    case MAVLINK_MSG_ID_MOUNT_ORIENTATION:
-        _handleGimbalOrientation(message);
-        break;
-    case MAVLINK_MSG_ID_OBSTACLE_DISTANCE:
-        _handleObstacleDistance(message);
-        break;
+    // Vehicle handlers are subscribed at high priority so vehicle state is up to date before other subscribers are called
+    _messageDispatcher.dispatch(link, message);
 
-    case MAVLINK_MSG_ID_SERIAL_CONTROL:
-    {
+    // This must be emitted after the vehicle processes the message. This way the vehicle state is up to date when anyone else
+    // does processing.
+    emit mavlinkMessageReceived(message);
+
+    _uas->receiveMessage(message);
+}
+
+/// Sets up the message id dispatch table for the messages handled by the vehicle itself
+void Vehicle::_subscribeMessageHandlers()
+{
+    auto subscribe = [this](uint32_t msgid, MAVLinkMessageDispatcher::Handler_t handler) {
+        _messageDispatcher.subscribe(this, msgid, handler, MAVLinkMessageDispatcher::anyId, MAVLinkMessageDispatcher::anyId, MAVLinkMessageDispatcher::PriorityHigh);
+    };
+
+    subscribe(MAVLINK_MSG_ID_HOME_POSITION,          [this](LinkInterface*, const mavlink_message_t& message) { _handleHomePosition(message); });
+    subscribe(MAVLINK_MSG_ID_HEARTBEAT,              [this](LinkInterface*, const mavlink_message_t& message) { _handleHeartbeat(message); });
+    subscribe(MAVLINK_MSG_ID_RADIO_STATUS,           [this](LinkInterface*, const mavlink_message_t& message) { _handleRadioStatus(message); });
+    subscribe(MAVLINK_MSG_ID_RC_CHANNELS,            [this](LinkInterface*, const mavlink_message_t& message) { _handleRCChannels(message); });
+    subscribe(MAVLINK_MSG_ID_BATTERY_STATUS,         [this](LinkInterface*, const mavlink_message_t& message) { _handleBatteryStatus(message); });
+    subscribe(MAVLINK_MSG_ID_SYS_STATUS,             [this](LinkInterface*, const mavlink_message_t& message) { _handleSysStatus(message); });
+    subscribe(MAVLINK_MSG_ID_VIBRATION,              [this](LinkInterface*, const mavlink_message_t& message) { _handleVibration(message); });
+    subscribe(MAVLINK_MSG_ID_EXTENDED_SYS_STATE,     [this](LinkInterface*, const mavlink_message_t& message) { _handleExtendedSysState(message); });
+    subscribe(MAVLINK_MSG_ID_COMMAND_ACK,            [this](LinkInterface*, const mavlink_message_t& message) { _handleCommandAck(message); });
+    subscribe(MAVLINK_MSG_ID_COMMAND_LONG,           [this](LinkInterface*, const mavlink_message_t& message) { _handleCommandLong(message); });
+    subscribe(MAVLINK_MSG_ID_WIND_COV,               [this](LinkInterface*, const mavlink_message_t& message) { _handleWindCov(message); });
+    subscribe(MAVLINK_MSG_ID_LOGGING_DATA,           [this](LinkInterface*, const mavlink_message_t& message) { _handleMavlinkLoggingData(message); });
+    subscribe(MAVLINK_MSG_ID_LOGGING_DATA_ACKED,     [this](LinkInterface*, const mavlink_message_t& message) { _handleMavlinkLoggingDataAcked(message); });
+    subscribe(MAVLINK_MSG_ID_GPS_RAW_INT,            [this](LinkInterface*, const mavlink_message_t& message) { _handleGpsRawInt(message); });
+    subscribe(MAVLINK_MSG_ID_GLOBAL_POSITION_INT,    [this](LinkInterface*, const mavlink_message_t& message) { _handleGlobalPositionInt(message); });
+    subscribe(MAVLINK_MSG_ID_ALTITUDE,               [this](LinkInterface*, const mavlink_message_t& message) { _handleAltitude(message); });
+    subscribe(MAVLINK_MSG_ID_VFR_HUD,                [this](LinkInterface*, const mavlink_message_t& message) { _handleVfrHud(message); });
+    subscribe(MAVLINK_MSG_ID_SCALED_PRESSURE,        [this](LinkInterface*, const mavlink_message_t& message) { _handleScaledPressure(message); });
+    subscribe(MAVLINK_MSG_ID_SCALED_PRESSURE2,       [this](LinkInterface*, const mavlink_message_t& message) { _handleScaledPressure2(message); });
+    subscribe(MAVLINK_MSG_ID_SCALED_PRESSURE3,       [this](LinkInterface*, const mavlink_message_t& message) { _handleScaledPressure3(message); });
+    subscribe(MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED,  [this](LinkInterface*, const mavlink_message_t& message) { _handleCameraImageCaptured(message); });
+    subscribe(MAVLINK_MSG_ID_ADSB_VEHICLE,           [this](LinkInterface*, const mavlink_message_t& message) { _handleADSBVehicle(message); });
+    subscribe(MAVLINK_MSG_ID_HIGH_LATENCY2,          [this](LinkInterface*, const mavlink_message_t& message) { _handleHighLatency2(message); });
+    subscribe(MAVLINK_MSG_ID_ATTITUDE,               [this](LinkInterface*, const mavlink_message_t& message) { _handleAttitude(message); });
+    subscribe(MAVLINK_MSG_ID_ATTITUDE_QUATERNION,    [this](LinkInterface*, const mavlink_message_t& message) { _handleAttitudeQuaternion(message); });
+    subscribe(MAVLINK_MSG_ID_ATTITUDE_TARGET,        [this](LinkInterface*, const mavlink_message_t& message) { _handleAttitudeTarget(message); });
+    subscribe(MAVLINK_MSG_ID_DISTANCE_SENSOR,        [this](LinkInterface*, const mavlink_message_t& message) { _handleDistanceSensor(message); });
+    subscribe(MAVLINK_MSG_ID_ESTIMATOR_STATUS,       [this](LinkInterface*, const mavlink_message_t& message) { _handleEstimatorStatus(message); });
+    subscribe(MAVLINK_MSG_ID_STATUSTEXT,             [this](LinkInterface*, const mavlink_message_t& message) { _handleStatusText(message); });
+    subscribe(MAVLINK_MSG_ID_ORBIT_EXECUTION_STATUS, [this](LinkInterface*, const mavlink_message_t& message) { _handleOrbitExecutionStatus(message); });
+    subscribe(MAVLINK_MSG_ID_MESSAGE_INTERVAL,       [this](LinkInterface*, const mavlink_message_t& message) { _handleMessageInterval(message); });
+    subscribe(MAVLINK_MSG_ID_PING,                   [this](LinkInterface* link, const mavlink_message_t& message) { _handlePing(link, message); });
+    subscribe(MAVLINK_MSG_ID_MOUNT_ORIENTATION,      [this](LinkInterface*, const mavlink_message_t& message) { _handleGimbalOrientation(message); });
+    subscribe(MAVLINK_MSG_ID_OBSTACLE_DISTANCE,      [this](LinkInterface*, const mavlink_message_t& message) { _handleObstacleDistance(message); });
+    subscribe(MAVLINK_MSG_ID_RAW_IMU,                [this](LinkInterface*, const mavlink_message_t& message) { emit mavlinkRawImu(message); });
+    subscribe(MAVLINK_MSG_ID_SCALED_IMU,             [this](LinkInterface*, const mavlink_message_t& message) { emit mavlinkScaledImu1(message); });
+    subscribe(MAVLINK_MSG_ID_SCALED_IMU2,            [this](LinkInterface*, const mavlink_message_t& message) { emit mavlinkScaledImu2(message); });
+    subscribe(MAVLINK_MSG_ID_SCALED_IMU3,            [this](LinkInterface*, const mavlink_message_t& message) { emit mavlinkScaledImu3(message); });
+
+    subscribe(MAVLINK_MSG_ID_SERIAL_CONTROL, [this](LinkInterface*, const mavlink_message_t& message) {
         mavlink_serial_control_t ser;
         mavlink_msg_serial_control_decode(&message, &ser);
         emit mavlinkSerialControl(ser.device, ser.flags, ser.timeout, ser.baudrate, QByteArray(reinterpret_cast<const char*>(ser.data), ser.count));
-    }
-        break;
+    });
 
-        // Following are ArduPilot dialect messages
+    // Following are ArduPilot dialect messages
 #if !defined(NO_ARDUPILOT_DIALECT)
-    case MAVLINK_MSG_ID_CAMERA_FEEDBACK:
-        _handleCameraFeedback(message);
-        break;
-    case MAVLINK_MSG_ID_WIND:
-        _handleWind(message);
-        break;
+    subscribe(MAVLINK_MSG_ID_CAMERA_FEEDBACK,        [this](LinkInterface*, const mavlink_message_t& message) { _handleCameraFeedback(message); });
+    subscribe(MAVLINK_MSG_ID_WIND,                   [this](LinkInterface*, const mavlink_message_t& message) { _handleWind(message); });
 #endif
-    }
-
-    // This must be emitted after the vehicle processes the message. This way the vehicle state is up to date when anyone else
-    // does processing.
-    emit mavlinkMessageReceived(message);
-
-    _uas->receiveMessage(message);
 }
 
 #if !defined(NO_ARDUPILOT_DIALECT)
@@ -985,7 +899,7 @@ void Vehicle::_chunkedStatusTextCompleted(uint8_t compId)
     emit textMessageReceived(id(), compId, severity, messageText);
 }
 
-void Vehicle::_handleStatusText(mavlink_message_t& message)
+void Vehicle::_handleStatusText(const mavlink_message_t& message)
 {
     QByteArray  b;
     QString     messageText;
@@ -1042,7 +956,7 @@ void Vehicle::_handleStatusText(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleVfrHud(mavlink_message_t& message)
+void Vehicle::_handleVfrHud(const mavlink_message_t& message)
 {
     mavlink_vfr_hud_t vfrHud;
     mavlink_msg_vfr_hud_decode(&message, &vfrHud);
@@ -1053,7 +967,7 @@ void Vehicle::_handleVfrHud(mavlink_message_t& message)
     _throttlePctFact.setRawValue(static_cast<int16_t>(vfrHud.throttle));
 }
 
-void Vehicle::_handleEstimatorStatus(mavlink_message_t& message)
+void Vehicle::_handleEstimatorStatus(const mavlink_message_t& message)
 {
     mavlink_estimator_status_t estimatorStatus;
     mavlink_msg_estimator_status_decode(&message, &estimatorStatus);
@@ -1111,7 +1025,7 @@ void Vehicle::_handleEstimatorStatus(mavlink_message_t& message)
 #endif
 }
 
-void Vehicle::_handleDistanceSensor(mavlink_message_t& message)
+void Vehicle::_handleDistanceSensor(const mavlink_message_t& message)
 {
     mavlink_distance_sensor_t distanceSensor;
 
@@ -1162,7 +1076,7 @@ void Vehicle::_handleDistanceSensor(mavlink_message_t& message)
 #pragma warning(push, 0)
 #endif
 
-void Vehicle::_handleAttitudeTarget(mavlink_message_t& message)
+void Vehicle::_handleAttitudeTarget(const mavlink_message_t& message)
 {
     mavlink_attitude_target_t attitudeTarget;
 
@@ -1203,7 +1117,7 @@ void Vehicle::_handleAttitudeWorker(double rollRadians, double pitchRadians, dou
     _headingFact.setRawValue(yaw);
 }
 
-void Vehicle::_handleAttitude(mavlink_message_t& message)
+void Vehicle::_handleAttitude(const mavlink_message_t& message)
 {
     if (_receivingAttitudeQuaternion) {
         return;
@@ -1215,7 +1129,7 @@ void Vehicle::_handleAttitude(mavlink_message_t& message)
     _handleAttitudeWorker(attitude.roll, attitude.pitch, attitude.yaw);
 }
 
-void Vehicle::_handleAttitudeQuaternion(mavlink_message_t& message)
+void Vehicle::_handleAttitudeQuaternion(const mavlink_message_t& message)
 {
     _receivingAttitudeQuaternion = true;
 
@@ -1243,7 +1157,7 @@ void Vehicle::_handleAttitudeQuaternion(mavlink_message_t& message)
     yawRate()->setRawValue(qRadiansToDegrees(rates[2]));
 }
 
-void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
+void Vehicle::_handleGpsRawInt(const mavlink_message_t& message)
 {
     mavlink_gps_raw_int_t gpsRawInt;
     mavlink_msg_gps_raw_int_decode(&message, &gpsRawInt);
@@ -1271,7 +1185,7 @@ void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
     _gpsFactGroup.lock()->setRawValue(gpsRawInt.fix_type);
 }
 
-void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
+void Vehicle::_handleGlobalPositionInt(const mavlink_message_t& message)
 {
     mavlink_global_position_int_t globalPositionInt;
     mavlink_msg_global_position_int_decode(&message, &globalPositionInt);
@@ -1293,7 +1207,7 @@ void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleHighLatency2(mavlink_message_t& message)
+void Vehicle::_handleHighLatency2(const mavlink_message_t& message)
 {
     mavlink_high_latency2_t highLatency2;
     mavlink_msg_high_latency2_decode(&message, &highLatency2);
@@ -1373,7 +1287,7 @@ void Vehicle::_handleHighLatency2(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleAltitude(mavlink_message_t& message)
+void Vehicle::_handleAltitude(const mavlink_message_t& message)
 {
     mavlink_altitude_t altitude;
     mavlink_msg_altitude_decode(&message, &altitude);
@@ -1446,7 +1360,7 @@ QString Vehicle::vehicleUIDStr()
     return uid;
 }
 
-void Vehicle::_handleCommandLong(mavlink_message_t& message)
+void Vehicle::_handleCommandLong(const mavlink_message_t& message)
 {
 #ifdef NO_SERIAL_LINK
     // If not using serial link, bail out.
@@ -1475,7 +1389,7 @@ void Vehicle::_handleCommandLong(mavlink_message_t& message)
 #endif
 }
 
-void Vehicle::_handleExtendedSysState(mavlink_message_t& message)
+void Vehicle::_handleExtendedSysState(const mavlink_message_t& message)
 {
     mavlink_extended_sys_state_t extendedState;
     mavlink_msg_extended_sys_state_decode(&message, &extendedState);
@@ -1507,7 +1421,7 @@ void Vehicle::_handleExtendedSysState(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleVibration(mavlink_message_t& message)
+void Vehicle::_handleVibration(const mavlink_message_t& message)
 {
     mavlink_vibration_t vibration;
     mavlink_msg_vibration_decode(&message, &vibration);
@@ -1520,7 +1434,7 @@ void Vehicle::_handleVibration(mavlink_message_t& message)
     _vibrationFactGroup.clipCount3()->setRawValue(vibration.clipping_2);
 }
 
-void Vehicle::_handleWindCov(mavlink_message_t& message)
+void Vehicle::_handleWindCov(const mavlink_message_t& message)
 {
     mavlink_wind_cov_t wind;
     mavlink_msg_wind_cov_decode(&message, &wind);
@@ -1538,7 +1452,7 @@ void Vehicle::_handleWindCov(mavlink_message_t& message)
 }
 
 #if !defined(NO_ARDUPILOT_DIALECT)
-void Vehicle::_handleWind(mavlink_message_t& message)
+void Vehicle::_handleWind(const mavlink_message_t& message)
 {
     mavlink_wind_t wind;
     mavlink_msg_wind_decode(&message, &wind);
@@ -1590,7 +1504,7 @@ void Vehicle::_batteryStatusWorker(int batteryId, double voltage, double current
     }
 }
 
-void Vehicle::_handleSysStatus(mavlink_message_t& message)
+void Vehicle::_handleSysStatus(const mavlink_message_t& message)
 {
     mavlink_sys_status_t sysStatus;
     mavlink_msg_sys_status_decode(&message, &sysStatus);
@@ -1629,7 +1543,7 @@ void Vehicle::_handleSysStatus(mavlink_message_t& message)
                          sysStatus.battery_remaining == -1 ? qQNaN() : sysStatus.battery_remaining);
 }
 
-void Vehicle::_handleBatteryStatus(mavlink_message_t& message)
+void Vehicle::_handleBatteryStatus(const mavlink_message_t& message)
 {
     mavlink_battery_status_t bat_status;
     mavlink_msg_battery_status_decode(&message, &bat_status);
@@ -1678,7 +1592,7 @@ void Vehicle::_setHomePosition(QGeoCoordinate& homeCoord)
     }
 }
 
-void Vehicle::_handleHomePosition(mavlink_message_t& message)
+void Vehicle::_handleHomePosition(const mavlink_message_t& message)
 {
     mavlink_home_position_t homePos;
 
@@ -1716,7 +1630,7 @@ void Vehicle::_updateArmed(bool armed)
     }
 }
 
-void Vehicle::_handlePing(LinkInterface* link, mavlink_message_t& message)
+void Vehicle::_handlePing(LinkInterface* link, const mavlink_message_t& message)
 {
     mavlink_ping_t      ping;
     mavlink_message_t   msg;
@@ -1733,7 +1647,7 @@ void Vehicle::_handlePing(LinkInterface* link, mavlink_message_t& message)
     sendMessageOnLinkThreadSafe(link, msg);
 }
 
-void Vehicle::_handleHeartbeat(mavlink_message_t& message)
+void Vehicle::_handleHeartbeat(const mavlink_message_t& message)
 {
     if (message.compid != _defaultComponentId) {
         return;
@@ -1773,7 +1687,7 @@ void Vehicle::_handleHeartbeat(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleRadioStatus(mavlink_message_t& message)
+void Vehicle::_handleRadioStatus(const mavlink_message_t& message)
 {
 
     //-- Process telemetry status message
@@ -1833,7 +1747,7 @@ void Vehicle::_handleRadioStatus(mavlink_message_t& message)
     }
 }
 
-void Vehicle::_handleRCChannels(mavlink_message_t& message)
+void Vehicle::_handleRCChannels(const mavlink_message_t& message)
 {
     mavlink_rc_channels_t channels;
 
@@ -1886,19 +1800,19 @@ void Vehicle::_handleRCChannels(mavlink_message_t& message)
 #pragma warning(pop, 0)
 #endif
 
-void Vehicle::_handleScaledPressure(mavlink_message_t& message) {
+void Vehicle::_handleScaledPressure(const mavlink_message_t& message) {
     mavlink_scaled_pressure_t pressure;
     mavlink_msg_scaled_pressure_decode(&message, &pressure);
     _temperatureFactGroup.temperature1()->setRawValue(pressure.temperature / 100.0);
 }
 
-void Vehicle::_handleScaledPressure2(mavlink_message_t& message) {
+void Vehicle::_handleScaledPressure2(const mavlink_message_t& message) {
     mavlink_scaled_pressure2_t pressure;
     mavlink_msg_scaled_pressure2_decode(&message, &pressure);
     _temperatureFactGroup.temperature2()->setRawValue(pressure.temperature / 100.0);
 }
 
-void Vehicle::_handleScaledPressure3(mavlink_message_t& message) {
+void Vehicle::_handleScaledPressure3(const mavlink_message_t& message) {
     mavlink_scaled_pressure3_t pressure;
     mavlink_msg_scaled_pressure3_decode(&message, &pressure);
     _temperatureFactGroup.temperature3()->setRawValue(pressure.temperature / 100.0);
@@ -1963,6 +1877,26 @@ bool Vehicle::sendMessageOnLinkThreadSafe(LinkInterface* link, mavlink_message_t
     return true;
 }
 
+bool Vehicle::sendMessagesOnLinkThreadSafe(LinkInterface* link, mavlink_message_t* messages, int count, QByteArray& sendBuffer)
+{
+    if (!link->isConnected()) {
+        return false;
+    }
+
+    sendBuffer.resize(count * MAVLINK_MAX_PACKET_LEN);
+    int len = 0;
+    for (int i = 0; i < count; i++) {
+        _firmwarePlugin->adjustOutgoingMavlinkMessageThreadSafe(this, link, &messages[i]);
+        len += mavlink_msg_to_send_buffer(reinterpret_cast<uint8_t*>(sendBuffer.data()) + len, &messages[i]);
+    }
+
+    link->writeBytesThreadSafe(sendBuffer.constData(), len);
+    _messagesSent += static_cast<uint>(count);
+    emit messagesSentChanged();
+
+    return true;
+}
+
 void Vehicle::_updatePriorityLink(bool updateActive, bool sendCommand)
 {
     emit linksPropertiesChanged();
@@ -3257,7 +3191,7 @@ void Vehicle::_sendNextQueuedMavCommand()
     }
 }
 
-void Vehicle::_handleCommandAck(mavlink_message_t& message)
+void Vehicle::_handleCommandAck(const mavlink_message_t& message)
 {
     mavlink_command_ack_t ack;
     mavlink_msg_command_ack_decode(&message, &ack);
@@ -3664,7 +3598,7 @@ void Vehicle::_ackMavlinkLogData(uint16_t sequence)
     sendMessageOnLinkThreadSafe(priorityLink(), msg);
 }
 
-void Vehicle::_handleMavlinkLoggingData(mavlink_message_t& message)
+void Vehicle::_handleMavlinkLoggingData(const mavlink_message_t& message)
 {
     mavlink_logging_data_t log;
     mavlink_msg_logging_data_decode(&message, &log);
@@ -3672,7 +3606,7 @@ void Vehicle::_handleMavlinkLoggingData(mavlink_message_t& message)
                         log.first_message_offset, QByteArray((const char*)log.data, log.length), false);
 }
 
-void Vehicle::_handleMavlinkLoggingDataAcked(mavlink_message_t& message)
+void Vehicle::_handleMavlinkLoggingDataAcked(const mavlink_message_t& message)
 {
     mavlink_logging_data_acked_t log;
     mavlink_msg_logging_data_acked_decode(&message, &log);
@@ -3972,15 +3906,28 @@ void Vehicle::_trafficUpdate(bool /*alert*/, QString /*traffic_id*/, QString /*v
 #endif
 }
 
-void Vehicle::_mavlinkMessageStatus(int uasId, uint64_t totalSent, uint64_t totalReceived, uint64_t totalLoss, float lossPercent)
+void Vehicle::_updateLinkQuality()
 {
-    if(uasId == _id) {
-        _mavlinkSentCount       = totalSent;
-        _mavlinkReceivedCount   = totalReceived;
-        _mavlinkLossCount       = totalLoss;
-        _mavlinkLossPercent     = lossPercent;
+    LinkQualityTracker* linkQuality = _mavlink->linkQuality();
+
+    // Status covers all components of the vehicle over all links
+    LinkQualityTracker::Stats_t stats = linkQuality->stats(LinkQualityTracker::anyId, _id);
+    if (stats.totalReceived != _mavlinkReceivedCount || stats.totalLost != _mavlinkLossCount) {
+        _mavlinkSentCount       = stats.totalSent();
+        _mavlinkReceivedCount   = stats.totalReceived;
+        _mavlinkLossCount       = stats.totalLost;
+        _mavlinkLossPercent     = static_cast<float>(stats.windowLossPercent);
         emit mavlinkStatusChanged();
     }
+
+    if (_heardFrom) {
+        quint64 totalLost   = linkQuality->stats(LinkQualityTracker::anyId, _id, _compID).totalLost;
+        uint    messagesLost = static_cast<uint>(totalLost > _messagesLostBase ? totalLost - _messagesLostBase : 0);
+        if (messagesLost != _messagesLost) {
+            _messagesLost = messagesLost;
+            emit messagesLostChanged();
+        }
+    }
 }
 
 int  Vehicle::versionCompare(QString& compare)
@@ -21,6 +21,7 @@
 #include "QGCMAVLink.h"
 #include "QmlObjectListModel.h"
 #include "MAVLinkProtocol.h"
+#include "MAVLinkMessageDispatcher.h"
 #include "UASMessageHandler.h"
 #include "SettingsFact.h"
 #include "QGCMapCircle.h"
@@ -835,6 +836,11 @@ public:
     /// @return true: message sent, false: Link no longer connected
     bool sendMessageOnLinkThreadSafe(LinkInterface* link, mavlink_message_t message);
 
+    /// Sends the messages to the specified link with a single write. The messages are encoded into sendBuffer, which
+    /// the caller keeps from call to call so sending doesn't allocate. Messages may be adjusted by the firmware plugin.
+    /// @return true: messages sent, false: Link no longer connected
+    bool sendMessagesOnLinkThreadSafe(LinkInterface* link, mavlink_message_t* messages, int count, QByteArray& sendBuffer);
+
     /// Sends the specified messages multiple times to the vehicle in order to attempt to
     /// guarantee that it makes it to the vehicle.
     void sendMessageMultiple(mavlink_message_t message);
@@ -1010,6 +1016,10 @@ public:
     ParameterManager*               parameterManager    () { return _parameterManager; }
     ParameterManager*               parameterManager    () const { return _parameterManager; }
     FTPManager*                     ftpManager          () { return _ftpManager; }
+
+    /// Incoming messages from this vehicle are dispatched to subscribers by message id. Subscribe here instead of
+    /// connecting to mavlinkMessageReceived when only a few message ids are needed.
+    MAVLinkMessageDispatcher*       messageDispatcher   () { return &_messageDispatcher; }
     ComponentInformationManager*    compInfoManager     () { return _componentInformationManager; }
     VehicleObjectAvoidance* objectAvoidance     () { return _objectAvoidance; }
 
@@ -1299,7 +1309,7 @@ private slots:
     void _updateHobbsMeter              ();
     void _vehicleParamLoaded            (bool ready);
     void _sendQGCTimeToVehicle          ();
-    void _mavlinkMessageStatus          (int uasId, uint64_t totalSent, uint64_t totalReceived, uint64_t totalLoss, float lossPercent);
+    void _updateLinkQuality             ();
 
     void _trafficUpdate                 (bool alert, QString traffic_id, QString vehicle_id, QGeoCoordinate location, float heading);
     void _orbitTelemetryTimeout         ();
@@ -1312,33 +1322,34 @@ private:
     void _loadSettings                  ();
     void _saveSettings                  ();
     void _startJoystick                 (bool start);
-    void _handlePing                    (LinkInterface* link, mavlink_message_t& message);
-    void _handleHomePosition            (mavlink_message_t& message);
-    void _handleHeartbeat               (mavlink_message_t& message);
-    void _handleRadioStatus             (mavlink_message_t& message);
-    void _handleRCChannels              (mavlink_message_t& message);
-    void _handleBatteryStatus           (mavlink_message_t& message);
-    void _handleSysStatus               (mavlink_message_t& message);
-    void _handleWindCov                 (mavlink_message_t& message);
-    void _handleVibration               (mavlink_message_t& message);
-    void _handleExtendedSysState        (mavlink_message_t& message);
-    void _handleCommandAck              (mavlink_message_t& message);
-    void _handleCommandLong             (mavlink_message_t& message);
-    void _handleGpsRawInt               (mavlink_message_t& message);
-    void _handleGlobalPositionInt       (mavlink_message_t& message);
-    void _handleAltitude                (mavlink_message_t& message);
-    void _handleVfrHud                  (mavlink_message_t& message);
-    void _handleScaledPressure          (mavlink_message_t& message);
-    void _handleScaledPressure2         (mavlink_message_t& message);
-    void _handleScaledPressure3         (mavlink_message_t& message);
-    void _handleHighLatency2            (mavlink_message_t& message);
+    void _subscribeMessageHandlers      ();
+    void _handlePing                    (LinkInterface* link, const mavlink_message_t& message);
+    void _handleHomePosition            (const mavlink_message_t& message);
+    void _handleHeartbeat               (const mavlink_message_t& message);
+    void _handleRadioStatus             (const mavlink_message_t& message);
+    void _handleRCChannels              (const mavlink_message_t& message);
+    void _handleBatteryStatus           (const mavlink_message_t& message);
+    void _handleSysStatus               (const mavlink_message_t& message);
+    void _handleWindCov                 (const mavlink_message_t& message);
+    void _handleVibration               (const mavlink_message_t& message);
+    void _handleExtendedSysState        (const mavlink_message_t& message);
+    void _handleCommandAck              (const mavlink_message_t& message);
+    void _handleCommandLong             (const mavlink_message_t& message);
+    void _handleGpsRawInt               (const mavlink_message_t& message);
+    void _handleGlobalPositionInt       (const mavlink_message_t& message);
+    void _handleAltitude                (const mavlink_message_t& message);
+    void _handleVfrHud                  (const mavlink_message_t& message);
+    void _handleScaledPressure          (const mavlink_message_t& message);
+    void _handleScaledPressure2         (const mavlink_message_t& message);
+    void _handleScaledPressure3         (const mavlink_message_t& message);
+    void _handleHighLatency2            (const mavlink_message_t& message);
     void _handleAttitudeWorker          (double rollRadians, double pitchRadians, double yawRadians);
-    void _handleAttitude                (mavlink_message_t& message);
-    void _handleAttitudeQuaternion      (mavlink_message_t& message);
-    void _handleAttitudeTarget          (mavlink_message_t& message);
-    void _handleDistanceSensor          (mavlink_message_t& message);
-    void _handleEstimatorStatus         (mavlink_message_t& message);
-    void _handleStatusText              (mavlink_message_t& message);
+    void _handleAttitude                (const mavlink_message_t& message);
+    void _handleAttitudeQuaternion      (const mavlink_message_t& message);
+    void _handleAttitudeTarget          (const mavlink_message_t& message);
+    void _handleDistanceSensor          (const mavlink_message_t& message);
+    void _handleEstimatorStatus         (const mavlink_message_t& message);
+    void _handleStatusText              (const mavlink_message_t& message);
     void _handleOrbitExecutionStatus    (const mavlink_message_t& message);
     void _handleMessageInterval         (const mavlink_message_t& message);
     void _handleGimbalOrientation       (const mavlink_message_t& message);
@@ -1346,7 +1357,7 @@ private:
     // ArduPilot dialect messages
 #if !defined(NO_ARDUPILOT_DIALECT)
     void _handleCameraFeedback          (const mavlink_message_t& message);
-    void _handleWind                    (mavlink_message_t& message);
+    void _handleWind                    (const mavlink_message_t& message);
 #endif
     void _handleCameraImageCaptured     (const mavlink_message_t& message);
     void _handleADSBVehicle             (const mavlink_message_t& message);
@@ -1356,8 +1367,8 @@ private:
     void _linkActiveChanged             (LinkInterface* link, bool active, int vehicleID);
     void _say                           (const QString& text);
     QString _vehicleIdSpeech            ();
-    void _handleMavlinkLoggingData      (mavlink_message_t& message);
-    void _handleMavlinkLoggingDataAcked (mavlink_message_t& message);
+    void _handleMavlinkLoggingData      (const mavlink_message_t& message);
+    void _handleMavlinkLoggingDataAcked (const mavlink_message_t& message);
     void _ackMavlinkLogData             (uint16_t sequence);
     void _sendNextQueuedMavCommand      ();
     void _updatePriorityLink            (bool updateActive, bool sendCommand);
@@ -1461,6 +1472,7 @@ private:
 
     ParameterManager*               _parameterManager               = nullptr;
     FTPManager*                     _ftpManager                     = nullptr;
+    MAVLinkMessageDispatcher        _messageDispatcher              { this };
     ComponentInformationManager*    _componentInformationManager    = nullptr;
     InitialConnectStateMachine*     _initialConnectStateMachine     = nullptr;
     VehicleObjectAvoidance*         _objectAvoidance                = nullptr;
@@ -1504,7 +1516,7 @@ private:
     uint                _messagesReceived;
     uint                _messagesSent;
     uint                _messagesLost;
-    uint8_t             _messageSeq;
+    quint64             _messagesLostBase       = 0;    ///< Link quality loss count at the last resetCounters
     uint8_t             _compID;
     bool                _heardFrom;
 
@@ -1537,6 +1549,9 @@ private:
     uint64_t    _mavlinkReceivedCount   = 0;
     uint64_t    _mavlinkLossCount       = 0;
     float       _mavlinkLossPercent     = 0.0f;
+    QTimer      _linkQualityTimer;
+
+    static const int _linkQualityUpdateMSecs = 1000;
 
     QMap<QString, QTime> _noisySpokenPrearmMap; ///< Used to prevent PreArm messages from being spoken too often
 
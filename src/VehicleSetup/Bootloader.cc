@@ -14,6 +14,7 @@
 #include <QSerialPortInfo>
 #include <QDebug>
 #include <QElapsedTimer>
+#include <QQueue>
 
 #include "QGC.h"
 
@@ -29,6 +30,8 @@ bool Bootloader::open(const QString portName)
 {
     qCDebug(FirmwareUpgradeLog) << "open:" << portName;
 
+    _device = &_port;
+
     _port.setPortName   (portName);
     _port.setBaudRate   (QSerialPort::Baud115200);
     _port.setDataBits   (QSerialPort::Data8);
@@ -57,8 +60,8 @@ QString Bootloader::_getNextLine(int timeoutMsecs)
     timeout.start();
     while (timeout.elapsed() < timeoutMsecs) {
         char oneChar;
-        _port.waitForReadyRead(100);
-        if (_port.read(&oneChar, 1) > 0) {
+        _device->waitForReadyRead(100);
+        if (_device->read(&oneChar, 1) > 0) {
             if (oneChar == '\r') {
                 foundCR = true;
                 continue;
@@ -84,15 +87,15 @@ bool Bootloader::getBoardInfo(uint32_t& bootloaderVersion, uint32_t& boardID, ui
             }
         } else {
             qCDebug(FirmwareUpgradeLog) << "Radio in normal mode";
-            _port.readAll();
+            _device->readAll();
             _port.setBaudRate(QSerialPort::Baud57600);
             // Put radio into command mode
             _write("+++");
-            if (!_port.waitForReadyRead(2000)) {
+            if (!_device->waitForReadyRead(2000)) {
                 _errorString = tr("Unable to put radio into command mode +++");
                 goto Error;
             }
-            QByteArray bytes = _port.readAll();
+            QByteArray bytes = _device->readAll();
             if (!bytes.contains("OK")) {
                 _errorString = tr("Radio did not respond to command mode");
                 goto Error;
@@ -162,7 +165,7 @@ bool Bootloader::initFlashSequence(void)
 {
     if (_sikRadio && !_inBootloaderMode) {
         _write("AT&UPDATE\r\n");
-        if (!_port.waitForReadyRead(1500)) {
+        if (!_device->waitForReadyRead(1500)) {
             _errorString = tr("Unable to reboot radio (ready read)");
             return false;
         }
@@ -199,19 +202,27 @@ bool Bootloader::reboot(void)
     bool success;
     if (_sikRadio && !_inBootloaderMode) {
         qCDebug(FirmwareUpgradeLog) << "reboot ATZ";
-        _port.readAll();
+        _device->readAll();
         success = _write("ATZ\r\n");
     } else {
         qCDebug(FirmwareUpgradeLog) << "reboot";
         success = _write(PROTO_BOOT) && _write(PROTO_EOC);
     }
-    _port.flush();
+    _flush();
     if (success) {
         QGC::SLEEP::msleep(1000);
     }
     return success;
 }
 
+void Bootloader::_flush(void)
+{
+    // Only the serial port buffers writes
+    if (_device == &_port) {
+        _port.flush();
+    }
+}
+
 bool Bootloader::_write(const char* data)
 {
     return _write((uint8_t*)data, qstrlen(data));
@@ -219,9 +230,9 @@ bool Bootloader::_write(const char* data)
 
 bool Bootloader::_write(const uint8_t* data, qint64 maxSize)
 {
-    qint64 bytesWritten = _port.write((const char*)data, maxSize);
+    qint64 bytesWritten = _device->write((const char*)data, maxSize);
     if (bytesWritten == -1) {
-        _errorString = tr("Write failed: %1").arg(_port.errorString());
+        _errorString = tr("Write failed: %1").arg(_device->errorString());
         qWarning() << _errorString;
         return false;
     }
@@ -245,19 +256,19 @@ bool Bootloader::_read(uint8_t* data, qint64 cBytesExpected, int readTimeout)
     QElapsedTimer timeout;
 
     timeout.start();
-    while (_port.bytesAvailable() < cBytesExpected) {
+    while (_device->bytesAvailable() < cBytesExpected) {
         if (timeout.elapsed() > readTimeout) {
             _errorString = tr("Timeout waiting for bytes to be available");
             return false;
         }
-        _port.waitForReadyRead(100);
+        _device->waitForReadyRead(100);
     }
 
     qint64 bytesRead;
-    bytesRead = _port.read((char *)data, cBytesExpected);
+    bytesRead = _device->read((char *)data, cBytesExpected);
 
     if (bytesRead != cBytesExpected) {
-        _errorString = tr("Read failed: error: %1").arg(_port.errorString());
+        _errorString = tr("Read failed: error: %1").arg(_device->errorString());
         return false;
     }
 
@@ -270,10 +281,12 @@ bool Bootloader::_getCommandResponse(int responseTimeout)
 {
     uint8_t response[2];
     
+    _lostSync = true;
     if (!_read(response, 2, responseTimeout)) {
         _errorString.prepend(tr("Get Command Response: "));
         return false;
     }
+    _lostSync = response[0] != PROTO_INSYNC || response[1] == PROTO_INVALID;
     
     // Make sure we get a good sync response
     if (response[0] != PROTO_INSYNC) {
@@ -348,61 +361,99 @@ bool Bootloader::_binProgram(const FirmwareImage* image)
         _errorString = tr("Unable to open firmware file %1: %2").arg(image->binFilename(), firmwareFile.errorString());
         return false;
     }
-    uint32_t imageSize = (uint32_t)firmwareFile.size();
-    
-    uint8_t imageBuf[PROG_MULTI_MAX];
-    uint32_t bytesSent = 0;
-    _imageCRC = 0;
-    
-    Q_ASSERT(PROG_MULTI_MAX <= 0x8F);
-    
-    while (bytesSent < imageSize) {
-        int bytesToSend = imageSize - bytesSent;
-        if (bytesToSend > (int)sizeof(imageBuf)) {
-            bytesToSend = (int)sizeof(imageBuf);
-        }
-        
-        Q_ASSERT((bytesToSend % 4) == 0);
-        
-        int bytesRead = firmwareFile.read((char *)imageBuf, bytesToSend);
-        if (bytesRead == -1 || bytesRead != bytesToSend) {
-            _errorString = tr("Firmware file read failed: %1").arg(firmwareFile.errorString());
-            return false;
-        }
-        
-        Q_ASSERT(bytesToSend <= 0x8F);
-        
-        bool failed = true;
-        if (_write(PROTO_PROG_MULTI) &&
-                _write((uint8_t)bytesToSend) &&
-                _write(imageBuf, bytesToSend) &&
-                _write(PROTO_EOC)) {
-            if (_getCommandResponse()) {
-                failed = false;
+    QByteArray imageBytes = firmwareFile.readAll();
+    if (imageBytes.size() != firmwareFile.size()) {
+        _errorString = tr("Firmware file read failed: %1").arg(firmwareFile.errorString());
+        return false;
+    }
+    firmwareFile.close();
+    const uint8_t*  imageBuf    = reinterpret_cast<const uint8_t*>(imageBytes.constData());
+    uint32_t        imageSize   = static_cast<uint32_t>(imageBytes.size());
+
+    Q_ASSERT((imageSize % 4) == 0);
+
+    // Calculate the CRC now so we can test it after the board is flashed
+    _imageCRC = _paddedImageCRC(imageBuf, imageSize);
+
+    int pipelineDepth = _bootloaderVersion >= _bootloaderVersionPipelined ? _pipelineDepth : 1;
+    if (_binProgramBlocks(imageBuf, imageSize, pipelineDepth)) {
+        return true;
+    }
+    if (pipelineDepth == 1 || !_lostSync) {
+        return false;
+    }
+
+    // Blocks in flight when sync was lost are in an unknown state, so start over a block at a time
+    qCWarning(FirmwareUpgradeLog) << "Pipelined programming lost sync, programming again unpipelined:" << _errorString;
+    _flush();
+    while (_device->waitForReadyRead(100)) {
+        _device->readAll();
+    }
+    if (!_sync() || !erase()) {
+        return false;
+    }
+    return _binProgramBlocks(imageBuf, imageSize, 1);
+}
+
+bool Bootloader::_binProgramBlocks(const uint8_t* imageBuf, uint32_t imageSize, int pipelineDepth)
+{
+    // The bootloader handles commands strictly in order, so PROG_MULTI commands can be written ahead of their
+    // responses. Pipelined programming uses larger blocks as well.
+    QQueue<uint32_t>    inFlight;       // Addresses of blocks waiting for a response
+    uint32_t            blockSize       = pipelineDepth > 1 ? PROG_MULTI_MAX_BIN : PROG_MULTI_MAX;
+    uint32_t            bytesSent       = 0;
+    QElapsedTimer       elapsed;
+
+    _programBytesPerSecond = 0;
+    elapsed.start();
+
+    while (bytesSent < imageSize || !inFlight.isEmpty()) {
+        if (bytesSent < imageSize && inFlight.count() < pipelineDepth) {
+            uint8_t     buf[PROG_MULTI_MAX_BIN + 3];
+            uint32_t    bytesToSend = qMin(imageSize - bytesSent, blockSize);
+
+            buf[0] = PROTO_PROG_MULTI;
+            buf[1] = static_cast<uint8_t>(bytesToSend);
+            memcpy(&buf[2], imageBuf + bytesSent, bytesToSend);
+            buf[bytesToSend + 2] = PROTO_EOC;
+            if (!_write(buf, bytesToSend + 3)) {
+                _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(bytesSent, 8, 16, QLatin1Char('0'));
+                return false;
             }
+
+            inFlight.enqueue(bytesSent);
+            bytesSent += bytesToSend;
+            continue;
         }
-        if (failed) {
-            _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(bytesSent, 8, 16, QLatin1Char('0'));
+
+        _flush();
+        uint32_t address = inFlight.dequeue();
+        if (!_getCommandResponse()) {
+            _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(address, 8, 16, QLatin1Char('0'));
             return false;
         }
 
-        bytesSent += bytesToSend;
+        emit updateProgress(qMin(address + blockSize, imageSize), imageSize);
+    }
 
-        // Calculate the CRC now so we can test it after the board is flashed.
-        _imageCRC = QGC::crc32((uint8_t *)imageBuf, bytesToSend, _imageCRC);
+    _programBytesPerSecond = static_cast<uint32_t>(static_cast<qint64>(imageSize) * 1000 / qMax(elapsed.elapsed(), static_cast<qint64>(1)));
+    qCDebug(FirmwareUpgradeLog) << "_binProgram: bytes" << imageSize << "msecs" << elapsed.elapsed() << "bytes/sec" << _programBytesPerSecond << "pipeline depth" << pipelineDepth;
 
-        emit updateProgress(bytesSent, imageSize);
-    }
-    firmwareFile.close();
+    return true;
+}
+
+/// The bootloader calculates its CRC over the entire flash size, with the unprogrammed remainder reading as 0xFF
+uint32_t Bootloader::_paddedImageCRC(const uint8_t* image, uint32_t imageSize) const
+{
+    uint32_t crc = QGC::crc32(image, imageSize, 0);
 
-    // We calculate the CRC using the entire flash size, filling the remainder with 0xFF.
-    while (bytesSent < _boardFlashSize) {
-        const uint8_t fill = 0xFF;
-        _imageCRC = QGC::crc32(&fill, 1, _imageCRC);
-        bytesSent++;
+    const QByteArray fill(4096, static_cast<char>(0xFF));
+    for (uint32_t offset = imageSize; offset < _boardFlashSize; offset += static_cast<uint32_t>(fill.size())) {
+        uint32_t cBytes = qMin(_boardFlashSize - offset, static_cast<uint32_t>(fill.size()));
+        crc = QGC::crc32(reinterpret_cast<const uint8_t*>(fill.constData()), cBytes, crc);
     }
 
-    return true;
+    return crc;
 }
 
 bool Bootloader::_ihxProgram(const FirmwareImage* image)
@@ -429,7 +480,7 @@ bool Bootloader::_ihxProgram(const FirmwareImage* image)
                 _write(flashAddress & 0xFF) &&
                 _write((flashAddress >> 8) & 0xFF) &&
                 _write(PROTO_EOC)) {
-            _port.flush();
+            _flush();
             if (_getCommandResponse()) {
                 failed = false;
             }
@@ -459,7 +510,7 @@ bool Bootloader::_ihxProgram(const FirmwareImage* image)
                     _write(bytesToWrite) &&
                     _write(&((uint8_t *)bytes.data())[bytesIndex], bytesToWrite) &&
                     _write(PROTO_EOC)) {
-                _port.flush();
+                _flush();
                 if (_getCommandResponse()) {
                     failed = false;
                 }
@@ -546,7 +597,7 @@ bool Bootloader::_binVerifyBytes(const FirmwareImage* image)
         if (_write(PROTO_READ_MULTI) &&
                 _write((uint8_t)bytesToRead) &&
                 _write(PROTO_EOC)) {
-            _port.flush();
+            _flush();
             if (_read(readBuf, bytesToRead)) {
                 if (_getCommandResponse()) {
                     failed = false;
@@ -601,7 +652,7 @@ bool Bootloader::_ihxVerifyBytes(const FirmwareImage* image)
                 _write(readAddress & 0xFF) &&
                 _write((readAddress >> 8) & 0xFF) &&
                 _write(PROTO_EOC)) {
-            _port.flush();
+            _flush();
             if (_getCommandResponse()) {
                 failed = false;
             }
@@ -631,7 +682,7 @@ bool Bootloader::_ihxVerifyBytes(const FirmwareImage* image)
             if (_write(PROTO_READ_MULTI) &&
                     _write(bytesToRead) &&
                     _write(PROTO_EOC)) {
-                _port.flush();
+                _flush();
                 if (_read(readBuf, bytesToRead)) {
                     if (_getCommandResponse()) {
                         failed = false;
@@ -672,7 +723,7 @@ bool Bootloader::_verifyCRC(void)
     
     bool failed = true;
     if (_write(buf, 2)) {
-        _port.flush();
+        _flush();
         if (_read((uint8_t*)&flashCRC, sizeof(flashCRC), _verifyTimeout)) {
             if (_getCommandResponse()) {
                 failed = false;
@@ -706,7 +757,7 @@ bool Bootloader::_syncWorker(void)
 bool Bootloader::_sync(void)
 {
     // Sometimes getting sync is flaky, try 3 times
-    _port.readAll();
+    _device->readAll();
     bool success = false;
     for (int i=0; i<3; i++) {
         success = _syncWorker();
@@ -721,7 +772,7 @@ bool Bootloader::_get3DRRadioBoardId(uint32_t& boardID)
     if (!_write(buf, sizeof(buf))) {
         goto Error;
     }
-    _port.flush();
+    _flush();
 
     if (!_read((uint8_t*)buf, 2)) {
         goto Error;
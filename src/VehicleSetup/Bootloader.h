@@ -26,13 +26,24 @@ public:
     QString errorString(void) { return _errorString; }
     
     bool open               (const QString portName);
-    void close              (void) { _port.close(); }
+    void close              (void) { _device->close(); }
     bool getBoardInfo       (uint32_t& bootloaderVersion, uint32_t& boardID, uint32_t& flashSize);
     bool initFlashSequence  (void);
     bool erase              (void);
     bool program            (const FirmwareImage* image);
     bool verify             (const FirmwareImage* image);
     bool reboot             (void);
+
+    /// Uses an already open device in place of a serial port. Used by unit tests to talk to a simulated bootloader.
+    void openDevice         (QIODevice* device) { _device = device; }
+
+    /// Opts in to writing up to depth PROG_MULTI_MAX_BIN sized blocks ahead of their responses when programming a .bin
+    /// image. Only used with bootloader revision 5 or later. If the bootloader loses sync part way through, the image
+    /// is erased and programmed again a block at a time.
+    void setPipelineDepth   (int depth) { _pipelineDepth = qMax(depth, 1); }
+
+    /// @return Programming throughput of the last .bin image, 0 if none
+    uint32_t programBytesPerSecond(void) const { return _programBytesPerSecond; }
     
     // Supported bootloader board ids
     static const int boardIDPX4FMUV1    = 5;        ///< PX4 V1 board, as from USB PID
@@ -67,7 +78,9 @@ private:
     bool    _sync               (void);
     bool    _syncWorker         (void);
     bool    _binProgram         (const FirmwareImage* image);
+    bool    _binProgramBlocks   (const uint8_t* imageBuf, uint32_t imageSize, int pipelineDepth);
     bool    _ihxProgram         (const FirmwareImage* image);
+    void    _flush              (void);
     bool    _write              (const uint8_t* data, qint64 maxSize);
     bool    _write              (const uint8_t byte);
     bool    _write              (const char* data);
@@ -79,6 +92,7 @@ private:
     bool    _binVerifyBytes     (const FirmwareImage* image);
     bool    _ihxVerifyBytes     (const FirmwareImage* image);
     bool    _verifyCRC          (void);
+    uint32_t _paddedImageCRC    (const uint8_t* image, uint32_t imageSize) const;
     QString _getNextLine        (int timeoutMsecs);
     bool    _get3DRRadioBoardId (uint32_t& boardID);
 
@@ -114,10 +128,12 @@ private:
         INFO_FLASH_SIZE		=   4,    ///< max firmware size in bytes
         
         PROG_MULTI_MAX		=   64,     ///< write size for PROTO_PROG_MULTI, must be multiple of 4
+        PROG_MULTI_MAX_BIN  =   252,    ///< write size for PROTO_PROG_MULTI with PX4 bootloaders, must be multiple of 4. Protocol max is 255
         READ_MULTI_MAX		=   0x28    ///< read size for PROTO_READ_MULTI, must be multiple of 4. Sik Radio max size is 0x28
     };
     
     QSerialPort _port;
+    QIODevice*  _device             = &_port;   ///< Device used for bootloader communication, normally _port
     bool        _sikRadio           = false;
     bool        _inBootloaderMode   = false;    ///< true: board is in bootloader mode, false: special case for SiK Radio, board is in command mode
     uint32_t    _boardID            = 0;        ///< board id for currently connected board
@@ -126,6 +142,9 @@ private:
     uint32_t    _imageCRC           = 0;        ///< CRC for image in currently selected firmware file
     QString     _firmwareFilename;              ///< Currently selected firmware file to flash
     QString     _errorString;                   ///< Last error
+    int         _pipelineDepth      = 1;
+    bool        _lostSync           = false;    ///< Last command response timed out or was out of sync
+    uint32_t    _programBytesPerSecond = 0;
     
     static const int _eraseTimeout                      = 20000;    ///< Msecs to wait for response from erase command
     static const int _rebootTimeout                     = 10000;    ///< Msecs to wait for reboot command to cause serial port to disconnect
@@ -134,4 +153,5 @@ private:
     static const int _responseTimeout                   = 2000;     ///< Msecs to wait for command response bytes
     static const int _flashSizeSmall                    = 1032192;  ///< Flash size for boards with silicon error
     static const int _bootloaderVersionV2CorrectFlash   = 5;        ///< Anything below this bootloader version on V2 boards cannot trust flash size
+    static const int _bootloaderVersionPipelined        = 5;        ///< Lowest bootloader version programmed with pipelined PROG_MULTI blocks
 };
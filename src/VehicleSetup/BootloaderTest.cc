@@ -0,0 +1,332 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "BootloaderTest.h"
+#include "Bootloader.h"
+#include "FirmwareImage.h"
+#include "QGC.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtEndian>
+#include <QThread>
+
+// Protocol bytes, see Bootloader.h
+static const uint8_t kInSync        = 0x12;
+static const uint8_t kEOC           = 0x20;
+static const uint8_t kOk            = 0x10;
+static const uint8_t kFailed        = 0x11;
+static const uint8_t kInvalid       = 0x13;
+static const uint8_t kGetSync       = 0x21;
+static const uint8_t kGetDevice     = 0x22;
+static const uint8_t kChipErase     = 0x23;
+static const uint8_t kProgMulti     = 0x27;
+static const uint8_t kGetCRC        = 0x29;
+static const uint8_t kBoot          = 0x30;
+
+static const uint32_t kFlashSize    = 256 * 1024;
+
+/// Bit at a time CRC32, independent of the table driven QGC::crc32
+static uint32_t _referenceCRC32(const uint8_t* data, uint32_t cBytes, uint32_t state)
+{
+    for (uint32_t i=0; i<cBytes; i++) {
+        state ^= data[i];
+        for (int bit=0; bit<8; bit++) {
+            state = (state & 1) ? (state >> 1) ^ 0xEDB88320 : state >> 1;
+        }
+    }
+    return state;
+}
+
+BootloaderSimulator::BootloaderSimulator(uint32_t flashSize)
+    : flash(static_cast<int>(flashSize), static_cast<char>(0xFF))
+{
+    open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+}
+
+qint64 BootloaderSimulator::readData(char* data, qint64 maxSize)
+{
+    int cBytes = static_cast<int>(qMin(maxSize, static_cast<qint64>(_output.size())));
+    memcpy(data, _output.constData(), static_cast<size_t>(cBytes));
+    _output.remove(0, cBytes);
+    return cBytes;
+}
+
+qint64 BootloaderSimulator::writeData(const char* data, qint64 maxSize)
+{
+    if (_input.size() + maxSize > inputCapacity) {
+        overrunCount++;
+        _input.clear();
+    } else {
+        _input.append(data, static_cast<int>(maxSize));
+    }
+    return maxSize;
+}
+
+bool BootloaderSimulator::waitForReadyRead(int msecs)
+{
+    while (_processCommand()) {
+    }
+    if (_output.isEmpty()) {
+        // Nothing is coming, wait like a real device would
+        QThread::msleep(static_cast<unsigned long>(msecs));
+        return false;
+    }
+    return true;
+}
+
+void BootloaderSimulator::_respond(uint8_t status)
+{
+    _output.append(static_cast<char>(kInSync));
+    _output.append(static_cast<char>(status));
+}
+
+void BootloaderSimulator::_respondValue(uint32_t value)
+{
+    uchar bytes[4];
+    qToLittleEndian<quint32>(value, bytes);
+    _output.append(reinterpret_cast<const char*>(bytes), 4);
+    _respond(kOk);
+}
+
+/// Handles the first complete command in the input
+///     @return false: no complete command available
+bool BootloaderSimulator::_processCommand(void)
+{
+    if (_input.isEmpty()) {
+        return false;
+    }
+
+    uint8_t command         = static_cast<uint8_t>(_input[0]);
+    int     commandLength   = 2;
+    if (command == kGetDevice) {
+        commandLength = 3;
+    } else if (command == kProgMulti) {
+        if (_input.size() < 2) {
+            return false;
+        }
+        commandLength = static_cast<uint8_t>(_input[1]) + 3;
+    }
+    if (_input.size() < commandLength) {
+        return false;
+    }
+
+    QByteArray commandBytes = _input.left(commandLength);
+    _input.remove(0, commandLength);
+    if (static_cast<uint8_t>(commandBytes[commandLength - 1]) != kEOC) {
+        _respond(kInvalid);
+        return true;
+    }
+
+    switch (command) {
+    case kGetSync:
+        _respond(kOk);
+        break;
+    case kGetDevice:
+        switch (commandBytes[1]) {
+        case 1:
+            _respondValue(bootloaderRev);
+            break;
+        case 2:
+            _respondValue(Bootloader::boardIDPX4FMUV5);
+            break;
+        case 4:
+            _respondValue(static_cast<uint32_t>(flash.size()));
+            break;
+        default:
+            _respond(kInvalid);
+            break;
+        }
+        break;
+    case kChipErase:
+        flash.fill(static_cast<char>(0xFF));
+        _address = 0;
+        _respond(kOk);
+        break;
+    case kProgMulti:
+    {
+        int cBytes = commandLength - 3;
+        if (_address == failAddress || (cBytes % 4) != 0 || _address + static_cast<uint32_t>(cBytes) > static_cast<uint32_t>(flash.size())) {
+            _respond(kFailed);
+        } else {
+            memcpy(flash.data() + _address, commandBytes.constData() + 2, static_cast<size_t>(cBytes));
+            _address += static_cast<uint32_t>(cBytes);
+            _respond(kOk);
+        }
+        maxResponsesPending = qMax(maxResponsesPending, _output.size() / 2);
+        break;
+    }
+    case kGetCRC:
+        _respondValue(_referenceCRC32(reinterpret_cast<const uint8_t*>(flash.constData()), static_cast<uint32_t>(flash.size()), 0));
+        break;
+    case kBoot:
+        break;
+    default:
+        _respond(kInvalid);
+        break;
+    }
+
+    return true;
+}
+
+QString BootloaderTest::_createImage(uint32_t imageSize)
+{
+    QFile file(QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("BootloaderTest.bin"));
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return QString();
+    }
+    QByteArray bytes(static_cast<int>(imageSize), 0);
+    for (int i=0; i<bytes.size(); i++) {
+        bytes[i] = static_cast<char>((i * 7) % 251);
+    }
+    file.write(bytes);
+    file.close();
+    return file.fileName();
+}
+
+void BootloaderTest::_testCRC(void)
+{
+    QByteArray bytes(4096, 0);
+    for (int i=0; i<bytes.size(); i++) {
+        bytes[i] = static_cast<char>(qrand());
+    }
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(bytes.constData());
+
+    // Unaligned starts and lengths which do and don't fill the eight byte steps, chained through a running state
+    uint32_t state = 0;
+    for (uint32_t offset=0; offset<9; offset++) {
+        for (uint32_t cBytes: { 0u, 1u, 7u, 8u, 9u, 63u, 1000u }) {
+            QCOMPARE(QGC::crc32(data + offset, cBytes, state), _referenceCRC32(data + offset, cBytes, state));
+            state = QGC::crc32(data + offset, cBytes, state);
+        }
+    }
+}
+
+void BootloaderTest::_testPipelinedProgram(void)
+{
+    // Not a multiple of the block size, so the last block is short
+    uint32_t    imageSize   = 100 * 1024 + 12;
+    QString     imageFile   = _createImage(imageSize);
+    QVERIFY(!imageFile.isEmpty());
+
+    FirmwareImage image;
+    QVERIFY(image.load(imageFile, Bootloader::boardIDPX4FMUV5));
+
+    QFile file(imageFile);
+    QVERIFY(file.open(QFile::ReadOnly));
+    QByteArray imageBytes = file.readAll();
+    file.close();
+
+    // Pipelining is opt in, and older bootloaders are programmed a block at a time regardless
+    static const struct {
+        uint32_t    bootloaderRev;
+        int         pipelineDepth;
+        int         expectedResponsesPending;
+    } rgCases[] = {
+        { 5, 1, 1 },
+        { 5, 4, 4 },    // Depth used when flashing from the firmware upgrade page
+        { 5, 8, 8 },
+        { 4, 8, 1 },
+    };
+
+    for (const auto& testCase: rgCases) {
+        BootloaderSimulator simulator(kFlashSize);
+        Bootloader          bootloader(false);
+
+        simulator.bootloaderRev = testCase.bootloaderRev;
+        bootloader.openDevice(&simulator);
+        bootloader.setPipelineDepth(testCase.pipelineDepth);
+
+        uint32_t bootloaderVersion, boardId, flashSize;
+        QVERIFY(bootloader.getBoardInfo(bootloaderVersion, boardId, flashSize));
+        QCOMPARE(flashSize, kFlashSize);
+        QVERIFY(bootloader.erase());
+        QVERIFY2(bootloader.program(&image), qPrintable(bootloader.errorString()));
+
+        // Verify compares the CRC precomputed while programming against the CRC of the whole simulated flash
+        QVERIFY2(bootloader.verify(&image), qPrintable(bootloader.errorString()));
+        QCOMPARE(simulator.flash.left(static_cast<int>(imageSize)), imageBytes);
+        QCOMPARE(simulator.maxResponsesPending, testCase.expectedResponsesPending);
+        QCOMPARE(simulator.overrunCount, 0);
+        QVERIFY(bootloader.programBytesPerSecond() > 0);
+
+        qCDebug(FirmwareUpgradeLog) << "Bootloader rev" << testCase.bootloaderRev << "pipeline depth" << testCase.pipelineDepth << "bytes/sec" << bootloader.programBytesPerSecond();
+    }
+
+    QFile::remove(imageFile);
+}
+
+void BootloaderTest::_testPipelineFallback(void)
+{
+    uint32_t    imageSize   = 16 * 1024;
+    QString     imageFile   = _createImage(imageSize);
+    QVERIFY(!imageFile.isEmpty());
+
+    FirmwareImage image;
+    QVERIFY(image.load(imageFile, Bootloader::boardIDPX4FMUV5));
+
+    QFile file(imageFile);
+    QVERIFY(file.open(QFile::ReadOnly));
+    QByteArray imageBytes = file.readAll();
+    file.close();
+
+    BootloaderSimulator simulator(kFlashSize);
+    Bootloader          bootloader(false);
+
+    // Eight blocks in flight overrun this bootloader, so programming has to start over a block at a time
+    simulator.inputCapacity = 1024;
+    bootloader.openDevice(&simulator);
+    bootloader.setPipelineDepth(8);
+
+    uint32_t bootloaderVersion, boardId, flashSize;
+    QVERIFY(bootloader.getBoardInfo(bootloaderVersion, boardId, flashSize));
+    QVERIFY(bootloader.erase());
+    QVERIFY2(bootloader.program(&image), qPrintable(bootloader.errorString()));
+    QVERIFY(simulator.overrunCount > 0);
+
+    QVERIFY2(bootloader.verify(&image), qPrintable(bootloader.errorString()));
+    QCOMPARE(simulator.flash.left(static_cast<int>(imageSize)), imageBytes);
+
+    QFile::remove(imageFile);
+}
+
+void BootloaderTest::_testProgramFailure(void)
+{
+    QString imageFile = _createImage(8 * 1024);
+    QVERIFY(!imageFile.isEmpty());
+
+    FirmwareImage image;
+    QVERIFY(image.load(imageFile, Bootloader::boardIDPX4FMUV5));
+
+    // Failure is reported against the block which failed, not the last block written. A failed write is not a loss
+    // of sync, so pipelined programming does not start over.
+    static const struct {
+        int         pipelineDepth;
+        uint32_t    failAddress;
+    } rgCases[] = {
+        { 1, 64 * 5 },
+        { 8, 252 * 5 },
+    };
+
+    for (const auto& testCase: rgCases) {
+        BootloaderSimulator simulator(kFlashSize);
+        Bootloader          bootloader(false);
+
+        simulator.failAddress = testCase.failAddress;
+        bootloader.openDevice(&simulator);
+        bootloader.setPipelineDepth(testCase.pipelineDepth);
+
+        uint32_t bootloaderVersion, boardId, flashSize;
+        QVERIFY(bootloader.getBoardInfo(bootloaderVersion, boardId, flashSize));
+        QVERIFY(bootloader.erase());
+        QVERIFY(!bootloader.program(&image));
+        QVERIFY2(bootloader.errorString().contains(QStringLiteral("0x%1").arg(testCase.failAddress, 8, 16, QLatin1Char('0'))), qPrintable(bootloader.errorString()));
+    }
+
+    QFile::remove(imageFile);
+}
@@ -0,0 +1,62 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QIODevice>
+
+/// Simulated PX4 bootloader. Written commands wait in a bounded input buffer and are handled when the client waits
+/// for a response. Writing more than the buffer holds overruns it, which loses the buffered commands like a real
+/// bootloader dropping bytes it has no room for.
+class BootloaderSimulator : public QIODevice
+{
+public:
+    BootloaderSimulator(uint32_t flashSize);
+
+    QByteArray  flash;                              ///< Flash contents
+    uint32_t    bootloaderRev       = 5;            ///< Reported protocol revision
+    uint32_t    failAddress         = 0xFFFFFFFF;   ///< PROG_MULTI at this address fails
+    int         inputCapacity       = 4096;         ///< Bytes of commands buffered before the input overruns
+    int         maxResponsesPending = 0;            ///< Most PROG_MULTI responses written but not yet read by the client
+    int         overrunCount        = 0;
+
+    // Overrides from QIODevice
+    bool    isSequential    (void) const override { return true; }
+    qint64  bytesAvailable  (void) const override { return _output.size() + QIODevice::bytesAvailable(); }
+    bool    waitForReadyRead(int msecs) override;
+
+protected:
+    qint64  readData        (char* data, qint64 maxSize) override;
+    qint64  writeData       (const char* data, qint64 maxSize) override;
+
+private:
+    bool    _processCommand (void);
+    void    _respond        (uint8_t status);
+    void    _respondValue   (uint32_t value);
+
+    QByteArray  _input;
+    QByteArray  _output;
+    uint32_t    _address    = 0;
+};
+
+class BootloaderTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testCRC               (void);
+    void _testPipelinedProgram  (void);
+    void _testPipelineFallback  (void);
+    void _testProgramFailure    (void);
+
+private:
+    QString _createImage        (uint32_t imageSize);
+};
@@ -137,7 +137,7 @@ Item {
         QGCTextField {
             text:               _activeJoystick.axisFrequency
             enabled:            advancedSettings.checked
-            validator:          DoubleValidator { bottom: 0.25; top: 50.0; }
+            validator:          DoubleValidator { bottom: 0.25; top: _activeJoystick.maxAxisFrequency; }
             inputMethodHints:   Qt.ImhFormattedNumbersOnly
             Layout.alignment:   Qt.AlignVCenter
             onEditingFinished: {
@@ -151,10 +151,16 @@ void PX4FirmwareUpgradeThreadWorker::_flash(void)
 
     if (_erase()) {
         emit status(tr("Programming new version..."));
-        
+
+        // Only takes effect on bootloader revision 5 and later, which fall back to a block at a time if they lose sync
+        _bootloader->setPipelineDepth(_flashPipelineDepth);
         if (_bootloader->program(_controller->image())) {
             qCDebug(FirmwareUpgradeLog) << "Program complete";
-            emit status("Program complete");
+            if (_bootloader->programBytesPerSecond()) {
+                emit status(tr("Program complete (%1 KB/s)").arg(_bootloader->programBytesPerSecond() / 1024.0, 0, 'f', 1));
+            } else {
+                emit status("Program complete");
+            }
         } else {
             qCDebug(FirmwareUpgradeLog) << "Program failed:" << _bootloader->errorString();
             goto Error;
@@ -74,6 +74,8 @@ private:
     bool                _boardIsSiKRadio        = false;
     bool                _findBoardFirstAttempt  = true;     ///< true: we found the board right away, it needs to be unplugged and plugged back in
     QGCSerialPortInfo   _foundBoardPortInfo;                ///< port info for found board
+
+    static const int    _flashPipelineDepth     = 4;        ///< PROG_MULTI blocks written ahead of their responses, about 1KB in flight
 };
 
 /// @brief Provides methods to interact with the bootloader. The commands themselves are signalled
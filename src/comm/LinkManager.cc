@@ -216,9 +216,9 @@ void LinkManager::_addLink(LinkInterface* link)
     }
 
     connect(link, &LinkInterface::communicationError,   _app,               &QGCApplication::criticalMessageBoxOnMainThread);
-    connect(link, &LinkInterface::bytesReceived,        _mavlinkProtocol,   &MAVLinkProtocol::receiveBytes);
     connect(link, &LinkInterface::bytesSent,            _mavlinkProtocol,   &MAVLinkProtocol::logSentBytes);
 
+    _mavlinkProtocol->registerLink(link);
     _mavlinkProtocol->resetMetadataForLink(link);
     _mavlinkProtocol->setVersion(_mavlinkProtocol->getCurrentVersion());
 
@@ -282,7 +282,8 @@ void LinkManager::_deleteLink(LinkInterface* link)
         return;
     }
 
-    // Free up the mavlink channel associated with this link
+    // Stop decoding data from the link and free up the mavlink channel associated with it
+    _mavlinkProtocol->unregisterLink(link);
     _freeMavlinkChannel(link->mavlinkChannel());
 
     for (int i=0; i<_sharedLinks.count(); i++) {
@@ -0,0 +1,188 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkQualityTracker.h"
+
+#include <QMutexLocker>
+
+LinkQualityTracker::LinkQualityTracker(void)
+{
+    _clock.start();
+}
+
+/// Moves the window forward to the bucket for the specified time, clearing any buckets which have aged out
+void LinkQualityTracker::_advanceWindow(Counters_t& counters, qint64 timestampUSecs)
+{
+    qint64 bucket = timestampUSecs / _bucketUSecs;
+
+    if (counters.firstUSecs < 0) {
+        counters.firstUSecs     = timestampUSecs;
+        counters.currentBucket  = bucket;
+        return;
+    }
+    if (bucket <= counters.currentBucket) {
+        return;
+    }
+
+    qint64 advance = qMin(bucket - counters.currentBucket, static_cast<qint64>(_windowBuckets));
+    for (qint64 i = 1; i <= advance; i++) {
+        int index = static_cast<int>((counters.currentBucket + i) % _windowBuckets);
+        counters.bucketReceived[index]  = 0;
+        counters.bucketLost[index]      = 0;
+    }
+    counters.currentBucket = bucket;
+}
+
+LinkQualityTracker::Stats_t LinkQualityTracker::update(uint8_t mavlinkChannel, const QVector<mavlink_message_t>& messages, qint64 timestampUSecs)
+{
+    Stats_t stats;
+
+    if (mavlinkChannel >= MAVLINK_COMM_NUM_BUFFERS) {
+        return stats;
+    }
+
+    ChannelState_t& channel = _channels[mavlinkChannel];
+    QMutexLocker    lock(&channel.mutex);
+
+    _advanceWindow(channel.counters, timestampUSecs);
+    int     bucketIndex = static_cast<int>(channel.counters.currentBucket % _windowBuckets);
+    quint64 chunk       = ++channel.chunkCount;
+
+    for (const mavlink_message_t& message: messages) {
+        ComponentState_t&   component   = channel.components[static_cast<quint16>((message.sysid << 8) | message.compid)];
+        Counters_t&         counters    = component.counters;
+        uint8_t             lost        = 0;
+
+        if (counters.firstUSecs >= 0) {
+            // Sequence numbers wrap at 256, so the distance from the expected sequence number is the number lost
+            lost = static_cast<uint8_t>(message.seq - static_cast<uint8_t>(component.lastSeq + 1));
+
+            // Inter-arrival jitter, smoothed the same way as RFC 3550. Messages after the first one from the
+            // component in this chunk share its timestamp and would only add zero length intervals.
+            if (component.lastChunk != chunk) {
+                float interval  = static_cast<float>(timestampUSecs - component.lastArrivalUSecs);
+                float deviation = qAbs(interval - component.meanIntervalUSecs);
+                component.meanIntervalUSecs += (interval - component.meanIntervalUSecs) * (1.0f / 16.0f);
+                component.jitterUSecs       += (deviation - component.jitterUSecs) * (1.0f / 16.0f);
+            }
+        }
+        _advanceWindow(counters, timestampUSecs);
+        component.lastSeq           = message.seq;
+        component.lastArrivalUSecs  = timestampUSecs;
+        component.lastChunk         = chunk;
+
+        counters.totalReceived++;
+        counters.totalLost += lost;
+        counters.bucketReceived[bucketIndex]++;
+        counters.bucketLost[bucketIndex] += lost;
+
+        channel.counters.totalReceived++;
+        channel.counters.totalLost += lost;
+        channel.counters.bucketReceived[bucketIndex]++;
+        channel.counters.bucketLost[bucketIndex] += lost;
+    }
+
+    _accumulate(channel.counters, timestampUSecs, stats);
+    _finalize(stats, 0);
+
+    return stats;
+}
+
+void LinkQualityTracker::resetChannel(uint8_t mavlinkChannel)
+{
+    if (mavlinkChannel >= MAVLINK_COMM_NUM_BUFFERS) {
+        return;
+    }
+
+    ChannelState_t& channel = _channels[mavlinkChannel];
+    QMutexLocker    lock(&channel.mutex);
+
+    channel.components.clear();
+    channel.counters    = Counters_t();
+    channel.chunkCount  = 0;
+}
+
+/// Adds the totals and the part of the window which is still current to stats
+void LinkQualityTracker::_accumulate(const Counters_t& counters, qint64 nowUSecs, Stats_t& stats)
+{
+    stats.totalReceived += counters.totalReceived;
+    stats.totalLost     += counters.totalLost;
+
+    qint64 nowBucket    = nowUSecs / _bucketUSecs;
+    qint64 age          = nowBucket - counters.currentBucket;
+    if (counters.firstUSecs < 0 || age >= _windowBuckets) {
+        return;
+    }
+
+    quint32 received    = 0;
+    quint32 lost        = 0;
+    for (qint64 i = 0; i < _windowBuckets - age; i++) {
+        int index = static_cast<int>((counters.currentBucket - i + _windowBuckets) % _windowBuckets);
+        received    += counters.bucketReceived[index];
+        lost        += counters.bucketLost[index];
+    }
+    stats.windowReceived    += received;
+    stats.windowLost        += lost;
+
+    // Rate is over the part of the window the counters have actually been running for, but at least one bucket
+    qint64 windowStartUSecs = qMax(counters.firstUSecs, (nowBucket - _windowBuckets + 1) * _bucketUSecs);
+    qint64 spanUSecs        = qMax(nowUSecs - windowStartUSecs, static_cast<qint64>(_bucketUSecs));
+    stats.rateHz += (static_cast<double>(received) * 1.0e6) / static_cast<double>(spanUSecs);
+}
+
+void LinkQualityTracker::_finalize(Stats_t& stats, double weightedJitterUSecs)
+{
+    quint32 windowSent = stats.windowReceived + stats.windowLost;
+    if (windowSent) {
+        stats.windowLossPercent = (static_cast<double>(stats.windowLost) * 100.0) / static_cast<double>(windowSent);
+    }
+    if (stats.windowReceived) {
+        stats.jitterMSecs = (weightedJitterUSecs / stats.windowReceived) / 1000.0;
+    }
+}
+
+LinkQualityTracker::Stats_t LinkQualityTracker::stats(int mavlinkChannel, int sysid, int compid) const
+{
+    Stats_t stats;
+    double  weightedJitterUSecs = 0;
+    qint64  nowUSecs            = timestampUSecs();
+
+    int firstChannel    = mavlinkChannel == anyId ? 0 : mavlinkChannel;
+    int lastChannel     = mavlinkChannel == anyId ? MAVLINK_COMM_NUM_BUFFERS - 1 : mavlinkChannel;
+
+    for (int i = qMax(firstChannel, 0); i <= qMin(lastChannel, MAVLINK_COMM_NUM_BUFFERS - 1); i++) {
+        const ChannelState_t&   channel = _channels[i];
+        QMutexLocker            lock(&channel.mutex);
+
+        for (auto iter = channel.components.constBegin(); iter != channel.components.constEnd(); iter++) {
+            if ((sysid != anyId && (iter.key() >> 8) != sysid) || (compid != anyId && (iter.key() & 0xFF) != compid)) {
+                continue;
+            }
+
+            quint32 windowReceived = stats.windowReceived;
+            _accumulate(iter.value().counters, nowUSecs, stats);
+            weightedJitterUSecs += static_cast<double>(iter.value().jitterUSecs) * (stats.windowReceived - windowReceived);
+        }
+    }
+    _finalize(stats, weightedJitterUSecs);
+
+    return stats;
+}
+
+QList<quint16> LinkQualityTracker::components(uint8_t mavlinkChannel) const
+{
+    if (mavlinkChannel >= MAVLINK_COMM_NUM_BUFFERS) {
+        return QList<quint16>();
+    }
+
+    const ChannelState_t&   channel = _channels[mavlinkChannel];
+    QMutexLocker            lock(&channel.mutex);
+
+    return channel.components.keys();
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include "QGCMAVLink.h"
+
+/// Sequence loss, message rate and jitter statistics for incoming MAVLink traffic, tracked per
+/// (mavlink channel, sysid, compid).
+///
+/// Each channel is only ever updated from the thread which decodes it, and all messages decoded from a single chunk
+/// of bytes are accounted for under a single lock of the channel. Counters are integers which are bumped per message.
+/// Percentages and rates are only calculated when stats are queried. Windowed values cover the last few seconds of
+/// traffic, kept as per second buckets so old traffic drops out without rescanning anything.
+class LinkQualityTracker
+{
+public:
+    LinkQualityTracker(void);
+
+    typedef struct {
+        quint64 totalReceived       = 0;
+        quint64 totalLost           = 0;
+        quint32 windowReceived      = 0;
+        quint32 windowLost          = 0;
+        double  windowLossPercent   = 0;    ///< Loss over the window
+        double  rateHz              = 0;    ///< Received messages per second over the window
+        double  jitterMSecs         = 0;    ///< Smoothed deviation of the inter-arrival time of the chunks carrying the messages
+
+        quint64 totalSent(void) const { return totalReceived + totalLost; }
+    } Stats_t;
+
+    static const int anyId = -1;
+
+    /// @return Monotonic timestamp for use with update
+    qint64 timestampUSecs(void) const { return _clock.nsecsElapsed() / 1000; }
+
+    /// Accounts for the messages decoded from a single chunk of bytes. Must only be called from the thread which
+    /// decodes the channel. All messages in a chunk share the same arrival time, so jitter is only measured between
+    /// chunks.
+    /// @return Updated stats for the whole channel
+    Stats_t update(uint8_t mavlinkChannel, const QVector<mavlink_message_t>& messages, qint64 timestampUSecs);
+
+    /// Clears all state for the channel. Used when the channel is assigned to a new link.
+    void resetChannel(uint8_t mavlinkChannel);
+
+    // The following methods are thread safe
+
+    /// @return Stats combined over all matching channels/systems/components
+    Stats_t stats(int mavlinkChannel = anyId, int sysid = anyId, int compid = anyId) const;
+
+    /// @return sysid/compid pairs seen on the channel, as sysid << 8 | compid
+    QList<quint16> components(uint8_t mavlinkChannel) const;
+
+private:
+    static const int    _windowBuckets  = 5;
+    static const qint64 _bucketUSecs    = 1000000;
+
+    typedef struct {
+        quint64 totalReceived                   = 0;
+        quint64 totalLost                       = 0;
+        qint64  firstUSecs                      = -1;
+        qint64  currentBucket                   = 0;
+        quint32 bucketReceived[_windowBuckets]  = {};
+        quint32 bucketLost[_windowBuckets]      = {};
+    } Counters_t;
+
+    typedef struct {
+        Counters_t  counters;
+        qint64      lastArrivalUSecs    = 0;
+        quint64     lastChunk           = 0;    ///< Last chunk which contained a message from the component
+        float       meanIntervalUSecs   = 0;
+        float       jitterUSecs         = 0;
+        uint8_t     lastSeq             = 0;
+    } ComponentState_t;
+
+    typedef struct {
+        mutable QMutex                      mutex;
+        QHash<quint16, ComponentState_t>    components;     ///< Keyed by sysid << 8 | compid
+        Counters_t                          counters;       ///< Totals for the whole channel
+        quint64                             chunkCount = 0; ///< Number of chunks accounted for, used to spot the first message of a component in a chunk
+    } ChannelState_t;
+
+    static void _advanceWindow  (Counters_t& counters, qint64 timestampUSecs);
+    static void _accumulate     (const Counters_t& counters, qint64 nowUSecs, Stats_t& stats);
+    static void _finalize       (Stats_t& stats, double weightedJitterUSecs);
+
+    ChannelState_t  _channels[MAVLINK_COMM_NUM_BUFFERS];
+    QElapsedTimer   _clock;
+};
@@ -13,7 +13,6 @@
 #include "QGCApplication.h"
 
 #include <QFileInfo>
-#include <QtEndian>
 #include <QSignalSpy>
 
 const char*  LogReplayLinkConfiguration::_logFilenameKey = "logFilename";
@@ -71,6 +70,7 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPointer& config)
     , _logReplayConfig  (qobject_cast<LogReplayLinkConfiguration*>(config.data()))
     , _connected        (false)
     , _playbackSpeed    (1)
+    , _playheadOffset   (0)
 {
     if (!_logReplayConfig) {
         qWarning() << "Internal error";
@@ -78,6 +78,8 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPointer& config)
 
     _errorTitle = tr("Log Replay Error");
     
+    _readTickTimer.setInterval(_readTickIntervalMSecs);
+    _readTickTimer.setTimerType(Qt::PreciseTimer);
     _readTickTimer.moveToThread(this);
     
     QObject::connect(&_readTickTimer, &QTimer::timeout,                 this, &LogReplayLink::_readNextLogEntry);
@@ -101,12 +103,6 @@ bool LogReplayLink::_connect(void)
         return false;
     }
 
-    _mavlinkChannel = qgcApp()->toolbox()->linkManager()->_reserveMavlinkChannel();
-    if (_mavlinkChannel == 0) {
-        qWarning() << "No mavlink channels available";
-        return false;
-    }
-
     if (isRunning()) {
         quit();
         wait();
@@ -122,10 +118,6 @@ void LogReplayLink::_disconnect(void)
         wait();
         _connected = false;
 
-        if (_mavlinkChannel != 0) {
-            qgcApp()->toolbox()->linkManager()->_freeMavlinkChannel(_mavlinkChannel);
-        }
-
         emit disconnected();
     }
 }
@@ -147,6 +139,7 @@ void LogReplayLink::run(void)
     exec();
     
     _readTickTimer.stop();
+    _logReader.close();
 }
 
 void LogReplayLink::_replayError(const QString& errorMsg)
@@ -161,203 +154,75 @@ void LogReplayLink::_writeBytes(const QByteArray bytes)
     Q_UNUSED(bytes);
 }
 
-/// Parses a BigEndian quint64 timestamp
-/// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
-quint64 LogReplayLink::_parseTimestamp(const QByteArray& bytes)
-{
-    quint64 timestamp = qFromBigEndian(*((quint64*)(bytes.constData())));
-    quint64 currentTimestamp = ((quint64)QDateTime::currentMSecsSinceEpoch()) * 1000;
-    
-    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
-    // little endian, so switch it.
-    if (timestamp > currentTimestamp) {
-        timestamp = qbswap(timestamp);
-    }
-    
-    return timestamp;
-}
-
-/// Reads the next mavlink message from the log
-///     @param bytes[output] Bytes for mavlink message
-/// @return Unix timestamp in microseconds UTC for NEXT mavlink message or 0 if no message found
-quint64 LogReplayLink::_readNextMavlinkMessage(QByteArray& bytes)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-
-    bytes.clear();
-
-    while (_logFile.getChar(&nextByte)) { // Loop over every byte
-        mavlink_message_t message;
-        bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, &message, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            // This is the possible beginning of a mavlink message, clear any partial bytes
-            bytes.clear();
-        }
-        bytes.append(nextByte);
-
-        if (messageFound) {
-            // Return the timestamp for the next message
-            QByteArray rawTime = _logFile.read(cbTimestamp);
-            return _parseTimestamp(rawTime);
-        }
-    }
-
-    return 0;
-}
-
-/// Seeks to the beginning of the next successfully parsed mavlink message in the log file.
-///     @param nextMsg[output] Parsed next message that was found
-/// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
-quint64 LogReplayLink::_seekToNextMavlinkMessage(mavlink_message_t* nextMsg)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-    qint64              messageStartPos = -1;
-
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.getChar(&nextByte)) {
-        bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, nextMsg, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            // This is the possible beginning of a mavlink message
-            messageStartPos = _logFile.pos() - 1;
-        }
-        
-        // If we've found a message, jump back to the start of the message, grab the timestamp,
-        // and go back to the end of this file.
-        if (messageFound && messageStartPos != -1) {
-            _logFile.seek(messageStartPos - cbTimestamp);
-            QByteArray rawTime = _logFile.read(cbTimestamp);
-            return _parseTimestamp(rawTime);
-        }
-    }
-    
-    return 0;
-}
-
-quint64 LogReplayLink::_findLastTimestamp(void)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-    quint64             lastTimestamp = 0;
-    mavlink_message_t   msg;
-
-    // We read through the entire file looking for the last good timestamp. This can be somewhat slow, but trying to work from the
-    // end of the file can be way slower due to all the seeking back and forth required. So instead we take the simple reliable approach.
-
-    _logFile.reset();
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.bytesAvailable() > cbTimestamp) {
-        lastTimestamp = _parseTimestamp(_logFile.read(cbTimestamp));
-
-        bool endOfMessage = false;
-        while (!endOfMessage && _logFile.getChar(&nextByte)) {
-            endOfMessage = mavlink_parse_char(_mavlinkChannel, nextByte, &msg, &status);
-        }
-    }
-
-    return lastTimestamp;
-}
-
 bool LogReplayLink::_loadLogFile(void)
 {
     QString errorMsg;
-    QString logFilename = _logReplayConfig->logFilename();
-    QFileInfo logFileInfo;
-    int logDurationSecondsTotal;
-    quint64 startTimeUSecs;
-    quint64 endTimeUSecs;
-
-    if (_logFile.isOpen()) {
-        errorMsg = tr("Attempt to load new log while log being played");
-        goto Error;
-    }
-    
-    _logFile.setFileName(logFilename);
-    if (!_logFile.open(QFile::ReadOnly)) {
-        errorMsg = tr("Unable to open log file: '%1', error: %2").arg(logFilename).arg(_logFile.errorString());
-        goto Error;
+
+    if (_logReader.isOpen()) {
+        _replayError(tr("Attempt to load new log while log being played"));
+        return false;
     }
-    logFileInfo.setFile(logFilename);
-    _logFileSize = logFileInfo.size();
-    
-    startTimeUSecs = _parseTimestamp(_logFile.read(cbTimestamp));
-    endTimeUSecs = _findLastTimestamp();
 
-    if (endTimeUSecs <= startTimeUSecs) {
-        errorMsg = tr("The log file '%1' is corrupt or empty.").arg(logFilename);
-        goto Error;
+    if (!_logReader.open(_logReplayConfig->logFilename(), errorMsg)) {
+        _replayError(errorMsg);
+        return false;
     }
 
-    // Remember the start and end time so we can move around this _logFile with the slider.
-    _logEndTimeUSecs = endTimeUSecs;
-    _logStartTimeUSecs = startTimeUSecs;
-    _logDurationUSecs = endTimeUSecs - startTimeUSecs;
-    _logCurrentTimeUSecs = startTimeUSecs;
+    // Remember the start and end time so we can move around the log with the slider.
+    _logStartTimeUSecs = _logReader.startTimeUSecs();
+    _logEndTimeUSecs = _logReader.endTimeUSecs();
+    _logDurationUSecs = _logEndTimeUSecs - _logStartTimeUSecs;
 
-    // Reset our log file so when we go to read it for the first time, we start at the beginning.
-    _logFile.reset();
+    _resetPlaybackToBeginning();
 
-    logDurationSecondsTotal = (_logDurationUSecs) / 1000000;
-    
-    emit logFileStats(logDurationSecondsTotal);
+    emit logFileStats(static_cast<int>(_logDurationUSecs / 1000000));
     
     return true;
-    
-Error:
-    if (_logFile.isOpen()) {
-        _logFile.close();
-    }
-    _replayError(errorMsg);
-    return false;
 }
 
-/// This function will read the next available log entry. It will then start
-/// the _readTickTimer timer to read the new log entry at the appropriate time.
-/// It might not perfectly match the timing of the log file, but it will never
-/// induce a static drift into the log file replay.
+/// Called on each tick of the _readTickTimer. Sends all log records whose time has been reached as a single
+/// bytesReceived chunk. Timing is calculated relative to the start of playback so there is no drift, and the tick
+/// rate is independent of both the message rate in the log and the playback speed.
 void LogReplayLink::_readNextLogEntry(void)
 {
+    quint64 elapsedMSecs            = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) - _playbackStartTimeMSecs;
+    quint64 targetLogTimeUSecs      = _playbackStartLogTimeUSecs + static_cast<quint64>(elapsedMSecs * 1000 * _playbackSpeed);
+    bool    atEnd                   = false;
     QByteArray bytes;
 
-    // Now parse MAVLink messages, grabbing their timestamps as we go. We stop once we
-    // have at least 3ms until the next one.
-
-    // We track what the next execution time should be in milliseconds, which we use to set
-    // the next timer interrupt.
-    int timeToNextExecutionMSecs = 0;
-
-    while (timeToNextExecutionMSecs < 3) {
-        // Read the next mavlink message from the log
-        qint64 nextTimeUSecs = _readNextMavlinkMessage(bytes);
-        emit bytesReceived(this, bytes);
-        emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
+    while (bytes.size() < _maxBytesPerTick) {
+        TlogReader::Record_t    record;
+        qint64                  nextOffset = _playheadOffset;
 
-        if (_logFile.atEnd()) {
-            _finishPlayback();
-            return;
+        if (!_logReader.readRecord(nextOffset, record)) {
+            // A truncated or corrupt tail has no more records, move the playhead past it so playback completes
+            _playheadOffset = nextOffset;
+            _logCurrentTimeUSecs = _logEndTimeUSecs;
+            atEnd = true;
+            break;
+        }
+        if (record.timestampUSecs > targetLogTimeUSecs) {
+            // Resume from this record on the next tick, without rescanning any corrupt bytes in front of it
+            _playheadOffset = nextOffset - TlogReader::cbTimestamp - record.packetLength;
+            break;
         }
 
-        _logCurrentTimeUSecs = nextTimeUSecs;
-
-        // Calculate how long we should wait in real time until parsing this message.
-        // We pace ourselves relative to the start time of playback to fix any drift (initially set in play())
-
-        quint64 currentTimeMSecs =                  (quint64)QDateTime::currentMSecsSinceEpoch();
-        quint64 desiredPlayheadMovementTimeMSecs =  ((_logCurrentTimeUSecs - _playbackStartLogTimeUSecs) / 1000) / _playbackSpeed;
-        quint64 desiredCurrentTimeMSecs =           _playbackStartTimeMSecs + desiredPlayheadMovementTimeMSecs;
-
-        timeToNextExecutionMSecs = desiredCurrentTimeMSecs - currentTimeMSecs;
+        bytes.append(reinterpret_cast<const char*>(record.packet), record.packetLength);
+        _playheadOffset = nextOffset;
+        _logCurrentTimeUSecs = record.timestampUSecs;
     }
 
-    _signalCurrentLogTimeSecs();
+    if (!bytes.isEmpty()) {
+        emit bytesReceived(this, bytes);
+    }
+    if (!bytes.isEmpty() || atEnd) {
+        emit playbackPercentCompleteChanged((static_cast<qreal>(_logCurrentTimeUSecs - _logStartTimeUSecs) / _logDurationUSecs) * 100);
+        _signalCurrentLogTimeSecs();
+    }
 
-    // And schedule the next execution of this function.
-    _readTickTimer.start(timeToNextExecutionMSecs);
+    if (atEnd) {
+        _finishPlayback();
+    }
 }
 
 void LogReplayLink::_play(void)
@@ -368,13 +233,13 @@ void LogReplayLink::_play(void)
 #endif
     
     // Make sure we aren't at the end of the file, if we are, reset to the beginning and play from there.
-    if (_logFile.atEnd()) {
+    if (_playheadOffset >= _logReader.size()) {
         _resetPlaybackToBeginning();
     }
     
     _playbackStartTimeMSecs = (quint64)QDateTime::currentMSecsSinceEpoch();
     _playbackStartLogTimeUSecs = _logCurrentTimeUSecs;
-    _readTickTimer.start(1);
+    _readTickTimer.start();
     
     emit playbackStarted();
 }
@@ -393,9 +258,7 @@ void LogReplayLink::_pause(void)
 
 void LogReplayLink::_resetPlaybackToBeginning(void)
 {
-    if (_logFile.isOpen()) {
-        _logFile.reset();
-    }
+    _playheadOffset = 0;
     
     // And since we haven't starting playback, clear the time of initial playback and the current timestamp.
     _playbackStartTimeMSecs = 0;
@@ -420,46 +283,18 @@ void LogReplayLink::movePlayhead(qreal percentComplete)
     if (percentComplete > 100) {
         percentComplete = 100;
     }
-    
-    qreal percentCompleteMult = percentComplete / 100.0;
-    
-    // But if we have a timestamped MAVLink log, then actually aim to hit that percentage in terms of
-    // time through the file.
-    qint64 newFilePos = (qint64)(percentCompleteMult * (qreal)_logFile.size());
 
-    // Now seek to the appropriate position, failing gracefully if we can't.
-    if (!_logFile.seek(newFilePos)) {
-        _replayError(tr("Unable to seek to new position"));
-        return;
-    }
+    // Seek directly to the requested time through the log using the index
+    quint64 desiredTimeUSecs = _logStartTimeUSecs + static_cast<quint64>((percentComplete / 100.0) * _logDurationUSecs);
+    _playheadOffset = _logReader.offsetForTimestamp(desiredTimeUSecs);
 
-    // But we do align to the next MAVLink message for consistency.
-    mavlink_message_t dummy;
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
-
-    // Now calculate the current file location based on time.
-    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
-
-    // Calculate the effective baud rate of the file in bytes/s.
-    qreal baudRate = _logFile.size() / (qreal)_logDurationUSecs / 1e6;
-
-    // And the desired time is:
-    qreal desiredTimeUSecs = percentCompleteMult * _logDurationUSecs;
-
-    // And now jump the necessary number of bytes in the proper direction
-    qint64 offset = (newRelativeTimeUSecs - desiredTimeUSecs) * baudRate;
-    if (!_logFile.seek(_logFile.pos() + offset)) {
-        _replayError(tr("Unable to seek to new position"));
-        return;
-    }
-
-    // And scan until we reach the start of a MAVLink message. We make sure to record this timestamp for
-    // smooth jumping around the file.
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
+    TlogReader::Record_t    record;
+    qint64                  recordOffset = _playheadOffset;
+    _logCurrentTimeUSecs = _logReader.readRecord(recordOffset, record) ? record.timestampUSecs : _logEndTimeUSecs;
     _signalCurrentLogTimeSecs();
 
     // Now update the UI with our actual final position.
-    newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
+    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
     percentComplete = (newRelativeTimeUSecs / _logDurationUSecs) * 100;
     emit playbackPercentCompleteChanged(percentComplete);
 }
@@ -468,10 +303,9 @@ void LogReplayLink::_setPlaybackSpeed(qreal playbackSpeed)
 {
     _playbackSpeed = playbackSpeed;
     
-    // Let _readNextLogEntry update to correct speed
+    // Restart pacing from the current position at the new speed
     _playbackStartTimeMSecs = (quint64)QDateTime::currentMSecsSinceEpoch();
     _playbackStartLogTimeUSecs = _logCurrentTimeUSecs;
-    _readTickTimer.start(1);
 }
 
 /// @brief Called when playback is complete
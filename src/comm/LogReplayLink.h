@@ -11,9 +11,9 @@
 
 #include "LinkManager.h"
 #include "MAVLinkProtocol.h"
+#include "TlogReader.h"
 
 #include <QTimer>
-#include <QFile>
 
 class LogReplayLinkConfiguration : public LinkConfiguration
 {
@@ -107,10 +107,6 @@ private:
     ~LogReplayLink();
 
     void    _replayError                (const QString& errorMsg);
-    quint64 _parseTimestamp             (const QByteArray& bytes);
-    quint64 _seekToNextMavlinkMessage   (mavlink_message_t* nextMsg);
-    quint64 _findLastTimestamp          (void);
-    quint64 _readNextMavlinkMessage     (QByteArray& bytes);
     bool    _loadLogFile                (void);
     void    _finishPlayback             (void);
     void    _resetPlaybackToBeginning   (void);
@@ -126,12 +122,11 @@ private:
     LogReplayLinkConfiguration* _logReplayConfig;
 
     bool    _connected;
-    uint8_t _mavlinkChannel;
-    QTimer  _readTickTimer;      ///< Timer which signals a read of next log record
+    QTimer  _readTickTimer;      ///< Timer which signals a read of the log records which are due for playback
 
     QString _errorTitle; ///< Title for communicatorError signals
 
-    quint64 _logCurrentTimeUSecs;   ///< The timestamp of the next message in the log file.
+    quint64 _logCurrentTimeUSecs;   ///< The timestamp of the last message played from the log file.
     quint64 _logStartTimeUSecs;     ///< The first timestamp in the current log file.
     quint64 _logEndTimeUSecs;       ///< The last timestamp in the current log file.
     quint64 _logDurationUSecs;
@@ -141,10 +136,11 @@ private:
     quint64 _playbackStartLogTimeUSecs;
 
     MAVLinkProtocol*    _mavlink;
-    QFile               _logFile;
-    quint64             _logFileSize;
+    TlogReader          _logReader;
+    qint64              _playheadOffset;    ///< File offset of the next record to play
 
-    static const int cbTimestamp = sizeof(quint64);
+    static const int _readTickIntervalMSecs = 20;
+    static const int _maxBytesPerTick       = 1024 * 1024;  ///< Limits the size of a single bytesReceived chunk at high playback speeds
 };
 
 class LogReplayLinkController : public QObject
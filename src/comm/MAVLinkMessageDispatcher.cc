@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageDispatcher.h"
+#include "QGCLoggingCategory.h"
+
+#include <QElapsedTimer>
+
+QGC_LOGGING_CATEGORY(MAVLinkMessageDispatcherLog, "MAVLinkMessageDispatcherLog")
+
+MAVLinkMessageDispatcher::MAVLinkMessageDispatcher(QObject* parent)
+    : QObject               (parent)
+    , _directTable          (_directTableSize)
+    , _nextSubscriptionId   (1)
+{
+    for (MsgidEntry_t& entry: _directTable) {
+        entry.dispatchCount = 0;
+        entry.handlerNSecs  = 0;
+    }
+
+    // Costs are always collected, but only logged periodically when the category is enabled
+    if (MAVLinkMessageDispatcherLog().isDebugEnabled()) {
+        _costLogTimer.setInterval(_costLogIntervalMSecs);
+        connect(&_costLogTimer, &QTimer::timeout, this, &MAVLinkMessageDispatcher::_logCosts);
+        _costLogTimer.start();
+    }
+}
+
+MAVLinkMessageDispatcher::MsgidEntry_t* MAVLinkMessageDispatcher::_entry(uint32_t msgid, bool create)
+{
+    if (msgid < _directTableSize) {
+        return &_directTable[static_cast<int>(msgid)];
+    }
+
+    auto iter = _overflowTable.find(msgid);
+    if (iter != _overflowTable.end()) {
+        return &iter.value();
+    }
+    if (create) {
+        MsgidEntry_t entry;
+        entry.dispatchCount = 0;
+        entry.handlerNSecs  = 0;
+        return &_overflowTable.insert(msgid, entry).value();
+    }
+    return nullptr;
+}
+
+const MAVLinkMessageDispatcher::MsgidEntry_t* MAVLinkMessageDispatcher::_constEntry(uint32_t msgid) const
+{
+    if (msgid < _directTableSize) {
+        return &_directTable[static_cast<int>(msgid)];
+    }
+
+    auto iter = _overflowTable.constFind(msgid);
+    return iter != _overflowTable.constEnd() ? &iter.value() : nullptr;
+}
+
+int MAVLinkMessageDispatcher::subscribe(QObject* context, uint32_t msgid, Handler_t handler, int sysid, int compid, Priority_t priority)
+{
+    SharedSubscription_t subscription(new Subscription_t);
+
+    subscription->id            = _nextSubscriptionId++;
+    subscription->context       = context;
+    subscription->msgid         = msgid;
+    subscription->sysid         = sysid;
+    subscription->compid        = compid;
+    subscription->priority      = priority;
+    subscription->handler       = handler;
+    subscription->active        = true;
+    subscription->callCount     = 0;
+    subscription->handlerNSecs  = 0;
+
+    // Insert after all subscriptions of the same or higher priority
+    SubscriptionList_t& subscriptions = _entry(msgid, true)->subscriptions;
+    int index = subscriptions.count();
+    while (index > 0 && subscriptions[index - 1]->priority > priority) {
+        index--;
+    }
+    subscriptions.insert(index, subscription);
+
+    _subscriptions[subscription->id] = subscription;
+    _contextSubscriptions.insert(context, subscription);
+    connect(context, &QObject::destroyed, this, &MAVLinkMessageDispatcher::_contextDestroyed, Qt::UniqueConnection);
+
+    return subscription->id;
+}
+
+void MAVLinkMessageDispatcher::_remove(const SharedSubscription_t& subscription)
+{
+    // Clearing active also stops the subscription from being called by a dispatch which is already in progress
+    subscription->active = false;
+    _subscriptions.remove(subscription->id);
+
+    MsgidEntry_t* entry = _entry(subscription->msgid, false);
+    if (entry) {
+        entry->subscriptions.removeOne(subscription);
+    }
+}
+
+void MAVLinkMessageDispatcher::unsubscribe(int subscriptionId)
+{
+    SharedSubscription_t subscription = _subscriptions.value(subscriptionId);
+
+    if (subscription) {
+        _contextSubscriptions.remove(subscription->context, subscription);
+        _remove(subscription);
+    }
+}
+
+void MAVLinkMessageDispatcher::unsubscribeAll(QObject* context)
+{
+    for (const SharedSubscription_t& subscription: _contextSubscriptions.values(context)) {
+        _remove(subscription);
+    }
+    _contextSubscriptions.remove(context);
+}
+
+void MAVLinkMessageDispatcher::_contextDestroyed(QObject* context)
+{
+    unsubscribeAll(context);
+}
+
+int MAVLinkMessageDispatcher::subscriberCount(uint32_t msgid) const
+{
+    const MsgidEntry_t* entry = _constEntry(msgid);
+    return entry ? entry->subscriptions.count() : 0;
+}
+
+void MAVLinkMessageDispatcher::dispatch(LinkInterface* link, const mavlink_message_t& message)
+{
+    MsgidEntry_t* entry = _entry(message.msgid, false);
+    if (!entry || entry->subscriptions.isEmpty()) {
+        return;
+    }
+
+    // Work from a copy since handlers can subscribe/unsubscribe while being called
+    const SubscriptionList_t    subscriptions = entry->subscriptions;
+    QElapsedTimer               timer;
+    quint64                     totalNSecs = 0;
+
+    for (const SharedSubscription_t& subscription: subscriptions) {
+        if (!subscription->active ||
+                (subscription->sysid != anyId && subscription->sysid != message.sysid) ||
+                (subscription->compid != anyId && subscription->compid != message.compid)) {
+            continue;
+        }
+
+        timer.start();
+        subscription->handler(link, message);
+        quint64 handlerNSecs = static_cast<quint64>(timer.nsecsElapsed());
+
+        subscription->callCount++;
+        subscription->handlerNSecs += handlerNSecs;
+        totalNSecs += handlerNSecs;
+    }
+
+    // Look the entry up again, handlers may have added new message ids to the table
+    entry = _entry(message.msgid, false);
+    if (entry) {
+        entry->dispatchCount++;
+        entry->handlerNSecs += totalNSecs;
+    }
+}
+
+QStringList MAVLinkMessageDispatcher::costReport(void) const
+{
+    QList<QPair<uint32_t, const MsgidEntry_t*>> rgEntries;
+
+    for (uint32_t msgid = 0; msgid < _directTableSize; msgid++) {
+        const MsgidEntry_t& entry = _directTable[static_cast<int>(msgid)];
+        if (entry.dispatchCount) {
+            rgEntries.append(qMakePair(msgid, &entry));
+        }
+    }
+    for (auto iter = _overflowTable.constBegin(); iter != _overflowTable.constEnd(); iter++) {
+        if (iter.value().dispatchCount) {
+            rgEntries.append(qMakePair(iter.key(), &iter.value()));
+        }
+    }
+    std::sort(rgEntries.begin(), rgEntries.end(), [](const QPair<uint32_t, const MsgidEntry_t*>& a, const QPair<uint32_t, const MsgidEntry_t*>& b) {
+        return a.second->handlerNSecs > b.second->handlerNSecs;
+    });
+
+    QStringList report;
+    for (const auto& pair: rgEntries) {
+        const MsgidEntry_t* entry = pair.second;
+
+        mavlink_message_t dummy;
+        dummy.msgid = pair.first;
+        const mavlink_message_info_t* messageInfo = mavlink_get_message_info(&dummy);
+
+        report.append(QStringLiteral("%1(%2): dispatched %3 total %4ms avg %5us")
+                      .arg(messageInfo ? messageInfo->name : "UNKNOWN")
+                      .arg(pair.first)
+                      .arg(entry->dispatchCount)
+                      .arg(entry->handlerNSecs / 1.0e6, 0, 'f', 2)
+                      .arg((entry->handlerNSecs / 1.0e3) / entry->dispatchCount, 0, 'f', 2));
+        for (const SharedSubscription_t& subscription: entry->subscriptions) {
+            report.append(QStringLiteral("    %1: calls %2 total %3ms")
+                          .arg(subscription->context->metaObject()->className())
+                          .arg(subscription->callCount)
+                          .arg(subscription->handlerNSecs / 1.0e6, 0, 'f', 2));
+        }
+    }
+
+    return report;
+}
+
+void MAVLinkMessageDispatcher::resetCosts(void)
+{
+    for (MsgidEntry_t& entry: _directTable) {
+        entry.dispatchCount = 0;
+        entry.handlerNSecs  = 0;
+    }
+    for (MsgidEntry_t& entry: _overflowTable) {
+        entry.dispatchCount = 0;
+        entry.handlerNSecs  = 0;
+    }
+    for (const SharedSubscription_t& subscription: _subscriptions) {
+        subscription->callCount     = 0;
+        subscription->handlerNSecs  = 0;
+    }
+}
+
+void MAVLinkMessageDispatcher::_logCosts(void)
+{
+    qCDebug(MAVLinkMessageDispatcherLog) << "Handler cost" << parent();
+    for (const QString& line: costReport()) {
+        qCDebug(MAVLinkMessageDispatcherLog) << line;
+    }
+}
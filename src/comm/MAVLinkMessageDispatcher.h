@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QTimer>
+#include <QSharedPointer>
+#include <QLoggingCategory>
+
+#include <functional>
+
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkMessageDispatcherLog)
+
+class LinkInterface;
+
+/// Message id indexed dispatch table for incoming MAVLink messages.
+///
+/// Components subscribe to the exact message ids they handle, optionally filtered by sysid/compid, instead of
+/// connecting to a signal which delivers every message. Dispatching a message only calls the handlers subscribed to
+/// that id. Handler run time is tracked per message id and per subscription, see costReport().
+class MAVLinkMessageDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    MAVLinkMessageDispatcher(QObject* parent = nullptr);
+
+    typedef std::function<void(LinkInterface* link, const mavlink_message_t& message)> Handler_t;
+
+    /// Handlers for a message id are called in priority order, then in subscription order
+    typedef enum {
+        PriorityHigh,       ///< Used by the owner of the dispatcher to update its own state before anyone else sees the message
+        PriorityNormal,
+    } Priority_t;
+
+    static const int anyId = -1;
+
+    /// Subscribes to a message id. The subscription is automatically removed when the context object is destroyed.
+    ///     @param context Object which owns the handler
+    ///     @param msgid Message id to subscribe to
+    ///     @param handler Called on the dispatching thread for each matching message
+    ///     @param sysid Only messages from this system id, anyId for all
+    ///     @param compid Only messages from this component id, anyId for all
+    /// @return Subscription id for use with unsubscribe
+    int subscribe(QObject* context, uint32_t msgid, Handler_t handler, int sysid = anyId, int compid = anyId, Priority_t priority = PriorityNormal);
+
+    void unsubscribe    (int subscriptionId);
+    void unsubscribeAll (QObject* context);
+
+    /// Calls all handlers subscribed to the message
+    void dispatch(LinkInterface* link, const mavlink_message_t& message);
+
+    /// @return Number of handlers subscribed to the specified message id
+    int subscriberCount(uint32_t msgid) const;
+
+    /// @return Dispatch counts and handler cost per message id and per subscription, most expensive first
+    QStringList costReport(void) const;
+
+    void resetCosts(void);
+
+private slots:
+    void _contextDestroyed  (QObject* context);
+    void _logCosts          (void);
+
+private:
+    typedef struct {
+        int         id;
+        QObject*    context;
+        uint32_t    msgid;
+        int         sysid;
+        int         compid;
+        Priority_t  priority;
+        Handler_t   handler;
+        bool        active;
+        quint64     callCount;
+        quint64     handlerNSecs;
+    } Subscription_t;
+
+    typedef QSharedPointer<Subscription_t>  SharedSubscription_t;
+    typedef QVector<SharedSubscription_t>   SubscriptionList_t;
+
+    typedef struct {
+        SubscriptionList_t  subscriptions;
+        quint64             dispatchCount;
+        quint64             handlerNSecs;
+    } MsgidEntry_t;
+
+    MsgidEntry_t*       _entry      (uint32_t msgid, bool create);
+    const MsgidEntry_t* _constEntry (uint32_t msgid) const;
+    void                _remove     (const SharedSubscription_t& subscription);
+
+    QVector<MsgidEntry_t>                   _directTable;       ///< Indexed by msgid for the common message ids
+    QHash<uint32_t, MsgidEntry_t>           _overflowTable;     ///< Message ids outside the direct table
+    QHash<int, SharedSubscription_t>        _subscriptions;
+    QMultiHash<QObject*, SharedSubscription_t> _contextSubscriptions;
+    int                                     _nextSubscriptionId;
+    QTimer                                  _costLogTimer;
+
+    static const uint32_t   _directTableSize        = 512;
+    static const int        _costLogIntervalMSecs   = 10000;
+};
@@ -0,0 +1,160 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkParserWorker.h"
+#include "QGCLoggingCategory.h"
+
+#include <QMutexLocker>
+
+QGC_LOGGING_CATEGORY(MAVLinkParserWorkerLog, "MAVLinkParserWorkerLog")
+
+MAVLinkParserWorker::MAVLinkParserWorker(LinkQualityTracker* linkQuality, QObject* parent)
+    : QObject           (parent)
+    , _linkQuality      (linkQuality)
+    , _messagesDecoded  (0)
+{
+    memset(_channelStates,  0, sizeof(_channelStates));
+    memset(_parseStatus,    0, sizeof(_parseStatus));
+    memset(_parseBuffer,    0, sizeof(_parseBuffer));
+}
+
+void MAVLinkParserWorker::addLink(LinkInterface* link, uint8_t mavlinkChannel)
+{
+    // Called from the main thread, which owns the channel status
+    setOutboundMavlink1(mavlinkChannel, mavlink_get_channel_status(mavlinkChannel)->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1);
+    {
+        QMutexLocker lock(&_linkMutex);
+        _linkChannels[link] = mavlinkChannel;
+    }
+    resetLink(link);
+}
+
+void MAVLinkParserWorker::removeLink(LinkInterface* link)
+{
+    QMutexLocker lock(&_linkMutex);
+    _linkChannels.remove(link);
+}
+
+void MAVLinkParserWorker::resetLink(LinkInterface* link)
+{
+    QMutexLocker lock(&_linkMutex);
+    if (_linkChannels.contains(link)) {
+        // Channel state is only touched from the worker thread
+        uint8_t mavlinkChannel = _linkChannels[link];
+        QMetaObject::invokeMethod(this, [this, mavlinkChannel]() { _resetChannel(mavlinkChannel); }, Qt::QueuedConnection);
+    }
+}
+
+void MAVLinkParserWorker::setForwardingLink(SharedLinkInterfacePointer forwardingLink)
+{
+    QMutexLocker lock(&_linkMutex);
+    _forwardingLink = forwardingLink;
+}
+
+void MAVLinkParserWorker::setOutboundMavlink1(uint8_t mavlinkChannel, bool mavlink1)
+{
+    _outboundMavlink1[mavlinkChannel].storeRelease(mavlink1 ? 1 : 0);
+}
+
+void MAVLinkParserWorker::_resetChannel(uint8_t mavlinkChannel)
+{
+    ChannelState_t& channelState = _channelStates[mavlinkChannel];
+
+    channelState.decodedFirstPacket = false;
+    channelState.nonMavlinkCount    = 0;
+    memset(&_parseStatus[mavlinkChannel], 0, sizeof(_parseStatus[mavlinkChannel]));
+    memset(&_parseBuffer[mavlinkChannel], 0, sizeof(_parseBuffer[mavlinkChannel]));
+    _linkQuality->resetChannel(mavlinkChannel);
+}
+
+/// Same as mavlink_parse_char, but framing against the worker's own parse state for the channel
+uint8_t MAVLinkParserWorker::_parseChar(uint8_t mavlinkChannel, uint8_t c, mavlink_message_t* message)
+{
+    mavlink_message_t*  rxmsg   = &_parseBuffer[mavlinkChannel];
+    mavlink_status_t*   status  = &_parseStatus[mavlinkChannel];
+    mavlink_status_t    messageStatus;
+
+    uint8_t msgReceived = mavlink_frame_char_buffer(rxmsg, status, c, message, &messageStatus);
+    if (msgReceived == MAVLINK_FRAMING_BAD_CRC || msgReceived == MAVLINK_FRAMING_BAD_SIGNATURE) {
+        // Treat as a parse failure and restart framing, possibly on this byte
+        _mav_parse_error(status);
+        status->msg_received    = MAVLINK_FRAMING_INCOMPLETE;
+        status->parse_state     = MAVLINK_PARSE_STATE_IDLE;
+        if (c == MAVLINK_STX) {
+            status->parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+            rxmsg->len = 0;
+            mavlink_start_checksum(rxmsg);
+        }
+        return 0;
+    }
+    return msgReceived;
+}
+
+void MAVLinkParserWorker::receiveBytes(LinkInterface* link, QByteArray b)
+{
+    uint8_t                     mavlinkChannel;
+    SharedLinkInterfacePointer  forwardingLink;
+
+    {
+        QMutexLocker lock(&_linkMutex);
+
+        // Since receiveBytes signals cross threads we can end up with signals in the queue
+        // that come through after the link is removed. For these we just drop the data
+        // since the link is closed.
+        auto iter = _linkChannels.constFind(link);
+        if (iter == _linkChannels.constEnd()) {
+            return;
+        }
+        mavlinkChannel = iter.value();
+        forwardingLink = _forwardingLink;
+    }
+
+    ChannelState_t&     channelState = _channelStates[mavlinkChannel];
+    MAVLinkMessageBatch batch;
+    mavlink_message_t   message;
+    bool                switchedToMavlink2 = false;
+
+    for (int position = 0; position < b.size(); position++) {
+        if (_parseChar(mavlinkChannel, static_cast<uint8_t>(b[position]), &message)) {
+            if (!channelState.decodedFirstPacket) {
+                channelState.decodedFirstPacket = true;
+                // The channel status flags are left alone here, they are switched on the main thread from mavlink2Detected
+                if (message.magic == MAVLINK_STX && _outboundMavlink1[mavlinkChannel].testAndSetOrdered(1, 0)) {
+                    qCDebug(MAVLinkParserWorkerLog) << "Incoming mavlink 2.0 packet on outbound mavlink 1.0 channel:" << mavlinkChannel;
+                    switchedToMavlink2 = true;
+                }
+            }
+
+            if (forwardingLink) {
+                uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+                int len = mavlink_msg_to_send_buffer(buf, &message);
+                forwardingLink->writeBytesThreadSafe(reinterpret_cast<const char*>(buf), len);
+            }
+
+            batch.append(message);
+        } else if (!channelState.decodedFirstPacket) {
+            // No formed message yet
+            if (++channelState.nonMavlinkCount > _nonMavlinkByteThreshold) {
+                channelState.nonMavlinkCount = 0;
+                emit nonMavlinkDataDetected(link);
+            }
+        }
+    }
+
+    if (!batch.isEmpty()) {
+        // Loss accounting for the whole chunk is done in one go. Stats are polled from the tracker by the consumers.
+        _linkQuality->update(mavlinkChannel, batch, _linkQuality->timestampUSecs());
+
+        _messagesDecoded.fetchAndAddRelaxed(static_cast<quint64>(batch.count()));
+        if (switchedToMavlink2) {
+            emit mavlink2Detected(link);
+        }
+        emit messagesReceived(link, batch);
+    }
+}
@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QVector>
+#include <QByteArray>
+#include <QAtomicInteger>
+#include <QLoggingCategory>
+
+#include "LinkInterface.h"
+#include "LinkQualityTracker.h"
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkParserWorkerLog)
+
+Q_DECLARE_METATYPE(mavlink_message_t)
+
+/// Set of messages decoded from a single bytesReceived chunk of a link
+typedef QVector<mavlink_message_t> MAVLinkMessageBatch;
+
+/// Decodes the incoming byte stream for a set of links on a thread other than the main thread.
+///
+/// Each mavlink channel is owned by exactly one worker. The worker keeps its own parse state for the channel instead of
+/// using the shared mavlink channel status, which is left to the packing side on the main thread. The worker handles
+/// framing and forwarding, and feeds the link quality tracker. The decoded messages are then handed to MAVLinkProtocol
+/// on the main thread as a batch.
+class MAVLinkParserWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @param linkQuality Sequence loss statistics for the channels handled by this worker are kept here
+    MAVLinkParserWorker(LinkQualityTracker* linkQuality, QObject* parent = nullptr);
+
+    // The following methods are thread safe. The link pointer is only used as a key and is never dereferenced
+    // from the worker thread.
+
+    /// Starts decoding data from the specified link on the specified mavlink channel
+    void addLink(LinkInterface* link, uint8_t mavlinkChannel);
+
+    /// Stops decoding data from the specified link. Any data which is still queued for the link is dropped.
+    void removeLink(LinkInterface* link);
+
+    /// Resets the decoding statistics for the specified link
+    void resetLink(LinkInterface* link);
+
+    /// Sets the link which all decoded messages are forwarded to, nullptr for no forwarding
+    void setForwardingLink(SharedLinkInterfacePointer forwardingLink);
+
+    /// Tells the worker whether the specified mavlink channel is currently packing outbound MAVLink 1. The worker only
+    /// reads this to detect the switch to MAVLink 2, the channel status flags themselves are set by the caller.
+    void setOutboundMavlink1(uint8_t mavlinkChannel, bool mavlink1);
+
+    /// @return true: worker believes the channel is still packing outbound MAVLink 1
+    bool outboundMavlink1(uint8_t mavlinkChannel) const { return _outboundMavlink1[mavlinkChannel].load() != 0; }
+
+    /// @return Total number of messages decoded by this worker
+    quint64 messagesDecoded(void) const { return _messagesDecoded.load(); }
+
+public slots:
+    /// Parses all incoming bytes and constructs MAVLink packets from them. Called on the worker thread.
+    void receiveBytes(LinkInterface* link, QByteArray b);
+
+signals:
+    /// All messages decoded from a single chunk of incoming bytes
+    void messagesReceived(LinkInterface* link, MAVLinkMessageBatch messages);
+
+    /// Signalled when the first packet decoded on a link which is sending MAVLink 1 is a MAVLink 2 packet. The receiver
+    /// is responsible for switching the channel status to outbound MAVLink 2 on the main thread.
+    void mavlink2Detected(LinkInterface* link);
+
+    /// Signalled each time _nonMavlinkByteThreshold bytes are received on a link without a single MAVLink packet being decoded
+    void nonMavlinkDataDetected(LinkInterface* link);
+
+private:
+    typedef struct {
+        bool        decodedFirstPacket;     ///< true: channel has correctly decoded it's first mavlink packet
+        int         nonMavlinkCount;        ///< Number of bytes received prior to the first decoded packet
+    } ChannelState_t;
+
+    void    _resetChannel   (uint8_t mavlinkChannel);
+    uint8_t _parseChar      (uint8_t mavlinkChannel, uint8_t c, mavlink_message_t* message);
+
+    QMutex                          _linkMutex;         ///< Protects _linkChannels and _forwardingLink
+    QHash<LinkInterface*, uint8_t>  _linkChannels;
+    SharedLinkInterfacePointer      _forwardingLink;
+
+    // The following are only accessed from the worker thread
+    ChannelState_t      _channelStates[MAVLINK_COMM_NUM_BUFFERS];
+    mavlink_status_t    _parseStatus[MAVLINK_COMM_NUM_BUFFERS];     ///< Parse state, never the shared channel status
+    mavlink_message_t   _parseBuffer[MAVLINK_COMM_NUM_BUFFERS];     ///< Message being framed on each channel
+
+    QAtomicInt          _outboundMavlink1[MAVLINK_COMM_NUM_BUFFERS];///< 1: channel is packing outbound MAVLink 1
+
+    LinkQualityTracker*     _linkQuality;
+    QAtomicInteger<quint64> _messagesDecoded;
+
+    static const int _nonMavlinkByteThreshold = 1000;
+};
@@ -39,8 +39,6 @@
 #include "MultiVehicleManager.h"
 #include "SettingsManager.h"
 
-Q_DECLARE_METATYPE(mavlink_message_t)
-
 QGC_LOGGING_CATEGORY(MAVLinkProtocolLog, "MAVLinkProtocolLog")
 
 const char* MAVLinkProtocol::_tempLogFileTemplate = "FlightDataXXXXXX"; ///< Template for temporary log file
@@ -53,8 +51,6 @@ const char* MAVLinkProtocol::_logFileExtension = "mavlink";             ///< Ext
 MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , m_enable_version_check(true)
-    , _message({})
-    , _status({})
     , versionMismatchIgnore(false)
     , systemId(255)
     , _current_version(100)
@@ -65,19 +61,22 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     , _tempLogFile(QString("%2.%3").arg(_tempLogFileTemplate).arg(_logFileExtension))
     , _linkMgr(nullptr)
     , _multiVehicleManager(nullptr)
+    , _checkedUserNonMavlink(false)
+    , _warnedUserNonMavlink(false)
 {
-    memset(totalReceiveCounter, 0, sizeof(totalReceiveCounter));
-    memset(totalLossCounter,    0, sizeof(totalLossCounter));
-    memset(runningLossPercent,  0, sizeof(runningLossPercent));
-    memset(firstMessage,        1, sizeof(firstMessage));
-    memset(&_status,            0, sizeof(_status));
-    memset(&_message,           0, sizeof(_message));
 }
 
 MAVLinkProtocol::~MAVLinkProtocol()
 {
     storeSettings();
     _closeLogFile();
+
+    for (QThread* parserThread: _parserThreads) {
+        parserThread->quit();
+        parserThread->wait();
+        delete parserThread;
+    }
+    qDeleteAll(_parserWorkers);
 }
 
 void MAVLinkProtocol::setVersion(unsigned version)
@@ -85,14 +84,16 @@ void MAVLinkProtocol::setVersion(unsigned version)
     QList<LinkInterface*> links = _linkMgr->links();
 
     for (int i = 0; i < links.length(); i++) {
-        mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(links[i]->mavlinkChannel());
-
-        // Set flags for version
+        // Channel status flags are only written here on the main thread, which is also where outbound packing happens.
+        // The parser worker keeps its own parse state and only needs to know the outbound version.
+        uint8_t             mavlinkChannel  = links[i]->mavlinkChannel();
+        mavlink_status_t*   mavlinkStatus   = mavlink_get_channel_status(mavlinkChannel);
         if (version < 200) {
             mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
         } else {
             mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
         }
+        _parserWorkerForLink(links[i])->setOutboundMavlink1(mavlinkChannel, version < 200);
     }
 
     _current_version = version;
@@ -106,9 +107,30 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    _multiVehicleManager =   _toolbox->multiVehicleManager();
 
    qRegisterMetaType<mavlink_message_t>("mavlink_message_t");
+   qRegisterMetaType<MAVLinkMessageBatch>("MAVLinkMessageBatch");
 
    loadSettings();
 
+   // Decoding is spread across a small pool of worker threads. Each mavlink channel is always decoded by the same
+   // worker, leaving at least one core free for the main thread.
+   int workerCount = qBound(1, QThread::idealThreadCount() - 1, _maxParserWorkers);
+   for (int i = 0; i < workerCount; i++) {
+       QThread*             parserThread = new QThread();
+       MAVLinkParserWorker* parserWorker = new MAVLinkParserWorker(&_linkQuality);
+
+       parserThread->setObjectName(QStringLiteral("MAVLinkParser%1").arg(i));
+       parserWorker->moveToThread(parserThread);
+
+       connect(parserWorker, &MAVLinkParserWorker::messagesReceived,       this, &MAVLinkProtocol::_messagesReceived);
+       connect(parserWorker, &MAVLinkParserWorker::mavlink2Detected,       this, &MAVLinkProtocol::_mavlink2Detected);
+       connect(parserWorker, &MAVLinkParserWorker::nonMavlinkDataDetected, this, &MAVLinkProtocol::_nonMavlinkDataDetected);
+
+       parserThread->start();
+       _parserThreads.append(parserThread);
+       _parserWorkers.append(parserWorker);
+   }
+   qCDebug(MAVLinkProtocolLog) << "MAVLink parser worker count" << workerCount;
+
    // All the *Counter variables are not initialized here, as they should be initialized
    // on a per-link basis before those links are used. @see resetMetadataForLink().
 
@@ -119,6 +141,12 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleAdded, this, &MAVLinkProtocol::_vehicleCountChanged);
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkProtocol::_vehicleCountChanged);
 
+   connect(&_logWriter, &TelemetryLogWriter::writeFailed, this, &MAVLinkProtocol::_logWriteFailed);
+
+   connect(_linkMgr, &LinkManager::newLink,     this, &MAVLinkProtocol::_updateForwardingLink);
+   connect(_linkMgr, &LinkManager::linkDeleted, this, &MAVLinkProtocol::_updateForwardingLink);
+   connect(_app->toolbox()->settingsManager()->appSettings()->forwardMavlink(), &Fact::rawValueChanged, this, &MAVLinkProtocol::_updateForwardingLink);
+
    emit versionCheckChanged(m_enable_version_check);
 }
 
@@ -149,245 +177,157 @@ void MAVLinkProtocol::storeSettings()
 
 void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 {
-    int channel = link->mavlinkChannel();
-    totalReceiveCounter[channel] = 0;
-    totalLossCounter[channel]    = 0;
-    runningLossPercent[channel]  = 0.0f;
-    for(int i = 0; i < 256; i++) {
-        firstMessage[channel][i] =  1;
-    }
+    _parserWorkerForLink(link)->resetLink(link);
     link->setDecodedFirstMavlinkPacket(false);
 }
 
-/**
- * This method parses all outcoming bytes and log a MAVLink packet.
- * @param link The interface to read from
- * @see LinkInterface
- **/
-
-void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
-
-    uint8_t bytes_time[sizeof(quint64)];
+MAVLinkParserWorker* MAVLinkProtocol::_parserWorkerForLink(LinkInterface* link)
+{
+    return _parserWorkers[link->mavlinkChannel() % _parserWorkers.count()];
+}
 
-    Q_UNUSED(link);
-    if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
+void MAVLinkProtocol::registerLink(LinkInterface* link)
+{
+    MAVLinkParserWorker* parserWorker = _parserWorkerForLink(link);
 
-        quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
+    parserWorker->addLink(link, link->mavlinkChannel());
+    connect(link, &LinkInterface::bytesReceived, parserWorker, &MAVLinkParserWorker::receiveBytes, Qt::UniqueConnection);
+}
 
-        qToBigEndian(time,bytes_time);
+void MAVLinkProtocol::unregisterLink(LinkInterface* link)
+{
+    MAVLinkParserWorker* parserWorker = _parserWorkerForLink(link);
 
-        b.insert(0,QByteArray((const char*)bytes_time,sizeof(bytes_time)));
+    disconnect(link, &LinkInterface::bytesReceived, parserWorker, &MAVLinkParserWorker::receiveBytes);
+    parserWorker->removeLink(link);
+}
 
-        int len = b.count();
+void MAVLinkProtocol::_updateForwardingLink(void)
+{
+    SharedLinkInterfacePointer forwardingLink;
 
-        if(_tempLogFile.write(b) != len)
-        {
-            // If there's an error logging data, raise an alert and stop logging.
-            emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-            _stopLogging();
-            _logSuspendError = true;
-        }
+    if (_app->toolbox()->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool()) {
+        forwardingLink = _linkMgr->mavlinkForwardingLink();
+    }
+    for (MAVLinkParserWorker* parserWorker: _parserWorkers) {
+        parserWorker->setForwardingLink(forwardingLink);
     }
-
 }
 
 /**
- * This method parses all incoming bytes and constructs a MAVLink packet.
- * It can handle multiple links in parallel, as each link has it's own buffer/
- * parsing state machine.
+ * This method parses all outcoming bytes and log a MAVLink packet.
  * @param link The interface to read from
  * @see LinkInterface
  **/
 
-void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
+void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b)
 {
-    // Since receiveBytes signals cross threads we can end up with signals in the queue
-    // that come through after the link is disconnected. For these we just drop the data
-    // since the link is closed.
-    if (!_linkMgr->containsLink(link)) {
-        return;
+    Q_UNUSED(link);
+
+    if (!_logSuspendError && !_logSuspendReplay && _logWriter.isLogging()) {
+        _logWriter.logRecord(_logWriter.timestampUSecs(), b.constData(), b.count());
     }
+}
 
-    uint8_t mavlinkChannel = link->mavlinkChannel();
-
-    static int  nonmavlinkCount = 0;
-    static bool checkedUserNonMavlink = false;
-    static bool warnedUserNonMavlink  = false;
-
-    for (int position = 0; position < b.size(); position++) {
-        if (mavlink_parse_char(mavlinkChannel, static_cast<uint8_t>(b[position]), &_message, &_status)) {
-            // Got a valid message
-            if (!link->decodedFirstMavlinkPacket()) {
-                link->setDecodedFirstMavlinkPacket(true);
-                mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-                if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    qDebug() << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                    mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-                    // Set all links to v2
-                    setVersion(200);
-                }
-            }
+/**
+ * Handles the messages decoded by a parser worker. Runs on the main thread.
+ * @param link The interface the messages were received on
+ * @param messages The decoded messages in the order they were received
+ **/
 
-            //-----------------------------------------------------------------
-            // MAVLink Status
-            uint8_t lastSeq = lastIndex[_message.sysid][_message.compid];
-            uint8_t expectedSeq = lastSeq + 1;
-            // Increase receive counter
-            totalReceiveCounter[mavlinkChannel]++;
-            // Determine what the next expected sequence number is, accounting for
-            // never having seen a message for this system/component pair.
-            if(firstMessage[_message.sysid][_message.compid]) {
-                firstMessage[_message.sysid][_message.compid] = 0;
-                lastSeq     = _message.seq;
-                expectedSeq = _message.seq;
-            }
-            // And if we didn't encounter that sequence number, record the error
-            //int foo = 0;
-            if (_message.seq != expectedSeq)
-            {
-                //foo = 1;
-                int lostMessages = 0;
-                //-- Account for overflow during packet loss
-                if(_message.seq < expectedSeq) {
-                    lostMessages = (_message.seq + 255) - expectedSeq;
-                } else {
-                    lostMessages = _message.seq - expectedSeq;
-                }
-                // Log how many were lost
-                totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
-            }
+void MAVLinkProtocol::_messagesReceived(LinkInterface* link, MAVLinkMessageBatch messages)
+{
+    for (const mavlink_message_t& message: messages) {
+        // Since the batch is queued across threads, as well as the fact that message handlers can
+        // disconnect links we can end up here after the link is gone. For these we just drop the data.
+        if (!_linkMgr->containsLink(link)) {
+            return;
+        }
+        _handleMessage(link, message);
+    }
+}
 
-            // And update the last sequence number for this system/component pair
-            lastIndex[_message.sysid][_message.compid] = _message.seq;;
-            // Calculate new loss ratio
-            uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
-            float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
-            receiveLossPercent *= 100.0f;
-            receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
-            runningLossPercent[mavlinkChannel] = receiveLossPercent;
-
-            //qDebug() << foo << _message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << _message.sysid << _message.compid << ")";
-
-            //-----------------------------------------------------------------
-            // MAVLink forwarding
-            bool forwardingEnabled = _app->toolbox()->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool();
-            if (forwardingEnabled) {
-                SharedLinkInterfacePointer forwardingLink = _linkMgr->mavlinkForwardingLink();
-
-                if (forwardingLink) {
-                    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                    int len = mavlink_msg_to_send_buffer(buf, &_message);
-                    forwardingLink->writeBytesThreadSafe((const char*)buf, len);
-                }
-            }
+void MAVLinkProtocol::_mavlink2Detected(LinkInterface* link)
+{
+    if (_linkMgr->containsLink(link)) {
+        qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << link->mavlinkChannel();
+        // Set all links to v2
+        setVersion(200);
+    }
+}
 
-            //-----------------------------------------------------------------
-            // Log data
-            if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-                uint8_t buf[MAVLINK_MAX_PACKET_LEN+sizeof(quint64)];
-
-                // Write the uint64 time in microseconds in big endian format before the message.
-                // This timestamp is saved in UTC time. We are only saving in ms precision because
-                // getting more than this isn't possible with Qt without a ton of extra code.
-                quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-                qToBigEndian(time, buf);
-
-                // Then write the message to the buffer
-                int len = mavlink_msg_to_send_buffer(buf + sizeof(quint64), &_message);
-
-                // Determine how many bytes were written by adding the timestamp size to the message size
-                len += sizeof(quint64);
-
-                // Now write this timestamp/message pair to the log.
-                QByteArray b(reinterpret_cast<const char*>(buf), len);
-                if(_tempLogFile.write(b) != len)
-                {
-                    // If there's an error logging data, raise an alert and stop logging.
-                    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-                    _stopLogging();
-                    _logSuspendError = true;
-                }
-
-                // Check for the vehicle arming going by. This is used to trigger log save.
-                if (!_vehicleWasArmed && _message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                    mavlink_heartbeat_t state;
-                    mavlink_msg_heartbeat_decode(&_message, &state);
-                    if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
-                        _vehicleWasArmed = true;
-                    }
-                }
-            }
+void MAVLinkProtocol::_handleMessage(LinkInterface* link, const mavlink_message_t& message)
+{
+    if (!link->decodedFirstMavlinkPacket()) {
+        // Switching to outbound mavlink 2.0 is handled by the parser worker, see _mavlink2Detected
+        link->setDecodedFirstMavlinkPacket(true);
+    }
 
-            if (_message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                _startLogging();
-                mavlink_heartbeat_t heartbeat;
-                mavlink_msg_heartbeat_decode(&_message, &heartbeat);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, heartbeat.autopilot, heartbeat.type);
+    //-----------------------------------------------------------------
+    // Log data
+    if (!_logSuspendError && !_logSuspendReplay && _logWriter.isLogging()) {
+        // The log writer prepends the timestamp and queues the record for writing on its own thread
+        uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+        int len = mavlink_msg_to_send_buffer(buf, &message);
+        _logWriter.logRecord(_logWriter.timestampUSecs(), reinterpret_cast<const char*>(buf), len);
+
+        // Check for the vehicle arming going by. This is used to trigger log save.
+        if (!_vehicleWasArmed && message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            mavlink_heartbeat_t state;
+            mavlink_msg_heartbeat_decode(&message, &state);
+            if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
+                _vehicleWasArmed = true;
             }
+        }
+    }
 
-            if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
-                _startLogging();
-                mavlink_high_latency2_t highLatency2;
-                mavlink_msg_high_latency2_decode(&_message, &highLatency2);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, highLatency2.autopilot, highLatency2.type);
-            }
+    if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        _startLogging();
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, heartbeat.autopilot, heartbeat.type);
+    }
 
-#if 0
-            // Given the current state of SiK Radio firmwares there is no way to make the code below work.
-            // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
-            // packet even if the vehicle is sending Mavlink 2.
-
-            // Detect if we are talking to an old radio not supporting v2
-            mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-            if (_message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
-                if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
-                && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    _radio_version_mismatch_count++;
-                }
-            }
+    if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
+        _startLogging();
+        mavlink_high_latency2_t highLatency2;
+        mavlink_msg_high_latency2_decode(&message, &highLatency2);
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, highLatency2.autopilot, highLatency2.type);
+    }
 
-            if (_radio_version_mismatch_count == 5) {
-                // Warn the user if the radio continues to send v1 while the link uses v2
-                emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
-                // Set to flag warning already shown
-                _radio_version_mismatch_count = -1;
-                // Flick link back to v1
-                qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-            }
-#endif
+    // The packet is emitted as a whole, as it is only 255 - 261 bytes short
+    // kind of inefficient, but no issue for a groundstation pc.
+    // It buys as reentrancy for the whole code over all threads
+    emit messageReceived(link, message);
+}
 
-            // Update MAVLink status on every 32th packet
-            if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
-                emit mavlinkMessageStatus(_message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
-            }
+void MAVLinkProtocol::_logWriteFailed(void)
+{
+    if (!_logSuspendError) {
+        // If there's an error logging data, raise an alert and stop logging.
+        emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
+        _stopLogging();
+        _logSuspendError = true;
+    }
+}
 
-            // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-            // kind of inefficient, but no issue for a groundstation pc.
-            // It buys as reentrancy for the whole code over all threads
-            emit messageReceived(link, _message);
-            // Reset message parsing
-            memset(&_status,  0, sizeof(_status));
-            memset(&_message, 0, sizeof(_message));
-        } else if (!link->decodedFirstMavlinkPacket()) {
-            // No formed message yet
-            nonmavlinkCount++;
-            if (nonmavlinkCount > 1000 && !warnedUserNonMavlink) {
-                // 1000 bytes with no mavlink message. Are we connected to a mavlink capable device?
-                if (!checkedUserNonMavlink) {
-                    link->requestReset();
-                    checkedUserNonMavlink = true;
-                } else {
-                    warnedUserNonMavlink = true;
-                    // Disconnect the link since it's some other device and
-                    // QGC clinging on to it and feeding it data might have unintended
-                    // side effects (e.g. if its a modem)
-                    qDebug() << "disconnected link" << link->getName() << "as it contained no MAVLink data";
-                    QMetaObject::invokeMethod(_linkMgr, "disconnectLink", Q_ARG( LinkInterface*, link ) );
-                    return;
-                }
-            }
-        }
+void MAVLinkProtocol::_nonMavlinkDataDetected(LinkInterface* link)
+{
+    if (!_linkMgr->containsLink(link) || link->decodedFirstMavlinkPacket() || _warnedUserNonMavlink) {
+        return;
+    }
+
+    // Bytes with no mavlink message. Are we connected to a mavlink capable device?
+    if (!_checkedUserNonMavlink) {
+        link->requestReset();
+        _checkedUserNonMavlink = true;
+    } else {
+        _warnedUserNonMavlink = true;
+        // Disconnect the link since it's some other device and
+        // QGC clinging on to it and feeding it data might have unintended
+        // side effects (e.g. if its a modem)
+        qDebug() << "disconnected link" << link->getName() << "as it contained no MAVLink data";
+        QMetaObject::invokeMethod(_linkMgr, "disconnectLink", Q_ARG( LinkInterface*, link ) );
     }
 }
 
@@ -435,18 +375,19 @@ void MAVLinkProtocol::_vehicleCountChanged(void)
 /// @brief Closes the log file if it is open
 bool MAVLinkProtocol::_closeLogFile(void)
 {
-    if (_tempLogFile.isOpen()) {
-        if (_tempLogFile.size() == 0) {
-            // Don't save zero byte files
-            _tempLogFile.remove();
-            return false;
-        } else {
-            _tempLogFile.flush();
-            _tempLogFile.close();
-            return true;
-        }
+    if (!_logWriter.isLogging()) {
+        return false;
     }
-    return false;
+
+    // The writer owns the file until everything queued is on disk and the file is closed
+    _logWriter.stopLogging();
+
+    if (QFileInfo(_tempLogFile.fileName()).size() == 0) {
+        // Don't save zero byte files
+        _tempLogFile.remove();
+        return false;
+    }
+    return true;
 }
 
 void MAVLinkProtocol::_startLogging(void)
@@ -467,12 +408,15 @@ void MAVLinkProtocol::_startLogging(void)
 #endif
     //-- Log is always written to a temp file. If later the user decides they want
     //   it, it's all there for them.
-    if (!_tempLogFile.isOpen()) {
+    if (!_logWriter.isLogging()) {
         if (!_logSuspendReplay) {
-            if (!_tempLogFile.open()) {
+            // The temp file is only used to pick a unique name, the log writer opens and owns the file from here on
+            bool opened = _tempLogFile.open();
+            _tempLogFile.close();
+            if (!opened || !_logWriter.startLogging(_tempLogFile.fileName())) {
                 emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Opening Flight Data file for writing failed. "
                                                                       "Unable to write to %1. Please choose a different file location.").arg(_tempLogFile.fileName()));
-                _closeLogFile();
+                _tempLogFile.remove();
                 _logSuspendError = true;
                 return;
             }
@@ -487,7 +431,7 @@ void MAVLinkProtocol::_startLogging(void)
 
 void MAVLinkProtocol::_stopLogging(void)
 {
-    if (_tempLogFile.isOpen()) {
+    if (_logWriter.isLogging()) {
         if (_closeLogFile()) {
             if ((_vehicleWasArmed || _app->toolbox()->settingsManager()->appSettings()->telemetrySaveNotArmed()->rawValue().toBool()) &&
                 _app->toolbox()->settingsManager()->appSettings()->telemetrySave()->rawValue().toBool() &&
@@ -16,9 +16,13 @@
 #include <QFile>
 #include <QMap>
 #include <QByteArray>
+#include <QThread>
 #include <QLoggingCategory>
 
 #include "LinkInterface.h"
+#include "MAVLinkParserWorker.h"
+#include "LinkQualityTracker.h"
+#include "TelemetryLogWriter.h"
 #include "QGCMAVLink.h"
 #include "QGC.h"
 #include "QGCTemporaryFile.h"
@@ -67,6 +71,23 @@ public:
      * Reset the counters for all metadata for this link.
      */
     virtual void resetMetadataForLink(LinkInterface *link);
+
+    /// Starts decoding incoming data for the specified link on one of the parser worker threads.
+    /// The link must already have a mavlink channel assigned.
+    void registerLink(LinkInterface* link);
+
+    /// Stops decoding incoming data for the specified link
+    void unregisterLink(LinkInterface* link);
+
+    /// @return Number of parser worker threads
+    int parserWorkerCount(void) const { return _parserWorkers.count(); }
+
+    /// @return Background writer for the telemetry log, provides write statistics for the ui
+    TelemetryLogWriter* logWriter(void) { return &_logWriter; }
+
+    /// Sequence loss, rate and jitter statistics per link/system/component for all incoming traffic. Query with the
+    /// link's mavlink channel.
+    LinkQualityTracker* linkQuality(void) { return &_linkQuality; }
     
     /// Suspend/Restart logging during replay.
     void suspendLogForReplay(bool suspend);
@@ -78,9 +99,6 @@ public:
     virtual void setToolbox(QGCToolbox *toolbox);
 
 public slots:
-    /** @brief Receive bytes from a communication interface */
-    void receiveBytes(LinkInterface* link, QByteArray b);
-
     /** @brief Log bytes sent from a communication interface */
     void logSentBytes(LinkInterface* link, QByteArray b);
     
@@ -103,14 +121,6 @@ public slots:
 
 protected:
     bool        m_enable_version_check;                         ///< Enable checking of version match of MAV and QGC
-    uint8_t     lastIndex[256][256];                            ///< Store the last received sequence ID for each system/componenet pair
-    uint8_t     firstMessage[256][256];                         ///< First message flag
-    uint64_t    totalReceiveCounter[MAVLINK_COMM_NUM_BUFFERS];  ///< The total number of successfully received messages
-    uint64_t    totalLossCounter[MAVLINK_COMM_NUM_BUFFERS];     ///< Total messages lost during transmission.
-    float       runningLossPercent[MAVLINK_COMM_NUM_BUFFERS];   ///< Loss rate
-
-    mavlink_message_t _message;
-    mavlink_status_t _status;
 
     bool        versionMismatchIgnore;
     int         systemId;
@@ -130,8 +140,6 @@ signals:
     /** @brief Emitted if a new system ID was set */
     void systemIdChanged(int systemId);
 
-    void mavlinkMessageStatus(int uasId, uint64_t totalSent, uint64_t totalReceived, uint64_t totalLoss, float lossPercent);
-
     /**
      * @brief Emitted if a new radio status packet received
      *
@@ -153,9 +161,17 @@ signals:
     void checkTelemetrySavePath(void);
 
 private slots:
-    void _vehicleCountChanged(void);
-    
+    void _vehicleCountChanged       (void);
+    void _messagesReceived          (LinkInterface* link, MAVLinkMessageBatch messages);
+    void _mavlink2Detected          (LinkInterface* link);
+    void _nonMavlinkDataDetected    (LinkInterface* link);
+    void _updateForwardingLink      (void);
+    void _logWriteFailed            (void);
+
 private:
+    MAVLinkParserWorker* _parserWorkerForLink(LinkInterface* link);
+    void _handleMessage(LinkInterface* link, const mavlink_message_t& message);
+
     bool _closeLogFile(void);
     void _startLogging(void);
     void _stopLogging(void);
@@ -165,10 +181,20 @@ private:
     bool _vehicleWasArmed;      ///< true: Vehicle was armed during log sequence
 
     QGCTemporaryFile    _tempLogFile;            ///< File to log to
+    TelemetryLogWriter  _logWriter;              ///< Writes queued log records to _tempLogFile on a background thread
     static const char*  _tempLogFileTemplate;    ///< Template for temporary log file
     static const char*  _logFileExtension;       ///< Extension for log files
 
     LinkManager*            _linkMgr;
     MultiVehicleManager*    _multiVehicleManager;
+
+    LinkQualityTracker          _linkQuality;       ///< Updated by the parser workers
+    QList<QThread*>             _parserThreads;
+    QList<MAVLinkParserWorker*> _parserWorkers;     ///< Channel n is decoded by worker n % count
+
+    bool _checkedUserNonMavlink;
+    bool _warnedUserNonMavlink;
+
+    static const int _maxParserWorkers = 4;
 };
 
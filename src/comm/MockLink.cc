@@ -14,11 +14,16 @@
 
 #ifdef UNITTEST_BUILD
 #include "UnitTest.h"
+#include "ParameterCacheFile.h"
+#include "FirmwarePluginManager.h"
 #endif
 
 #include <QTimer>
 #include <QDebug>
 #include <QFile>
+#include <QMutexLocker>
+#include <QDeadlineTimer>
+#include <QRandomGenerator>
 
 #include <string.h>
 
@@ -95,11 +100,13 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
     px4_cm.main_mode = PX4_CUSTOM_MAIN_MODE_MANUAL;
     _mavCustomMode = px4_cm.data;
 
-    _mockLinkFTP = new MockLinkFTP(_vehicleSystemId, _vehicleComponentId, this);
+    _mockLinkFTP        = new MockLinkFTP(_vehicleSystemId, _vehicleComponentId, this);
+    _mockLinkFTPCamera  = new MockLinkFTP(_vehicleSystemId, MAV_COMP_ID_CAMERA, this);
 
     moveToThread(this);
 
     _loadParams();
+    _loadVolatileParams();
 
     _adsbVehicleCoordinate = QGeoCoordinate(_vehicleLatitude, _vehicleLongitude).atDistanceAndAzimuth(1000, _adsbAngle);
     _adsbVehicleCoordinate.setAltitude(100);
@@ -221,6 +228,7 @@ void MockLink::_run500HzTasks(void)
 
     if (_mavlinkStarted && _connected) {
         _paramRequestListWorker();
+        _delayedParamValueWorker();
         _logDownloadWorker();
     }
 }
@@ -548,6 +556,15 @@ void MockLink::_handleManualControl(const mavlink_message_t& msg)
     mavlink_msg_manual_control_decode(&msg, &manualControl);
 
     qCDebug(MockLinkLog) << "MANUAL_CONTROL" << manualControl.x << manualControl.y << manualControl.z << manualControl.r;
+
+    QMutexLocker lock(&_manualControlMutex);
+    _manualControlArrivals.append(QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs());
+}
+
+QList<qint64> MockLink::manualControlArrivals(void)
+{
+    QMutexLocker lock(&_manualControlMutex);
+    return _manualControlArrivals;
 }
 
 void MockLink::_setParamFloatUnionIntoMap(int componentId, const QString& paramName, float paramFloat)
@@ -696,6 +713,92 @@ void MockLink::_handleParamRequestList(const mavlink_message_t& msg)
     // Start the worker routine
     _currentParamRequestListComponentIndex = 0;
     _currentParamRequestListParamIndex = 0;
+
+    if (_firmwareType == MAV_AUTOPILOT_PX4) {
+        // Like PX4 the parameter set hash goes out first, a matching cache on the other end cancels the list
+        _sendParamHash();
+        _paramHashCheckDeadline = _runningTime.elapsed() + _paramHashCheckMSecs;
+    }
+}
+
+/// Sends the _HASH_CHECK value for the autopilot parameter set
+void MockLink::_sendParamHash(void)
+{
+    mavlink_message_t       responseMsg;
+    mavlink_param_union_t   valueUnion;
+
+    valueUnion.type = MAV_PARAM_TYPE_UINT32;
+    valueUnion.param_uint32 = _paramHash(_vehicleComponentId);
+    mavlink_msg_param_value_pack_chan(_vehicleSystemId,
+                                      _vehicleComponentId,
+                                      _mavlinkChannel,
+                                      &responseMsg,
+                                      "_HASH_CHECK",
+                                      valueUnion.param_float,
+                                      MAV_PARAM_TYPE_UINT32,
+                                      0,
+                                      -1);
+    respondWithMavlinkMessage(responseMsg);
+}
+
+/// Finds the parameters which do not take part in the _HASH_CHECK, the same ones QGC leaves out of its cache hash. Done
+/// up front since the firmware plugins and their meta data are only used from the main thread.
+void MockLink::_loadVolatileParams(void)
+{
+    if (_firmwareType != MAV_AUTOPILOT_PX4) {
+        return;
+    }
+
+    FirmwarePlugin* plugin          = qgcApp()->toolbox()->firmwarePluginManager()->firmwarePluginForAutopilot(_firmwareType, _vehicleType);
+    QObject*        paramMetaData   = plugin->_loadParameterMetaData(plugin->_internalParameterMetaDataFile(nullptr));
+    if (paramMetaData) {
+        for (const QString& paramName: _mapParamName2Value[_vehicleComponentId].keys()) {
+            if (plugin->_isParameterVolatile(paramMetaData, paramName, _vehicleType)) {
+                _volatileParams.insert(paramName);
+            }
+        }
+        delete paramMetaData;
+    }
+}
+
+/// @return Hash of a component's parameter set, calculated the same way as PX4 does for _HASH_CHECK
+quint32 MockLink::_paramHash(int componentId)
+{
+    quint32                         hash = 0;
+    const QMap<QString, QVariant>&  paramMap = _mapParamName2Value[componentId];
+    for (auto iter = paramMap.constBegin(); iter != paramMap.constEnd(); iter++) {
+        if (_volatileParams.contains(iter.key())) {
+            continue;
+        }
+
+        FactMetaData::ValueType_t factType;
+        switch (_mapParamName2MavParamType[componentId][iter.key()]) {
+        case MAV_PARAM_TYPE_UINT8:
+            factType = FactMetaData::valueTypeUint8;
+            break;
+        case MAV_PARAM_TYPE_INT8:
+            factType = FactMetaData::valueTypeInt8;
+            break;
+        case MAV_PARAM_TYPE_UINT16:
+            factType = FactMetaData::valueTypeUint16;
+            break;
+        case MAV_PARAM_TYPE_INT16:
+            factType = FactMetaData::valueTypeInt16;
+            break;
+        case MAV_PARAM_TYPE_UINT32:
+            factType = FactMetaData::valueTypeUint32;
+            break;
+        case MAV_PARAM_TYPE_REAL32:
+            factType = FactMetaData::valueTypeFloat;
+            break;
+        default:
+            factType = FactMetaData::valueTypeInt32;
+            break;
+        }
+        hash = ParameterCacheFile::addToHash(hash, iter.key(), factType, iter.value());
+    }
+
+    return hash;
 }
 
 /// Sends the next parameter to the vehicle
@@ -706,6 +809,14 @@ void MockLink::_paramRequestListWorker(void)
         return;
     }
 
+    if (_paramHashCheckDeadline) {
+        if (_runningTime.elapsed() < _paramHashCheckDeadline) {
+            // Still waiting for an answer to the _HASH_CHECK
+            return;
+        }
+        _paramHashCheckDeadline = 0;
+    }
+
     int componentId = _mapParamName2Value.keys()[_currentParamRequestListComponentIndex];
     int cParameters = _mapParamName2Value[componentId].count();
     QString paramName = _mapParamName2Value[componentId].keys()[_currentParamRequestListParamIndex];
@@ -736,7 +847,7 @@ void MockLink::_paramRequestListWorker(void)
                                           paramType,                                     // MAV_PARAM_TYPE
                                           cParameters,                                   // Total number of parameters
                                           _currentParamRequestListParamIndex);           // Index of this parameter
-        respondWithMavlinkMessage(responseMsg);
+        _respondWithParamValue(responseMsg);
     }
 
     // Move to next param index
@@ -751,6 +862,28 @@ void MockLink::_paramRequestListWorker(void)
     }
 }
 
+/// Sends a PARAM_VALUE through the simulated link loss and latency
+void MockLink::_respondWithParamValue(const mavlink_message_t& msg)
+{
+    if (_paramLossPercent && static_cast<int>(QRandomGenerator::global()->bounded(100)) < _paramLossPercent) {
+        qCDebug(MockLinkLog) << "Simulated loss of PARAM_VALUE";
+        return;
+    }
+    if (_paramLatencyMSecs) {
+        _delayedParamValues.append(qMakePair(_runningTime.elapsed() + _paramLatencyMSecs, msg));
+        return;
+    }
+    respondWithMavlinkMessage(msg);
+}
+
+void MockLink::_delayedParamValueWorker(void)
+{
+    qint64 now = _runningTime.elapsed();
+    while (_delayedParamValues.count() && _delayedParamValues.first().first <= now) {
+        respondWithMavlinkMessage(_delayedParamValues.takeFirst().second);
+    }
+}
+
 void MockLink::_handleParamSet(const mavlink_message_t& msg)
 {
     mavlink_param_set_t request;
@@ -766,6 +899,18 @@ void MockLink::_handleParamSet(const mavlink_message_t& msg)
 
     qCDebug(MockLinkLog) << "_handleParamSet" << componentId << paramId << request.param_type;
 
+    if (strcmp(paramId, "_HASH_CHECK") == 0) {
+        // Parameter set was loaded from a cache with this hash, the list is no longer needed if it matches
+        mavlink_param_union_t valueUnion;
+        valueUnion.param_float = request.param_value;
+        if (_firmwareType == MAV_AUTOPILOT_PX4 && valueUnion.param_uint32 == _paramHash(_vehicleComponentId)) {
+            qCDebug(MockLinkLog) << "_handleParamSet _HASH_CHECK match, cancelling param list";
+            _currentParamRequestListComponentIndex = -1;
+        }
+        _paramHashCheckDeadline = 0;
+        return;
+    }
+
     Q_ASSERT(_mapParamName2Value.contains(componentId));
     Q_ASSERT(_mapParamName2MavParamType.contains(componentId));
     Q_ASSERT(_mapParamName2Value[componentId].contains(paramId));
@@ -799,20 +944,7 @@ void MockLink::_handleParamRequestRead(const mavlink_message_t& msg)
 
     // special case for magic _HASH_CHECK value
     if (request.target_component == MAV_COMP_ID_ALL && paramName == "_HASH_CHECK") {
-        mavlink_param_union_t   valueUnion;
-        valueUnion.type = MAV_PARAM_TYPE_UINT32;
-        valueUnion.param_uint32 = 0;
-        // Special case of magic hash check value
-        mavlink_msg_param_value_pack_chan(_vehicleSystemId,
-                                          componentId,
-                                          _mavlinkChannel,
-                                          &responseMsg,
-                                          request.param_id,
-                                          valueUnion.param_float,
-                                          MAV_PARAM_TYPE_UINT32,
-                                          0,
-                                          -1);
-        respondWithMavlinkMessage(responseMsg);
+        _sendParamHash();
         return;
     }
 
@@ -854,7 +986,7 @@ void MockLink::_handleParamRequestRead(const mavlink_message_t& msg)
                                       _mapParamName2MavParamType[componentId][paramId],          // Parameter type
                                       _mapParamName2Value[componentId].count(),                  // Total number of parameters
                                       _mapParamName2Value[componentId].keys().indexOf(paramId)); // Index of this parameter
-    respondWithMavlinkMessage(responseMsg);
+    _respondWithParamValue(responseMsg);
 }
 
 void MockLink::emitRemoteControlChannelRawChanged(int channel, uint16_t raw)
@@ -897,7 +1029,9 @@ void MockLink::emitRemoteControlChannelRawChanged(int channel, uint16_t raw)
 
 void MockLink::_handleFTP(const mavlink_message_t& msg)
 {
+    // Each server ignores messages targeted at other components
     _mockLinkFTP->mavlinkMessageReceived(msg);
+    _mockLinkFTPCamera->mavlinkMessageReceived(msg);
 }
 
 void MockLink::_handleCommandLong(const mavlink_message_t& msg)
@@ -1421,38 +1555,80 @@ void MockLink::_handleLogRequestData(const mavlink_message_t& msg)
     _logDownloadBytesRemaining = request.count;
 }
 
-void MockLink::_logDownloadWorker(void)
+void MockLink::setLogDownloadSimulation(uint32_t fileSize, const QList<uint32_t>& dropOffsets, const QList<uint32_t>& delayOffsets)
 {
-    if (_logDownloadBytesRemaining != 0) {
-        QFile file(_logDownloadFilename);
-        if (file.open(QIODevice::ReadOnly)) {
-            uint8_t buffer[MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN];
+    _logDownloadFileSize = fileSize;
 
-            qint64 bytesToRead = qMin(_logDownloadBytesRemaining, (uint32_t)MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            Q_ASSERT(file.seek(_logDownloadCurrentOffset));
-            Q_ASSERT(file.read((char *)buffer, bytesToRead) == bytesToRead);
+    _logDownloadDropOffsets.clear();
+    for (uint32_t offset: dropOffsets) {
+        _logDownloadDropOffsets.insert(offset);
+    }
+    _logDownloadDelayOffsets.clear();
+    for (uint32_t offset: delayOffsets) {
+        _logDownloadDelayOffsets.insert(offset);
+    }
+}
 
-            qDebug() << "MockLink::_logDownloadWorker" << _logDownloadCurrentOffset << _logDownloadBytesRemaining;
+void MockLink::_logDownloadWorker(void)
+{
+    for (int i = 0; i < _logDownloadPacketsPerTick && _logDownloadBytesRemaining != 0; i++) {
+        uint32_t offset = _logDownloadCurrentOffset;
+        uint32_t count  = qMin(_logDownloadBytesRemaining, static_cast<uint32_t>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN));
 
-            mavlink_message_t responseMsg;
-            mavlink_msg_log_data_pack_chan(_vehicleSystemId,
-                                           _vehicleComponentId,
-                                           _mavlinkChannel,
-                                           &responseMsg,
-                                           _logDownloadLogId,
-                                           _logDownloadCurrentOffset,
-                                           bytesToRead,
-                                           &buffer[0]);
-            respondWithMavlinkMessage(responseMsg);
+        _logDownloadCurrentOffset   += count;
+        _logDownloadBytesRemaining  -= count;
 
-            _logDownloadCurrentOffset += bytesToRead;
-            _logDownloadBytesRemaining -= bytesToRead;
+        if (_logDownloadDropOffsets.remove(offset)) {
+            qCDebug(MockLinkLog) << "MockLink::_logDownloadWorker dropping" << offset;
+            continue;
+        }
+        if (_logDownloadDelayOffsets.remove(offset) && _logDownloadDelayedCount == 0) {
+            qCDebug(MockLinkLog) << "MockLink::_logDownloadWorker delaying" << offset;
+            _logDownloadDelayedOffset   = offset;
+            _logDownloadDelayedCount    = count;
+            continue;
+        }
 
-            file.close();
-        } else {
-            qWarning() << "MockLink::_logDownloadWorker open failed" << file.errorString();
+        _sendLogData(offset, count);
+        if (_logDownloadDelayedCount != 0) {
+            _sendLogData(_logDownloadDelayedOffset, _logDownloadDelayedCount);
+            _logDownloadDelayedCount = 0;
         }
     }
+
+    // Nothing follows the held back packet, send it anyway
+    if (_logDownloadBytesRemaining == 0 && _logDownloadDelayedCount != 0) {
+        _sendLogData(_logDownloadDelayedOffset, _logDownloadDelayedCount);
+        _logDownloadDelayedCount = 0;
+    }
+}
+
+void MockLink::_sendLogData(uint32_t offset, uint32_t count)
+{
+    QFile file(_logDownloadFilename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "MockLink::_sendLogData open failed" << file.errorString();
+        return;
+    }
+
+    uint8_t buffer[MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN];
+    if (!file.seek(offset) || file.read(reinterpret_cast<char*>(buffer), count) != static_cast<qint64>(count)) {
+        qWarning() << "MockLink::_sendLogData read failed" << offset << count;
+        return;
+    }
+
+    qCDebug(MockLinkVerboseLog) << "MockLink::_sendLogData" << offset << count;
+
+    mavlink_message_t responseMsg;
+    mavlink_msg_log_data_pack_chan(_vehicleSystemId,
+                                   _vehicleComponentId,
+                                   _mavlinkChannel,
+                                   &responseMsg,
+                                   _logDownloadLogId,
+                                   offset,
+                                   static_cast<uint8_t>(count),
+                                   &buffer[0]);
+    respondWithMavlinkMessage(responseMsg);
 }
 
 void MockLink::_sendADSBVehicles(void)
@@ -11,7 +11,9 @@
 #pragma once
 
 #include <QElapsedTimer>
+#include <QMutex>
 #include <QMap>
+#include <QSet>
 #include <QLoggingCategory>
 #include <QGeoCoordinate>
 
@@ -119,7 +121,8 @@ public:
     /// Sends the specified mavlink message to QGC
     void respondWithMavlinkMessage(const mavlink_message_t& msg);
 
-    MockLinkFTP* mockLinkFTP(void) { return _mockLinkFTP; }
+    /// @return FTP server for the autopilot, or for the camera component if componentId is MAV_COMP_ID_CAMERA
+    MockLinkFTP* mockLinkFTP(uint8_t componentId = MAV_COMP_ID_AUTOPILOT1) { return componentId == MAV_COMP_ID_CAMERA ? _mockLinkFTPCamera : _mockLinkFTP; }
 
     // Overrides from LinkInterface
     QString getName             (void) const override { return _name; }
@@ -154,6 +157,21 @@ public:
     /// Returns the filename for the simulated log file. Only available after a download is requested.
     QString logDownloadFile(void) { return _logDownloadFilename; }
 
+    /// Returns the arrival times of all MANUAL_CONTROL messages received, as QDeadlineTimer::current(Qt::PreciseTimer) nsecs.
+    /// Thread safe.
+    QList<qint64> manualControlArrivals(void);
+
+    /// Simulates a poor link for parameter traffic. Set before the vehicle requests parameters.
+    ///     @param lossPercent Percentage of PARAM_VALUE messages which are dropped
+    ///     @param latencyMSecs Delay before each PARAM_VALUE is sent
+    void setParamLinkSimulation(int lossPercent, int latencyMSecs) { _paramLossPercent = lossPercent; _paramLatencyMSecs = latencyMSecs; }
+
+    /// Simulates a poor link for log download. Set before the log list is requested.
+    ///     @param fileSize Size of the simulated log file
+    ///     @param dropOffsets LOG_DATA offsets which are dropped the first time they are sent
+    ///     @param delayOffsets LOG_DATA offsets which are sent after the packet following them, the first time they are sent
+    void setLogDownloadSimulation(uint32_t fileSize, const QList<uint32_t>& dropOffsets, const QList<uint32_t>& delayOffsets);
+
     static MockLink* startPX4MockLink               (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startGenericMockLink           (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startNoInitialConnectMockLink  (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
@@ -205,6 +223,7 @@ private:
     void _handleIncomingNSHBytes        (const char* bytes, int cBytes);
     void _handleIncomingMavlinkBytes    (const uint8_t* bytes, int cBytes);
     void _loadParams                    (void);
+    void _loadVolatileParams            (void);
     void _handleHeartBeat               (const mavlink_message_t& msg);
     void _handleSetMode                 (const mavlink_message_t& msg);
     void _handleParamRequestList        (const mavlink_message_t& msg);
@@ -229,7 +248,12 @@ private:
     void _respondWithAutopilotVersion   (void);
     void _sendRCChannels                (void);
     void _paramRequestListWorker        (void);
+    void _sendParamHash                 (void);
+    quint32 _paramHash                  (int componentId);
+    void _respondWithParamValue         (const mavlink_message_t& msg);
+    void _delayedParamValueWorker       (void);
     void _logDownloadWorker             (void);
+    void _sendLogData                   (uint32_t offset, uint32_t count);
     void _sendADSBVehicles              (void);
     void _moveADSBVehicle               (void);
     void _sendVersionMetaData           (void);
@@ -252,6 +276,7 @@ private:
 
     QMap<int, QMap<QString, QVariant>>          _mapParamName2Value;
     QMap<int, QMap<QString, MAV_PARAM_TYPE>>    _mapParamName2MavParamType;
+    QSet<QString>                               _volatileParams;    ///< Autopilot parameters left out of the _HASH_CHECK
 
     uint8_t     _mavBaseMode;
     uint32_t    _mavCustomMode;
@@ -266,7 +291,8 @@ private:
     double              _vehicleLongitude;
     double              _vehicleAltitude;
 
-    MockLinkFTP* _mockLinkFTP = nullptr;
+    MockLinkFTP* _mockLinkFTP       = nullptr;
+    MockLinkFTP* _mockLinkFTPCamera = nullptr;
 
     bool _sendStatusText;
     bool _apmSendHomePositionOnEmptyList;
@@ -278,12 +304,27 @@ private:
     int _currentParamRequestListComponentIndex; // Current component index for param request list workflow, -1 for no request in progress
     int _currentParamRequestListParamIndex;     // Current parameter index for param request list workflow
 
+    int _paramLossPercent   = 0;
+    int _paramLatencyMSecs  = 0;
+    QList<QPair<qint64, mavlink_message_t>> _delayedParamValues;   ///< Pair: time to send, PARAM_VALUE message
+    qint64 _paramHashCheckDeadline = 0;     ///< Param list is held until _runningTime reaches this, 0 for not held
+
+    static const int _paramHashCheckMSecs = 100;    ///< How long the param list waits for the _HASH_CHECK answer
+
     static const uint16_t _logDownloadLogId = 0;        ///< Id of siumulated log file
-    static const uint32_t _logDownloadFileSize = 1000;  ///< Size of simulated log file
+    static const int      _logDownloadPacketsPerTick = 4;
+
+    QMutex          _manualControlMutex;
+    QList<qint64>   _manualControlArrivals;
 
     QString _logDownloadFilename;           ///< Filename for log download which is in progress
     uint32_t    _logDownloadCurrentOffset;  ///< Current offset we are sending from
     uint32_t    _logDownloadBytesRemaining; ///< Number of bytes still to send, 0 = send inactive
+    uint32_t        _logDownloadFileSize = 1000;    ///< Size of simulated log file
+    QSet<uint32_t>  _logDownloadDropOffsets;
+    QSet<uint32_t>  _logDownloadDelayOffsets;
+    uint32_t        _logDownloadDelayedOffset = 0;  ///< Offset of the packet being held back, only valid if _logDownloadDelayedCount != 0
+    uint32_t        _logDownloadDelayedCount  = 0;
 
     QGeoCoordinate  _adsbVehicleCoordinate;
     double          _adsbAngle;
@@ -295,5 +336,7 @@ private:
     static double       _defaultVehicleAltitude;
     static int          _nextVehicleSystemId;
     static const char*  _failParam;
+
+    friend class ParameterManagerTest;
 };
 
@@ -231,7 +231,57 @@ void MockLinkFTP::_burstReadCommand(uint8_t senderSystemId, uint8_t senderCompon
         burstOffset += cBytes;
     }
 
-    _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdBurstReadFile);
+    if (burstOffset >= _currentFile.size()) {
+        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdBurstReadFile);
+    }
+}
+
+void MockLinkFTP::_createCommand(uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber)
+{
+    MavlinkFTP::Request response;
+    uint16_t            outgoingSeqNumber = _nextSeqNumber(seqNumber);
+
+    ensureNullTemination(request);
+
+    _currentFile.close();
+    _uploadPath = (char *)request->data;
+    _uploadedFiles[_uploadPath].clear();
+
+    response.hdr.opcode     = MavlinkFTP::kRspAck;
+    response.hdr.req_opcode = MavlinkFTP::kCmdCreateFile;
+    response.hdr.session    = _sessionId;
+    response.hdr.offset     = 0;
+    response.hdr.size       = 0;
+
+    _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+}
+
+void MockLinkFTP::_writeCommand(uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber)
+{
+    MavlinkFTP::Request response;
+    uint16_t            outgoingSeqNumber = _nextSeqNumber(seqNumber);
+
+    if (request->hdr.session != _sessionId || _uploadPath.isEmpty()) {
+        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrInvalidSession, outgoingSeqNumber, MavlinkFTP::kCmdWriteFile);
+        return;
+    }
+
+    // Writes may arrive out of order, the file grows to cover the furthest write
+    QByteArray& bytes   = _uploadedFiles[_uploadPath];
+    int         end     = static_cast<int>(request->hdr.offset) + request->hdr.size;
+    if (bytes.size() < end) {
+        bytes.resize(end);
+    }
+    memcpy(bytes.data() + request->hdr.offset, request->data, request->hdr.size);
+
+    response.hdr.opcode         = MavlinkFTP::kRspAck;
+    response.hdr.req_opcode     = MavlinkFTP::kCmdWriteFile;
+    response.hdr.session        = _sessionId;
+    response.hdr.offset         = request->hdr.offset;
+    response.hdr.size           = sizeof(uint32_t);
+    response.writeFileLength    = request->hdr.size;
+
+    _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
 }
 
 void MockLinkFTP::_terminateCommand(uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber)
@@ -243,6 +293,9 @@ void MockLinkFTP::_terminateCommand(uint8_t senderSystemId, uint8_t senderCompon
         return;
     }
     
+    _currentFile.close();
+    _currentFile.remove();
+    _uploadPath.clear();
     _sendAck(senderSystemId, senderComponentId, outgoingSeqNumber, MavlinkFTP::kCmdTerminateSession);
 
     emit terminateCommandReceived();
@@ -254,6 +307,7 @@ void MockLinkFTP::_resetCommand(uint8_t senderSystemId, uint8_t senderComponentI
     
     _currentFile.close();
     _currentFile.remove();
+    _uploadPath.clear();
     _sendAck(senderSystemId, senderComponentId, outgoingSeqNumber, MavlinkFTP::kCmdResetSessions);
     
     emit resetCommandReceived();
@@ -270,17 +324,15 @@ void MockLinkFTP::mavlinkMessageReceived(const mavlink_message_t& message)
     mavlink_file_transfer_protocol_t requestFTP;
     mavlink_msg_file_transfer_protocol_decode(&message, &requestFTP);
     
-    if (requestFTP.target_system != _systemIdServer) {
+    if (requestFTP.target_system != _systemIdServer || requestFTP.target_component != _componentIdServer) {
         return;
     }
 
     MavlinkFTP::Request* request = (MavlinkFTP::Request*)&requestFTP.payload[0];
 
-    if (_randomDropsEnabled) {
-        if ((rand() % 5) == 0) {
-            qDebug() << "MockLinkFTP: Random drop of incoming packet";
-            return;
-        }
+    if (_randomDrop()) {
+        qDebug() << "MockLinkFTP: Random drop of incoming packet";
+        return;
     }
 
     if (_lastReplyValid && request->hdr.seqNumber == _lastReplySequence - 1) {
@@ -330,6 +382,14 @@ void MockLinkFTP::mavlinkMessageReceived(const mavlink_message_t& message)
         _burstReadCommand(message.sysid, message.compid, request, incomingSeqNumber);
         break;
 
+    case MavlinkFTP::kCmdCreateFile:
+        _createCommand(message.sysid, message.compid, request, incomingSeqNumber);
+        break;
+
+    case MavlinkFTP::kCmdWriteFile:
+        _writeCommand(message.sysid, message.compid, request, incomingSeqNumber);
+        break;
+
     case MavlinkFTP::kCmdTerminateSession:
         _terminateCommand(message.sysid, message.compid, request, incomingSeqNumber);
         break;
@@ -365,6 +425,7 @@ void MockLinkFTP::_sendNak(uint8_t targetSystemId, uint8_t targetComponentId, Ma
     nakResponse.hdr.opcode      = MavlinkFTP::kRspNak;
     nakResponse.hdr.req_opcode  = reqOpcode;
     nakResponse.hdr.session     = 0;
+    nakResponse.hdr.offset      = 0;
     nakResponse.hdr.size        = 1;
     nakResponse.data[0]         = error;
     
@@ -378,6 +439,7 @@ void MockLinkFTP::_sendNakErrno(uint8_t targetSystemId, uint8_t targetComponentI
     nakResponse.hdr.opcode      = MavlinkFTP::kRspNak;
     nakResponse.hdr.req_opcode  = reqOpcode;
     nakResponse.hdr.session     = 0;
+    nakResponse.hdr.offset      = 0;
     nakResponse.hdr.size        = 2;
     nakResponse.data[0]         = MavlinkFTP::kErrFailErrno;
     nakResponse.data[1]         = nakErrno;
@@ -401,16 +463,19 @@ void MockLinkFTP::_sendResponse(uint8_t targetSystemId, uint8_t targetComponentI
                                                  targetComponentId,
                                                  (uint8_t*)request);            // Payload
 
-    if (_randomDropsEnabled) {
-        if ((rand() % 5) == 0) {
-            qDebug() << "MockLinkFTP: Random drop of outgoing packet";
-            return;
-        }
+    if (_randomDrop()) {
+        qDebug() << "MockLinkFTP: Random drop of outgoing packet";
+        return;
     }
     
     _mockLink->respondWithMavlinkMessage(_lastReply);
 }
 
+bool MockLinkFTP::_randomDrop(void)
+{
+    return _randomDropsPercent > 0 && (rand() % 100) < _randomDropsPercent;
+}
+
 /// @brief Generates the next sequence number given an incoming sequence number. Handles generating
 /// bad sequence numbers when errModeBadSequence is set.
 uint16_t MockLinkFTP::_nextSeqNumber(uint16_t seqNumber)
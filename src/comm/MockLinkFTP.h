@@ -14,6 +14,7 @@
 
 #include <QStringList>
 #include <QFile>
+#include <QMap>
 
 class MockLink;
 
@@ -53,7 +54,16 @@ public:
     /// Called to handle an FTP message
     void mavlinkMessageReceived(const mavlink_message_t& message);
 
-    void enableRandromDrops(bool enable) { _randomDropsEnabled = enable; }
+    void enableRandromDrops(bool enable) { _randomDropsPercent = enable ? 20 : 0; }
+
+    /// Drops the specified percentage of incoming and outgoing packets
+    void setRandomDropsPercent(int percent) { _randomDropsPercent = percent; }
+
+    /// @return Contents of a file uploaded to the specified path, empty if nothing was uploaded
+    QByteArray uploadedFile(const QString& path) const { return _uploadedFiles.value(path); }
+
+    /// @return true if a file was created at the specified path, even if nothing was written to it
+    bool hasUploadedFile(const QString& path) const { return _uploadedFiles.contains(path); }
 
     static const char* sizeFilenamePrefix;
 
@@ -73,8 +83,11 @@ private:
     void        _openCommand            (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _readCommand            (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _burstReadCommand          (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
+    void        _createCommand          (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
+    void        _writeCommand           (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _terminateCommand       (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _resetCommand           (uint8_t senderSystemId, uint8_t senderComponentId, uint16_t seqNumber);
+    bool        _randomDrop             (void);
     uint16_t    _nextSeqNumber          (uint16_t seqNumber);
     QString     _createTestTempFile     (int size);
     
@@ -91,7 +104,9 @@ private:
     bool                    _lastReplyValid     = false;
     uint16_t                _lastReplySequence  = 0;
     mavlink_message_t       _lastReply;
-    bool                    _randomDropsEnabled = false;
+    int                     _randomDropsPercent = 0;
+    QString                 _uploadPath;                        ///< Path of file being uploaded, empty if none
+    QMap<QString, QByteArray> _uploadedFiles;                   ///< Uploaded file contents by path
 
     static const uint8_t    _sessionId          = 1;    ///< We only support a single fixed session
 };
@@ -0,0 +1,240 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryLogWriter.h"
+#include "QGCLoggingCategory.h"
+
+#include <QDateTime>
+#include <QtEndian>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#elif defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+QGC_LOGGING_CATEGORY(TelemetryLogWriterLog, "TelemetryLogWriterLog")
+
+TelemetryLogWriter::TelemetryLogWriter(QObject* parent, int ringSizeBytes)
+    : QThread               (parent)
+    , _logging              (false)
+    , _ringSize             (static_cast<quint64>(ringSizeBytes))
+    , _ringMask             (_ringSize - 1)
+    , _baseTimestampUSecs   (0)
+    , _head                 (0)
+    , _tail                 (0)
+    , _stopRequested        (0)
+    , _writeError           (0)
+    , _bytesWritten         (0)
+    , _droppedRecords       (0)
+    , _commitCount          (0)
+    , _commitNSecs          (0)
+    , _maxCommitNSecs       (0)
+    , _writeLatencyMSecs    (0)
+    , _maxWriteLatencyMSecs (0)
+{
+    _baseTimestampUSecs = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+    _monotonicClock.start();
+
+    _statsTimer.setInterval(_statsIntervalMSecs);
+    connect(&_statsTimer, &QTimer::timeout, this, &TelemetryLogWriter::_updateStats);
+}
+
+TelemetryLogWriter::~TelemetryLogWriter()
+{
+    stopLogging();
+}
+
+quint64 TelemetryLogWriter::timestampUSecs(void) const
+{
+    return _baseTimestampUSecs + static_cast<quint64>(_monotonicClock.nsecsElapsed() / 1000);
+}
+
+bool TelemetryLogWriter::startLogging(const QString& fileName)
+{
+    if (_logging) {
+        qWarning() << "TelemetryLogWriter::startLogging called while already logging";
+        return false;
+    }
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        _errorString = _file.errorString();
+        qCWarning(TelemetryLogWriterLog) << "Open failed" << fileName << _errorString;
+        return false;
+    }
+    _errorString.clear();
+
+    if (_ring.isEmpty()) {
+        _ring.resize(static_cast<int>(_ringSize));
+    }
+
+    // Resample wall clock time for each log so long running sessions don't drift from UTC
+    _baseTimestampUSecs = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+    _monotonicClock.restart();
+
+    _logging = true;
+    _head.store(0);
+    _tail.store(0);
+    _stopRequested.store(0);
+    _writeError.store(0);
+    _bytesWritten.store(0);
+    _droppedRecords.store(0);
+
+    start();
+    _statsTimer.start();
+
+    return true;
+}
+
+void TelemetryLogWriter::stopLogging(void)
+{
+    if (!_logging) {
+        return;
+    }
+
+    // The writer thread commits whatever is still queued, syncs and closes the file before it exits
+    _stopRequested.store(1);
+    _wakeSemaphore.release();
+    wait();
+
+    _statsTimer.stop();
+    _updateStats();
+    _logging = false;
+}
+
+bool TelemetryLogWriter::logRecord(quint64 timestampUSecs, const char* data, int length)
+{
+    if (!_logging || _writeError.load()) {
+        return false;
+    }
+
+    const quint64 recordLength = sizeof(quint64) + static_cast<quint64>(length);
+    const quint64 head         = _head.load();
+    const quint64 queued       = head - _tail.loadAcquire();
+
+    if (queued + recordLength > _ringSize) {
+        _droppedRecords.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    uint8_t timestamp[sizeof(quint64)];
+    qToBigEndian(timestampUSecs, timestamp);
+
+    // Copy timestamp and packet into the ring, wrapping as needed
+    quint64 position = head;
+    const char* rgSource[2]     = { reinterpret_cast<const char*>(timestamp), data };
+    const quint64 rgLength[2]   = { sizeof(timestamp), static_cast<quint64>(length) };
+    for (int i=0; i<2; i++) {
+        quint64 index       = position & _ringMask;
+        quint64 firstPart   = qMin(rgLength[i], _ringSize - index);
+        memcpy(_ring.data() + index, rgSource[i], firstPart);
+        memcpy(_ring.data(), rgSource[i] + firstPart, rgLength[i] - firstPart);
+        position += rgLength[i];
+    }
+
+    _head.storeRelease(position);
+
+    // Wake the writer early once the queue is half full
+    const quint64 halfFull = _ringSize / 2;
+    if (queued < halfFull && queued + recordLength >= halfFull) {
+        _wakeSemaphore.release();
+    }
+
+    return true;
+}
+
+void TelemetryLogWriter::run(void)
+{
+    QElapsedTimer syncTimer;
+    syncTimer.start();
+
+    while (!_stopRequested.load()) {
+        _wakeSemaphore.tryAcquire(1, _commitIntervalMSecs);
+        _commitQueued();
+        if (syncTimer.elapsed() >= _syncIntervalMSecs) {
+            _sync();
+            syncTimer.restart();
+        }
+    }
+
+    _commitQueued();
+    _sync();
+    _file.close();
+}
+
+/// Writes everything currently queued using as few large writes as possible
+void TelemetryLogWriter::_commitQueued(void)
+{
+    if (_writeError.load()) {
+        return;
+    }
+
+    const quint64   head = _head.loadAcquire();
+    quint64         tail = _tail.load();
+
+    if (head == tail) {
+        return;
+    }
+
+    QElapsedTimer commitTimer;
+    commitTimer.start();
+
+    while (tail != head) {
+        quint64 index       = tail & _ringMask;
+        quint64 writeBytes  = qMin(head - tail, _ringSize - index);
+        writeBytes          = qMin(writeBytes, static_cast<quint64>(_maxWriteBytes));
+
+        if (_file.write(_ring.constData() + index, static_cast<qint64>(writeBytes)) != static_cast<qint64>(writeBytes)) {
+            qCWarning(TelemetryLogWriterLog) << "Write failed" << _file.errorString();
+            _writeError.store(1);
+            emit writeFailed();
+            break;
+        }
+
+        tail += writeBytes;
+        _tail.storeRelease(tail);
+        _bytesWritten.fetchAndAddRelaxed(writeBytes);
+    }
+    _file.flush();
+
+    quint64 commitNSecs = static_cast<quint64>(commitTimer.nsecsElapsed());
+    _commitCount.fetchAndAddRelaxed(1);
+    _commitNSecs.fetchAndAddRelaxed(commitNSecs);
+    if (commitNSecs > _maxCommitNSecs.load()) {
+        _maxCommitNSecs.store(commitNSecs);
+    }
+}
+
+/// Pushes written data through to the storage device
+void TelemetryLogWriter::_sync(void)
+{
+    if (_writeError.load()) {
+        return;
+    }
+
+    _file.flush();
+#if defined(Q_OS_WIN)
+    ::_commit(_file.handle());
+#elif defined(Q_OS_UNIX)
+    fsync(_file.handle());
+#endif
+}
+
+void TelemetryLogWriter::_updateStats(void)
+{
+    quint64 commitCount     = _commitCount.fetchAndStoreRelaxed(0);
+    quint64 commitNSecs     = _commitNSecs.fetchAndStoreRelaxed(0);
+    quint64 maxCommitNSecs  = _maxCommitNSecs.fetchAndStoreRelaxed(0);
+
+    _writeLatencyMSecs      = commitCount ? (static_cast<double>(commitNSecs) / commitCount) / 1.0e6 : 0;
+    _maxWriteLatencyMSecs   = static_cast<double>(maxCommitNSecs) / 1.0e6;
+
+    emit statsChanged();
+}
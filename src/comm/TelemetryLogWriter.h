@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QFile>
+#include <QTimer>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryLogWriterLog)
+
+/// Writes telemetry log (tlog) records to disk on a background thread.
+///
+/// Records are queued by a single producer (the main thread) into a lock free single producer/single consumer ring
+/// buffer. The writer thread wakes up periodically and commits everything which is queued as a single large write, so
+/// a slow disk never blocks the producer. If the ring buffer fills up records are dropped and counted instead.
+///
+/// Each record is the standard tlog layout: uint64 big endian UTC timestamp in microseconds followed by the packet.
+class TelemetryLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    /// @param ringSizeBytes Size of the record queue, must be a power of 2
+    TelemetryLogWriter(QObject* parent = nullptr, int ringSizeBytes = _defaultRingSizeBytes);
+    ~TelemetryLogWriter();
+
+    Q_PROPERTY(quint64  bytesQueued             READ bytesQueued            NOTIFY statsChanged)
+    Q_PROPERTY(quint64  bytesWritten            READ bytesWritten           NOTIFY statsChanged)
+    Q_PROPERTY(quint64  droppedRecords          READ droppedRecords         NOTIFY statsChanged)
+    Q_PROPERTY(double   writeLatencyMSecs       READ writeLatencyMSecs      NOTIFY statsChanged)    ///< Average commit latency over the last stats period
+    Q_PROPERTY(double   maxWriteLatencyMSecs    READ maxWriteLatencyMSecs   NOTIFY statsChanged)    ///< Worst commit latency over the last stats period
+
+    quint64 bytesQueued         (void) const { return _head.load() - _tail.load(); }
+    quint64 bytesWritten        (void) const { return _bytesWritten.load(); }
+    quint64 droppedRecords      (void) const { return _droppedRecords.load(); }
+    double  writeLatencyMSecs   (void) const { return _writeLatencyMSecs; }
+    double  maxWriteLatencyMSecs(void) const { return _maxWriteLatencyMSecs; }
+
+    /// Opens the specified file and starts writing queued records to it. The writer owns the file handle until
+    /// stopLogging returns, the caller should not open the file in the meantime.
+    /// @return false: file could not be opened, see errorString()
+    bool startLogging(const QString& fileName);
+
+    /// Writes all queued records, syncs the file to disk, closes it and stops the writer thread. Once this returns
+    /// the complete log is on disk.
+    void stopLogging(void);
+
+    bool    isLogging   (void) const { return _logging; }
+    QString errorString (void) const { return _errorString; }
+
+    /// Queues a record for writing. Must only be called from a single thread.
+    ///     @param timestampUSecs UTC timestamp in microseconds, see timestampUSecs()
+    /// @return false: queue was full, record dropped
+    bool logRecord(quint64 timestampUSecs, const char* data, int length);
+
+    /// @return Monotonic UTC timestamp in microseconds. Wall clock time is only sampled when logging starts,
+    ///         after which time advances with the monotonic clock so timestamps never run backwards.
+    quint64 timestampUSecs(void) const;
+
+signals:
+    void statsChanged(void);
+
+    /// Signalled from the writer thread if writing to the file fails. No further records are written after this.
+    void writeFailed(void);
+
+protected:
+    // Override from QThread
+    void run(void) final;
+
+private slots:
+    void _updateStats(void);
+
+private:
+    void _commitQueued(void);
+    void _sync        (void);
+
+    QFile           _file;                  ///< Only touched by the writer thread while logging
+    bool            _logging;
+    QString         _errorString;
+    QByteArray      _ring;
+    quint64         _ringSize;
+    quint64         _ringMask;
+    QSemaphore      _wakeSemaphore;         ///< Used by the producer to wake the writer before the commit interval if the queue is filling up
+    QElapsedTimer   _monotonicClock;
+    quint64         _baseTimestampUSecs;
+    QTimer          _statsTimer;
+
+    // Ring buffer positions. Only the producer writes _head, only the writer thread writes _tail.
+    QAtomicInteger<quint64> _head;
+    QAtomicInteger<quint64> _tail;
+
+    QAtomicInteger<int>     _stopRequested;
+    QAtomicInteger<int>     _writeError;
+    QAtomicInteger<quint64> _bytesWritten;
+    QAtomicInteger<quint64> _droppedRecords;
+    QAtomicInteger<quint64> _commitCount;           ///< Number of commits since the last stats update
+    QAtomicInteger<quint64> _commitNSecs;           ///< Total commit time since the last stats update
+    QAtomicInteger<quint64> _maxCommitNSecs;        ///< Worst commit time since the last stats update
+
+    double  _writeLatencyMSecs;
+    double  _maxWriteLatencyMSecs;
+
+    static const int _defaultRingSizeBytes  = 4 * 1024 * 1024;
+    static const int _commitIntervalMSecs   = 50;
+    static const int _syncIntervalMSecs     = 1000;
+    static const int _maxWriteBytes         = 256 * 1024;
+    static const int _statsIntervalMSecs    = 1000;
+};
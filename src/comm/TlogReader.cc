@@ -0,0 +1,339 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogReader.h"
+#include "QGCLoggingCategory.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include <limits>
+
+QGC_LOGGING_CATEGORY(TlogReaderLog, "TlogReaderLog")
+
+const char* TlogReader::_indexFileExtension = "qgcindex";
+const char* TlogReader::_indexDirName       = "TlogIndex";
+
+TlogReader::TlogReader(void)
+    : _data             (nullptr)
+    , _size             (0)
+    , _nowUSecs         (0)
+    , _startTimeUSecs   (0)
+    , _endTimeUSecs     (0)
+{
+
+}
+
+TlogReader::~TlogReader()
+{
+    close();
+}
+
+QString TlogReader::indexFilename(const QString& logFilename)
+{
+    QDir        indexDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    QByteArray  pathHash = QCryptographicHash::hash(QFileInfo(logFilename).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+
+    return indexDir.filePath(QStringLiteral("%1/%2.%3").arg(_indexDirName).arg(QString::fromLatin1(pathHash)).arg(_indexFileExtension));
+}
+
+bool TlogReader::open(const QString& logFilename, QString& errorString)
+{
+    close();
+
+    _file.setFileName(logFilename);
+    if (!_file.open(QFile::ReadOnly)) {
+        errorString = QObject::tr("Unable to open log file: '%1', error: %2").arg(logFilename).arg(_file.errorString());
+        return false;
+    }
+
+    _size = _file.size();
+    if (_size <= cbTimestamp) {
+        errorString = QObject::tr("The log file '%1' is corrupt or empty.").arg(logFilename);
+        close();
+        return false;
+    }
+
+    _data = _file.map(0, _size);
+    if (!_data) {
+        errorString = QObject::tr("Unable to map log file: '%1', error: %2").arg(logFilename).arg(_file.errorString());
+        close();
+        return false;
+    }
+
+    _nowUSecs = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+    _indexFilename = indexFilename(logFilename);
+
+    if (!_loadIndex()) {
+        _buildIndex();
+        _saveIndex();
+    }
+
+    if (_index.isEmpty() || _endTimeUSecs <= _startTimeUSecs) {
+        errorString = QObject::tr("The log file '%1' is corrupt or empty.").arg(logFilename);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void TlogReader::close(void)
+{
+    if (_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+        _data = nullptr;
+    }
+    if (_file.isOpen()) {
+        _file.close();
+    }
+    _size           = 0;
+    _startTimeUSecs = 0;
+    _endTimeUSecs   = 0;
+    _index.clear();
+}
+
+/// Parses a BigEndian quint64 timestamp
+/// @return A Unix timestamp in microseconds UTC
+quint64 TlogReader::_parseTimestamp(const uchar* bytes) const
+{
+    quint64 timestamp = qFromBigEndian<quint64>(bytes);
+
+    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
+    // little endian, so switch it.
+    if (timestamp > _nowUSecs) {
+        timestamp = qbswap(timestamp);
+    }
+
+    return timestamp;
+}
+
+/// @return Length of the MAVLink packet which starts at the specified location, -1 if this is not the start of a packet
+int TlogReader::_packetLength(const uint8_t* packet, qint64 available)
+{
+    if (available < 3) {
+        return -1;
+    }
+
+    if (packet[0] == MAVLINK_STX) {
+        int length = MAVLINK_NUM_HEADER_BYTES + packet[1] + MAVLINK_NUM_CHECKSUM_BYTES;
+        if (packet[2] & MAVLINK_IFLAG_SIGNED) {
+            length += MAVLINK_SIGNATURE_BLOCK_LEN;
+        }
+        return length;
+    } else if (packet[0] == MAVLINK_STX_MAVLINK1) {
+        return 1 + MAVLINK_CORE_HEADER_MAVLINK1_LEN + packet[1] + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+
+    return -1;
+}
+
+/// Validates the packet checksum. Packets for messages which are not part of the dialect can't be validated and are
+/// accepted based on framing alone.
+bool TlogReader::_validPacket(const uint8_t* packet, int packetLength)
+{
+    bool        mavlink2    = packet[0] == MAVLINK_STX;
+    int         headerLen   = mavlink2 ? MAVLINK_CORE_HEADER_LEN : MAVLINK_CORE_HEADER_MAVLINK1_LEN;
+    int         payloadLen  = packet[1];
+    uint32_t    msgId;
+
+    if (1 + headerLen + payloadLen + MAVLINK_NUM_CHECKSUM_BYTES > packetLength) {
+        return false;
+    }
+
+    if (mavlink2) {
+        msgId = packet[7] | (packet[8] << 8) | (static_cast<uint32_t>(packet[9]) << 16);
+    } else {
+        msgId = packet[5];
+    }
+
+    const mavlink_msg_entry_t* msgEntry = mavlink_get_msg_entry(msgId);
+    if (!msgEntry) {
+        return true;
+    }
+
+    uint16_t crc = crc_calculate(packet + 1, static_cast<uint16_t>(headerLen + payloadLen));
+    crc_accumulate(msgEntry->crc_extra, &crc);
+
+    const uint8_t* checksum = packet + 1 + headerLen + payloadLen;
+    return (checksum[0] | (checksum[1] << 8)) == crc;
+}
+
+bool TlogReader::readRecord(qint64& offset, Record_t& record) const
+{
+    while (offset + cbTimestamp < _size) {
+        const uint8_t*  packet          = _data + offset + cbTimestamp;
+        qint64          available       = _size - offset - cbTimestamp;
+        int             packetLength    = _packetLength(packet, available);
+
+        if (packetLength > 0 && packetLength <= available && _validPacket(packet, packetLength)) {
+            record.timestampUSecs   = _parseTimestamp(_data + offset);
+            record.packet           = packet;
+            record.packetLength     = packetLength;
+            offset += cbTimestamp + packetLength;
+            return true;
+        }
+
+        // Not a valid record, resync one byte at a time
+        offset++;
+    }
+
+    offset = _size;
+    return false;
+}
+
+qint64 TlogReader::offsetForTimestamp(quint64 timestampUSecs) const
+{
+    if (_index.isEmpty()) {
+        return 0;
+    }
+
+    // Find the last index entry at or before the requested time
+    auto iter = std::upper_bound(_index.constBegin(), _index.constEnd(), timestampUSecs,
+                                 [](quint64 timestamp, const IndexEntry_t& entry) { return timestamp < entry.timestampUSecs; });
+    if (iter != _index.constBegin()) {
+        iter--;
+    }
+
+    // Then scan forward to the exact record
+    qint64      offset = iter->offset;
+    Record_t    record;
+    while (true) {
+        qint64 recordOffset = offset;
+        if (!readRecord(offset, record)) {
+            return _size;
+        }
+        if (record.timestampUSecs >= timestampUSecs) {
+            return recordOffset;
+        }
+    }
+}
+
+void TlogReader::_buildIndex(void)
+{
+    qint64      offset = 0;
+    Record_t    record;
+
+    _clearIndex();
+
+    while (true) {
+        qint64 recordOffset = offset;
+        if (!readRecord(offset, record)) {
+            break;
+        }
+        if (_index.isEmpty()) {
+            _startTimeUSecs = record.timestampUSecs;
+            _index.append({ record.timestampUSecs, recordOffset });
+        } else if (record.timestampUSecs >= _index.last().timestampUSecs + _indexIntervalUSecs) {
+            // Timestamps can step backwards slightly, only index increasing times so the index stays sorted
+            _index.append({ record.timestampUSecs, recordOffset });
+        }
+        _endTimeUSecs = record.timestampUSecs;
+    }
+
+    qCDebug(TlogReaderLog) << "Built index" << _file.fileName() << "entries" << _index.count();
+}
+
+/// Loads the cached index if it is valid for the current log file
+bool TlogReader::_loadIndex(void)
+{
+    QFile indexFile(_indexFilename);
+
+    if (!indexFile.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&indexFile);
+    quint32     magic;
+    quint32     version;
+    qint64      logSize;
+    qint64      logModifiedMSecs;
+    quint32     count;
+
+    stream >> magic >> version >> logSize >> logModifiedMSecs;
+    if (magic != _indexMagic || version != _indexVersion || logSize != _size ||
+            logModifiedMSecs != QFileInfo(_file).lastModified().toMSecsSinceEpoch()) {
+        qCDebug(TlogReaderLog) << "Ignoring stale index" << _indexFilename;
+        return false;
+    }
+
+    // The index file is untrusted input. Each entry points at a distinct record, and each record holds at least a
+    // timestamp, which bounds the entry count by the log size.
+    stream >> _startTimeUSecs >> _endTimeUSecs >> count;
+    if (stream.status() != QDataStream::Ok || count > static_cast<quint64>(_size) / sizeof(quint64) || count > static_cast<quint32>(std::numeric_limits<int>::max())) {
+        qCDebug(TlogReaderLog) << "Ignoring corrupt index" << _indexFilename << "count" << count;
+        _clearIndex();
+        return false;
+    }
+
+    _index.resize(static_cast<int>(count));
+    for (int i = 0; i < _index.count(); i++) {
+        IndexEntry_t& entry = _index[i];
+        stream >> entry.timestampUSecs >> entry.offset;
+
+        // Offsets must be within the log and both offsets and timestamps must be increasing since lookups
+        // binary search the index and then read from the offset.
+        bool valid = entry.offset >= 0 && entry.offset < _size;
+        if (valid && i > 0) {
+            const IndexEntry_t& previous = _index[i - 1];
+            valid = entry.offset > previous.offset && entry.timestampUSecs >= previous.timestampUSecs;
+        }
+        if (stream.status() != QDataStream::Ok || !valid) {
+            qCDebug(TlogReaderLog) << "Ignoring corrupt index" << _indexFilename << "entry" << i;
+            _clearIndex();
+            return false;
+        }
+    }
+
+    qCDebug(TlogReaderLog) << "Loaded index" << _indexFilename << "entries" << _index.count();
+    return true;
+}
+
+void TlogReader::_clearIndex(void)
+{
+    _index.clear();
+    _startTimeUSecs = 0;
+    _endTimeUSecs   = 0;
+}
+
+/// Caches the index in the cache directory. Failure is not an error, the index will just be rebuilt on next open.
+void TlogReader::_saveIndex(void)
+{
+    if (_index.isEmpty()) {
+        return;
+    }
+
+    if (!QDir().mkpath(QFileInfo(_indexFilename).absolutePath())) {
+        qCDebug(TlogReaderLog) << "Unable to create index directory" << QFileInfo(_indexFilename).absolutePath();
+        return;
+    }
+
+    QSaveFile indexFile(_indexFilename);
+    if (!indexFile.open(QFile::WriteOnly)) {
+        qCDebug(TlogReaderLog) << "Unable to cache index" << _indexFilename << indexFile.errorString();
+        return;
+    }
+
+    QDataStream stream(&indexFile);
+    stream << _indexMagic << _indexVersion << _size << QFileInfo(_file).lastModified().toMSecsSinceEpoch();
+    stream << _startTimeUSecs << _endTimeUSecs << static_cast<quint32>(_index.count());
+    for (const IndexEntry_t& entry: _index) {
+        stream << entry.timestampUSecs << entry.offset;
+    }
+
+    if (!indexFile.commit()) {
+        qCDebug(TlogReaderLog) << "Unable to cache index" << _indexFilename << indexFile.errorString();
+    }
+}
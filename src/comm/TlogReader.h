@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QLoggingCategory>
+
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TlogReaderLog)
+
+/// Random access reader for telemetry logs (tlog).
+///
+/// The log file is memory mapped and records are framed directly from the mapped memory using the MAVLink header
+/// length and checksum, so no per byte parsing state is required. On first open a sparse timestamp to file offset index
+/// is built and cached in the application cache directory. Seeking to a timestamp is then a binary search of the index followed by a
+/// short forward scan, independent of log size.
+class TlogReader
+{
+public:
+    typedef struct {
+        quint64 timestampUSecs;
+        qint64  offset;
+    } IndexEntry_t;
+
+    typedef struct {
+        quint64         timestampUSecs;     ///< UTC timestamp in microseconds
+        const uint8_t*  packet;             ///< Raw MAVLink packet, points into the mapped log file
+        int             packetLength;
+    } Record_t;
+
+    TlogReader(void);
+    ~TlogReader();
+
+    /// Opens and maps the specified log file, loading or building the index
+    ///     @param[out] errorString Error message if open fails
+    /// @return true: success
+    bool open(const QString& logFilename, QString& errorString);
+
+    void close(void);
+
+    bool    isOpen          (void) const { return _data != nullptr; }
+    qint64  size            (void) const { return _size; }
+    quint64 startTimeUSecs  (void) const { return _startTimeUSecs; }
+    quint64 endTimeUSecs    (void) const { return _endTimeUSecs; }
+
+    const QVector<IndexEntry_t>& index(void) const { return _index; }
+
+    /// Reads the record at the specified offset. Corrupt data is skipped until the next valid record.
+    ///     @param[in,out] offset File offset to read from, updated to the offset of the following record
+    ///     @param[out] record Record which was read
+    /// @return false: no more records in file
+    bool readRecord(qint64& offset, Record_t& record) const;
+
+    /// @return File offset of the first record with a timestamp at or after the specified time
+    qint64 offsetForTimestamp(quint64 timestampUSecs) const;
+
+    /// @return Filename used to cache the index for the specified log file. Index files are kept in the application
+    ///         cache directory, keyed by the absolute path of the log, so log directories are never written to.
+    static QString indexFilename(const QString& logFilename);
+
+    static const int cbTimestamp = sizeof(quint64);
+
+private:
+    quint64 _parseTimestamp (const uchar* bytes) const;
+    bool    _loadIndex      (void);
+    void    _buildIndex     (void);
+    void    _saveIndex      (void);
+    void    _clearIndex     (void);
+
+    static int  _packetLength   (const uint8_t* packet, qint64 available);
+    static bool _validPacket    (const uint8_t* packet, int packetLength);
+
+    QFile                   _file;
+    QString                 _indexFilename;
+    const uchar*            _data;
+    qint64                  _size;
+    quint64                 _nowUSecs;
+    quint64                 _startTimeUSecs;
+    quint64                 _endTimeUSecs;
+    QVector<IndexEntry_t>   _index;
+
+    static const quint32    _indexMagic             = 0x51474349;   ///< "QGCI"
+    static const quint32    _indexVersion           = 1;
+    static const quint64    _indexIntervalUSecs     = 1000000;      ///< Log time between index entries
+    static const char*      _indexFileExtension;
+    static const char*      _indexDirName;
+};
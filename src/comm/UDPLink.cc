@@ -31,6 +31,13 @@
 #include "SettingsManager.h"
 #include "AutoConnectSettings.h"
 
+#if defined(QGC_UDP_BATCH_RECEIVE)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
 #define REMOVE_GONE_HOSTS 0
 
 static const char* kZeroconfRegistration = "_qgroundcontrol._udp";
@@ -221,19 +228,7 @@ void UDPLink::readBytes()
             databuffer.clear();
         }
         _logInputDataRate(datagram.length(), QDateTime::currentMSecsSinceEpoch());
-        // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
-        // added to the list and will start receiving datagrams from here. Even a port scanner
-        // would trigger this.
-        // Add host to broadcast list if not yet present, or update its port
-        QHostAddress asender = sender;
-        if(_isIpLocal(sender)) {
-            asender = QHostAddress(QString("127.0.0.1"));
-        }
-        if(!contains_target(_sessionTargets, asender, senderPort)) {
-            qDebug() << "Adding target" << asender << senderPort;
-            UDPCLient* target = new UDPCLient(asender, senderPort);
-            _sessionTargets.append(target);
-        }
+        _addSessionTarget(sender, senderPort);
     }
     //-- Send whatever is left
     if(databuffer.size()) {
@@ -241,6 +236,123 @@ void UDPLink::readBytes()
     }
 }
 
+void UDPLink::_addSessionTarget(const QHostAddress& sender, quint16 senderPort)
+{
+    // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
+    // added to the list and will start receiving datagrams from here. Even a port scanner
+    // would trigger this.
+    // Add host to broadcast list if not yet present, or update its port
+    QHostAddress asender = sender;
+    if(_isIpLocal(sender)) {
+        asender = QHostAddress(QString("127.0.0.1"));
+    }
+    if(!contains_target(_sessionTargets, asender, senderPort)) {
+        qDebug() << "Adding target" << asender << senderPort;
+        UDPCLient* target = new UDPCLient(asender, senderPort);
+        _sessionTargets.append(target);
+    }
+}
+
+#if defined(QGC_UDP_BATCH_RECEIVE)
+/// Called from QUdpSocket::readyRead. The first datagram is read through QUdpSocket, which re-arms its read
+/// notification, then whatever else is pending is drained with a single recvmmsg call on the same descriptor.
+/// Datagrams land in fixed size slots of the reused receive buffer and are compacted in place, so the buffer
+/// itself is emitted. It is only reallocated if the receiver is still holding on to the previous chunk.
+/// Anything left in the socket after the recvmmsg call fires readyRead again.
+void UDPLink::_readBytesBatched()
+{
+    if (!_socket || !_socket->hasPendingDatagrams()) {
+        return;
+    }
+
+    const int bufferSize = (_batchDatagrams + 1) * _batchSlotSize;
+    if (_receiveBuffer.size() != bufferSize) {
+        _receiveBuffer.resize(bufferSize);
+    }
+    char* buffer = _receiveBuffer.data();
+
+    QHostAddress    sender;
+    quint16         senderPort;
+    qint64          firstLength = _socket->readDatagram(buffer, _batchSlotSize, &sender, &senderPort);
+    if (firstLength < 0) {
+        return;
+    }
+    _singleDatagramCount++;
+    _addSessionTarget(sender, senderPort);
+
+    mmsghdr             rgHeaders[_batchDatagrams];
+    iovec               rgIovecs[_batchDatagrams];
+    sockaddr_storage    rgSenders[_batchDatagrams];
+
+    memset(rgHeaders, 0, sizeof(rgHeaders));
+    for (int i = 0; i < _batchDatagrams; i++) {
+        rgIovecs[i].iov_base                = buffer + ((i + 1) * _batchSlotSize);
+        rgIovecs[i].iov_len                 = _batchSlotSize;
+        rgHeaders[i].msg_hdr.msg_iov        = &rgIovecs[i];
+        rgHeaders[i].msg_hdr.msg_iovlen     = 1;
+        rgHeaders[i].msg_hdr.msg_name       = &rgSenders[i];
+        rgHeaders[i].msg_hdr.msg_namelen    = sizeof(rgSenders[i]);
+    }
+
+    int offset  = static_cast<int>(firstLength);
+    int count   = recvmmsg(static_cast<int>(_socket->socketDescriptor()), rgHeaders, _batchDatagrams, MSG_DONTWAIT, nullptr);
+    if (count < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            qWarning() << "UDPLink: recvmmsg failed" << strerror(errno);
+        }
+        count = 0;
+    }
+    if (count > 0) {
+        _batchCallCount++;
+        _batchDatagramCount += static_cast<quint64>(count);
+    }
+
+    for (int i = 0; i < count; i++) {
+        const msghdr& header = rgHeaders[i].msg_hdr;
+
+        if (header.msg_flags & MSG_TRUNC) {
+            qWarning() << "UDPLink: Datagram larger than" << _batchSlotSize << "bytes truncated";
+        }
+
+        // Slots only ever move towards the front of the buffer
+        memmove(buffer + offset, rgIovecs[i].iov_base, rgHeaders[i].msg_len);
+        offset += static_cast<int>(rgHeaders[i].msg_len);
+
+        _addBatchSender(&rgSenders[i], static_cast<int>(header.msg_namelen));
+    }
+
+    if (offset) {
+        _receiveBuffer.resize(offset);
+        _logInputDataRate(offset, QDateTime::currentMSecsSinceEpoch());
+        emit bytesReceived(this, _receiveBuffer);
+    }
+}
+
+/// Only senders which haven't been seen recently go through the QHostAddress based session target check
+void UDPLink::_addBatchSender(const void* senderAddress, int senderAddressLength)
+{
+    QByteArray rawSender = QByteArray::fromRawData(static_cast<const char*>(senderAddress), senderAddressLength);
+    if (_knownSenders.contains(rawSender)) {
+        return;
+    }
+
+    // A port scan or many short lived peers must not grow the cache forever, starting over just costs a few lookups
+    if (_knownSenders.count() >= _maxKnownSenders) {
+        _knownSenders.clear();
+    }
+    _knownSenders.insert(QByteArray(rawSender.constData(), rawSender.size()));
+
+    const sockaddr* address = static_cast<const sockaddr*>(senderAddress);
+    quint16         senderPort;
+    if (address->sa_family == AF_INET6) {
+        senderPort = ntohs(reinterpret_cast<const sockaddr_in6*>(address)->sin6_port);
+    } else {
+        senderPort = ntohs(reinterpret_cast<const sockaddr_in*>(address)->sin_port);
+    }
+    _addSessionTarget(QHostAddress(address), senderPort);
+}
+#endif
+
 /**
  * @brief Disconnect the connection.
  *
@@ -302,7 +414,13 @@ bool UDPLink::_hardwareConnect()
         _socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, bufferSizeMultiplier * receiveBufferSize);
 
         _registerZeroconf(_udpConfig->localPort(), kZeroconfRegistration);
+
+#if defined(QGC_UDP_BATCH_RECEIVE)
+        _knownSenders.clear();
+        QObject::connect(_socket, &QUdpSocket::readyRead, this, &UDPLink::_readBytesBatched);
+#else
         QObject::connect(_socket, &QUdpSocket::readyRead, this, &UDPLink::readBytes);
+#endif
         emit connected();
     } else {
         emit communicationError(tr("UDP Link Error"), tr("Error binding UDP port: %1").arg(_socket->errorString()));
@@ -25,6 +25,7 @@
 #include <QMutexLocker>
 #include <QQueue>
 #include <QByteArray>
+#include <QSet>
 
 #if defined(QGC_ZEROCONF_ENABLED)
 #include <dns_sd.h>
@@ -33,6 +34,11 @@
 #include "QGCConfig.h"
 #include "LinkManager.h"
 
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+// Incoming datagrams are drained with recvmmsg into a reused buffer instead of one readDatagram call per datagram
+#define QGC_UDP_BATCH_RECEIVE
+#endif
+
 class UDPCLient {
 public:
     UDPCLient(const QHostAddress& address_, quint16 port_)
@@ -159,6 +165,7 @@ class UDPLink : public LinkInterface
 
     friend class UDPConfiguration;
     friend class LinkManager;
+    friend class UDPLinkTest;
 
 public:
     void    requestReset            () override { }
@@ -199,6 +206,11 @@ private:
     void    _registerZeroconf       (uint16_t port, const std::string& regType);
     void    _deregisterZeroconf     ();
     void    _writeDataGram          (const QByteArray data, const UDPCLient* target);
+    void    _addSessionTarget       (const QHostAddress& sender, quint16 senderPort);
+#if defined(QGC_UDP_BATCH_RECEIVE)
+    void    _readBytesBatched       ();
+    void    _addBatchSender         (const void* senderAddress, int senderAddressLength);
+#endif
 
 #if defined(QGC_ZEROCONF_ENABLED)
     DNSServiceRef  _dnssServiceRef;
@@ -211,5 +223,17 @@ private:
     QList<UDPCLient*>       _sessionTargets;
     QList<QHostAddress>     _localAddress;
 
+#if defined(QGC_UDP_BATCH_RECEIVE)
+    QByteArray              _receiveBuffer;             ///< Reused receive buffer, one fixed size slot per datagram. Emitted as is.
+    QSet<QByteArray>        _knownSenders;              ///< Raw sender addresses already checked against the session targets
+    quint64                 _batchCallCount     = 0;    ///< Number of recvmmsg calls which returned datagrams
+    quint64                 _batchDatagramCount = 0;    ///< Number of datagrams read through recvmmsg
+    quint64                 _singleDatagramCount = 0;   ///< Number of datagrams read through QUdpSocket
+
+    static const int        _batchDatagrams     = 64;
+    static const int        _batchSlotSize      = 4096;
+    static const int        _maxKnownSenders    = 64;   ///< Sender cache is cleared when it grows past this
+#endif
+
 };
 
@@ -32,6 +32,8 @@
 #ifndef __mobile__
     #include "QGCSerialPortInfo.h"
     #include "RunGuard.h"
+    #include "CmdLineOptParser.h"
+    #include "TlogAnalyzer.h"
 #endif
 
 #ifdef UNITTEST_BUILD
@@ -226,6 +228,31 @@ bool checkAndroidWritePermission() {
 int main(int argc, char *argv[])
 {
 #ifndef __mobile__
+    // Headless tlog analysis runs without the ui or any of the tools, so it must be handled before anything else is
+    // started. It is also allowed to run alongside a normal instance.
+    {
+        bool analyzeTlog = false;
+        bool fieldsFound = false;
+        bool outputFound = false;
+        bool gapFound = false;
+        QString logPath;
+        QString fields;
+        QString outputDir;
+        QString gapThresholdMSecs;
+        CmdLineOpt_t rgAnalyzeOptions[] = {
+            { "--analyze-tlog",         &analyzeTlog,   &logPath },
+            { "--analyze-fields",       &fieldsFound,   &fields },
+            { "--analyze-output",       &outputFound,   &outputDir },
+            { "--analyze-gap-msecs",    &gapFound,      &gapThresholdMSecs },
+        };
+
+        ParseCmdLineOptions(argc, argv, rgAnalyzeOptions, sizeof(rgAnalyzeOptions)/sizeof(rgAnalyzeOptions[0]), false);
+        if (analyzeTlog) {
+            QCoreApplication analyzeApp(argc, argv);
+            return TlogAnalyzer::runFromCommandLine(logPath, fields, outputDir, gapThresholdMSecs);
+        }
+    }
+
     RunGuard guard("QGroundControlRunGuardKey");
     if (!guard.tryToRun()) {
         // QApplication is necessary to use QMessageBox
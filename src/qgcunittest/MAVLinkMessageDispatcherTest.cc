@@ -0,0 +1,209 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageDispatcherTest.h"
+
+#include <QRegularExpression>
+#include <QThread>
+
+/// The dispatcher only looks at the header fields, so there is no need for a packed message
+mavlink_message_t MAVLinkMessageDispatcherTest::_message(uint32_t msgid, uint8_t sysid, uint8_t compid)
+{
+    mavlink_message_t message;
+
+    memset(&message, 0, sizeof(message));
+    message.msgid   = msgid;
+    message.sysid   = sysid;
+    message.compid  = compid;
+
+    return message;
+}
+
+void MAVLinkMessageDispatcherTest::_dispatch_test(void)
+{
+    const uint32_t overflowMsgId = _overflowMsgId;
+
+    MAVLinkMessageDispatcher    dispatcher;
+    QObject                     context;
+    int                         heartbeatCount  = 0;
+    int                         attitudeCount   = 0;
+    int                         overflowCount   = 0;
+
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT,    [&](LinkInterface*, const mavlink_message_t&) { heartbeatCount++; });
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_ATTITUDE,     [&](LinkInterface*, const mavlink_message_t&) { attitudeCount++; });
+    dispatcher.subscribe(&context, overflowMsgId,               [&](LinkInterface*, const mavlink_message_t&) { overflowCount++; });
+    QCOMPARE(dispatcher.subscriberCount(MAVLINK_MSG_ID_HEARTBEAT), 1);
+    QCOMPARE(dispatcher.subscriberCount(overflowMsgId), 1);
+    QCOMPARE(dispatcher.subscriberCount(MAVLINK_MSG_ID_VFR_HUD), 0);
+
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, 1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, 1));
+    dispatcher.dispatch(nullptr, _message(overflowMsgId, 1, 1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_VFR_HUD, 1, 1));
+    QCOMPARE(heartbeatCount,    2);
+    QCOMPARE(attitudeCount,     0);
+    QCOMPARE(overflowCount,     1);
+}
+
+void MAVLinkMessageDispatcherTest::_filter_test(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    QObject                     context;
+    int                         anyCount        = 0;
+    int                         sysidCount      = 0;
+    int                         compidCount     = 0;
+    int                         exactCount      = 0;
+    const int                   anyId           = MAVLinkMessageDispatcher::anyId;
+
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) { anyCount++; });
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) { sysidCount++; },   1,      anyId);
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) { compidCount++; },  anyId,  MAV_COMP_ID_CAMERA);
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) { exactCount++; },   1,      MAV_COMP_ID_CAMERA);
+
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, MAV_COMP_ID_AUTOPILOT1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, MAV_COMP_ID_CAMERA));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 2, MAV_COMP_ID_CAMERA));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 2, MAV_COMP_ID_AUTOPILOT1));
+
+    QCOMPARE(anyCount,      4);
+    QCOMPARE(sysidCount,    2);
+    QCOMPARE(compidCount,   2);
+    QCOMPARE(exactCount,    1);
+}
+
+/// High priority handlers are called first regardless of subscription order, then subscription order
+void MAVLinkMessageDispatcherTest::_priority_test(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    QObject                     context;
+    QStringList                 callOrder;
+    const int                   anyId = MAVLinkMessageDispatcher::anyId;
+
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) { callOrder.append("normal1"); });
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) { callOrder.append("high1"); }, anyId, anyId, MAVLinkMessageDispatcher::PriorityHigh);
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) { callOrder.append("normal2"); });
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) { callOrder.append("high2"); }, anyId, anyId, MAVLinkMessageDispatcher::PriorityHigh);
+
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, 1));
+    QCOMPARE(callOrder, QStringList({ "high1", "high2", "normal1", "normal2" }));
+}
+
+/// Handlers which subscribe and unsubscribe while a message is being dispatched
+void MAVLinkMessageDispatcherTest::_subscribeDuringDispatch_test(void)
+{
+    const uint32_t overflowMsgId = _overflowMsgId;
+
+    MAVLinkMessageDispatcher    dispatcher;
+    QObject                     context;
+    int                         addedCount      = 0;
+    int                         removedCount    = 0;
+    int                         selfCount       = 0;
+    int                         overflowCount   = 0;
+    int                         removedId       = 0;
+    int                         selfId          = 0;
+    bool                        subscribed      = false;
+
+    // First handler adds a new subscription to the same message id, a new overflow message id which may rehash the
+    // overflow table, and removes a handler which comes later in the list
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) {
+        if (!subscribed) {
+            subscribed = true;
+            dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) { addedCount++; });
+            for (uint32_t i = 0; i < 64; i++) {
+                dispatcher.subscribe(&context, overflowMsgId + i, [&](LinkInterface*, const mavlink_message_t&) { overflowCount++; });
+            }
+            dispatcher.unsubscribe(removedId);
+        }
+    });
+    selfId = dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) {
+        selfCount++;
+        dispatcher.unsubscribe(selfId);
+    });
+    removedId = dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT, [&](LinkInterface*, const mavlink_message_t&) { removedCount++; });
+    QCOMPARE(dispatcher.subscriberCount(MAVLINK_MSG_ID_HEARTBEAT), 3);
+
+    // Subscriptions added during dispatch are not called until the next message, removed ones are not called at all
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, 1));
+    QCOMPARE(addedCount,    0);
+    QCOMPARE(removedCount,  0);
+    QCOMPARE(selfCount,     1);
+    QCOMPARE(dispatcher.subscriberCount(MAVLINK_MSG_ID_HEARTBEAT), 2);
+
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, 1));
+    dispatcher.dispatch(nullptr, _message(overflowMsgId + 10, 1, 1));
+    QCOMPARE(addedCount,    1);
+    QCOMPARE(removedCount,  0);
+    QCOMPARE(selfCount,     1);
+    QCOMPARE(overflowCount, 1);
+}
+
+void MAVLinkMessageDispatcherTest::_contextDestroyed_test(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    QObject*                    context         = new QObject();
+    QObject                     otherContext;
+    int                         callCount       = 0;
+    int                         otherCallCount  = 0;
+
+    dispatcher.subscribe(context,       MAVLINK_MSG_ID_HEARTBEAT,   [&](LinkInterface*, const mavlink_message_t&) { callCount++; });
+    dispatcher.subscribe(context,       MAVLINK_MSG_ID_ATTITUDE,    [&](LinkInterface*, const mavlink_message_t&) { callCount++; });
+    dispatcher.subscribe(&otherContext, MAVLINK_MSG_ID_HEARTBEAT,   [&](LinkInterface*, const mavlink_message_t&) { otherCallCount++; });
+
+    delete context;
+    QCOMPARE(dispatcher.subscriberCount(MAVLINK_MSG_ID_HEARTBEAT),  1);
+    QCOMPARE(dispatcher.subscriberCount(MAVLINK_MSG_ID_ATTITUDE),   0);
+
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, 1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_ATTITUDE,  1, 1));
+    QCOMPARE(callCount,         0);
+    QCOMPARE(otherCallCount,    1);
+
+    dispatcher.unsubscribeAll(&otherContext);
+    QCOMPARE(dispatcher.subscriberCount(MAVLINK_MSG_ID_HEARTBEAT),  0);
+}
+
+/// Dispatch counts and handler time are tracked per message id and per subscription
+void MAVLinkMessageDispatcherTest::_cost_test(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    QObject                     context;
+
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_HEARTBEAT,    [&](LinkInterface*, const mavlink_message_t&) { });
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_ATTITUDE,     [&](LinkInterface*, const mavlink_message_t&) { QThread::msleep(5); });
+    dispatcher.subscribe(&context, MAVLINK_MSG_ID_ATTITUDE,     [&](LinkInterface*, const mavlink_message_t&) { });
+
+    // Nothing dispatched, nothing reported
+    QVERIFY(dispatcher.costReport().isEmpty());
+
+    for (int i = 0; i < 3; i++) {
+        dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, 1));
+    }
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_ATTITUDE, 1, 1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_ATTITUDE, 1, 1));
+
+    // Messages nobody subscribed to are not counted
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_VFR_HUD, 1, 1));
+
+    // Most expensive message first, each followed by its subscriptions
+    QStringList report = dispatcher.costReport();
+    QCOMPARE(report.count(), 5);
+    QVERIFY2(report[0].startsWith(QStringLiteral("ATTITUDE(%1): dispatched 2 ").arg(MAVLINK_MSG_ID_ATTITUDE)), qPrintable(report[0]));
+    QVERIFY2(report[1].startsWith(QStringLiteral("    QObject: calls 2 ")), qPrintable(report[1]));
+    QVERIFY2(report[2].startsWith(QStringLiteral("    QObject: calls 2 ")), qPrintable(report[2]));
+    QVERIFY2(report[3].startsWith(QStringLiteral("HEARTBEAT(%1): dispatched 3 ").arg(MAVLINK_MSG_ID_HEARTBEAT)), qPrintable(report[3]));
+    QVERIFY2(report[4].startsWith(QStringLiteral("    QObject: calls 3 ")), qPrintable(report[4]));
+
+    // The sleeping handler accounts for at least 10ms in total
+    QRegularExpressionMatch match = QRegularExpression(QStringLiteral("total ([0-9.]+)ms")).match(report[0]);
+    QVERIFY(match.hasMatch());
+    QVERIFY(match.captured(1).toDouble() >= 10.0);
+
+    dispatcher.resetCosts();
+    QVERIFY(dispatcher.costReport().isEmpty());
+}
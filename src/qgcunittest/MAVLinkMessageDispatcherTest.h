@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "MAVLinkMessageDispatcher.h"
+
+/// Unit test for MAVLinkMessageDispatcher
+class MAVLinkMessageDispatcherTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _dispatch_test                 (void);
+    void _filter_test                   (void);
+    void _priority_test                 (void);
+    void _subscribeDuringDispatch_test  (void);
+    void _contextDestroyed_test         (void);
+    void _cost_test                     (void);
+
+private:
+    mavlink_message_t _message(uint32_t msgid, uint8_t sysid, uint8_t compid);
+
+    static const uint32_t _overflowMsgId = 12345;   ///< Outside of the dispatcher's direct table
+};
@@ -0,0 +1,281 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkParserWorkerTest.h"
+#include "LinkManager.h"
+#include "MockLink.h"
+#include "QGCApplication.h"
+
+#include <QElapsedTimer>
+
+/// Builds a stream of alternating HEARTBEAT and ATTITUDE messages. Messages are packed on the specified channel
+/// such that sequence numbers start at 0 and increment by one.
+///     @param dropEvery 0: no loss, otherwise skip every dropEvery message to simulate loss
+QByteArray MAVLinkParserWorkerTest::_buildStream(uint8_t channel, int messageCount, int dropEvery)
+{
+    QByteArray          stream;
+    mavlink_message_t   message;
+    uint8_t             buf[MAVLINK_MAX_PACKET_LEN];
+
+    for (int i=0; i<messageCount; i++) {
+        if (i & 1) {
+            mavlink_msg_attitude_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, channel, &message, static_cast<uint32_t>(i), 0.1f, 0.2f, 0.3f, 0, 0, 0);
+        } else {
+            mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, channel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+        }
+        if (dropEvery && (i % dropEvery) == 0) {
+            continue;
+        }
+        int len = mavlink_msg_to_send_buffer(buf, &message);
+        stream.append(reinterpret_cast<const char*>(buf), len);
+    }
+
+    return stream;
+}
+
+void MAVLinkParserWorkerTest::_decode_test(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    // Use a channel which is not in use by the real protocol so the parse state is not shared
+    int channel = _linkManager->_reserveMavlinkChannel();
+    QVERIFY(channel != 0);
+
+    LinkQualityTracker  linkQuality;
+    MAVLinkParserWorker worker(&linkQuality);
+    QSignalSpy          spyBatch(&worker, &MAVLinkParserWorker::messagesReceived);
+
+    worker.addLink(_mockLink, static_cast<uint8_t>(channel));
+    QCoreApplication::processEvents();
+
+    // Split the stream at an odd position to verify framing across chunks
+    QByteArray stream = _buildStream(static_cast<uint8_t>(channel), 10, 0);
+    worker.receiveBytes(_mockLink, stream.left(17));
+    worker.receiveBytes(_mockLink, stream.mid(17));
+
+    int messageCount = 0;
+    for (const QList<QVariant>& args: spyBatch) {
+        QCOMPARE(args[0].value<LinkInterface*>(), static_cast<LinkInterface*>(_mockLink));
+        messageCount += args[1].value<MAVLinkMessageBatch>().count();
+    }
+    QCOMPARE(messageCount, 10);
+    QCOMPARE(worker.messagesDecoded(), static_cast<quint64>(10));
+
+    _linkManager->_freeMavlinkChannel(channel);
+    _disconnectMockLink();
+}
+
+void MAVLinkParserWorkerTest::_lossStats_test(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    int channel = _linkManager->_reserveMavlinkChannel();
+    QVERIFY(channel != 0);
+
+    LinkQualityTracker  linkQuality;
+    MAVLinkParserWorker worker(&linkQuality);
+
+    worker.addLink(_mockLink, static_cast<uint8_t>(channel));
+    QCoreApplication::processEvents();
+
+    // Drop every 4th message, which leaves 96 received messages. The final dropped message has no received message
+    // after it so it is not counted as lost.
+    worker.receiveBytes(_mockLink, _buildStream(static_cast<uint8_t>(channel), 129, 4));
+
+    LinkQualityTracker::Stats_t stats = linkQuality.stats(channel);
+    QCOMPARE(stats.totalReceived, static_cast<quint64>(96));
+    QCOMPARE(stats.totalLost, static_cast<quint64>(31));
+    QCOMPARE(linkQuality.stats(channel, 1, MAV_COMP_ID_AUTOPILOT1).totalLost, static_cast<quint64>(31));
+
+    _linkManager->_freeMavlinkChannel(channel);
+    _disconnectMockLink();
+}
+
+void MAVLinkParserWorkerTest::_linkQuality_test(void)
+{
+    LinkQualityTracker          linkQuality;
+    QVector<mavlink_message_t>  messages;
+    mavlink_message_t           message;
+    const uint8_t               channel = 1;
+
+    // Two components interleaved on the same channel, each with its own sequence numbers. The autopilot wraps its
+    // sequence number and loses 2 messages across the wrap, the camera loses none.
+    uint8_t rgAutopilotSeq[] = { 250, 251, 252, 253, 254, 255, 2, 3 };
+    for (size_t i = 0; i < sizeof(rgAutopilotSeq); i++) {
+        mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, channel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+        message.seq = rgAutopilotSeq[i];
+        messages.append(message);
+        mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_CAMERA, channel, &message, MAV_TYPE_CAMERA, MAV_AUTOPILOT_INVALID, 0, 0, MAV_STATE_ACTIVE);
+        message.seq = static_cast<uint8_t>(10 + i);
+        messages.append(message);
+    }
+
+    LinkQualityTracker::Stats_t channelStats = linkQuality.update(channel, messages, linkQuality.timestampUSecs());
+    QCOMPARE(channelStats.totalReceived, static_cast<quint64>(16));
+    QCOMPARE(channelStats.totalLost, static_cast<quint64>(2));
+
+    LinkQualityTracker::Stats_t stats = linkQuality.stats(channel, 1, MAV_COMP_ID_AUTOPILOT1);
+    QCOMPARE(stats.totalReceived, static_cast<quint64>(8));
+    QCOMPARE(stats.totalLost, static_cast<quint64>(2));
+    QCOMPARE(stats.windowReceived, static_cast<quint32>(8));
+    QCOMPARE(stats.windowLossPercent, 20.0);
+
+    stats = linkQuality.stats(LinkQualityTracker::anyId, 1, MAV_COMP_ID_CAMERA);
+    QCOMPARE(stats.totalLost, static_cast<quint64>(0));
+
+    QCOMPARE(linkQuality.components(channel).count(), 2);
+    QCOMPARE(linkQuality.stats(LinkQualityTracker::anyId, 2).totalReceived, static_cast<quint64>(0));
+
+    linkQuality.resetChannel(channel);
+    QCOMPARE(linkQuality.stats().totalReceived, static_cast<quint64>(0));
+    QCOMPARE(linkQuality.components(channel).count(), 0);
+}
+
+void MAVLinkParserWorkerTest::_chunkJitter_test(void)
+{
+    LinkQualityTracker          linkQuality;
+    QVector<mavlink_message_t>  singleMessage;
+    QVector<mavlink_message_t>  manyMessages;
+    mavlink_message_t           message;
+    const uint8_t               singleChannel   = 1;
+    const uint8_t               manyChannel     = 2;
+    qint64                      startUSecs      = linkQuality.timestampUSecs();
+    uint8_t                     singleSeq       = 0;
+    uint8_t                     manySeq         = 0;
+
+    // The same chunk arrival times are fed on two channels, one with a single message per chunk and one with five.
+    // Since messages within a chunk share a timestamp they must not add to the jitter.
+    mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, singleChannel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    const qint64 rgIntervalUSecs[] = { 10000, 12000, 8000, 10000, 15000, 5000, 10000, 10000 };
+    qint64 timestampUSecs = startUSecs;
+    for (size_t i = 0; i < sizeof(rgIntervalUSecs) / sizeof(rgIntervalUSecs[0]); i++) {
+        singleMessage.clear();
+        message.seq = singleSeq++;
+        singleMessage.append(message);
+        linkQuality.update(singleChannel, singleMessage, timestampUSecs);
+
+        manyMessages.clear();
+        for (int j = 0; j < 5; j++) {
+            message.seq = manySeq++;
+            manyMessages.append(message);
+        }
+        linkQuality.update(manyChannel, manyMessages, timestampUSecs);
+
+        timestampUSecs += rgIntervalUSecs[i];
+    }
+
+    // Query once all chunk times are in the past
+    QTest::qSleep(static_cast<int>((timestampUSecs - startUSecs) / 1000) + 10);
+
+    LinkQualityTracker::Stats_t singleStats = linkQuality.stats(singleChannel);
+    LinkQualityTracker::Stats_t manyStats   = linkQuality.stats(manyChannel);
+    QCOMPARE(manyStats.totalReceived, singleStats.totalReceived * 5);
+    QCOMPARE(manyStats.totalLost, static_cast<quint64>(0));
+    QVERIFY(singleStats.jitterMSecs > 0);
+    QVERIFY(qAbs(manyStats.jitterMSecs - singleStats.jitterMSecs) < 1.0e-6);
+}
+
+void MAVLinkParserWorkerTest::_removedLink_test(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    int channel = _linkManager->_reserveMavlinkChannel();
+    QVERIFY(channel != 0);
+
+    LinkQualityTracker  linkQuality;
+    MAVLinkParserWorker worker(&linkQuality);
+    QSignalSpy          spyBatch(&worker, &MAVLinkParserWorker::messagesReceived);
+
+    worker.addLink(_mockLink, static_cast<uint8_t>(channel));
+    worker.removeLink(_mockLink);
+
+    // Data queued after the link is removed must be dropped
+    worker.receiveBytes(_mockLink, _buildStream(static_cast<uint8_t>(channel), 10, 0));
+    QCOMPARE(spyBatch.count(), 0);
+
+    _linkManager->_freeMavlinkChannel(channel);
+    _disconnectMockLink();
+}
+
+void MAVLinkParserWorkerTest::_mavlink2Switch_test(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    int channel = _linkManager->_reserveMavlinkChannel();
+    QVERIFY(channel != 0);
+
+    LinkQualityTracker  linkQuality;
+    MAVLinkParserWorker worker(&linkQuality);
+    QSignalSpy          spyMavlink2(&worker, &MAVLinkParserWorker::mavlink2Detected);
+
+    worker.addLink(_mockLink, static_cast<uint8_t>(channel));
+
+    // Pack the stream as mavlink 2.0, then put the channel back to outbound mavlink 1.0
+    mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(static_cast<uint8_t>(channel));
+    mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    QByteArray stream = _buildStream(static_cast<uint8_t>(channel), 4, 0);
+    mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    worker.setOutboundMavlink1(static_cast<uint8_t>(channel), true);
+    uint8_t flags = mavlinkStatus->flags;
+
+    // Only the first decoded packet is checked
+    worker.receiveBytes(_mockLink, stream);
+    worker.receiveBytes(_mockLink, stream);
+    QCOMPARE(spyMavlink2.count(), 1);
+    QCOMPARE(spyMavlink2[0][0].value<LinkInterface*>(), static_cast<LinkInterface*>(_mockLink));
+    QVERIFY(!worker.outboundMavlink1(static_cast<uint8_t>(channel)));
+
+    // Parsing must never touch the shared channel status, switching the flags is left to the main thread
+    QCOMPARE(mavlinkStatus->flags, flags);
+
+    _linkManager->_freeMavlinkChannel(channel);
+    _disconnectMockLink();
+}
+
+void MAVLinkParserWorkerTest::_throughput_test(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    int channel = _linkManager->_reserveMavlinkChannel();
+    QVERIFY(channel != 0);
+
+    LinkQualityTracker  linkQuality;
+    MAVLinkParserWorker worker(&linkQuality);
+    worker.addLink(_mockLink, static_cast<uint8_t>(channel));
+    QCoreApplication::processEvents();
+
+    // Feed the stream in UDP sized chunks, same as a link would
+    const int   cMessages   = 200000;
+    const int   cChunkSize  = 1400;
+    QByteArray  stream      = _buildStream(static_cast<uint8_t>(channel), cMessages, 0);
+
+    QSignalSpy spyBatch(&worker, &MAVLinkParserWorker::messagesReceived);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int position = 0; position < stream.size(); position += cChunkSize) {
+        worker.receiveBytes(_mockLink, stream.mid(position, cChunkSize));
+    }
+    qint64 elapsedNSecs = qMax(timer.nsecsElapsed(), static_cast<qint64>(1));
+    qint64 messagesPerSecond = static_cast<qint64>(cMessages * 1.0e9 / elapsedNSecs);
+
+    qCDebug(MAVLinkParserWorkerLog) << "MAVLinkParserWorker sustained" << messagesPerSecond << "messages/sec on a single core"
+                                    << "-" << static_cast<qint64>(stream.size() * 1.0e9 / elapsedNSecs / 1024) << "KB/sec";
+
+    // Every message is delivered, and at most one batch is signalled per chunk
+    QCOMPARE(worker.messagesDecoded(), static_cast<quint64>(cMessages));
+    QVERIFY(spyBatch.count() <= (stream.size() + cChunkSize - 1) / cChunkSize);
+
+    // A single worker must keep up with eight vehicles streaming at high rates (~1000 messages/sec each) with a
+    // wide margin. This is far below what a single core decodes, so it only catches gross regressions.
+    QVERIFY2(messagesPerSecond > _minMessagesPerSecond, qPrintable(QStringLiteral("%1 messages/sec").arg(messagesPerSecond)));
+
+    _linkManager->_freeMavlinkChannel(channel);
+    _disconnectMockLink();
+}
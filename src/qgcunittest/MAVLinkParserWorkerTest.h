@@ -0,0 +1,33 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "MAVLinkParserWorker.h"
+
+/// Unit test for MAVLinkParserWorker and LinkQualityTracker. Also checks decode throughput for a single worker thread.
+class MAVLinkParserWorkerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _decode_test(void);
+    void _lossStats_test(void);
+    void _linkQuality_test(void);
+    void _chunkJitter_test(void);
+    void _removedLink_test(void);
+    void _mavlink2Switch_test(void);
+    void _throughput_test(void);
+
+private:
+    QByteArray _buildStream(uint8_t channel, int messageCount, int dropEvery);
+
+    static const qint64 _minMessagesPerSecond = 50000;
+};
@@ -0,0 +1,214 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileMemoryCacheTest.h"
+#include "QGCTileCacheWorker.h"
+
+/// @return Tile hashes which are all stored in the same shard
+QStringList QGCTileMemoryCacheTest::_sameShardHashes(QGCTileMemoryCache& cache, int count)
+{
+    QStringList hashes;
+    for (int i = 0; hashes.count() < count; i++) {
+        QString hash = QStringLiteral("tile%1").arg(i);
+        if (hashes.isEmpty() || &cache._shard(hash) == &cache._shard(hashes.first())) {
+            hashes.append(hash);
+        }
+    }
+    return hashes;
+}
+
+void QGCTileMemoryCacheTest::_insert(QGCTileMemoryCache& cache, const QString& hash, int size)
+{
+    cache.insert(hash, QByteArray(size, hash.at(hash.length() - 1).toLatin1()), QStringLiteral("png"), QStringLiteral("type"));
+}
+
+bool QGCTileMemoryCacheTest::_contains(QGCTileMemoryCache& cache, const QString& hash)
+{
+    QByteArray  img;
+    QString     format;
+    QString     type;
+    return cache.find(hash, img, format, type);
+}
+
+/// Once a shard is over budget the least recently inserted tiles go first
+void QGCTileMemoryCacheTest::_evictionOrder_test(void)
+{
+    const int shardBudget   = _shardBudget;
+    const int tileSize      = _tileSize;
+
+    QGCTileMemoryCache cache;
+    cache.setMaxBytes(shardBudget * QGCTileMemoryCache::_shardCount);
+
+    QStringList hashes = _sameShardHashes(cache, 6);
+    for (int i = 0; i < 4; i++) {
+        _insert(cache, hashes[i], tileSize);
+    }
+    QCOMPARE(cache.stats().evictions, 0ull);
+    QCOMPARE(cache.stats().bytes, static_cast<quint64>(shardBudget));
+
+    _insert(cache, hashes[4], tileSize);
+    _insert(cache, hashes[5], tileSize);
+
+    QGCTileMemoryCache::Stats_t stats = cache.stats();
+    QCOMPARE(stats.evictions, 2ull);
+    QCOMPARE(stats.count, 4u);
+    QCOMPARE(stats.bytes, static_cast<quint64>(shardBudget));
+
+    QVERIFY(!_contains(cache, hashes[0]));
+    QVERIFY(!_contains(cache, hashes[1]));
+    for (int i = 2; i < 6; i++) {
+        QVERIFY(_contains(cache, hashes[i]));
+    }
+
+    // Shrinking the budget evicts immediately
+    cache.setMaxBytes(tileSize * QGCTileMemoryCache::_shardCount);
+    stats = cache.stats();
+    QCOMPARE(stats.count, 1u);
+    QCOMPARE(stats.evictions, 5ull);
+}
+
+/// Both a hit and a re-insert make a tile the most recently used one
+void QGCTileMemoryCacheTest::_refreshOnHit_test(void)
+{
+    const int shardBudget   = _shardBudget;
+    const int tileSize      = _tileSize;
+
+    QGCTileMemoryCache cache;
+    cache.setMaxBytes(shardBudget * QGCTileMemoryCache::_shardCount);
+
+    QStringList hashes = _sameShardHashes(cache, 6);
+    for (int i = 0; i < 4; i++) {
+        _insert(cache, hashes[i], tileSize);
+    }
+
+    // Oldest tile is hit, next oldest is re-inserted with a new image
+    QVERIFY(_contains(cache, hashes[0]));
+    cache.insert(hashes[1], QByteArray(tileSize, 'n'), QStringLiteral("jpg"), QStringLiteral("other"));
+    QCOMPARE(cache.stats().count, 4u);
+    QCOMPARE(cache.stats().bytes, static_cast<quint64>(shardBudget));
+
+    _insert(cache, hashes[4], tileSize);
+    _insert(cache, hashes[5], tileSize);
+
+    QVERIFY(!_contains(cache, hashes[2]));
+    QVERIFY(!_contains(cache, hashes[3]));
+    QVERIFY(_contains(cache, hashes[0]));
+
+    QByteArray  img;
+    QString     format;
+    QString     type;
+    QVERIFY(cache.find(hashes[1], img, format, type));
+    QCOMPARE(img, QByteArray(tileSize, 'n'));
+    QCOMPARE(format, QStringLiteral("jpg"));
+    QCOMPARE(type, QStringLiteral("other"));
+}
+
+/// Tiles which don't fit in a shard, and empty tiles, are never cached and don't push anything out
+void QGCTileMemoryCacheTest::_oversizeTile_test(void)
+{
+    const int shardBudget   = _shardBudget;
+    const int tileSize      = _tileSize;
+
+    QGCTileMemoryCache cache;
+    cache.setMaxBytes(shardBudget * QGCTileMemoryCache::_shardCount);
+
+    QStringList hashes = _sameShardHashes(cache, 3);
+    _insert(cache, hashes[0], tileSize);
+    _insert(cache, hashes[1], shardBudget + 1);
+    _insert(cache, hashes[2], 0);
+
+    QGCTileMemoryCache::Stats_t stats = cache.stats();
+    QCOMPARE(stats.insertions, 1ull);
+    QCOMPARE(stats.evictions, 0ull);
+    QCOMPARE(stats.count, 1u);
+    QCOMPARE(stats.bytes, static_cast<quint64>(tileSize));
+
+    QVERIFY(_contains(cache, hashes[0]));
+    QVERIFY(!_contains(cache, hashes[1]));
+    QVERIFY(!_contains(cache, hashes[2]));
+
+    // A tile exactly the size of the shard budget still fits, replacing everything else
+    _insert(cache, hashes[1], shardBudget);
+    QVERIFY(_contains(cache, hashes[1]));
+    QVERIFY(!_contains(cache, hashes[0]));
+}
+
+/// clear() empties every shard but leaves the counters alone
+void QGCTileMemoryCacheTest::_clear_test(void)
+{
+    const int tileSize = _tileSize;
+
+    QGCTileMemoryCache cache;
+
+    const int cTiles = 100;
+    for (int i = 0; i < cTiles; i++) {
+        _insert(cache, QStringLiteral("tile%1").arg(i), tileSize);
+    }
+    QCOMPARE(cache.stats().count, static_cast<quint32>(cTiles));
+
+    cache.clear();
+
+    QGCTileMemoryCache::Stats_t stats = cache.stats();
+    QCOMPARE(stats.count, 0u);
+    QCOMPARE(stats.bytes, 0ull);
+    QCOMPARE(stats.insertions, static_cast<quint64>(cTiles));
+    QCOMPARE(stats.evictions, 0ull);
+    for (int i = 0; i < cTiles; i++) {
+        QVERIFY(!_contains(cache, QStringLiteral("tile%1").arg(i)));
+    }
+
+    // Cache is usable again after a clear
+    _insert(cache, QStringLiteral("tile0"), tileSize);
+    QVERIFY(_contains(cache, QStringLiteral("tile0")));
+}
+
+/// Hit, miss, insertion and eviction counters add up across shards and are reset by resetStats()
+void QGCTileMemoryCacheTest::_stats_test(void)
+{
+    const int shardBudget   = _shardBudget;
+    const int tileSize      = _tileSize;
+
+    QGCTileMemoryCache cache;
+    cache.setMaxBytes(shardBudget * QGCTileMemoryCache::_shardCount);
+
+    // Spread over all shards, well under budget
+    const int cTiles = 16;
+    for (int i = 0; i < cTiles; i++) {
+        _insert(cache, QStringLiteral("spread%1").arg(i), 1);
+    }
+    for (int i = 0; i < cTiles; i++) {
+        QVERIFY(_contains(cache, QStringLiteral("spread%1").arg(i)));
+    }
+    for (int i = 0; i < 3; i++) {
+        QVERIFY(!_contains(cache, QStringLiteral("missing%1").arg(i)));
+    }
+
+    // Overfill a single shard by two tiles
+    QStringList hashes = _sameShardHashes(cache, 6);
+    for (const QString& hash: hashes) {
+        _insert(cache, hash, tileSize);
+    }
+
+    QGCTileMemoryCache::Stats_t stats = cache.stats();
+    qCDebug(QGCTileCacheLog) << "hits" << stats.hits << "misses" << stats.misses << "insertions" << stats.insertions
+                             << "evictions" << stats.evictions << "bytes" << stats.bytes << "count" << stats.count;
+    QCOMPARE(stats.hits, static_cast<quint64>(cTiles));
+    QCOMPARE(stats.misses, 3ull);
+    QCOMPARE(stats.insertions, static_cast<quint64>(cTiles + hashes.count()));
+    QVERIFY(stats.evictions >= 2);
+    QCOMPARE(stats.count, static_cast<quint32>(cTiles + hashes.count() - stats.evictions));
+
+    cache.resetStats();
+    stats = cache.stats();
+    QCOMPARE(stats.hits, 0ull);
+    QCOMPARE(stats.misses, 0ull);
+    QCOMPARE(stats.insertions, 0ull);
+    QCOMPARE(stats.evictions, 0ull);
+    QVERIFY(stats.count > 0);
+}
@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCTileMemoryCache.h"
+
+/// Unit test for the QGCTileMemoryCache sharded LRU. Eviction is per shard, so LRU ordering is checked with tile
+/// hashes which all land in the same shard.
+class QGCTileMemoryCacheTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _evictionOrder_test(void);
+    void _refreshOnHit_test(void);
+    void _oversizeTile_test(void);
+    void _clear_test(void);
+    void _stats_test(void);
+
+private:
+    QStringList _sameShardHashes(QGCTileMemoryCache& cache, int count);
+    void        _insert         (QGCTileMemoryCache& cache, const QString& hash, int size);
+    bool        _contains       (QGCTileMemoryCache& cache, const QString& hash);
+
+    static const int _shardBudget   = 1000;                 ///< Bytes per shard
+    static const int _tileSize      = _shardBudget / 4;     ///< Four tiles fill a shard exactly
+};
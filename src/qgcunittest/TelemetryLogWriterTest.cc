@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryLogWriterTest.h"
+#include "QGCTemporaryFile.h"
+
+#include <QtEndian>
+
+/// @return Unique file name for a log, the file itself is created by the writer
+QString TelemetryLogWriterTest::_tempLogFileName(void)
+{
+    QGCTemporaryFile tempFile(QStringLiteral("TelemetryLogWriterTestXXXXXX.tlog"));
+    if (!tempFile.open()) {
+        return QString();
+    }
+    tempFile.close();
+    return tempFile.fileName();
+}
+
+/// @return Record as it should appear in the tlog: big endian timestamp followed by the data
+QByteArray TelemetryLogWriterTest::_record(quint64 timestampUSecs, const QByteArray& data)
+{
+    uint8_t timestamp[sizeof(quint64)];
+    qToBigEndian(timestampUSecs, timestamp);
+
+    QByteArray record(reinterpret_cast<const char*>(timestamp), sizeof(timestamp));
+    record.append(data);
+    return record;
+}
+
+QByteArray TelemetryLogWriterTest::_readLog(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+/// Pushes many times the ring size through the queue with record sizes that don't divide the ring, so records are
+/// split across the end of the ring. Full queue is handled by backing off and retrying.
+void TelemetryLogWriterTest::_wraparound_test(void)
+{
+    const int ringSizeBytes = _ringSizeBytes;
+
+    QString fileName = _tempLogFileName();
+    QVERIFY(!fileName.isEmpty());
+
+    TelemetryLogWriter writer(nullptr, ringSizeBytes);
+    QVERIFY(writer.startLogging(fileName));
+    QVERIFY(writer.isLogging());
+
+    QByteArray  expected;
+    quint64     dropCount = 0;
+    for (int i=0; i<500; i++) {
+        QByteArray data(37, static_cast<char>(i));
+        int retries = 0;
+        while (!writer.logRecord(static_cast<quint64>(i), data.constData(), data.count())) {
+            dropCount++;
+            QVERIFY(++retries < 1000);
+            QThread::msleep(1);
+        }
+        expected.append(_record(static_cast<quint64>(i), data));
+    }
+
+    writer.stopLogging();
+    QVERIFY(!writer.isLogging());
+    QCOMPARE(writer.droppedRecords(), dropCount);
+    QCOMPARE(writer.bytesWritten(), static_cast<quint64>(expected.count()));
+    QVERIFY(writer.bytesWritten() > static_cast<quint64>(10 * ringSizeBytes));
+    QCOMPARE(_readLog(fileName), expected);
+
+    QFile::remove(fileName);
+}
+
+/// Records which don't fit are dropped and counted, everything which was accepted is written in order
+void TelemetryLogWriterTest::_dropWhenFull_test(void)
+{
+    const int ringSizeBytes = _ringSizeBytes;
+
+    QString fileName = _tempLogFileName();
+    QVERIFY(!fileName.isEmpty());
+
+    TelemetryLogWriter writer(nullptr, ringSizeBytes);
+    QVERIFY(writer.startLogging(fileName));
+
+    // A record larger than the ring can never fit
+    QByteArray oversize(ringSizeBytes, 'x');
+    QVERIFY(!writer.logRecord(0, oversize.constData(), oversize.count()));
+    QCOMPARE(writer.droppedRecords(), static_cast<quint64>(1));
+
+    // Burst without giving the writer a chance to keep up
+    QByteArray  expected;
+    quint64     dropCount = 1;
+    for (int i=0; i<64; i++) {
+        QByteArray data(100, static_cast<char>(i));
+        if (writer.logRecord(static_cast<quint64>(i), data.constData(), data.count())) {
+            expected.append(_record(static_cast<quint64>(i), data));
+        } else {
+            dropCount++;
+        }
+    }
+
+    writer.stopLogging();
+    QCOMPARE(writer.droppedRecords(), dropCount);
+    QCOMPARE(_readLog(fileName), expected);
+
+    // Nothing is queued once logging has stopped
+    QVERIFY(!writer.logRecord(0, oversize.constData(), 1));
+
+    QFile::remove(fileName);
+}
+
+/// stopLogging must not return until everything queued is in the file and the file is closed
+void TelemetryLogWriterTest::_flushOnStop_test(void)
+{
+    QString fileName = _tempLogFileName();
+    QVERIFY(!fileName.isEmpty());
+
+    // Default ring size so nothing is dropped
+    TelemetryLogWriter writer;
+    QVERIFY(writer.startLogging(fileName));
+
+    QByteArray expected;
+    for (int i=0; i<1000; i++) {
+        QByteArray data = QByteArray::number(i);
+        QVERIFY(writer.logRecord(static_cast<quint64>(i), data.constData(), data.count()));
+        expected.append(_record(static_cast<quint64>(i), data));
+    }
+
+    // Stop well before the commit interval has passed
+    writer.stopLogging();
+    QCOMPARE(writer.bytesQueued(), static_cast<quint64>(0));
+    QCOMPARE(writer.droppedRecords(), static_cast<quint64>(0));
+    QCOMPARE(_readLog(fileName), expected);
+
+    // The writer can be restarted on a new file, which starts out empty
+    QString secondFileName = _tempLogFileName();
+    QVERIFY(writer.startLogging(secondFileName));
+    QByteArray data("second");
+    QVERIFY(writer.logRecord(1, data.constData(), data.count()));
+    writer.stopLogging();
+    QCOMPARE(_readLog(secondFileName), _record(1, data));
+    QCOMPARE(_readLog(fileName), expected);
+
+    QFile::remove(fileName);
+    QFile::remove(secondFileName);
+}
@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "TelemetryLogWriter.h"
+
+/// Unit test for the TelemetryLogWriter record queue. Uses a small ring so records wrap and the queue fills quickly.
+class TelemetryLogWriterTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _wraparound_test(void);
+    void _dropWhenFull_test(void);
+    void _flushOnStop_test(void);
+
+private:
+    QString     _tempLogFileName(void);
+    QByteArray  _record         (quint64 timestampUSecs, const QByteArray& data);
+    QByteArray  _readLog        (const QString& fileName);
+
+    static const int _ringSizeBytes = 1024;
+};
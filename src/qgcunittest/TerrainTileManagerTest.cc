@@ -0,0 +1,340 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileManagerTest.h"
+#include "ElevationMapProvider.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QPoint>
+
+/// Pretends all download slots are busy so queued tiles stay in the download queue until the test completes them
+void TerrainTileManagerTest::_holdDownloads(TerrainTileManager& manager)
+{
+    manager._activeDownloads = TerrainTileManager::_maxConcurrentDownloads;
+}
+
+/// @return Keys of the tiles waiting for a download slot, in order
+QList<quint64> TerrainTileManagerTest::_queuedDownloads(TerrainTileManager& manager)
+{
+    QList<quint64> keys;
+    for (const TerrainTileManager::TileDownload_t& tileDownload: manager._tileDownloadQueue) {
+        keys.append(tileDownload.key);
+    }
+    return keys;
+}
+
+/// Every tile has a single elevation, so a height tells which tile it was sampled from
+double TerrainTileManagerTest::_tileElevation(int x, int y)
+{
+    return (x - _baseTileX) * 100 + (y - _baseTileY) + 10;
+}
+
+QGeoCoordinate TerrainTileManagerTest::_tileCenter(int x, int y)
+{
+    return QGeoCoordinate((y + 0.5) * srtm1TileSize - 90.0, (x + 0.5) * srtm1TileSize - 180.0);
+}
+
+/// Takes the tile out of the download queue as if it had been downloaded, then hands the result to the manager
+void TerrainTileManagerTest::_completeDownload(TerrainTileManager& manager, int x, int y, QNetworkReply::NetworkError error)
+{
+    quint64 key = TerrainTileManager::_tileKey(x, y);
+    for (int i = 0; i < manager._tileDownloadQueue.count(); i++) {
+        if (manager._tileDownloadQueue[i].key == key) {
+            manager._tileDownloadQueue.removeAt(i);
+            break;
+        }
+    }
+
+    QByteArray responseBytes;
+    if (error == QNetworkReply::NoError) {
+        const int   gridSize    = 3;
+        double      elevation   = _tileElevation(x, y);
+
+        QJsonArray carpet;
+        for (int row = 0; row < gridSize; row++) {
+            QJsonArray rowArray;
+            for (int col = 0; col < gridSize; col++) {
+                rowArray.append(elevation);
+            }
+            carpet.append(rowArray);
+        }
+
+        QJsonObject bounds;
+        bounds["sw"] = QJsonArray({ y * srtm1TileSize - 90.0, x * srtm1TileSize - 180.0 });
+        bounds["ne"] = QJsonArray({ (y + 1) * srtm1TileSize - 90.0, (x + 1) * srtm1TileSize - 180.0 });
+
+        QJsonObject stats;
+        stats["min"] = elevation;
+        stats["max"] = elevation;
+        stats["avg"] = elevation;
+
+        QJsonObject data;
+        data["bounds"] = bounds;
+        data["stats"]  = stats;
+        data["carpet"] = carpet;
+
+        QJsonObject root;
+        root["status"]  = "success";
+        root["data"]    = data;
+
+        responseBytes = TerrainTile::serialize(QJsonDocument(root).toJson());
+    }
+
+    // Keeps the download slots full so completing a tile never starts a real download
+    manager._activeDownloads++;
+    manager._tileDownloadDone(key, responseBytes, error);
+}
+
+void TerrainTileManagerTest::_connectCoordinateResult(TerrainOfflineAirMapQuery& query, CoordinateResult_t& result)
+{
+    connect(&query, &TerrainQueryInterface::coordinateHeightsReceived, this, [&result](bool success, QList<double> heights) {
+        result.signalCount++;
+        result.success = success;
+        result.heights = heights;
+    });
+}
+
+void TerrainTileManagerTest::_connectPolyPathResult(TerrainOfflineAirMapQuery& query, PolyPathResult_t& result)
+{
+    connect(&query, &TerrainOfflineAirMapQuery::polyPathHeightsReceived, this, [&result](bool success, const QList<TerrainQueryInterface::PathHeightInfo_t>& rgPathHeightInfo) {
+        result.signalCount++;
+        result.success          = success;
+        result.rgPathHeightInfo = rgPathHeightInfo;
+    });
+}
+
+/// Requests which share a tile wait on a single download of it, and each is signalled once all of its own tiles are in
+void TerrainTileManagerTest::_sharedPendingTile_test(void)
+{
+    const int x1 = _baseTileX;
+    const int y1 = _baseTileY;
+    const int x2 = _baseTileX + 1;
+    const int y2 = _baseTileY;
+    const int maxConcurrentDownloads = TerrainTileManager::_maxConcurrentDownloads;
+
+    TerrainTileManager manager;
+    _holdDownloads(manager);
+
+    TerrainOfflineAirMapQuery   queryA;
+    TerrainOfflineAirMapQuery   queryB;
+    CoordinateResult_t          resultA;
+    CoordinateResult_t          resultB;
+    _connectCoordinateResult(queryA, resultA);
+    _connectCoordinateResult(queryB, resultB);
+
+    manager.addCoordinateQuery(&queryA, { _tileCenter(x1, y1) });
+    manager.addCoordinateQuery(&queryB, { _tileCenter(x2, y2), _tileCenter(x1, y1) });
+
+    const quint64 key1 = TerrainTileManager::_tileKey(x1, y1);
+    const quint64 key2 = TerrainTileManager::_tileKey(x2, y2);
+    QCOMPARE(_queuedDownloads(manager), QList<quint64>({ key1, key2 }));
+    QCOMPARE(manager._pendingTiles, QSet<quint64>({ key1, key2 }));
+    QCOMPARE(manager._requestQueue.count(), 2);
+    QCOMPARE(resultA.signalCount, 0);
+    QCOMPARE(resultB.signalCount, 0);
+
+    // First tile completes the request which only needs that one
+    _completeDownload(manager, x1, y1);
+    QCOMPARE(resultA.signalCount, 1);
+    QVERIFY(resultA.success);
+    QCOMPARE(resultA.heights, QList<double>({ _tileElevation(x1, y1) }));
+    QCOMPARE(resultB.signalCount, 0);
+    QCOMPARE(manager._requestQueue.count(), 1);
+    QCOMPARE(manager._requestQueue[0].missingTiles, QSet<quint64>({ key2 }));
+
+    // A new request on a downloaded tile is answered right away
+    CoordinateResult_t resultC;
+    TerrainOfflineAirMapQuery queryC;
+    _connectCoordinateResult(queryC, resultC);
+    manager.addCoordinateQuery(&queryC, { _tileCenter(x1, y1) });
+    QCOMPARE(resultC.signalCount, 1);
+    QCOMPARE(manager._requestQueue.count(), 1);
+
+    _completeDownload(manager, x2, y2);
+    QCOMPARE(resultB.signalCount, 1);
+    QVERIFY(resultB.success);
+    QCOMPARE(resultB.heights, QList<double>({ _tileElevation(x2, y2), _tileElevation(x1, y1) }));
+    QCOMPARE(resultA.signalCount, 1);
+
+    QVERIFY(manager._requestQueue.isEmpty());
+    QVERIFY(manager._pendingTiles.isEmpty());
+    QVERIFY(manager._tileDownloadQueue.isEmpty());
+    QCOMPARE(manager._activeDownloads, maxConcurrentDownloads);
+}
+
+/// A failed tile fails every request waiting on it, leaves the other requests queued and is downloaded again on the next request
+void TerrainTileManagerTest::_tileFailed_test(void)
+{
+    const int x1 = _baseTileX;
+    const int y1 = _baseTileY;
+    const int x2 = _baseTileX;
+    const int y2 = _baseTileY + 1;
+
+    TerrainTileManager manager;
+    _holdDownloads(manager);
+
+    TerrainOfflineAirMapQuery   queryA;
+    TerrainOfflineAirMapQuery   queryB;
+    TerrainOfflineAirMapQuery   queryC;
+    CoordinateResult_t          resultA;
+    CoordinateResult_t          resultB;
+    CoordinateResult_t          resultC;
+    _connectCoordinateResult(queryA, resultA);
+    _connectCoordinateResult(queryB, resultB);
+    _connectCoordinateResult(queryC, resultC);
+
+    int     pathSignalCount = 0;
+    bool    pathSuccess     = true;
+    connect(&queryA, &TerrainQueryInterface::pathHeightsReceived, this, [&](bool success, double, double, const QList<double>&) {
+        pathSignalCount++;
+        pathSuccess = success;
+    });
+
+    manager.addCoordinateQuery(&queryA, { _tileCenter(x1, y1) });
+    manager.addPathQuery(&queryA, _tileCenter(x1, y1), _tileCenter(x2, y2));
+    manager.addCoordinateQuery(&queryB, { _tileCenter(x2, y2) });
+    manager.addCoordinateQuery(&queryC, { _tileCenter(x1, y1), _tileCenter(x2, y2) });
+    QCOMPARE(manager._requestQueue.count(), 4);
+    QCOMPARE(_queuedDownloads(manager).count(), 2);
+
+    _completeDownload(manager, x1, y1, QNetworkReply::ContentNotFoundError);
+
+    QCOMPARE(resultA.signalCount, 1);
+    QVERIFY(!resultA.success);
+    QCOMPARE(pathSignalCount, 1);
+    QVERIFY(!pathSuccess);
+    QCOMPARE(resultC.signalCount, 1);
+    QVERIFY(!resultC.success);
+    QCOMPARE(resultB.signalCount, 0);
+    QCOMPARE(manager._requestQueue.count(), 1);
+    QVERIFY(!manager._pendingTiles.contains(TerrainTileManager::_tileKey(x1, y1)));
+
+    // The failed tile is not cached, asking for it again queues a new download
+    manager.addCoordinateQuery(&queryA, { _tileCenter(x1, y1) });
+    QCOMPARE(_queuedDownloads(manager), QList<quint64>({ TerrainTileManager::_tileKey(x2, y2), TerrainTileManager::_tileKey(x1, y1) }));
+
+    _completeDownload(manager, x2, y2);
+    QCOMPARE(resultB.signalCount, 1);
+    QVERIFY(resultB.success);
+    QCOMPARE(resultB.heights, QList<double>({ _tileElevation(x2, y2) }));
+
+    _completeDownload(manager, x1, y1);
+    QCOMPARE(resultA.signalCount, 2);
+    QVERIFY(resultA.success);
+    QCOMPARE(resultC.signalCount, 1);
+    QVERIFY(manager._requestQueue.isEmpty());
+}
+
+/// Path samples are grouped by tile, a leg which crosses tile edges must take each height from the tile the sample is in
+void TerrainTileManagerTest::_polyPathTileEdges_test(void)
+{
+    TerrainTileManager manager;
+    _holdDownloads(manager);
+
+    TerrainOfflineAirMapQuery   query;
+    PolyPathResult_t            result;
+    _connectPolyPathResult(query, result);
+
+    // East across three tiles, then north into a fourth
+    QList<QGeoCoordinate> polyPath = {
+        _tileCenter(_baseTileX,     _baseTileY),
+        _tileCenter(_baseTileX + 2, _baseTileY),
+        _tileCenter(_baseTileX + 2, _baseTileY + 1),
+    };
+    manager.addPolyPathQuery(&query, polyPath);
+
+    QList<QPoint> rgTiles = { { _baseTileX, _baseTileY }, { _baseTileX + 1, _baseTileY }, { _baseTileX + 2, _baseTileY }, { _baseTileX + 2, _baseTileY + 1 } };
+    QList<quint64> rgKeys;
+    for (const QPoint& tile: rgTiles) {
+        rgKeys.append(TerrainTileManager::_tileKey(tile.x(), tile.y()));
+    }
+    QCOMPARE(_queuedDownloads(manager), rgKeys);
+
+    for (const QPoint& tile: rgTiles) {
+        QCOMPARE(result.signalCount, 0);
+        _completeDownload(manager, tile.x(), tile.y());
+    }
+    QCOMPARE(result.signalCount, 1);
+    QVERIFY(result.success);
+    QCOMPARE(result.rgPathHeightInfo.count(), polyPath.count() - 1);
+
+    for (int leg = 0; leg < polyPath.count() - 1; leg++) {
+        const QGeoCoordinate&   startPoint      = polyPath[leg];
+        const QGeoCoordinate&   endPoint        = polyPath[leg + 1];
+        const QList<double>&    heights         = result.rgPathHeightInfo[leg].heights;
+        double                  steps           = ceil(endPoint.distanceTo(startPoint) / TerrainTile::terrainAltitudeSpacing);
+        int                     tileChanges     = 0;
+
+        QCOMPARE(heights.count(), static_cast<int>(steps) + 1);
+        for (int i = 0; i < heights.count(); i++) {
+            QGeoCoordinate sample = i == heights.count() - 1 ? endPoint :
+                                                               QGeoCoordinate(startPoint.latitude() + (endPoint.latitude() - startPoint.latitude()) * i / steps,
+                                                                              startPoint.longitude() + (endPoint.longitude() - startPoint.longitude()) * i / steps);
+            double expected = _tileElevation(AirmapElevationProvider::tileX(sample.longitude()), AirmapElevationProvider::tileY(sample.latitude()));
+            QCOMPARE(heights[i], expected);
+            if (i > 0 && heights[i] != heights[i - 1]) {
+                tileChanges++;
+            }
+        }
+        QCOMPARE(tileChanges, leg == 0 ? 2 : 1);
+    }
+}
+
+/// A queued request is only resolved once the last of its tiles arrives. If a tile it needs went missing in the meantime
+/// the request goes back on the queue and the tile is downloaded again.
+void TerrainTileManagerTest::_requeueOnLastTile_test(void)
+{
+    const int x1 = _baseTileX;
+    const int y1 = _baseTileY;
+    const int x2 = _baseTileX + 1;
+    const int y2 = _baseTileY;
+    const int x3 = _baseTileX + 2;
+    const int y3 = _baseTileY;
+
+    const quint64 key1 = TerrainTileManager::_tileKey(x1, y1);
+    const quint64 key2 = TerrainTileManager::_tileKey(x2, y2);
+    const quint64 key3 = TerrainTileManager::_tileKey(x3, y3);
+
+    TerrainTileManager manager;
+    _holdDownloads(manager);
+
+    TerrainOfflineAirMapQuery   query;
+    PolyPathResult_t            result;
+    _connectPolyPathResult(query, result);
+
+    manager.addPolyPathQuery(&query, { _tileCenter(x1, y1), _tileCenter(x3, y3) });
+    QCOMPARE(manager._requestQueue.count(), 1);
+    QCOMPARE(manager._requestQueue[0].missingTiles, QSet<quint64>({ key1, key2, key3 }));
+
+    // Tiles arrive out of order, the request only waits on what is still missing
+    _completeDownload(manager, x3, y3);
+    QCOMPARE(manager._requestQueue[0].missingTiles, QSet<quint64>({ key1, key2 }));
+    _completeDownload(manager, x1, y1);
+    QCOMPARE(manager._requestQueue[0].missingTiles, QSet<quint64>({ key2 }));
+    QCOMPARE(result.signalCount, 0);
+
+    // Drop a tile which already arrived, re-evaluating on the last tile must notice and download it again
+    manager._tiles.remove(key1);
+    _completeDownload(manager, x2, y2);
+    QCOMPARE(result.signalCount, 0);
+    QCOMPARE(manager._requestQueue.count(), 1);
+    QCOMPARE(manager._requestQueue[0].missingTiles, QSet<quint64>({ key1 }));
+    QCOMPARE(_queuedDownloads(manager), QList<quint64>({ key1 }));
+
+    _completeDownload(manager, x1, y1);
+    QCOMPARE(result.signalCount, 1);
+    QVERIFY(result.success);
+    QCOMPARE(result.rgPathHeightInfo.count(), 1);
+    QCOMPARE(result.rgPathHeightInfo[0].heights.first(), _tileElevation(x1, y1));
+    QCOMPARE(result.rgPathHeightInfo[0].heights.last(), _tileElevation(x3, y3));
+    QVERIFY(result.rgPathHeightInfo[0].heights.contains(_tileElevation(x2, y2)));
+    QVERIFY(manager._requestQueue.isEmpty());
+}
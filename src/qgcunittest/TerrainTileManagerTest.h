@@ -0,0 +1,50 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "TerrainQuery.h"
+
+/// Unit test for the TerrainTileManager request queue. Tile downloads are never started, the test hands the manager
+/// the tiles itself so it controls the order in which they arrive.
+class TerrainTileManagerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _sharedPendingTile_test(void);
+    void _tileFailed_test(void);
+    void _polyPathTileEdges_test(void);
+    void _requeueOnLastTile_test(void);
+
+private:
+    typedef struct {
+        int             signalCount = 0;
+        bool            success     = false;
+        QList<double>   heights;
+    } CoordinateResult_t;
+
+    typedef struct {
+        int                                             signalCount = 0;
+        bool                                            success     = false;
+        QList<TerrainQueryInterface::PathHeightInfo_t>  rgPathHeightInfo;
+    } PolyPathResult_t;
+
+    void            _holdDownloads      (TerrainTileManager& manager);
+    void            _completeDownload   (TerrainTileManager& manager, int x, int y, QNetworkReply::NetworkError error = QNetworkReply::NoError);
+    QList<quint64>  _queuedDownloads    (TerrainTileManager& manager);
+    QGeoCoordinate  _tileCenter         (int x, int y);
+    double          _tileElevation      (int x, int y);
+    void            _connectCoordinateResult(TerrainOfflineAirMapQuery& query, CoordinateResult_t& result);
+    void            _connectPolyPathResult  (TerrainOfflineAirMapQuery& query, PolyPathResult_t& result);
+
+    static const int _baseTileX = 18800;
+    static const int _baseTileY = 13700;
+};
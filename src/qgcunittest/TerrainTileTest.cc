@@ -0,0 +1,141 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileTest.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+const double TerrainTileTest::_swLat    = 47.0;
+const double TerrainTileTest::_swLon    = 8.0;
+const double TerrainTileTest::_spacing  = 0.001;
+
+/// Creates a square tile where the elevation at each grid point is row * gridSize + column
+TerrainTile TerrainTileTest::_createTile(int gridSize)
+{
+    QJsonArray carpet;
+    for (int row = 0; row < gridSize; row++) {
+        QJsonArray rowArray;
+        for (int col = 0; col < gridSize; col++) {
+            rowArray.append(row * gridSize + col);
+        }
+        carpet.append(rowArray);
+    }
+
+    double      extent = _spacing * (gridSize - 1);
+    QJsonObject bounds;
+    bounds["sw"] = QJsonArray({ _swLat, _swLon });
+    bounds["ne"] = QJsonArray({ _swLat + extent, _swLon + extent });
+
+    QJsonObject stats;
+    stats["min"] = 0;
+    stats["max"] = gridSize * gridSize - 1;
+    stats["avg"] = (gridSize * gridSize - 1) / 2.0;
+
+    QJsonObject data;
+    data["bounds"] = bounds;
+    data["stats"]  = stats;
+    data["carpet"] = carpet;
+
+    QJsonObject root;
+    root["status"]  = "success";
+    root["data"]    = data;
+
+    return TerrainTile(TerrainTile::serialize(QJsonDocument(root).toJson()));
+}
+
+void TerrainTileTest::_sample_test(void)
+{
+    TerrainTile tile = _createTile(5);
+    QVERIFY(tile.isValid());
+
+    // Nearest lands on the closest grid point
+    QCOMPARE(tile.elevation(QGeoCoordinate(_swLat + 2 * _spacing, _swLon + 3 * _spacing)), 13.0);
+    QCOMPARE(tile.elevation(QGeoCoordinate(_swLat + 2.2 * _spacing, _swLon + 2.8 * _spacing)), 13.0);
+
+    // Bilinear blends the surrounding four points: 6, 7, 11, 12
+    double elevation = tile.elevation(QGeoCoordinate(_swLat + 1.5 * _spacing, _swLon + 1.5 * _spacing), TerrainTile::SampleBilinear);
+    QVERIFY(qAbs(elevation - 9.0) < 0.001);
+    elevation = tile.elevation(QGeoCoordinate(_swLat + 1.25 * _spacing, _swLon + 1.5 * _spacing), TerrainTile::SampleBilinear);
+    QVERIFY(qAbs(elevation - 7.75) < 0.001);
+
+    // Corners are still inside the tile
+    elevation = tile.elevation(QGeoCoordinate(_swLat + 4 * _spacing, _swLon + 4 * _spacing), TerrainTile::SampleBilinear);
+    QVERIFY(qAbs(elevation - 24.0) < 0.001);
+
+    // Outside the tile
+    QVERIFY(qIsNaN(tile.elevation(QGeoCoordinate(_swLat - _spacing, _swLon))));
+    QVERIFY(qIsNaN(tile.elevation(QGeoCoordinate(_swLat, _swLon + 5 * _spacing), TerrainTile::SampleBilinear)));
+
+    // NaN coordinates
+    const double    rgLatitudes[]   = { qQNaN(), _swLat, qQNaN() };
+    const double    rgLongitudes[]  = { _swLon, qQNaN(), qQNaN() };
+    double          rgElevations[3];
+    for (TerrainTile::SampleMode mode: { TerrainTile::SampleNearest, TerrainTile::SampleBilinear }) {
+        tile.elevations(rgLatitudes, rgLongitudes, rgElevations, 3, mode);
+        for (double nanElevation: rgElevations) {
+            QVERIFY(qIsNaN(nanElevation));
+        }
+    }
+}
+
+void TerrainTileTest::_batch_test(void)
+{
+    TerrainTile             tile = _createTile(5);
+    QList<QGeoCoordinate>   coordinates;
+
+    for (int i = 1; i < 40; i++) {
+        coordinates.append(QGeoCoordinate(_swLat + i * _spacing * 0.1, _swLon + (40 - i) * _spacing * 0.1));
+    }
+    coordinates.append(QGeoCoordinate(_swLat + 10 * _spacing, _swLon));
+
+    for (TerrainTile::SampleMode mode: { TerrainTile::SampleNearest, TerrainTile::SampleBilinear }) {
+        QVector<double> elevations = tile.elevations(coordinates, mode);
+        QCOMPARE(elevations.count(), coordinates.count());
+        for (int i = 0; i < coordinates.count() - 1; i++) {
+            QCOMPARE(elevations[i], tile.elevation(coordinates[i], mode));
+        }
+        QVERIFY(qIsNaN(elevations.last()));
+    }
+}
+
+void TerrainTileTest::_range_test(void)
+{
+    // Big enough for range queries to go up the min/max pyramid
+    const int   gridSize    = 40;
+    TerrainTile tile        = _createTile(gridSize);
+    double      minElevation;
+    double      maxElevation;
+
+    QVERIFY(tile.elevationRange(QGeoCoordinate(_swLat - 1, _swLon - 1), QGeoCoordinate(_swLat + 1, _swLon + 1), minElevation, maxElevation));
+    QCOMPARE(minElevation, 0.0);
+    QCOMPARE(maxElevation, static_cast<double>(gridSize * gridSize - 1));
+
+    // Bounds must always contain the exact range of the area
+    struct {
+        int row0, col0, row1, col1;
+    } rgAreas[] = {
+        { 0, 0, 0, 0 },
+        { 3, 5, 4, 6 },
+        { 10, 2, 30, 37 },
+        { 21, 21, 39, 39 },
+    };
+    for (const auto& area: rgAreas) {
+        QVERIFY(tile.elevationRange(QGeoCoordinate(_swLat + area.row0 * _spacing, _swLon + area.col0 * _spacing),
+                                    QGeoCoordinate(_swLat + area.row1 * _spacing, _swLon + area.col1 * _spacing),
+                                    minElevation, maxElevation));
+        QVERIFY(minElevation <= area.row0 * gridSize + area.col0);
+        QVERIFY(maxElevation >= area.row1 * gridSize + area.col1);
+        QVERIFY(minElevation >= 0 && maxElevation <= gridSize * gridSize - 1);
+    }
+
+    // No overlap
+    QVERIFY(!tile.elevationRange(QGeoCoordinate(_swLat + 1, _swLon + 1), QGeoCoordinate(_swLat + 2, _swLon + 2), minElevation, maxElevation));
+}
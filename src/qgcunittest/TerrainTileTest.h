@@ -0,0 +1,30 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "TerrainTile.h"
+
+class TerrainTileTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _sample_test       (void);
+    void _batch_test        (void);
+    void _range_test        (void);
+
+private:
+    TerrainTile _createTile(int gridSize);
+
+    static const double _swLat;
+    static const double _swLon;
+    static const double _spacing;
+};
@@ -0,0 +1,256 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogReaderTest.h"
+#include "TlogReader.h"
+#include "LinkManager.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include <limits>
+
+const quint64 TlogReaderTest::_startTimeUSecs = 1600000000000000ull;
+
+/// Writes a HEARTBEAT record for each tick. The offset and timestamp of each record written are added to
+/// _recordOffsets and _recordTimestamps.
+bool TlogReaderTest::_writeTestLog(const QString& logFilename, int firstTick, int tickCount, bool append)
+{
+    QFile logFile(logFilename);
+    if (!logFile.open(append ? (QFile::WriteOnly | QFile::Append) : QFile::WriteOnly)) {
+        return false;
+    }
+    if (!append) {
+        _recordOffsets.clear();
+        _recordTimestamps.clear();
+    }
+
+    int channel = _linkManager->_reserveMavlinkChannel();
+    if (channel == 0) {
+        return false;
+    }
+
+    mavlink_message_t   message;
+    uint8_t             buf[MAVLINK_MAX_PACKET_LEN];
+    uchar               timestamp[sizeof(quint64)];
+
+    for (int tick = firstTick; tick < firstTick + tickCount; tick++) {
+        quint64 timestampUSecs = _startTimeUSecs + static_cast<quint64>(tick) * _tickUSecs;
+
+        _recordOffsets.append(logFile.pos());
+        _recordTimestamps.append(timestampUSecs);
+
+        mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, static_cast<uint8_t>(channel), &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, static_cast<uint32_t>(tick), MAV_STATE_ACTIVE);
+        qToBigEndian<quint64>(timestampUSecs, timestamp);
+        logFile.write(reinterpret_cast<const char*>(timestamp), sizeof(timestamp));
+        int len = mavlink_msg_to_send_buffer(buf, &message);
+        logFile.write(reinterpret_cast<const char*>(buf), len);
+    }
+
+    _linkManager->_freeMavlinkChannel(channel);
+
+    return logFile.error() == QFile::NoError;
+}
+
+void TlogReaderTest::_buildIndex_test(void)
+{
+    const int logTicks = _logTicks;
+
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath("test.tlog");
+    QString         errorString;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(_writeTestLog(logFilename, 0, logTicks, false));
+
+    QString indexFilename = TlogReader::indexFilename(logFilename);
+    QFile::remove(indexFilename);
+
+    TlogReader reader;
+    QVERIFY2(reader.open(logFilename, errorString), qPrintable(errorString));
+    QCOMPARE(reader.startTimeUSecs(), _recordTimestamps.first());
+    QCOMPARE(reader.endTimeUSecs(), _recordTimestamps.last());
+
+    // One entry per second of log, each pointing at a record with the entry's timestamp
+    const QVector<TlogReader::IndexEntry_t> index = reader.index();
+    QCOMPARE(index.count(), 31);
+    for (int i = 0; i < index.count(); i++) {
+        TlogReader::Record_t    record;
+        qint64                  offset = index[i].offset;
+        QVERIFY(_recordOffsets.contains(index[i].offset));
+        QVERIFY(reader.readRecord(offset, record));
+        QCOMPARE(record.timestampUSecs, index[i].timestampUSecs);
+        if (i > 0) {
+            QVERIFY(index[i].offset > index[i - 1].offset);
+            QVERIFY(index[i].timestampUSecs > index[i - 1].timestampUSecs);
+        }
+    }
+
+    // Index is cached outside of the log directory
+    QVERIFY(QFile::exists(indexFilename));
+    QVERIFY(QFileInfo(indexFilename).absolutePath() != QFileInfo(logFilename).absolutePath());
+    QCOMPARE(QDir(tempDir.path()).entryList(QDir::Files), QStringList({ "test.tlog" }));
+
+    // Reopen loads the cached index, which must match what was built
+    reader.close();
+    QVERIFY2(reader.open(logFilename, errorString), qPrintable(errorString));
+    QCOMPARE(reader.index().count(), index.count());
+    for (int i = 0; i < index.count(); i++) {
+        QCOMPARE(reader.index()[i].offset,          index[i].offset);
+        QCOMPARE(reader.index()[i].timestampUSecs,  index[i].timestampUSecs);
+    }
+
+    reader.close();
+    QFile::remove(indexFilename);
+}
+
+void TlogReaderTest::_offsetForTimestamp_test(void)
+{
+    const int logTicks = _logTicks;
+
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath("test.tlog");
+    QString         errorString;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(_writeTestLog(logFilename, 0, logTicks, false));
+
+    TlogReader reader;
+    QVERIFY2(reader.open(logFilename, errorString), qPrintable(errorString));
+
+    // Before the start of the log is the first record, after the end is the end of the file
+    QCOMPARE(reader.offsetForTimestamp(0), _recordOffsets.first());
+    QCOMPARE(reader.offsetForTimestamp(_recordTimestamps.first() - 1), _recordOffsets.first());
+    QCOMPARE(reader.offsetForTimestamp(_recordTimestamps.last()), _recordOffsets.last());
+    QCOMPARE(reader.offsetForTimestamp(_recordTimestamps.last() + 1), reader.size());
+    QCOMPARE(reader.offsetForTimestamp(std::numeric_limits<quint64>::max()), reader.size());
+
+    // Exact timestamps land on their own record, anything in between on the following record
+    for (int i = 0; i < _recordOffsets.count(); i++) {
+        QCOMPARE(reader.offsetForTimestamp(_recordTimestamps[i]), _recordOffsets[i]);
+        if (i > 0) {
+            QCOMPARE(reader.offsetForTimestamp(_recordTimestamps[i] - _tickUSecs / 2), _recordOffsets[i]);
+        }
+    }
+
+    reader.close();
+    QFile::remove(TlogReader::indexFilename(logFilename));
+}
+
+/// A cached index for a log which has since changed must not be used
+void TlogReaderTest::_staleIndex_test(void)
+{
+    const int logTicks = _logTicks;
+
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath("test.tlog");
+    QString         errorString;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(_writeTestLog(logFilename, 0, logTicks, false));
+
+    TlogReader reader;
+    QVERIFY2(reader.open(logFilename, errorString), qPrintable(errorString));
+    QCOMPARE(reader.endTimeUSecs(), _recordTimestamps.last());
+    reader.close();
+
+    // Ten more seconds of log
+    QVERIFY(_writeTestLog(logFilename, logTicks, 100, true));
+
+    QVERIFY2(reader.open(logFilename, errorString), qPrintable(errorString));
+    QCOMPARE(reader.endTimeUSecs(), _recordTimestamps.last());
+    QCOMPARE(reader.index().count(), 41);
+    QCOMPARE(reader.offsetForTimestamp(_recordTimestamps.last()), _recordOffsets.last());
+
+    reader.close();
+    QFile::remove(TlogReader::indexFilename(logFilename));
+}
+
+/// A damaged index file is ignored and rebuilt
+void TlogReaderTest::_corruptIndex_test(void)
+{
+    const int logTicks = _logTicks;
+
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath("test.tlog");
+    QString         errorString;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(_writeTestLog(logFilename, 0, logTicks, false));
+
+    QString indexFilename = TlogReader::indexFilename(logFilename);
+
+    TlogReader reader;
+    QVERIFY2(reader.open(logFilename, errorString), qPrintable(errorString));
+    const QVector<TlogReader::IndexEntry_t> index = reader.index();
+    reader.close();
+
+    QFile indexFile(indexFilename);
+    QVERIFY(indexFile.open(QFile::ReadOnly));
+    QByteArray validIndex = indexFile.readAll();
+    indexFile.close();
+
+    // Valid header for the log followed by entries pointing outside of the log, then complete garbage
+    const int headerBytes = 4 + 4 + 8 + 8 + 8 + 8 + 4;
+    QVERIFY(validIndex.count() > headerBytes);
+    QByteArray badEntries = validIndex.left(headerBytes) + QByteArray(validIndex.count() - headerBytes, '\xff');
+    QByteArray garbage(validIndex.count(), '\x5a');
+
+    for (const QByteArray& corruptIndex: { badEntries, garbage }) {
+        QVERIFY(indexFile.open(QFile::WriteOnly | QFile::Truncate));
+        indexFile.write(corruptIndex);
+        indexFile.close();
+
+        QVERIFY2(reader.open(logFilename, errorString), qPrintable(errorString));
+        QCOMPARE(reader.index().count(), index.count());
+        for (int i = 0; i < index.count(); i++) {
+            QCOMPARE(reader.index()[i].offset,          index[i].offset);
+            QCOMPARE(reader.index()[i].timestampUSecs,  index[i].timestampUSecs);
+        }
+        QCOMPARE(reader.endTimeUSecs(), _recordTimestamps.last());
+        reader.close();
+    }
+
+    QFile::remove(indexFilename);
+}
+
+/// A log whose last record was cut off, as happens when the log was not closed cleanly
+void TlogReaderTest::_truncatedTail_test(void)
+{
+    const int logTicks = _logTicks;
+
+    QTemporaryDir   tempDir;
+    QString         logFilename = tempDir.filePath("test.tlog");
+    QString         errorString;
+    QVERIFY(tempDir.isValid());
+    QVERIFY(_writeTestLog(logFilename, 0, logTicks, false));
+
+    QFile logFile(logFilename);
+    QVERIFY(logFile.resize(logFile.size() - 5));
+
+    TlogReader reader;
+    QVERIFY2(reader.open(logFilename, errorString), qPrintable(errorString));
+    QCOMPARE(reader.endTimeUSecs(), _recordTimestamps[logTicks - 2]);
+
+    // Reading runs through every complete record and then ends at the end of the file
+    TlogReader::Record_t    record;
+    qint64                  offset      = 0;
+    int                     recordCount = 0;
+    while (reader.readRecord(offset, record)) {
+        QCOMPARE(record.timestampUSecs, _recordTimestamps[recordCount]);
+        recordCount++;
+    }
+    QCOMPARE(recordCount, logTicks - 1);
+    QCOMPARE(offset, reader.size());
+
+    // Seeking into the damaged tail is the end of the file
+    QCOMPARE(reader.offsetForTimestamp(_recordTimestamps.last()), reader.size());
+
+    reader.close();
+    QFile::remove(TlogReader::indexFilename(logFilename));
+}
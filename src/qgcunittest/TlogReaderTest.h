@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for TlogReader indexing, seeking and handling of damaged logs and index files
+class TlogReaderTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _buildIndex_test           (void);
+    void _offsetForTimestamp_test   (void);
+    void _staleIndex_test           (void);
+    void _corruptIndex_test         (void);
+    void _truncatedTail_test        (void);
+
+private:
+    bool _writeTestLog(const QString& logFilename, int firstTick, int tickCount, bool append);
+
+    QVector<qint64>     _recordOffsets;
+    QVector<quint64>    _recordTimestamps;
+
+    static const quint64    _startTimeUSecs;
+    static const quint64    _tickUSecs          = 100000;
+    static const int        _logTicks           = 301;      ///< 30 seconds of log at 10Hz
+};
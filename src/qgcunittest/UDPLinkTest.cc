@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "UDPLinkTest.h"
+#include "LinkManager.h"
+
+#include <QUdpSocket>
+#include <QElapsedTimer>
+#include <QSemaphore>
+
+UDPLinkTest::UDPLinkTest(void)
+    : _link                     (nullptr)
+    , _receivedByteCount        (0)
+    , _bytesReceivedSignalCount (0)
+{
+
+}
+
+void UDPLinkTest::init(void)
+{
+    UnitTest::init();
+
+    UDPConfiguration* udpConfig = new UDPConfiguration("MockUDP");
+    udpConfig->setLocalPort(0); // Let the OS pick a free port, see _linkPort()
+    _sharedConfig = SharedLinkConfigurationPointer(udpConfig);
+    _link = new UDPLink(_sharedConfig);
+
+    _receivedBytes.clear();
+    _receivedByteCount          = 0;
+    _bytesReceivedSignalCount   = 0;
+
+    // The link lives on its own thread, so this is a queued connection back to the test thread
+    connect(_link, &LinkInterface::bytesReceived, this, [this](LinkInterface* link, QByteArray bytes) {
+        Q_UNUSED(link);
+        if (_receivedBytes.size() < 1024 * 1024) {
+            _receivedBytes.append(bytes);
+        }
+        _receivedByteCount += bytes.size();
+        _bytesReceivedSignalCount++;
+    });
+}
+
+void UDPLinkTest::cleanup(void)
+{
+    _link->_disconnect();
+    delete _link;
+    _link = nullptr;
+
+    _sharedConfig.clear();
+
+    UnitTest::cleanup();
+}
+
+void UDPLinkTest::_connectLink(void)
+{
+    QSignalSpy spyConnected(_link, &LinkInterface::connected);
+    QCOMPARE(_link->_connect(), true);
+    QVERIFY(spyConnected.count() || spyConnected.wait(1000));
+}
+
+void UDPLinkTest::_loopback_test(void)
+{
+    _connectLink();
+
+    // Datagrams of varying size, including MAVLink v2 max packet size, must arrive complete and in order
+    QUdpSocket  sender;
+    QByteArray  bytesSent;
+    for (int i = 0; i < 200; i++) {
+        QByteArray datagram(1 + (i % 280), static_cast<char>(i));
+        QCOMPARE(sender.writeDatagram(datagram, QHostAddress::LocalHost, _linkPort()), static_cast<qint64>(datagram.size()));
+        bytesSent.append(datagram);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(_receivedByteCount, static_cast<qint64>(bytesSent.size()), 2000);
+    QVERIFY(_receivedBytes == bytesSent);
+}
+
+void UDPLinkTest::_batching_test(void)
+{
+    _connectLink();
+
+    // Hold the link thread while a burst is queued in the socket, so all of it is pending on the next read
+    QSemaphore linkThreadBlocked;
+    QSemaphore releaseLinkThread;
+    QMetaObject::invokeMethod(_link, [&]() { linkThreadBlocked.release(); releaseLinkThread.acquire(); }, Qt::QueuedConnection);
+    QVERIFY(linkThreadBlocked.tryAcquire(1, 2000));
+
+    const int   cDatagrams      = 500;
+    const int   cDatagramSize   = 64;
+    QUdpSocket  sender;
+    QByteArray  datagram(cDatagramSize, 'x');
+    for (int i = 0; i < cDatagrams; i++) {
+        QCOMPARE(sender.writeDatagram(datagram, QHostAddress::LocalHost, _linkPort()), static_cast<qint64>(cDatagramSize));
+    }
+    releaseLinkThread.release();
+
+    QTRY_COMPARE_WITH_TIMEOUT(_receivedByteCount, static_cast<qint64>(cDatagrams * cDatagramSize), 2000);
+    QCOMPARE(_receivedBytes, QByteArray(cDatagrams * cDatagramSize, 'x'));
+
+#if defined(QGC_UDP_BATCH_RECEIVE)
+    // Counters are updated on the link thread before bytesReceived is emitted, so they are settled by now
+    const quint64   batchCallCount      = _link->_batchCallCount;
+    const quint64   batchDatagramCount  = _link->_batchDatagramCount;
+    const quint64   singleDatagramCount = _link->_singleDatagramCount;
+    const int       batchDatagrams      = UDPLink::_batchDatagrams;
+    qCDebug(LinkManagerLog) << "UDPLink batch receive" << batchDatagramCount << "datagrams in" << batchCallCount << "recvmmsg calls," << singleDatagramCount << "single reads";
+
+    // Every datagram went through exactly one of the two read paths, and the queued burst was drained in full batches
+    QCOMPARE(batchDatagramCount + singleDatagramCount, static_cast<quint64>(cDatagrams));
+    QVERIFY(batchCallCount > 0);
+    QVERIFY2(batchDatagramCount / batchCallCount >= static_cast<quint64>(batchDatagrams / 2),
+             qPrintable(QStringLiteral("%1 datagrams per recvmmsg call").arg(batchDatagramCount / batchCallCount)));
+#endif
+}
+
+void UDPLinkTest::_throughput_test(void)
+{
+    _connectLink();
+
+    // Sent in bursts which fit in the socket receive buffer so nothing is dropped by the kernel
+    const int   cDatagrams      = 10000;
+    const int   cBurst          = 500;
+    const int   cDatagramSize   = 64;
+    QUdpSocket  sender;
+    QByteArray  datagram(cDatagramSize, 'x');
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int sent = 0; sent < cDatagrams; sent += cBurst) {
+        for (int i = 0; i < cBurst; i++) {
+            sender.writeDatagram(datagram, QHostAddress::LocalHost, _linkPort());
+        }
+        QTRY_COMPARE_WITH_TIMEOUT(_receivedByteCount, static_cast<qint64>((sent + cBurst) * cDatagramSize), 2000);
+    }
+    qint64 elapsedNSecs = qMax(timer.nsecsElapsed(), static_cast<qint64>(1));
+
+    qCDebug(LinkManagerLog) << "UDPLink received" << static_cast<qint64>(cDatagrams * 1.0e9 / elapsedNSecs) << "datagrams/sec over loopback"
+                            << "-" << static_cast<double>(cDatagrams) / _bytesReceivedSignalCount << "datagrams per bytesReceived signal";
+
+    // Every datagram arrives intact
+    QCOMPARE(_receivedBytes, QByteArray(cDatagrams * cDatagramSize, 'x'));
+}
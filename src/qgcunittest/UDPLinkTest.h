@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "UDPLink.h"
+
+/// Unit test for UDPLink receive path, including coalescing of pending datagrams into a single chunk.
+class UDPLinkTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    UDPLinkTest(void);
+
+private slots:
+    void init(void);
+    void cleanup(void);
+
+    void _loopback_test(void);
+    void _batching_test(void);
+    void _throughput_test(void);
+
+private:
+    void    _connectLink    (void);
+    quint16 _linkPort       (void) const { return _link->_socket->localPort(); }
+
+    SharedLinkConfigurationPointer  _sharedConfig;
+    UDPLink*                        _link;
+    QByteArray                      _receivedBytes;
+    qint64                          _receivedByteCount;
+    int                             _bytesReceivedSignalCount;
+};
@@ -20,6 +20,7 @@
 #include "AppSettings.h"
 #include "SettingsManager.h"
 #include "MockLink.h"
+#include "ParameterManager.h"
 
 #include <QRandomGenerator>
 #include <QTemporaryFile>
@@ -127,6 +128,11 @@ void UnitTest::init(void)
     _expectMissedMessageBox = false;
     
     MAVLinkProtocol::deleteTempLogFiles();
+
+    // A parameter cache left by an earlier test would turn its initial parameter load into a cache load
+    QDir paramCacheDir(ParameterManager::parameterCacheDir());
+    paramCacheDir.removeRecursively();
+    paramCacheDir.mkpath(paramCacheDir.absolutePath());
 }
 
 /// @brief Called after each test.
@@ -16,6 +16,7 @@
 //#include "FileDialogTest.h"
 #include "GeoTest.h"
 #include "LinkManagerTest.h"
+#include "MAVLinkParserWorkerTest.h"
 //#include "MessageBoxTest.h"
 #include "MissionItemTest.h"
 #include "SimpleMissionItemTest.h"
@@ -27,9 +28,11 @@
 //#include "MainWindowTest.h"
 //#include "FileManagerTest.h"
 #include "TCPLinkTest.h"
+#include "TerrainTileTest.h"
+#include "UDPLinkTest.h"
 #include "ParameterManagerTest.h"
 #include "MissionCommandTreeTest.h"
-//#include "LogDownloadTest.h"
+#include "LogDownloadTest.h"
 #include "SendMavCommandWithSignallingTest.h"
 #include "SendMavCommandWithHandlerTest.h"
 #include "VisualMissionItemTest.h"
@@ -48,28 +51,59 @@
 #include "RequestMessageTest.h"
 #include "InitialConnectTest.h"
 #include "FTPManagerTest.h"
+#include "JoystickTest.h"
+#include "BootloaderTest.h"
+#include "TlogAnalyzerTest.h"
+#include "GeoTagLogParserTest.h"
+#include "ADSBSpatialIndexTest.h"
+#include "MAVLinkTimeSeriesTest.h"
+#include "TelemetryLogWriterTest.h"
+#include "TlogReaderTest.h"
+#include "FactGroupTest.h"
+#include "MAVLinkMessageDispatcherTest.h"
+#include "QGCTileMemoryCacheTest.h"
+#include "TerrainTileManagerTest.h"
+#include "TrajectoryPointsTest.h"
+#include "ParameterMetaDataTest.h"
 
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
 //UT_REGISTER_TEST(FileDialogTest)
 UT_REGISTER_TEST(GeoTest)
 UT_REGISTER_TEST(LinkManagerTest)
+UT_REGISTER_TEST(MAVLinkParserWorkerTest)
 //UT_REGISTER_TEST(MessageBoxTest)
 UT_REGISTER_TEST(SendMavCommandWithSignallingTest)
 UT_REGISTER_TEST(SendMavCommandWithHandlerTest)
 UT_REGISTER_TEST(RequestMessageTest)
 UT_REGISTER_TEST(FTPManagerTest)
 UT_REGISTER_TEST(InitialConnectTest)
+UT_REGISTER_TEST(JoystickTest)
+UT_REGISTER_TEST(BootloaderTest)
+UT_REGISTER_TEST(TlogAnalyzerTest)
+UT_REGISTER_TEST(GeoTagLogParserTest)
+UT_REGISTER_TEST(ADSBSpatialIndexTest)
+UT_REGISTER_TEST(MAVLinkTimeSeriesTest)
+UT_REGISTER_TEST(TelemetryLogWriterTest)
+UT_REGISTER_TEST(TlogReaderTest)
+UT_REGISTER_TEST(FactGroupTest)
+UT_REGISTER_TEST(MAVLinkMessageDispatcherTest)
+UT_REGISTER_TEST(QGCTileMemoryCacheTest)
+UT_REGISTER_TEST(TerrainTileManagerTest)
+UT_REGISTER_TEST(TrajectoryPointsTest)
+UT_REGISTER_TEST(ParameterMetaDataTest)
 UT_REGISTER_TEST(MissionItemTest)
 UT_REGISTER_TEST(SimpleMissionItemTest)
 UT_REGISTER_TEST(MissionControllerTest)
 UT_REGISTER_TEST(MissionManagerTest)
 //UT_REGISTER_TEST(RadioConfigTest)
 UT_REGISTER_TEST(TCPLinkTest)
+UT_REGISTER_TEST(TerrainTileTest)
+UT_REGISTER_TEST(UDPLinkTest)
 //UT_REGISTER_TEST(FileManagerTest)
 UT_REGISTER_TEST(ParameterManagerTest)
 UT_REGISTER_TEST(MissionCommandTreeTest)
-//UT_REGISTER_TEST(LogDownloadTest)
+UT_REGISTER_TEST(LogDownloadTest)
 UT_REGISTER_TEST(SurveyComplexItemTest)
 UT_REGISTER_TEST(CameraSectionTest)
 UT_REGISTER_TEST(SpeedSectionTest)
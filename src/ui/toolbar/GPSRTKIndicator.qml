@@ -76,6 +76,22 @@ Item {
                         }
                     QGCLabel { text: qsTr("Satellites:") }
                     QGCLabel { text: QGroundControl.gpsRtk.numSatellites.value }
+                    QGCLabel {
+                        text: qsTr("RTCM Rate:")
+                        visible: QGroundControl.gpsRtk.rtcmDataRate.value > 0
+                        }
+                    QGCLabel {
+                        text: QGroundControl.gpsRtk.rtcmDataRate.valueString + " " + QGroundControl.gpsRtk.rtcmDataRate.units
+                        visible: QGroundControl.gpsRtk.rtcmDataRate.value > 0
+                        }
+                    QGCLabel {
+                        text: qsTr("RTCM Latency:")
+                        visible: QGroundControl.gpsRtk.rtcmDataRate.value > 0
+                        }
+                    QGCLabel {
+                        text: QGroundControl.gpsRtk.rtcmLatency.valueString + " " + QGroundControl.gpsRtk.rtcmLatency.units
+                        visible: QGroundControl.gpsRtk.rtcmDataRate.value > 0
+                        }
                 }
             }
         }